@@ -26,12 +26,457 @@ typedef struct {
 	bool lookup_head;
 } LookupEntry;
 
+/*****************************************************************************/
+
+/* The index is backed by two hash sets: one for the (head) entries of all
+ * idx-types, and one to intern the objects. Which hash set implementation
+ * is used is a build time choice (NM_DEDUP_MULTI_OPEN_ADDRESSING).
+ *
+ * The default uses GHashTable and allocates the entries with g_slice.
+ *
+ * The open-addressing variant keeps the hash of each element inline in a
+ * flat bucket array (linear probing) and hands out the entries from slabs
+ * owned by the index. That avoids the per-node allocations and pointer
+ * chasing of GHashTable, and makes lookups mostly touch a single cache
+ * line. The price is that slab memory is only returned when the index is
+ * destroyed. */
+
+#ifndef NM_DEDUP_MULTI_OPEN_ADDRESSING
+#define NM_DEDUP_MULTI_OPEN_ADDRESSING 0
+#endif
+
+#if NM_DEDUP_MULTI_OPEN_ADDRESSING
+
+#define TABLE_HASH_EMPTY     0u
+#define TABLE_HASH_TOMBSTONE 1u
+#define TABLE_MIN_BUCKETS    8u
+
+typedef struct {
+	/* the cached hash of @value, or one of TABLE_HASH_EMPTY and
+	 * TABLE_HASH_TOMBSTONE. */
+	guint hash;
+	gconstpointer value;
+} TableBucket;
+
+typedef struct {
+	GHashFunc hash_func;
+	GEqualFunc equal_func;
+	TableBucket *buckets;
+	guint n_buckets;
+	guint n_used;
+	guint n_tombstones;
+} Table;
+
+static void
+_table_init (Table *table, GHashFunc hash_func, GEqualFunc equal_func)
+{
+	*table = (Table) {
+		.hash_func  = hash_func,
+		.equal_func = equal_func,
+	};
+}
+
+static void
+_table_destroy (Table *table)
+{
+	nm_clear_g_free (&table->buckets);
+	table->n_buckets = 0;
+	table->n_used = 0;
+	table->n_tombstones = 0;
+}
+
+static guint
+_table_hash (const Table *table, gconstpointer key)
+{
+	guint hash;
+
+	hash = table->hash_func (key);
+	if (hash <= TABLE_HASH_TOMBSTONE)
+		hash += 2;
+	return hash;
+}
+
+static void
+_table_resize (Table *table, guint n_buckets)
+{
+	TableBucket *old_buckets = table->buckets;
+	guint old_n_buckets = table->n_buckets;
+	guint i;
+
+	nm_assert (nm_utils_is_power_of_two (n_buckets));
+	nm_assert (n_buckets > table->n_used);
+
+	table->buckets = g_new0 (TableBucket, n_buckets);
+	table->n_buckets = n_buckets;
+	table->n_tombstones = 0;
+
+	for (i = 0; i < old_n_buckets; i++) {
+		const TableBucket *b = &old_buckets[i];
+		guint j;
+
+		if (b->hash <= TABLE_HASH_TOMBSTONE)
+			continue;
+
+		j = b->hash & (n_buckets - 1);
+		while (table->buckets[j].hash != TABLE_HASH_EMPTY)
+			j = (j + 1) & (n_buckets - 1);
+		table->buckets[j] = *b;
+	}
+
+	g_free (old_buckets);
+}
+
+static TableBucket *
+_table_find (const Table *table, gconstpointer key, guint hash)
+{
+	guint i;
+
+	if (table->n_used == 0)
+		return NULL;
+
+	i = hash & (table->n_buckets - 1);
+	while (TRUE) {
+		TableBucket *b = &table->buckets[i];
+
+		if (b->hash == TABLE_HASH_EMPTY)
+			return NULL;
+		if (   b->hash == hash
+		    && table->equal_func (b->value, key))
+			return b;
+		i = (i + 1) & (table->n_buckets - 1);
+	}
+}
+
+static gpointer
+_table_lookup (const Table *table, gconstpointer key)
+{
+	TableBucket *b;
+
+	b = _table_find (table, key, _table_hash (table, key));
+	return b ? (gpointer) b->value : NULL;
+}
+
+static gboolean
+_table_add (Table *table, gconstpointer value)
+{
+	TableBucket *b_free = NULL;
+	guint hash;
+	guint i;
+
+	/* keep the load (including tombstones) below 3/4. If most of the load
+	 * are tombstones, rehashing at the same size is enough. */
+	if ((table->n_used + table->n_tombstones + 1u) * 4u > table->n_buckets * 3u) {
+		guint n_buckets = NM_MAX (table->n_buckets, TABLE_MIN_BUCKETS);
+
+		while ((table->n_used + 1u) * 2u > n_buckets)
+			n_buckets *= 2u;
+		_table_resize (table, n_buckets);
+	}
+
+	hash = _table_hash (table, value);
+	i = hash & (table->n_buckets - 1);
+	while (TRUE) {
+		TableBucket *b = &table->buckets[i];
+
+		if (b->hash == TABLE_HASH_EMPTY) {
+			if (!b_free)
+				b_free = b;
+			break;
+		}
+		if (b->hash == TABLE_HASH_TOMBSTONE) {
+			if (!b_free)
+				b_free = b;
+		} else if (   b->hash == hash
+		           && table->equal_func (b->value, value))
+			return FALSE;
+		i = (i + 1) & (table->n_buckets - 1);
+	}
+
+	if (b_free->hash == TABLE_HASH_TOMBSTONE)
+		table->n_tombstones--;
+	b_free->hash = hash;
+	b_free->value = value;
+	table->n_used++;
+	return TRUE;
+}
+
+static gboolean
+_table_remove (Table *table, gconstpointer key)
+{
+	TableBucket *b;
+
+	b = _table_find (table, key, _table_hash (table, key));
+	if (!b)
+		return FALSE;
+
+	table->n_used--;
+
+	/* a bucket that is followed by an empty one does not interrupt any
+	 * probe sequence. It can become empty right away. */
+	if (table->buckets[(b - table->buckets + 1) & (table->n_buckets - 1)].hash == TABLE_HASH_EMPTY)
+		b->hash = TABLE_HASH_EMPTY;
+	else {
+		b->hash = TABLE_HASH_TOMBSTONE;
+		table->n_tombstones++;
+	}
+	b->value = NULL;
+
+	if (   table->n_buckets > TABLE_MIN_BUCKETS
+	    && table->n_used * 8u < table->n_buckets)
+		_table_resize (table, table->n_buckets / 2u);
+	return TRUE;
+}
+
+static guint
+_table_size (const Table *table)
+{
+	return table->n_used;
+}
+
+static gpointer
+_table_get_any (const Table *table)
+{
+	guint i;
+
+	for (i = 0; i < table->n_buckets; i++) {
+		if (table->buckets[i].hash > TABLE_HASH_TOMBSTONE)
+			return (gpointer) table->buckets[i].value;
+	}
+	return NULL;
+}
+
+static void
+_table_foreach (const Table *table, GFunc func, gpointer user_data)
+{
+	guint i;
+
+	for (i = 0; i < table->n_buckets; i++) {
+		if (table->buckets[i].hash > TABLE_HASH_TOMBSTONE)
+			func ((gpointer) table->buckets[i].value, user_data);
+	}
+}
+
+static gsize
+_table_get_allocated_bytes (const Table *table)
+{
+	return table->n_buckets * sizeof (TableBucket);
+}
+
+/*****************************************************************************/
+
+#define SLAB_CHUNK_N_ELEMS 256u
+
+typedef struct _SlabChunk {
+	struct _SlabChunk *next;
+	/* followed by SLAB_CHUNK_N_ELEMS elements of Slab.elem_size. */
+	max_align_t data[];
+} SlabChunk;
+
+typedef struct {
+	gsize elem_size;
+	gpointer free_list;
+	SlabChunk *chunks;
+	guint n_chunks;
+	guint n_free_in_chunk;
+} Slab;
+
+static void
+_slab_init (Slab *slab, gsize elem_size)
+{
+	*slab = (Slab) {
+		/* freed elements keep the next pointer of the free list. */
+		.elem_size = NM_MAX (elem_size, sizeof (gpointer)),
+	};
+}
+
+static gpointer
+_slab_alloc0 (Slab *slab)
+{
+	gpointer elem;
+
+	if (slab->free_list) {
+		elem = slab->free_list;
+		slab->free_list = *((gpointer *) elem);
+	} else {
+		if (slab->n_free_in_chunk == 0) {
+			SlabChunk *chunk;
+
+			chunk = g_malloc (sizeof (SlabChunk) + (SLAB_CHUNK_N_ELEMS * slab->elem_size));
+			chunk->next = slab->chunks;
+			slab->chunks = chunk;
+			slab->n_chunks++;
+			slab->n_free_in_chunk = SLAB_CHUNK_N_ELEMS;
+		}
+		slab->n_free_in_chunk--;
+		elem = &((char *) slab->chunks->data)[slab->n_free_in_chunk * slab->elem_size];
+	}
+
+	memset (elem, 0, slab->elem_size);
+	return elem;
+}
+
+static void
+_slab_free (Slab *slab, gpointer elem)
+{
+	nm_assert (elem);
+
+	*((gpointer *) elem) = slab->free_list;
+	slab->free_list = elem;
+}
+
+static void
+_slab_destroy (Slab *slab)
+{
+	SlabChunk *chunk;
+
+	while ((chunk = slab->chunks)) {
+		slab->chunks = chunk->next;
+		g_free (chunk);
+	}
+	slab->free_list = NULL;
+	slab->n_chunks = 0;
+	slab->n_free_in_chunk = 0;
+}
+
+static gsize
+_slab_get_allocated_bytes (const Slab *slab)
+{
+	return slab->n_chunks * (sizeof (SlabChunk) + (SLAB_CHUNK_N_ELEMS * slab->elem_size));
+}
+
+#else /* NM_DEDUP_MULTI_OPEN_ADDRESSING */
+
+typedef struct {
+	GHashTable *hash;
+} Table;
+
+static void
+_table_init (Table *table, GHashFunc hash_func, GEqualFunc equal_func)
+{
+	table->hash = g_hash_table_new (hash_func, equal_func);
+}
+
+static void
+_table_destroy (Table *table)
+{
+	nm_clear_pointer (&table->hash, g_hash_table_unref);
+}
+
+static gpointer
+_table_lookup (const Table *table, gconstpointer key)
+{
+	return g_hash_table_lookup (table->hash, key);
+}
+
+static gboolean
+_table_add (Table *table, gconstpointer value)
+{
+	return g_hash_table_add (table->hash, (gpointer) value);
+}
+
+static gboolean
+_table_remove (Table *table, gconstpointer key)
+{
+	return g_hash_table_remove (table->hash, key);
+}
+
+static guint
+_table_size (const Table *table)
+{
+	return g_hash_table_size (table->hash);
+}
+
+static gpointer
+_table_get_any (const Table *table)
+{
+	GHashTableIter iter;
+	gpointer value;
+
+	g_hash_table_iter_init (&iter, table->hash);
+	if (g_hash_table_iter_next (&iter, &value, NULL))
+		return value;
+	return NULL;
+}
+
+static void
+_table_foreach (const Table *table, GFunc func, gpointer user_data)
+{
+	GHashTableIter iter;
+	gpointer value;
+
+	g_hash_table_iter_init (&iter, table->hash);
+	while (g_hash_table_iter_next (&iter, &value, NULL))
+		func (value, user_data);
+}
+
+static gsize
+_table_get_allocated_bytes (const Table *table)
+{
+	guint n = g_hash_table_size (table->hash);
+	gsize n_buckets = 8;
+
+	/* GHashTable does not tell its size. It keeps the load between 1/4
+	 * and roughly 15/16, and grows to a power of two of about 4/3 of
+	 * the number of nodes. For a set, it tracks a hash and a key per bucket. */
+	while (n_buckets < (gsize) n + (n / 3u))
+		n_buckets *= 2u;
+	return n_buckets * (sizeof (guint) + sizeof (gpointer));
+}
+
+#endif /* NM_DEDUP_MULTI_OPEN_ADDRESSING */
+
+/*****************************************************************************/
+
 struct _NMDedupMultiIndex {
 	int ref_count;
-	GHashTable *idx_entries;
-	GHashTable *idx_objs;
+	Table idx_entries;
+	Table idx_objs;
+#if NM_DEDUP_MULTI_OPEN_ADDRESSING
+	Slab slab_entries;
+	Slab slab_head_entries;
+#endif
 };
 
+static NMDedupMultiEntry *
+_entry_alloc (NMDedupMultiIndex *self)
+{
+#if NM_DEDUP_MULTI_OPEN_ADDRESSING
+	return _slab_alloc0 (&self->slab_entries);
+#else
+	return g_slice_new0 (NMDedupMultiEntry);
+#endif
+}
+
+static void
+_entry_free (NMDedupMultiIndex *self, NMDedupMultiEntry *entry)
+{
+#if NM_DEDUP_MULTI_OPEN_ADDRESSING
+	_slab_free (&self->slab_entries, entry);
+#else
+	g_slice_free (NMDedupMultiEntry, entry);
+#endif
+}
+
+static NMDedupMultiHeadEntry *
+_head_entry_alloc (NMDedupMultiIndex *self)
+{
+#if NM_DEDUP_MULTI_OPEN_ADDRESSING
+	return _slab_alloc0 (&self->slab_head_entries);
+#else
+	return g_slice_new0 (NMDedupMultiHeadEntry);
+#endif
+}
+
+static void
+_head_entry_free (NMDedupMultiIndex *self, NMDedupMultiHeadEntry *head_entry)
+{
+#if NM_DEDUP_MULTI_OPEN_ADDRESSING
+	_slab_free (&self->slab_head_entries, head_entry);
+#else
+	g_slice_free (NMDedupMultiHeadEntry, head_entry);
+#endif
+}
+
 /*****************************************************************************/
 
 static void
@@ -75,7 +520,7 @@ _entry_lookup_obj (const NMDedupMultiIndex *self,
 	};
 
 	ASSERT_idx_type (idx_type);
-	return g_hash_table_lookup (self->idx_entries, &stack_entry);
+	return _table_lookup (&self->idx_entries, &stack_entry);
 }
 
 static NMDedupMultiHeadEntry *
@@ -99,11 +544,11 @@ _entry_lookup_head (const NMDedupMultiIndex *self,
 			nm_assert (c_list_length (&idx_type->lst_idx_head) == 1);
 			head_entry = c_list_entry (idx_type->lst_idx_head.next, NMDedupMultiHeadEntry, lst_idx);
 		}
-		nm_assert (head_entry == g_hash_table_lookup (self->idx_entries, &stack_entry));
+		nm_assert (head_entry == _table_lookup (&self->idx_entries, &stack_entry));
 		return head_entry;
 	}
 
-	return g_hash_table_lookup (self->idx_entries, &stack_entry);
+	return _table_lookup (&self->idx_entries, &stack_entry);
 }
 
 static void
@@ -314,7 +759,7 @@ _add (NMDedupMultiIndex *self,
 		head_entry = head_existing;
 
 	if (!head_entry) {
-		head_entry = g_slice_new0 (NMDedupMultiHeadEntry);
+		head_entry = _head_entry_alloc (self);
 		head_entry->is_head = TRUE;
 		head_entry->idx_type = idx_type;
 		c_list_init (&head_entry->lst_entries_head);
@@ -330,7 +775,7 @@ _add (NMDedupMultiIndex *self,
 		nm_assert (c_list_contains (&entry_order->lst_entries, &head_entry->lst_entries_head));
 	}
 
-	entry = g_slice_new0 (NMDedupMultiEntry);
+	entry = _entry_alloc (self);
 	entry->obj = obj_new;
 	entry->head = head_entry;
 
@@ -354,10 +799,10 @@ _add (NMDedupMultiIndex *self,
 	head_entry->len++;
 
 	if (   add_head_entry
-	    && !g_hash_table_add (self->idx_entries, head_entry))
+	    && !_table_add (&self->idx_entries, head_entry))
 		nm_assert_not_reached ();
 
-	if (!g_hash_table_add (self->idx_entries, entry))
+	if (!_table_add (&self->idx_entries, entry))
 		nm_assert_not_reached ();
 
 	NM_SET_OUT (out_entry, entry);
@@ -481,14 +926,14 @@ _remove_entry (NMDedupMultiIndex *self,
 	nm_assert (entry->obj);
 	nm_assert (entry->head);
 	nm_assert (!c_list_is_empty (&entry->lst_entries));
-	nm_assert (g_hash_table_lookup (self->idx_entries, entry) == entry);
+	nm_assert (_table_lookup (&self->idx_entries, entry) == entry);
 
 	head_entry = (NMDedupMultiHeadEntry *) entry->head;
 	obj = entry->obj;
 
 	nm_assert (head_entry);
 	nm_assert (head_entry->len > 0);
-	nm_assert (g_hash_table_lookup (self->idx_entries, head_entry) == head_entry);
+	nm_assert (_table_lookup (&self->idx_entries, head_entry) == head_entry);
 
 	idx_type = (NMDedupMultiIdxType *) head_entry->idx_type;
 	ASSERT_idx_type (idx_type);
@@ -502,20 +947,20 @@ _remove_entry (NMDedupMultiIndex *self,
 
 	NM_SET_OUT (out_head_entry_removed, head_entry != NULL);
 
-	if (!g_hash_table_remove (self->idx_entries, entry))
+	if (!_table_remove (&self->idx_entries, entry))
 		nm_assert_not_reached ();
 
 	if (   head_entry
-	    && !g_hash_table_remove (self->idx_entries, head_entry))
+	    && !_table_remove (&self->idx_entries, head_entry))
 		nm_assert_not_reached ();
 
 	c_list_unlink_stale (&entry->lst_entries);
-	g_slice_free (NMDedupMultiEntry, entry);
+	_entry_free (self, entry);
 
 	if (head_entry) {
 		nm_assert (c_list_is_empty (&head_entry->lst_entries_head));
 		c_list_unlink_stale (&head_entry->lst_idx);
-		g_slice_free (NMDedupMultiHeadEntry, head_entry);
+		_head_entry_free (self, head_entry);
 	}
 
 	nm_dedup_multi_obj_unref (obj);
@@ -535,7 +980,7 @@ _remove_head (NMDedupMultiIndex *self,
 	nm_assert (head_entry);
 	nm_assert (head_entry->len > 0);
 	nm_assert (head_entry->len == c_list_length (&head_entry->lst_entries_head));
-	nm_assert (g_hash_table_lookup (self->idx_entries, head_entry) == head_entry);
+	nm_assert (_table_lookup (&self->idx_entries, head_entry) == head_entry);
 
 	n = 0;
 	c_list_for_each_safe (iter_entry, iter_entry_safe, &head_entry->lst_entries_head) {
@@ -787,11 +1232,11 @@ nm_dedup_multi_index_obj_release (NMDedupMultiIndex *self,
 {
 	nm_assert (self);
 	nm_assert (obj);
-	nm_assert (g_hash_table_lookup (self->idx_objs, obj) == obj);
+	nm_assert (_table_lookup (&self->idx_objs, obj) == obj);
 	nm_assert (((const NMDedupMultiObj *) obj)->_multi_idx == self);
 
 	((NMDedupMultiObj *) obj)->_multi_idx = NULL;
-	if (!g_hash_table_remove (self->idx_objs, obj))
+	if (!_table_remove (&self->idx_objs, obj))
 		nm_assert_not_reached ();
 }
 
@@ -802,7 +1247,7 @@ nm_dedup_multi_index_obj_find (NMDedupMultiIndex *self,
 	g_return_val_if_fail (self, NULL);
 	g_return_val_if_fail (obj, NULL);
 
-	return g_hash_table_lookup (self->idx_objs, obj);
+	return _table_lookup (&self->idx_objs, obj);
 }
 
 gconstpointer
@@ -816,12 +1261,12 @@ nm_dedup_multi_index_obj_intern (NMDedupMultiIndex *self,
 	nm_assert (obj_new);
 
 	if (obj_new->_multi_idx == self) {
-		nm_assert (g_hash_table_lookup (self->idx_objs, obj_new) == obj_new);
+		nm_assert (_table_lookup (&self->idx_objs, obj_new) == obj_new);
 		nm_dedup_multi_obj_ref (obj_new);
 		return obj_new;
 	}
 
-	obj_old = g_hash_table_lookup (self->idx_objs, obj_new);
+	obj_old = _table_lookup (&self->idx_objs, obj_new);
 	nm_assert (obj_old != obj_new);
 
 	if (obj_old) {
@@ -838,7 +1283,7 @@ nm_dedup_multi_index_obj_intern (NMDedupMultiIndex *self,
 	nm_assert (obj_new);
 	nm_assert (!obj_new->_multi_idx);
 
-	if (!g_hash_table_add (self->idx_objs, (gpointer) obj_new))
+	if (!_table_add (&self->idx_objs, obj_new))
 		nm_assert_not_reached ();
 
 	((NMDedupMultiObj *) obj_new)->_multi_idx = self;
@@ -1019,8 +1464,12 @@ nm_dedup_multi_index_new (void)
 
 	self = g_slice_new0 (NMDedupMultiIndex);
 	self->ref_count = 1;
-	self->idx_entries = g_hash_table_new ((GHashFunc) _dict_idx_entries_hash, (GEqualFunc) _dict_idx_entries_equal);
-	self->idx_objs    = g_hash_table_new ((GHashFunc) _dict_idx_objs_hash,    (GEqualFunc) _dict_idx_objs_equal);
+	_table_init (&self->idx_entries, (GHashFunc) _dict_idx_entries_hash, (GEqualFunc) _dict_idx_entries_equal);
+	_table_init (&self->idx_objs,    (GHashFunc) _dict_idx_objs_hash,    (GEqualFunc) _dict_idx_objs_equal);
+#if NM_DEDUP_MULTI_OPEN_ADDRESSING
+	_slab_init (&self->slab_entries, sizeof (NMDedupMultiEntry));
+	_slab_init (&self->slab_head_entries, sizeof (NMDedupMultiHeadEntry));
+#endif
 	return self;
 }
 
@@ -1034,13 +1483,20 @@ nm_dedup_multi_index_ref (NMDedupMultiIndex *self)
 	return self;
 }
 
+static void
+_obj_detach (gpointer data, gpointer user_data)
+{
+	NMDedupMultiObj *obj = data;
+
+	nm_assert (obj->_multi_idx == user_data);
+	obj->_multi_idx = NULL;
+}
+
 NMDedupMultiIndex *
 nm_dedup_multi_index_unref (NMDedupMultiIndex *self)
 {
-	GHashTableIter iter;
 	const NMDedupMultiIdxType *idx_type;
 	NMDedupMultiEntry *entry;
-	const NMDedupMultiObj *obj;
 
 	g_return_val_if_fail (self, NULL);
 	g_return_val_if_fail (self->ref_count > 0, NULL);
@@ -1048,29 +1504,59 @@ nm_dedup_multi_index_unref (NMDedupMultiIndex *self)
 	if (--self->ref_count > 0)
 		return NULL;
 
-more:
-	g_hash_table_iter_init (&iter, self->idx_entries);
-	while (g_hash_table_iter_next (&iter, (gpointer *) &entry, NULL)) {
+	while ((entry = _table_get_any (&self->idx_entries))) {
 		if (entry->is_head)
 			idx_type = ((NMDedupMultiHeadEntry *) entry)->idx_type;
 		else
 			idx_type = entry->head->idx_type;
 		_remove_idx_entry (self, (NMDedupMultiIdxType *) idx_type, TRUE, FALSE);
-		goto more;
 	}
 
-	nm_assert (g_hash_table_size (self->idx_entries) == 0);
+	nm_assert (_table_size (&self->idx_entries) == 0);
 
-	g_hash_table_iter_init (&iter, self->idx_objs);
-	while (g_hash_table_iter_next (&iter, (gpointer *) &obj, NULL)) {
-		nm_assert (obj->_multi_idx == self);
-		((NMDedupMultiObj * )obj)->_multi_idx = NULL;
-	}
-	g_hash_table_remove_all (self->idx_objs);
+	_table_foreach (&self->idx_objs, _obj_detach, self);
 
-	g_hash_table_unref (self->idx_entries);
-	g_hash_table_unref (self->idx_objs);
+	_table_destroy (&self->idx_entries);
+	_table_destroy (&self->idx_objs);
+
+#if NM_DEDUP_MULTI_OPEN_ADDRESSING
+	_slab_destroy (&self->slab_entries);
+	_slab_destroy (&self->slab_head_entries);
+#endif
 
 	g_slice_free (NMDedupMultiIndex, self);
 	return NULL;
 }
+
+/**
+ * nm_dedup_multi_index_get_stats:
+ * @self: the index instance
+ * @out_stats: (out): the statistics
+ *
+ * Returns the number of tracked objects and entries, and the memory
+ * used for bookkeeping (excluding the objects themselves). With the
+ * GHashTable backend the memory of the hash tables is an estimate.
+ */
+void
+nm_dedup_multi_index_get_stats (const NMDedupMultiIndex *self,
+                                NMDedupMultiIndexStats *out_stats)
+{
+	g_return_if_fail (self);
+	g_return_if_fail (out_stats);
+
+	*out_stats = (NMDedupMultiIndexStats) {
+		.n_objs    = _table_size (&self->idx_objs),
+		.n_entries = _table_size (&self->idx_entries),
+		.bytes     =   sizeof (NMDedupMultiIndex)
+		             + _table_get_allocated_bytes (&self->idx_entries)
+		             + _table_get_allocated_bytes (&self->idx_objs),
+	};
+
+#if NM_DEDUP_MULTI_OPEN_ADDRESSING
+	out_stats->bytes +=   _slab_get_allocated_bytes (&self->slab_entries)
+	                    + _slab_get_allocated_bytes (&self->slab_head_entries);
+#else
+	/* head entries are slightly larger, but they are few. */
+	out_stats->bytes += (gsize) out_stats->n_entries * sizeof (NMDedupMultiEntry);
+#endif
+}
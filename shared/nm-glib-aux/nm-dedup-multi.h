@@ -262,6 +262,15 @@ _nm_auto_unref_dedup_multi_index (NMDedupMultiIndex **v)
 }
 #define nm_auto_unref_dedup_multi_index nm_auto(_nm_auto_unref_dedup_multi_index)
 
+typedef struct {
+	guint n_objs;
+	guint n_entries;
+	gsize bytes;
+} NMDedupMultiIndexStats;
+
+void nm_dedup_multi_index_get_stats (const NMDedupMultiIndex *self,
+                                     NMDedupMultiIndexStats *out_stats);
+
 #define NM_DEDUP_MULTI_ENTRY_MISSING      ((const NMDedupMultiEntry *)     GUINT_TO_POINTER (1))
 #define NM_DEDUP_MULTI_HEAD_ENTRY_MISSING ((const NMDedupMultiHeadEntry *) GUINT_TO_POINTER (1))
 
@@ -0,0 +1,340 @@
+// SPDX-License-Identifier: LGPL-2.1+
+/*
+ * Copyright (C) 2020 Red Hat, Inc.
+ */
+
+#define NM_TEST_UTILS_NO_LIBNM 1
+
+#include "nm-default.h"
+
+#include "nm-glib-aux/nm-dedup-multi.h"
+
+#include "nm-utils/nm-test-utils.h"
+
+/*****************************************************************************/
+
+/* The objects mimic the platform cache: every object is tracked by its
+ * ID in one list (like NMP_CACHE_ID_TYPE_OBJECT_TYPE), and in a second
+ * idx-type that partitions the objects (like routes by ifindex). */
+
+#define N_PARTITIONS 64
+
+typedef struct {
+	NMDedupMultiObj parent;
+	guint32 id;
+	guint32 partition;
+	guint32 data[4];
+} BenchObj;
+
+static const NMDedupMultiObjClass bench_obj_class;
+
+static const NMDedupMultiObj *
+_bench_obj_clone (const NMDedupMultiObj *obj)
+{
+	BenchObj *o;
+
+	o = g_slice_dup (BenchObj, (const BenchObj *) obj);
+	o->parent._multi_idx = NULL;
+	o->parent._ref_count = 1;
+	return &o->parent;
+}
+
+static void
+_bench_obj_destroy (NMDedupMultiObj *obj)
+{
+	g_slice_free (BenchObj, (BenchObj *) obj);
+}
+
+static void
+_bench_obj_full_hash_update (const NMDedupMultiObj *obj, NMHashState *h)
+{
+	const BenchObj *o = (const BenchObj *) obj;
+
+	nm_hash_update_vals (h,
+	                     o->id,
+	                     o->partition);
+	nm_hash_update (h, o->data, sizeof (o->data));
+}
+
+static gboolean
+_bench_obj_full_equal (const NMDedupMultiObj *obj_a,
+                       const NMDedupMultiObj *obj_b)
+{
+	const BenchObj *o_a = (const BenchObj *) obj_a;
+	const BenchObj *o_b = (const BenchObj *) obj_b;
+
+	return    o_a->id == o_b->id
+	       && o_a->partition == o_b->partition
+	       && memcmp (o_a->data, o_b->data, sizeof (o_a->data)) == 0;
+}
+
+static const NMDedupMultiObjClass bench_obj_class = {
+	.obj_clone = _bench_obj_clone,
+	.obj_destroy = _bench_obj_destroy,
+	.obj_full_hash_update = _bench_obj_full_hash_update,
+	.obj_full_equal = _bench_obj_full_equal,
+};
+
+#define BENCH_OBJ_INIT(_id) \
+	(&((BenchObj) { \
+		.parent = { \
+			.klass = &bench_obj_class, \
+			._ref_count = NM_OBJ_REF_COUNT_STACKINIT, \
+		}, \
+		.id = (_id), \
+		.partition = (_id) % N_PARTITIONS, \
+	}))
+
+static BenchObj *
+_bench_obj_new (guint32 id)
+{
+	BenchObj *o;
+
+	o = g_slice_new0 (BenchObj);
+	o->parent.klass = &bench_obj_class;
+	o->parent._ref_count = 1;
+	o->id = id;
+	o->partition = id % N_PARTITIONS;
+	o->data[0] = id * 7u;
+	return o;
+}
+
+/*****************************************************************************/
+
+static void
+_bench_idx_id_hash_update (const NMDedupMultiIdxType *idx_type,
+                           const NMDedupMultiObj *obj,
+                           NMHashState *h)
+{
+	nm_hash_update_val (h, ((const BenchObj *) obj)->id);
+}
+
+static gboolean
+_bench_idx_id_equal (const NMDedupMultiIdxType *idx_type,
+                     const NMDedupMultiObj *obj_a,
+                     const NMDedupMultiObj *obj_b)
+{
+	return ((const BenchObj *) obj_a)->id == ((const BenchObj *) obj_b)->id;
+}
+
+static void
+_bench_idx_partition_hash_update (const NMDedupMultiIdxType *idx_type,
+                                  const NMDedupMultiObj *obj,
+                                  NMHashState *h)
+{
+	nm_hash_update_val (h, ((const BenchObj *) obj)->partition);
+}
+
+static gboolean
+_bench_idx_partition_equal (const NMDedupMultiIdxType *idx_type,
+                            const NMDedupMultiObj *obj_a,
+                            const NMDedupMultiObj *obj_b)
+{
+	return ((const BenchObj *) obj_a)->partition == ((const BenchObj *) obj_b)->partition;
+}
+
+static const NMDedupMultiIdxTypeClass bench_idx_type_class_id = {
+	.idx_obj_id_hash_update = _bench_idx_id_hash_update,
+	.idx_obj_id_equal = _bench_idx_id_equal,
+};
+
+static const NMDedupMultiIdxTypeClass bench_idx_type_class_partition = {
+	.idx_obj_id_hash_update = _bench_idx_id_hash_update,
+	.idx_obj_id_equal = _bench_idx_id_equal,
+	.idx_obj_partition_hash_update = _bench_idx_partition_hash_update,
+	.idx_obj_partition_equal = _bench_idx_partition_equal,
+};
+
+typedef struct {
+	NMDedupMultiIndex *idx;
+	NMDedupMultiIdxType idx_type_id;
+	NMDedupMultiIdxType idx_type_partition;
+} BenchIndex;
+
+static void
+_bench_index_init (BenchIndex *b)
+{
+	b->idx = nm_dedup_multi_index_new ();
+	nm_dedup_multi_idx_type_init (&b->idx_type_id, &bench_idx_type_class_id);
+	nm_dedup_multi_idx_type_init (&b->idx_type_partition, &bench_idx_type_class_partition);
+}
+
+static void
+_bench_index_clear (BenchIndex *b)
+{
+	nm_dedup_multi_index_remove_idx (b->idx, &b->idx_type_id);
+	nm_dedup_multi_index_remove_idx (b->idx, &b->idx_type_partition);
+	g_assert_cmpint (b->idx_type_id.len, ==, 0);
+	g_assert_cmpint (b->idx_type_partition.len, ==, 0);
+	nm_clear_pointer (&b->idx, nm_dedup_multi_index_unref);
+}
+
+static void
+_bench_index_add (BenchIndex *b, guint32 id)
+{
+	BenchObj *o = _bench_obj_new (id);
+
+	nm_dedup_multi_index_add (b->idx, &b->idx_type_id, o, NM_DEDUP_MULTI_IDX_MODE_APPEND, NULL, NULL);
+	nm_dedup_multi_index_add (b->idx, &b->idx_type_partition, o, NM_DEDUP_MULTI_IDX_MODE_APPEND, NULL, NULL);
+	nm_dedup_multi_obj_unref (&o->parent);
+}
+
+static gboolean
+_bench_index_remove (BenchIndex *b, guint32 id)
+{
+	guint n;
+
+	n = nm_dedup_multi_index_remove_obj (b->idx, &b->idx_type_id, BENCH_OBJ_INIT (id), NULL);
+	if (nm_dedup_multi_index_remove_obj (b->idx, &b->idx_type_partition, BENCH_OBJ_INIT (id), NULL) != n)
+		g_assert_not_reached ();
+	return n > 0;
+}
+
+/*****************************************************************************/
+
+static void
+test_dedup_multi_consistency (void)
+{
+	BenchIndex b;
+	const guint N = nmtst_test_quick () ? 500 : 5000;
+	gs_free gboolean *present = g_new0 (gboolean, N);
+	guint n_present = 0;
+	guint i_run;
+
+	_bench_index_init (&b);
+
+	/* random adds and removes, so that the table grows, shrinks and
+	 * accumulates deleted buckets. Check against a plain array. */
+	for (i_run = 0; i_run < 20 * N; i_run++) {
+		const guint32 id = nmtst_get_rand_uint32 () % N;
+		const NMDedupMultiEntry *entry;
+		const NMDedupMultiHeadEntry *head_entry;
+		NMDedupMultiIndexStats stats;
+
+		if (nmtst_get_rand_uint32 () % 3 != 0 && i_run < 15 * N) {
+			_bench_index_add (&b, id);
+			if (!present[id]) {
+				present[id] = TRUE;
+				n_present++;
+			}
+		} else {
+			g_assert (_bench_index_remove (&b, id) == present[id]);
+			if (present[id]) {
+				present[id] = FALSE;
+				n_present--;
+			}
+		}
+
+		entry = nm_dedup_multi_index_lookup_obj (b.idx, &b.idx_type_id, BENCH_OBJ_INIT (id));
+		g_assert ((!!entry) == present[id]);
+		if (entry)
+			g_assert_cmpint (((const BenchObj *) entry->obj)->id, ==, id);
+
+		entry = nm_dedup_multi_index_lookup_obj (b.idx, &b.idx_type_partition, BENCH_OBJ_INIT (id));
+		g_assert ((!!entry) == present[id]);
+
+		head_entry = nm_dedup_multi_index_lookup_head (b.idx, &b.idx_type_id, NULL);
+		g_assert_cmpint (head_entry ? head_entry->len : 0, ==, n_present);
+		g_assert_cmpint (b.idx_type_id.len, ==, n_present);
+		g_assert_cmpint (b.idx_type_partition.len, ==, n_present);
+
+		nm_dedup_multi_index_get_stats (b.idx, &stats);
+		g_assert_cmpint (stats.n_objs, ==, n_present);
+	}
+
+	_bench_index_clear (&b);
+}
+
+/*****************************************************************************/
+
+static void
+_bench_report (const char *what, guint n, double elapsed_sec)
+{
+	g_test_message ("dedup-multi bench: %-7s %8u objs in %8.3f msec (%.0f ops/sec)",
+	                what,
+	                n,
+	                elapsed_sec * 1000.0,
+	                elapsed_sec > 0 ? n / elapsed_sec : 0.0);
+}
+
+static void
+test_dedup_multi_bench (gconstpointer test_data)
+{
+	const guint N = GPOINTER_TO_UINT (test_data);
+	gs_free guint32 *ids = g_new (guint32, N);
+	NMDedupMultiIndexStats stats;
+	BenchIndex b;
+	guint i;
+
+	if (   N > 100000
+	    && !g_test_perf ()) {
+		g_test_skip ("Skip benchmark with many objects (run with \"-m perf\")");
+		return;
+	}
+
+	for (i = 0; i < N; i++)
+		ids[i] = i;
+	for (i = N; i > 1; i--) {
+		guint j = nmtst_get_rand_uint32 () % i;
+
+		NM_SWAP (ids[i - 1], ids[j]);
+	}
+
+	_bench_index_init (&b);
+
+	g_test_timer_start ();
+	for (i = 0; i < N; i++)
+		_bench_index_add (&b, ids[i]);
+	_bench_report ("add", N, g_test_timer_elapsed ());
+
+	nm_dedup_multi_index_get_stats (b.idx, &stats);
+	g_assert_cmpint (stats.n_objs, ==, N);
+	g_test_message ("dedup-multi bench: %s backend, %zu bytes of bookkeeping per object (%u entries), plus %zu bytes for the object",
+	                NM_DEDUP_MULTI_OPEN_ADDRESSING ? "open-addressing" : "ghashtable",
+	                stats.bytes / N,
+	                stats.n_entries,
+	                sizeof (BenchObj));
+
+	g_test_timer_start ();
+	for (i = 0; i < N; i++) {
+		if (!nm_dedup_multi_index_lookup_obj (b.idx, &b.idx_type_id, BENCH_OBJ_INIT (ids[N - 1 - i])))
+			g_assert_not_reached ();
+	}
+	_bench_report ("lookup", N, g_test_timer_elapsed ());
+
+	g_test_timer_start ();
+	for (i = 0; i < N; i++) {
+		if (nm_dedup_multi_index_lookup_obj (b.idx, &b.idx_type_id, BENCH_OBJ_INIT (N + ids[i])))
+			g_assert_not_reached ();
+	}
+	_bench_report ("miss", N, g_test_timer_elapsed ());
+
+	g_test_timer_start ();
+	for (i = 0; i < N; i++) {
+		if (!_bench_index_remove (&b, ids[i]))
+			g_assert_not_reached ();
+	}
+	_bench_report ("remove", N, g_test_timer_elapsed ());
+
+	nm_dedup_multi_index_get_stats (b.idx, &stats);
+	g_assert_cmpint (stats.n_objs, ==, 0);
+	g_assert_cmpint (stats.n_entries, ==, 0);
+
+	_bench_index_clear (&b);
+}
+
+/*****************************************************************************/
+
+NMTST_DEFINE ();
+
+int
+main (int argc, char **argv)
+{
+	nmtst_init (&argc, &argv, TRUE);
+
+	g_test_add_func ("/dedup-multi/consistency", test_dedup_multi_consistency);
+	g_test_add_data_func ("/dedup-multi/bench/10000", GUINT_TO_POINTER (10000), test_dedup_multi_bench);
+	g_test_add_data_func ("/dedup-multi/bench/1000000", GUINT_TO_POINTER (1000000), test_dedup_multi_bench);
+
+	return g_test_run ();
+}
@@ -0,0 +1,289 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Copyright (C) 2020 Red Hat, Inc.
+ */
+
+#include "nm-default.h"
+
+#include "nm-activation-queue.h"
+
+#include "nm-core-utils.h"
+
+/*****************************************************************************/
+
+/* Activation stages are not scheduled with one idle source per device.
+ * Instead, all scheduled stages are queued and dispatched from a single
+ * idle source. One dispatch invokes at most @batch_max entries, so that
+ * other events get processed in between, even when thousands of devices
+ * activate at the same time. Later stages are dispatched first, to
+ * complete in-flight activations before starting new ones. Entries that
+ * get queued during a dispatch for a stage that was already handled are
+ * invoked by the next one. */
+
+/* histogram buckets: <1ms, <2ms, <4ms, ..., <1024ms, >=1024ms */
+#define HIST_N 12
+
+typedef struct {
+	guint64 wait[HIST_N];
+	guint64 run[HIST_N];
+	guint n_since_report;
+} StageHist;
+
+struct _NMActivationQueue {
+	NMActivationQueueInvokeFunc invoke_func;
+	NMActivationQueueBatchFunc batch_func;
+	NMActivationQueueStageToStringFunc stage_to_string;
+	gpointer user_data;
+	GSource *source;
+	guint n_stages;
+	guint batch_max;
+	guint n_queued;
+	StageHist *hists;
+	CList lst_heads[];
+};
+
+/*****************************************************************************/
+
+static guint
+_hist_bucket (gint64 duration_usec)
+{
+	guint64 msec = duration_usec > 0 ? ((guint64) duration_usec) / 1000u : 0u;
+	guint i;
+
+	for (i = 0; i < HIST_N - 1; i++) {
+		if (msec < (((guint64) 1u) << i))
+			return i;
+	}
+	return HIST_N - 1;
+}
+
+static const char *
+_hist_to_string (const guint64 *buckets, char *buf, gsize len)
+{
+	char *buf0 = buf;
+	guint i;
+
+	buf[0] = '\0';
+	for (i = 0; i < HIST_N; i++) {
+		if (buckets[i] == 0)
+			continue;
+		nm_utils_strbuf_append (&buf, &len,
+		                        "%s%s%"G_GUINT64_FORMAT"ms:%"G_GUINT64_FORMAT,
+		                        buf == buf0 ? "" : " ",
+		                        i < HIST_N - 1 ? "<" : ">=",
+		                          i < HIST_N - 1
+		                        ? (((guint64) 1u) << i)
+		                        : (((guint64) 1u) << (HIST_N - 2)),
+		                        buckets[i]);
+	}
+	return buf0;
+}
+
+static void
+_report (NMActivationQueue *self)
+{
+	char buf1[300];
+	char buf2[300];
+	guint stage;
+
+	if (!nm_logging_enabled (LOGL_DEBUG, LOGD_DEVICE))
+		return;
+
+	/* the histograms are cumulative. We log them whenever the queue
+	 * drains, if there were any stages invoked since the last time. */
+	for (stage = 0; stage < self->n_stages; stage++) {
+		StageHist *hist = &self->hists[stage];
+
+		if (hist->n_since_report == 0)
+			continue;
+		hist->n_since_report = 0;
+		nm_log_dbg (LOGD_DEVICE, "activation-queue: %s: waited [%s], ran [%s]",
+		            self->stage_to_string (stage),
+		            _hist_to_string (hist->wait, buf1, sizeof (buf1)),
+		            _hist_to_string (hist->run, buf2, sizeof (buf2)));
+	}
+}
+
+/*****************************************************************************/
+
+static gboolean _dispatch_cb (gpointer user_data);
+
+static void
+_schedule (NMActivationQueue *self)
+{
+	if (   self->source
+	    || self->n_queued == 0)
+		return;
+
+	self->source = nm_g_source_attach (nm_g_idle_source_new (G_PRIORITY_DEFAULT_IDLE,
+	                                                         _dispatch_cb,
+	                                                         self,
+	                                                         NULL),
+	                                   NULL);
+}
+
+static void
+_invoke (NMActivationQueue *self, NMActivationQueueEntry *entry)
+{
+	StageHist *hist = &self->hists[entry->stage];
+	gint64 now_usec;
+
+	nm_assert (self->n_queued > 0);
+
+	c_list_unlink (&entry->lst);
+	self->n_queued--;
+
+	now_usec = nm_utils_get_monotonic_timestamp_usec ();
+	hist->wait[_hist_bucket (now_usec - entry->queued_at_usec)]++;
+	hist->n_since_report++;
+
+	/* the entry might get freed or queued again by the callback. */
+	self->invoke_func (entry, self->user_data);
+
+	hist->run[_hist_bucket (nm_utils_get_monotonic_timestamp_usec () - now_usec)]++;
+}
+
+static gboolean
+_dispatch_cb (gpointer user_data)
+{
+	NMActivationQueue *self = user_data;
+	CList batch = C_LIST_INIT (batch);
+	NMActivationQueueEntry *entry;
+	guint n_budget = self->batch_max;
+	guint stage;
+
+	nm_clear_g_source_inst (&self->source);
+
+	nm_log_trace (LOGD_DEVICE, "activation-queue: dispatch (%u queued)",
+	              self->n_queued);
+
+	for (stage = self->n_stages; stage > 0 && n_budget > 0; ) {
+		stage--;
+
+		/* Take the entries that we are going to invoke now. Entries that
+		 * get queued for this stage meanwhile are invoked by the next
+		 * dispatch. */
+		while (   n_budget > 0
+		       && (entry = c_list_first_entry (&self->lst_heads[stage], NMActivationQueueEntry, lst))) {
+			c_list_unlink (&entry->lst);
+			c_list_link_tail (&batch, &entry->lst);
+			n_budget--;
+		}
+
+		if (c_list_is_empty (&batch))
+			continue;
+
+		if (self->batch_func)
+			self->batch_func (stage, &batch, self->user_data);
+
+		/* the other entries of the batch might get removed or queued
+		 * again while we invoke it. */
+		while ((entry = c_list_first_entry (&batch, NMActivationQueueEntry, lst)))
+			_invoke (self, entry);
+	}
+
+	if (self->n_queued > 0)
+		_schedule (self);
+	else
+		_report (self);
+
+	return G_SOURCE_CONTINUE;
+}
+
+/*****************************************************************************/
+
+/**
+ * nm_activation_queue_add:
+ * @self: the queue
+ * @entry: the entry to queue. If it is already queued, it is moved
+ *   to the tail of @stage.
+ * @stage: the stage of the entry.
+ */
+void
+nm_activation_queue_add (NMActivationQueue *self,
+                         NMActivationQueueEntry *entry,
+                         guint stage)
+{
+	nm_assert (self);
+	nm_assert (stage < self->n_stages);
+
+	if (c_list_is_linked (&entry->lst))
+		c_list_unlink (&entry->lst);
+	else
+		self->n_queued++;
+
+	entry->stage = stage;
+	entry->queued_at_usec = nm_utils_get_monotonic_timestamp_usec ();
+	c_list_link_tail (&self->lst_heads[stage], &entry->lst);
+
+	_schedule (self);
+}
+
+void
+nm_activation_queue_remove (NMActivationQueue *self,
+                            NMActivationQueueEntry *entry)
+{
+	nm_assert (self);
+
+	if (!c_list_is_linked (&entry->lst))
+		return;
+
+	nm_assert (self->n_queued > 0);
+	c_list_unlink (&entry->lst);
+	self->n_queued--;
+}
+
+guint
+nm_activation_queue_get_n_queued (NMActivationQueue *self)
+{
+	return self->n_queued;
+}
+
+/*****************************************************************************/
+
+NMActivationQueue *
+nm_activation_queue_new (guint n_stages,
+                         guint batch_max,
+                         NMActivationQueueInvokeFunc invoke_func,
+                         NMActivationQueueBatchFunc batch_func,
+                         NMActivationQueueStageToStringFunc stage_to_string,
+                         gpointer user_data)
+{
+	NMActivationQueue *self;
+	guint stage;
+
+	g_return_val_if_fail (n_stages > 0, NULL);
+	g_return_val_if_fail (batch_max > 0, NULL);
+	g_return_val_if_fail (invoke_func, NULL);
+	g_return_val_if_fail (stage_to_string, NULL);
+
+	self = g_malloc0 (sizeof (NMActivationQueue) + (sizeof (CList) * n_stages));
+	self->n_stages = n_stages;
+	self->batch_max = batch_max;
+	self->invoke_func = invoke_func;
+	self->batch_func = batch_func;
+	self->stage_to_string = stage_to_string;
+	self->user_data = user_data;
+	self->hists = g_new0 (StageHist, n_stages);
+	for (stage = 0; stage < n_stages; stage++)
+		c_list_init (&self->lst_heads[stage]);
+	return self;
+}
+
+void
+nm_activation_queue_free (NMActivationQueue *self)
+{
+	NMActivationQueueEntry *entry;
+	guint stage;
+
+	if (!self)
+		return;
+
+	for (stage = 0; stage < self->n_stages; stage++) {
+		while ((entry = c_list_first_entry (&self->lst_heads[stage], NMActivationQueueEntry, lst)))
+			c_list_unlink (&entry->lst);
+	}
+	nm_clear_g_source_inst (&self->source);
+	g_free (self->hists);
+	g_free (self);
+}
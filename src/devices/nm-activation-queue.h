@@ -0,0 +1,64 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Copyright (C) 2020 Red Hat, Inc.
+ */
+
+#ifndef __NM_ACTIVATION_QUEUE_H__
+#define __NM_ACTIVATION_QUEUE_H__
+
+#include "c-list/src/c-list.h"
+
+/* One dispatch invokes at most that many entries. */
+#define NM_ACTIVATION_QUEUE_BATCH_MAX 64
+
+typedef struct _NMActivationQueue NMActivationQueue;
+
+typedef struct {
+	CList lst;
+	gint64 queued_at_usec;
+	guint stage;
+} NMActivationQueueEntry;
+
+/* Invoked for each entry, after it was removed from the queue. */
+typedef void (*NMActivationQueueInvokeFunc) (NMActivationQueueEntry *entry,
+                                             gpointer user_data);
+
+/* Invoked with the entries of one stage that are about to be invoked
+ * in this dispatch, before invoking any of them. */
+typedef void (*NMActivationQueueBatchFunc) (guint stage,
+                                            CList *batch,
+                                            gpointer user_data);
+
+typedef const char *(*NMActivationQueueStageToStringFunc) (guint stage);
+
+NMActivationQueue *nm_activation_queue_new (guint n_stages,
+                                            guint batch_max,
+                                            NMActivationQueueInvokeFunc invoke_func,
+                                            NMActivationQueueBatchFunc batch_func,
+                                            NMActivationQueueStageToStringFunc stage_to_string,
+                                            gpointer user_data);
+
+void nm_activation_queue_free (NMActivationQueue *self);
+
+static inline void
+nm_activation_queue_entry_init (NMActivationQueueEntry *entry)
+{
+	c_list_init (&entry->lst);
+}
+
+static inline gboolean
+nm_activation_queue_entry_is_queued (const NMActivationQueueEntry *entry)
+{
+	return c_list_is_linked (&entry->lst);
+}
+
+void nm_activation_queue_add (NMActivationQueue *self,
+                              NMActivationQueueEntry *entry,
+                              guint stage);
+
+void nm_activation_queue_remove (NMActivationQueue *self,
+                                 NMActivationQueueEntry *entry);
+
+guint nm_activation_queue_get_n_queued (NMActivationQueue *self);
+
+#endif /* __NM_ACTIVATION_QUEUE_H__ */
@@ -402,6 +402,28 @@ check_connection_compatible (NMDevice *device, NMConnection *connection, GError
 	return TRUE;
 }
 
+static void
+get_autoconnect_lookup (NMDevice *device, NMSettingsAutoconnectLookup *lookup)
+{
+	/* the types that check_connection_compatible() accepts. */
+	static const char *const types[] = {
+		NM_SETTING_WIRED_SETTING_NAME,
+		NM_SETTING_PPPOE_SETTING_NAME,
+		NULL,
+	};
+
+	NM_DEVICE_CLASS (nm_device_ethernet_parent_class)->get_autoconnect_lookup (device, lookup);
+
+	if (!lookup->type)
+		lookup->types = types;
+
+	/* without permanent MAC address, check_connection_compatible() rejects
+	 * profiles with a MAC address. That is not expressed by the lookup,
+	 * which is fine: it only needs to return a superset of the compatible
+	 * profiles. */
+	lookup->hwaddr = nm_device_get_permanent_hw_address (device);
+}
+
 /*****************************************************************************/
 /* 802.1X */
 
@@ -1967,6 +1989,7 @@ nm_device_ethernet_class_init (NMDeviceEthernetClass *klass)
 
 	device_class->get_generic_capabilities = get_generic_capabilities;
 	device_class->check_connection_compatible = check_connection_compatible;
+	device_class->get_autoconnect_lookup = get_autoconnect_lookup;
 	device_class->complete_connection = complete_connection;
 	device_class->new_default_connection = new_default_connection;
 
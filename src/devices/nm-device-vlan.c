@@ -355,6 +355,27 @@ check_connection_compatible (NMDevice *device, NMConnection *connection, GError
 	return TRUE;
 }
 
+static void
+get_autoconnect_lookup (NMDevice *device, NMSettingsAutoconnectLookup *lookup)
+{
+	NMDeviceVlanPrivate *priv = NM_DEVICE_VLAN_GET_PRIVATE (device);
+	NMDevice *parent_device;
+
+	NM_DEVICE_CLASS (nm_device_vlan_parent_class)->get_autoconnect_lookup (device, lookup);
+
+	/* check_connection_compatible() only checks the id and the parent
+	 * of real devices. */
+	if (!nm_device_is_real (device))
+		return;
+
+	lookup->vlan_id = priv->vlan_id;
+	lookup->vlan_id_has = TRUE;
+
+	parent_device = nm_device_parent_get_device (device);
+	if (parent_device)
+		lookup->parent = nm_device_get_ip_iface (parent_device);
+}
+
 static gboolean
 check_connection_available (NMDevice *device,
                             NMConnection *connection,
@@ -570,6 +591,7 @@ nm_device_vlan_class_init (NMDeviceVlanClass *klass)
 	device_class->parent_changed_notify = parent_changed_notify;
 
 	device_class->check_connection_compatible = check_connection_compatible;
+	device_class->get_autoconnect_lookup = get_autoconnect_lookup;
 	device_class->check_connection_available = check_connection_available;
 	device_class->complete_connection = complete_connection;
 	device_class->update_connection = update_connection;
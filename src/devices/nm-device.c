@@ -59,6 +59,7 @@
 #include "c-list/src/c-list.h"
 #include "dns/nm-dns-manager.h"
 #include "nm-acd-manager.h"
+#include "nm-activation-queue.h"
 #include "nm-core-internal.h"
 #include "systemd/nm-sd.h"
 #include "nm-lldp-listener.h"
@@ -102,6 +103,12 @@ dhcp_grace_period_from_timeout (guint32 timeout)
 
 typedef void (*ActivationHandleFunc) (NMDevice *self);
 
+typedef struct {
+	NMActivationQueueEntry base;
+	NMDevice *self;
+	int addr_family;
+} ActivationQueueEntry;
+
 typedef enum {
 	CLEANUP_TYPE_KEEP,
 	CLEANUP_TYPE_REMOVED,
@@ -159,6 +166,21 @@ typedef struct {
 	                          that the original configuration didn't change. */
 } AppliedConfig;
 
+typedef struct {
+	/* Routes on the IP interface that changed in platform since the external
+	 * configuration was last updated. */
+	GHashTable *changed_routes;
+	/* Digest of the internal configurations at the last update. If they change,
+	 * parts that were subtracted from the external configuration might become
+	 * external again, and we must capture everything. */
+	guint8 internal_digest[NM_UTILS_CHECKSUM_LENGTH_SHA1];
+	int ifindex;
+	bool addresses_changed:1;
+	bool need_full:1;
+	/* set while we flush the pending route changes from platform. */
+	bool flushing:1;
+} ExtIPCapture;
+
 typedef struct {
 	NMDhcpClient *client;
 	NMDhcpConfig *config;
@@ -358,6 +380,13 @@ typedef struct _NMDevicePrivate {
 		ActivationHandleFunc activation_source_func_x[2];
 	};
 
+	/* the entries in the activation queue, indexed like activation_source_func_x. */
+	ActivationQueueEntry activation_queue_x[2];
+
+	/* the link was already brought up by the activation queue for the
+	 * pending activate_stage2_device_link_up(). */
+	bool activation_link_up_done:1;
+
 	guint           recheck_assume_id;
 
 	struct {
@@ -426,6 +455,7 @@ typedef struct _NMDevicePrivate {
 	bool            concheck_rp_filter_checked:1;
 
 	NMDeviceStageState stage1_sriov_state:3;
+	NMDeviceStageState stage1_ethtool_state:3;
 
 	/* Generic DHCP stuff */
 	char *          dhcp_anycast_address;
@@ -466,6 +496,19 @@ typedef struct _NMDevicePrivate {
 		NMIPConfig *ext_ip_config_x[2];
 	};
 
+	/* Configuration captured from platform, before subtracting the parts
+	 * that NM configured itself. */
+	union {
+		struct {
+			NMIP6Config *ext_ip6_config_captured;
+			NMIP4Config *ext_ip4_config_captured;
+		};
+		NMIPConfig *ext_ip_config_captured_x[2];
+	};
+
+	/* Changes to platform objects since the last capture */
+	ExtIPCapture ext_ip_capture_x[2];
+
 	/* VPNs which use this device */
 	union {
 		struct {
@@ -551,7 +594,6 @@ typedef struct _NMDevicePrivate {
 	};
 
 	AppliedConfig  ac_ip6_config;  /* config from IPv6 autoconfiguration */
-	NMIP6Config *  ext_ip6_config_captured; /* Configuration captured from platform. */
 	NMIP6Config *  dad6_ip6_config;
 	struct in6_addr ipv6ll_addr;
 
@@ -568,6 +610,7 @@ typedef struct _NMDevicePrivate {
 	GHashTable *   ip6_saved_properties;
 
 	EthtoolState  *ethtool_state;
+	GCancellable  *ethtool_query_cancellable;
 
 	gboolean needs_ip6_subnet;
 
@@ -657,6 +700,8 @@ static void _carrier_wait_check_queued_act_request (NMDevice *self);
 static gint64 _get_carrier_wait_ms (NMDevice *self);
 
 static const char *_activation_func_to_string (ActivationHandleFunc func);
+static const char *_activation_stage_to_string (guint stage);
+static guint _activation_func_to_stage (ActivationHandleFunc func);
 
 static void _set_state_full (NMDevice *self,
                              NMDeviceState state,
@@ -686,6 +731,8 @@ static void concheck_update_state (NMDevice *self,
                                    NMConnectivityState state,
                                    gboolean is_periodic);
 
+static void activate_stage2_device_link_up (NMDevice *self);
+
 static void activate_stage4_ip_config_timeout_4 (NMDevice *self);
 static void activate_stage4_ip_config_timeout_6 (NMDevice *self);
 
@@ -5992,6 +6039,37 @@ nm_device_can_auto_connect (NMDevice *self,
 	return TRUE;
 }
 
+static void
+get_autoconnect_lookup (NMDevice *self,
+                        NMSettingsAutoconnectLookup *lookup)
+{
+	/* check_connection_compatible() rejects profiles of other types and profiles
+	 * that pin another interface name. */
+	*lookup = (NMSettingsAutoconnectLookup) {
+		.type   = NM_DEVICE_GET_CLASS (self)->connection_type_check_compatible,
+		.ifname = nm_device_get_iface (self),
+	};
+}
+
+/**
+ * nm_device_get_autoconnect_lookup:
+ * @self: the #NMDevice
+ * @lookup: (out): the lookup to initialize
+ *
+ * Fills @lookup, so that nm_settings_get_autoconnect_candidates() returns
+ * all profiles that may be compatible with @self, but ideally not many more.
+ * The strings in @lookup are owned by @self.
+ */
+void
+nm_device_get_autoconnect_lookup (NMDevice *self,
+                                  NMSettingsAutoconnectLookup *lookup)
+{
+	g_return_if_fail (NM_IS_DEVICE (self));
+	g_return_if_fail (lookup);
+
+	NM_DEVICE_GET_CLASS (self)->get_autoconnect_lookup (self, lookup);
+}
+
 static gboolean
 device_has_config (NMDevice *self)
 {
@@ -6472,15 +6550,32 @@ check_connection_compatible (NMDevice *self, NMConnection *connection, GError **
  * Returns: #TRUE if @connection could potentially be activated on
  *   @self.
  */
+static guint64 _check_connection_compatible_count;
+
 gboolean
 nm_device_check_connection_compatible (NMDevice *self, NMConnection *connection, GError **error)
 {
 	g_return_val_if_fail (NM_IS_DEVICE (self), FALSE);
 	g_return_val_if_fail (NM_IS_CONNECTION (connection), FALSE);
 
+	_check_connection_compatible_count++;
+
 	return NM_DEVICE_GET_CLASS (self)->check_connection_compatible (self, connection, error);
 }
 
+/**
+ * nm_device_check_connection_compatible_get_count:
+ *
+ * Returns: the number of nm_device_check_connection_compatible() calls so far,
+ *   for all devices. This is for debugging the cost of matching profiles
+ *   to devices.
+ */
+guint64
+nm_device_check_connection_compatible_get_count (void)
+{
+	return _check_connection_compatible_count;
+}
+
 gboolean
 nm_device_check_slave_connection_compatible (NMDevice *self, NMConnection *slave)
 {
@@ -6684,6 +6779,42 @@ nm_device_auth_request (NMDevice *self,
 
 /*****************************************************************************/
 
+/* The scheduled activation stages of all devices are dispatched from one
+ * NMActivationQueue. The devices that reach activate_stage2_device_link_up()
+ * in the same dispatch are brought up with one netlink burst (see
+ * _activation_queue_bring_up_many()). */
+
+typedef enum {
+	ACTIVATION_STAGE_1_DEVICE_PREPARE,
+	ACTIVATION_STAGE_2_DEVICE_CONFIG,
+	ACTIVATION_STAGE_2_DEVICE_LINK_UP,
+	ACTIVATION_STAGE_3_IP_CONFIG_START,
+	ACTIVATION_STAGE_4_IP_CONFIG_TIMEOUT_4,
+	ACTIVATION_STAGE_4_IP_CONFIG_TIMEOUT_6,
+	ACTIVATION_STAGE_5_IP_CONFIG_RESULT_4,
+	ACTIVATION_STAGE_5_IP_CONFIG_RESULT_6,
+	_ACTIVATION_STAGE_NUM,
+} ActivationStage;
+
+static void activation_source_handle (NMActivationQueueEntry *base, gpointer user_data);
+static void _activation_queue_bring_up_many (guint stage, CList *batch, gpointer user_data);
+
+static NMActivationQueue *
+_activation_queue_get (void)
+{
+	static NMActivationQueue *queue;
+
+	if (G_UNLIKELY (!queue)) {
+		queue = nm_activation_queue_new (_ACTIVATION_STAGE_NUM,
+		                                 NM_ACTIVATION_QUEUE_BATCH_MAX,
+		                                 activation_source_handle,
+		                                 _activation_queue_bring_up_many,
+		                                 _activation_stage_to_string,
+		                                 NULL);
+	}
+	return queue;
+}
+
 static void
 activation_source_clear (NMDevice *self,
                          int addr_family)
@@ -6696,28 +6827,30 @@ activation_source_clear (NMDevice *self,
 		       _activation_func_to_string (priv->activation_source_func_x[IS_IPv4]),
 		       nm_utils_addr_family_to_char (addr_family),
 		       priv->activation_source_id_x[IS_IPv4]);
-		nm_clear_g_source (&priv->activation_source_id_x[IS_IPv4]);
+		nm_activation_queue_remove (_activation_queue_get (),
+		                            &priv->activation_queue_x[IS_IPv4].base);
+		priv->activation_source_id_x[IS_IPv4] = 0;
 		priv->activation_source_func_x[IS_IPv4] = NULL;
 	}
+	if (IS_IPv4)
+		priv->activation_link_up_done = FALSE;
 }
 
-static gboolean
-activation_source_handle_cb (NMDevice *self,
-                             int addr_family)
+static void
+activation_source_handle (NMActivationQueueEntry *base, gpointer user_data)
 {
-	NMDevicePrivate *priv;
+	ActivationQueueEntry *entry = (ActivationQueueEntry *) base;
+	NMDevice *self = entry->self;
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	const int addr_family = entry->addr_family;
 	const gboolean IS_IPv4 = (addr_family == AF_INET);
 	ActivationHandleFunc activation_source_func;
 	guint activation_source_id;
 
-	g_return_val_if_fail (NM_IS_DEVICE (self), G_SOURCE_REMOVE);
-
-	priv = NM_DEVICE_GET_PRIVATE (self);
-
 	activation_source_func = priv->activation_source_func_x[IS_IPv4];
 	activation_source_id = priv->activation_source_id_x[IS_IPv4];
 
-	g_return_val_if_fail (activation_source_id != 0, G_SOURCE_REMOVE);
+	nm_assert (activation_source_id != 0);
 	nm_assert (activation_source_func);
 
 	priv->activation_source_func_x[IS_IPv4] = NULL;
@@ -6728,6 +6861,8 @@ activation_source_handle_cb (NMDevice *self,
 	       nm_utils_addr_family_to_char (addr_family),
 	       activation_source_id);
 
+	g_object_ref (self);
+
 	activation_source_func (self);
 
 	_LOGT (LOGD_DEVICE, "activation-stage: complete %s,v%c (id %u)",
@@ -6735,19 +6870,76 @@ activation_source_handle_cb (NMDevice *self,
 	       nm_utils_addr_family_to_char (addr_family),
 	       activation_source_id);
 
-	return G_SOURCE_REMOVE;
-}
+	if (IS_IPv4) {
+		/* only valid for the stage that was just invoked. */
+		priv->activation_link_up_done = FALSE;
+	}
 
-static gboolean
-activation_source_handle_cb_4 (gpointer user_data)
-{
-	return activation_source_handle_cb (user_data, AF_INET);
+	g_object_unref (self);
 }
 
-static gboolean
-activation_source_handle_cb_6 (gpointer user_data)
-{
-	return activation_source_handle_cb (user_data, AF_INET6);
+/* Bring up the links of all devices in @batch that are about to do so
+ * in activate_stage2_device_link_up(), with one request per device but
+ * without waiting for each response in turn. nm_device_bring_up() then
+ * skips the request for these devices. */
+static void
+_activation_queue_bring_up_many (guint stage, CList *batch, gpointer user_data)
+{
+	gs_free int *ifindexes = NULL;
+	gs_free int *results = NULL;
+	gs_free NMDevice **devices = NULL;
+	NMActivationQueueEntry *base;
+	NMPlatform *platform = NULL;
+	guint len = 0;
+	guint i;
+
+	if (stage != ACTIVATION_STAGE_2_DEVICE_LINK_UP)
+		return;
+
+	c_list_for_each_entry (base, batch, lst) {
+		NMDevice *self = ((ActivationQueueEntry *) base)->self;
+		int ifindex;
+
+		if (   !nm_device_get_enabled (self)
+		    || nm_device_sys_iface_state_is_external_or_assume (self))
+			continue;
+
+		ifindex = nm_device_get_ip_ifindex (self);
+		if (ifindex <= 0)
+			continue;
+
+		/* in practice, all devices share the same platform instance. Devices
+		 * of other instances are brought up the normal way. */
+		if (!platform)
+			platform = nm_device_get_platform (self);
+		else if (platform != nm_device_get_platform (self))
+			continue;
+
+		if (!devices) {
+			devices = g_new (NMDevice *, NM_ACTIVATION_QUEUE_BATCH_MAX);
+			ifindexes = g_new (int, NM_ACTIVATION_QUEUE_BATCH_MAX);
+		}
+		nm_assert (len < NM_ACTIVATION_QUEUE_BATCH_MAX);
+		devices[len] = self;
+		ifindexes[len] = ifindex;
+		len++;
+	}
+
+	if (len < 2) {
+		/* nothing to gain. nm_device_bring_up() does it, at the same
+		 * point of the activation. */
+		return;
+	}
+
+	results = g_new (int, len);
+	nm_platform_link_set_up_many (platform, ifindexes, len, results);
+
+	for (i = 0; i < len; i++) {
+		/* on failure, let nm_device_bring_up() retry it and report
+		 * the error. */
+		if (results[i] >= 0)
+			NM_DEVICE_GET_PRIVATE (devices[i])->activation_link_up_done = TRUE;
+	}
 }
 
 static void
@@ -6755,7 +6947,8 @@ activation_source_schedule (NMDevice *self, ActivationHandleFunc func, int addr_
 {
 	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
 	const gboolean IS_IPv4 = (addr_family == AF_INET);
-	guint new_id = 0;
+	guint new_id;
+	static guint id_counter = 1;
 
 	if (   priv->activation_source_id_x[IS_IPv4] != 0
 	    && priv->activation_source_func_x[IS_IPv4] == func) {
@@ -6767,10 +6960,9 @@ activation_source_schedule (NMDevice *self, ActivationHandleFunc func, int addr_
 		return;
 	}
 
-	new_id = g_idle_add (  IS_IPv4
-	                     ? activation_source_handle_cb_4
-	                     : activation_source_handle_cb_6,
-	                     self);
+	new_id = id_counter++;
+	if (G_UNLIKELY (id_counter == 0))
+		id_counter = 1;
 
 	if (priv->activation_source_id_x[IS_IPv4] != 0) {
 		_LOGD (LOGD_DEVICE, "activation-stage: schedule %s,v%c which replaces %s,v%c (id %u -> %u)",
@@ -6779,7 +6971,8 @@ activation_source_schedule (NMDevice *self, ActivationHandleFunc func, int addr_
 		       _activation_func_to_string (priv->activation_source_func_x[IS_IPv4]),
 		       nm_utils_addr_family_to_char (addr_family),
 		       priv->activation_source_id_x[IS_IPv4], new_id);
-		nm_clear_g_source (&priv->activation_source_id_x[IS_IPv4]);
+		if (IS_IPv4)
+			priv->activation_link_up_done = FALSE;
 	} else {
 		_LOGD (LOGD_DEVICE, "activation-stage: schedule %s,v%c (id %u)",
 		       _activation_func_to_string (func),
@@ -6789,6 +6982,10 @@ activation_source_schedule (NMDevice *self, ActivationHandleFunc func, int addr_
 
 	priv->activation_source_func_x[IS_IPv4] = func;
 	priv->activation_source_id_x[IS_IPv4] = new_id;
+
+	nm_activation_queue_add (_activation_queue_get (),
+	                         &priv->activation_queue_x[IS_IPv4].base,
+	                         _activation_func_to_stage (func));
 }
 
 static void
@@ -6815,7 +7012,11 @@ activation_source_invoke_sync (NMDevice *self, ActivationHandleFunc func, int ad
 		       priv->activation_source_id_x[IS_IPv4]);
 	}
 
-	nm_clear_g_source (&priv->activation_source_id_x[IS_IPv4]);
+	if (priv->activation_source_id_x[IS_IPv4] != 0) {
+		nm_activation_queue_remove (_activation_queue_get (),
+		                            &priv->activation_queue_x[IS_IPv4].base);
+		priv->activation_source_id_x[IS_IPv4] = 0;
+	}
 	priv->activation_source_func_x[IS_IPv4] = NULL;
 
 	func (self);
@@ -7012,6 +7213,28 @@ sriov_params_cb (GError *error, gpointer data)
 	nm_device_activate_schedule_stage1_device_prepare (self, FALSE);
 }
 
+static void
+_ethtool_query_cb (GError *error, gpointer user_data)
+{
+	NMDevice *self = user_data;
+	NMDevicePrivate *priv;
+
+	if (nm_utils_error_is_cancelled (error))
+		return;
+
+	priv = NM_DEVICE_GET_PRIVATE (self);
+
+	g_clear_object (&priv->ethtool_query_cancellable);
+
+	/* not fatal. Stage 2 reads the settings again, if they are not cached. */
+	if (error)
+		_LOGD (LOGD_DEVICE, "ethtool: failed to query the current settings: %s", error->message);
+
+	priv->stage1_ethtool_state = NM_DEVICE_STAGE_STATE_COMPLETED;
+
+	nm_device_activate_schedule_stage1_device_prepare (self, FALSE);
+}
+
 /*
  * activate_stage1_device_prepare
  *
@@ -7098,6 +7321,32 @@ activate_stage1_device_prepare (NMDevice *self)
 		priv->stage1_sriov_state = NM_DEVICE_STAGE_STATE_COMPLETED;
 	}
 
+	if (priv->stage1_ethtool_state != NM_DEVICE_STAGE_STATE_COMPLETED) {
+		int ip_ifindex = nm_device_get_ip_ifindex (self);
+
+		if (priv->stage1_ethtool_state == NM_DEVICE_STAGE_STATE_PENDING)
+			return;
+		else if (   ip_ifindex > 0
+		         && !nm_device_sys_iface_state_is_external_or_assume (self)
+		         && nm_device_get_applied_setting (self, NM_TYPE_SETTING_ETHTOOL)) {
+			/* stage 2 reads the current features, coalesce and ring settings
+			 * before applying the ones of the profile. Fetch them on a worker
+			 * thread, so that a slow driver does not block us. */
+			priv->ethtool_query_cancellable = g_cancellable_new ();
+			nm_platform_link_ethtool_query_async (nm_device_get_platform (self),
+			                                      ip_ifindex,
+			                                        NM_PLATFORM_ETHTOOL_QUERY_FEATURES
+			                                      | NM_PLATFORM_ETHTOOL_QUERY_COALESCE
+			                                      | NM_PLATFORM_ETHTOOL_QUERY_RING,
+			                                      _ethtool_query_cb,
+			                                      self,
+			                                      priv->ethtool_query_cancellable);
+			priv->stage1_ethtool_state = NM_DEVICE_STAGE_STATE_PENDING;
+			return;
+		}
+		priv->stage1_ethtool_state = NM_DEVICE_STAGE_STATE_COMPLETED;
+	}
+
 	/* Assumed connections were already set up outside NetworkManager */
 	klass = NM_DEVICE_GET_CLASS (self);
 
@@ -7360,12 +7609,6 @@ tc_commit (NMDevice *self)
 static void
 activate_stage2_device_config (NMDevice *self)
 {
-	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
-	NMDeviceClass *klass;
-	NMActStageReturn ret;
-	gboolean no_firmware = FALSE;
-	CList *iter;
-
 	nm_device_state_changed (self, NM_DEVICE_STATE_CONFIG, NM_DEVICE_STATE_REASON_NONE);
 
 	if (!nm_device_sys_iface_state_is_external_or_assume (self))
@@ -7381,6 +7624,32 @@ activate_stage2_device_config (NMDevice *self)
 
 	_routing_rules_sync (self, NM_TERNARY_TRUE);
 
+	if (!nm_device_sys_iface_state_is_external_or_assume (self)) {
+		/* bringing up the link is a stage of its own, so that the activation
+		 * queue can do it for many devices at once. */
+		activation_source_schedule (self, activate_stage2_device_link_up, AF_INET);
+		return;
+	}
+
+	activate_stage2_device_link_up (self);
+}
+
+/*
+ * activate_stage2_device_link_up
+ *
+ * The second part of stage 2: bring up the link and let the device
+ * type do its configuration.
+ *
+ */
+static void
+activate_stage2_device_link_up (NMDevice *self)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	NMDeviceClass *klass;
+	NMActStageReturn ret;
+	gboolean no_firmware = FALSE;
+	CList *iter;
+
 	if (!nm_device_sys_iface_state_is_external_or_assume (self)) {
 		if (!nm_device_bring_up (self, FALSE, &no_firmware)) {
 			nm_device_state_changed (self,
@@ -13799,10 +14068,15 @@ nm_device_bring_up (NMDevice *self, gboolean block, gboolean *no_firmware)
 	_LOGD (LOGD_PLATFORM, "bringing up device %d", ifindex);
 	if (ifindex <= 0) {
 		/* assume success. */
+	} else if (   priv->activation_link_up_done
+	           && nm_platform_link_is_up (nm_device_get_platform (self), ifindex)) {
+		/* already brought up by the activation queue, together with
+		 * other devices. */
 	} else {
 		if (!nm_platform_link_set_up (nm_device_get_platform (self), ifindex, no_firmware))
 			return FALSE;
 	}
+	priv->activation_link_up_done = FALSE;
 
 	/* Store carrier immediately. */
 	nm_device_set_carrier_from_platform (self);
@@ -13949,8 +14223,8 @@ intersect_ext_config (NMDevice *self,
 	family = nm_ip_config_get_addr_family (config->orig);
 	penalty = default_route_metric_penalty_get (self, family);
 	ext = family == AF_INET
-	      ? (NMIPConfig *) priv->ext_ip_config_4
-	      : (NMIPConfig *) priv->ext_ip_config_6;
+	      ? (NMIPConfig *) priv->ext_ip4_config_captured
+	      : (NMIPConfig *) priv->ext_ip6_config_captured;
 
 	if (config->current) {
 		nm_ip_config_intersect (config->current,
@@ -13967,10 +14241,158 @@ intersect_ext_config (NMDevice *self,
 	}
 }
 
+/* With more changed routes than this, capturing everything again is cheaper
+ * than looking up each route. */
+#define EXT_IP_CAPTURE_CHANGED_ROUTES_MAX 10000
+
+static void
+ext_ip_capture_clear (ExtIPCapture *capture)
+{
+	nm_clear_pointer (&capture->changed_routes, g_hash_table_unref);
+	capture->addresses_changed = FALSE;
+	capture->need_full = FALSE;
+}
+
+static void
+ext_ip_capture_track (NMDevice *self, NMPObjectType obj_type, const NMPObject *obj)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	const gboolean IS_IPv4 = NM_IN_SET (obj_type, NMP_OBJECT_TYPE_IP4_ADDRESS, NMP_OBJECT_TYPE_IP4_ROUTE);
+	ExtIPCapture *capture = &priv->ext_ip_capture_x[IS_IPv4];
+
+	if (capture->need_full)
+		return;
+
+	if (NM_IN_SET (obj_type, NMP_OBJECT_TYPE_IP4_ADDRESS, NMP_OBJECT_TYPE_IP6_ADDRESS)) {
+		/* there are few addresses, and their order matters. Always capture
+		 * them all. */
+		capture->addresses_changed = TRUE;
+		return;
+	}
+
+	if (!capture->changed_routes) {
+		capture->changed_routes = g_hash_table_new_full ((GHashFunc) nmp_object_id_hash,
+		                                                 (GEqualFunc) nmp_object_id_equal,
+		                                                 (GDestroyNotify) nmp_object_unref,
+		                                                 NULL);
+	} else if (g_hash_table_size (capture->changed_routes) >= EXT_IP_CAPTURE_CHANGED_ROUTES_MAX) {
+		nm_clear_pointer (&capture->changed_routes, g_hash_table_unref);
+		capture->need_full = TRUE;
+		return;
+	}
+
+	g_hash_table_add (capture->changed_routes, (gpointer) nmp_object_ref (obj));
+}
+
+static void
+_ext_ip_capture_digest_add (GChecksum *sum, const NMIPConfig *config)
+{
+	guint8 has = !!config;
+
+	g_checksum_update (sum, &has, sizeof (has));
+	if (config)
+		nm_ip_config_hash (config, sum, FALSE);
+}
+
+static void
+ext_ip_capture_get_digest (NMDevice *self, int addr_family, guint8 *out_digest)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	const gboolean IS_IPv4 = (addr_family == AF_INET);
+	nm_auto_free_checksum GChecksum *sum = NULL;
+	guint32 penalty;
+	GSList *iter;
+
+	sum = g_checksum_new (G_CHECKSUM_SHA1);
+
+	penalty = default_route_metric_penalty_get (self, addr_family);
+	g_checksum_update (sum, (const guchar *) &penalty, sizeof (penalty));
+
+	_ext_ip_capture_digest_add (sum, priv->con_ip_config_x[IS_IPv4]);
+	if (IS_IPv4) {
+		_ext_ip_capture_digest_add (sum, priv->dev_ip_config_4.orig);
+		_ext_ip_capture_digest_add (sum, priv->dev_ip_config_4.current);
+	} else {
+		_ext_ip_capture_digest_add (sum, priv->ac_ip6_config.orig);
+		_ext_ip_capture_digest_add (sum, priv->ac_ip6_config.current);
+		_ext_ip_capture_digest_add (sum, priv->dhcp6.ip6_config.orig);
+		_ext_ip_capture_digest_add (sum, priv->dhcp6.ip6_config.current);
+	}
+	_ext_ip_capture_digest_add (sum, priv->dev2_ip_config_x[IS_IPv4].orig);
+	_ext_ip_capture_digest_add (sum, priv->dev2_ip_config_x[IS_IPv4].current);
+	for (iter = priv->vpn_configs_x[IS_IPv4]; iter; iter = iter->next)
+		_ext_ip_capture_digest_add (sum, iter->data);
+
+	nm_utils_checksum_get_digest_len (sum, out_digest, NM_UTILS_CHECKSUM_LENGTH_SHA1);
+}
+
+/* Brings the captured and the external configuration up to date by only
+ * looking at the platform objects that changed since the last update.
+ * Returns %FALSE if that is not possible, and everything must be captured
+ * again. */
+static gboolean
+ext_ip_capture_update (NMDevice *self, int addr_family, int ifindex)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	const gboolean IS_IPv4 = (addr_family == AF_INET);
+	ExtIPCapture *capture = &priv->ext_ip_capture_x[IS_IPv4];
+	NMPlatform *platform = nm_device_get_platform (self);
+	guint8 digest[NM_UTILS_CHECKSUM_LENGTH_SHA1];
+	GHashTableIter h_iter;
+	const NMPObject *obj;
+
+	if (   capture->need_full
+	    || capture->ifindex != ifindex
+	    || !priv->ext_ip_config_captured_x[IS_IPv4]
+	    || !priv->ext_ip_config_x[IS_IPv4])
+		return FALSE;
+
+	/* Slaves have no IP configuration */
+	if (nm_platform_link_get_master (platform, ifindex) > 0)
+		return FALSE;
+
+	ext_ip_capture_get_digest (self, addr_family, digest);
+	if (memcmp (digest, capture->internal_digest, sizeof (digest)) != 0)
+		return FALSE;
+
+	if (capture->addresses_changed) {
+		if (IS_IPv4) {
+			nm_ip4_config_capture_update_addresses (priv->ext_ip4_config_captured, platform);
+			nm_ip4_config_capture_update_addresses (priv->ext_ip_config_4, platform);
+		} else {
+			nm_ip6_config_capture_update_addresses (priv->ext_ip6_config_captured, platform,
+			                                        NM_SETTING_IP6_CONFIG_PRIVACY_UNKNOWN);
+			nm_ip6_config_capture_update_addresses (priv->ext_ip_config_6, platform,
+			                                        NM_SETTING_IP6_CONFIG_PRIVACY_UNKNOWN);
+		}
+	}
+
+	if (capture->changed_routes) {
+		g_hash_table_iter_init (&h_iter, capture->changed_routes);
+		while (g_hash_table_iter_next (&h_iter, (gpointer *) &obj, NULL)) {
+			if (IS_IPv4) {
+				nm_ip4_config_capture_update_route (priv->ext_ip4_config_captured, platform, obj);
+				nm_ip4_config_capture_update_route (priv->ext_ip_config_4, platform, obj);
+			} else {
+				nm_ip6_config_capture_update_route (priv->ext_ip6_config_captured, platform, obj);
+				nm_ip6_config_capture_update_route (priv->ext_ip_config_6, platform, obj);
+			}
+		}
+	}
+
+	_LOGT (LOGD_DEVICE, "ip%c: updated external configuration incrementally (%u routes changed%s)",
+	       nm_utils_addr_family_to_char (addr_family),
+	       capture->changed_routes ? g_hash_table_size (capture->changed_routes) : 0u,
+	       capture->addresses_changed ? ", addresses changed" : "");
+	return TRUE;
+}
+
 static gboolean
 update_ext_ip_config (NMDevice *self, int addr_family, gboolean intersect_configs)
 {
 	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	const gboolean IS_IPv4 = (addr_family == AF_INET);
+	ExtIPCapture *capture;
 	int ifindex;
 	GSList *iter;
 	gboolean is_up;
@@ -13983,12 +14405,39 @@ update_ext_ip_config (NMDevice *self, int addr_family, gboolean intersect_config
 
 	is_up = nm_platform_link_is_up (nm_device_get_platform (self), ifindex);
 
+	/* The route changes reach us only once per main loop iteration, but
+	 * the platform cache already has them. Get them now, otherwise the
+	 * incremental update would miss them. */
+	capture = &priv->ext_ip_capture_x[IS_IPv4];
+	capture->flushing = TRUE;
+	nm_platform_change_set_flush (nm_device_get_platform (self),
+	                              IS_IPv4 ? NMP_OBJECT_TYPE_IP4_ROUTE : NMP_OBJECT_TYPE_IP6_ROUTE,
+	                              ifindex);
+	capture->flushing = FALSE;
+
+	if (!ext_ip_capture_update (self, addr_family, ifindex)) {
+		if (IS_IPv4) {
+			g_clear_object (&priv->ext_ip_config_4);
+			g_clear_object (&priv->ext_ip4_config_captured);
+			priv->ext_ip4_config_captured = nm_ip4_config_capture (nm_device_get_multi_index (self),
+			                                                       nm_device_get_platform (self),
+			                                                       ifindex);
+			if (priv->ext_ip4_config_captured)
+				priv->ext_ip_config_4 = nm_ip4_config_new_cloned (priv->ext_ip4_config_captured);
+		} else {
+			g_clear_object (&priv->ext_ip_config_6);
+			g_clear_object (&priv->ext_ip6_config_captured);
+			priv->ext_ip6_config_captured = nm_ip6_config_capture (nm_device_get_multi_index (self),
+			                                                       nm_device_get_platform (self),
+			                                                       ifindex,
+			                                                       NM_SETTING_IP6_CONFIG_PRIVACY_UNKNOWN);
+			if (priv->ext_ip6_config_captured)
+				priv->ext_ip_config_6 = nm_ip6_config_new_cloned (priv->ext_ip6_config_captured);
+		}
+	}
+
 	if (addr_family == AF_INET) {
 
-		g_clear_object (&priv->ext_ip_config_4);
-		priv->ext_ip_config_4 = nm_ip4_config_capture (nm_device_get_multi_index (self),
-		                                              nm_device_get_platform (self),
-		                                              ifindex);
 		if (priv->ext_ip_config_4) {
 			if (intersect_configs) {
 				/* This function was called upon external changes. Remove the configuration
@@ -13996,7 +14445,7 @@ update_ext_ip_config (NMDevice *self, int addr_family, gboolean intersect_config
 				 * config. This way, we don't re-add addresses that were manually removed
 				 * by the user. */
 				if (priv->con_ip_config_4) {
-					nm_ip4_config_intersect (priv->con_ip_config_4, priv->ext_ip_config_4,
+					nm_ip4_config_intersect (priv->con_ip_config_4, priv->ext_ip4_config_captured,
 					                         TRUE,
 					                         is_up,
 					                         default_route_metric_penalty_get (self, AF_INET));
@@ -14006,7 +14455,7 @@ update_ext_ip_config (NMDevice *self, int addr_family, gboolean intersect_config
 				intersect_ext_config (self, &priv->dev2_ip_config_4, TRUE, is_up);
 
 				for (iter = priv->vpn_configs_4; iter; iter = iter->next)
-					nm_ip4_config_intersect (iter->data, priv->ext_ip_config_4, TRUE, is_up, 0);
+					nm_ip4_config_intersect (iter->data, priv->ext_ip4_config_captured, TRUE, is_up, 0);
 			}
 
 			/* Remove parts from ext_ip_config_4 to only contain the information that
@@ -14033,15 +14482,7 @@ update_ext_ip_config (NMDevice *self, int addr_family, gboolean intersect_config
 	} else {
 		nm_assert (addr_family == AF_INET6);
 
-		g_clear_object (&priv->ext_ip_config_6);
-		g_clear_object (&priv->ext_ip6_config_captured);
-		priv->ext_ip6_config_captured = nm_ip6_config_capture (nm_device_get_multi_index (self),
-		                                                       nm_device_get_platform (self),
-		                                                       ifindex,
-		                                                       NM_SETTING_IP6_CONFIG_PRIVACY_UNKNOWN);
-		if (priv->ext_ip6_config_captured) {
-
-			priv->ext_ip_config_6 = nm_ip6_config_new_cloned (priv->ext_ip6_config_captured);
+		if (priv->ext_ip_config_6) {
 
 			if (intersect_configs) {
 				/* This function was called upon external changes. Remove the configuration
@@ -14049,7 +14490,7 @@ update_ext_ip_config (NMDevice *self, int addr_family, gboolean intersect_config
 				 * config. This way, we don't re-add addresses that were manually removed
 				 * by the user. */
 				if (priv->con_ip_config_6) {
-					nm_ip6_config_intersect (priv->con_ip_config_6, priv->ext_ip_config_6,
+					nm_ip6_config_intersect (priv->con_ip_config_6, priv->ext_ip6_config_captured,
 					                         is_up,
 					                         is_up,
 					                         default_route_metric_penalty_get (self, AF_INET6));
@@ -14060,11 +14501,11 @@ update_ext_ip_config (NMDevice *self, int addr_family, gboolean intersect_config
 				intersect_ext_config (self, &priv->dev2_ip_config_6, is_up, is_up);
 
 				for (iter = priv->vpn_configs_6; iter; iter = iter->next)
-					nm_ip6_config_intersect (iter->data, priv->ext_ip_config_6, is_up, is_up, 0);
+					nm_ip6_config_intersect (iter->data, priv->ext_ip6_config_captured, is_up, is_up, 0);
 
 				if (   is_up
 				    && priv->ipv6ll_has
-				    && !nm_ip6_config_lookup_address (priv->ext_ip_config_6, &priv->ipv6ll_addr))
+				    && !nm_ip6_config_lookup_address (priv->ext_ip6_config_captured, &priv->ipv6ll_addr))
 					priv->ipv6ll_has = FALSE;
 			}
 
@@ -14095,6 +14536,10 @@ update_ext_ip_config (NMDevice *self, int addr_family, gboolean intersect_config
 		}
 	}
 
+	ext_ip_capture_clear (capture);
+	capture->ifindex = ifindex;
+	ext_ip_capture_get_digest (self, addr_family, capture->internal_digest);
+
 	return TRUE;
 }
 
@@ -14252,6 +14697,24 @@ queued_ip6_config_change (gpointer user_data)
 	return queued_ip_config_change (user_data, AF_INET6);
 }
 
+static void
+_queue_ip_config_change (NMDevice *self, int addr_family)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+
+	if (addr_family == AF_INET) {
+		if (!priv->queued_ip_config_id_4) {
+			priv->queued_ip_config_id_4 = g_idle_add (queued_ip4_config_change, self);
+			_LOGD (LOGD_DEVICE, "queued IP4 config change");
+		}
+	} else {
+		if (!priv->queued_ip_config_id_6) {
+			priv->queued_ip_config_id_6 = g_idle_add (queued_ip6_config_change, self);
+			_LOGD (LOGD_DEVICE, "queued IP6 config change");
+		}
+	}
+}
+
 static void
 device_ipx_changed (NMPlatform *platform,
                     int obj_type_i,
@@ -14268,23 +14731,22 @@ device_ipx_changed (NMPlatform *platform,
 	if (nm_device_get_ip_ifindex (self) != ifindex)
 		return;
 
-	if (!nm_device_is_real (self))
-		return;
+	priv = NM_DEVICE_GET_PRIVATE (self);
 
-	if (nm_device_get_unmanaged_flags (self, NM_UNMANAGED_PLATFORM_INIT)) {
-		/* ignore all platform signals until the link is initialized in platform. */
+	if (   !nm_device_is_real (self)
+	    || nm_device_get_unmanaged_flags (self, NM_UNMANAGED_PLATFORM_INIT)) {
+		/* ignore all platform signals until the link is initialized in platform.
+		 * As we miss changes, the next update must capture everything. */
+		priv->ext_ip_capture_x[0].need_full = TRUE;
+		priv->ext_ip_capture_x[1].need_full = TRUE;
 		return;
 	}
 
-	priv = NM_DEVICE_GET_PRIVATE (self);
+	ext_ip_capture_track (self, obj_type, NMP_OBJECT_UP_CAST (platform_object));
 
 	switch (obj_type) {
 	case NMP_OBJECT_TYPE_IP4_ADDRESS:
-	case NMP_OBJECT_TYPE_IP4_ROUTE:
-		if (!priv->queued_ip_config_id_4) {
-			priv->queued_ip_config_id_4 = g_idle_add (queued_ip4_config_change, self);
-			_LOGD (LOGD_DEVICE, "queued IP4 config change");
-		}
+		_queue_ip_config_change (self, AF_INET);
 		break;
 	case NMP_OBJECT_TYPE_IP6_ADDRESS:
 		addr = platform_object;
@@ -14295,19 +14757,55 @@ device_ipx_changed (NMPlatform *platform,
 			priv->dad6_failed_addrs = g_slist_prepend (priv->dad6_failed_addrs,
 			                                           (gpointer) nmp_object_ref (NMP_OBJECT_UP_CAST (addr)));
 		}
-
-		/* fall-through */
-	case NMP_OBJECT_TYPE_IP6_ROUTE:
-		if (!priv->queued_ip_config_id_6) {
-			priv->queued_ip_config_id_6 = g_idle_add (queued_ip6_config_change, self);
-			_LOGD (LOGD_DEVICE, "queued IP6 config change");
-		}
+		_queue_ip_config_change (self, AF_INET6);
 		break;
 	default:
 		g_return_if_reached ();
 	}
 }
 
+static void
+device_ip_change_set_cb (NMPlatform *platform,
+                         const NMPlatformChangeSet *change_set,
+                         NMDevice *self)
+{
+	NMDevicePrivate *priv;
+	gboolean IS_IPv4;
+	guint i;
+
+	/* routes come in bulk (e.g. from routing daemons), so we only look
+	 * at them once per main loop iteration. Addresses are handled by
+	 * device_ipx_changed(), because DAD needs to see every event. */
+	if (!NM_IN_SET (change_set->obj_type, NMP_OBJECT_TYPE_IP4_ROUTE,
+	                                      NMP_OBJECT_TYPE_IP6_ROUTE))
+		return;
+
+	if (nm_device_get_ip_ifindex (self) != change_set->ifindex)
+		return;
+
+	priv = NM_DEVICE_GET_PRIVATE (self);
+	IS_IPv4 = (change_set->obj_type == NMP_OBJECT_TYPE_IP4_ROUTE);
+
+	if (   !nm_device_is_real (self)
+	    || nm_device_get_unmanaged_flags (self, NM_UNMANAGED_PLATFORM_INIT)) {
+		priv->ext_ip_capture_x[IS_IPv4].need_full = TRUE;
+		return;
+	}
+
+	if (!change_set->objs) {
+		/* too many changes. Capture everything anew. */
+		nm_clear_pointer (&priv->ext_ip_capture_x[IS_IPv4].changed_routes, g_hash_table_unref);
+		priv->ext_ip_capture_x[IS_IPv4].need_full = TRUE;
+	} else {
+		for (i = 0; i < change_set->n_objs; i++)
+			ext_ip_capture_track (self, change_set->obj_type, change_set->objs[i]);
+	}
+
+	/* when flushing, we are about to update the configuration anyway. */
+	if (!priv->ext_ip_capture_x[IS_IPv4].flushing)
+		_queue_ip_config_change (self, IS_IPv4 ? AF_INET : AF_INET6);
+}
+
 /*****************************************************************************/
 
 NM_UTILS_FLAGS2STR_DEFINE (nm_unmanaged_flags2str, NMUnmanagedFlags,
@@ -15497,6 +15995,9 @@ _cleanup_generic_pre (NMDevice *self, CleanupType cleanup_type)
 
 	priv->stage1_sriov_state = NM_DEVICE_STAGE_STATE_INIT;
 
+	nm_clear_g_cancellable (&priv->ethtool_query_cancellable);
+	priv->stage1_ethtool_state = NM_DEVICE_STAGE_STATE_INIT;
+
 	if (cleanup_type != CLEANUP_TYPE_KEEP) {
 		nm_manager_device_route_metric_clear (NM_MANAGER_GET,
 		                                      nm_device_get_ip_ifindex (self));
@@ -15555,6 +16056,9 @@ _cleanup_generic_post (NMDevice *self, CleanupType cleanup_type)
 	applied_config_clear (&priv->ac_ip6_config);
 	g_clear_object (&priv->ext_ip_config_6);
 	g_clear_object (&priv->ext_ip6_config_captured);
+	g_clear_object (&priv->ext_ip4_config_captured);
+	ext_ip_capture_clear (&priv->ext_ip_capture_x[0]);
+	ext_ip_capture_clear (&priv->ext_ip_capture_x[1]);
 	applied_config_clear (&priv->dev2_ip_config_6);
 	g_clear_object (&priv->ip_config_6);
 	g_clear_object (&priv->dad6_ip6_config);
@@ -15917,11 +16421,23 @@ notify_ip_properties (NMDevice *self)
 static void
 ip6_managed_setup (NMDevice *self)
 {
+	NMPlatformSysctlBatch *batch;
+	const char *ifname;
+
 	set_nm_ipv6ll (self, TRUE);
 	set_disable_ipv6 (self, "1");
-	nm_device_sysctl_ip_conf_set (self, AF_INET6, "accept_ra", "0");
-	nm_device_sysctl_ip_conf_set (self, AF_INET6, "use_tempaddr", "0");
-	nm_device_sysctl_ip_conf_set (self, AF_INET6, "forwarding", "0");
+
+	ifname = nm_device_get_ip_iface_from_platform (self);
+	if (!ifname)
+		return;
+
+	/* this happens for every device that we manage. Don't block on the writes.
+	 * Later accesses to the sysctls of the interface wait for them. */
+	batch = nm_platform_sysctl_batch_new (nm_device_get_platform (self));
+	nm_platform_sysctl_batch_add_ip_conf (batch, AF_INET6, ifname, "accept_ra", "0");
+	nm_platform_sysctl_batch_add_ip_conf (batch, AF_INET6, ifname, "use_tempaddr", "0");
+	nm_platform_sysctl_batch_add_ip_conf (batch, AF_INET6, ifname, "forwarding", "0");
+	nm_platform_sysctl_batch_commit (batch, NULL, NULL, NULL);
 }
 
 static void
@@ -17373,6 +17889,7 @@ _activation_func_to_string (ActivationHandleFunc func)
 	} G_STMT_END
 	FUNC_TO_STRING_CHECK_AND_RETURN (func, activate_stage1_device_prepare);
 	FUNC_TO_STRING_CHECK_AND_RETURN (func, activate_stage2_device_config);
+	FUNC_TO_STRING_CHECK_AND_RETURN (func, activate_stage2_device_link_up);
 	FUNC_TO_STRING_CHECK_AND_RETURN (func, activate_stage3_ip_config_start);
 	FUNC_TO_STRING_CHECK_AND_RETURN (func, activate_stage4_ip_config_timeout_4);
 	FUNC_TO_STRING_CHECK_AND_RETURN (func, activate_stage4_ip_config_timeout_6);
@@ -17381,6 +17898,46 @@ _activation_func_to_string (ActivationHandleFunc func)
 	g_return_val_if_reached ("unknown");
 }
 
+static guint
+_activation_func_to_stage (ActivationHandleFunc func)
+{
+	static const ActivationHandleFunc funcs[_ACTIVATION_STAGE_NUM] = {
+		[ACTIVATION_STAGE_1_DEVICE_PREPARE]       = activate_stage1_device_prepare,
+		[ACTIVATION_STAGE_2_DEVICE_CONFIG]        = activate_stage2_device_config,
+		[ACTIVATION_STAGE_2_DEVICE_LINK_UP]       = activate_stage2_device_link_up,
+		[ACTIVATION_STAGE_3_IP_CONFIG_START]      = activate_stage3_ip_config_start,
+		[ACTIVATION_STAGE_4_IP_CONFIG_TIMEOUT_4]  = activate_stage4_ip_config_timeout_4,
+		[ACTIVATION_STAGE_4_IP_CONFIG_TIMEOUT_6]  = activate_stage4_ip_config_timeout_6,
+		[ACTIVATION_STAGE_5_IP_CONFIG_RESULT_4]   = activate_stage5_ip_config_result_4,
+		[ACTIVATION_STAGE_5_IP_CONFIG_RESULT_6]   = activate_stage5_ip_config_result_6,
+	};
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS (funcs); i++) {
+		if (funcs[i] == func)
+			return i;
+	}
+	g_return_val_if_reached (ACTIVATION_STAGE_1_DEVICE_PREPARE);
+}
+
+static const char *
+_activation_stage_to_string (guint stage)
+{
+	static const char *const names[_ACTIVATION_STAGE_NUM] = {
+		[ACTIVATION_STAGE_1_DEVICE_PREPARE]       = "stage1-device-prepare",
+		[ACTIVATION_STAGE_2_DEVICE_CONFIG]        = "stage2-device-config",
+		[ACTIVATION_STAGE_2_DEVICE_LINK_UP]       = "stage2-device-link-up",
+		[ACTIVATION_STAGE_3_IP_CONFIG_START]      = "stage3-ip-config-start",
+		[ACTIVATION_STAGE_4_IP_CONFIG_TIMEOUT_4]  = "stage4-ip-config-timeout-4",
+		[ACTIVATION_STAGE_4_IP_CONFIG_TIMEOUT_6]  = "stage4-ip-config-timeout-6",
+		[ACTIVATION_STAGE_5_IP_CONFIG_RESULT_4]   = "stage5-ip-config-result-4",
+		[ACTIVATION_STAGE_5_IP_CONFIG_RESULT_6]   = "stage5-ip-config-result-6",
+	};
+
+	nm_assert (stage < G_N_ELEMENTS (names));
+	return names[stage];
+}
+
 /*****************************************************************************/
 
 static void
@@ -17692,6 +18249,13 @@ nm_device_init (NMDevice *self)
 	c_list_init (&self->devices_lst);
 	c_list_init (&priv->slaves);
 
+	nm_activation_queue_entry_init (&priv->activation_queue_x[0].base);
+	priv->activation_queue_x[0].self = self;
+	priv->activation_queue_x[0].addr_family = AF_INET6;
+	nm_activation_queue_entry_init (&priv->activation_queue_x[1].base);
+	priv->activation_queue_x[1].self = self;
+	priv->activation_queue_x[1].addr_family = AF_INET;
+
 	priv->concheck_x[0].state = NM_CONNECTIVITY_UNKNOWN;
 	priv->concheck_x[1].state = NM_CONNECTIVITY_UNKNOWN;
 
@@ -17780,8 +18344,7 @@ constructed (GObject *object)
 	platform = nm_device_get_platform (self);
 	g_signal_connect (platform, NM_PLATFORM_SIGNAL_IP4_ADDRESS_CHANGED, G_CALLBACK (device_ipx_changed), self);
 	g_signal_connect (platform, NM_PLATFORM_SIGNAL_IP6_ADDRESS_CHANGED, G_CALLBACK (device_ipx_changed), self);
-	g_signal_connect (platform, NM_PLATFORM_SIGNAL_IP4_ROUTE_CHANGED, G_CALLBACK (device_ipx_changed), self);
-	g_signal_connect (platform, NM_PLATFORM_SIGNAL_IP6_ROUTE_CHANGED, G_CALLBACK (device_ipx_changed), self);
+	g_signal_connect (platform, NM_PLATFORM_SIGNAL_CHANGE_SET, G_CALLBACK (device_ip_change_set_cb), self);
 	g_signal_connect (platform, NM_PLATFORM_SIGNAL_LINK_CHANGED, G_CALLBACK (link_changed_cb), self);
 
 	priv->manager = g_object_ref (NM_MANAGER_GET);
@@ -17825,6 +18388,10 @@ dispose (GObject *object)
 	}
 
 	nm_clear_g_cancellable (&priv->deactivating_cancellable);
+	nm_clear_g_cancellable (&priv->ethtool_query_cancellable);
+
+	activation_source_clear (self, AF_INET);
+	activation_source_clear (self, AF_INET6);
 
 	nm_device_assume_state_reset (self);
 
@@ -17832,6 +18399,7 @@ dispose (GObject *object)
 
 	platform = nm_device_get_platform (self);
 	g_signal_handlers_disconnect_by_func (platform, G_CALLBACK (device_ipx_changed), self);
+	g_signal_handlers_disconnect_by_func (platform, G_CALLBACK (device_ip_change_set_cb), self);
 	g_signal_handlers_disconnect_by_func (platform, G_CALLBACK (link_changed_cb), self);
 
 	arp_cleanup (self);
@@ -18083,6 +18651,7 @@ nm_device_class_init (NMDeviceClass *klass)
 
 	klass->get_type_description = get_type_description;
 	klass->can_auto_connect = can_auto_connect;
+	klass->get_autoconnect_lookup = get_autoconnect_lookup;
 	klass->can_update_from_platform_link = can_update_from_platform_link;
 	klass->check_connection_compatible = check_connection_compatible;
 	klass->check_connection_available = check_connection_available;
@@ -324,6 +324,12 @@ typedef struct _NMDeviceClass {
 	                                  NMSettingsConnection *sett_conn,
 	                                  char **specific_object);
 
+	/* describes the device for nm_settings_get_autoconnect_candidates(). Derived
+	 * classes may only add restrictions that their check_connection_compatible()
+	 * enforces. */
+	void        (* get_autoconnect_lookup) (NMDevice *self,
+	                                        struct _NMSettingsAutoconnectLookup *lookup);
+
 	guint32     (*get_configured_mtu) (NMDevice *self,
 	                                   NMDeviceMtuSource *out_source,
 	                                   gboolean *out_force);
@@ -563,6 +569,9 @@ gboolean nm_device_can_auto_connect (NMDevice *self,
                                      NMSettingsConnection *sett_conn,
                                      char **specific_object);
 
+void nm_device_get_autoconnect_lookup (NMDevice *self,
+                                       struct _NMSettingsAutoconnectLookup *lookup);
+
 gboolean nm_device_complete_connection (NMDevice *device,
                                         NMConnection *connection,
                                         const char *specific_object,
@@ -573,6 +582,8 @@ gboolean nm_device_check_connection_compatible (NMDevice *device,
                                                 NMConnection *connection,
                                                 GError **error);
 
+guint64 nm_device_check_connection_compatible_get_count (void);
+
 gboolean nm_device_check_slave_connection_compatible (NMDevice *device, NMConnection *connection);
 
 gboolean nm_device_unmanage_on_quit (NMDevice *self);
@@ -0,0 +1,247 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Copyright (C) 2020 Red Hat, Inc.
+ */
+
+#include "nm-default.h"
+
+#include "devices/nm-activation-queue.h"
+
+#include "nm-test-utils-core.h"
+
+/*****************************************************************************/
+
+#define N_STAGES 3
+
+typedef struct _TestData TestData;
+
+typedef struct {
+	NMActivationQueueEntry base;
+	TestData *data;
+	guint id;
+	/* queue the entry for the next stage, when it gets invoked. */
+	bool advance:1;
+} TestEntry;
+
+struct _TestData {
+	NMActivationQueue *queue;
+	GString *log;
+	TestEntry entries[8];
+	/* remove this entry, when invoking entry @remove_by. */
+	TestEntry *remove;
+	TestEntry *remove_by;
+};
+
+static void
+_log (TestData *data, const char *fmt, ...) _nm_printf (2, 3);
+
+static void
+_log (TestData *data, const char *fmt, ...)
+{
+	va_list ap;
+
+	if (data->log->len > 0)
+		g_string_append_c (data->log, ' ');
+	va_start (ap, fmt);
+	g_string_append_vprintf (data->log, fmt, ap);
+	va_end (ap);
+}
+
+static void
+_invoke_cb (NMActivationQueueEntry *base, gpointer user_data)
+{
+	TestEntry *entry = (TestEntry *) base;
+	TestData *data = user_data;
+
+	g_assert (entry->data == data);
+	g_assert (!nm_activation_queue_entry_is_queued (base));
+
+	_log (data, "%u:%u", base->stage, entry->id);
+
+	if (data->remove_by == entry) {
+		nm_activation_queue_remove (data->queue, &data->remove->base);
+		data->remove = NULL;
+		data->remove_by = NULL;
+	}
+
+	if (   entry->advance
+	    && base->stage + 1 < N_STAGES)
+		nm_activation_queue_add (data->queue, base, base->stage + 1);
+}
+
+static void
+_batch_cb (guint stage, CList *batch, gpointer user_data)
+{
+	TestData *data = user_data;
+
+	_log (data, "[%u:%u]", stage, (guint) c_list_length (batch));
+}
+
+static const char *
+_stage_to_string (guint stage)
+{
+	static const char *const names[N_STAGES] = { "s0", "s1", "s2" };
+
+	g_assert_cmpint (stage, <, N_STAGES);
+	return names[stage];
+}
+
+static void
+_test_data_init (TestData *data, guint batch_max)
+{
+	guint i;
+
+	*data = (TestData) {
+		.log = g_string_new (NULL),
+	};
+	data->queue = nm_activation_queue_new (N_STAGES,
+	                                       batch_max,
+	                                       _invoke_cb,
+	                                       _batch_cb,
+	                                       _stage_to_string,
+	                                       data);
+	for (i = 0; i < G_N_ELEMENTS (data->entries); i++) {
+		data->entries[i].data = data;
+		data->entries[i].id = i;
+		nm_activation_queue_entry_init (&data->entries[i].base);
+	}
+}
+
+static void
+_test_data_clear (TestData *data)
+{
+	nm_activation_queue_free (data->queue);
+	g_string_free (data->log, TRUE);
+}
+
+/* runs one dispatch of the queue, and returns what happened. */
+static char *
+_dispatch (TestData *data)
+{
+	char *s;
+
+	g_assert (g_main_context_iteration (NULL, FALSE));
+	s = g_strdup (data->log->str);
+	g_string_truncate (data->log, 0);
+	return s;
+}
+
+#define _assert_dispatch(data, expected) \
+	G_STMT_START { \
+		gs_free char *_s = _dispatch (data); \
+		\
+		g_assert_cmpstr (_s, ==, (expected)); \
+	} G_STMT_END
+
+/*****************************************************************************/
+
+static void
+test_dispatch_order (void)
+{
+	TestData data;
+	guint i;
+
+	_test_data_init (&data, 4);
+
+	for (i = 0; i < 6; i++) {
+		data.entries[i].advance = TRUE;
+		nm_activation_queue_add (data.queue, &data.entries[i].base, 0);
+	}
+	g_assert_cmpint (nm_activation_queue_get_n_queued (data.queue), ==, 6);
+
+	/* the budget of a dispatch is limited. Entries that advance to a
+	 * later stage are invoked by the next dispatch. */
+	_assert_dispatch (&data, "[0:4] 0:0 0:1 0:2 0:3");
+	g_assert_cmpint (nm_activation_queue_get_n_queued (data.queue), ==, 6);
+
+	/* later stages go first. */
+	_assert_dispatch (&data, "[1:4] 1:0 1:1 1:2 1:3");
+	_assert_dispatch (&data, "[2:4] 2:0 2:1 2:2 2:3");
+	_assert_dispatch (&data, "[0:2] 0:4 0:5");
+	_assert_dispatch (&data, "[1:2] 1:4 1:5");
+	_assert_dispatch (&data, "[2:2] 2:4 2:5");
+
+	g_assert_cmpint (nm_activation_queue_get_n_queued (data.queue), ==, 0);
+
+	/* the queue drained, there is nothing left to dispatch. */
+	g_assert (!g_main_context_iteration (NULL, FALSE));
+
+	_test_data_clear (&data);
+}
+
+static void
+test_dispatch_mixed (void)
+{
+	TestData data;
+
+	_test_data_init (&data, 4);
+
+	nm_activation_queue_add (data.queue, &data.entries[0].base, 0);
+	nm_activation_queue_add (data.queue, &data.entries[1].base, 2);
+	nm_activation_queue_add (data.queue, &data.entries[2].base, 0);
+	nm_activation_queue_add (data.queue, &data.entries[3].base, 1);
+
+	/* the budget is shared by all stages. */
+	_assert_dispatch (&data, "[2:1] 2:1 [1:1] 1:3 [0:2] 0:0 0:2");
+	g_assert_cmpint (nm_activation_queue_get_n_queued (data.queue), ==, 0);
+
+	/* adding a queued entry again moves it to the tail of the new stage. */
+	nm_activation_queue_add (data.queue, &data.entries[0].base, 1);
+	nm_activation_queue_add (data.queue, &data.entries[1].base, 1);
+	nm_activation_queue_add (data.queue, &data.entries[0].base, 1);
+	nm_activation_queue_add (data.queue, &data.entries[2].base, 0);
+	nm_activation_queue_add (data.queue, &data.entries[2].base, 2);
+	g_assert_cmpint (nm_activation_queue_get_n_queued (data.queue), ==, 3);
+
+	_assert_dispatch (&data, "[2:1] 2:2 [1:2] 1:1 1:0");
+
+	_test_data_clear (&data);
+}
+
+static void
+test_dispatch_remove (void)
+{
+	TestData data;
+	guint i;
+
+	_test_data_init (&data, 4);
+
+	for (i = 0; i < 4; i++)
+		nm_activation_queue_add (data.queue, &data.entries[i].base, 0);
+
+	/* a removed entry is not invoked. */
+	nm_activation_queue_remove (data.queue, &data.entries[1].base);
+	g_assert (!nm_activation_queue_entry_is_queued (&data.entries[1].base));
+	nm_activation_queue_remove (data.queue, &data.entries[1].base);
+	g_assert_cmpint (nm_activation_queue_get_n_queued (data.queue), ==, 3);
+
+	/* neither if it gets removed while its batch is invoked. */
+	data.remove = &data.entries[3];
+	data.remove_by = &data.entries[0];
+
+	_assert_dispatch (&data, "[0:3] 0:0 0:2");
+	g_assert_cmpint (nm_activation_queue_get_n_queued (data.queue), ==, 0);
+	g_assert (!g_main_context_iteration (NULL, FALSE));
+
+	/* the queue can be used again. */
+	nm_activation_queue_add (data.queue, &data.entries[1].base, 1);
+	_assert_dispatch (&data, "[1:1] 1:1");
+
+	_test_data_clear (&data);
+}
+
+/*****************************************************************************/
+
+NMTST_DEFINE ();
+
+int
+main (int argc, char **argv)
+{
+	nmtst_init_assert_logging (&argc, &argv, "INFO", "DEFAULT");
+
+	g_test_add_func ("/activation-queue/dispatch-order", test_dispatch_order);
+	g_test_add_func ("/activation-queue/dispatch-mixed", test_dispatch_mixed);
+	g_test_add_func ("/activation-queue/dispatch-remove", test_dispatch_remove);
+
+	return g_test_run ();
+}
@@ -760,9 +760,14 @@ static const ConfigGroup config_groups[] = {
 			NM_CONFIG_KEYFILE_KEY_MAIN_HOSTNAME_MODE,
 			NM_CONFIG_KEYFILE_KEY_MAIN_IGNORE_CARRIER,
 			NM_CONFIG_KEYFILE_KEY_MAIN_MONITOR_CONNECTION_FILES,
+			NM_CONFIG_KEYFILE_KEY_MAIN_NETLINK_RCVBUF_MAX,
+			NM_CONFIG_KEYFILE_KEY_MAIN_NETLINK_RESYNC,
+			NM_CONFIG_KEYFILE_KEY_MAIN_NETLINK_WORKER,
 			NM_CONFIG_KEYFILE_KEY_MAIN_NO_AUTO_DEFAULT,
 			NM_CONFIG_KEYFILE_KEY_MAIN_PLUGINS,
 			NM_CONFIG_KEYFILE_KEY_MAIN_RC_MANAGER,
+			NM_CONFIG_KEYFILE_KEY_MAIN_ROUTE_CACHE_IGNORE_PROTOCOLS,
+			NM_CONFIG_KEYFILE_KEY_MAIN_ROUTE_CACHE_IGNORE_TABLES,
 			NM_CONFIG_KEYFILE_KEY_MAIN_SLAVES_ORDER,
 			NM_CONFIG_KEYFILE_KEY_MAIN_SYSTEMD_RESOLVED,
 		),
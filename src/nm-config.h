@@ -52,9 +52,14 @@
 #define NM_CONFIG_KEYFILE_KEY_MAIN_HOSTNAME_MODE            "hostname-mode"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_IGNORE_CARRIER           "ignore-carrier"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_MONITOR_CONNECTION_FILES "monitor-connection-files"
+#define NM_CONFIG_KEYFILE_KEY_MAIN_NETLINK_RCVBUF_MAX      "netlink-rcvbuf-max"
+#define NM_CONFIG_KEYFILE_KEY_MAIN_NETLINK_RESYNC          "netlink-resync"
+#define NM_CONFIG_KEYFILE_KEY_MAIN_NETLINK_WORKER          "netlink-worker"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_NO_AUTO_DEFAULT          "no-auto-default"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_PLUGINS                  "plugins"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_RC_MANAGER               "rc-manager"
+#define NM_CONFIG_KEYFILE_KEY_MAIN_ROUTE_CACHE_IGNORE_PROTOCOLS "route-cache-ignore-protocols"
+#define NM_CONFIG_KEYFILE_KEY_MAIN_ROUTE_CACHE_IGNORE_TABLES "route-cache-ignore-tables"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_SLAVES_ORDER             "slaves-order"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_SYSTEMD_RESOLVED         "systemd-resolved"
 
@@ -45,6 +45,18 @@ typedef struct {
 	GVariant *value;
 } PropertyCacheData;
 
+/* a signal or property change of an already registered object, that
+ * is delayed while the export is frozen. */
+typedef struct {
+	CList frozen_lst;
+	NMDBusObject *obj;
+	const NMDBusInterfaceInfoExtended *interface_info;
+	const GDBusSignalInfo *signal_info;
+	GVariant *args;
+	guint n_pspecs;
+	const GParamSpec *pspecs[];
+} FrozenEmitData;
+
 typedef struct {
 	CList registration_lst;
 	NMDBusObject *obj;
@@ -81,6 +93,14 @@ typedef struct {
 	CList caller_info_lst_head;
 
 	guint objmgr_registration_id;
+
+	/* while positive, newly exported objects are not yet registered on the bus.
+	 * See nm_dbus_manager_export_freeze(). */
+	guint export_freeze_count;
+
+	/* the FrozenEmitData that are emitted by nm_dbus_manager_export_thaw(). */
+	CList frozen_lst_head;
+
 	bool started:1;
 	bool shutting_down:1;
 } NMDBusManagerPrivate;
@@ -926,6 +946,28 @@ static const GDBusInterfaceVTable dbus_vtable = {
 	.set_property = NULL,
 };
 
+static void
+_frozen_emit_data_free (FrozenEmitData *data)
+{
+	c_list_unlink_stale (&data->frozen_lst);
+	nm_g_variant_unref (data->args);
+	g_free (data);
+}
+
+static void
+_frozen_emit_data_clear_obj (NMDBusManager *self,
+                             NMDBusObject *obj)
+{
+	NMDBusManagerPrivate *priv = NM_DBUS_MANAGER_GET_PRIVATE (self);
+	FrozenEmitData *data;
+	FrozenEmitData *data_safe;
+
+	c_list_for_each_entry_safe (data, data_safe, &priv->frozen_lst_head, frozen_lst) {
+		if (data->obj == obj)
+			_frozen_emit_data_free (data);
+	}
+}
+
 static void
 _obj_register (NMDBusManager *self,
                NMDBusObject *obj)
@@ -1114,7 +1156,8 @@ _nm_dbus_manager_obj_export (NMDBusObject *obj)
 		nm_assert_not_reached ();
 	c_list_link_tail (&priv->objects_lst_head, &obj->internal.objects_lst);
 
-	if (priv->started)
+	if (   priv->started
+	    && priv->export_freeze_count == 0)
 		_obj_register (self, obj);
 }
 
@@ -1135,10 +1178,15 @@ _nm_dbus_manager_obj_unexport (NMDBusObject *obj)
 	nm_assert (&obj->internal == g_hash_table_lookup (priv->objects_by_path, &obj->internal));
 	nm_assert (c_list_contains (&priv->objects_lst_head, &obj->internal.objects_lst));
 
-	if (priv->started)
+	if (   priv->started
+	    && !c_list_is_empty (&obj->internal.registration_lst_head))
 		_obj_unregister (self, obj);
 	else
-		nm_assert (c_list_is_empty (&obj->internal.registration_lst_head));
+		nm_assert (!priv->started || priv->export_freeze_count > 0);
+
+	/* the object is gone. Drop what it emitted while frozen, the peers
+	 * don't care about it anymore. */
+	_frozen_emit_data_clear_obj (self, obj);
 
 	if (!g_hash_table_remove (priv->objects_by_path, &obj->internal))
 		nm_assert_not_reached ();
@@ -1169,11 +1217,33 @@ _nm_dbus_manager_obj_notify (NMDBusObject *obj,
 
 	nm_assert (!priv->started || priv->objmgr_registration_id != 0);
 	nm_assert (priv->objmgr_registration_id == 0 || priv->main_dbus_connection);
-	nm_assert (c_list_is_empty (&obj->internal.registration_lst_head) != priv->started);
+	nm_assert (   c_list_is_empty (&obj->internal.registration_lst_head) != priv->started
+	           || priv->export_freeze_count > 0);
 
 	if (G_UNLIKELY (!priv->started))
 		return;
 
+	if (G_UNLIKELY (c_list_is_empty (&obj->internal.registration_lst_head))) {
+		/* not yet registered due to nm_dbus_manager_export_freeze(). */
+		return;
+	}
+
+	if (G_UNLIKELY (priv->export_freeze_count > 0)) {
+		FrozenEmitData *data;
+
+		/* the new value may refer to an object that is not yet announced. Delay
+		 * the notification until thaw, when it is emitted with the values at
+		 * that time. */
+		data = g_malloc (sizeof (FrozenEmitData) + (sizeof (const GParamSpec *) * n_pspecs));
+		*data = (FrozenEmitData) {
+			.obj      = obj,
+			.n_pspecs = n_pspecs,
+		};
+		memcpy (data->pspecs, pspecs, sizeof (const GParamSpec *) * n_pspecs);
+		c_list_link_tail (&priv->frozen_lst_head, &data->frozen_lst);
+		return;
+	}
+
 	c_list_for_each_entry (reg_data, &obj->internal.registration_lst_head, registration_lst) {
 		if (_reg_data_get_interface_info (reg_data)->legacy_property_changed) {
 			any_legacy_signals = TRUE;
@@ -1323,11 +1393,28 @@ _nm_dbus_manager_obj_emit_signal (NMDBusObject *obj,
 	self = obj->internal.bus_manager;
 	priv = NM_DBUS_MANAGER_GET_PRIVATE (self);
 
-	if (!priv->started) {
+	if (   !priv->started
+	    || c_list_is_empty (&obj->internal.registration_lst_head)) {
 		nm_g_variant_unref_floating (args);
 		return;
 	}
 
+	if (G_UNLIKELY (priv->export_freeze_count > 0)) {
+		FrozenEmitData *data;
+
+		/* signals like "DeviceAdded" refer to objects that are only announced
+		 * on thaw. Delay them until then. */
+		data = g_new (FrozenEmitData, 1);
+		*data = (FrozenEmitData) {
+			.obj            = obj,
+			.interface_info = interface_info,
+			.signal_info    = signal_info,
+			.args           = g_variant_ref_sink (args),
+		};
+		c_list_link_tail (&priv->frozen_lst_head, &data->frozen_lst);
+		return;
+	}
+
 	g_dbus_connection_emit_signal (priv->main_dbus_connection,
 	                               NULL,
 	                               obj->internal.path,
@@ -1416,6 +1503,11 @@ dbus_vtable_objmgr_method_call (GDBusConnection *connection,
 	c_list_for_each_entry (obj, &priv->objects_lst_head, internal.objects_lst) {
 		GVariantBuilder interfaces_builder;
 
+		if (c_list_is_empty (&obj->internal.registration_lst_head)) {
+			/* not yet registered due to nm_dbus_manager_export_freeze(). */
+			continue;
+		}
+
 		/* note that we are called on an idle handler. Hence, all properties are
 		 * supposed to be in a consistent state. That is true, if you always
 		 * g_object_thaw_notify() before returning to the mainloop. Keeping
@@ -1501,10 +1593,79 @@ nm_dbus_manager_start (NMDBusManager *self,
 	priv->set_property_handler_data = set_property_handler_data;
 	priv->started = TRUE;
 
+	if (priv->export_freeze_count > 0)
+		return;
+
 	c_list_for_each_entry (obj, &priv->objects_lst_head, internal.objects_lst)
 		_obj_register (self, obj);
 }
 
+/**
+ * nm_dbus_manager_export_freeze:
+ * @self: the #NMDBusManager
+ *
+ * Objects that get exported while frozen are registered on the bus only
+ * when the last nm_dbus_manager_export_thaw() is called. That is useful
+ * when exporting many objects at once, because the objects don't emit
+ * any property changes and signals before they are announced. Each
+ * object is announced with its final properties.
+ *
+ * Signals and property changes of objects that are already registered
+ * are delayed too, because they might refer to one of the new objects
+ * (like the manager's "DeviceAdded" signal). On thaw, they are emitted
+ * in order after the new objects are announced. Those of an object that
+ * gets unexported in the meantime are dropped.
+ *
+ * Like with g_object_freeze_notify(), don't return to the mainloop
+ * while frozen.
+ */
+void
+nm_dbus_manager_export_freeze (NMDBusManager *self)
+{
+	g_return_if_fail (NM_IS_DBUS_MANAGER (self));
+
+	NM_DBUS_MANAGER_GET_PRIVATE (self)->export_freeze_count++;
+}
+
+void
+nm_dbus_manager_export_thaw (NMDBusManager *self)
+{
+	NMDBusManagerPrivate *priv;
+	FrozenEmitData *data;
+	NMDBusObject *obj;
+
+	g_return_if_fail (NM_IS_DBUS_MANAGER (self));
+
+	priv = NM_DBUS_MANAGER_GET_PRIVATE (self);
+
+	g_return_if_fail (priv->export_freeze_count > 0);
+
+	if (--priv->export_freeze_count > 0)
+		return;
+
+	if (!priv->started)
+		return;
+
+	c_list_for_each_entry (obj, &priv->objects_lst_head, internal.objects_lst) {
+		if (c_list_is_empty (&obj->internal.registration_lst_head))
+			_obj_register (self, obj);
+	}
+
+	while ((data = c_list_first_entry (&priv->frozen_lst_head, FrozenEmitData, frozen_lst))) {
+		if (data->signal_info) {
+			g_dbus_connection_emit_signal (priv->main_dbus_connection,
+			                               NULL,
+			                               data->obj->internal.path,
+			                               data->interface_info->parent.name,
+			                               data->signal_info->name,
+			                               data->args,
+			                               NULL);
+		} else
+			_nm_dbus_manager_obj_notify (data->obj, data->n_pspecs, data->pspecs);
+		_frozen_emit_data_free (data);
+	}
+}
+
 gboolean
 nm_dbus_manager_acquire_bus (NMDBusManager *self,
                              gboolean request_name)
@@ -1586,6 +1747,35 @@ nm_dbus_manager_acquire_bus (NMDBusManager *self,
 	return TRUE;
 }
 
+/* For tests: use @connection as main connection, instead of connecting
+ * to the system bus and requesting our name, and start. */
+void
+_nmtst_dbus_manager_start_on_connection (NMDBusManager *self,
+                                         GDBusConnection *connection)
+{
+	NMDBusManagerPrivate *priv;
+	gs_free_error GError *error = NULL;
+
+	g_return_if_fail (NM_IS_DBUS_MANAGER (self));
+	g_return_if_fail (G_IS_DBUS_CONNECTION (connection));
+
+	priv = NM_DBUS_MANAGER_GET_PRIVATE (self);
+
+	g_return_if_fail (!priv->main_dbus_connection);
+
+	priv->main_dbus_connection = g_object_ref (connection);
+	priv->objmgr_registration_id = g_dbus_connection_register_object (priv->main_dbus_connection,
+	                                                                  OBJECT_MANAGER_SERVER_BASE_PATH,
+	                                                                  NM_UNCONST_PTR (GDBusInterfaceInfo, &interface_info_objmgr),
+	                                                                  &dbus_vtable_objmgr,
+	                                                                  self,
+	                                                                  NULL,
+	                                                                  &error);
+	g_assert_no_error (error);
+
+	nm_dbus_manager_start (self, NULL, NULL);
+}
+
 void
 nm_dbus_manager_stop (NMDBusManager *self)
 {
@@ -1616,6 +1806,7 @@ nm_dbus_manager_init (NMDBusManager *self)
 
 	c_list_init (&priv->private_servers_lst_head);
 	c_list_init (&priv->objects_lst_head);
+	c_list_init (&priv->frozen_lst_head);
 
 	priv->objects_by_path = g_hash_table_new ((GHashFunc) _objects_by_path_hash, (GEqualFunc) _objects_by_path_equal);
 
@@ -1634,6 +1825,7 @@ dispose (GObject *object)
 	 * expect any remaining objects. */
 	nm_assert (!priv->objects_by_path || g_hash_table_size (priv->objects_by_path) == 0);
 	nm_assert (c_list_is_empty (&priv->objects_lst_head));
+	nm_assert (c_list_is_empty (&priv->frozen_lst_head));
 
 	nm_clear_pointer (&priv->objects_by_path, g_hash_table_destroy);
 
@@ -47,6 +47,12 @@ void nm_dbus_manager_start (NMDBusManager *self,
 
 void nm_dbus_manager_stop (NMDBusManager *self);
 
+void nm_dbus_manager_export_freeze (NMDBusManager *self);
+void nm_dbus_manager_export_thaw (NMDBusManager *self);
+
+void _nmtst_dbus_manager_start_on_connection (NMDBusManager *self,
+                                              GDBusConnection *connection);
+
 gboolean nm_dbus_manager_is_stopping (NMDBusManager *self);
 
 gpointer nm_dbus_manager_lookup_object (NMDBusManager *self, const char *path);
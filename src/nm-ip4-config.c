@@ -588,11 +588,44 @@ nm_ip4_config_clone (const NMIP4Config *self)
 	return copy;
 }
 
+static void
+_capture_addresses (NMIP4Config *self, NMPlatform *platform)
+{
+	NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
+	const NMDedupMultiHeadEntry *head_entry;
+	NMDedupMultiIter iter;
+	const NMPObject *plobj = NULL;
+
+	head_entry = nm_platform_lookup_object (platform,
+	                                        NMP_OBJECT_TYPE_IP4_ADDRESS,
+	                                        priv->ifindex);
+	if (!head_entry)
+		return;
+
+	nmp_cache_iter_for_each (&iter, head_entry, &plobj) {
+		if (!_nm_ip_config_add_obj (priv->multi_idx,
+		                            &priv->idx_ip4_addresses_,
+		                            priv->ifindex,
+		                            plobj,
+		                            NULL,
+		                            FALSE,
+		                            TRUE,
+		                            NULL,
+		                            NULL))
+			nm_assert_not_reached ();
+	}
+	head_entry = nm_ip4_config_lookup_addresses (self);
+	nm_assert (head_entry);
+	nm_dedup_multi_head_entry_sort (head_entry,
+	                                sort_captured_addresses,
+	                                NULL);
+	_notify_addresses (self);
+}
+
 NMIP4Config *
 nm_ip4_config_capture (NMDedupMultiIndex *multi_idx, NMPlatform *platform, int ifindex)
 {
 	NMIP4Config *self;
-	NMIP4ConfigPrivate *priv;
 	const NMDedupMultiHeadEntry *head_entry;
 	NMDedupMultiIter iter;
 	const NMPObject *plobj = NULL;
@@ -604,31 +637,8 @@ nm_ip4_config_capture (NMDedupMultiIndex *multi_idx, NMPlatform *platform, int i
 		return NULL;
 
 	self = nm_ip4_config_new (multi_idx, ifindex);
-	priv = NM_IP4_CONFIG_GET_PRIVATE (self);
 
-	head_entry = nm_platform_lookup_object (platform,
-	                                        NMP_OBJECT_TYPE_IP4_ADDRESS,
-	                                        ifindex);
-	if (head_entry) {
-		nmp_cache_iter_for_each (&iter, head_entry, &plobj) {
-			if (!_nm_ip_config_add_obj (priv->multi_idx,
-			                            &priv->idx_ip4_addresses_,
-			                            ifindex,
-			                            plobj,
-			                            NULL,
-			                            FALSE,
-			                            TRUE,
-			                            NULL,
-			                            NULL))
-				nm_assert_not_reached ();
-		}
-		head_entry = nm_ip4_config_lookup_addresses (self);
-		nm_assert (head_entry);
-		nm_dedup_multi_head_entry_sort (head_entry,
-		                                sort_captured_addresses,
-		                                NULL);
-		_notify_addresses (self);
-	}
+	_capture_addresses (self, platform);
 
 	head_entry = nm_platform_lookup_object (platform,
 	                                        NMP_OBJECT_TYPE_IP4_ROUTE,
@@ -641,6 +651,53 @@ nm_ip4_config_capture (NMDedupMultiIndex *multi_idx, NMPlatform *platform, int i
 	return self;
 }
 
+/**
+ * nm_ip4_config_capture_update_addresses:
+ * @self: a #NMIP4Config created by nm_ip4_config_capture()
+ * @platform: the #NMPlatform
+ *
+ * Replaces the addresses of @self with the ones currently in the platform
+ * cache, like nm_ip4_config_capture() would capture them. The routes are
+ * left untouched.
+ */
+void
+nm_ip4_config_capture_update_addresses (NMIP4Config *self, NMPlatform *platform)
+{
+	g_return_if_fail (NM_IS_IP4_CONFIG (self));
+
+	g_object_freeze_notify (G_OBJECT (self));
+	nm_ip4_config_reset_addresses (self);
+	_capture_addresses (self, platform);
+	g_object_thaw_notify (G_OBJECT (self));
+}
+
+/**
+ * nm_ip4_config_capture_update_route:
+ * @self: a #NMIP4Config created by nm_ip4_config_capture()
+ * @platform: the #NMPlatform
+ * @needle: a route of the interface that changed in platform
+ *
+ * Updates @self with the current state of @needle in the platform cache. If
+ * the route is no longer in the cache, it gets removed from @self. This
+ * allows to keep a captured configuration up to date without capturing all
+ * routes again.
+ */
+void
+nm_ip4_config_capture_update_route (NMIP4Config *self, NMPlatform *platform, const NMPObject *needle)
+{
+	const NMPObject *plobj;
+
+	g_return_if_fail (NM_IS_IP4_CONFIG (self));
+	nm_assert (NMP_OBJECT_GET_TYPE (needle) == NMP_OBJECT_TYPE_IP4_ROUTE);
+	nm_assert (NMP_OBJECT_CAST_IP4_ROUTE (needle)->ifindex == NM_IP4_CONFIG_GET_PRIVATE (self)->ifindex);
+
+	plobj = nm_platform_lookup_obj (platform, NMP_CACHE_ID_TYPE_OBJECT_TYPE, needle);
+	if (plobj)
+		_add_route (self, plobj, NULL, NULL);
+	else
+		nm_ip4_config_nmpobj_remove (self, needle);
+}
+
 void
 nm_ip4_config_update_routes_metric (NMIP4Config *self, gint64 metric)
 {
@@ -843,6 +900,7 @@ _nm_ip_config_merge_route_attributes (int addr_family,
 	NMIPAddr addr;
 	NMPlatformIP4Route *r4 = (NMPlatformIP4Route *) r;
 	NMPlatformIP6Route *r6 = (NMPlatformIP6Route *) r;
+	NMPlatformRouteRtax rtax;
 	gboolean onlink;
 
 	nm_assert (s_route);
@@ -893,16 +951,18 @@ _nm_ip_config_merge_route_attributes (int addr_family,
 
 	r->r_rtm_flags = ((onlink) ? (unsigned) RTNH_F_ONLINK : 0u);
 
-	GET_ATTR (NM_IP_ROUTE_ATTRIBUTE_WINDOW,         r->window,         UINT32,   uint32, 0);
-	GET_ATTR (NM_IP_ROUTE_ATTRIBUTE_CWND,           r->cwnd,           UINT32,   uint32, 0);
-	GET_ATTR (NM_IP_ROUTE_ATTRIBUTE_INITCWND,       r->initcwnd,       UINT32,   uint32, 0);
-	GET_ATTR (NM_IP_ROUTE_ATTRIBUTE_INITRWND,       r->initrwnd,       UINT32,   uint32, 0);
-	GET_ATTR (NM_IP_ROUTE_ATTRIBUTE_MTU,            r->mtu,            UINT32,   uint32, 0);
-	GET_ATTR (NM_IP_ROUTE_ATTRIBUTE_LOCK_WINDOW,    r->lock_window,    BOOLEAN,  boolean, FALSE);
-	GET_ATTR (NM_IP_ROUTE_ATTRIBUTE_LOCK_CWND,      r->lock_cwnd,      BOOLEAN,  boolean, FALSE);
-	GET_ATTR (NM_IP_ROUTE_ATTRIBUTE_LOCK_INITCWND,  r->lock_initcwnd,  BOOLEAN,  boolean, FALSE);
-	GET_ATTR (NM_IP_ROUTE_ATTRIBUTE_LOCK_INITRWND,  r->lock_initrwnd,  BOOLEAN,  boolean, FALSE);
-	GET_ATTR (NM_IP_ROUTE_ATTRIBUTE_LOCK_MTU,       r->lock_mtu,       BOOLEAN,  boolean, FALSE);
+	GET_ATTR (NM_IP_ROUTE_ATTRIBUTE_WINDOW,         rtax.window,         UINT32,   uint32, 0);
+	GET_ATTR (NM_IP_ROUTE_ATTRIBUTE_CWND,           rtax.cwnd,           UINT32,   uint32, 0);
+	GET_ATTR (NM_IP_ROUTE_ATTRIBUTE_INITCWND,       rtax.initcwnd,       UINT32,   uint32, 0);
+	GET_ATTR (NM_IP_ROUTE_ATTRIBUTE_INITRWND,       rtax.initrwnd,       UINT32,   uint32, 0);
+	GET_ATTR (NM_IP_ROUTE_ATTRIBUTE_MTU,            rtax.mtu,            UINT32,   uint32, 0);
+	GET_ATTR (NM_IP_ROUTE_ATTRIBUTE_LOCK_WINDOW,    rtax.lock_window,    BOOLEAN,  boolean, FALSE);
+	GET_ATTR (NM_IP_ROUTE_ATTRIBUTE_LOCK_CWND,      rtax.lock_cwnd,      BOOLEAN,  boolean, FALSE);
+	GET_ATTR (NM_IP_ROUTE_ATTRIBUTE_LOCK_INITCWND,  rtax.lock_initcwnd,  BOOLEAN,  boolean, FALSE);
+	GET_ATTR (NM_IP_ROUTE_ATTRIBUTE_LOCK_INITRWND,  rtax.lock_initrwnd,  BOOLEAN,  boolean, FALSE);
+	GET_ATTR (NM_IP_ROUTE_ATTRIBUTE_LOCK_MTU,       rtax.lock_mtu,       BOOLEAN,  boolean, FALSE);
+
+	r->rtax_id = nm_platform_route_rtax_intern (&rtax);
 
 	if (   (variant = nm_ip_route_get_attribute (s_route, NM_IP_ROUTE_ATTRIBUTE_SRC))
 	    && g_variant_is_of_type (variant, G_VARIANT_TYPE_STRING)) {
@@ -3375,6 +3435,19 @@ nm_ip4_config_new (NMDedupMultiIndex *multi_idx, int ifindex)
 	                                     NULL);
 }
 
+NMIP4Config *
+nm_ip4_config_new_cloned (const NMIP4Config *src)
+{
+	NMIP4Config *new;
+
+	g_return_val_if_fail (NM_IS_IP4_CONFIG (src), NULL);
+
+	new = nm_ip4_config_new (nm_ip4_config_get_multi_idx (src),
+	                         nm_ip4_config_get_ifindex (src));
+	nm_ip4_config_replace (new, src, NULL);
+	return new;
+}
+
 static void
 finalize (GObject *object)
 {
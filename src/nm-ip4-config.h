@@ -148,6 +148,7 @@ GType nm_ip4_config_get_type (void);
 
 NMIP4Config * nm_ip4_config_new (NMDedupMultiIndex *multi_idx,
                                  int ifindex);
+NMIP4Config * nm_ip4_config_new_cloned (const NMIP4Config *src);
 
 NMIP4Config *nm_ip4_config_clone (const NMIP4Config *self);
 int nm_ip4_config_get_ifindex (const NMIP4Config *self);
@@ -155,6 +156,8 @@ int nm_ip4_config_get_ifindex (const NMIP4Config *self);
 NMDedupMultiIndex *nm_ip4_config_get_multi_idx (const NMIP4Config *self);
 
 NMIP4Config *nm_ip4_config_capture (NMDedupMultiIndex *multi_idx, NMPlatform *platform, int ifindex);
+void nm_ip4_config_capture_update_addresses (NMIP4Config *self, NMPlatform *platform);
+void nm_ip4_config_capture_update_route (NMIP4Config *self, NMPlatform *platform, const NMPObject *needle);
 
 void nm_ip4_config_add_dependent_routes (NMIP4Config *self,
                                          guint32 route_table,
@@ -365,16 +365,62 @@ nm_ip6_config_clone (const NMIP6Config *self)
 	return copy;
 }
 
+static void
+_capture_addresses (NMIP6Config *self, NMPlatform *platform, NMSettingIP6ConfigPrivacy use_temporary)
+{
+	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
+	const NMDedupMultiHeadEntry *head_entry;
+	NMDedupMultiIter iter;
+	const NMPObject *plobj = NULL;
+
+	head_entry = nm_platform_lookup_object (platform,
+	                                        NMP_OBJECT_TYPE_IP6_ADDRESS,
+	                                        priv->ifindex);
+	if (!head_entry)
+		return;
+
+	nmp_cache_iter_for_each (&iter, head_entry, &plobj) {
+		if (!_nm_ip_config_add_obj (priv->multi_idx,
+		                            &priv->idx_ip6_addresses_,
+		                            priv->ifindex,
+		                            plobj,
+		                            NULL,
+		                            FALSE,
+		                            TRUE,
+		                            NULL,
+		                            NULL))
+			nm_assert_not_reached ();
+	}
+	head_entry = nm_ip6_config_lookup_addresses (self);
+	nm_assert (head_entry);
+	nm_dedup_multi_head_entry_sort (head_entry,
+	                                sort_captured_addresses,
+	                                GINT_TO_POINTER (use_temporary));
+	_notify_addresses (self);
+}
+
+static void
+_capture_ipv6_disabled (NMIP6Config *self, NMPlatform *platform)
+{
+	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
+	char ifname[IFNAMSIZ];
+	char *path;
+
+	priv->ipv6_disabled = FALSE;
+	if (nm_platform_if_indextoname (platform, priv->ifindex, ifname)) {
+		path = nm_sprintf_bufa (128, "/proc/sys/net/ipv6/conf/%s/disable_ipv6", ifname);
+		if (nm_platform_sysctl_get_int32 (platform, NMP_SYSCTL_PATHID_ABSOLUTE (path), 0) != 0)
+			priv->ipv6_disabled = TRUE;
+	}
+}
+
 NMIP6Config *
 nm_ip6_config_capture (NMDedupMultiIndex *multi_idx, NMPlatform *platform, int ifindex, NMSettingIP6ConfigPrivacy use_temporary)
 {
 	NMIP6Config *self;
-	NMIP6ConfigPrivate *priv;
 	const NMDedupMultiHeadEntry *head_entry;
 	NMDedupMultiIter iter;
 	const NMPObject *plobj = NULL;
-	char ifname[IFNAMSIZ];
-	char *path;
 
 	nm_assert (ifindex > 0);
 
@@ -383,31 +429,8 @@ nm_ip6_config_capture (NMDedupMultiIndex *multi_idx, NMPlatform *platform, int i
 		return NULL;
 
 	self = nm_ip6_config_new (multi_idx, ifindex);
-	priv = NM_IP6_CONFIG_GET_PRIVATE (self);
 
-	head_entry = nm_platform_lookup_object (platform,
-	                                        NMP_OBJECT_TYPE_IP6_ADDRESS,
-	                                        ifindex);
-	if (head_entry) {
-		nmp_cache_iter_for_each (&iter, head_entry, &plobj) {
-			if (!_nm_ip_config_add_obj (priv->multi_idx,
-			                            &priv->idx_ip6_addresses_,
-			                            ifindex,
-			                            plobj,
-			                            NULL,
-			                            FALSE,
-			                            TRUE,
-			                            NULL,
-			                            NULL))
-				nm_assert_not_reached ();
-		}
-		head_entry = nm_ip6_config_lookup_addresses (self);
-		nm_assert (head_entry);
-		nm_dedup_multi_head_entry_sort (head_entry,
-		                                sort_captured_addresses,
-		                                GINT_TO_POINTER (use_temporary));
-		_notify_addresses (self);
-	}
+	_capture_addresses (self, platform, use_temporary);
 
 	head_entry = nm_platform_lookup_object (platform,
 	                                        NMP_OBJECT_TYPE_IP6_ROUTE,
@@ -416,15 +439,59 @@ nm_ip6_config_capture (NMDedupMultiIndex *multi_idx, NMPlatform *platform, int i
 	nmp_cache_iter_for_each (&iter, head_entry, &plobj)
 		_add_route (self, plobj, NULL, NULL);
 
-	if (nm_platform_if_indextoname (platform, ifindex, ifname)) {
-		path = nm_sprintf_bufa (128, "/proc/sys/net/ipv6/conf/%s/disable_ipv6", ifname);
-		if (nm_platform_sysctl_get_int32 (platform, NMP_SYSCTL_PATHID_ABSOLUTE (path), 0) != 0)
-			priv->ipv6_disabled = TRUE;
-	}
+	_capture_ipv6_disabled (self, platform);
 
 	return self;
 }
 
+/**
+ * nm_ip6_config_capture_update_addresses:
+ * @self: a #NMIP6Config created by nm_ip6_config_capture()
+ * @platform: the #NMPlatform
+ * @use_temporary: the same value that was passed to nm_ip6_config_capture()
+ *
+ * Replaces the addresses of @self with the ones currently in the platform
+ * cache, like nm_ip6_config_capture() would capture them. The routes are
+ * left untouched. Since toggling disable_ipv6 flushes or regenerates
+ * addresses, that flag is refreshed as well.
+ */
+void
+nm_ip6_config_capture_update_addresses (NMIP6Config *self, NMPlatform *platform, NMSettingIP6ConfigPrivacy use_temporary)
+{
+	g_return_if_fail (NM_IS_IP6_CONFIG (self));
+
+	g_object_freeze_notify (G_OBJECT (self));
+	nm_ip6_config_reset_addresses (self);
+	_capture_addresses (self, platform, use_temporary);
+	_capture_ipv6_disabled (self, platform);
+	g_object_thaw_notify (G_OBJECT (self));
+}
+
+/**
+ * nm_ip6_config_capture_update_route:
+ * @self: a #NMIP6Config created by nm_ip6_config_capture()
+ * @platform: the #NMPlatform
+ * @needle: a route of the interface that changed in platform
+ *
+ * Updates @self with the current state of @needle in the platform cache. If
+ * the route is no longer in the cache, it gets removed from @self.
+ */
+void
+nm_ip6_config_capture_update_route (NMIP6Config *self, NMPlatform *platform, const NMPObject *needle)
+{
+	const NMPObject *plobj;
+
+	g_return_if_fail (NM_IS_IP6_CONFIG (self));
+	nm_assert (NMP_OBJECT_GET_TYPE (needle) == NMP_OBJECT_TYPE_IP6_ROUTE);
+	nm_assert (NMP_OBJECT_CAST_IP6_ROUTE (needle)->ifindex == NM_IP6_CONFIG_GET_PRIVATE (self)->ifindex);
+
+	plobj = nm_platform_lookup_obj (platform, NMP_CACHE_ID_TYPE_OBJECT_TYPE, needle);
+	if (plobj)
+		_add_route (self, plobj, NULL, NULL);
+	else
+		nm_ip6_config_nmpobj_remove (self, needle);
+}
+
 void
 nm_ip6_config_update_routes_metric (NMIP6Config *self, gint64 metric)
 {
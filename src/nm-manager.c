@@ -1098,6 +1098,39 @@ nm_manager_get_activatable_connections (NMManager *manager,
 	                                          NULL);
 }
 
+/**
+ * nm_manager_get_autoconnect_candidates:
+ * @manager: the #NMManager
+ * @device: the device to autoconnect
+ * @out_len: (allow-none): the number of returned profiles
+ *
+ * Like nm_manager_get_activatable_connections() for auto activation and
+ * sorted, but only returns the profiles that could be compatible with
+ * @device, according to the index of #NMSettings.
+ *
+ * Returns: (transfer container): the %NULL terminated list of candidates.
+ */
+NMSettingsConnection **
+nm_manager_get_autoconnect_candidates (NMManager *manager,
+                                       NMDevice *device,
+                                       guint *out_len)
+{
+	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (manager);
+	const GetActivatableConnectionsFilterData d = {
+		.self = manager,
+		.for_auto_activation = TRUE,
+	};
+	NMSettingsAutoconnectLookup lookup;
+
+	nm_device_get_autoconnect_lookup (device, &lookup);
+
+	return nm_settings_get_autoconnect_candidates (priv->settings,
+	                                               &lookup,
+	                                               _get_activatable_connections_filter,
+	                                               (gpointer) &d,
+	                                               out_len);
+}
+
 static NMActiveConnection *
 active_connection_get_by_path (NMManager *self, const char *path)
 {
@@ -1117,11 +1150,139 @@ active_connection_get_by_path (NMManager *self, const char *path)
 
 /*****************************************************************************/
 
+static gboolean
+_route_cache_scope_parse_protocol (const char *str, guint8 *out_protocol)
+{
+	static const struct {
+		const char *name;
+		guint8 protocol;
+	} names[] = {
+		{ "zebra", 11  },
+		{ "bird",  12  },
+		{ "babel", 42  },
+		{ "bgp",   186 },
+		{ "isis",  187 },
+		{ "ospf",  188 },
+		{ "rip",   189 },
+		{ "eigrp", 192 },
+	};
+	gint64 v;
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS (names); i++) {
+		if (g_ascii_strcasecmp (str, names[i].name) == 0) {
+			*out_protocol = names[i].protocol;
+			return TRUE;
+		}
+	}
+
+	v = _nm_utils_ascii_str_to_int64 (str, 0, 0, G_MAXUINT8, -1);
+	if (v < 0)
+		return FALSE;
+	*out_protocol = v;
+	return TRUE;
+}
+
+static void
+_route_cache_scope_apply (NMManager *self, NMConfigData *config_data)
+{
+	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (self);
+	gs_free char *str_protocols = NULL;
+	gs_free char *str_tables = NULL;
+	gs_free const char **strv_protocols = NULL;
+	gs_free const char **strv_tables = NULL;
+	gs_unref_array GArray *protocols = NULL;
+	gs_unref_array GArray *tables = NULL;
+	gsize i;
+
+	str_protocols = nm_config_data_get_value (config_data,
+	                                          NM_CONFIG_KEYFILE_GROUP_MAIN,
+	                                          NM_CONFIG_KEYFILE_KEY_MAIN_ROUTE_CACHE_IGNORE_PROTOCOLS,
+	                                          NM_CONFIG_GET_VALUE_STRIP);
+	str_tables = nm_config_data_get_value (config_data,
+	                                       NM_CONFIG_KEYFILE_GROUP_MAIN,
+	                                       NM_CONFIG_KEYFILE_KEY_MAIN_ROUTE_CACHE_IGNORE_TABLES,
+	                                       NM_CONFIG_GET_VALUE_STRIP);
+
+	protocols = g_array_new (FALSE, FALSE, sizeof (guint8));
+	strv_protocols = nm_utils_strsplit_set (str_protocols, ", ");
+	for (i = 0; strv_protocols && strv_protocols[i]; i++) {
+		guint8 p;
+
+		if (!_route_cache_scope_parse_protocol (strv_protocols[i], &p)) {
+			_LOGW (LOGD_CORE, "config: invalid route protocol \"%s\" in %s",
+			       strv_protocols[i], NM_CONFIG_KEYFILE_KEY_MAIN_ROUTE_CACHE_IGNORE_PROTOCOLS);
+			continue;
+		}
+		g_array_append_val (protocols, p);
+	}
+
+	tables = g_array_new (FALSE, FALSE, sizeof (guint32));
+	strv_tables = nm_utils_strsplit_set (str_tables, ", ");
+	for (i = 0; strv_tables && strv_tables[i]; i++) {
+		gint64 v;
+		guint32 t;
+
+		v = _nm_utils_ascii_str_to_int64 (strv_tables[i], 0, 1, G_MAXUINT32, -1);
+		if (v < 0) {
+			_LOGW (LOGD_CORE, "config: invalid route table \"%s\" in %s",
+			       strv_tables[i], NM_CONFIG_KEYFILE_KEY_MAIN_ROUTE_CACHE_IGNORE_TABLES);
+			continue;
+		}
+		t = v;
+		g_array_append_val (tables, t);
+	}
+
+	nm_platform_route_cache_scope_set (priv->platform,
+	                                   (const guint8 *) protocols->data,
+	                                   protocols->len,
+	                                   (const guint32 *) tables->data,
+	                                   tables->len);
+}
+
+static void
+_netlink_config_apply (NMManager *self, NMConfigData *config_data)
+{
+	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (self);
+	gs_free char *str_resync = NULL;
+	gint64 rcvbuf_max;
+	gboolean resync_affected_only = FALSE;
+
+	rcvbuf_max = nm_config_data_get_value_int64 (config_data,
+	                                             NM_CONFIG_KEYFILE_GROUP_MAIN,
+	                                             NM_CONFIG_KEYFILE_KEY_MAIN_NETLINK_RCVBUF_MAX,
+	                                             10, 0, G_MAXINT, 0);
+
+	str_resync = nm_config_data_get_value (config_data,
+	                                       NM_CONFIG_KEYFILE_GROUP_MAIN,
+	                                       NM_CONFIG_KEYFILE_KEY_MAIN_NETLINK_RESYNC,
+	                                       NM_CONFIG_GET_VALUE_STRIP | NM_CONFIG_GET_VALUE_NO_EMPTY);
+	if (nm_streq0 (str_resync, "affected"))
+		resync_affected_only = TRUE;
+	else if (!NM_IN_STRSET (str_resync, NULL, "all")) {
+		_LOGW (LOGD_CORE, "config: invalid value \"%s\" for %s",
+		       str_resync, NM_CONFIG_KEYFILE_KEY_MAIN_NETLINK_RESYNC);
+	}
+
+	nm_platform_netlink_config_set (priv->platform, rcvbuf_max, resync_affected_only);
+
+	nm_platform_netlink_worker_set (priv->platform,
+	                                nm_config_data_get_value_boolean (config_data,
+	                                                                  NM_CONFIG_KEYFILE_GROUP_MAIN,
+	                                                                  NM_CONFIG_KEYFILE_KEY_MAIN_NETLINK_WORKER,
+	                                                                  FALSE));
+}
+
 static void
 _config_changed_cb (NMConfig *config, NMConfigData *config_data, NMConfigChangeFlags changes, NMConfigData *old_data, NMManager *self)
 {
 	g_object_freeze_notify (G_OBJECT (self));
 
+	if (NM_FLAGS_HAS (changes, NM_CONFIG_CHANGE_VALUES)) {
+		_route_cache_scope_apply (self, config_data);
+		_netlink_config_apply (self, config_data);
+	}
+
 	if (NM_FLAGS_HAS (changes, NM_CONFIG_CHANGE_GLOBAL_DNS_CONFIG))
 		_notify (self, PROP_GLOBAL_DNS_CONFIGURATION);
 
@@ -3534,6 +3695,8 @@ platform_query_devices (NMManager *self)
 {
 	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (self);
 	gs_unref_ptrarray GPtrArray *links = NULL;
+	gs_free int *ifindexes = NULL;
+	NMDBusManager *dbus_manager;
 	int i;
 	gboolean guess_assume;
 	gs_free char *order = NULL;
@@ -3546,6 +3709,22 @@ platform_query_devices (NMManager *self)
 	links = nm_platform_link_get_all (priv->platform, !nm_streq0 (order, "index"));
 	if (!links)
 		return;
+
+	/* On boot there may be many links. Realizing them one by one costs a
+	 * series of blocking ethtool ioctls per device and a PropertiesChanged
+	 * signal on the manager for each new device. Instead, fetch the ethtool
+	 * information for all links up-front (in parallel) into the platform's
+	 * ethtool cache, and announce the new devices together, once they are
+	 * all realized. */
+	dbus_manager = nm_dbus_object_get_manager (NM_DBUS_OBJECT (self));
+	g_object_freeze_notify (G_OBJECT (self));
+	nm_dbus_manager_export_freeze (dbus_manager);
+
+	ifindexes = g_new (int, links->len);
+	for (i = 0; i < links->len; i++)
+		ifindexes[i] = NMP_OBJECT_CAST_LINK (links->pdata[i])->ifindex;
+	nm_platform_link_ethtool_prefetch (priv->platform, ifindexes, links->len);
+
 	for (i = 0; i < links->len; i++) {
 		const NMPlatformLink *link = NMP_OBJECT_CAST_LINK (links->pdata[i]);
 		const NMConfigDeviceStateData *dev_state;
@@ -3557,6 +3736,9 @@ platform_query_devices (NMManager *self)
 		                     guess_assume && (!dev_state || !dev_state->connection_uuid),
 		                     dev_state);
 	}
+
+	nm_dbus_manager_export_thaw (dbus_manager);
+	g_object_thaw_notify (G_OBJECT (self));
 }
 
 static void
@@ -6705,6 +6887,9 @@ nm_manager_start (NMManager *self, GError **error)
 	if (!nm_settings_start (priv->settings, error))
 		return FALSE;
 
+	_route_cache_scope_apply (self, NM_CONFIG_GET_DATA);
+	_netlink_config_apply (self, NM_CONFIG_GET_DATA);
+
 	nm_platform_process_events (priv->platform);
 
 	g_signal_connect (priv->platform,
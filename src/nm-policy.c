@@ -1223,6 +1223,7 @@ auto_activate_device (NMPolicy *self,
 	gs_free_error GError *error = NULL;
 	gs_unref_object NMAuthSubject *subject = NULL;
 	NMActiveConnection *ac;
+	guint64 n_checks;
 
 	nm_assert (NM_IS_POLICY (self));
 	nm_assert (NM_IS_DEVICE (device));
@@ -1239,10 +1240,14 @@ auto_activate_device (NMPolicy *self,
 	if (!nm_device_autoconnect_allowed (device))
 		return;
 
-	connections = nm_manager_get_activatable_connections (priv->manager, TRUE, TRUE, &len);
+	/* only consider the profiles that could be compatible with the device, instead
+	 * of running the full compatibility check for every profile. */
+	connections = nm_manager_get_autoconnect_candidates (priv->manager, device, &len);
 	if (!connections[0])
 		return;
 
+	n_checks = nm_device_check_connection_compatible_get_count ();
+
 	/* Find the first connection that should be auto-activated */
 	best_connection = NULL;
 	for (i = 0; i < len; i++) {
@@ -1271,6 +1276,12 @@ auto_activate_device (NMPolicy *self,
 		}
 	}
 
+	_LOGT (LOGD_DEVICE, "auto-activate: %s: %u candidates, %"G_GUINT64_FORMAT" compatibility checks (%"G_GUINT64_FORMAT" in total)",
+	       nm_device_get_iface (device),
+	       len,
+	       nm_device_check_connection_compatible_get_count () - n_checks,
+	       nm_device_check_connection_compatible_get_count ());
+
 	if (!best_connection)
 		return;
 
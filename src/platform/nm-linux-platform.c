@@ -20,10 +20,12 @@
 #include <linux/if_tun.h>
 #include <linux/if_tunnel.h>
 #include <linux/ip6_tunnel.h>
+#include <linux/netconf.h>
 #include <linux/tc_act/tc_mirred.h>
 #include <netinet/icmp6.h>
 #include <netinet/in.h>
 #include <poll.h>
+#include <sys/eventfd.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <unistd.h>
@@ -152,6 +154,21 @@ G_STATIC_ASSERT (RTA_MAX == (__RTA_MAX - 1));
 
 /*****************************************************************************/
 
+#define NETCONFA_PROXY_NEIGH                    5
+#define NETCONFA_IGNORE_ROUTES_WITH_LINKDOWN    6
+
+#ifndef NETCONFA_IFINDEX_ALL
+#define NETCONFA_IFINDEX_ALL            -1
+#define NETCONFA_IFINDEX_DEFAULT        -2
+#endif
+
+/* Appeared in kernel 4.12 */
+#ifndef RTM_DELNETCONF
+#define RTM_DELNETCONF                  81
+#endif
+
+/*****************************************************************************/
+
 /* Appeared in in kernel prior to 3.13 dated 19 January, 2014 */
 #ifndef ARPHRD_6LOWPAN
 #define ARPHRD_6LOWPAN 825
@@ -418,6 +435,9 @@ typedef struct {
 
 /*****************************************************************************/
 
+typedef struct _NLWorker NLWorker;
+typedef struct _SysctlBatchJob SysctlBatchJob;
+
 typedef struct {
 	struct nl_sock *genl;
 
@@ -431,11 +451,72 @@ typedef struct {
 #endif
 	guint32 nlh_seq_last_seen;
 
+	/* whether kernel honors filters in dump requests (NETLINK_GET_STRICT_CHK). */
+	bool nlh_strict_check:1;
+
+	/* reusable buffers to receive several datagrams per syscall. */
+	NLRecvBatch *nlh_recv_batch;
+	guint nlh_recv_batch_nesting;
+
+	/* if set, a thread reads @nlh and parses the messages. */
+	NLWorker *nl_worker;
+
+	struct {
+		/* the requested receive buffer size of the event socket. It grows
+		 * on overflow up to @rcvbuf_max. */
+		int rcvbuf_size;
+		int rcvbuf_max;
+
+		/* on overflow, only resync right away the types for which we saw
+		 * events. The others are resynced after the storm settles. */
+		bool resync_affected_only:1;
+
+		/* the refresh-all types for which we received events since the last resync. */
+		DelayedActionType types_seen;
+
+		DelayedActionType resync_deferred;
+		guint resync_deferred_id;
+		gint64 resync_deferred_since_msec;
+
+		guint n_overflows;
+		guint n_resyncs[_REFRESH_ALL_TYPE_NUM];
+	} nl_event;
+
 	guint32 pruning[_REFRESH_ALL_TYPE_NUM];
 
+	/* the link that link_refresh() currently requests. If it is a WireGuard
+	 * link, its configuration gets refetched. See _new_from_nl_link(). */
+	int wireguard_refresh_ifindex;
+
 	GHashTable *sysctl_get_prev_values;
 	CList sysctl_list;
 
+	struct {
+		/* cached values of /proc/sys/net/ipv{4,6}/conf/$IFNAME/$PROPERTY,
+		 * indexed by $IFNAME. See _sysctl_cache_lookup(). */
+		GHashTable *by_ifname;
+
+		/* whether we receive RTM_NEWNETCONF notifications. If so,
+		 * the values that kernel reports there don't expire. */
+		bool netconf_subscribed:1;
+
+		NMPlatformSysctlCacheStats stats;
+	} sysctl_cache;
+
+	struct {
+		/* protects SysctlBatchJob.applied. */
+		GMutex lock;
+		GCond cond;
+
+		/* the batch handed to the worker pool. There is at most one per
+		 * platform instance, the others wait in @queued. */
+		SysctlBatchJob *in_flight;
+		GQueue queued;
+
+		/* directories with pending writes, and the number of writes. */
+		GHashTable *pending;
+	} sysctl_batch;
+
 	NMUdevClient *udev_client;
 
 	struct {
@@ -528,6 +609,7 @@ static void delayed_action_schedule (NMPlatform *platform, DelayedActionType act
 static gboolean delayed_action_handle_all (NMPlatform *platform, gboolean read_netlink);
 static void do_request_link_no_delayed_actions (NMPlatform *platform, int ifindex, const char *name);
 static void do_request_all_no_delayed_actions (NMPlatform *platform, DelayedActionType action_type);
+static void do_request_filtered (NMPlatform *platform, NMPObjectType obj_type, int ifindex, guint32 table);
 static void cache_on_change (NMPlatform *platform,
                              NMPCacheOpsType cache_op,
                              const NMPObject *obj_old,
@@ -2697,6 +2779,12 @@ link_wireguard_change (NMPlatform *platform,
 {
 	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
 	gs_unref_ptrarray GPtrArray *msgs = NULL;
+	nm_auto_nmpobj const NMPObject *lnk_cached = NULL;
+	gs_free NMPWireGuardPeer *d_peers = NULL;
+	gs_free NMPlatformWireGuardChangePeerFlags *d_peer_flags = NULL;
+	gs_free NMPWireGuardAllowedIP *d_allowed_ips_buf = NULL;
+	guint d_peers_len = 0;
+	const NMPObject *plink;
 	int wireguard_family_id;
 	guint i;
 	int r;
@@ -2705,6 +2793,56 @@ link_wireguard_change (NMPlatform *platform,
 	if (wireguard_family_id < 0)
 		return -NME_PL_NO_FIRMWARE;
 
+	/* Only send what differs from the cached configuration. The cache gets
+	 * refetched with every RTM_NEWLINK message and after each of our changes
+	 * (see below). WireGuard sends no notifications, so to pick up changes
+	 * done by somebody else in the meantime, the caller must refresh the
+	 * link first. We don't dump all peers here a second time. */
+	nm_platform_process_events (platform);
+	plink = nm_platform_link_get_obj (platform, ifindex, TRUE);
+	if (   plink
+	    && plink->link.type == NM_LINK_TYPE_WIREGUARD
+	    && NMP_OBJECT_GET_TYPE (plink->_link.netlink.lnk) == NMP_OBJECT_TYPE_LNK_WIREGUARD)
+		lnk_cached = nmp_object_ref (plink->_link.netlink.lnk);
+
+	if (lnk_cached) {
+		guint n_peers_changed = 0;
+
+		nmp_object_lnk_wireguard_create_change_delta (lnk_cached,
+		                                              lnk_wireguard,
+		                                              peers,
+		                                              peer_flags,
+		                                              peers_len,
+		                                              &change_flags,
+		                                              &d_peers,
+		                                              &d_peer_flags,
+		                                              &d_peers_len,
+		                                              &d_allowed_ips_buf);
+
+		for (i = 0; i < d_peers_len; i++) {
+			if (d_peer_flags[i] != NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_NONE)
+				n_peers_changed++;
+		}
+
+		_LOGT ("wireguard: set-device, %u peers to add, update or remove (%u requested, %u configured)",
+		       n_peers_changed,
+		       peers_len,
+		       lnk_cached->_lnk_wireguard.peers_len);
+
+		if (   n_peers_changed == 0
+		    && !NM_FLAGS_ANY (change_flags,   NM_PLATFORM_WIREGUARD_CHANGE_FLAG_HAS_PRIVATE_KEY
+		                                    | NM_PLATFORM_WIREGUARD_CHANGE_FLAG_HAS_LISTEN_PORT
+		                                    | NM_PLATFORM_WIREGUARD_CHANGE_FLAG_HAS_FWMARK)) {
+			_LOGT ("wireguard: set-device, already configured as requested");
+			nm_explicit_bzero (d_peers, sizeof (d_peers[0]) * d_peers_len);
+			return 0;
+		}
+
+		peers = d_peers;
+		peer_flags = d_peer_flags;
+		peers_len = d_peers_len;
+	}
+
 	r = _wireguard_create_change_nlmsgs (platform,
 	                                     ifindex,
 	                                     wireguard_family_id,
@@ -2714,6 +2852,9 @@ link_wireguard_change (NMPlatform *platform,
 	                                     peers_len,
 	                                     change_flags,
 	                                     &msgs);
+	if (d_peers)
+		nm_explicit_bzero (d_peers, sizeof (d_peers[0]) * d_peers_len);
+
 	if (r < 0) {
 		_LOGW ("wireguard: set-device, cannot construct netlink message: %s", nm_strerror (r));
 		return r;
@@ -3058,31 +3199,52 @@ _new_from_nl_link (NMPlatform *platform, const NMPCache *cache, struct nlmsghdr
 	}
 
 	if (obj->link.type == NM_LINK_TYPE_WIREGUARD) {
+		NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
 		const NMPObject *lnk_data_new = NULL;
-		struct nl_sock *genl = NM_LINUX_PLATFORM_GET_PRIVATE (platform)->genl;
-
-		/* The WireGuard kernel module does not yet send link update
-		 * notifications, so we don't actually update the cache. For
-		 * now, always refetch link data here. */
+		const NMPObject *lnk_data_cached = NULL;
+
+		/* The WireGuard kernel module does not send notifications when its
+		 * configuration changes, and RTM_NEWLINK messages carry none of it.
+		 * Dumping all peers is expensive for devices with many peers, and
+		 * RTM_NEWLINK messages are frequent. So, only fetch the WireGuard
+		 * data when we don't have it yet, or when the link gets refreshed
+		 * explicitly with nm_platform_link_refresh(). After our own changes,
+		 * _wireguard_refresh_link() refetches it too.
+		 *
+		 * If only the peer statistics (handshake time, rx/tx bytes) changed,
+		 * keep the cached data. The statistics change all the time, and we
+		 * don't want to emit a change signal for that. They are only updated
+		 * in the cache together with a change of the configuration. */
 
 		_lookup_cached_link (cache, obj->link.ifindex, completed_from_cache, &link_cached);
 		if (   link_cached
 		    && link_cached->_link.netlink.is_in_netlink
-		    && link_cached->link.type == NM_LINK_TYPE_WIREGUARD)
+		    && link_cached->link.type == NM_LINK_TYPE_WIREGUARD) {
 			obj->_link.wireguard_family_id = link_cached->_link.wireguard_family_id;
-		else
+			if (NMP_OBJECT_GET_TYPE (link_cached->_link.netlink.lnk) == NMP_OBJECT_TYPE_LNK_WIREGUARD)
+				lnk_data_cached = link_cached->_link.netlink.lnk;
+		} else
 			obj->_link.wireguard_family_id = -1;
 
 		if (obj->_link.wireguard_family_id < 0)
-			obj->_link.wireguard_family_id = genl_ctrl_resolve (genl, "wireguard");
+			obj->_link.wireguard_family_id = genl_ctrl_resolve (priv->genl, "wireguard");
 
-		if (obj->_link.wireguard_family_id >= 0) {
+		if (   obj->_link.wireguard_family_id >= 0
+		    && (   !lnk_data_cached
+		        || obj->link.ifindex == priv->wireguard_refresh_ifindex)) {
 			lnk_data_new = _wireguard_read_info (platform,
-			                                     genl,
+			                                     priv->genl,
 			                                     obj->_link.wireguard_family_id,
 			                                     obj->link.ifindex);
 		}
 
+		if (   lnk_data_cached
+		    && (   !lnk_data_new
+		        || nmp_object_lnk_wireguard_equal_config (lnk_data_cached, lnk_data_new))) {
+			nmp_object_unref (lnk_data_new);
+			lnk_data_new = nmp_object_ref (lnk_data_cached);
+		}
+
 		if (   lnk_data_new
 		    && obj->_link.netlink.lnk
 		    && nmp_object_equal (obj->_link.netlink.lnk, lnk_data_new))
@@ -3244,11 +3406,7 @@ _new_from_nl_route (struct nlmsghdr *nlh, gboolean id_only)
 		.is_present = FALSE,
 	};
 	guint32 mss;
-	guint32 window = 0;
-	guint32 cwnd = 0;
-	guint32 initcwnd = 0;
-	guint32 initrwnd = 0;
-	guint32 mtu = 0;
+	NMPlatformRouteRtax rtax = { 0 };
 	guint32 lock = 0;
 
 	if (!nlmsg_valid_hdr (nlh, sizeof (*rtm)))
@@ -3383,17 +3541,23 @@ rta_multipath_done:
 		if (mtb[RTAX_ADVMSS])
 			mss = nla_get_u32 (mtb[RTAX_ADVMSS]);
 		if (mtb[RTAX_WINDOW])
-			window = nla_get_u32 (mtb[RTAX_WINDOW]);
+			rtax.window = nla_get_u32 (mtb[RTAX_WINDOW]);
 		if (mtb[RTAX_CWND])
-			cwnd = nla_get_u32 (mtb[RTAX_CWND]);
+			rtax.cwnd = nla_get_u32 (mtb[RTAX_CWND]);
 		if (mtb[RTAX_INITCWND])
-			initcwnd = nla_get_u32 (mtb[RTAX_INITCWND]);
+			rtax.initcwnd = nla_get_u32 (mtb[RTAX_INITCWND]);
 		if (mtb[RTAX_INITRWND])
-			initrwnd = nla_get_u32 (mtb[RTAX_INITRWND]);
+			rtax.initrwnd = nla_get_u32 (mtb[RTAX_INITRWND]);
 		if (mtb[RTAX_MTU])
-			mtu = nla_get_u32 (mtb[RTAX_MTU]);
+			rtax.mtu = nla_get_u32 (mtb[RTAX_MTU]);
 	}
 
+	rtax.lock_window   = NM_FLAGS_HAS (lock, 1 << RTAX_WINDOW);
+	rtax.lock_cwnd     = NM_FLAGS_HAS (lock, 1 << RTAX_CWND);
+	rtax.lock_initcwnd = NM_FLAGS_HAS (lock, 1 << RTAX_INITCWND);
+	rtax.lock_initrwnd = NM_FLAGS_HAS (lock, 1 << RTAX_INITRWND);
+	rtax.lock_mtu      = NM_FLAGS_HAS (lock, 1 << RTAX_MTU);
+
 	/*****************************************************************/
 
 	obj = nmp_object_new (is_v4 ? NMP_OBJECT_TYPE_IP4_ROUTE : NMP_OBJECT_TYPE_IP6_ROUTE, NULL);
@@ -3438,16 +3602,7 @@ rta_multipath_done:
 	}
 
 	obj->ip_route.mss = mss;
-	obj->ip_route.window = window;
-	obj->ip_route.cwnd = cwnd;
-	obj->ip_route.initcwnd = initcwnd;
-	obj->ip_route.initrwnd = initrwnd;
-	obj->ip_route.mtu = mtu;
-	obj->ip_route.lock_window   = NM_FLAGS_HAS (lock, 1 << RTAX_WINDOW);
-	obj->ip_route.lock_cwnd     = NM_FLAGS_HAS (lock, 1 << RTAX_CWND);
-	obj->ip_route.lock_initcwnd = NM_FLAGS_HAS (lock, 1 << RTAX_INITCWND);
-	obj->ip_route.lock_initrwnd = NM_FLAGS_HAS (lock, 1 << RTAX_INITRWND);
-	obj->ip_route.lock_mtu      = NM_FLAGS_HAS (lock, 1 << RTAX_MTU);
+	obj->ip_route.rtax_id = nm_platform_route_rtax_intern (&rtax);
 
 	if (!is_v4) {
 
@@ -3810,11 +3965,83 @@ _new_from_nl_qdisc (NMPlatform *platform, struct nlmsghdr *nlh, gboolean id_only
 	return g_steal_pointer (&obj);
 }
 
+static void
+_new_from_nl_tfilter_action (struct nlattr *options, NMPlatformAction *action)
+{
+	static const struct nla_policy policy[] = {
+		/* TCA_MATCHALL_ACT. The action table, as _nl_msg_new_tfilter() sends it. */
+		[2] = { .type = NLA_NESTED },
+	};
+	static const struct nla_policy act_tab_policy[] = {
+		/* the action with priority 1. */
+		[1] = { .type = NLA_NESTED },
+	};
+	static const struct nla_policy act_policy[] = {
+		[TCA_ACT_KIND]    = { .type = NLA_STRING },
+		[TCA_ACT_OPTIONS] = { .type = NLA_NESTED },
+	};
+	struct nlattr *tb[G_N_ELEMENTS (policy)];
+	struct nlattr *act_tab_tb[G_N_ELEMENTS (act_tab_policy)];
+	struct nlattr *act_tb[G_N_ELEMENTS (act_policy)];
+	const char *kind;
+
+	if (nla_parse_nested_arr (tb, options, policy) < 0)
+		return;
+	if (!tb[2])
+		return;
+	if (nla_parse_nested_arr (act_tab_tb, tb[2], act_tab_policy) < 0)
+		return;
+	if (!act_tab_tb[1])
+		return;
+	if (nla_parse_nested_arr (act_tb, act_tab_tb[1], act_policy) < 0)
+		return;
+	if (!act_tb[TCA_ACT_KIND])
+		return;
+
+	kind = nla_get_string (act_tb[TCA_ACT_KIND]);
+
+	if (nm_streq (kind, NM_PLATFORM_ACTION_KIND_SIMPLE)) {
+		static const struct nla_policy simple_policy[] = {
+			[TCA_DEF_DATA] = { .type = NLA_STRING },
+		};
+		struct nlattr *simple_tb[G_N_ELEMENTS (simple_policy)];
+
+		action->kind = NM_PLATFORM_ACTION_KIND_SIMPLE;
+		if (   act_tb[TCA_ACT_OPTIONS]
+		    && nla_parse_nested_arr (simple_tb, act_tb[TCA_ACT_OPTIONS], simple_policy) >= 0
+		    && simple_tb[TCA_DEF_DATA]) {
+			nla_strlcpy (action->simple.sdata,
+			             simple_tb[TCA_DEF_DATA],
+			             sizeof (action->simple.sdata));
+		}
+	} else if (nm_streq (kind, NM_PLATFORM_ACTION_KIND_MIRRED)) {
+		static const struct nla_policy mirred_policy[] = {
+			[TCA_MIRRED_PARMS] = { .minlen = sizeof (struct tc_mirred) },
+		};
+		struct nlattr *mirred_tb[G_N_ELEMENTS (mirred_policy)];
+		struct tc_mirred sel;
+
+		action->kind = NM_PLATFORM_ACTION_KIND_MIRRED;
+		if (   act_tb[TCA_ACT_OPTIONS]
+		    && nla_parse_nested_arr (mirred_tb, act_tb[TCA_ACT_OPTIONS], mirred_policy) >= 0
+		    && mirred_tb[TCA_MIRRED_PARMS]) {
+			nla_memcpy_checked_size (&sel, mirred_tb[TCA_MIRRED_PARMS], sizeof (sel));
+			action->mirred.ifindex = sel.ifindex;
+			action->mirred.egress = NM_IN_SET (sel.eaction, TCA_EGRESS_REDIR, TCA_EGRESS_MIRROR);
+			action->mirred.ingress = NM_IN_SET (sel.eaction, TCA_INGRESS_REDIR, TCA_INGRESS_MIRROR);
+			action->mirred.redirect = NM_IN_SET (sel.eaction, TCA_EGRESS_REDIR, TCA_INGRESS_REDIR);
+			action->mirred.mirror = NM_IN_SET (sel.eaction, TCA_EGRESS_MIRROR, TCA_INGRESS_MIRROR);
+		}
+	} else
+		action->kind = g_intern_string (kind);
+}
+
 static NMPObject *
 _new_from_nl_tfilter (struct nlmsghdr *nlh, gboolean id_only)
 {
 	static const struct nla_policy policy[] = {
-		[TCA_KIND] = { .type = NLA_STRING },
+		[TCA_KIND]    = { .type = NLA_STRING },
+		[TCA_OPTIONS] = { .type = NLA_NESTED },
 	};
 	struct nlattr *tb[G_N_ELEMENTS (policy)];
 	NMPObject *obj = NULL;
@@ -3837,6 +4064,13 @@ _new_from_nl_tfilter (struct nlmsghdr *nlh, gboolean id_only)
 	obj->tfilter.parent = tcm->tcm_parent;
 	obj->tfilter.info = tcm->tcm_info;
 
+	/* parse the action back, so that nm_platform_tfilter_sync() can tell
+	 * whether the filter is already configured as desired. */
+	if (   !id_only
+	    && tb[TCA_OPTIONS]
+	    && nm_streq (obj->tfilter.kind, "matchall"))
+		_new_from_nl_tfilter_action (tb[TCA_OPTIONS], &obj->tfilter.action);
+
 	return obj;
 }
 
@@ -4463,13 +4697,13 @@ nla_put_failure:
 }
 
 static guint32
-ip_route_get_lock_flag (const NMPlatformIPRoute *route)
+ip_route_get_lock_flag (const NMPlatformRouteRtax *rtax)
 {
-	return   (((guint32) route->lock_window)   << RTAX_WINDOW)
-	       | (((guint32) route->lock_cwnd)     << RTAX_CWND)
-	       | (((guint32) route->lock_initcwnd) << RTAX_INITCWND)
-	       | (((guint32) route->lock_initrwnd) << RTAX_INITRWND)
-	       | (((guint32) route->lock_mtu)      << RTAX_MTU);
+	return   (((guint32) rtax->lock_window)   << RTAX_WINDOW)
+	       | (((guint32) rtax->lock_cwnd)     << RTAX_CWND)
+	       | (((guint32) rtax->lock_initcwnd) << RTAX_INITCWND)
+	       | (((guint32) rtax->lock_initrwnd) << RTAX_INITRWND)
+	       | (((guint32) rtax->lock_mtu)      << RTAX_MTU);
 }
 
 /* Copied and modified from libnl3's build_route_msg() and rtnl_route_build_msg(). */
@@ -4481,7 +4715,8 @@ _nl_msg_new_route (int nlmsg_type,
 	nm_auto_nlmsg struct nl_msg *msg = NULL;
 	const NMPClass *klass = NMP_OBJECT_GET_CLASS (obj);
 	gboolean is_v4 = klass->addr_family == AF_INET;
-	const guint32 lock = ip_route_get_lock_flag (NMP_OBJECT_CAST_IP_ROUTE (obj));
+	const NMPlatformRouteRtax *rtax = NM_PLATFORM_IP_ROUTE_RTAX (NMP_OBJECT_CAST_IP_ROUTE (obj));
+	const guint32 lock = ip_route_get_lock_flag (rtax);
 	const guint32 table = nm_platform_route_table_uncoerce (NMP_OBJECT_CAST_IP_ROUTE (obj)->table_coerced, TRUE);
 	const struct rtmsg rtmsg = {
 		.rtm_family = klass->addr_family,
@@ -4539,11 +4774,11 @@ _nl_msg_new_route (int nlmsg_type,
 	}
 
 	if (   obj->ip_route.mss
-	    || obj->ip_route.window
-	    || obj->ip_route.cwnd
-	    || obj->ip_route.initcwnd
-	    || obj->ip_route.initrwnd
-	    || obj->ip_route.mtu
+	    || rtax->window
+	    || rtax->cwnd
+	    || rtax->initcwnd
+	    || rtax->initrwnd
+	    || rtax->mtu
 	    || lock) {
 		struct nlattr *metrics;
 
@@ -4553,16 +4788,16 @@ _nl_msg_new_route (int nlmsg_type,
 
 		if (obj->ip_route.mss)
 			NLA_PUT_U32 (msg, RTAX_ADVMSS, obj->ip_route.mss);
-		if (obj->ip_route.window)
-			NLA_PUT_U32 (msg, RTAX_WINDOW, obj->ip_route.window);
-		if (obj->ip_route.cwnd)
-			NLA_PUT_U32 (msg, RTAX_CWND, obj->ip_route.cwnd);
-		if (obj->ip_route.initcwnd)
-			NLA_PUT_U32 (msg, RTAX_INITCWND, obj->ip_route.initcwnd);
-		if (obj->ip_route.initrwnd)
-			NLA_PUT_U32 (msg, RTAX_INITRWND, obj->ip_route.initrwnd);
-		if (obj->ip_route.mtu)
-			NLA_PUT_U32 (msg, RTAX_MTU, obj->ip_route.mtu);
+		if (rtax->window)
+			NLA_PUT_U32 (msg, RTAX_WINDOW, rtax->window);
+		if (rtax->cwnd)
+			NLA_PUT_U32 (msg, RTAX_CWND, rtax->cwnd);
+		if (rtax->initcwnd)
+			NLA_PUT_U32 (msg, RTAX_INITCWND, rtax->initcwnd);
+		if (rtax->initrwnd)
+			NLA_PUT_U32 (msg, RTAX_INITRWND, rtax->initrwnd);
+		if (rtax->mtu)
+			NLA_PUT_U32 (msg, RTAX_MTU, rtax->mtu);
 		if (lock)
 			NLA_PUT_U32 (msg, RTAX_LOCK, lock);
 
@@ -5069,162 +5304,917 @@ sysctl_set_internal (NMPlatform *platform,
 
 /*****************************************************************************/
 
-static gboolean
-sysctl_set (NMPlatform *platform,
-            const char *pathid,
-            int dirfd,
-            const char *path,
-            const char *value)
+/* Values of ip conf sysctls are cached, because devices read them over
+ * and over (and on a box with thousands of VLANs, that adds up).
+ *
+ * The cache only contains /proc/sys/net/ipv{4,6}/conf/$IFNAME/$PROPERTY
+ * paths, which are resolved in the netns of the platform instance. The
+ * values for which kernel sends RTM_NEWNETCONF notifications are updated
+ * from there and stay valid. Everything else is only trusted for a short
+ * time, because somebody else might write to the file. */
+#define SYSCTL_CACHE_TTL_MSEC 5000
+
+typedef struct {
+	const char *property;
+	char *value;
+
+	/* 0 means the value is kept up to date via RTM_NEWNETCONF. */
+	gint64 expiry_msec;
+
+	char property_data[];
+} SysctlCacheValue;
+
+typedef struct {
+	const char *ifname;
+	GHashTable *values_x[2];
+	char ifname_data[];
+} SysctlCacheIf;
+
+static void
+_sysctl_cache_value_free (SysctlCacheValue *v)
 {
-	nm_auto_pop_netns NMPNetns *netns = NULL;
+	g_free (v->value);
+	g_free (v);
+}
 
-	g_return_val_if_fail (path, FALSE);
-	g_return_val_if_fail (value, FALSE);
+static void
+_sysctl_cache_if_free (SysctlCacheIf *cif)
+{
+	nm_clear_pointer (&cif->values_x[0], g_hash_table_destroy);
+	nm_clear_pointer (&cif->values_x[1], g_hash_table_destroy);
+	g_free (cif);
+}
 
-	ASSERT_SYSCTL_ARGS (pathid, dirfd, path);
+static gboolean
+_sysctl_cache_parse_path (const char *path,
+                          int *out_addr_family,
+                          char *out_ifname,
+                          const char **out_property)
+{
+	const char *s;
+	gsize l;
+
+	if (NM_STR_HAS_PREFIX (path, "/proc/sys/net/ipv4/conf/"))
+		*out_addr_family = AF_INET;
+	else if (NM_STR_HAS_PREFIX (path, "/proc/sys/net/ipv6/conf/"))
+		*out_addr_family = AF_INET6;
+	else
+		return FALSE;
 
-	if (   dirfd < 0
-	    && !nm_platform_netns_push (platform, &netns)) {
-		errno = ENETDOWN;
+	path += NM_STRLEN ("/proc/sys/net/ipv4/conf/");
+	s = strchr (path, '/');
+	if (!s)
+		return FALSE;
+	l = s - path;
+	if (   l == 0
+	    || l >= IFNAMSIZ)
+		return FALSE;
+	s++;
+	if (   !s[0]
+	    || strchr (s, '/'))
 		return FALSE;
-	}
 
-	return sysctl_set_internal (platform, pathid, dirfd, path, value);
+	memcpy (out_ifname, path, l);
+	out_ifname[l] = '\0';
+	*out_property = s;
+	return TRUE;
 }
 
-typedef struct {
-	NMPlatform *platform;
-	char *pathid;
-	int dirfd;
-	char *path;
-	char **values;
-	GCancellable *cancellable;
-	NMPlatformAsyncCallback callback;
-	gpointer callback_data;
-} SysctlAsyncInfo;
+static gboolean
+_sysctl_cache_property_is_netconf (int addr_family, const char *property)
+{
+	/* these are the values that kernel reports via RTM_NEWNETCONF
+	 * whenever they change. */
+	if (NM_IN_STRSET (property, "forwarding",
+	                            "mc_forwarding",
+	                            "ignore_routes_with_linkdown"))
+		return TRUE;
+	if (addr_family == AF_INET)
+		return NM_IN_STRSET (property, "rp_filter", "proxy_arp");
+	return nm_streq (property, "proxy_ndp");
+}
 
-static void
-sysctl_async_info_free (SysctlAsyncInfo *info)
+static SysctlCacheValue *
+_sysctl_cache_lookup (NMPlatform *platform,
+                      int addr_family,
+                      const char *ifname,
+                      const char *property)
 {
-	g_object_unref (info->platform);
-	g_free (info->pathid);
-	if (info->dirfd >= 0)
-		nm_close (info->dirfd);
-	g_free (info->path);
-	g_strfreev (info->values);
-	g_object_unref (info->cancellable);
-	g_slice_free (SysctlAsyncInfo, info);
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	SysctlCacheIf *cif;
+	GHashTable *values;
+	SysctlCacheValue *v;
+
+	if (!priv->sysctl_cache.by_ifname)
+		return NULL;
+
+	cif = g_hash_table_lookup (priv->sysctl_cache.by_ifname, &ifname);
+	if (!cif)
+		return NULL;
+
+	values = cif->values_x[(addr_family == AF_INET)];
+	if (!values)
+		return NULL;
+
+	v = g_hash_table_lookup (values, &property);
+	if (!v)
+		return NULL;
+
+	if (   v->expiry_msec != 0
+	    && v->expiry_msec <= nm_utils_get_monotonic_timestamp_msec ()) {
+		g_hash_table_remove (values, v);
+		priv->sysctl_cache.stats.n_entries--;
+		return NULL;
+	}
+
+	return v;
 }
 
 static void
-sysctl_async_cb (GObject *object,
-                 GAsyncResult *res,
-                 gpointer user_data)
+_sysctl_cache_put (NMPlatform *platform,
+                   int addr_family,
+                   const char *ifname,
+                   const char *property,
+                   const char *value)
 {
-	NMPlatform *platform;
-	GTask *task = G_TASK (res);
-	SysctlAsyncInfo *info;
-	gs_free_error GError *error = NULL;
-	gs_free char *values_str = NULL;
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	SysctlCacheIf *cif = NULL;
+	GHashTable **p_values;
+	SysctlCacheValue *v;
+	gsize l;
 
-	info = g_task_get_task_data (task);
+	if (!priv->sysctl_cache.by_ifname) {
+		priv->sysctl_cache.by_ifname = g_hash_table_new_full (nm_pstr_hash,
+		                                                      nm_pstr_equal,
+		                                                      (GDestroyNotify) _sysctl_cache_if_free,
+		                                                      NULL);
+	} else
+		cif = g_hash_table_lookup (priv->sysctl_cache.by_ifname, &ifname);
+
+	if (!cif) {
+		l = strlen (ifname) + 1;
+		cif = g_malloc0 (sizeof (SysctlCacheIf) + l);
+		memcpy (cif->ifname_data, ifname, l);
+		cif->ifname = cif->ifname_data;
+		g_hash_table_add (priv->sysctl_cache.by_ifname, cif);
+	}
+
+	p_values = &cif->values_x[(addr_family == AF_INET)];
+	if (!*p_values) {
+		*p_values = g_hash_table_new_full (nm_pstr_hash,
+		                                   nm_pstr_equal,
+		                                   (GDestroyNotify) _sysctl_cache_value_free,
+		                                   NULL);
+		v = NULL;
+	} else
+		v = g_hash_table_lookup (*p_values, &property);
 
-	if (g_task_propagate_boolean (task, &error)) {
-		platform = info->platform;
-		_LOGD ("sysctl: successfully set-async '%s' to values '%s'",
-		       info->pathid ?: info->path,
-		       (values_str = g_strjoinv (", ", info->values)));
+	if (!v) {
+		l = strlen (property) + 1;
+		v = g_malloc (sizeof (SysctlCacheValue) + l);
+		memcpy (v->property_data, property, l);
+		v->property = v->property_data;
+		v->value = NULL;
+		g_hash_table_add (*p_values, v);
+		priv->sysctl_cache.stats.n_entries++;
 	}
 
-	if (info->callback)
-		info->callback (error, info->callback_data);
+	nm_utils_strdup_reset (&v->value, value);
+
+	if (   priv->sysctl_cache.netconf_subscribed
+	    && _sysctl_cache_property_is_netconf (addr_family, property))
+		v->expiry_msec = 0;
+	else
+		v->expiry_msec = nm_utils_get_monotonic_timestamp_msec () + SYSCTL_CACHE_TTL_MSEC;
 }
 
 static void
-sysctl_async_thread_fn (GTask *task,
-                        gpointer source_object,
-                        gpointer task_data,
-                        GCancellable *cancellable)
+_sysctl_cache_invalidate (NMPlatform *platform,
+                          int addr_family,
+                          const char *ifname,
+                          const char *property)
 {
-	nm_auto_pop_netns NMPNetns *netns = NULL;
-	SysctlAsyncInfo *info = task_data;
-	GError *error = NULL;
-	char **value;
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	SysctlCacheIf *cif;
+	GHashTable *values;
 
-	if (g_task_return_error_if_cancelled (task))
+	if (!priv->sysctl_cache.by_ifname)
 		return;
 
-	if (   info->dirfd < 0
-	    && !nm_platform_netns_push (info->platform, &netns)) {
-		g_set_error_literal (&error,
-		                     NM_UTILS_ERROR,
-		                     NM_UTILS_ERROR_UNKNOWN,
-		                     "sysctl: failed changing namespace");
-		g_task_return_error (task, error);
+	cif = g_hash_table_lookup (priv->sysctl_cache.by_ifname, &ifname);
+	if (!cif)
+		return;
+
+	values = cif->values_x[(addr_family == AF_INET)];
+	if (   values
+	    && g_hash_table_remove (values, &property))
+		priv->sysctl_cache.stats.n_entries--;
+}
+
+static void
+_sysctl_cache_flush (NMPlatform *platform,
+                     int addr_family,
+                     const char *ifname)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	GHashTableIter iter;
+	SysctlCacheIf *cif;
+	int IS_IPv4;
+
+	nm_assert (NM_IN_SET (addr_family, AF_UNSPEC, AF_INET, AF_INET6));
+
+	if (!priv->sysctl_cache.by_ifname)
+		return;
+
+	if (   !ifname
+	    && addr_family == AF_UNSPEC) {
+		nm_clear_pointer (&priv->sysctl_cache.by_ifname, g_hash_table_destroy);
+		priv->sysctl_cache.stats.n_entries = 0;
 		return;
 	}
 
-	for (value = info->values; *value; value++) {
-		if (!sysctl_set_internal (info->platform,
-		                          info->pathid,
-		                          info->dirfd,
-		                          info->path,
-		                          *value)) {
-			g_set_error (&error,
-			             NM_UTILS_ERROR,
-			             NM_UTILS_ERROR_UNKNOWN,
-			             "sysctl: failed setting '%s' to value '%s': %s",
-			             info->pathid ?: info->path,
-			             *value,
-			             nm_strerror_native (errno));
-			g_task_return_error (task, error);
-			return;
+	g_hash_table_iter_init (&iter, priv->sysctl_cache.by_ifname);
+	while (g_hash_table_iter_next (&iter, (gpointer *) &cif, NULL)) {
+		if (   ifname
+		    && !nm_streq (ifname, cif->ifname))
+			continue;
+		for (IS_IPv4 = 0; IS_IPv4 < 2; IS_IPv4++) {
+			if (   addr_family != AF_UNSPEC
+			    && IS_IPv4 != (addr_family == AF_INET))
+				continue;
+			if (cif->values_x[IS_IPv4]) {
+				priv->sysctl_cache.stats.n_entries -= g_hash_table_size (cif->values_x[IS_IPv4]);
+				nm_clear_pointer (&cif->values_x[IS_IPv4], g_hash_table_destroy);
+			}
 		}
-		if (g_task_return_error_if_cancelled (task))
-			return;
+		if (   !cif->values_x[0]
+		    && !cif->values_x[1])
+			g_hash_table_iter_remove (&iter);
 	}
-	g_task_return_boolean (task, TRUE);
 }
 
 static void
-sysctl_set_async_return_idle (gpointer user_data,
-                              GCancellable *cancellable)
+_sysctl_cache_flush_ifname (NMPlatform *platform, const char *ifname)
 {
-	gs_unref_object NMPlatform *platform = NULL;
-	gs_free_error GError *cancelled_error = NULL;
-	gs_free_error GError *error = NULL;
-	NMPlatformAsyncCallback callback;
-	gpointer callback_data;
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	SysctlCacheIf *cif;
 
-	nm_utils_user_data_unpack (user_data, &platform, &callback, &callback_data, &error);
-	g_cancellable_set_error_if_cancelled (cancellable, &cancelled_error);
-	callback (cancelled_error ?: error, callback_data);
+	if (   !ifname
+	    || !priv->sysctl_cache.by_ifname)
+		return;
+
+	cif = g_hash_table_lookup (priv->sysctl_cache.by_ifname, &ifname);
+	if (!cif)
+		return;
+
+	priv->sysctl_cache.stats.n_entries -=   (cif->values_x[0] ? g_hash_table_size (cif->values_x[0]) : 0u)
+	                                      + (cif->values_x[1] ? g_hash_table_size (cif->values_x[1]) : 0u);
+	g_hash_table_remove (priv->sysctl_cache.by_ifname, cif);
+}
+
+static gboolean
+_sysctl_cache_value_is_canonical (const char *value)
+{
+	/* after a successful write, we only remember values that kernel reports
+	 * back the same way (plain integers). Other values might be normalized
+	 * by kernel, so they are read again. */
+	if (value[0] == '-')
+		value++;
+	if (!g_ascii_isdigit (value[0]))
+		return FALSE;
+	if (   value[0] == '0'
+	    && value[1] != '\0')
+		return FALSE;
+	for (value++; value[0]; value++) {
+		if (!g_ascii_isdigit (value[0]))
+			return FALSE;
+	}
+	return TRUE;
 }
 
 static void
-sysctl_set_async (NMPlatform *platform,
-                  const char *pathid,
-                  int dirfd,
-                  const char *path,
-                  const char *const *values,
-                  NMPlatformAsyncCallback callback,
-                  gpointer data,
-                  GCancellable *cancellable)
+_sysctl_cache_after_set (NMPlatform *platform,
+                         const char *path,
+                         const char *value)
 {
-	SysctlAsyncInfo *info;
-	GTask *task;
-	int dirfd_dup, errsv;
-	gpointer packed;
-	GError *error = NULL;
+	char ifname[IFNAMSIZ];
+	const char *property;
+	int addr_family;
 
-	g_return_if_fail (platform);
-	g_return_if_fail (path);
-	g_return_if_fail (values && values[0]);
-	g_return_if_fail (cancellable);
-	g_return_if_fail (!data || callback);
+	if (!_sysctl_cache_parse_path (path, &addr_family, ifname, &property))
+		return;
+
+	if (NM_IN_STRSET (ifname, "all", "default")) {
+		/* writing to "all" or "default" can change the values of every
+		 * interface. */
+		_sysctl_cache_flush (platform, addr_family, NULL);
+		return;
+	}
+
+	if (   value
+	    && _sysctl_cache_value_is_canonical (value))
+		_sysctl_cache_put (platform, addr_family, ifname, property, value);
+	else
+		_sysctl_cache_invalidate (platform, addr_family, ifname, property);
+}
+
+static void
+_sysctl_cache_netconf_event (NMPlatform *platform, struct nlmsghdr *nlh)
+{
+	static const struct nla_policy policy[] = {
+		[NETCONFA_IFINDEX]                      = { .type = NLA_S32 },
+		[NETCONFA_FORWARDING]                   = { .type = NLA_S32 },
+		[NETCONFA_RP_FILTER]                    = { .type = NLA_S32 },
+		[NETCONFA_MC_FORWARDING]                = { .type = NLA_S32 },
+		[NETCONFA_PROXY_NEIGH]                  = { .type = NLA_S32 },
+		[NETCONFA_IGNORE_ROUTES_WITH_LINKDOWN]  = { .type = NLA_S32 },
+	};
+	static const struct {
+		int attr;
+		const char *property_4;
+		const char *property_6;
+	} map[] = {
+		{ NETCONFA_FORWARDING,                  "forwarding",                  "forwarding" },
+		{ NETCONFA_RP_FILTER,                   "rp_filter",                   NULL },
+		{ NETCONFA_MC_FORWARDING,               "mc_forwarding",               "mc_forwarding" },
+		{ NETCONFA_PROXY_NEIGH,                 "proxy_arp",                   "proxy_ndp" },
+		{ NETCONFA_IGNORE_ROUTES_WITH_LINKDOWN, "ignore_routes_with_linkdown", "ignore_routes_with_linkdown" },
+	};
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	struct nlattr *tb[G_N_ELEMENTS (policy)];
+	const struct netconfmsg *ncm;
+	const NMPlatformLink *plink;
+	const char *ifname;
+	char sbuf[30];
+	int addr_family;
+	int ifindex;
+	guint i;
+
+	if (!priv->sysctl_cache.by_ifname)
+		return;
+
+	if (!nlmsg_valid_hdr (nlh, sizeof (*ncm)))
+		return;
+
+	ncm = nlmsg_data (nlh);
+	addr_family = ncm->ncm_family;
+	if (!NM_IN_SET (addr_family, AF_INET, AF_INET6))
+		return;
+
+	if (nlmsg_parse_arr (nlh, sizeof (*ncm), tb, policy) < 0)
+		return;
+
+	if (!tb[NETCONFA_IFINDEX])
+		return;
+	ifindex = nla_get_s32 (tb[NETCONFA_IFINDEX]);
+
+	if (NM_IN_SET (ifindex, NETCONFA_IFINDEX_ALL, NETCONFA_IFINDEX_DEFAULT)) {
+		/* kernel propagates changes of "all" and "default" to the
+		 * interfaces in ways that we don't want to replicate. */
+		_sysctl_cache_flush (platform, addr_family, NULL);
+		return;
+	}
+
+	plink = nm_platform_link_get (platform, ifindex);
+	if (!plink) {
+		/* kernel announces a new interface before RTM_NEWLINK. We cannot
+		 * have anything cached for it, because values are dropped when
+		 * a link goes away or gets renamed. */
+		return;
+	}
+	ifname = plink->name;
+
+	if (nlh->nlmsg_type == RTM_DELNETCONF) {
+		_sysctl_cache_flush_ifname (platform, ifname);
+		return;
+	}
+
+	for (i = 0; i < G_N_ELEMENTS (map); i++) {
+		const char *property = (addr_family == AF_INET) ? map[i].property_4 : map[i].property_6;
+
+		if (   !property
+		    || !tb[map[i].attr])
+			continue;
+		if (!_sysctl_cache_lookup (platform, addr_family, ifname, property))
+			continue;
+		_sysctl_cache_put (platform,
+		                   addr_family,
+		                   ifname,
+		                   property,
+		                   nm_sprintf_buf (sbuf, "%d", (int) nla_get_s32 (tb[map[i].attr])));
+		priv->sysctl_cache.stats.updates_netconf++;
+	}
+}
+
+static gboolean
+sysctl_cache_get_stats (NMPlatform *platform, NMPlatformSysctlCacheStats *out_stats)
+{
+	*out_stats = NM_LINUX_PLATFORM_GET_PRIVATE (platform)->sysctl_cache.stats;
+	return TRUE;
+}
+
+/*****************************************************************************/
+
+/* Batches of one platform instance are applied one after the other. Batches
+ * of different instances (network namespaces) may be applied in parallel. */
+#define SYSCTL_BATCH_POOL_MAX_THREADS 4
+
+struct _SysctlBatchJob {
+	NMPlatform *platform;
+	NMPlatformSysctlBatch *batch;
+	GMainContext *context;
+	NMPlatformAsyncCallback callback;
+	gpointer callback_data;
+	GCancellable *cancellable;
+	GError *error;
+
+	/* protected by the lock of the platform instance. */
+	bool applied:1;
+};
+
+static GThreadPool *sysctl_batch_pool;
+
+static void
+_sysctl_batch_job_free (SysctlBatchJob *job)
+{
+	nm_platform_sysctl_batch_free (job->batch);
+	g_main_context_unref (job->context);
+	nm_g_object_unref (job->cancellable);
+	g_clear_error (&job->error);
+	g_object_unref (job->platform);
+	g_slice_free (SysctlBatchJob, job);
+}
+
+static gsize
+_sysctl_batch_key_len (const char *pathid)
+{
+	const char *s;
+
+	/* writes are ordered by their directory. That is, accessing a sysctl
+	 * of an interface waits for all pending writes of this interface. */
+	s = strrchr (pathid, '/');
+	return s ? (gsize) (s - pathid) : strlen (pathid);
+}
+
+static void
+_sysctl_batch_pending_add (NMPlatform *platform, const char *pathid)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	char *key;
+	guint n;
+
+	if (!priv->sysctl_batch.pending)
+		priv->sysctl_batch.pending = g_hash_table_new_full (nm_str_hash, g_str_equal, g_free, NULL);
+
+	key = g_strndup (pathid, _sysctl_batch_key_len (pathid));
+	n = GPOINTER_TO_UINT (g_hash_table_lookup (priv->sysctl_batch.pending, key));
+	g_hash_table_insert (priv->sysctl_batch.pending, key, GUINT_TO_POINTER (n + 1));
+}
+
+static void
+_sysctl_batch_pending_remove (NMPlatform *platform, const char *pathid)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	gs_free char *key = NULL;
+	guint n;
+
+	key = g_strndup (pathid, _sysctl_batch_key_len (pathid));
+	n = GPOINTER_TO_UINT (g_hash_table_lookup (priv->sysctl_batch.pending, key));
+	nm_assert (n > 0);
+	if (n <= 1)
+		g_hash_table_remove (priv->sysctl_batch.pending, key);
+	else
+		g_hash_table_insert (priv->sysctl_batch.pending, g_steal_pointer (&key), GUINT_TO_POINTER (n - 1));
+}
+
+/* applying a batch can happen from a worker thread. */
+#undef NM_THREAD_SAFE_ON_MAIN_THREAD
+#define NM_THREAD_SAFE_ON_MAIN_THREAD 0
+
+static void
+_sysctl_batch_apply (NMPlatform *platform,
+                     const NMPlatformSysctlBatch *batch,
+                     GCancellable *cancellable,
+                     GError **error)
+{
+	nm_auto_pop_netns NMPNetns *netns = NULL;
+	nm_auto_close int dir_fd = -1;
+	const char *dir_last = NULL;
+	gsize dir_last_len = 0;
+	const NMPlatformSysctlBatchEntry *entry_failed = NULL;
+	int errsv_failed = 0;
+	guint n_failed = 0;
+	guint i;
+
+	if (!nm_platform_netns_push (platform, &netns)) {
+		g_set_error_literal (error,
+		                     NM_UTILS_ERROR,
+		                     NM_UTILS_ERROR_UNKNOWN,
+		                     "sysctl: failed changing namespace");
+		return;
+	}
+
+	for (i = 0; i < batch->entries->len; i++) {
+		const NMPlatformSysctlBatchEntry *entry = &g_array_index (batch->entries, NMPlatformSysctlBatchEntry, i);
+		const char *basename;
+		gsize dir_len;
+		gboolean success;
+
+		if (g_cancellable_is_cancelled (cancellable))
+			return;
+
+		if (!entry->path) {
+			errno = EBADF;
+			success = FALSE;
+		} else if (entry->dirfd >= 0)
+			success = sysctl_set_internal (platform, entry->pathid, entry->dirfd, entry->path, entry->value);
+		else {
+			/* consecutive values are usually in the same directory, like
+			 * /proc/sys/net/ipv6/conf/$IFNAME. Open it once, and write the
+			 * values relative to it. */
+			basename = strrchr (entry->path, '/');
+			nm_assert (basename);
+			dir_len = basename - entry->path;
+			if (   !dir_last
+			    || dir_last_len != dir_len
+			    || strncmp (dir_last, entry->path, dir_len) != 0) {
+				gs_free char *dir = g_strndup (entry->path, dir_len);
+
+				if (dir_fd >= 0)
+					nm_close (nm_steal_fd (&dir_fd));
+				dir_fd = open (dir, O_PATH | O_DIRECTORY | O_CLOEXEC);
+				dir_last = entry->path;
+				dir_last_len = dir_len;
+			}
+			if (dir_fd >= 0)
+				success = sysctl_set_internal (platform, entry->path, dir_fd, &basename[1], entry->value);
+			else
+				success = sysctl_set_internal (platform, NULL, -1, entry->path, entry->value);
+		}
+
+		if (!success) {
+			if (n_failed++ == 0) {
+				entry_failed = entry;
+				errsv_failed = errno;
+			}
+		}
+	}
+
+	if (n_failed > 0) {
+		g_set_error (error,
+		             NM_UTILS_ERROR,
+		             NM_UTILS_ERROR_UNKNOWN,
+		             "sysctl: failed setting '%s' to value '%s': %s%s",
+		             entry_failed->pathid,
+		             entry_failed->value,
+		             nm_strerror_native (errsv_failed),
+		             n_failed > 1
+		               ? nm_sprintf_bufa (60, " (and %u more failures)", n_failed - 1)
+		               : "");
+	}
+}
+
+static gboolean _sysctl_batch_job_complete_cb (gpointer user_data);
+
+static void
+_sysctl_batch_job_applied (SysctlBatchJob *job)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (job->platform);
+	GSource *source;
+
+	g_mutex_lock (&priv->sysctl_batch.lock);
+	job->applied = TRUE;
+	g_cond_broadcast (&priv->sysctl_batch.cond);
+	g_mutex_unlock (&priv->sysctl_batch.lock);
+
+	source = nm_g_idle_source_new (G_PRIORITY_DEFAULT,
+	                               _sysctl_batch_job_complete_cb,
+	                               job,
+	                               NULL);
+	g_source_attach (source, job->context);
+	g_source_unref (source);
+}
+
+static void
+_sysctl_batch_thread_fn (gpointer data, gpointer user_data)
+{
+	SysctlBatchJob *job = data;
+
+	_sysctl_batch_apply (job->platform, job->batch, job->cancellable, &job->error);
+	_sysctl_batch_job_applied (job);
+}
+
+#undef NM_THREAD_SAFE_ON_MAIN_THREAD
+#define NM_THREAD_SAFE_ON_MAIN_THREAD 1
+
+static void
+_sysctl_batch_start_next (NMPlatform *platform)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	SysctlBatchJob *job;
+
+	if (priv->sysctl_batch.in_flight)
+		return;
+
+	job = g_queue_pop_head (&priv->sysctl_batch.queued);
+	if (!job)
+		return;
+
+	if (G_UNLIKELY (!sysctl_batch_pool)) {
+		sysctl_batch_pool = g_thread_pool_new (_sysctl_batch_thread_fn,
+		                                       NULL,
+		                                       SYSCTL_BATCH_POOL_MAX_THREADS,
+		                                       FALSE,
+		                                       NULL);
+	}
+
+	priv->sysctl_batch.in_flight = job;
+	g_thread_pool_push (sysctl_batch_pool, job, NULL);
+}
+
+static gboolean
+_sysctl_batch_job_complete_cb (gpointer user_data)
+{
+	SysctlBatchJob *job = user_data;
+	NMPlatform *platform = job->platform;
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	gs_free_error GError *cancelled_error = NULL;
+	guint i;
+
+	if (priv->sysctl_batch.in_flight == job) {
+		priv->sysctl_batch.in_flight = NULL;
+		_sysctl_batch_start_next (platform);
+	}
+
+	for (i = 0; i < job->batch->entries->len; i++) {
+		const NMPlatformSysctlBatchEntry *entry = &g_array_index (job->batch->entries, NMPlatformSysctlBatchEntry, i);
+
+		_sysctl_batch_pending_remove (platform, entry->pathid);
+		if (entry->dirfd < 0)
+			_sysctl_cache_after_set (platform, entry->path, NULL);
+	}
+
+	if (job->error)
+		_LOGD ("sysctl: batch of %u values done: %s", job->batch->entries->len, job->error->message);
+	else
+		_LOGD ("sysctl: batch of %u values done", job->batch->entries->len);
+
+	if (job->callback) {
+		g_cancellable_set_error_if_cancelled (job->cancellable, &cancelled_error);
+		job->callback (cancelled_error ?: job->error, job->callback_data);
+	}
+
+	_sysctl_batch_job_free (job);
+	return G_SOURCE_REMOVE;
+}
+
+static void
+_sysctl_batch_barrier (NMPlatform *platform, const char *pathid)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	gs_free char *key_free = NULL;
+	SysctlBatchJob *job;
+	const char *key;
+
+	if (   !priv->sysctl_batch.pending
+	    || g_hash_table_size (priv->sysctl_batch.pending) == 0)
+		return;
+
+	key = nm_strndup_a (300, pathid, _sysctl_batch_key_len (pathid), &key_free);
+	if (!g_hash_table_contains (priv->sysctl_batch.pending, key))
+		return;
+
+	/* a batch that was committed earlier has pending writes in the same
+	 * directory. Don't overtake it. */
+	_LOGT ("sysctl: wait for pending batches before accessing '%s'", pathid);
+
+	job = priv->sysctl_batch.in_flight;
+	if (job) {
+		g_mutex_lock (&priv->sysctl_batch.lock);
+		while (!job->applied)
+			g_cond_wait (&priv->sysctl_batch.cond, &priv->sysctl_batch.lock);
+		g_mutex_unlock (&priv->sysctl_batch.lock);
+	}
+
+	while ((job = g_queue_pop_head (&priv->sysctl_batch.queued))) {
+		_sysctl_batch_apply (platform, job->batch, job->cancellable, &job->error);
+		_sysctl_batch_job_applied (job);
+	}
+}
+
+static void
+sysctl_batch_commit (NMPlatform *platform,
+                     NMPlatformSysctlBatch *batch,
+                     NMPlatformAsyncCallback callback,
+                     gpointer data,
+                     GCancellable *cancellable)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	SysctlBatchJob *job;
+	guint i;
+
+	job = g_slice_new (SysctlBatchJob);
+	*job = (SysctlBatchJob) {
+		.platform      = g_object_ref (platform),
+		.batch         = batch,
+		.context       = g_main_context_ref_thread_default (),
+		.callback      = callback,
+		.callback_data = data,
+		.cancellable   = nm_g_object_ref (cancellable),
+	};
+
+	for (i = 0; i < batch->entries->len; i++) {
+		const NMPlatformSysctlBatchEntry *entry = &g_array_index (batch->entries, NMPlatformSysctlBatchEntry, i);
+
+		_sysctl_batch_pending_add (platform, entry->pathid);
+		if (entry->dirfd < 0)
+			_sysctl_cache_after_set (platform, entry->path, NULL);
+	}
+
+	_LOGD ("sysctl: commit batch of %u values", batch->entries->len);
+
+	g_queue_push_tail (&priv->sysctl_batch.queued, job);
+	_sysctl_batch_start_next (platform);
+}
+
+/*****************************************************************************/
+
+static gboolean
+sysctl_set (NMPlatform *platform,
+            const char *pathid,
+            int dirfd,
+            const char *path,
+            const char *value)
+{
+	nm_auto_pop_netns NMPNetns *netns = NULL;
+
+	g_return_val_if_fail (path, FALSE);
+	g_return_val_if_fail (value, FALSE);
+
+	ASSERT_SYSCTL_ARGS (pathid, dirfd, path);
+
+	_sysctl_batch_barrier (platform, dirfd < 0 ? path : pathid);
+
+	if (dirfd < 0) {
+		if (!nm_platform_netns_push (platform, &netns)) {
+			errno = ENETDOWN;
+			return FALSE;
+		}
+		if (!sysctl_set_internal (platform, pathid, dirfd, path, value)) {
+			int errsv = errno;
+
+			_sysctl_cache_after_set (platform, path, NULL);
+			errno = errsv;
+			return FALSE;
+		}
+		_sysctl_cache_after_set (platform, path, value);
+		return TRUE;
+	}
+
+	return sysctl_set_internal (platform, pathid, dirfd, path, value);
+}
+
+typedef struct {
+	NMPlatform *platform;
+	char *pathid;
+	int dirfd;
+	char *path;
+	char **values;
+	GCancellable *cancellable;
+	NMPlatformAsyncCallback callback;
+	gpointer callback_data;
+} SysctlAsyncInfo;
+
+static void
+sysctl_async_info_free (SysctlAsyncInfo *info)
+{
+	g_object_unref (info->platform);
+	g_free (info->pathid);
+	if (info->dirfd >= 0)
+		nm_close (info->dirfd);
+	g_free (info->path);
+	g_strfreev (info->values);
+	g_object_unref (info->cancellable);
+	g_slice_free (SysctlAsyncInfo, info);
+}
+
+static void
+sysctl_async_cb (GObject *object,
+                 GAsyncResult *res,
+                 gpointer user_data)
+{
+	NMPlatform *platform;
+	GTask *task = G_TASK (res);
+	SysctlAsyncInfo *info;
+	gs_free_error GError *error = NULL;
+	gs_free char *values_str = NULL;
+
+	info = g_task_get_task_data (task);
+
+	/* the value was written on another thread. Forget what we know about it. */
+	if (info->dirfd < 0)
+		_sysctl_cache_after_set (info->platform, info->path, NULL);
+
+	if (g_task_propagate_boolean (task, &error)) {
+		platform = info->platform;
+		_LOGD ("sysctl: successfully set-async '%s' to values '%s'",
+		       info->pathid ?: info->path,
+		       (values_str = g_strjoinv (", ", info->values)));
+	}
+
+	if (info->callback)
+		info->callback (error, info->callback_data);
+}
+
+static void
+sysctl_async_thread_fn (GTask *task,
+                        gpointer source_object,
+                        gpointer task_data,
+                        GCancellable *cancellable)
+{
+	nm_auto_pop_netns NMPNetns *netns = NULL;
+	SysctlAsyncInfo *info = task_data;
+	GError *error = NULL;
+	char **value;
+
+	if (g_task_return_error_if_cancelled (task))
+		return;
+
+	if (   info->dirfd < 0
+	    && !nm_platform_netns_push (info->platform, &netns)) {
+		g_set_error_literal (&error,
+		                     NM_UTILS_ERROR,
+		                     NM_UTILS_ERROR_UNKNOWN,
+		                     "sysctl: failed changing namespace");
+		g_task_return_error (task, error);
+		return;
+	}
+
+	for (value = info->values; *value; value++) {
+		if (!sysctl_set_internal (info->platform,
+		                          info->pathid,
+		                          info->dirfd,
+		                          info->path,
+		                          *value)) {
+			g_set_error (&error,
+			             NM_UTILS_ERROR,
+			             NM_UTILS_ERROR_UNKNOWN,
+			             "sysctl: failed setting '%s' to value '%s': %s",
+			             info->pathid ?: info->path,
+			             *value,
+			             nm_strerror_native (errno));
+			g_task_return_error (task, error);
+			return;
+		}
+		if (g_task_return_error_if_cancelled (task))
+			return;
+	}
+	g_task_return_boolean (task, TRUE);
+}
+
+static void
+sysctl_set_async_return_idle (gpointer user_data,
+                              GCancellable *cancellable)
+{
+	gs_unref_object NMPlatform *platform = NULL;
+	gs_free_error GError *cancelled_error = NULL;
+	gs_free_error GError *error = NULL;
+	NMPlatformAsyncCallback callback;
+	gpointer callback_data;
+
+	nm_utils_user_data_unpack (user_data, &platform, &callback, &callback_data, &error);
+	g_cancellable_set_error_if_cancelled (cancellable, &cancelled_error);
+	callback (cancelled_error ?: error, callback_data);
+}
+
+static void
+sysctl_set_async (NMPlatform *platform,
+                  const char *pathid,
+                  int dirfd,
+                  const char *path,
+                  const char *const *values,
+                  NMPlatformAsyncCallback callback,
+                  gpointer data,
+                  GCancellable *cancellable)
+{
+	SysctlAsyncInfo *info;
+	GTask *task;
+	int dirfd_dup, errsv;
+	gpointer packed;
+	GError *error = NULL;
+
+	g_return_if_fail (platform);
+	g_return_if_fail (path);
+	g_return_if_fail (values && values[0]);
+	g_return_if_fail (cancellable);
+	g_return_if_fail (!data || callback);
 
 	ASSERT_SYSCTL_ARGS (pathid, dirfd, path);
 
+	/* the write happens on another thread. Let committed batches for
+	 * the same directory go first. */
+	_sysctl_batch_barrier (platform, dirfd < 0 ? path : pathid);
+
 	if (dirfd >= 0) {
 		dirfd_dup = fcntl (dirfd, F_DUPFD_CLOEXEC, 0);
 		if (dirfd_dup < 0) {
@@ -5245,8 +6235,10 @@ sysctl_set_async (NMPlatform *platform,
 			                         packed);
 			return;
 		}
-	} else
+	} else {
 		dirfd_dup = -1;
+		_sysctl_cache_after_set (platform, path, NULL);
+	}
 
 	info = g_slice_new0 (SysctlAsyncInfo);
 	info->platform = g_object_ref (platform);
@@ -5354,13 +6346,30 @@ _log_dbg_sysctl_get_impl (NMPlatform *platform, const char *pathid, const char *
 static char *
 sysctl_get (NMPlatform *platform, const char *pathid, int dirfd, const char *path)
 {
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
 	nm_auto_pop_netns NMPNetns *netns = NULL;
 	GError *error = NULL;
 	gs_free char *contents = NULL;
+	char cache_ifname[IFNAMSIZ];
+	const char *cache_property = NULL;
+	int cache_addr_family = AF_UNSPEC;
 
 	ASSERT_SYSCTL_ARGS (pathid, dirfd, path);
 
+	_sysctl_batch_barrier (platform, dirfd < 0 ? path : pathid);
+
 	if (dirfd < 0) {
+		if (_sysctl_cache_parse_path (path, &cache_addr_family, cache_ifname, &cache_property)) {
+			const SysctlCacheValue *v;
+
+			v = _sysctl_cache_lookup (platform, cache_addr_family, cache_ifname, cache_property);
+			if (v) {
+				priv->sysctl_cache.stats.hits++;
+				return g_strdup (v->value);
+			}
+			priv->sysctl_cache.stats.misses++;
+		}
+
 		if (!nm_platform_netns_push (platform, &netns)) {
 			errno = EBUSY;
 			return NULL;
@@ -5398,6 +6407,9 @@ sysctl_get (NMPlatform *platform, const char *pathid, int dirfd, const char *pat
 
 	_log_dbg_sysctl_get (platform, pathid, contents);
 
+	if (cache_property)
+		_sysctl_cache_put (platform, cache_addr_family, cache_ifname, cache_property, contents);
+
 	/* errno is left undefined (as we don't return NULL). */
 	return g_steal_pointer (&contents);
 }
@@ -5410,6 +6422,34 @@ process_events (NMPlatform *platform)
 	delayed_action_handle_all (platform, TRUE);
 }
 
+static void
+refresh_all (NMPlatform *platform, NMPObjectType obj_type)
+{
+	DelayedActionType action_type;
+
+	switch (obj_type) {
+	case NMP_OBJECT_TYPE_LINK:         action_type = DELAYED_ACTION_TYPE_REFRESH_ALL_LINKS;             break;
+	case NMP_OBJECT_TYPE_IP4_ADDRESS:  action_type = DELAYED_ACTION_TYPE_REFRESH_ALL_IP4_ADDRESSES;     break;
+	case NMP_OBJECT_TYPE_IP6_ADDRESS:  action_type = DELAYED_ACTION_TYPE_REFRESH_ALL_IP6_ADDRESSES;     break;
+	case NMP_OBJECT_TYPE_IP4_ROUTE:    action_type = DELAYED_ACTION_TYPE_REFRESH_ALL_IP4_ROUTES;        break;
+	case NMP_OBJECT_TYPE_IP6_ROUTE:    action_type = DELAYED_ACTION_TYPE_REFRESH_ALL_IP6_ROUTES;        break;
+	case NMP_OBJECT_TYPE_ROUTING_RULE: action_type = DELAYED_ACTION_TYPE_REFRESH_ALL_ROUTING_RULES_ALL; break;
+	case NMP_OBJECT_TYPE_QDISC:        action_type = DELAYED_ACTION_TYPE_REFRESH_ALL_QDISCS;            break;
+	case NMP_OBJECT_TYPE_TFILTER:      action_type = DELAYED_ACTION_TYPE_REFRESH_ALL_TFILTERS;          break;
+	default:
+		g_return_if_reached ();
+	}
+
+	delayed_action_schedule (platform, action_type, NULL);
+	delayed_action_handle_all (platform, FALSE);
+}
+
+static void
+refresh_filtered (NMPlatform *platform, NMPObjectType obj_type, int ifindex, guint32 table)
+{
+	do_request_filtered (platform, obj_type, ifindex, table);
+}
+
 /*****************************************************************************/
 
 static const RefreshAllInfo *
@@ -5944,6 +6984,7 @@ cache_prune_all (NMPlatform *platform)
 {
 	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
 	RefreshAllType refresh_all_type;
+	gboolean pruned = FALSE;
 
 	for (refresh_all_type = _REFRESH_ALL_TYPE_FIRST; refresh_all_type < _REFRESH_ALL_TYPE_NUM; refresh_all_type++) {
 		NMPLookup lookup;
@@ -5956,6 +6997,15 @@ cache_prune_all (NMPlatform *platform)
 		refresh_all_type_init_lookup (refresh_all_type,
 		                              &lookup);
 		cache_prune_one_type (platform, &lookup);
+		pruned = TRUE;
+	}
+
+	if (   pruned
+	    && _LOGD_ENABLED ()) {
+		char sbuf[512];
+
+		_LOGD ("cache-prune: object pools: %s",
+		       nmp_object_pool_stats_to_string (sbuf, sizeof (sbuf)));
 	}
 }
 
@@ -6065,6 +7115,16 @@ cache_on_change (NMPlatform *platform,
 				}
 			}
 		}
+		{
+			/* the ip conf sysctls of a link are gone with the link, and
+			 * some (like the IPv6 "mtu") are reset by kernel. */
+			if (   obj_old
+			    && (   !obj_new
+			        || !obj_new->_link.netlink.is_in_netlink
+			        || !nm_streq (obj_old->link.name, obj_new->link.name)
+			        || obj_old->link.mtu != obj_new->link.mtu))
+				_sysctl_cache_flush_ifname (platform, obj_old->link.name);
+		}
 		{
 			/* if a link goes down, we must refresh routes */
 			if (   cache_op == NMP_CACHE_OPS_UPDATED
@@ -6299,6 +7359,92 @@ _nl_send_nlmsg (NMPlatform *platform,
 	return 0;
 }
 
+/* Limits for a batch of requests that _nl_send_nlmsg_many() sends with one
+ * sendmsg() call. The kernel rejects datagrams larger than the socket's send
+ * buffer (see nl_socket_set_buffer_size()), and every request produces an ACK
+ * (and possibly a notification) that must fit into our receive buffer until we
+ * get to read it. */
+#define NL_SEND_BATCH_MAX_BYTES  (16 * 1024)
+#define NL_SEND_BATCH_MAX_MSGS   256
+
+/**
+ * _nl_send_nlmsg_many:
+ * @platform:
+ * @nlmsgs: the messages to send.
+ * @len: the number of messages in @nlmsgs.
+ * @out_seq_results: an array of @len elements that receives the result
+ *   for each message.
+ * @out_errmsgs: an array of @len elements that receives the extended
+ *   error message for each message.
+ *
+ * Like _nl_send_nlmsg(), but all messages are sent in one datagram, each
+ * with its own sequence number. The kernel processes them in order and
+ * acknowledges each message individually.
+ *
+ * Returns: 0 on success or a negative errno. On failure, none of the
+ *   messages was sent.
+ */
+static int
+_nl_send_nlmsg_many (NMPlatform *platform,
+                     struct nl_msg *const*nlmsgs,
+                     guint len,
+                     WaitForNlResponseResult *out_seq_results,
+                     char **out_errmsgs)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	struct iovec iov[NL_SEND_BATCH_MAX_MSGS];
+	guint32 seqs[NL_SEND_BATCH_MAX_MSGS];
+	struct sockaddr_nl nladdr = {
+		.nl_family = AF_NETLINK,
+	};
+	struct msghdr msg = {
+		.msg_name = &nladdr,
+		.msg_namelen = sizeof (nladdr),
+		.msg_iov = iov,
+		.msg_iovlen = len,
+	};
+	int try_count;
+	int errsv;
+	guint i;
+
+	nm_assert (len > 0);
+	nm_assert (len <= NL_SEND_BATCH_MAX_MSGS);
+
+	for (i = 0; i < len; i++) {
+		struct nlmsghdr *nlhdr = nlmsg_hdr (nlmsgs[i]);
+
+		/* the messages are concatenated in the datagram. The kernel finds
+		 * the next message at the aligned offset. */
+		nm_assert (nlhdr->nlmsg_len == NLMSG_ALIGN (nlhdr->nlmsg_len));
+
+		seqs[i] = _nlh_seq_next_get (priv);
+		nlhdr->nlmsg_seq = seqs[i];
+		if (!nlhdr->nlmsg_pid)
+			nlhdr->nlmsg_pid = nl_socket_get_local_port (priv->nlh);
+		nlhdr->nlmsg_flags |= (NLM_F_REQUEST | NLM_F_ACK);
+
+		iov[i].iov_base = nlhdr;
+		iov[i].iov_len = nlhdr->nlmsg_len;
+	}
+
+	try_count = 0;
+again:
+	if (sendmsg (nl_socket_get_fd (priv->nlh), &msg, 0) < 0) {
+		errsv = errno;
+		if (errsv == EINTR && try_count++ < 100)
+			goto again;
+		_LOGD ("netlink: nl-send-nlmsg-many: failed sending %u messages: %s (%d)",
+		       len, nm_strerror_native (errsv), errsv);
+		return -nm_errno_from_native (errsv);
+	}
+
+	for (i = 0; i < len; i++) {
+		delayed_action_schedule_WAIT_FOR_NL_RESPONSE (platform, seqs[i], &out_seq_results[i], &out_errmsgs[i],
+		                                              DELAYED_ACTION_RESPONSE_TYPE_VOID, NULL);
+	}
+	return 0;
+}
+
 static void
 do_request_link_no_delayed_actions (NMPlatform *platform, int ifindex, const char *name)
 {
@@ -6347,9 +7493,29 @@ do_request_link (NMPlatform *platform, int ifindex, const char *name)
 	delayed_action_handle_all (platform, FALSE);
 }
 
+/**
+ * _nl_msg_new_dump:
+ * @obj_type: the object type to dump
+ * @preferred_addr_family: the address family, if the object type does not
+ *   imply one.
+ * @ifindex: if positive, only dump objects of this interface. Only
+ *   supported for IP addresses and routes.
+ * @table: if non-zero, only dump routes of this table. Only supported for
+ *   IP routes.
+ *
+ * Since kernel 4.20 the dump requests can carry filters, which kernel honors
+ * if NETLINK_GET_STRICT_CHK is enabled on the socket. With strict checking,
+ * kernel also rejects dump requests that don't carry the full header for the
+ * respective message type, so we always send that. Older kernels ignore the
+ * filters and dump everything, which is still correct, only slower.
+ *
+ * Returns: the netlink message
+ */
 static struct nl_msg *
 _nl_msg_new_dump (NMPObjectType obj_type,
-                  int preferred_addr_family)
+                  int preferred_addr_family,
+                  int ifindex,
+                  guint32 table)
 {
 	nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
 	const NMPClass *klass;
@@ -6358,6 +7524,14 @@ _nl_msg_new_dump (NMPObjectType obj_type,
 
 	nm_assert (klass);
 	nm_assert (klass->rtm_gettype > 0);
+	nm_assert (   ifindex <= 0
+	           || NM_IN_SET (klass->obj_type, NMP_OBJECT_TYPE_IP4_ADDRESS,
+	                                          NMP_OBJECT_TYPE_IP6_ADDRESS,
+	                                          NMP_OBJECT_TYPE_IP4_ROUTE,
+	                                          NMP_OBJECT_TYPE_IP6_ROUTE));
+	nm_assert (   table == 0
+	           || NM_IN_SET (klass->obj_type, NMP_OBJECT_TYPE_IP4_ROUTE,
+	                                          NMP_OBJECT_TYPE_IP6_ROUTE));
 
 	nlmsg = nlmsg_alloc_simple (klass->rtm_gettype, NLM_F_DUMP);
 
@@ -6380,17 +7554,51 @@ _nl_msg_new_dump (NMPObjectType obj_type,
 		}
 		break;
 	case NMP_OBJECT_TYPE_LINK:
+		{
+			const struct ifinfomsg ifi = {
+				.ifi_family = preferred_addr_family,
+			};
+
+			if (nlmsg_append_struct (nlmsg, &ifi) < 0)
+				g_return_val_if_reached (NULL);
+		}
+		break;
 	case NMP_OBJECT_TYPE_IP4_ADDRESS:
 	case NMP_OBJECT_TYPE_IP6_ADDRESS:
+		{
+			const struct ifaddrmsg ifa = {
+				.ifa_family = preferred_addr_family,
+				.ifa_index = NM_MAX (ifindex, 0),
+			};
+
+			if (nlmsg_append_struct (nlmsg, &ifa) < 0)
+				g_return_val_if_reached (NULL);
+		}
+		break;
 	case NMP_OBJECT_TYPE_IP4_ROUTE:
 	case NMP_OBJECT_TYPE_IP6_ROUTE:
+		{
+			const struct rtmsg rtmsg = {
+				.rtm_family = preferred_addr_family,
+				.rtm_table = table <= 0xFF ? table : RT_TABLE_COMPAT,
+			};
+
+			if (nlmsg_append_struct (nlmsg, &rtmsg) < 0)
+				g_return_val_if_reached (NULL);
+
+			if (table > 0xFF)
+				NLA_PUT_U32 (nlmsg, RTA_TABLE, table);
+			if (ifindex > 0)
+				NLA_PUT_U32 (nlmsg, RTA_OIF, ifindex);
+		}
+		break;
 	case NMP_OBJECT_TYPE_ROUTING_RULE:
 		{
-			const struct rtgenmsg gmsg = {
-				.rtgen_family = preferred_addr_family,
+			const struct fib_rule_hdr frh = {
+				.family = preferred_addr_family,
 			};
 
-			if (nlmsg_append_struct (nlmsg, &gmsg) < 0)
+			if (nlmsg_append_struct (nlmsg, &frh) < 0)
 				g_return_val_if_reached (NULL);
 		}
 		break;
@@ -6399,6 +7607,9 @@ _nl_msg_new_dump (NMPObjectType obj_type,
 	}
 
 	return g_steal_pointer (&nlmsg);
+
+nla_put_failure:
+	g_return_val_if_reached (NULL);
 }
 
 static void
@@ -6466,7 +7677,9 @@ do_request_all_no_delayed_actions (NMPlatform *platform, DelayedActionType actio
 		event_handler_read_netlink (platform, FALSE);
 
 		nlmsg = _nl_msg_new_dump (refresh_all_info->obj_type,
-		                          refresh_all_info->addr_family);
+		                          refresh_all_info->addr_family,
+		                          0,
+		                          0);
 		if (!nlmsg)
 			goto next_after_fail;
 
@@ -6493,6 +7706,121 @@ do_request_one_type_by_needle_object (NMPlatform *platform, const NMPObject *obj
 	delayed_action_handle_all (platform, FALSE);
 }
 
+/**
+ * do_request_filtered:
+ * @platform: the #NMPlatform instance
+ * @obj_type: the type of objects to refresh. Only IP addresses and
+ *   routes are supported.
+ * @ifindex: if positive, only refresh the objects of this interface.
+ * @table: if non-zero, only refresh the routes of this table.
+ *
+ * Like a refresh-all of @obj_type, but only the objects matching the filter
+ * are marked dirty (and pruned, if they don't show up in the dump). If kernel
+ * supports strict checking of dump requests, it only sends us the matching objects.
+ * Otherwise we get the full dump, which is equally correct.
+ */
+static void
+do_request_filtered (NMPlatform *platform,
+                     NMPObjectType obj_type,
+                     int ifindex,
+                     guint32 table)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	NMPCache *cache = nm_platform_get_cache (platform);
+	nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
+	RefreshAllType refresh_all_type;
+	const RefreshAllInfo *refresh_all_info;
+	DelayedActionType action_type;
+	int *out_refresh_all_in_progress;
+	NMDedupMultiIter iter;
+	NMPLookup lookup;
+
+	switch (obj_type) {
+	case NMP_OBJECT_TYPE_IP4_ADDRESS: refresh_all_type = REFRESH_ALL_TYPE_IP4_ADDRESSES; break;
+	case NMP_OBJECT_TYPE_IP6_ADDRESS: refresh_all_type = REFRESH_ALL_TYPE_IP6_ADDRESSES; break;
+	case NMP_OBJECT_TYPE_IP4_ROUTE:   refresh_all_type = REFRESH_ALL_TYPE_IP4_ROUTES;    break;
+	case NMP_OBJECT_TYPE_IP6_ROUTE:   refresh_all_type = REFRESH_ALL_TYPE_IP6_ROUTES;    break;
+	default:
+		g_return_if_reached ();
+	}
+
+	if (!NM_IN_SET (obj_type, NMP_OBJECT_TYPE_IP4_ROUTE, NMP_OBJECT_TYPE_IP6_ROUTE))
+		table = 0;
+
+	refresh_all_info = refresh_all_type_get_info (refresh_all_type);
+	action_type = delayed_action_type_from_refresh_all_type (refresh_all_type);
+
+	if (NM_FLAGS_HAS (priv->delayed_action.flags, action_type)) {
+		/* a full refresh is already scheduled. It covers our request. */
+		delayed_action_handle_all (platform, FALSE);
+		return;
+	}
+
+	_LOGD ("do-request-filtered: %s, ifindex %d, table %u%s",
+	       nmp_class_from_type (obj_type)->obj_type_name,
+	       ifindex,
+	       (guint) table,
+	       priv->nlh_strict_check ? "" : " (no kernel filtering)");
+
+	priv->pruning[refresh_all_type] += 1;
+	if (ifindex > 0)
+		nmp_lookup_init_object (&lookup, obj_type, ifindex);
+	else
+		nmp_lookup_init_obj_type (&lookup, obj_type);
+	nm_dedup_multi_iter_for_each (&iter, nmp_cache_lookup (cache, &lookup)) {
+		const NMDedupMultiEntry *main_entry;
+
+		if (   table != 0
+		    && nm_platform_route_table_uncoerce (NMP_OBJECT_CAST_IP_ROUTE (iter.current->obj)->table_coerced, TRUE) != table)
+			continue;
+
+		main_entry = nmp_cache_reresolve_main_entry (cache, iter.current, &lookup);
+		nm_dedup_multi_entry_set_dirty (main_entry, TRUE);
+	}
+
+	out_refresh_all_in_progress = &priv->delayed_action.refresh_all_in_progress[refresh_all_type];
+	nm_assert (*out_refresh_all_in_progress >= 0);
+	*out_refresh_all_in_progress += 1;
+
+	event_handler_read_netlink (platform, FALSE);
+
+	nlmsg = _nl_msg_new_dump (obj_type,
+	                          refresh_all_info->addr_family,
+	                          ifindex,
+	                          table);
+	if (   !nlmsg
+	    || _nl_send_nlmsg (platform,
+	                       nlmsg,
+	                       NULL,
+	                       NULL,
+	                       DELAYED_ACTION_RESPONSE_TYPE_REFRESH_ALL_IN_PROGRESS,
+	                       out_refresh_all_in_progress) < 0) {
+		nm_assert (*out_refresh_all_in_progress > 0);
+		*out_refresh_all_in_progress -= 1;
+	}
+
+	delayed_action_handle_all (platform, FALSE);
+}
+
+static void
+do_request_refetch_object (NMPlatform *platform, const NMPObject *obj_needle, gboolean all_ifindexes)
+{
+	switch (NMP_OBJECT_GET_TYPE (obj_needle)) {
+	case NMP_OBJECT_TYPE_IP4_ADDRESS:
+	case NMP_OBJECT_TYPE_IP6_ADDRESS:
+	case NMP_OBJECT_TYPE_IP4_ROUTE:
+	case NMP_OBJECT_TYPE_IP6_ROUTE:
+		do_request_filtered (platform,
+		                     NMP_OBJECT_GET_TYPE (obj_needle),
+		                     all_ifindexes ? 0 : NMP_OBJECT_CAST_OBJ_WITH_IFINDEX (obj_needle)->ifindex,
+		                     0);
+		break;
+	default:
+		do_request_one_type_by_needle_object (platform, obj_needle);
+		break;
+	}
+}
+
 static void
 event_seq_check_refresh_all (NMPlatform *platform, guint32 seq_number)
 {
@@ -6507,65 +7835,169 @@ event_seq_check_refresh_all (NMPlatform *platform, guint32 seq_number)
 		nm_assert (priv->delayed_action.list_wait_for_nl_response->len > 0);
 
 		for (i = 0; i < priv->delayed_action.list_wait_for_nl_response->len; i++) {
-			data = &g_array_index (priv->delayed_action.list_wait_for_nl_response, DelayedActionWaitForNlResponseData, i);
+			data = &g_array_index (priv->delayed_action.list_wait_for_nl_response, DelayedActionWaitForNlResponseData, i);
+
+			if (   data->response_type == DELAYED_ACTION_RESPONSE_TYPE_REFRESH_ALL_IN_PROGRESS
+			    && data->response.out_refresh_all_in_progress
+			    && data->seq_number == priv->nlh_seq_last_seen) {
+				*data->response.out_refresh_all_in_progress -= 1;
+				data->response.out_refresh_all_in_progress = NULL;
+				break;
+			}
+		}
+	}
+
+	priv->nlh_seq_last_seen = seq_number;
+}
+
+static void
+event_seq_check (NMPlatform *platform, guint32 seq_number, WaitForNlResponseResult seq_result, const char *msg)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	DelayedActionWaitForNlResponseData *data;
+	guint i;
+
+	if (seq_number == 0)
+		return;
+
+	if (NM_FLAGS_HAS (priv->delayed_action.flags, DELAYED_ACTION_TYPE_WAIT_FOR_NL_RESPONSE)) {
+		nm_assert (priv->delayed_action.list_wait_for_nl_response->len > 0);
+
+		for (i = 0; i < priv->delayed_action.list_wait_for_nl_response->len; i++) {
+			data = &g_array_index (priv->delayed_action.list_wait_for_nl_response, DelayedActionWaitForNlResponseData, i);
+
+			if (data->seq_number == seq_number) {
+				/* We potentially receive many parts partial responses for the same sequence number.
+				 * Thus, we only remember the result, and collect it later. */
+				if (data->seq_result < 0) {
+					/* we already saw an error for this sequence number.
+					 * Preserve it. */
+				} else if (   seq_result != WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_UNKNOWN
+				           || data->seq_result == WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN)
+					data->seq_result = seq_result;
+				if (data->out_errmsg && !*data->out_errmsg)
+					*data->out_errmsg = g_strdup (msg);
+				return;
+			}
+		}
+	}
+
+#if NM_MORE_LOGGING
+	if (seq_number != priv->nlh_seq_last_handled)
+		_LOGt ("netlink: recvmsg: unwaited sequence number %u", seq_number);
+	priv->nlh_seq_last_handled = seq_number;
+#endif
+}
+
+static DelayedActionType
+_event_refresh_types_from_nlmsg_type (guint16 nlmsg_type)
+{
+	switch (nlmsg_type) {
+	case RTM_NEWLINK:
+	case RTM_DELLINK:
+		return DELAYED_ACTION_TYPE_REFRESH_ALL_LINKS;
+	case RTM_NEWADDR:
+	case RTM_DELADDR:
+		return   DELAYED_ACTION_TYPE_REFRESH_ALL_IP4_ADDRESSES
+		       | DELAYED_ACTION_TYPE_REFRESH_ALL_IP6_ADDRESSES;
+	case RTM_NEWROUTE:
+	case RTM_DELROUTE:
+		return   DELAYED_ACTION_TYPE_REFRESH_ALL_IP4_ROUTES
+		       | DELAYED_ACTION_TYPE_REFRESH_ALL_IP6_ROUTES;
+	case RTM_NEWRULE:
+	case RTM_DELRULE:
+		return DELAYED_ACTION_TYPE_REFRESH_ALL_ROUTING_RULES_ALL;
+	case RTM_NEWQDISC:
+	case RTM_DELQDISC:
+		return DELAYED_ACTION_TYPE_REFRESH_ALL_QDISCS;
+	case RTM_NEWTFILTER:
+	case RTM_DELTFILTER:
+		return DELAYED_ACTION_TYPE_REFRESH_ALL_TFILTERS;
+	}
+	return DELAYED_ACTION_TYPE_NONE;
+}
+
+static gboolean
+_event_route_msg_ignored (NMPlatform *platform, struct nlmsghdr *msghdr)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	const struct rtmsg *rtm;
+	const struct nlattr *nla;
+	guint32 table;
+
+	if (!nlmsg_valid_hdr (msghdr, sizeof (struct rtmsg)))
+		return FALSE;
+
+	rtm = nlmsg_data (msghdr);
+
+	if (!NM_IN_SET (rtm->rtm_family, AF_INET, AF_INET6))
+		return FALSE;
+
+	/* never drop responses to RTM_GETROUTE. */
+	if (NM_FLAGS_HAS (rtm->rtm_flags, RTM_F_CLONED))
+		return FALSE;
+	if (NM_FLAGS_HAS (priv->delayed_action.flags, DELAYED_ACTION_TYPE_WAIT_FOR_NL_RESPONSE)) {
+		guint i;
+
+		for (i = 0; i < priv->delayed_action.list_wait_for_nl_response->len; i++) {
+			const DelayedActionWaitForNlResponseData *data = &g_array_index (priv->delayed_action.list_wait_for_nl_response, DelayedActionWaitForNlResponseData, i);
 
-			if (   data->response_type == DELAYED_ACTION_RESPONSE_TYPE_REFRESH_ALL_IN_PROGRESS
-			    && data->response.out_refresh_all_in_progress
-			    && data->seq_number == priv->nlh_seq_last_seen) {
-				*data->response.out_refresh_all_in_progress -= 1;
-				data->response.out_refresh_all_in_progress = NULL;
-				break;
-			}
+			if (   data->response_type == DELAYED_ACTION_RESPONSE_TYPE_ROUTE_GET
+			    && data->seq_number == msghdr->nlmsg_seq)
+				return FALSE;
 		}
 	}
 
-	priv->nlh_seq_last_seen = seq_number;
+	nla = nlmsg_find_attr (msghdr, sizeof (struct rtmsg), RTA_TABLE);
+	table =   nla && nla_len (nla) >= (int) sizeof (guint32)
+	        ? nla_get_u32 (nla)
+	        : (guint32) rtm->rtm_table;
+
+	return nm_platform_route_cache_scope_ignores (platform, rtm->rtm_protocol, table);
 }
 
 static void
-event_seq_check (NMPlatform *platform, guint32 seq_number, WaitForNlResponseResult seq_result, const char *msg)
+_event_route_msg_ignored_replace (NMPlatform *platform, const NMPObject *obj)
 {
-	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
-	DelayedActionWaitForNlResponseData *data;
-	guint i;
+	NMPCache *cache = nm_platform_get_cache (platform);
+	nm_auto_nmpobj const NMPObject *obj_replace = NULL;
+	const NMDedupMultiHeadEntry *head_entry;
+	NMPCacheOpsType cache_op;
 
-	if (seq_number == 0)
+	/* The route protocol is not part of the kernel's identity of a route. An
+	 * ignored route can thus replace a route that we have in the cache. Like
+	 * nmp_cache_update_netlink_route() does for NLM_F_REPLACE, that is the first
+	 * route with the same weak-id. */
+	head_entry = nmp_cache_lookup_all (cache, NMP_CACHE_ID_TYPE_ROUTES_BY_WEAK_ID, obj);
+	if (!head_entry)
 		return;
 
-	if (NM_FLAGS_HAS (priv->delayed_action.flags, DELAYED_ACTION_TYPE_WAIT_FOR_NL_RESPONSE)) {
-		nm_assert (priv->delayed_action.list_wait_for_nl_response->len > 0);
-
-		for (i = 0; i < priv->delayed_action.list_wait_for_nl_response->len; i++) {
-			data = &g_array_index (priv->delayed_action.list_wait_for_nl_response, DelayedActionWaitForNlResponseData, i);
-
-			if (data->seq_number == seq_number) {
-				/* We potentially receive many parts partial responses for the same sequence number.
-				 * Thus, we only remember the result, and collect it later. */
-				if (data->seq_result < 0) {
-					/* we already saw an error for this sequence number.
-					 * Preserve it. */
-				} else if (   seq_result != WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_UNKNOWN
-				           || data->seq_result == WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN)
-					data->seq_result = seq_result;
-				if (data->out_errmsg && !*data->out_errmsg)
-					*data->out_errmsg = g_strdup (msg);
-				return;
-			}
-		}
+	obj_replace = nmp_object_ref (nm_dedup_multi_head_entry_get_idx (head_entry, 0)->obj);
+	cache_op = nmp_cache_remove (cache, obj_replace, TRUE, FALSE, NULL);
+	if (cache_op != NMP_CACHE_OPS_UNCHANGED) {
+		nm_assert (cache_op == NMP_CACHE_OPS_REMOVED);
+		cache_on_change (platform, cache_op, obj_replace, NULL);
+		nm_platform_cache_update_emit_signal (platform, cache_op, obj_replace, NULL);
 	}
-
-#if NM_MORE_LOGGING
-	if (seq_number != priv->nlh_seq_last_handled)
-		_LOGt ("netlink: recvmsg: unwaited sequence number %u", seq_number);
-	priv->nlh_seq_last_handled = seq_number;
-#endif
 }
 
+/**
+ * event_valid_msg:
+ * @platform: the platform instance
+ * @msg: the netlink message
+ * @p_obj_parsed: (allow-none): if given, @msg was already parsed by
+ *   the netlink worker and the result is stolen from here. It may be
+ *   %NULL, if the message could not be parsed.
+ * @handle_events: whether to update the cache
+ */
 static void
-event_valid_msg (NMPlatform *platform, struct nl_msg *msg, gboolean handle_events)
+event_valid_msg (NMPlatform *platform,
+                 struct nl_msg *msg,
+                 NMPObject **p_obj_parsed,
+                 gboolean handle_events)
 {
 	NMLinuxPlatformPrivate *priv;
-	nm_auto_nmpobj NMPObject *obj = NULL;
+	nm_auto_nmpobj NMPObject *obj = p_obj_parsed ? g_steal_pointer (p_obj_parsed) : NULL;
 	NMPCacheOpsType cache_op;
 	struct nlmsghdr *msghdr;
 	char buf_nlmsghdr[400];
@@ -6575,6 +8007,10 @@ event_valid_msg (NMPlatform *platform, struct nl_msg *msg, gboolean handle_event
 
 	msghdr = nlmsg_hdr (msg);
 
+	/* remember which types are busy. In case of an overflow, these are the
+	 * ones that most likely lost events. */
+	NM_LINUX_PLATFORM_GET_PRIVATE (platform)->nl_event.types_seen |= _event_refresh_types_from_nlmsg_type (msghdr->nlmsg_type);
+
 	if (   !_nm_platform_kernel_support_detected (NM_PLATFORM_KERNEL_SUPPORT_TYPE_EXTENDED_IFA_FLAGS)
 	    && msghdr->nlmsg_type == RTM_NEWADDR) {
 		/* IFA_FLAGS is set for IPv4 and IPv6 addresses. It was added first to IPv6,
@@ -6600,6 +8036,12 @@ event_valid_msg (NMPlatform *platform, struct nl_msg *msg, gboolean handle_event
 	if (!handle_events)
 		return;
 
+	if (NM_IN_SET (msghdr->nlmsg_type, RTM_NEWNETCONF,
+	                                   RTM_DELNETCONF)) {
+		_sysctl_cache_netconf_event (platform, msghdr);
+		return;
+	}
+
 	if (NM_IN_SET (msghdr->nlmsg_type, RTM_DELLINK,
 	                                   RTM_DELADDR,
 	                                   RTM_DELROUTE,
@@ -6611,7 +8053,26 @@ event_valid_msg (NMPlatform *platform, struct nl_msg *msg, gboolean handle_event
 		is_del = TRUE;
 	}
 
-	obj = nmp_object_new_from_nl (platform, cache, msg, is_del);
+	if (   msghdr->nlmsg_type == RTM_NEWROUTE
+	    && _event_route_msg_ignored (platform, msghdr)) {
+		/* the route is outside the configured cache scope. Don't bother
+		 * parsing it. See nm_platform_route_cache_scope_set().
+		 *
+		 * Except, if it replaced another route. That one might be in scope
+		 * and must be removed from the cache. */
+		_LOGT ("event-notification: %s: ignore (out of route cache scope)",
+		       nl_nlmsghdr_to_str (msghdr, buf_nlmsghdr, sizeof (buf_nlmsghdr)));
+		if (NM_FLAGS_HAS (msghdr->nlmsg_flags, NLM_F_REPLACE)) {
+			if (!p_obj_parsed)
+				obj = nmp_object_new_from_nl (platform, cache, msg, FALSE);
+			if (obj)
+				_event_route_msg_ignored_replace (platform, obj);
+		}
+		return;
+	}
+
+	if (!p_obj_parsed)
+		obj = nmp_object_new_from_nl (platform, cache, msg, is_del);
 	if (!obj) {
 		_LOGT ("event-notification: %s: ignore",
 		       nl_nlmsghdr_to_str (msghdr, buf_nlmsghdr, sizeof (buf_nlmsghdr)));
@@ -6640,6 +8101,19 @@ event_valid_msg (NMPlatform *platform, struct nl_msg *msg, gboolean handle_event
 		nm_auto_nmpobj const NMPObject *obj_old = NULL;
 		nm_auto_nmpobj const NMPObject *obj_new = NULL;
 
+		if (   msghdr->nlmsg_type == RTM_NEWLINK
+		    && msghdr->nlmsg_seq == 0
+		    && !NM_FLAGS_HAS (msghdr->nlmsg_flags, NLM_F_MULTI)) {
+			/* this is also how the kernel announces changed ethtool settings
+			 * of the link. They are not part of the link object, so do this
+			 * even if the link in the cache does not change.
+			 *
+			 * Only for notifications from the kernel, though. Dumps and the
+			 * replies to our own requests (which carry our sequence number)
+			 * don't indicate a change of the ethtool settings. */
+			nm_platform_ethtool_cache_link_event (platform, NMP_OBJECT_CAST_LINK (obj)->ifindex);
+		}
+
 		switch (msghdr->nlmsg_type) {
 
 		case RTM_GETLINK:
@@ -6856,34 +8330,163 @@ do_add_addrroute (NMPlatform *platform,
 		 *
 		 * rh#1484434 */
 		if (!nmp_cache_lookup_obj (nm_platform_get_cache (platform), obj_id))
-			do_request_one_type_by_needle_object (platform, obj_id);
+			do_request_refetch_object (platform, obj_id, FALSE);
 	}
 
 	return wait_for_nl_response_to_nmerr (seq_result);
 }
 
-static gboolean
-do_delete_object (NMPlatform *platform, const NMPObject *obj_id, struct nl_msg *nlmsg)
-{
-	WaitForNlResponseResult seq_result = WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN;
-	gs_free char *errmsg = NULL;
-	int nle;
+/**
+ * do_request_many:
+ * @platform:
+ * @log_op: the operation name for logging, like "add" or "delete".
+ * @objs_id: the IDs of the objects, for logging.
+ * @nlmsgs: the prepared netlink requests, one for each object.
+ * @len: the number of objects.
+ * @seq_results: an array of @len elements that receives the ACK result for
+ *   each request. If sending a request failed, its result stays
+ *   %WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN (this was already logged).
+ * @errmsgs: an array of @len elements that receives the extended ACK
+ *   error messages. The caller must free them.
+ *
+ * Sends the requests in batches and waits for the ACKs once per batch.
+ */
+static void
+do_request_many (NMPlatform *platform,
+                 const char *log_op,
+                 const NMPObject *const*objs_id,
+                 struct nl_msg *const*nlmsgs,
+                 guint len,
+                 WaitForNlResponseResult *seq_results,
+                 char **errmsgs)
+{
+	guint i_start;
+	guint i_end;
+	guint i;
+
+	for (i_start = 0; i_start < len; i_start = i_end) {
+		gsize n_bytes = 0;
+		int nle;
+
+		for (i_end = i_start; i_end < len; i_end++) {
+			gsize l = nlmsg_hdr (nlmsgs[i_end])->nlmsg_len;
+
+			if (   i_end > i_start
+			    && (   i_end - i_start >= NL_SEND_BATCH_MAX_MSGS
+			        || n_bytes + l > NL_SEND_BATCH_MAX_BYTES))
+				break;
+			n_bytes += l;
+		}
+
+		event_handler_read_netlink (platform, FALSE);
+
+		nle = _nl_send_nlmsg_many (platform,
+		                           &nlmsgs[i_start],
+		                           i_end - i_start,
+		                           &seq_results[i_start],
+		                           &errmsgs[i_start]);
+		if (nle < 0) {
+			for (i = i_start; i < i_end; i++) {
+				_LOGE ("do-%s-%s[%s]: failure sending netlink request \"%s\" (%d)",
+				       log_op,
+				       NMP_OBJECT_GET_CLASS (objs_id[i])->obj_type_name,
+				       nmp_object_to_string (objs_id[i], NMP_OBJECT_TO_STRING_ID, NULL, 0),
+				       nm_strerror (nle), -nle);
+			}
+			continue;
+		}
+
+		delayed_action_handle_all (platform, FALSE);
+	}
+}
+
+/**
+ * do_add_addrroute_many:
+ * @platform:
+ * @objs_id: the IDs of the objects to add, for logging.
+ * @nlmsgs: the prepared netlink requests, one for each object.
+ * @len: the number of objects.
+ * @suppress_netlink_failure: whether to log kernel failures only at debug level.
+ * @out_results: an array of @len elements that receives the result for each
+ *   object, like do_add_addrroute() would return it.
+ *
+ * Like calling do_add_addrroute() for each object, but the requests are
+ * sent in batches and we only wait for the ACKs once per batch.
+ */
+static void
+do_add_addrroute_many (NMPlatform *platform,
+                       const NMPObject *const*objs_id,
+                       struct nl_msg *const*nlmsgs,
+                       guint len,
+                       gboolean suppress_netlink_failure,
+                       int *out_results)
+{
+	gs_free WaitForNlResponseResult *seq_results = NULL;
+	gs_free char **errmsgs = NULL;
+	const NMPObject *obj_refetch = NULL;
+	gboolean refetch_all_ifindexes = FALSE;
 	char s_buf[256];
-	gboolean success;
-	const char *log_detail = "";
+	guint i;
 
-	event_handler_read_netlink (platform, FALSE);
+	if (len == 0)
+		return;
 
-	nle = _nl_send_nlmsg (platform, nlmsg, &seq_result, &errmsg, DELAYED_ACTION_RESPONSE_TYPE_VOID, NULL);
-	if (nle < 0) {
-		_LOGE ("do-delete-%s[%s]: failure sending netlink request \"%s\" (%d)",
-		       NMP_OBJECT_GET_CLASS (obj_id)->obj_type_name,
-		       nmp_object_to_string (obj_id, NMP_OBJECT_TO_STRING_ID, NULL, 0),
-		       nm_strerror (nle), -nle);
-		return FALSE;
+	seq_results = g_new0 (WaitForNlResponseResult, len);
+	errmsgs = g_new0 (char *, len);
+
+	do_request_many (platform, "add", objs_id, nlmsgs, len, seq_results, errmsgs);
+
+	for (i = 0; i < len; i++) {
+		const NMPObject *obj_id = objs_id[i];
+
+		nm_assert (NM_IN_SET (NMP_OBJECT_GET_TYPE (obj_id),
+		                      NMP_OBJECT_TYPE_IP4_ADDRESS, NMP_OBJECT_TYPE_IP6_ADDRESS,
+		                      NMP_OBJECT_TYPE_IP4_ROUTE, NMP_OBJECT_TYPE_IP6_ROUTE));
+
+		if (seq_results[i] == WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN) {
+			/* sending the request failed. Already logged. */
+			out_results[i] = -NME_PL_NETLINK;
+			continue;
+		}
+
+		_NMLOG ((   seq_results[i] == WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK
+		         || (   suppress_netlink_failure
+		             && seq_results[i] < 0))
+		            ? LOGL_DEBUG
+		            : LOGL_WARN,
+		        "do-add-%s[%s]: %s",
+		        NMP_OBJECT_GET_CLASS (obj_id)->obj_type_name,
+		        nmp_object_to_string (obj_id, NMP_OBJECT_TO_STRING_ID, NULL, 0),
+		        wait_for_nl_response_to_string (seq_results[i], errmsgs[i], s_buf, sizeof (s_buf)));
+
+		out_results[i] = wait_for_nl_response_to_nmerr (seq_results[i]);
+
+		/* See do_add_addrroute(). One refetch for the entire batch is enough. */
+		if (   NMP_OBJECT_GET_TYPE (obj_id) == NMP_OBJECT_TYPE_IP6_ADDRESS
+		    && !nmp_cache_lookup_obj (nm_platform_get_cache (platform), obj_id)) {
+			if (!obj_refetch)
+				obj_refetch = obj_id;
+			else if (NMP_OBJECT_CAST_IP_ADDRESS (obj_refetch)->ifindex != NMP_OBJECT_CAST_IP_ADDRESS (obj_id)->ifindex)
+				refetch_all_ifindexes = TRUE;
+		}
 	}
 
-	delayed_action_handle_all (platform, FALSE);
+	for (i = 0; i < len; i++)
+		g_free (errmsgs[i]);
+
+	if (obj_refetch)
+		do_request_refetch_object (platform, obj_refetch, refetch_all_ifindexes);
+}
+
+static gboolean
+_do_delete_object_log_result (NMPlatform *platform,
+                              const NMPObject *obj_id,
+                              WaitForNlResponseResult seq_result,
+                              const char *errmsg)
+{
+	char s_buf[256];
+	gboolean success;
+	const char *log_detail = "";
 
 	nm_assert (seq_result);
 
@@ -6909,24 +8512,115 @@ do_delete_object (NMPlatform *platform, const NMPObject *obj_id, struct nl_msg *
 	        wait_for_nl_response_to_string (seq_result, errmsg, s_buf, sizeof (s_buf)),
 	        log_detail);
 
-	if (NM_IN_SET (NMP_OBJECT_GET_TYPE (obj_id),
-	               NMP_OBJECT_TYPE_IP6_ADDRESS,
-	               NMP_OBJECT_TYPE_QDISC,
-	               NMP_OBJECT_TYPE_TFILTER)) {
-		/* In rare cases, the object is still there after we receive the ACK from
-		 * kernel. Need to refetch.
-		 *
-		 * We want to safe the expensive refetch, thus we look first into the cache
-		 * whether the object exists.
-		 *
-		 * rh#1484434 */
-		if (nmp_cache_lookup_obj (nm_platform_get_cache (platform), obj_id))
-			do_request_one_type_by_needle_object (platform, obj_id);
+	return success;
+}
+
+static gboolean
+_do_delete_object_needs_refetch (NMPlatform *platform,
+                                 const NMPObject *obj_id)
+{
+	/* In rare cases, the object is still there after we receive the ACK from
+	 * kernel. Need to refetch.
+	 *
+	 * We want to safe the expensive refetch, thus we look first into the cache
+	 * whether the object exists.
+	 *
+	 * rh#1484434 */
+	return    NM_IN_SET (NMP_OBJECT_GET_TYPE (obj_id),
+	                     NMP_OBJECT_TYPE_IP6_ADDRESS,
+	                     NMP_OBJECT_TYPE_QDISC,
+	                     NMP_OBJECT_TYPE_TFILTER)
+	       && nmp_cache_lookup_obj (nm_platform_get_cache (platform), obj_id);
+}
+
+static gboolean
+do_delete_object (NMPlatform *platform, const NMPObject *obj_id, struct nl_msg *nlmsg)
+{
+	WaitForNlResponseResult seq_result = WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN;
+	gs_free char *errmsg = NULL;
+	int nle;
+	gboolean success;
+
+	event_handler_read_netlink (platform, FALSE);
+
+	nle = _nl_send_nlmsg (platform, nlmsg, &seq_result, &errmsg, DELAYED_ACTION_RESPONSE_TYPE_VOID, NULL);
+	if (nle < 0) {
+		_LOGE ("do-delete-%s[%s]: failure sending netlink request \"%s\" (%d)",
+		       NMP_OBJECT_GET_CLASS (obj_id)->obj_type_name,
+		       nmp_object_to_string (obj_id, NMP_OBJECT_TO_STRING_ID, NULL, 0),
+		       nm_strerror (nle), -nle);
+		return FALSE;
 	}
 
+	delayed_action_handle_all (platform, FALSE);
+
+	success = _do_delete_object_log_result (platform, obj_id, seq_result, errmsg);
+
+	if (_do_delete_object_needs_refetch (platform, obj_id))
+		do_request_refetch_object (platform, obj_id, FALSE);
+
 	return success;
 }
 
+/**
+ * do_delete_object_many:
+ * @platform:
+ * @objs_id: the IDs of the objects to delete.
+ * @nlmsgs: the prepared netlink requests, one for each object.
+ * @len: the number of objects.
+ * @out_results: an array of @len elements that receives the result for each
+ *   object, like do_delete_object() would return it.
+ *
+ * Like calling do_delete_object() for each object, but the requests are
+ * sent in batches and we only wait for the ACKs once per batch.
+ */
+static void
+do_delete_object_many (NMPlatform *platform,
+                       const NMPObject *const*objs_id,
+                       struct nl_msg *const*nlmsgs,
+                       guint len,
+                       gboolean *out_results)
+{
+	gs_free WaitForNlResponseResult *seq_results = NULL;
+	gs_free char **errmsgs = NULL;
+	const NMPObject *obj_refetch = NULL;
+	gboolean refetch_all_ifindexes = FALSE;
+	guint i;
+
+	if (len == 0)
+		return;
+
+	seq_results = g_new0 (WaitForNlResponseResult, len);
+	errmsgs = g_new0 (char *, len);
+
+	do_request_many (platform, "delete", objs_id, nlmsgs, len, seq_results, errmsgs);
+
+	for (i = 0; i < len; i++) {
+		if (seq_results[i] == WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN) {
+			/* sending the request failed. Already logged. */
+			out_results[i] = FALSE;
+			continue;
+		}
+
+		out_results[i] = _do_delete_object_log_result (platform, objs_id[i], seq_results[i], errmsgs[i]);
+
+		/* One refetch for the entire batch is enough. */
+		if (_do_delete_object_needs_refetch (platform, objs_id[i])) {
+			if (!obj_refetch)
+				obj_refetch = objs_id[i];
+			else if (   NMP_OBJECT_GET_TYPE (obj_refetch) != NMP_OBJECT_GET_TYPE (objs_id[i])
+			         || NMP_OBJECT_CAST_OBJ_WITH_IFINDEX (obj_refetch)->ifindex != NMP_OBJECT_CAST_OBJ_WITH_IFINDEX (objs_id[i])->ifindex)
+				refetch_all_ifindexes = TRUE;
+		}
+	}
+
+	for (i = 0; i < len; i++)
+		g_free (errmsgs[i]);
+
+	if (obj_refetch)
+		do_request_refetch_object (platform, obj_refetch, refetch_all_ifindexes);
+}
+
 static int
 do_change_link (NMPlatform *platform,
                 ChangeLinkType change_link_type,
@@ -7086,7 +8780,12 @@ link_delete (NMPlatform *platform, int ifindex)
 static gboolean
 link_refresh (NMPlatform *platform, int ifindex)
 {
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	int wireguard_refresh_ifindex_old = priv->wireguard_refresh_ifindex;
+
+	priv->wireguard_refresh_ifindex = ifindex;
 	do_request_link (platform, ifindex, NULL);
+	priv->wireguard_refresh_ifindex = wireguard_refresh_ifindex_old;
 	return !!nm_platform_link_get_obj (platform, ifindex, TRUE);
 }
 
@@ -7149,6 +8848,131 @@ link_set_up (NMPlatform *platform, int ifindex, gboolean *out_no_firmware)
 	return r >= 0;
 }
 
+static void
+link_set_up_many (NMPlatform *platform,
+                  const int *ifindexes,
+                  guint len,
+                  int *out_results)
+{
+	nm_auto_pop_netns NMPNetns *netns = NULL;
+	gs_free struct nl_msg **nlmsgs = NULL;
+	gs_free WaitForNlResponseResult *seq_results = NULL;
+	gs_free char **errmsgs = NULL;
+	char s_buf[256];
+	guint i_start;
+	guint i_end;
+	guint i;
+
+	if (!nm_platform_netns_push (platform, &netns)) {
+		for (i = 0; i < len; i++)
+			out_results[i] = -NME_UNSPEC;
+		return;
+	}
+
+	nlmsgs = g_new0 (struct nl_msg *, len);
+	seq_results = g_new0 (WaitForNlResponseResult, len);
+	errmsgs = g_new0 (char *, len);
+
+	for (i = 0; i < len; i++) {
+		_LOGD ("link: change %d: flags: set up (batched)", ifindexes[i]);
+		nlmsgs[i] = _nl_msg_new_link_full (RTM_NEWLINK,
+		                                   0,
+		                                   ifindexes[i],
+		                                   NULL,
+		                                   AF_UNSPEC,
+		                                   IFF_UP,
+		                                   IFF_UP);
+		if (!nlmsgs[i]) {
+			g_warn_if_reached ();
+			for (i = 0; i < len; i++)
+				out_results[i] = -NME_UNSPEC;
+			goto out;
+		}
+	}
+
+	/* the requests carry no attributes, so NL_SEND_BATCH_MAX_BYTES is
+	 * not a concern. */
+	for (i_start = 0; i_start < len; i_start = i_end) {
+		int nle;
+
+		i_end = MIN (len, i_start + NL_SEND_BATCH_MAX_MSGS);
+
+		event_handler_read_netlink (platform, FALSE);
+
+		nle = _nl_send_nlmsg_many (platform,
+		                           &nlmsgs[i_start],
+		                           i_end - i_start,
+		                           &seq_results[i_start],
+		                           &errmsgs[i_start]);
+		if (nle < 0) {
+			for (i = i_start; i < i_end; i++) {
+				_LOGE ("do-change-link[%d]: failure sending netlink request: %s (%d)",
+				       ifindexes[i], nm_strerror (nle), -nle);
+			}
+			continue;
+		}
+
+		/* like do_change_link(), always refetch the links. The refresh
+		 * requests are sent before waiting for the responses. */
+		for (i = i_start; i < i_end; i++)
+			delayed_action_schedule (platform, DELAYED_ACTION_TYPE_REFRESH_LINK, GINT_TO_POINTER (ifindexes[i]));
+
+		delayed_action_handle_all (platform, FALSE);
+	}
+
+	for (i = 0; i < len; i++) {
+		const int errsv = -((int) seq_results[i]);
+		NMLogLevel log_level = LOGL_DEBUG;
+		const char *log_detail = "";
+		int result;
+
+		if (seq_results[i] == WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN) {
+			/* sending the request failed. Already logged. */
+			out_results[i] = -NME_PL_NETLINK;
+			continue;
+		}
+
+		if (errsv == EOPNOTSUPP) {
+			/* do_change_link() retries with RTM_SETLINK. That is rare,
+			 * just do the request again. */
+			out_results[i] = link_change_flags (platform, ifindexes[i], IFF_UP, IFF_UP);
+			continue;
+		}
+
+		if (   seq_results[i] == WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK
+		    || NM_IN_SET (errsv, EEXIST, EADDRINUSE))
+			result = 0;
+		else if (NM_IN_SET (errsv, ESRCH, ENOENT)) {
+			log_detail = ", firmware not found";
+			result = -NME_PL_NO_FIRMWARE;
+		} else if (errsv == ENODEV)
+			result = -NME_PL_NOT_FOUND;
+		else if (errsv == EAFNOSUPPORT)
+			result = -NME_PL_OPNOTSUPP;
+		else {
+			log_level = LOGL_WARN;
+			result = -NME_UNSPEC;
+		}
+
+		_NMLOG (log_level,
+		        "do-change-link[%d]: %s changing link: %s%s",
+		        ifindexes[i],
+		          seq_results[i] == WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK
+		        ? "success"
+		        : "failure",
+		        wait_for_nl_response_to_string (seq_results[i], errmsgs[i], s_buf, sizeof (s_buf)),
+		        log_detail);
+
+		out_results[i] = result;
+	}
+
+out:
+	for (i = 0; i < len; i++) {
+		nlmsg_free (nlmsgs[i]);
+		g_free (errmsgs[i]);
+	}
+}
+
 static gboolean
 link_set_down (NMPlatform *platform, int ifindex)
 {
@@ -7314,6 +9138,11 @@ nla_put_failure:
 	g_return_val_if_reached (FALSE);
 }
 
+/* NMPlatform calls link_get_permanent_address() and link_get_driver_info()
+ * also on worker threads. See nm_platform_link_ethtool_query_async(). */
+#undef NM_THREAD_SAFE_ON_MAIN_THREAD
+#define NM_THREAD_SAFE_ON_MAIN_THREAD 0
+
 static gboolean
 link_get_permanent_address (NMPlatform *platform,
                             int ifindex,
@@ -7328,6 +9157,9 @@ link_get_permanent_address (NMPlatform *platform,
 	return nmp_utils_ethtool_get_permanent_address (ifindex, buf, length);
 }
 
+#undef NM_THREAD_SAFE_ON_MAIN_THREAD
+#define NM_THREAD_SAFE_ON_MAIN_THREAD 1
+
 static int
 link_set_mtu (NMPlatform *platform, int ifindex, guint32 mtu)
 {
@@ -8208,6 +10040,9 @@ link_get_wake_on_lan (NMPlatform *platform, int ifindex)
 		return FALSE;
 }
 
+#undef NM_THREAD_SAFE_ON_MAIN_THREAD
+#define NM_THREAD_SAFE_ON_MAIN_THREAD 0
+
 static gboolean
 link_get_driver_info (NMPlatform *platform,
                       int ifindex,
@@ -8229,6 +10064,9 @@ link_get_driver_info (NMPlatform *platform,
 	return TRUE;
 }
 
+#undef NM_THREAD_SAFE_ON_MAIN_THREAD
+#define NM_THREAD_SAFE_ON_MAIN_THREAD 1
+
 /*****************************************************************************/
 
 static gboolean
@@ -8343,8 +10181,129 @@ ip6_address_delete (NMPlatform *platform, int ifindex, struct in6_addr addr, gui
 	if (!nlmsg)
 		g_return_val_if_reached (FALSE);
 
-	nmp_object_stackinit_id_ip6_address (&obj_id, ifindex, &addr);
-	return do_delete_object (platform, &obj_id, nlmsg);
+	nmp_object_stackinit_id_ip6_address (&obj_id, ifindex, &addr);
+	return do_delete_object (platform, &obj_id, nlmsg);
+}
+
+static struct nl_msg *
+_nl_msg_new_address_from_obj (int nlmsg_type,
+                              int addr_family,
+                              const NMPlatformIPXAddress *address,
+                              NMPObject *out_obj_id)
+{
+	const gboolean is_delete = (nlmsg_type == RTM_DELADDR);
+
+	if (addr_family == AF_INET) {
+		const NMPlatformIP4Address *a = &address->a4;
+
+		nmp_object_stackinit_id_ip4_address (out_obj_id, a->ifindex, a->address, a->plen, a->peer_address);
+		return _nl_msg_new_address (nlmsg_type,
+		                            is_delete ? 0 : NLM_F_CREATE | NLM_F_REPLACE,
+		                            AF_INET,
+		                            a->ifindex,
+		                            &a->address,
+		                            a->plen,
+		                            &a->peer_address,
+		                            is_delete ? 0 : a->n_ifa_flags,
+		                              is_delete
+		                            ? RT_SCOPE_NOWHERE
+		                            : (  nm_utils_ip4_address_is_link_local (a->address)
+		                               ? RT_SCOPE_LINK
+		                               : RT_SCOPE_UNIVERSE),
+		                            is_delete ? NM_PLATFORM_LIFETIME_PERMANENT : a->lifetime,
+		                            is_delete ? NM_PLATFORM_LIFETIME_PERMANENT : a->preferred,
+		                            is_delete ? 0 : a->broadcast_address,
+		                            is_delete ? NULL : a->label);
+	} else {
+		const NMPlatformIP6Address *a = &address->a6;
+
+		nm_assert (addr_family == AF_INET6);
+
+		nmp_object_stackinit_id_ip6_address (out_obj_id, a->ifindex, &a->address);
+		return _nl_msg_new_address (nlmsg_type,
+		                            is_delete ? 0 : NLM_F_CREATE | NLM_F_REPLACE,
+		                            AF_INET6,
+		                            a->ifindex,
+		                            &a->address,
+		                            a->plen,
+		                              is_delete || IN6_IS_ADDR_UNSPECIFIED (&a->peer_address)
+		                            ? NULL
+		                            : &a->peer_address,
+		                            is_delete ? 0 : a->n_ifa_flags,
+		                            is_delete ? RT_SCOPE_NOWHERE : RT_SCOPE_UNIVERSE,
+		                            is_delete ? NM_PLATFORM_LIFETIME_PERMANENT : a->lifetime,
+		                            is_delete ? NM_PLATFORM_LIFETIME_PERMANENT : a->preferred,
+		                            0,
+		                            NULL);
+	}
+}
+
+static void
+ip_address_change_many (NMPlatform *platform,
+                        int nlmsg_type,
+                        int addr_family,
+                        const NMPlatformIPXAddress *addresses,
+                        guint len,
+                        gboolean *out_results)
+{
+	gs_free NMPObject *objs = NULL;
+	gs_free const NMPObject **objs_id = NULL;
+	gs_free struct nl_msg **nlmsgs = NULL;
+	guint i;
+
+	nm_assert (NM_IN_SET (addr_family, AF_INET, AF_INET6));
+	nm_assert (NM_IN_SET (nlmsg_type, RTM_NEWADDR, RTM_DELADDR));
+
+	if (len == 0)
+		return;
+
+	objs = g_new (NMPObject, len);
+	objs_id = g_new (const NMPObject *, len);
+	nlmsgs = g_new0 (struct nl_msg *, len);
+
+	for (i = 0; i < len; i++) {
+		objs_id[i] = &objs[i];
+		nlmsgs[i] = _nl_msg_new_address_from_obj (nlmsg_type, addr_family, &addresses[i], &objs[i]);
+		if (!nlmsgs[i]) {
+			for (i = 0; i < len; i++)
+				out_results[i] = FALSE;
+			g_warn_if_reached ();
+			goto out;
+		}
+	}
+
+	if (nlmsg_type == RTM_NEWADDR) {
+		gs_free int *results = g_new (int, len);
+
+		do_add_addrroute_many (platform, objs_id, nlmsgs, len, FALSE, results);
+		for (i = 0; i < len; i++)
+			out_results[i] = (results[i] >= 0);
+	} else
+		do_delete_object_many (platform, objs_id, nlmsgs, len, out_results);
+
+out:
+	for (i = 0; i < len; i++)
+		nlmsg_free (nlmsgs[i]);
+}
+
+static void
+ip_address_add_many (NMPlatform *platform,
+                     int addr_family,
+                     const NMPlatformIPXAddress *addresses,
+                     guint len,
+                     gboolean *out_results)
+{
+	ip_address_change_many (platform, RTM_NEWADDR, addr_family, addresses, len, out_results);
+}
+
+static void
+ip_address_delete_many (NMPlatform *platform,
+                        int addr_family,
+                        const NMPlatformIPXAddress *addresses,
+                        guint len,
+                        gboolean *out_results)
+{
+	ip_address_change_many (platform, RTM_DELADDR, addr_family, addresses, len, out_results);
 }
 
 /*****************************************************************************/
@@ -8380,39 +10339,127 @@ ip_route_add (NMPlatform *platform,
 	                         NM_FLAGS_HAS (flags, NMP_NLM_FLAG_SUPPRESS_NETLINK_FAILURE));
 }
 
-static gboolean
-object_delete (NMPlatform *platform,
-               const NMPObject *obj)
-{
-	nm_auto_nmpobj const NMPObject *obj_keep_alive = NULL;
-	nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
+static void
+ip_route_add_many (NMPlatform *platform,
+                   NMPNlmFlags flags,
+                   int addr_family,
+                   const NMPObject *const*routes,
+                   guint len,
+                   int *out_results)
+{
+	gs_free NMPObject *objs = NULL;
+	gs_free const NMPObject **objs_id = NULL;
+	gs_free struct nl_msg **nlmsgs = NULL;
+	NMPObjectType obj_type;
+	guint i;
 
-	if (!NMP_OBJECT_IS_STACKINIT (obj))
-		obj_keep_alive = nmp_object_ref (obj);
+	nm_assert (NM_IN_SET (addr_family, AF_INET, AF_INET6));
 
+	obj_type =   addr_family == AF_INET
+	           ? NMP_OBJECT_TYPE_IP4_ROUTE
+	           : NMP_OBJECT_TYPE_IP6_ROUTE;
+
+	objs = g_new (NMPObject, len);
+	objs_id = g_new (const NMPObject *, len);
+	nlmsgs = g_new0 (struct nl_msg *, len);
+
+	for (i = 0; i < len; i++) {
+		nm_assert (NMP_OBJECT_GET_TYPE (routes[i]) == obj_type);
+
+		nmp_object_stackinit (&objs[i], obj_type, NMP_OBJECT_CAST_IP_ROUTE (routes[i]));
+		nm_platform_ip_route_normalize (addr_family, NMP_OBJECT_CAST_IP_ROUTE (&objs[i]));
+		objs_id[i] = &objs[i];
+
+		nlmsgs[i] = _nl_msg_new_route (RTM_NEWROUTE, flags & NMP_NLM_FLAG_FMASK, &objs[i]);
+		if (!nlmsgs[i]) {
+			for (i = 0; i < len; i++)
+				out_results[i] = -NME_BUG;
+			g_warn_if_reached ();
+			goto out;
+		}
+	}
+
+	do_add_addrroute_many (platform,
+	                       objs_id,
+	                       nlmsgs,
+	                       len,
+	                       NM_FLAGS_HAS (flags, NMP_NLM_FLAG_SUPPRESS_NETLINK_FAILURE),
+	                       out_results);
+
+out:
+	for (i = 0; i < len; i++)
+		nlmsg_free (nlmsgs[i]);
+}
+
+static struct nl_msg *
+_nl_msg_new_delete (const NMPObject *obj)
+{
 	switch (NMP_OBJECT_GET_TYPE (obj)) {
 	case NMP_OBJECT_TYPE_IP4_ROUTE:
 	case NMP_OBJECT_TYPE_IP6_ROUTE:
-		nlmsg = _nl_msg_new_route (RTM_DELROUTE, 0, obj);
-		break;
+		return _nl_msg_new_route (RTM_DELROUTE, 0, obj);
 	case NMP_OBJECT_TYPE_ROUTING_RULE:
-		nlmsg = _nl_msg_new_routing_rule (RTM_DELRULE, 0, NMP_OBJECT_CAST_ROUTING_RULE (obj));
-		break;
+		return _nl_msg_new_routing_rule (RTM_DELRULE, 0, NMP_OBJECT_CAST_ROUTING_RULE (obj));
 	case NMP_OBJECT_TYPE_QDISC:
-		nlmsg = _nl_msg_new_qdisc (RTM_DELQDISC, 0, NMP_OBJECT_CAST_QDISC (obj));
-		break;
+		return _nl_msg_new_qdisc (RTM_DELQDISC, 0, NMP_OBJECT_CAST_QDISC (obj));
 	case NMP_OBJECT_TYPE_TFILTER:
-		nlmsg = _nl_msg_new_tfilter (RTM_DELTFILTER, 0, NMP_OBJECT_CAST_TFILTER (obj));
-		break;
+		return _nl_msg_new_tfilter (RTM_DELTFILTER, 0, NMP_OBJECT_CAST_TFILTER (obj));
 	default:
-		break;
+		return NULL;
 	}
+}
+
+static gboolean
+object_delete (NMPlatform *platform,
+               const NMPObject *obj)
+{
+	nm_auto_nmpobj const NMPObject *obj_keep_alive = NULL;
+	nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
+
+	if (!NMP_OBJECT_IS_STACKINIT (obj))
+		obj_keep_alive = nmp_object_ref (obj);
 
+	nlmsg = _nl_msg_new_delete (obj);
 	if (!nlmsg)
 		g_return_val_if_reached (FALSE);
 	return do_delete_object (platform, obj, nlmsg);
 }
 
+static void
+object_delete_many (NMPlatform *platform,
+                    const NMPObject *const*objs,
+                    guint len,
+                    gboolean *out_results)
+{
+	gs_free const NMPObject **objs_keep_alive = NULL;
+	gs_free struct nl_msg **nlmsgs = NULL;
+	guint i;
+
+	objs_keep_alive = g_new0 (const NMPObject *, len);
+	nlmsgs = g_new0 (struct nl_msg *, len);
+
+	for (i = 0; i < len; i++) {
+		if (!NMP_OBJECT_IS_STACKINIT (objs[i]))
+			objs_keep_alive[i] = nmp_object_ref (objs[i]);
+
+		nlmsgs[i] = _nl_msg_new_delete (objs[i]);
+		if (!nlmsgs[i]) {
+			for (i = 0; i < len; i++)
+				out_results[i] = FALSE;
+			g_warn_if_reached ();
+			goto out;
+		}
+	}
+
+	do_delete_object_many (platform, objs, nlmsgs, len, out_results);
+
+out:
+	for (i = 0; i < len; i++) {
+		nlmsg_free (nlmsgs[i]);
+		nmp_object_unref (objs_keep_alive[i]);
+	}
+}
+
 /*****************************************************************************/
 
 static int
@@ -8549,93 +10596,514 @@ qdisc_add (NMPlatform *platform,
 	/* Note: @qdisc must not be copied or kept alive because the lifetime of qdisc.kind
 	 * is undefined. */
 
-	msg = _nl_msg_new_qdisc (RTM_NEWQDISC, flags, qdisc);
+	msg = _nl_msg_new_qdisc (RTM_NEWQDISC, flags, qdisc);
+
+	event_handler_read_netlink (platform, FALSE);
+
+	nle = _nl_send_nlmsg (platform, msg, &seq_result, &errmsg, DELAYED_ACTION_RESPONSE_TYPE_VOID, NULL);
+	if (nle < 0) {
+		_LOGE ("do-add-qdisc: failed sending netlink request \"%s\" (%d)",
+		      nm_strerror (nle), -nle);
+		return -NME_PL_NETLINK;
+	}
+
+	delayed_action_handle_all (platform, FALSE);
+
+	nm_assert (seq_result);
+
+	_NMLOG (seq_result == WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK
+	            ? LOGL_DEBUG
+	            : LOGL_WARN,
+	        "do-add-qdisc: %s",
+	        wait_for_nl_response_to_string (seq_result, errmsg, s_buf, sizeof (s_buf)));
+
+	if (seq_result == WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK)
+		return 0;
+	if (seq_result < 0)
+		return seq_result;
+	return -NME_UNSPEC;
+}
+
+/*****************************************************************************/
+
+static int
+tfilter_add (NMPlatform *platform,
+             NMPNlmFlags flags,
+             const NMPlatformTfilter *tfilter)
+{
+	WaitForNlResponseResult seq_result = WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN;
+	gs_free char *errmsg = NULL;
+	int nle;
+	char s_buf[256];
+	nm_auto_nlmsg struct nl_msg *msg = NULL;
+
+	/* Note: @tfilter must not be copied or kept alive because the lifetime of tfilter.kind
+	 * and tfilter.action.kind is undefined. */
+
+	msg = _nl_msg_new_tfilter (RTM_NEWTFILTER, flags, tfilter);
+
+	event_handler_read_netlink (platform, FALSE);
+
+	nle = _nl_send_nlmsg (platform, msg, &seq_result, &errmsg, DELAYED_ACTION_RESPONSE_TYPE_VOID, NULL);
+	if (nle < 0) {
+		_LOGE ("do-add-tfilter: failed sending netlink request \"%s\" (%d)",
+		      nm_strerror (nle), -nle);
+		return -NME_PL_NETLINK;
+	}
+
+	delayed_action_handle_all (platform, FALSE);
+
+	nm_assert (seq_result);
+
+	_NMLOG (seq_result == WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK
+	            ? LOGL_DEBUG
+	            : LOGL_WARN,
+	        "do-add-tfilter: %s",
+	        wait_for_nl_response_to_string (seq_result, errmsg, s_buf, sizeof (s_buf)));
+
+	if (seq_result == WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK)
+		return 0;
+
+	return -NME_UNSPEC;
+}
+
+static void
+_object_add_many (NMPlatform *platform,
+                  NMPNlmFlags flags,
+                  const NMPObject *const*objs,
+                  guint len,
+                  int *out_results)
+{
+	gs_free WaitForNlResponseResult *seq_results = NULL;
+	gs_free char **errmsgs = NULL;
+	gs_free struct nl_msg **nlmsgs = NULL;
+	char s_buf[256];
+	guint i;
+
+	/* Note: the objects must not be kept alive, because the lifetime of
+	 * the kind strings of qdiscs and tfilters is undefined. */
+
+	nlmsgs = g_new0 (struct nl_msg *, len);
+
+	for (i = 0; i < len; i++) {
+		switch (NMP_OBJECT_GET_TYPE (objs[i])) {
+		case NMP_OBJECT_TYPE_QDISC:
+			nlmsgs[i] = _nl_msg_new_qdisc (RTM_NEWQDISC, flags & NMP_NLM_FLAG_FMASK, NMP_OBJECT_CAST_QDISC (objs[i]));
+			break;
+		case NMP_OBJECT_TYPE_TFILTER:
+			nlmsgs[i] = _nl_msg_new_tfilter (RTM_NEWTFILTER, flags & NMP_NLM_FLAG_FMASK, NMP_OBJECT_CAST_TFILTER (objs[i]));
+			break;
+		case NMP_OBJECT_TYPE_ROUTING_RULE:
+			nlmsgs[i] = _nl_msg_new_routing_rule (RTM_NEWRULE, flags, NMP_OBJECT_CAST_ROUTING_RULE (objs[i]));
+			break;
+		default:
+			break;
+		}
+		if (!nlmsgs[i]) {
+			for (i = 0; i < len; i++)
+				out_results[i] = -NME_BUG;
+			g_warn_if_reached ();
+			goto out;
+		}
+	}
+
+	seq_results = g_new0 (WaitForNlResponseResult, len);
+	errmsgs = g_new0 (char *, len);
+
+	do_request_many (platform, "add", objs, nlmsgs, len, seq_results, errmsgs);
+
+	for (i = 0; i < len; i++) {
+		if (seq_results[i] == WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN) {
+			/* sending the request failed. Already logged. */
+			out_results[i] = -NME_PL_NETLINK;
+			continue;
+		}
+
+		_NMLOG (seq_results[i] == WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK
+		            ? LOGL_DEBUG
+		            : LOGL_WARN,
+		        "do-add-%s[%s]: %s",
+		        NMP_OBJECT_GET_CLASS (objs[i])->obj_type_name,
+		        nmp_object_to_string (objs[i], NMP_OBJECT_TO_STRING_ID, NULL, 0),
+		        wait_for_nl_response_to_string (seq_results[i], errmsgs[i], s_buf, sizeof (s_buf)));
+
+		out_results[i] = wait_for_nl_response_to_nmerr (seq_results[i]);
+		g_free (errmsgs[i]);
+	}
+
+out:
+	for (i = 0; i < len; i++)
+		nlmsg_free (nlmsgs[i]);
+}
+
+static void
+tc_add_many (NMPlatform *platform,
+             NMPNlmFlags flags,
+             const NMPObject *const*objs,
+             guint len,
+             int *out_results)
+{
+	_object_add_many (platform, flags, objs, len, out_results);
+}
+
+static void
+routing_rule_add_many (NMPlatform *platform,
+                       NMPNlmFlags flags,
+                       const NMPObject *const*objs,
+                       guint len,
+                       int *out_results)
+{
+	_object_add_many (platform, flags, objs, len, out_results);
+}
+
+/*****************************************************************************/
+
+static gboolean
+event_handler (int fd,
+               GIOCondition io_condition,
+               gpointer user_data)
+{
+	delayed_action_handle_all (NM_PLATFORM (user_data), TRUE);
+	return TRUE;
+}
+
+/*****************************************************************************/
+
+/* how many received datagrams may be queued for the main context, before
+ * the worker stops reading. Then the socket buffer fills up as it would
+ * without worker. */
+#define NL_WORKER_QUEUE_MAX 1024
+
+typedef struct {
+	/* the message, as parsed by the worker. Only valid if @parsed is set. */
+	NMPObject *obj;
+	bool parsed:1;
+} NLWorkerMsg;
+
+typedef struct {
+	/* the result of the read. Either an error code or the length of @buf. */
+	int n;
+	unsigned char *buf;
+	struct sockaddr_nl nla;
+	struct ucred creds;
+	bool creds_has:1;
+	guint n_msgs;
+	NLWorkerMsg msgs[];
+} NLWorkerDatagram;
+
+struct _NLWorker {
+	GThread *thread;
+
+	/* the event socket. Owned by the platform, only the worker reads from it. */
+	struct nl_sock *sk;
+	NLRecvBatch *batch;
+
+	/* readable while there are datagrams in @queue. The main context polls it. */
+	int fd_wakeup;
+	int fd_stop;
+
+	GMutex lock;
+	GCond cond;
+	GQueue queue;
+	bool stopping:1;
+
+	/* whether the worker read a datagram after it was asked to stop. That
+	 * datagram is lost and the cache needs a resync. */
+	bool lost_datagram:1;
+};
+
+static void
+_nl_worker_datagram_free (NLWorkerDatagram *dgram)
+{
+	guint i;
+
+	for (i = 0; i < dgram->n_msgs; i++)
+		nmp_object_unref (dgram->msgs[i].obj);
+	g_free (dgram->buf);
+	g_free (dgram);
+}
+
+NM_AUTO_DEFINE_FCN0 (NLWorkerDatagram *, _nm_auto_free_nl_worker_datagram, _nl_worker_datagram_free);
+#define nm_auto_free_nl_worker_datagram nm_auto(_nm_auto_free_nl_worker_datagram)
+
+/* Runs on the worker thread. Only types that don't need the platform
+ * or the cache to be parsed are handled here. Links and qdiscs are
+ * left to the main context. */
+static gboolean
+_nl_worker_parse_msg (struct nlmsghdr *hdr, NMPObject **out_obj)
+{
+	switch (hdr->nlmsg_type) {
+	case RTM_NEWADDR:
+	case RTM_DELADDR:
+		*out_obj = _new_from_nl_addr (hdr, hdr->nlmsg_type == RTM_DELADDR);
+		return TRUE;
+	case RTM_NEWROUTE:
+	case RTM_DELROUTE:
+		*out_obj = _new_from_nl_route (hdr, hdr->nlmsg_type == RTM_DELROUTE);
+		return TRUE;
+	case RTM_NEWRULE:
+	case RTM_DELRULE:
+		*out_obj = _new_from_nl_routing_rule (hdr, hdr->nlmsg_type == RTM_DELRULE);
+		return TRUE;
+	case RTM_NEWTFILTER:
+	case RTM_DELTFILTER:
+		*out_obj = _new_from_nl_tfilter (hdr, hdr->nlmsg_type == RTM_DELTFILTER);
+		return TRUE;
+	default:
+		return FALSE;
+	}
+}
+
+static NLWorkerDatagram *
+_nl_worker_datagram_new (int n,
+                         const unsigned char *buf,
+                         const struct sockaddr_nl *nla,
+                         const struct ucred *creds,
+                         gboolean creds_has)
+{
+	NLWorkerDatagram *dgram;
+	struct nlmsghdr *hdr;
+	guint n_msgs = 0;
+	guint i;
+	int remaining;
+
+	if (n > 0) {
+		remaining = n;
+		for (hdr = (struct nlmsghdr *) buf; nlmsg_ok (hdr, remaining); hdr = nlmsg_next (hdr, &remaining))
+			n_msgs++;
+	}
+
+	dgram = g_malloc0 (sizeof (NLWorkerDatagram) + n_msgs * sizeof (NLWorkerMsg));
+	dgram->n = n;
+	dgram->n_msgs = n_msgs;
+	if (n <= 0)
+		return dgram;
+
+	dgram->buf = g_memdup (buf, n);
+	dgram->nla = *nla;
+	dgram->creds_has = creds_has;
+	if (creds_has)
+		dgram->creds = *creds;
+
+	if (!creds_has || creds->pid) {
+		/* the main context will drop it. */
+		return dgram;
+	}
+
+	remaining = n;
+	hdr = (struct nlmsghdr *) dgram->buf;
+	for (i = 0; i < n_msgs; i++) {
+		dgram->msgs[i].parsed = _nl_worker_parse_msg (hdr, &dgram->msgs[i].obj);
+		hdr = nlmsg_next (hdr, &remaining);
+	}
+
+	return dgram;
+}
+
+static void
+_nl_worker_eventfd_signal (int fd)
+{
+	static const guint64 one = 1;
+
+	/* the counter cannot overflow, so this doesn't fail. */
+	if (write (fd, &one, sizeof (one)) != sizeof (one))
+		nm_assert_not_reached ();
+}
+
+static void
+_nl_worker_eventfd_clear (int fd)
+{
+	guint64 val;
+
+	if (read (fd, &val, sizeof (val)) < 0)
+		nm_assert (errno == EAGAIN);
+}
 
-	event_handler_read_netlink (platform, FALSE);
+/* takes ownership of @dgram. */
+static gboolean
+_nl_worker_push (NLWorker *worker, NLWorkerDatagram *dgram)
+{
+	g_mutex_lock (&worker->lock);
+	while (   worker->queue.length >= NL_WORKER_QUEUE_MAX
+	       && !worker->stopping)
+		g_cond_wait (&worker->cond, &worker->lock);
 
-	nle = _nl_send_nlmsg (platform, msg, &seq_result, &errmsg, DELAYED_ACTION_RESPONSE_TYPE_VOID, NULL);
-	if (nle < 0) {
-		_LOGE ("do-add-qdisc: failed sending netlink request \"%s\" (%d)",
-		      nm_strerror (nle), -nle);
-		return -NME_PL_NETLINK;
+	if (worker->stopping) {
+		worker->lost_datagram = TRUE;
+		g_mutex_unlock (&worker->lock);
+		_nl_worker_datagram_free (dgram);
+		return FALSE;
 	}
 
-	delayed_action_handle_all (platform, FALSE);
-
-	nm_assert (seq_result);
+	g_queue_push_tail (&worker->queue, dgram);
+	if (worker->queue.length == 1) {
+		/* the main context clears the eventfd, when it finds the queue empty. */
+		_nl_worker_eventfd_signal (worker->fd_wakeup);
+	}
+	g_mutex_unlock (&worker->lock);
+	return TRUE;
+}
 
-	_NMLOG (seq_result == WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK
-	            ? LOGL_DEBUG
-	            : LOGL_WARN,
-	        "do-add-qdisc: %s",
-	        wait_for_nl_response_to_string (seq_result, errmsg, s_buf, sizeof (s_buf)));
+static NLWorkerDatagram *
+_nl_worker_pop (NLWorker *worker)
+{
+	NLWorkerDatagram *dgram;
 
-	if (seq_result == WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK)
-		return 0;
-	if (seq_result < 0)
-		return seq_result;
-	return -NME_UNSPEC;
+	g_mutex_lock (&worker->lock);
+	dgram = g_queue_pop_head (&worker->queue);
+	if (!dgram)
+		_nl_worker_eventfd_clear (worker->fd_wakeup);
+	else if (worker->queue.length == NL_WORKER_QUEUE_MAX - 1)
+		g_cond_signal (&worker->cond);
+	g_mutex_unlock (&worker->lock);
+	return dgram;
 }
 
-/*****************************************************************************/
+static gboolean
+_nl_worker_read (NLWorker *worker)
+{
+	for (;;) {
+		struct sockaddr_nl nla;
+		struct ucred creds;
+		gboolean creds_has = FALSE;
+		unsigned char *buf = NULL;
+		int n;
+
+		n = nl_recv_batch_next (worker->sk, worker->batch, &nla, &buf, &creds, &creds_has);
+		if (n == -EAGAIN)
+			return TRUE;
 
-static int
-tfilter_add (NMPlatform *platform,
-             NMPNlmFlags flags,
-             const NMPlatformTfilter *tfilter)
+		if (n == -NME_NL_MSG_TRUNC) {
+			int buf_size;
+
+			/* like the main context does without worker, grow the buffer for the
+			 * next datagrams. The main context takes care of the resync. */
+			buf_size = nl_socket_get_msg_buf_size (worker->sk);
+			if (buf_size < 512*1024) {
+				if (nl_socket_set_msg_buf_size (worker->sk, buf_size * 2) < 0)
+					nm_assert_not_reached ();
+			}
+		}
+
+		if (!_nl_worker_push (worker,
+		                      _nl_worker_datagram_new (n, buf, &nla, &creds, creds_has)))
+			return FALSE;
+	}
+}
+
+static gpointer
+_nl_worker_thread (gpointer user_data)
 {
-	WaitForNlResponseResult seq_result = WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN;
-	gs_free char *errmsg = NULL;
-	int nle;
-	char s_buf[256];
-	nm_auto_nlmsg struct nl_msg *msg = NULL;
+	NLWorker *worker = user_data;
+	struct pollfd pfds[2];
 
-	/* Note: @tfilter must not be copied or kept alive because the lifetime of tfilter.kind
-	 * and tfilter.action.kind is undefined. */
+	for (;;) {
+		memset (pfds, 0, sizeof (pfds));
+		pfds[0].fd = nl_socket_get_fd (worker->sk);
+		pfds[0].events = POLLIN;
+		pfds[1].fd = worker->fd_stop;
+		pfds[1].events = POLLIN;
+
+		if (poll (pfds, G_N_ELEMENTS (pfds), -1) < 0) {
+			if (errno == EINTR)
+				continue;
+			break;
+		}
 
-	msg = _nl_msg_new_tfilter (RTM_NEWTFILTER, flags, tfilter);
+		if (pfds[1].revents)
+			break;
 
-	event_handler_read_netlink (platform, FALSE);
+		if (!_nl_worker_read (worker))
+			break;
+	}
 
-	nle = _nl_send_nlmsg (platform, msg, &seq_result, &errmsg, DELAYED_ACTION_RESPONSE_TYPE_VOID, NULL);
-	if (nle < 0) {
-		_LOGE ("do-add-tfilter: failed sending netlink request \"%s\" (%d)",
-		      nm_strerror (nle), -nle);
-		return -NME_PL_NETLINK;
+	return NULL;
+}
+
+static NLWorker *
+_nl_worker_new (struct nl_sock *sk, int *out_errno)
+{
+	NLWorker *worker;
+
+	worker = g_slice_new0 (NLWorker);
+	worker->sk = sk;
+	worker->fd_wakeup = -1;
+	worker->fd_stop = -1;
+	g_mutex_init (&worker->lock);
+	g_cond_init (&worker->cond);
+	g_queue_init (&worker->queue);
+
+	worker->fd_wakeup = eventfd (0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (worker->fd_wakeup >= 0)
+		worker->fd_stop = eventfd (0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (worker->fd_stop < 0) {
+		*out_errno = errno;
+		if (worker->fd_wakeup >= 0)
+			nm_close (worker->fd_wakeup);
+		g_mutex_clear (&worker->lock);
+		g_cond_clear (&worker->cond);
+		g_slice_free (NLWorker, worker);
+		return NULL;
 	}
 
-	delayed_action_handle_all (platform, FALSE);
+	worker->batch = nl_recv_batch_new (8);
+	worker->thread = g_thread_new ("nm-platform-nl", _nl_worker_thread, worker);
+	return worker;
+}
 
-	nm_assert (seq_result);
+/* stops the thread. Datagrams that are still queued can be popped
+ * afterwards, until _nl_worker_free(). Check _nl_worker_needs_resync()
+ * after that. */
+static void
+_nl_worker_stop (NLWorker *worker)
+{
+	if (!worker->thread)
+		return;
 
-	_NMLOG (seq_result == WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK
-	            ? LOGL_DEBUG
-	            : LOGL_WARN,
-	        "do-add-tfilter: %s",
-	        wait_for_nl_response_to_string (seq_result, errmsg, s_buf, sizeof (s_buf)));
+	g_mutex_lock (&worker->lock);
+	worker->stopping = TRUE;
+	g_cond_signal (&worker->cond);
+	g_mutex_unlock (&worker->lock);
 
-	if (seq_result == WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK)
-		return 0;
+	_nl_worker_eventfd_signal (worker->fd_stop);
 
-	return -NME_UNSPEC;
+	g_thread_join (g_steal_pointer (&worker->thread));
 }
 
-/*****************************************************************************/
-
+/* whether events got lost when stopping the worker. Call after popping
+ * all datagrams. */
 static gboolean
-event_handler (int fd,
-               GIOCondition io_condition,
-               gpointer user_data)
+_nl_worker_needs_resync (NLWorker *worker)
 {
-	delayed_action_handle_all (NM_PLATFORM (user_data), TRUE);
-	return TRUE;
+	nm_assert (!worker->thread);
+
+	return    worker->lost_datagram
+	       || !g_queue_is_empty (&worker->queue);
+}
+
+/* drops the datagrams that are still queued. */
+static void
+_nl_worker_free (NLWorker *worker)
+{
+	NLWorkerDatagram *dgram;
+
+	_nl_worker_stop (worker);
+
+	while ((dgram = g_queue_pop_head (&worker->queue)))
+		_nl_worker_datagram_free (dgram);
+	nl_recv_batch_free (worker->batch);
+	nm_close (worker->fd_wakeup);
+	nm_close (worker->fd_stop);
+	g_mutex_clear (&worker->lock);
+	g_cond_clear (&worker->cond);
+	g_slice_free (NLWorker, worker);
 }
 
 /*****************************************************************************/
 
 /* copied from libnl3's recvmsgs() */
 static int
-event_handler_recvmsgs (NMPlatform *platform, gboolean handle_events)
+_event_handler_recvmsgs (NMPlatform *platform, gboolean handle_events)
 {
 	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
 	struct nl_sock *sk = priv->nlh;
@@ -8648,19 +11116,43 @@ event_handler_recvmsgs (NMPlatform *platform, gboolean handle_events)
 	struct sockaddr_nl nla = {0};
 	struct ucred creds;
 	gboolean creds_has;
-	nm_auto_free unsigned char *buf = NULL;
+	unsigned char *buf;
+	nm_auto_free unsigned char *buf_alloc = NULL;
+	nm_auto_free_nl_worker_datagram NLWorkerDatagram *dgram = NULL;
+	guint msg_idx;
 
 continue_reading:
-	nm_clear_pointer (&buf, free);
-	n = nl_recv (sk, &nla, &buf, &creds, &creds_has);
+	nm_clear_pointer (&buf_alloc, free);
+	nm_clear_pointer (&dgram, _nl_worker_datagram_free);
+	buf = NULL;
+	if (priv->nl_worker) {
+		/* the worker thread reads the socket. Take the next datagram in order. */
+		dgram = _nl_worker_pop (priv->nl_worker);
+		if (!dgram)
+			return -EAGAIN;
+		n = dgram->n;
+		buf = dgram->buf;
+		nla = dgram->nla;
+		creds = dgram->creds;
+		creds_has = dgram->creds_has;
+	} else if (   priv->nlh_recv_batch_nesting > 1
+	           && !nl_recv_batch_has_pending (priv->nlh_recv_batch)) {
+		/* we are called recursively, while the outer call is still parsing
+		 * a datagram from the batch buffer. Don't overwrite it. */
+		n = nl_recv (sk, &nla, &buf_alloc, &creds, &creds_has);
+		buf = buf_alloc;
+	} else
+		n = nl_recv_batch_next (sk, priv->nlh_recv_batch, &nla, &buf, &creds, &creds_has);
 
 	if (n <= 0) {
 
-		if (n == -NME_NL_MSG_TRUNC) {
+		if (   n == -NME_NL_MSG_TRUNC
+		    && !priv->nl_worker) {
 			int buf_size;
 
 			/* the message receive buffer was too small. We lost one message, which
-			 * is unfortunate. Try to double the buffer size for the next time. */
+			 * is unfortunate. Try to double the buffer size for the next time.
+			 * With the worker, the thread already did that. */
 			buf_size = nl_socket_get_msg_buf_size (sk);
 			if (buf_size < 512*1024) {
 				buf_size *= 2;
@@ -8676,6 +11168,7 @@ continue_reading:
 	}
 
 	hdr = (struct nlmsghdr *) buf;
+	msg_idx = 0;
 	while (nlmsg_ok (hdr, n)) {
 		nm_auto_nlmsg struct nl_msg *msg = NULL;
 		gboolean abort_parsing = FALSE;
@@ -8684,7 +11177,8 @@ continue_reading:
 		char buf_nlmsghdr[400];
 		const char *extack_msg = NULL;
 
-		msg = nlmsg_alloc_convert (hdr);
+		/* the message is parsed in place. @buf stays valid until the next read. */
+		msg = nlmsg_alloc_inplace (hdr);
 
 		nlmsg_set_proto (msg, NETLINK_ROUTE);
 		nlmsg_set_src (msg, &nla);
@@ -8801,7 +11295,11 @@ continue_reading:
 			 * get along with broken kernels. NL_SKIP has no
 			 * effect on this.  */
 
-			event_valid_msg (platform, msg, handle_events);
+			if (   dgram
+			    && dgram->msgs[msg_idx].parsed)
+				event_valid_msg (platform, msg, &dgram->msgs[msg_idx].obj, handle_events);
+			else
+				event_valid_msg (platform, msg, NULL, handle_events);
 
 			seq_result = WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK;
 		}
@@ -8813,6 +11311,7 @@ continue_reading:
 
 		err = 0;
 		hdr = nlmsg_next (hdr, &n);
+		msg_idx++;
 	}
 
 	if (multipart) {
@@ -8832,8 +11331,220 @@ stop:
 	return err;
 }
 
+static int
+event_handler_recvmsgs (NMPlatform *platform, gboolean handle_events)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	int r;
+
+	priv->nlh_recv_batch_nesting++;
+	r = _event_handler_recvmsgs (platform, handle_events);
+	priv->nlh_recv_batch_nesting--;
+	return r;
+}
+
 /*****************************************************************************/
 
+#define NL_EVENT_RCVBUF_SIZE_INITIAL          (8 * 1024 * 1024)
+#define NL_EVENT_RCVBUF_SIZE_MAX_DEFAULT      (64 * 1024 * 1024)
+#define NL_EVENT_RESYNC_DEFERRED_MSEC         1000
+#define NL_EVENT_RESYNC_DEFERRED_MAX_MSEC     10000
+
+static void
+_nl_event_rcvbuf_set (NMPlatform *platform, int rcvbuf_size)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	int actual = -1;
+	int nle;
+
+	nle = nl_socket_set_rcvbuf_size (priv->nlh, rcvbuf_size, TRUE, &actual);
+	if (nle < 0) {
+		_LOGW ("netlink: failed to set receive buffer size to %d bytes: %s",
+		       rcvbuf_size, nm_strerror (nle));
+		return;
+	}
+
+	priv->nl_event.rcvbuf_size = rcvbuf_size;
+	_LOGD ("netlink: receive buffer size set to %d bytes (kernel reports %d)",
+	       rcvbuf_size, actual);
+}
+
+static void
+_nl_event_rcvbuf_grow (NMPlatform *platform)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	int rcvbuf_size;
+
+	if (priv->nl_event.rcvbuf_size >= priv->nl_event.rcvbuf_max)
+		return;
+
+	if (priv->nl_event.rcvbuf_size > priv->nl_event.rcvbuf_max / 2)
+		rcvbuf_size = priv->nl_event.rcvbuf_max;
+	else
+		rcvbuf_size = priv->nl_event.rcvbuf_size * 2;
+
+	_nl_event_rcvbuf_set (platform, rcvbuf_size);
+}
+
+static void
+_nl_event_resync_now (NMPlatform *platform, DelayedActionType action_type)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	DelayedActionType iflags;
+
+	nm_assert (action_type != DELAYED_ACTION_TYPE_NONE);
+	nm_assert (!NM_FLAGS_ANY (action_type, ~DELAYED_ACTION_TYPE_REFRESH_ALL));
+
+	FOR_EACH_DELAYED_ACTION (iflags, action_type)
+		priv->nl_event.n_resyncs[delayed_action_type_to_refresh_all_type (iflags)]++;
+
+	priv->nl_event.resync_deferred &= ~action_type;
+	if (priv->nl_event.resync_deferred == DELAYED_ACTION_TYPE_NONE)
+		nm_clear_g_source (&priv->nl_event.resync_deferred_id);
+
+	delayed_action_schedule (platform, action_type, NULL);
+}
+
+static gboolean
+_nl_event_resync_deferred_cb (gpointer user_data)
+{
+	NMPlatform *platform = user_data;
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	DelayedActionType action_type;
+
+	priv->nl_event.resync_deferred_id = 0;
+
+	action_type = priv->nl_event.resync_deferred;
+	if (action_type == DELAYED_ACTION_TYPE_NONE)
+		return G_SOURCE_REMOVE;
+
+	_LOGD ("netlink: resynchronize deferred types of the platform cache");
+	_nl_event_resync_now (platform, action_type);
+	delayed_action_handle_all (platform, FALSE);
+	return G_SOURCE_REMOVE;
+}
+
+static void
+_nl_event_resync (NMPlatform *platform, gboolean overflow)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	DelayedActionType action_type = DELAYED_ACTION_TYPE_REFRESH_ALL;
+	DelayedActionType iflags;
+	gint64 now_msec;
+
+	if (overflow) {
+		priv->nl_event.n_overflows++;
+		_nl_event_rcvbuf_grow (platform);
+
+		/* we might have missed RTM_NEWNETCONF notifications. */
+		_sysctl_cache_flush (platform, AF_UNSPEC, NULL);
+	}
+
+	if (   overflow
+	    && priv->nl_event.resync_affected_only) {
+		/* we cannot know which events were lost. Most likely they are of the
+		 * types that were busy, so resync these right away. Also, the dumps
+		 * that were in progress lost messages. The remaining types get resynced
+		 * after the storm settles, so that we don't feed it with more dumps. */
+		action_type = priv->nl_event.types_seen;
+		FOR_EACH_DELAYED_ACTION (iflags, DELAYED_ACTION_TYPE_REFRESH_ALL) {
+			if (delayed_action_refresh_all_in_progress (platform, iflags))
+				action_type |= iflags;
+		}
+		action_type &= DELAYED_ACTION_TYPE_REFRESH_ALL;
+		if (action_type == DELAYED_ACTION_TYPE_NONE)
+			action_type = DELAYED_ACTION_TYPE_REFRESH_ALL;
+	}
+
+	priv->nl_event.types_seen = DELAYED_ACTION_TYPE_NONE;
+
+	if (action_type != DELAYED_ACTION_TYPE_REFRESH_ALL) {
+		now_msec = nm_utils_get_monotonic_timestamp_msec ();
+		if (priv->nl_event.resync_deferred == DELAYED_ACTION_TYPE_NONE)
+			priv->nl_event.resync_deferred_since_msec = now_msec;
+		priv->nl_event.resync_deferred |= (DELAYED_ACTION_TYPE_REFRESH_ALL & ~action_type);
+
+		/* postpone the deferred resync while overflows keep coming, but
+		 * not indefinitely. */
+		if (   !priv->nl_event.resync_deferred_id
+		    || now_msec - priv->nl_event.resync_deferred_since_msec < NL_EVENT_RESYNC_DEFERRED_MAX_MSEC) {
+			nm_clear_g_source (&priv->nl_event.resync_deferred_id);
+			priv->nl_event.resync_deferred_id = g_timeout_add (NL_EVENT_RESYNC_DEFERRED_MSEC,
+			                                                   _nl_event_resync_deferred_cb,
+			                                                   platform);
+		}
+	}
+
+	_nl_event_resync_now (platform, action_type);
+
+	_LOGD ("netlink: resynchronize platform cache (overflows %u, resyncs of links %u, ip4-routes %u, ip6-routes %u, deferred 0x%x)",
+	       priv->nl_event.n_overflows,
+	       priv->nl_event.n_resyncs[REFRESH_ALL_TYPE_LINKS],
+	       priv->nl_event.n_resyncs[REFRESH_ALL_TYPE_IP4_ROUTES],
+	       priv->nl_event.n_resyncs[REFRESH_ALL_TYPE_IP6_ROUTES],
+	       (guint) priv->nl_event.resync_deferred);
+}
+
+static void
+netlink_config_set (NMPlatform *platform,
+                    guint rcvbuf_max,
+                    gboolean resync_affected_only)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+
+	if (rcvbuf_max == 0)
+		rcvbuf_max = NL_EVENT_RCVBUF_SIZE_MAX_DEFAULT;
+	rcvbuf_max = NM_MIN (rcvbuf_max, (guint) G_MAXINT);
+
+	priv->nl_event.rcvbuf_max = NM_MAX ((int) rcvbuf_max, NL_EVENT_RCVBUF_SIZE_INITIAL);
+	priv->nl_event.resync_affected_only = resync_affected_only;
+
+	if (priv->nl_event.rcvbuf_size > priv->nl_event.rcvbuf_max)
+		_nl_event_rcvbuf_set (platform, priv->nl_event.rcvbuf_max);
+
+	if (   !resync_affected_only
+	    && priv->nl_event.resync_deferred != DELAYED_ACTION_TYPE_NONE)
+		_nl_event_resync_now (platform, priv->nl_event.resync_deferred);
+}
+
+void
+_nmtst_linux_platform_nl_event_overflow (NMPlatform *platform, guint16 nlmsg_type_seen)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+
+	/* pretend that since the last resync, we only received events of
+	 * @nlmsg_type_seen, and then lost some. */
+	priv->nl_event.types_seen = _event_refresh_types_from_nlmsg_type (nlmsg_type_seen);
+	delayed_action_wait_for_nl_response_complete_all (platform,
+	                                                  WAIT_FOR_NL_RESPONSE_RESULT_FAILED_RESYNC);
+	_nl_event_resync (platform, TRUE);
+}
+
+void
+_nmtst_linux_platform_nl_event_get_stats (NMPlatform *platform,
+                                          guint *out_n_overflows,
+                                          int *out_rcvbuf_size)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+
+	NM_SET_OUT (out_n_overflows, priv->nl_event.n_overflows);
+	NM_SET_OUT (out_rcvbuf_size, priv->nl_event.rcvbuf_size);
+}
+
+guint
+_nmtst_linux_platform_nl_event_get_n_resyncs (NMPlatform *platform, NMPObjectType obj_type)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	RefreshAllType refresh_all_type;
+	guint n = 0;
+
+	for (refresh_all_type = _REFRESH_ALL_TYPE_FIRST; refresh_all_type < _REFRESH_ALL_TYPE_NUM; refresh_all_type++) {
+		if (refresh_all_type_get_info (refresh_all_type)->obj_type == obj_type)
+			n += priv->nl_event.n_resyncs[refresh_all_type];
+	}
+	return n;
+}
+
 static gboolean
 event_handler_read_netlink (NMPlatform *platform, gboolean wait_for_acks)
 {
@@ -8883,16 +11594,7 @@ event_handler_read_netlink (NMPlatform *platform, gboolean wait_for_acks)
 					delayed_action_wait_for_nl_response_complete_all (platform,
 					                                                  WAIT_FOR_NL_RESPONSE_RESULT_FAILED_RESYNC);
 
-					delayed_action_schedule (platform,
-					                         DELAYED_ACTION_TYPE_REFRESH_ALL_LINKS |
-					                         DELAYED_ACTION_TYPE_REFRESH_ALL_IP4_ADDRESSES |
-					                         DELAYED_ACTION_TYPE_REFRESH_ALL_IP6_ADDRESSES |
-					                         DELAYED_ACTION_TYPE_REFRESH_ALL_IP4_ROUTES |
-					                         DELAYED_ACTION_TYPE_REFRESH_ALL_IP6_ROUTES |
-					                         DELAYED_ACTION_TYPE_REFRESH_ALL_ROUTING_RULES_ALL |
-					                         DELAYED_ACTION_TYPE_REFRESH_ALL_QDISCS |
-					                         DELAYED_ACTION_TYPE_REFRESH_ALL_TFILTERS,
-					                         NULL);
+					_nl_event_resync (platform, nle == -ENOBUFS);
 					break;
 				default:
 					_LOGE ("netlink: read: failed to retrieve incoming events: %s (%d)", nm_strerror (nle), nle);
@@ -8926,7 +11628,9 @@ after_read:
 		timeout_msec = (next.timeout_abs_ns - next.now_ns) / (NM_UTILS_NSEC_PER_SEC / 1000);
 
 		memset (&pfd, 0, sizeof (pfd));
-		pfd.fd = nl_socket_get_fd (priv->nlh);
+		pfd.fd =   priv->nl_worker
+		         ? priv->nl_worker->fd_wakeup
+		         : nl_socket_get_fd (priv->nlh);
 		pfd.events = POLLIN;
 		r = poll (&pfd, 1, MAX (1, timeout_msec));
 
@@ -8950,6 +11654,68 @@ after_read:
 
 /*****************************************************************************/
 
+static void
+_event_source_attach (NMPlatform *platform, int fd)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+
+	nm_clear_g_source_inst (&priv->event_source);
+	priv->event_source = nm_g_unix_fd_source_new (fd,
+	                                              G_IO_IN | G_IO_NVAL | G_IO_PRI | G_IO_ERR | G_IO_HUP,
+	                                              G_PRIORITY_DEFAULT,
+	                                              event_handler,
+	                                              platform,
+	                                              NULL);
+	g_source_attach (priv->event_source, NULL);
+}
+
+static void
+netlink_worker_set (NMPlatform *platform, gboolean enabled)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	gboolean need_resync;
+	int errsv;
+
+	if (enabled == !!priv->nl_worker)
+		return;
+
+	/* while a datagram is being parsed, we cannot hand over the socket. */
+	g_return_if_fail (priv->nlh_recv_batch_nesting == 0);
+
+	if (enabled) {
+		/* first process what is already received, so that the worker
+		 * continues with the next datagram on the socket. */
+		event_handler_read_netlink (platform, FALSE);
+		nm_assert (!nl_recv_batch_has_pending (priv->nlh_recv_batch));
+
+		priv->nl_worker = _nl_worker_new (priv->nlh, &errsv);
+		if (!priv->nl_worker) {
+			_LOGW ("netlink: failed to start worker thread: %s", nm_strerror_native (errsv));
+			return;
+		}
+		_event_source_attach (platform, priv->nl_worker->fd_wakeup);
+		_LOGD ("netlink: read and parse events on a worker thread");
+		return;
+	}
+
+	/* the datagrams that the worker already read, come before what is
+	 * still in the socket. */
+	_nl_worker_stop (priv->nl_worker);
+	event_handler_read_netlink (platform, FALSE);
+	need_resync = _nl_worker_needs_resync (priv->nl_worker);
+	nm_clear_pointer (&priv->nl_worker, _nl_worker_free);
+	_event_source_attach (platform, nl_socket_get_fd (priv->nlh));
+	_LOGD ("netlink: read and parse events on the main thread");
+
+	if (need_resync) {
+		_LOGD ("netlink: events got lost while stopping the worker. Need to resynchronize platform cache");
+		_nl_event_resync (platform, FALSE);
+		delayed_action_handle_all (platform, FALSE);
+	}
+}
+
+/*****************************************************************************/
+
 static void
 cache_update_link_udev (NMPlatform *platform,
                         int ifindex,
@@ -9087,6 +11853,12 @@ nm_linux_platform_init (NMLinuxPlatform *self)
 	priv->delayed_action.list_master_connected = g_ptr_array_new ();
 	priv->delayed_action.list_refresh_link = g_ptr_array_new ();
 	priv->delayed_action.list_wait_for_nl_response = g_array_new (FALSE, TRUE, sizeof (DelayedActionWaitForNlResponseData));
+
+	priv->nl_event.rcvbuf_max = NL_EVENT_RCVBUF_SIZE_MAX_DEFAULT;
+
+	g_mutex_init (&priv->sysctl_batch.lock);
+	g_cond_init (&priv->sysctl_batch.cond);
+	g_queue_init (&priv->sysctl_batch.queued);
 }
 
 static void
@@ -9139,20 +11911,33 @@ constructed (GObject *_object)
 	nle = nl_socket_set_nonblocking (priv->nlh);
 	g_assert (!nle);
 
-	/* use 8 MB for receive socket kernel queue. */
-	nle = nl_socket_set_buffer_size (priv->nlh, 8*1024*1024, 0);
+	nle = nl_socket_set_buffer_size (priv->nlh, 0, 0);
 	g_assert (!nle);
 
+	/* use 8 MB for receive socket kernel queue. If we are privileged, this
+	 * is not capped by net.core.rmem_max. On overflow, it grows. */
+	_nl_event_rcvbuf_set (platform, NL_EVENT_RCVBUF_SIZE_INITIAL);
+
 	nle = nl_socket_set_ext_ack (priv->nlh, TRUE);
 	if (nle)
 		_LOGD ("could not enable extended acks on netlink socket");
 
+	nle = nl_socket_set_strict_check (priv->nlh, TRUE);
+	if (nle)
+		_LOGD ("could not enable strict checking of dump requests on netlink socket");
+	else
+		priv->nlh_strict_check = TRUE;
+
 	/* explicitly set the msg buffer size and disable MSG_PEEK.
 	 * If we later encounter NME_NL_MSG_TRUNC, we will adjust the buffer size. */
 	nl_socket_disable_msg_peek (priv->nlh);
 	nle = nl_socket_set_msg_buf_size (priv->nlh, 32 * 1024);
 	g_assert (!nle);
 
+	/* receive up to 8 datagrams per syscall. With the 32 KiB message buffer,
+	 * that's a 256 KiB receive area, which is reused for every read. */
+	priv->nlh_recv_batch = nl_recv_batch_new (8);
+
 	nle = nl_socket_add_memberships (priv->nlh,
 	                                 RTNLGRP_IPV4_IFADDR,
 	                                 RTNLGRP_IPV4_ROUTE,
@@ -9165,17 +11950,20 @@ constructed (GObject *_object)
 	                                 0);
 	g_assert (!nle);
 
+	nle = nl_socket_add_memberships (priv->nlh,
+	                                 RTNLGRP_IPV4_NETCONF,
+	                                 RTNLGRP_IPV6_NETCONF,
+	                                 0);
+	if (nle)
+		_LOGD ("could not subscribe to netconf notifications. Cached sysctl values expire quickly");
+	else
+		priv->sysctl_cache.netconf_subscribed = TRUE;
+
 	fd = nl_socket_get_fd (priv->nlh);
 
 	_LOGD ("Netlink socket for events established: port=%u, fd=%d", nl_socket_get_local_port (priv->nlh), fd);
 
-	priv->event_source = nm_g_unix_fd_source_new (fd,
-	                                              G_IO_IN | G_IO_NVAL | G_IO_PRI | G_IO_ERR | G_IO_HUP,
-	                                              G_PRIORITY_DEFAULT,
-	                                              event_handler,
-	                                              platform,
-	                                              NULL);
-	g_source_attach (priv->event_source, NULL);
+	_event_source_attach (platform, fd);
 
 	/* complete construction of the GObject instance before populating the cache. */
 	G_OBJECT_CLASS (nm_linux_platform_parent_class)->constructed (_object);
@@ -9254,6 +12042,9 @@ dispose (GObject *object)
 	g_ptr_array_set_size (priv->delayed_action.list_master_connected, 0);
 	g_ptr_array_set_size (priv->delayed_action.list_refresh_link, 0);
 
+	nm_clear_g_source (&priv->nl_event.resync_deferred_id);
+	priv->nl_event.resync_deferred = DELAYED_ACTION_TYPE_NONE;
+
 	G_OBJECT_CLASS (nm_linux_platform_parent_class)->dispose (object);
 }
 
@@ -9270,13 +12061,24 @@ finalize (GObject *object)
 
 	nm_clear_g_source_inst (&priv->event_source);
 
+	nm_clear_pointer (&priv->nl_worker, _nl_worker_free);
 	nl_socket_free (priv->nlh);
+	nl_recv_batch_free (priv->nlh_recv_batch);
 
 	if (priv->sysctl_get_prev_values) {
 		sysctl_clear_cache_list = g_slist_remove (sysctl_clear_cache_list, object);
 		g_hash_table_destroy (priv->sysctl_get_prev_values);
 	}
 
+	nm_clear_pointer (&priv->sysctl_cache.by_ifname, g_hash_table_destroy);
+
+	/* each job keeps the platform alive. */
+	nm_assert (!priv->sysctl_batch.in_flight);
+	nm_assert (g_queue_is_empty (&priv->sysctl_batch.queued));
+	nm_clear_pointer (&priv->sysctl_batch.pending, g_hash_table_unref);
+	g_mutex_clear (&priv->sysctl_batch.lock);
+	g_cond_clear (&priv->sysctl_batch.cond);
+
 	priv->udev_client = nm_udev_client_unref (priv->udev_client);
 
 	G_OBJECT_CLASS (nm_linux_platform_parent_class)->finalize (object);
@@ -9295,6 +12097,8 @@ nm_linux_platform_class_init (NMLinuxPlatformClass *klass)
 	platform_class->sysctl_set = sysctl_set;
 	platform_class->sysctl_set_async = sysctl_set_async;
 	platform_class->sysctl_get = sysctl_get;
+	platform_class->sysctl_cache_get_stats = sysctl_cache_get_stats;
+	platform_class->sysctl_batch_commit = sysctl_batch_commit;
 
 	platform_class->link_add = link_add;
 	platform_class->link_delete = link_delete;
@@ -9304,6 +12108,7 @@ nm_linux_platform_class_init (NMLinuxPlatformClass *klass)
 	platform_class->link_set_netns = link_set_netns;
 
 	platform_class->link_set_up = link_set_up;
+	platform_class->link_set_up_many = link_set_up_many;
 	platform_class->link_set_down = link_set_down;
 	platform_class->link_set_arp = link_set_arp;
 	platform_class->link_set_noarp = link_set_noarp;
@@ -9365,19 +12170,29 @@ nm_linux_platform_class_init (NMLinuxPlatformClass *klass)
 	platform_class->link_tun_add = link_tun_add;
 
 	platform_class->object_delete = object_delete;
+	platform_class->object_delete_many = object_delete_many;
 	platform_class->ip4_address_add = ip4_address_add;
 	platform_class->ip6_address_add = ip6_address_add;
 	platform_class->ip4_address_delete = ip4_address_delete;
 	platform_class->ip6_address_delete = ip6_address_delete;
+	platform_class->ip_address_add_many = ip_address_add_many;
+	platform_class->ip_address_delete_many = ip_address_delete_many;
 
 	platform_class->ip_route_add = ip_route_add;
+	platform_class->ip_route_add_many = ip_route_add_many;
 	platform_class->ip_route_get = ip_route_get;
 
 	platform_class->routing_rule_add = routing_rule_add;
+	platform_class->routing_rule_add_many = routing_rule_add_many;
 
 	platform_class->qdisc_add = qdisc_add;
 	platform_class->tfilter_add = tfilter_add;
+	platform_class->tc_add_many = tc_add_many;
 
 	platform_class->process_events = process_events;
+	platform_class->refresh_all = refresh_all;
+	platform_class->refresh_filtered = refresh_filtered;
+	platform_class->netlink_config_set = netlink_config_set;
+	platform_class->netlink_worker_set = netlink_worker_set;
 }
 
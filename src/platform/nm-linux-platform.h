@@ -24,4 +24,10 @@ NMPlatform *nm_linux_platform_new (gboolean log_with_ptr, gboolean netns_support
 
 void nm_linux_platform_setup (void);
 
+void _nmtst_linux_platform_nl_event_overflow (NMPlatform *platform, guint16 nlmsg_type_seen);
+void _nmtst_linux_platform_nl_event_get_stats (NMPlatform *platform,
+                                               guint *out_n_overflows,
+                                               int *out_rcvbuf_size);
+guint _nmtst_linux_platform_nl_event_get_n_resyncs (NMPlatform *platform, NMPObjectType obj_type);
+
 #endif /* __NETWORKMANAGER_LINUX_PLATFORM_H__ */
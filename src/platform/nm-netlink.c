@@ -27,6 +27,10 @@
 #define NETLINK_EXT_ACK         11
 #endif
 
+#ifndef NETLINK_GET_STRICT_CHK
+#define NETLINK_GET_STRICT_CHK  12
+#endif
+
 struct nl_msg {
 	int                     nm_protocol;
 	struct sockaddr_nl      nm_src;
@@ -35,6 +39,7 @@ struct nl_msg {
 	struct nlmsghdr *       nm_nlh;
 	size_t                  nm_size;
 	bool                    nm_creds_has:1;
+	bool                    nm_nlh_borrowed:1;
 };
 
 struct nl_sock {
@@ -290,6 +295,31 @@ nlmsg_alloc_convert (struct nlmsghdr *hdr)
 	return nm;
 }
 
+/**
+ * nlmsg_alloc_inplace:
+ * @hdr: the netlink message
+ *
+ * Like nlmsg_alloc_convert(), but the message is not copied. The
+ * returned message only references @hdr, which must stay valid for
+ * the lifetime of the message. The message cannot grow.
+ *
+ * Returns: the new message.
+ */
+struct nl_msg *
+nlmsg_alloc_inplace (struct nlmsghdr *hdr)
+{
+	struct nl_msg *nm;
+
+	nm = g_slice_new (struct nl_msg);
+	*nm = (struct nl_msg) {
+		.nm_protocol = -1,
+		.nm_size = hdr->nlmsg_len,
+		.nm_nlh = hdr,
+		.nm_nlh_borrowed = TRUE,
+	};
+	return nm;
+}
+
 struct nl_msg *
 nlmsg_alloc_simple (int nlmsgtype, int flags)
 {
@@ -308,7 +338,8 @@ void nlmsg_free (struct nl_msg *msg)
 	if (!msg)
 		return;
 
-	g_free (msg->nm_nlh);
+	if (!msg->nm_nlh_borrowed)
+		g_free (msg->nm_nlh);
 	g_slice_free (struct nl_msg, msg);
 }
 
@@ -940,6 +971,50 @@ nl_socket_set_buffer_size (struct nl_sock *sk, int rxbuf, int txbuf)
 	return 0;
 }
 
+/**
+ * nl_socket_set_rcvbuf_size:
+ * @sk: the netlink socket
+ * @rxbuf: the requested receive buffer size in bytes
+ * @force: if %TRUE, first try SO_RCVBUFFORCE, which requires CAP_NET_ADMIN
+ *   but is not limited by net.core.rmem_max. Falls back to SO_RCVBUF.
+ * @out_rxbuf: (allow-none): the actual size of the receive buffer, as
+ *   reported by kernel. Note that kernel doubles the requested value
+ *   to account for bookkeeping overhead.
+ *
+ * Returns: 0 on success or a negative error code.
+ */
+int
+nl_socket_set_rcvbuf_size (struct nl_sock *sk, int rxbuf, gboolean force, int *out_rxbuf)
+{
+	socklen_t len;
+	int err;
+
+	g_return_val_if_fail (rxbuf > 0, -NME_BUG);
+
+	if (sk->s_fd == -1)
+		return -NME_NL_BAD_SOCK;
+
+	err = -1;
+	if (force) {
+		err = setsockopt (sk->s_fd, SOL_SOCKET, SO_RCVBUFFORCE,
+		                  &rxbuf, sizeof (rxbuf));
+	}
+	if (err < 0) {
+		err = setsockopt (sk->s_fd, SOL_SOCKET, SO_RCVBUF,
+		                  &rxbuf, sizeof (rxbuf));
+		if (err < 0)
+			return -nm_errno_from_native (errno);
+	}
+
+	if (out_rxbuf) {
+		len = sizeof (*out_rxbuf);
+		if (getsockopt (sk->s_fd, SOL_SOCKET, SO_RCVBUF, out_rxbuf, &len) < 0)
+			*out_rxbuf = -1;
+	}
+
+	return 0;
+}
+
 int
 nl_socket_add_memberships (struct nl_sock *sk, int group, ...)
 {
@@ -990,6 +1065,22 @@ nl_socket_set_ext_ack (struct nl_sock *sk, gboolean enable)
 	return 0;
 }
 
+int
+nl_socket_set_strict_check (struct nl_sock *sk, gboolean enable)
+{
+	int err, val;
+
+	if (sk->s_fd == -1)
+		return -NME_NL_BAD_SOCK;
+
+	val = !!enable;
+	err = setsockopt (sk->s_fd, SOL_NETLINK, NETLINK_GET_STRICT_CHK, &val, sizeof (val));
+	if (err < 0)
+		return -nm_errno_from_native (errno);
+
+	return 0;
+}
+
 void nl_socket_disable_msg_peek (struct nl_sock *sk)
 {
 	sk->s_flags |= NL_MSG_PEEK_EXPLICIT;
@@ -1473,3 +1564,172 @@ abort:
 	NM_SET_OUT (out_creds_has, tmpcreds_has);
 	return retval;
 }
+
+/*****************************************************************************/
+
+#define NL_RECV_BATCH_MAX_SLOTS 16
+
+struct _NLRecvBatch {
+	unsigned char *buf;
+	size_t slot_size;
+	guint n_slots;
+	guint n_filled;
+	guint next;
+	struct mmsghdr mmsgs[NL_RECV_BATCH_MAX_SLOTS];
+	struct iovec iovs[NL_RECV_BATCH_MAX_SLOTS];
+	struct sockaddr_nl nlas[NL_RECV_BATCH_MAX_SLOTS];
+	union {
+		char buf[CMSG_SPACE (sizeof (struct ucred))];
+		struct cmsghdr align;
+	} cmsgs[NL_RECV_BATCH_MAX_SLOTS];
+};
+
+/**
+ * nl_recv_batch_new:
+ * @n_slots: how many datagrams to receive at most with one syscall.
+ *
+ * Returns: a new batch for nl_recv_batch_next(). Free with
+ *   nl_recv_batch_free().
+ */
+NLRecvBatch *
+nl_recv_batch_new (guint n_slots)
+{
+	NLRecvBatch *batch;
+
+	batch = g_slice_new0 (NLRecvBatch);
+	batch->n_slots = NM_CLAMP (n_slots, 1u, (guint) NL_RECV_BATCH_MAX_SLOTS);
+	return batch;
+}
+
+void
+nl_recv_batch_free (NLRecvBatch *batch)
+{
+	if (!batch)
+		return;
+
+	g_free (batch->buf);
+	g_slice_free (NLRecvBatch, batch);
+}
+
+gboolean
+nl_recv_batch_has_pending (const NLRecvBatch *batch)
+{
+	return batch->next < batch->n_filled;
+}
+
+/**
+ * nl_recv_batch_next:
+ * @sk: the netlink socket
+ * @batch: the receive batch
+ * @nla: the source address of the datagram
+ * @buf: (out) (transfer none): the received datagram. The buffer is owned
+ *   by @batch and only valid until the next call.
+ * @out_creds: (allow-none): the credentials of the sender
+ * @out_creds_has: (allow-none): whether @out_creds was set
+ *
+ * Like nl_recv(), but reads up to as many datagrams with one recvmmsg() call
+ * as @batch has slots, and returns them one by one. The datagrams are
+ * received into buffers that are reused and never peeked. So the buffer
+ * size from nl_socket_set_msg_buf_size() must be set.
+ *
+ * Returns: the length of the datagram, 0 on EOF or a negative error code.
+ *   For a truncated datagram, -NME_NL_MSG_TRUNC is returned and the
+ *   following datagrams are still returned by the next calls.
+ */
+int
+nl_recv_batch_next (struct nl_sock *sk,
+                    NLRecvBatch *batch,
+                    struct sockaddr_nl *nla,
+                    unsigned char **buf,
+                    struct ucred *out_creds,
+                    gboolean *out_creds_has)
+{
+	struct mmsghdr *mmsg;
+	struct ucred tmpcreds;
+	gboolean tmpcreds_has = FALSE;
+	guint i;
+	int n;
+
+	nm_assert (nla);
+	nm_assert (buf);
+	nm_assert (!out_creds_has == !out_creds);
+	nm_assert (sk->s_bufsize > 0);
+
+	if (batch->next >= batch->n_filled) {
+		const gboolean passcred = NM_FLAGS_HAS (sk->s_flags, NL_SOCK_PASSCRED);
+
+		batch->n_filled = 0;
+		batch->next = 0;
+
+		if (batch->slot_size != sk->s_bufsize) {
+			g_free (batch->buf);
+			batch->slot_size = sk->s_bufsize;
+			batch->buf = g_malloc (batch->slot_size * batch->n_slots);
+		}
+
+		for (i = 0; i < batch->n_slots; i++) {
+			batch->iovs[i] = (struct iovec) {
+				.iov_base = &batch->buf[i * batch->slot_size],
+				.iov_len = batch->slot_size,
+			};
+			batch->mmsgs[i] = (struct mmsghdr) {
+				.msg_hdr = {
+					.msg_name = &batch->nlas[i],
+					.msg_namelen = sizeof (struct sockaddr_nl),
+					.msg_iov = &batch->iovs[i],
+					.msg_iovlen = 1,
+					.msg_control = passcred ? batch->cmsgs[i].buf : NULL,
+					.msg_controllen = passcred ? sizeof (batch->cmsgs[i].buf) : 0,
+				},
+			};
+		}
+
+again:
+		/* MSG_WAITFORONE: for blocking sockets, only wait for the first datagram. */
+		n = recvmmsg (sk->s_fd, batch->mmsgs, batch->n_slots, MSG_WAITFORONE, NULL);
+		if (n < 0) {
+			int errsv = errno;
+
+			if (errsv == EINTR)
+				goto again;
+			return -nm_errno_from_native (errsv);
+		}
+		if (n == 0)
+			return 0;
+
+		batch->n_filled = n;
+	}
+
+	i = batch->next++;
+	mmsg = &batch->mmsgs[i];
+
+	if (mmsg->msg_len == 0)
+		return 0;
+
+	if (NM_FLAGS_ANY (mmsg->msg_hdr.msg_flags, MSG_TRUNC | MSG_CTRUNC))
+		return -NME_NL_MSG_TRUNC;
+
+	if (mmsg->msg_hdr.msg_namelen != sizeof (struct sockaddr_nl))
+		return -NME_UNSPEC;
+
+	if (out_creds && NM_FLAGS_HAS (sk->s_flags, NL_SOCK_PASSCRED)) {
+		struct cmsghdr *cmsg;
+
+		for (cmsg = CMSG_FIRSTHDR (&mmsg->msg_hdr); cmsg; cmsg = CMSG_NXTHDR (&mmsg->msg_hdr, cmsg)) {
+			if (cmsg->cmsg_level != SOL_SOCKET)
+				continue;
+			if (cmsg->cmsg_type != SCM_CREDENTIALS)
+				continue;
+			memcpy (&tmpcreds, CMSG_DATA (cmsg), sizeof (tmpcreds));
+			tmpcreds_has = TRUE;
+			break;
+		}
+	}
+
+	*nla = batch->nlas[i];
+	*buf = batch->iovs[i].iov_base;
+	if (out_creds && tmpcreds_has)
+		*out_creds = tmpcreds;
+	NM_SET_OUT (out_creds_has, tmpcreds_has);
+	return mmsg->msg_len;
+}
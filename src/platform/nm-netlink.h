@@ -377,6 +377,8 @@ struct nl_msg *nlmsg_alloc_size (size_t max);
 
 struct nl_msg *nlmsg_alloc_convert (struct nlmsghdr *hdr);
 
+struct nl_msg *nlmsg_alloc_inplace (struct nlmsghdr *hdr);
+
 struct nl_msg *nlmsg_alloc_simple (int nlmsgtype, int flags);
 
 void *nlmsg_reserve (struct nl_msg *n, size_t len, int pad);
@@ -524,6 +526,8 @@ int nl_socket_set_msg_buf_size (struct nl_sock *sk, size_t bufsize);
 
 int nl_socket_set_buffer_size (struct nl_sock *sk, int rxbuf, int txbuf);
 
+int nl_socket_set_rcvbuf_size (struct nl_sock *sk, int rxbuf, gboolean force, int *out_rxbuf);
+
 int nl_socket_set_passcred (struct nl_sock *sk, int state);
 
 int nl_socket_set_nonblocking (const struct nl_sock *sk);
@@ -542,6 +546,21 @@ int nl_recv (struct nl_sock *sk,
              struct ucred *out_creds,
              gboolean *out_creds_has);
 
+typedef struct _NLRecvBatch NLRecvBatch;
+
+NLRecvBatch *nl_recv_batch_new (guint n_slots);
+
+void nl_recv_batch_free (NLRecvBatch *batch);
+
+gboolean nl_recv_batch_has_pending (const NLRecvBatch *batch);
+
+int nl_recv_batch_next (struct nl_sock *sk,
+                        NLRecvBatch *batch,
+                        struct sockaddr_nl *nla,
+                        unsigned char **buf,
+                        struct ucred *out_creds,
+                        gboolean *out_creds_has);
+
 int nl_send (struct nl_sock *sk, struct nl_msg *msg);
 
 int nl_send_auto (struct nl_sock *sk, struct nl_msg *msg);
@@ -589,6 +608,8 @@ int nl_wait_for_ack (struct nl_sock *sk,
 
 int nl_socket_set_ext_ack (struct nl_sock *sk, gboolean enable);
 
+int nl_socket_set_strict_check (struct nl_sock *sk, gboolean enable);
+
 /*****************************************************************************/
 
 void *genlmsg_put (struct nl_msg *msg, uint32_t port, uint32_t seq, int family,
@@ -19,9 +19,30 @@ NMPCache *nm_platform_get_cache (NMPlatform *self);
 		nm_assert (NM_IN_SET (nm_platform_netns_get (_platform), NULL, nmp_netns_get_current ())); \
 	} G_STMT_END
 
+typedef struct {
+	/* the full path, used for logging and to order conflicting accesses. */
+	char *pathid;
+
+	/* if non-negative, a duplicate of the directory fd passed by the caller.
+	 * @path is then relative to it. */
+	int dirfd;
+
+	char *path;
+	char *value;
+} NMPlatformSysctlBatchEntry;
+
+struct _NMPlatformSysctlBatch {
+	NMPlatform *platform;
+
+	/* array of NMPlatformSysctlBatchEntry. */
+	GArray *entries;
+};
+
 void nm_platform_cache_update_emit_signal (NMPlatform *platform,
                                            NMPCacheOpsType cache_op,
                                            const NMPObject *obj_old,
                                            const NMPObject *obj_new);
 
+void nm_platform_ethtool_cache_link_event (NMPlatform *self, int ifindex);
+
 #endif /* __NM_PLATFORM_PRIVATE_H__ */
@@ -262,6 +262,11 @@ out:
  * ethtool
  *****************************************************************************/
 
+/* NMPlatform issues ethtool requests also from worker threads (see
+ * nm_platform_link_ethtool_query_async()). */
+#undef NM_THREAD_SAFE_ON_MAIN_THREAD
+#define NM_THREAD_SAFE_ON_MAIN_THREAD 0
+
 static
 NM_UTILS_ENUM2STR_DEFINE (_ethtool_cmd_to_string, guint32,
 	NM_UTILS_ENUM2STR (ETHTOOL_GCOALESCE,  "ETHTOOL_GCOALESCE"),
@@ -499,6 +504,13 @@ static const NMEthtoolFeatureInfo _ethtool_feature_infos[_NM_ETHTOOL_ID_FEATURE_
  * for multiple kernel-names. */
 #define N_ETHTOOL_KERNEL_FEATURES (((guint) _NM_ETHTOOL_ID_FEATURE_NUM) + 8u)
 
+/* the size of the NMEthtoolFeatureStates allocation. The states and the
+ * NULL terminated lists of states_indexed follow the struct. */
+#define ETHTOOL_FEATURE_STATES_SIZE \
+	(  sizeof (NMEthtoolFeatureStates) \
+	 + (N_ETHTOOL_KERNEL_FEATURES * sizeof (NMEthtoolFeatureState)) \
+	 + ((N_ETHTOOL_KERNEL_FEATURES + G_N_ELEMENTS (_ethtool_feature_infos)) * sizeof (NMEthtoolFeatureState *)))
+
 static void
 _ASSERT_ethtool_feature_infos (void)
 {
@@ -589,9 +601,7 @@ ethtool_get_features (SocketHandle *shandle)
 				i_flag = (guint32) (1u << (((guint) i_feature) % 32u));
 
 				if (!states) {
-					states = g_malloc0 (sizeof (NMEthtoolFeatureStates)
-					                    + (N_ETHTOOL_KERNEL_FEATURES * sizeof (NMEthtoolFeatureState))
-					                    + ((N_ETHTOOL_KERNEL_FEATURES + G_N_ELEMENTS (_ethtool_feature_infos)) * sizeof (NMEthtoolFeatureState *)));
+					states = g_malloc0 (ETHTOOL_FEATURE_STATES_SIZE);
 					states_list0 = &states->states_list[0];
 					states_plist0 = (gpointer) &states_list0[N_ETHTOOL_KERNEL_FEATURES];
 					states->n_ss_features = ss_features->len;
@@ -651,6 +661,46 @@ nmp_utils_ethtool_get_features (int ifindex)
 	return features;
 }
 
+/**
+ * nmp_utils_ethtool_features_dup:
+ * @features: the features, as returned by nmp_utils_ethtool_get_features().
+ *
+ * Returns: (transfer full): a copy of @features. Free with g_free().
+ */
+NMEthtoolFeatureStates *
+nmp_utils_ethtool_features_dup (const NMEthtoolFeatureStates *features)
+{
+	NMEthtoolFeatureStates *states;
+	const NMEthtoolFeatureState **states_plist;
+	const NMEthtoolFeatureState **states_plist_src;
+	guint i;
+
+	if (!features)
+		return NULL;
+
+	states = nm_memdup (features, ETHTOOL_FEATURE_STATES_SIZE);
+
+	/* the pointers point into the allocation itself. Relocate them. */
+#define _RELOCATE(ptr) \
+	((gpointer) (((const char *) states) + (((const char *) (ptr)) - ((const char *) features))))
+
+	states_plist_src = (gpointer) &features->states_list[N_ETHTOOL_KERNEL_FEATURES];
+	states_plist = (gpointer) &states->states_list[N_ETHTOOL_KERNEL_FEATURES];
+	for (i = 0; i < N_ETHTOOL_KERNEL_FEATURES + G_N_ELEMENTS (_ethtool_feature_infos); i++) {
+		if (states_plist_src[i])
+			states_plist[i] = _RELOCATE (states_plist_src[i]);
+	}
+
+	for (i = 0; i < _NM_ETHTOOL_ID_FEATURE_NUM; i++) {
+		if (features->states_indexed[i])
+			states->states_indexed[i] = _RELOCATE (features->states_indexed[i]);
+	}
+
+#undef _RELOCATE
+
+	return states;
+}
+
 static const char *
 _ethtool_feature_state_to_string (char *buf, gsize buf_size, const NMEthtoolFeatureState *s, const char *prefix)
 {
@@ -1382,6 +1432,9 @@ nmp_utils_ethtool_set_wake_on_lan (int ifindex,
 	return _ethtool_call_once (ifindex, &wol_info, sizeof (wol_info)) >= 0;
 }
 
+#undef NM_THREAD_SAFE_ON_MAIN_THREAD
+#define NM_THREAD_SAFE_ON_MAIN_THREAD 1
+
 /******************************************************************************
  * mii
  *****************************************************************************/
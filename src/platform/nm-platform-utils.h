@@ -87,6 +87,8 @@ struct _NMEthtoolFeatureStates {
 
 NMEthtoolFeatureStates *nmp_utils_ethtool_get_features (int ifindex);
 
+NMEthtoolFeatureStates *nmp_utils_ethtool_features_dup (const NMEthtoolFeatureStates *features);
+
 gboolean nmp_utils_ethtool_set_features (int ifindex,
                                          const NMEthtoolFeatureStates *features,
                                          const NMTernary *requested /* indexed by NMEthtoolID - _NM_ETHTOOL_ID_FEATURE_FIRST */,
@@ -7,6 +7,7 @@
 
 #include "nm-platform.h"
 
+#include <fcntl.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <netinet/in.h>
@@ -177,6 +178,34 @@ typedef struct _NMPlatformPrivate {
 	GHashTable *ip4_dev_route_blacklist_hash;
 	NMDedupMultiIndex *multi_idx;
 	NMPCache *cache;
+
+	/* bitmap of rtm_protocol values and sorted list of tables for routes
+	 * that are not kept in the cache. See nm_platform_route_cache_scope_set(). */
+	guint32 route_scope_ignore_protocols[256 / 32];
+	guint32 *route_scope_ignore_tables;
+	guint route_scope_ignore_tables_len;
+	guint64 route_scope_n_ignored;
+	bool route_scope_active:1;
+
+	/* the pending change sets by object type and ifindex, and in the order
+	 * of their first change. See NM_PLATFORM_SIGNAL_CHANGE_SET. */
+	GHashTable *change_sets;
+	CList change_sets_lst_head;
+	guint change_sets_idle_id;
+
+	/* the last published snapshot of the cache for other threads. Only
+	 * the thread that owns the platform creates snapshots, in @snapshot_context.
+	 * See nm_platform_cache_snapshot_get(). */
+	GMutex snapshot_lock;
+	NMPCacheSnapshot *snapshot;
+	GSource *snapshot_refresh_source;
+	GThread *snapshot_owner;
+	GMainContext *snapshot_context;
+
+	/* cached ethtool results by ifindex, and a counter that is bumped on
+	 * every invalidation. See _ethtool_cache_get(). */
+	GHashTable *ethtool_cache;
+	guint64 ethtool_cache_gen;
 } NMPlatformPrivate;
 
 G_DEFINE_TYPE (NMPlatform, nm_platform, G_TYPE_OBJECT)
@@ -440,6 +469,78 @@ nm_platform_process_events (NMPlatform *self)
 		klass->process_events (self);
 }
 
+/**
+ * nm_platform_refresh_filtered:
+ * @self: the #NMPlatform instance
+ * @obj_type: the object type to refresh. Must be one of IPv4/IPv6 addresses
+ *   or routes.
+ * @ifindex: if positive, only refresh the objects of this interface.
+ * @table: if non-zero, only refresh the routes of this table. Ignored
+ *   for addresses.
+ *
+ * Re-read a subset of the objects from kernel and synchronize the cache.
+ * Compared to a full refresh, this avoids re-reading (and on capable kernels,
+ * even receiving) all objects of the type when only a part is of interest.
+ */
+void
+nm_platform_refresh_filtered (NMPlatform *self,
+                              NMPObjectType obj_type,
+                              int ifindex,
+                              guint32 table)
+{
+	_CHECK_SELF_VOID (self, klass);
+
+	g_return_if_fail (NM_IN_SET (obj_type, NMP_OBJECT_TYPE_IP4_ADDRESS,
+	                                       NMP_OBJECT_TYPE_IP6_ADDRESS,
+	                                       NMP_OBJECT_TYPE_IP4_ROUTE,
+	                                       NMP_OBJECT_TYPE_IP6_ROUTE));
+
+	if (klass->refresh_filtered)
+		klass->refresh_filtered (self, obj_type, ifindex, table);
+}
+
+/**
+ * nm_platform_netlink_config_set:
+ * @self: the #NMPlatform instance
+ * @rcvbuf_max: the maximum size in bytes up to which the receive buffer of
+ *   the event socket grows, when it overflows. 0 selects the default.
+ * @resync_affected_only: after an overflow, only resync right away the object
+ *   types for which events were received. The other types are resynced
+ *   later, once the event storm settled.
+ *
+ * Tune how the platform deals with bursts of kernel events.
+ */
+void
+nm_platform_netlink_config_set (NMPlatform *self,
+                                guint rcvbuf_max,
+                                gboolean resync_affected_only)
+{
+	_CHECK_SELF_VOID (self, klass);
+
+	if (klass->netlink_config_set)
+		klass->netlink_config_set (self, rcvbuf_max, resync_affected_only);
+}
+
+/**
+ * nm_platform_netlink_worker_set:
+ * @self: the #NMPlatform instance
+ * @enabled: whether to read and parse netlink events on a separate thread.
+ *
+ * With the worker enabled, a thread reads the event socket and decodes
+ * addresses, routes, routing rules and traffic filters into #NMPObject
+ * instances. The main context still merges them into the cache and emits
+ * the signals, in the order in which the kernel sent the messages.
+ */
+void
+nm_platform_netlink_worker_set (NMPlatform *self,
+                                gboolean enabled)
+{
+	_CHECK_SELF_VOID (self, klass);
+
+	if (klass->netlink_worker_set)
+		klass->netlink_worker_set (self, enabled);
+}
+
 const NMPlatformLink *
 nm_platform_process_events_ensure_link (NMPlatform *self,
                                         int ifindex,
@@ -568,6 +669,216 @@ void nm_platform_sysctl_set_async (NMPlatform *self,
 	klass->sysctl_set_async (self, pathid, dirfd, path, values, callback, data, cancellable);
 }
 
+/*****************************************************************************/
+
+/**
+ * nm_platform_sysctl_batch_new:
+ * @self: platform instance
+ *
+ * Creates a batch of sysctl writes. Add the values with
+ * nm_platform_sysctl_batch_add() and hand the batch over with
+ * nm_platform_sysctl_batch_commit().
+ *
+ * Returns: (transfer full): the new batch.
+ */
+NMPlatformSysctlBatch *
+nm_platform_sysctl_batch_new (NMPlatform *self)
+{
+	NMPlatformSysctlBatch *batch;
+
+	g_return_val_if_fail (NM_IS_PLATFORM (self), NULL);
+
+	batch = g_slice_new (NMPlatformSysctlBatch);
+	batch->platform = g_object_ref (self);
+	batch->entries = g_array_new (FALSE, FALSE, sizeof (NMPlatformSysctlBatchEntry));
+	return batch;
+}
+
+void
+nm_platform_sysctl_batch_free (NMPlatformSysctlBatch *batch)
+{
+	guint i;
+
+	if (!batch)
+		return;
+
+	for (i = 0; i < batch->entries->len; i++) {
+		NMPlatformSysctlBatchEntry *entry = &g_array_index (batch->entries, NMPlatformSysctlBatchEntry, i);
+
+		g_free (entry->pathid);
+		if (entry->dirfd >= 0)
+			nm_close (entry->dirfd);
+		g_free (entry->path);
+		g_free (entry->value);
+	}
+	g_array_unref (batch->entries);
+	g_object_unref (batch->platform);
+	g_slice_free (NMPlatformSysctlBatch, batch);
+}
+
+/**
+ * nm_platform_sysctl_batch_add:
+ * @batch: the batch
+ * @pathid: if @dirfd is present, this must be the full path that is looked up
+ * @dirfd: optional file descriptor for parent directory for openat().
+ *   The batch keeps a duplicate of it.
+ * @path: absolute option path
+ * @value: the value to write
+ *
+ * Queues a write. Writes are done in the order in which they were added.
+ */
+void
+nm_platform_sysctl_batch_add (NMPlatformSysctlBatch *batch,
+                              const char *pathid,
+                              int dirfd,
+                              const char *path,
+                              const char *value)
+{
+	NMPlatformSysctlBatchEntry entry;
+
+	g_return_if_fail (batch);
+	g_return_if_fail (path);
+	g_return_if_fail (value);
+
+	if (dirfd >= 0) {
+		g_return_if_fail (pathid);
+
+		entry.pathid = g_strdup (pathid);
+		entry.dirfd = fcntl (dirfd, F_DUPFD_CLOEXEC, 0);
+		if (entry.dirfd < 0) {
+			/* the write will fail with EBADF, and be reported by the
+			 * callback of the batch. */
+			entry.path = NULL;
+		} else
+			entry.path = g_strdup (path);
+	} else {
+		entry.pathid = g_strdup (path);
+		entry.dirfd = -1;
+		entry.path = g_strdup (path);
+	}
+	entry.value = g_strdup (value);
+	g_array_append_val (batch->entries, entry);
+}
+
+void
+nm_platform_sysctl_batch_add_ip_conf (NMPlatformSysctlBatch *batch,
+                                      int addr_family,
+                                      const char *ifname,
+                                      const char *property,
+                                      const char *value)
+{
+	char buf[NM_UTILS_SYSCTL_IP_CONF_PATH_BUFSIZE];
+
+	nm_platform_sysctl_batch_add (batch,
+	                              NMP_SYSCTL_PATHID_ABSOLUTE (nm_utils_sysctl_ip_conf_path (addr_family,
+	                                                                                        buf,
+	                                                                                        ifname,
+	                                                                                        property)),
+	                              value);
+}
+
+guint
+nm_platform_sysctl_batch_get_len (const NMPlatformSysctlBatch *batch)
+{
+	g_return_val_if_fail (batch, 0);
+
+	return batch->entries->len;
+}
+
+static void
+_sysctl_batch_commit_return_idle (gpointer user_data,
+                                  GCancellable *cancellable)
+{
+	gs_free_error GError *cancelled_error = NULL;
+	gs_free_error GError *error = NULL;
+	NMPlatformAsyncCallback callback;
+	gpointer callback_data;
+
+	nm_utils_user_data_unpack (user_data, &callback, &callback_data, &error);
+	g_cancellable_set_error_if_cancelled (cancellable, &cancelled_error);
+	callback (cancelled_error ?: error, callback_data);
+}
+
+/**
+ * nm_platform_sysctl_batch_commit:
+ * @batch: (transfer full): the batch
+ * @callback: (allow-none): function called on termination
+ * @data: data passed to callback function
+ * @cancellable: (allow-none): to cancel the operation
+ *
+ * Writes the values of the batch without blocking the caller. The platform
+ * may apply batches on worker threads, but batches of one platform instance
+ * are applied one after the other, in the order in which they were committed.
+ * Reading or writing a sysctl with nm_platform_sysctl_get() or
+ * nm_platform_sysctl_set() waits for pending writes in the same directory,
+ * so a synchronous access never overtakes a batch that was committed earlier.
+ *
+ * A failed write does not stop the others. @callback is invoked once, and
+ * asynchronously. The error reports the first failure.
+ */
+void
+nm_platform_sysctl_batch_commit (NMPlatformSysctlBatch *batch,
+                                 NMPlatformAsyncCallback callback,
+                                 gpointer data,
+                                 GCancellable *cancellable)
+{
+	nm_auto_free_sysctl_batch NMPlatformSysctlBatch *batch_free = batch;
+	gs_free_error GError *error = NULL;
+	NMPlatformClass *klass;
+	NMPlatform *self;
+	guint i;
+
+	g_return_if_fail (batch);
+	g_return_if_fail (!data || callback);
+
+	self = batch->platform;
+	klass = NM_PLATFORM_GET_CLASS (self);
+
+	if (klass->sysctl_batch_commit) {
+		klass->sysctl_batch_commit (self,
+		                            g_steal_pointer (&batch_free),
+		                            callback,
+		                            data,
+		                            cancellable);
+		return;
+	}
+
+	for (i = 0; i < batch->entries->len; i++) {
+		const NMPlatformSysctlBatchEntry *entry = &g_array_index (batch->entries, NMPlatformSysctlBatchEntry, i);
+		int errsv;
+
+		if (!entry->path)
+			errsv = EBADF;
+		else if (klass->sysctl_set (self,
+		                            entry->dirfd >= 0 ? entry->pathid : NULL,
+		                            entry->dirfd,
+		                            entry->path,
+		                            entry->value))
+			continue;
+		else
+			errsv = errno;
+
+		if (!error) {
+			g_set_error (&error,
+			             NM_UTILS_ERROR,
+			             NM_UTILS_ERROR_UNKNOWN,
+			             "sysctl: failed setting '%s' to value '%s': %s",
+			             entry->pathid,
+			             entry->value,
+			             nm_strerror_native (errsv));
+		}
+	}
+
+	if (!callback)
+		return;
+
+	nm_utils_invoke_on_idle (cancellable,
+	                         _sysctl_batch_commit_return_idle,
+	                         nm_utils_user_data_pack (callback,
+	                                                  data,
+	                                                  g_steal_pointer (&error)));
+}
+
 
 gboolean
 nm_platform_sysctl_ip_conf_set_ipv6_hop_limit_safe (NMPlatform *self,
@@ -676,6 +987,30 @@ nm_platform_sysctl_get (NMPlatform *self, const char *pathid, int dirfd, const c
 	return klass->sysctl_get (self, pathid, dirfd, path);
 }
 
+/**
+ * nm_platform_sysctl_cache_get_stats:
+ * @self: platform instance
+ * @out_stats: (out): the counters of the sysctl value cache
+ *
+ * Values of /proc/sys/net/ipv{4,6}/conf sysctls are cached by the platform
+ * and kept current from netconf notifications of kernel.
+ *
+ * Returns: %FALSE if the platform has no such cache. In that case
+ *   @out_stats is zeroed.
+ */
+gboolean
+nm_platform_sysctl_cache_get_stats (NMPlatform *self, NMPlatformSysctlCacheStats *out_stats)
+{
+	_CHECK_SELF (self, klass, FALSE);
+
+	g_return_val_if_fail (out_stats, FALSE);
+
+	memset (out_stats, 0, sizeof (*out_stats));
+	if (!klass->sysctl_cache_get_stats)
+		return FALSE;
+	return klass->sysctl_cache_get_stats (self, out_stats);
+}
+
 /**
  * nm_platform_sysctl_get_int32:
  * @self: platform instance
@@ -874,32 +1209,6 @@ nm_platform_sysctl_ip_conf_get_rp_filter_ipv4 (NMPlatform *self,
 
 /*****************************************************************************/
 
-static int
-_link_get_all_presort (gconstpointer  p_a,
-                       gconstpointer  p_b,
-                       gpointer       sort_by_name)
-{
-	const NMPlatformLink *a = NMP_OBJECT_CAST_LINK (*((const NMPObject **) p_a));
-	const NMPlatformLink *b = NMP_OBJECT_CAST_LINK (*((const NMPObject **) p_b));
-
-	/* Loopback always first */
-	if (a->ifindex == 1)
-		return -1;
-	if (b->ifindex == 1)
-		return 1;
-
-	if (GPOINTER_TO_INT (sort_by_name)) {
-		/* Initialized links first */
-		if (a->initialized > b->initialized)
-			return -1;
-		if (a->initialized < b->initialized)
-			return 1;
-
-		return strcmp (a->name, b->name);
-	} else
-		return a->ifindex - b->ifindex;
-}
-
 /**
  * nm_platform_link_get_all:
  * @self: platform instance
@@ -907,117 +1216,51 @@ _link_get_all_presort (gconstpointer  p_a,
  *
  * Retrieve a snapshot of configuration for all links at once. The result is
  * owned by the caller and should be freed with g_ptr_array_unref().
+ *
+ * The links are ordered by ifindex or name, except that children/slaves
+ * come after all their ancestors.
  */
 GPtrArray *
 nm_platform_link_get_all (NMPlatform *self, gboolean sort_by_name)
 {
-	gs_unref_ptrarray GPtrArray *links = NULL;
 	GPtrArray *result;
-	guint i, nresult;
-	gs_unref_hashtable GHashTable *unseen = NULL;
-	const NMPlatformLink *item;
-	NMPLookup lookup;
 
 	_CHECK_SELF (self, klass, NULL);
 
-	nmp_lookup_init_obj_type (&lookup, NMP_OBJECT_TYPE_LINK);
-	links = nm_dedup_multi_objs_to_ptr_array_head (nm_platform_lookup (self, &lookup),
-	                                               NULL, NULL);
-	if (!links)
-		return NULL;
-
-	for (i = 0; i < links->len; ) {
-		if (!nmp_object_is_visible (links->pdata[i]))
-			g_ptr_array_remove_index_fast (links, i);
-		else
-			i++;
-	}
-
-	if (links->len == 0)
-		return NULL;
-
-	/* first sort the links by their ifindex or name. Below we will sort
-	 * further by moving children/slaves to the end. */
-	g_ptr_array_sort_with_data (links, _link_get_all_presort, GINT_TO_POINTER (sort_by_name));
-
-	unseen = g_hash_table_new (nm_direct_hash, NULL);
-	for (i = 0; i < links->len; i++) {
-		item = NMP_OBJECT_CAST_LINK (links->pdata[i]);
-		nm_assert (item->ifindex > 0);
-		if (!g_hash_table_insert (unseen, GINT_TO_POINTER (item->ifindex), NULL))
-			nm_assert_not_reached ();
-	}
+	result = nmp_cache_link_get_all_sorted (nm_platform_get_cache (self), sort_by_name);
 
 #if NM_MORE_ASSERTS
 	/* Ensure that link_get_all returns a consistent and valid result. */
-	for (i = 0; i < links->len; i++) {
-		item = NMP_OBJECT_CAST_LINK (links->pdata[i]);
-
-		if (!item->ifindex)
-			continue;
-		if (item->master != 0) {
-			g_warn_if_fail (item->master > 0);
-			g_warn_if_fail (item->master != item->ifindex);
-			g_warn_if_fail (g_hash_table_contains (unseen, GINT_TO_POINTER (item->master)));
-		}
-		if (item->parent != 0) {
-			if (item->parent != NM_PLATFORM_LINK_OTHER_NETNS) {
-				g_warn_if_fail (item->parent > 0);
-				g_warn_if_fail (item->parent != item->ifindex);
-				g_warn_if_fail (g_hash_table_contains (unseen, GINT_TO_POINTER (item->parent)));
-			}
-		}
-	}
-#endif
-
-	/* Re-order the links list such that children/slaves come after all ancestors */
-	nm_assert (g_hash_table_size (unseen) == links->len);
-	nresult = links->len;
-	result = g_ptr_array_new_full (nresult, (GDestroyNotify) nmp_object_unref);
-
-	while (TRUE) {
-		gboolean found_something = FALSE;
-		guint first_idx = G_MAXUINT;
+	if (result) {
+		gs_unref_hashtable GHashTable *seen = NULL;
+		guint i;
 
-		for (i = 0; i < links->len; i++) {
-			item = NMP_OBJECT_CAST_LINK (links->pdata[i]);
+		seen = g_hash_table_new (nm_direct_hash, NULL);
+		for (i = 0; i < result->len; i++) {
+			const NMPlatformLink *item = NMP_OBJECT_CAST_LINK (result->pdata[i]);
 
-			if (!item)
-				continue;
-
-			g_assert (g_hash_table_contains (unseen, GINT_TO_POINTER (item->ifindex)));
-
-			if (item->master > 0 && g_hash_table_contains (unseen, GINT_TO_POINTER (item->master)))
-				goto skip;
-			if (item->parent > 0 && g_hash_table_contains (unseen, GINT_TO_POINTER (item->parent)))
-				goto skip;
-
-			g_hash_table_remove (unseen, GINT_TO_POINTER (item->ifindex));
-			g_ptr_array_add (result, links->pdata[i]);
-			links->pdata[i] = NULL;
-			found_something = TRUE;
-			continue;
-skip:
-			if (first_idx == G_MAXUINT)
-				first_idx = i;
+			nm_assert (item->ifindex > 0);
+			if (!g_hash_table_add (seen, GINT_TO_POINTER (item->ifindex)))
+				nm_assert_not_reached ();
 		}
+		for (i = 0; i < result->len; i++) {
+			const NMPlatformLink *item = NMP_OBJECT_CAST_LINK (result->pdata[i]);
 
-		if (found_something) {
-			if (first_idx == G_MAXUINT)
-				break;
-		} else {
-			nm_assert (first_idx != G_MAXUINT);
-			/* There is a loop, pop the first (remaining) element from the list.
-			 * This can happen for veth pairs where each peer is parent of the other end. */
-			item = NMP_OBJECT_CAST_LINK (links->pdata[first_idx]);
-			nm_assert (item);
-			g_hash_table_remove (unseen, GINT_TO_POINTER (item->ifindex));
-			g_ptr_array_add (result, links->pdata[first_idx]);
-			links->pdata[first_idx] = NULL;
+			if (item->master != 0) {
+				g_warn_if_fail (item->master > 0);
+				g_warn_if_fail (item->master != item->ifindex);
+				g_warn_if_fail (g_hash_table_contains (seen, GINT_TO_POINTER (item->master)));
+			}
+			if (item->parent != 0) {
+				if (item->parent != NM_PLATFORM_LINK_OTHER_NETNS) {
+					g_warn_if_fail (item->parent > 0);
+					g_warn_if_fail (item->parent != item->ifindex);
+					g_warn_if_fail (g_hash_table_contains (seen, GINT_TO_POINTER (item->parent)));
+				}
+			}
 		}
-		nm_assert (result->len < nresult);
 	}
-	nm_assert (result->len == nresult);
+#endif
 
 	return result;
 }
@@ -1708,91 +1951,676 @@ nm_platform_link_get_address (NMPlatform *self, int ifindex, size_t *length)
 	return nmp_link_address_get (pllink ? &pllink->l_address : NULL, length);
 }
 
-/**
- * nm_platform_link_get_permanent_address:
- * @self: platform instance
- * @ifindex: Interface index
- * @buf: buffer of at least %NM_UTILS_HWADDR_LEN_MAX bytes, on success
- * the permanent hardware address
- * @length: Pointer to a variable to store address length
+/*****************************************************************************/
+
+/* Some drivers take a long time to answer ethtool requests, and the same
+ * information is requested repeatedly while realizing and activating a
+ * device. Cache the results per ifindex.
  *
- * Returns: %TRUE on success, %FALSE on failure to read the permanent hardware
- * address.
- */
-gboolean
-nm_platform_link_get_permanent_address (NMPlatform *self, int ifindex, guint8 *buf, size_t *length)
-{
-	_CHECK_SELF (self, klass, FALSE);
+ * The driver info and the permanent address don't change during the lifetime
+ * of a link, unless the driver changes. The features, coalesce and ring
+ * settings are dropped whenever the kernel announces a change of the link
+ * (RTM_NEWLINK), and when we change them ourselves. Only links that are in the
+ * platform cache are cached, because otherwise we would not notice their
+ * removal. */
 
-	if (length)
-		*length = 0;
+#define ETHTOOL_QUERY_VOLATILE \
+	(  NM_PLATFORM_ETHTOOL_QUERY_FEATURES \
+	 | NM_PLATFORM_ETHTOOL_QUERY_COALESCE \
+	 | NM_PLATFORM_ETHTOOL_QUERY_RING)
 
-	g_return_val_if_fail (ifindex > 0, FALSE);
-	g_return_val_if_fail (buf, FALSE);
-	g_return_val_if_fail (length, FALSE);
+#define ETHTOOL_PREFETCH_MAX_THREADS 8
 
-	if (klass->link_get_permanent_address)
-		return klass->link_get_permanent_address (self, ifindex, buf, length);
-	return FALSE;
+typedef struct {
+	int ifindex;
+
+	/* the value of ethtool_cache_gen when the entry was last invalidated. */
+	guint64 gen;
+
+	NMPlatformEthtoolQueryFlags valid;
+
+	bool driver_info_success:1;
+	bool permanent_address_success:1;
+	bool coalesce_success:1;
+	bool ring_success:1;
+
+	guint8 permanent_address_len;
+	guint8 permanent_address[NM_UTILS_HWADDR_LEN_MAX];
+
+	char *driver_name;
+	char *driver_version;
+	char *fw_version;
+
+	/* %NULL, if we failed to read the features. */
+	NMEthtoolFeatureStates *features;
+
+	NMEthtoolCoalesceState coalesce;
+	NMEthtoolRingState ring;
+} EthtoolCacheEntry;
+
+static void
+_ethtool_cache_entry_clear (EthtoolCacheEntry *entry,
+                            NMPlatformEthtoolQueryFlags what)
+{
+	if (NM_FLAGS_HAS (what, NM_PLATFORM_ETHTOOL_QUERY_DRIVER_INFO)) {
+		nm_clear_g_free (&entry->driver_name);
+		nm_clear_g_free (&entry->driver_version);
+		nm_clear_g_free (&entry->fw_version);
+	}
+	if (NM_FLAGS_HAS (what, NM_PLATFORM_ETHTOOL_QUERY_FEATURES))
+		nm_clear_g_free (&entry->features);
+	entry->valid &= ~what;
 }
 
-gboolean
-nm_platform_link_supports_carrier_detect (NMPlatform *self, int ifindex)
+static void
+_ethtool_cache_entry_clear_all (EthtoolCacheEntry *entry)
 {
-	_CHECK_SELF (self, klass, FALSE);
+	_ethtool_cache_entry_clear (entry, NM_PLATFORM_ETHTOOL_QUERY_ALL);
+}
 
-	g_return_val_if_fail (ifindex >= 0, FALSE);
+static void
+_ethtool_cache_entry_free (gpointer data)
+{
+	EthtoolCacheEntry *entry = data;
 
-	return klass->link_supports_carrier_detect (self, ifindex);
+	_ethtool_cache_entry_clear_all (entry);
+	g_slice_free (EthtoolCacheEntry, entry);
 }
 
-gboolean
-nm_platform_link_supports_vlans (NMPlatform *self, int ifindex)
+/* Moves the results that are valid in @src to @dst, unless @dst already
+ * has them. */
+static void
+_ethtool_cache_entry_merge (EthtoolCacheEntry *dst,
+                            EthtoolCacheEntry *src)
 {
-	_CHECK_SELF (self, klass, FALSE);
+	NMPlatformEthtoolQueryFlags what = src->valid & ~dst->valid;
 
-	g_return_val_if_fail (ifindex >= 0, FALSE);
+	nm_assert (dst->ifindex == src->ifindex);
 
-	return klass->link_supports_vlans (self, ifindex);
+	if (NM_FLAGS_HAS (what, NM_PLATFORM_ETHTOOL_QUERY_DRIVER_INFO)) {
+		dst->driver_info_success = src->driver_info_success;
+		dst->driver_name = g_steal_pointer (&src->driver_name);
+		dst->driver_version = g_steal_pointer (&src->driver_version);
+		dst->fw_version = g_steal_pointer (&src->fw_version);
+	}
+	if (NM_FLAGS_HAS (what, NM_PLATFORM_ETHTOOL_QUERY_PERMANENT_ADDRESS)) {
+		dst->permanent_address_success = src->permanent_address_success;
+		dst->permanent_address_len = src->permanent_address_len;
+		memcpy (dst->permanent_address, src->permanent_address, src->permanent_address_len);
+	}
+	if (NM_FLAGS_HAS (what, NM_PLATFORM_ETHTOOL_QUERY_FEATURES))
+		dst->features = g_steal_pointer (&src->features);
+	if (NM_FLAGS_HAS (what, NM_PLATFORM_ETHTOOL_QUERY_COALESCE)) {
+		dst->coalesce_success = src->coalesce_success;
+		dst->coalesce = src->coalesce;
+	}
+	if (NM_FLAGS_HAS (what, NM_PLATFORM_ETHTOOL_QUERY_RING)) {
+		dst->ring_success = src->ring_success;
+		dst->ring = src->ring;
+	}
+	dst->valid |= what;
 }
 
-gboolean
-nm_platform_link_supports_sriov (NMPlatform *self, int ifindex)
-{
-	_CHECK_SELF (self, klass, FALSE);
+/* the ethtool requests also run on worker threads. */
+#undef NM_THREAD_SAFE_ON_MAIN_THREAD
+#define NM_THREAD_SAFE_ON_MAIN_THREAD 0
 
-	g_return_val_if_fail (ifindex >= 0, FALSE);
+/* Issues the ethtool requests for @what and fills @entry. This does not
+ * touch the platform instance, so it can be called on any thread. The
+ * caller must have switched to the netns of the platform. */
+static void
+_ethtool_cache_entry_query (NMPlatform *self,
+                            EthtoolCacheEntry *entry,
+                            NMPlatformEthtoolQueryFlags what)
+{
+	NMPlatformClass *klass = NM_PLATFORM_GET_CLASS (self);
+
+	_ethtool_cache_entry_clear (entry, what);
+
+	if (NM_FLAGS_HAS (what, NM_PLATFORM_ETHTOOL_QUERY_DRIVER_INFO)) {
+		entry->driver_info_success = klass->link_get_driver_info (self,
+		                                                          entry->ifindex,
+		                                                          &entry->driver_name,
+		                                                          &entry->driver_version,
+		                                                          &entry->fw_version);
+		if (!entry->driver_info_success)
+			_ethtool_cache_entry_clear (entry, NM_PLATFORM_ETHTOOL_QUERY_DRIVER_INFO);
+	}
+	if (NM_FLAGS_HAS (what, NM_PLATFORM_ETHTOOL_QUERY_PERMANENT_ADDRESS)) {
+		size_t len = 0;
+
+		entry->permanent_address_success =    klass->link_get_permanent_address
+		                                   && klass->link_get_permanent_address (self,
+		                                                                         entry->ifindex,
+		                                                                         entry->permanent_address,
+		                                                                         &len);
+		entry->permanent_address_len = entry->permanent_address_success ? len : 0;
+	}
+	if (NM_FLAGS_HAS (what, NM_PLATFORM_ETHTOOL_QUERY_FEATURES))
+		entry->features = nmp_utils_ethtool_get_features (entry->ifindex);
+	if (NM_FLAGS_HAS (what, NM_PLATFORM_ETHTOOL_QUERY_COALESCE))
+		entry->coalesce_success = nmp_utils_ethtool_get_coalesce (entry->ifindex, &entry->coalesce);
+	if (NM_FLAGS_HAS (what, NM_PLATFORM_ETHTOOL_QUERY_RING))
+		entry->ring_success = nmp_utils_ethtool_get_ring (entry->ifindex, &entry->ring);
 
-	return klass->link_supports_sriov (self, ifindex);
+	entry->valid |= what;
 }
 
-/**
- * nm_platform_link_set_sriov_params:
- * @self: platform instance
- * @ifindex: the index of the interface to change
- * @num_vfs: the number of VFs to create
- * @autoprobe: the new autoprobe-drivers value (pass
- *     %NM_TERNARY_DEFAULT to keep current value)
- * @callback: called when the operation finishes
- * @callback_data: data passed to @callback
- * @cancellable: cancellable to abort the operation
- *
- * Sets SR-IOV parameters asynchronously without
- * blocking the main thread. The callback function is
- * always invoked, and asynchronously.
- */
-void
-nm_platform_link_set_sriov_params_async (NMPlatform *self,
-                                         int ifindex,
-                                         guint num_vfs,
-                                         NMTernary autoprobe,
-                                         NMPlatformAsyncCallback callback,
-                                         gpointer callback_data,
-                                         GCancellable *cancellable)
+typedef struct {
+	NMPlatform *self;
+	EthtoolCacheEntry *entries;
+	guint len;
+	int next_idx;
+} EthtoolPrefetchJob;
+
+static gpointer
+_ethtool_prefetch_thread_fn (gpointer user_data)
 {
-	_CHECK_SELF_VOID (self, klass);
+	EthtoolPrefetchJob *job = user_data;
+	nm_auto_pop_netns NMPNetns *netns = NULL;
 
-	g_return_if_fail (ifindex > 0);
+	if (!nm_platform_netns_push (job->self, &netns))
+		return NULL;
+
+	while (TRUE) {
+		const guint idx = g_atomic_int_add (&job->next_idx, 1);
+
+		if (idx >= job->len)
+			break;
+
+		_ethtool_cache_entry_query (job->self,
+		                            &job->entries[idx],
+		                            NM_PLATFORM_ETHTOOL_QUERY_DRIVER_INFO
+		                            | NM_PLATFORM_ETHTOOL_QUERY_PERMANENT_ADDRESS);
+	}
+
+	return NULL;
+}
+
+#undef NM_THREAD_SAFE_ON_MAIN_THREAD
+#define NM_THREAD_SAFE_ON_MAIN_THREAD 1
+
+static EthtoolCacheEntry *
+_ethtool_cache_lookup (NMPlatform *self,
+                       int ifindex,
+                       gboolean create)
+{
+	NMPlatformPrivate *priv = NM_PLATFORM_GET_PRIVATE (self);
+	EthtoolCacheEntry *entry;
+
+	if (priv->ethtool_cache) {
+		entry = g_hash_table_lookup (priv->ethtool_cache, &ifindex);
+		if (entry || !create)
+			return entry;
+	} else {
+		if (!create)
+			return NULL;
+		priv->ethtool_cache = g_hash_table_new_full (nm_pint_hash, nm_pint_equals, NULL, _ethtool_cache_entry_free);
+	}
+
+	entry = g_slice_new0 (EthtoolCacheEntry);
+	entry->ifindex = ifindex;
+	entry->gen = priv->ethtool_cache_gen;
+	g_hash_table_add (priv->ethtool_cache, entry);
+	return entry;
+}
+
+static void
+_ethtool_cache_invalidate (NMPlatform *self,
+                           int ifindex,
+                           NMPlatformEthtoolQueryFlags what)
+{
+	NMPlatformPrivate *priv = NM_PLATFORM_GET_PRIVATE (self);
+	EthtoolCacheEntry *entry;
+
+	entry = _ethtool_cache_lookup (self, ifindex, FALSE);
+	if (!entry)
+		return;
+
+	_ethtool_cache_entry_clear (entry, what);
+	entry->gen = ++priv->ethtool_cache_gen;
+}
+
+static void
+_ethtool_cache_link_changed (NMPlatform *self,
+                             NMPCacheOpsType cache_op,
+                             const NMPObject *obj_old,
+                             const NMPObject *obj_new)
+{
+	NMPlatformPrivate *priv = NM_PLATFORM_GET_PRIVATE (self);
+	NMPlatformEthtoolQueryFlags what;
+	int ifindex;
+
+	if (   !priv->ethtool_cache
+	    || g_hash_table_size (priv->ethtool_cache) == 0)
+		return;
+
+	switch (cache_op) {
+	case NMP_CACHE_OPS_REMOVED:
+		ifindex = NMP_OBJECT_CAST_LINK (obj_old)->ifindex;
+		g_hash_table_remove (priv->ethtool_cache, &ifindex);
+		return;
+	case NMP_CACHE_OPS_UPDATED:
+		what = ETHTOOL_QUERY_VOLATILE;
+		if (!nm_streq0 (NMP_OBJECT_CAST_LINK (obj_old)->driver,
+		                NMP_OBJECT_CAST_LINK (obj_new)->driver))
+			what = NM_PLATFORM_ETHTOOL_QUERY_ALL;
+		break;
+	default:
+		what = NM_PLATFORM_ETHTOOL_QUERY_ALL;
+		break;
+	}
+
+	_ethtool_cache_invalidate (self, NMP_OBJECT_CAST_LINK (obj_new)->ifindex, what);
+}
+
+/**
+ * nm_platform_ethtool_cache_link_event:
+ * @self: platform instance
+ * @ifindex: the interface
+ *
+ * The kernel announces changes to the features, the coalesce and the ring
+ * settings of a link (for example, by "ethtool -K") with a RTM_NEWLINK
+ * message. But the link in the cache is often unchanged by that message,
+ * so that no change signal invalidates the cached ethtool settings. The
+ * platform implementation calls this for every RTM_NEWLINK notification
+ * instead, but not for dumps or the replies to its own requests.
+ */
+void
+nm_platform_ethtool_cache_link_event (NMPlatform *self, int ifindex)
+{
+	_ethtool_cache_invalidate (self, ifindex, ETHTOOL_QUERY_VOLATILE);
+}
+
+/* Returns the entry with the results for @what, issuing the ethtool requests
+ * that are not yet cached. If the link is not in the platform cache, the
+ * results are returned in @tmp instead, which the caller must clear. */
+static const EthtoolCacheEntry *
+_ethtool_cache_get (NMPlatform *self,
+                    int ifindex,
+                    NMPlatformEthtoolQueryFlags what,
+                    EthtoolCacheEntry *tmp)
+{
+	nm_auto_pop_netns NMPNetns *netns = NULL;
+	EthtoolCacheEntry *entry;
+
+	nm_assert (tmp && tmp->valid == NM_PLATFORM_ETHTOOL_QUERY_NONE);
+
+	if (   ifindex > 0
+	    && nm_platform_link_get (self, ifindex))
+		entry = _ethtool_cache_lookup (self, ifindex, TRUE);
+	else {
+		tmp->ifindex = ifindex;
+		entry = tmp;
+	}
+
+	what &= ~entry->valid;
+	if (what == NM_PLATFORM_ETHTOOL_QUERY_NONE)
+		return entry;
+
+	if (!nm_platform_netns_push (self, &netns))
+		return NULL;
+
+	_ethtool_cache_entry_query (self, entry, what);
+	return entry;
+}
+
+/**
+ * nm_platform_link_ethtool_prefetch:
+ * @self: platform instance
+ * @ifindexes: the interfaces
+ * @len: the number of interfaces in @ifindexes
+ *
+ * Query the driver info and the permanent hardware address of all
+ * interfaces at once and add them to the cache, for realizing many devices
+ * at once. The ethtool requests are issued from several threads, so that a
+ * slow driver does not delay the others. This blocks until all requests
+ * are done.
+ */
+void
+nm_platform_link_ethtool_prefetch (NMPlatform *self,
+                                   const int *ifindexes,
+                                   guint len)
+{
+	gs_free EthtoolCacheEntry *entries = NULL;
+	GThread *threads[ETHTOOL_PREFETCH_MAX_THREADS - 1];
+	EthtoolPrefetchJob job;
+	guint n_entries;
+	guint n_threads;
+	guint i;
+
+	_CHECK_SELF_VOID (self, klass);
+
+	if (len == 0)
+		return;
+
+	entries = g_new0 (EthtoolCacheEntry, len);
+	n_entries = 0;
+	for (i = 0; i < len; i++) {
+		const EthtoolCacheEntry *entry;
+
+		if (!nm_platform_link_get (self, ifindexes[i]))
+			continue;
+		entry = _ethtool_cache_lookup (self, ifindexes[i], FALSE);
+		if (   entry
+		    && NM_FLAGS_ALL (entry->valid,   NM_PLATFORM_ETHTOOL_QUERY_DRIVER_INFO
+		                                   | NM_PLATFORM_ETHTOOL_QUERY_PERMANENT_ADDRESS))
+			continue;
+		entries[n_entries++].ifindex = ifindexes[i];
+	}
+
+	if (n_entries == 0)
+		return;
+
+	job = (EthtoolPrefetchJob) {
+		.self    = self,
+		.entries = entries,
+		.len     = n_entries,
+	};
+
+	/* one thread per 16 links, and the current thread helps out. Most
+	 * ioctls are fast, the threads are for the drivers that are not. */
+	n_threads = MIN ((n_entries + 15u) / 16u, (guint) ETHTOOL_PREFETCH_MAX_THREADS) - 1u;
+
+	_LOGD ("ethtool: prefetch driver info and permanent address of %u links (%u worker threads)",
+	       n_entries, n_threads);
+
+	for (i = 0; i < n_threads; i++)
+		threads[i] = g_thread_try_new ("nm-ethtool", _ethtool_prefetch_thread_fn, &job, NULL);
+
+	_ethtool_prefetch_thread_fn (&job);
+
+	for (i = 0; i < n_threads; i++) {
+		if (threads[i])
+			g_thread_join (threads[i]);
+	}
+
+	for (i = 0; i < n_entries; i++) {
+		_ethtool_cache_entry_merge (_ethtool_cache_lookup (self, entries[i].ifindex, TRUE),
+		                            &entries[i]);
+		_ethtool_cache_entry_clear_all (&entries[i]);
+	}
+}
+
+typedef struct {
+	NMPlatform *self;
+	EthtoolCacheEntry result;
+	guint64 gen;
+	NMPlatformEthtoolQueryFlags what;
+	NMPlatformAsyncCallback callback;
+	gpointer callback_data;
+} EthtoolQueryAsyncData;
+
+static void
+_ethtool_query_async_data_free (gpointer user_data)
+{
+	EthtoolQueryAsyncData *data = user_data;
+
+	_ethtool_cache_entry_clear_all (&data->result);
+	g_object_unref (data->self);
+	g_slice_free (EthtoolQueryAsyncData, data);
+}
+
+#undef NM_THREAD_SAFE_ON_MAIN_THREAD
+#define NM_THREAD_SAFE_ON_MAIN_THREAD 0
+
+static void
+_ethtool_query_async_thread_fn (GTask *task,
+                                gpointer source_object,
+                                gpointer task_data,
+                                GCancellable *cancellable)
+{
+	nm_auto_pop_netns NMPNetns *netns = NULL;
+	EthtoolQueryAsyncData *data = task_data;
+
+	if (g_task_return_error_if_cancelled (task))
+		return;
+
+	if (!nm_platform_netns_push (data->self, &netns)) {
+		g_task_return_new_error (task,
+		                         NM_UTILS_ERROR,
+		                         NM_UTILS_ERROR_UNKNOWN,
+		                         "ethtool: failed changing namespace");
+		return;
+	}
+
+	_ethtool_cache_entry_query (data->self, &data->result, data->what);
+	g_task_return_boolean (task, TRUE);
+}
+
+#undef NM_THREAD_SAFE_ON_MAIN_THREAD
+#define NM_THREAD_SAFE_ON_MAIN_THREAD 1
+
+static void
+_ethtool_query_async_cb (GObject *source,
+                         GAsyncResult *res,
+                         gpointer user_data)
+{
+	GTask *task = G_TASK (res);
+	EthtoolQueryAsyncData *data = g_task_get_task_data (task);
+	NMPlatform *self = data->self;
+	gs_free_error GError *error = NULL;
+	EthtoolCacheEntry *entry;
+
+	if (g_task_propagate_boolean (task, &error)) {
+		entry = _ethtool_cache_lookup (self, data->result.ifindex, FALSE);
+		if (!entry) {
+			/* the link is gone. */
+		} else if (entry->gen > data->gen) {
+			_LOGD ("ethtool[%d]: drop results of query, the link changed in the meantime",
+			       data->result.ifindex);
+		} else
+			_ethtool_cache_entry_merge (entry, &data->result);
+	}
+
+	if (data->callback)
+		data->callback (error, data->callback_data);
+}
+
+static void
+_ethtool_query_async_return_idle (gpointer user_data,
+                                  GCancellable *cancellable)
+{
+	gs_unref_object NMPlatform *self = NULL;
+	gs_free_error GError *cancelled_error = NULL;
+	gs_free_error GError *error = NULL;
+	NMPlatformAsyncCallback callback;
+	gpointer callback_data;
+
+	nm_utils_user_data_unpack (user_data, &self, &callback, &callback_data, &error);
+	g_cancellable_set_error_if_cancelled (cancellable, &cancelled_error);
+	callback (cancelled_error ?: error, callback_data);
+}
+
+/**
+ * nm_platform_link_ethtool_query_async:
+ * @self: platform instance
+ * @ifindex: the interface
+ * @what: the information to fetch
+ * @callback: (allow-none): function called on termination
+ * @callback_data: data passed to @callback
+ * @cancellable: to cancel the operation
+ *
+ * Issues the ethtool requests for @what on a worker thread and adds the
+ * results to the cache. Afterwards, nm_platform_link_get_driver_info(),
+ * nm_platform_link_get_permanent_address() and the nm_platform_ethtool_get_*()
+ * functions return without blocking, unless the link changed in the
+ * meantime. The callback is always invoked, and asynchronously.
+ */
+void
+nm_platform_link_ethtool_query_async (NMPlatform *self,
+                                      int ifindex,
+                                      NMPlatformEthtoolQueryFlags what,
+                                      NMPlatformAsyncCallback callback,
+                                      gpointer callback_data,
+                                      GCancellable *cancellable)
+{
+	NMPlatformPrivate *priv;
+	EthtoolQueryAsyncData *data;
+	EthtoolCacheEntry *entry;
+	GError *error = NULL;
+	GTask *task;
+
+	_CHECK_SELF_VOID (self, klass);
+
+	g_return_if_fail (ifindex > 0);
+	g_return_if_fail (!callback_data || callback);
+
+	priv = NM_PLATFORM_GET_PRIVATE (self);
+
+	if (!nm_platform_link_get (self, ifindex)) {
+		if (!callback)
+			return;
+		g_set_error (&error,
+		             NM_UTILS_ERROR,
+		             NM_UTILS_ERROR_UNKNOWN,
+		             "ethtool: link %d does not exist",
+		             ifindex);
+		nm_utils_invoke_on_idle (cancellable,
+		                         _ethtool_query_async_return_idle,
+		                         nm_utils_user_data_pack (g_object_ref (self),
+		                                                  callback,
+		                                                  callback_data,
+		                                                  error));
+		return;
+	}
+
+	/* create the entry right away, so that changes to the link while the
+	 * requests are pending invalidate the result. */
+	entry = _ethtool_cache_lookup (self, ifindex, TRUE);
+
+	what &= ~entry->valid;
+	if (what == NM_PLATFORM_ETHTOOL_QUERY_NONE) {
+		if (!callback)
+			return;
+		nm_utils_invoke_on_idle (cancellable,
+		                         _ethtool_query_async_return_idle,
+		                         nm_utils_user_data_pack (g_object_ref (self),
+		                                                  callback,
+		                                                  callback_data,
+		                                                  NULL));
+		return;
+	}
+
+	data = g_slice_new0 (EthtoolQueryAsyncData);
+	data->self = g_object_ref (self);
+	data->result.ifindex = ifindex;
+	data->gen = priv->ethtool_cache_gen;
+	data->what = what;
+	data->callback = callback;
+	data->callback_data = callback_data;
+
+	task = g_task_new (self, cancellable, _ethtool_query_async_cb, NULL);
+	g_task_set_task_data (task, data, _ethtool_query_async_data_free);
+	g_task_set_return_on_cancel (task, FALSE);
+	g_task_run_in_thread (task, _ethtool_query_async_thread_fn);
+	g_object_unref (task);
+}
+
+NMPlatformEthtoolQueryFlags
+_nmtst_platform_ethtool_cache_get_valid (NMPlatform *self, int ifindex)
+{
+	const EthtoolCacheEntry *entry;
+
+	entry = _ethtool_cache_lookup (self, ifindex, FALSE);
+	return entry ? entry->valid : NM_PLATFORM_ETHTOOL_QUERY_NONE;
+}
+
+/*****************************************************************************/
+
+/**
+ * nm_platform_link_get_permanent_address:
+ * @self: platform instance
+ * @ifindex: Interface index
+ * @buf: buffer of at least %NM_UTILS_HWADDR_LEN_MAX bytes, on success
+ * the permanent hardware address
+ * @length: Pointer to a variable to store address length
+ *
+ * Returns: %TRUE on success, %FALSE on failure to read the permanent hardware
+ * address.
+ */
+gboolean
+nm_platform_link_get_permanent_address (NMPlatform *self, int ifindex, guint8 *buf, size_t *length)
+{
+	nm_auto (_ethtool_cache_entry_clear_all) EthtoolCacheEntry tmp = { };
+	const EthtoolCacheEntry *entry;
+
+	_CHECK_SELF (self, klass, FALSE);
+
+	if (length)
+		*length = 0;
+
+	g_return_val_if_fail (ifindex > 0, FALSE);
+	g_return_val_if_fail (buf, FALSE);
+	g_return_val_if_fail (length, FALSE);
+
+	entry = _ethtool_cache_get (self, ifindex, NM_PLATFORM_ETHTOOL_QUERY_PERMANENT_ADDRESS, &tmp);
+	if (   !entry
+	    || !entry->permanent_address_success)
+		return FALSE;
+
+	memcpy (buf, entry->permanent_address, entry->permanent_address_len);
+	*length = entry->permanent_address_len;
+	return TRUE;
+}
+
+gboolean
+nm_platform_link_supports_carrier_detect (NMPlatform *self, int ifindex)
+{
+	_CHECK_SELF (self, klass, FALSE);
+
+	g_return_val_if_fail (ifindex >= 0, FALSE);
+
+	return klass->link_supports_carrier_detect (self, ifindex);
+}
+
+gboolean
+nm_platform_link_supports_vlans (NMPlatform *self, int ifindex)
+{
+	_CHECK_SELF (self, klass, FALSE);
+
+	g_return_val_if_fail (ifindex >= 0, FALSE);
+
+	return klass->link_supports_vlans (self, ifindex);
+}
+
+gboolean
+nm_platform_link_supports_sriov (NMPlatform *self, int ifindex)
+{
+	_CHECK_SELF (self, klass, FALSE);
+
+	g_return_val_if_fail (ifindex >= 0, FALSE);
+
+	return klass->link_supports_sriov (self, ifindex);
+}
+
+/**
+ * nm_platform_link_set_sriov_params:
+ * @self: platform instance
+ * @ifindex: the index of the interface to change
+ * @num_vfs: the number of VFs to create
+ * @autoprobe: the new autoprobe-drivers value (pass
+ *     %NM_TERNARY_DEFAULT to keep current value)
+ * @callback: called when the operation finishes
+ * @callback_data: data passed to @callback
+ * @cancellable: cancellable to abort the operation
+ *
+ * Sets SR-IOV parameters asynchronously without
+ * blocking the main thread. The callback function is
+ * always invoked, and asynchronously.
+ */
+void
+nm_platform_link_set_sriov_params_async (NMPlatform *self,
+                                         int ifindex,
+                                         guint num_vfs,
+                                         NMTernary autoprobe,
+                                         NMPlatformAsyncCallback callback,
+                                         gpointer callback_data,
+                                         GCancellable *cancellable)
+{
+	_CHECK_SELF_VOID (self, klass);
+
+	g_return_if_fail (ifindex > 0);
 
 	_LOG3D ("link: setting %u total VFs and autoprobe %d", num_vfs, (int) autoprobe);
 	klass->link_set_sriov_params_async (self,
@@ -1863,6 +2691,53 @@ nm_platform_link_set_up (NMPlatform *self, int ifindex, gboolean *out_no_firmwar
 	return klass->link_set_up (self, ifindex, out_no_firmware);
 }
 
+/**
+ * nm_platform_link_set_up_many:
+ * @self: platform instance
+ * @ifindexes: the interfaces to bring up
+ * @len: the number of interfaces in @ifindexes
+ * @out_results: (out): an array of @len elements. For each interface,
+ *   it receives zero on success or a negative NMErrno. A missing firmware
+ *   is reported as -NME_PL_NO_FIRMWARE.
+ *
+ * Like calling nm_platform_link_set_up() for each interface, but the
+ * platform implementation may pipeline the requests.
+ */
+void
+nm_platform_link_set_up_many (NMPlatform *self,
+                              const int *ifindexes,
+                              guint len,
+                              int *out_results)
+{
+	guint i;
+
+	_CHECK_SELF_VOID (self, klass);
+
+	nm_assert (out_results);
+
+	if (len == 0)
+		return;
+
+	for (i = 0; i < len; i++)
+		g_return_if_fail (ifindexes[i] > 0);
+
+	_LOGD ("link: setting up %u links", len);
+
+	if (!klass->link_set_up_many) {
+		for (i = 0; i < len; i++) {
+			gboolean no_firmware = FALSE;
+
+			if (klass->link_set_up (self, ifindexes[i], &no_firmware))
+				out_results[i] = 0;
+			else
+				out_results[i] = no_firmware ? -NME_PL_NO_FIRMWARE : -NME_UNSPEC;
+		}
+		return;
+	}
+
+	klass->link_set_up_many (self, ifindexes, len, out_results);
+}
+
 /**
  * nm_platform_link_set_down:
  * @self: platform instance
@@ -2065,15 +2940,22 @@ nm_platform_link_get_driver_info (NMPlatform *self,
                                   char **out_driver_version,
                                   char **out_fw_version)
 {
+	nm_auto (_ethtool_cache_entry_clear_all) EthtoolCacheEntry tmp = { };
+	const EthtoolCacheEntry *entry;
+
 	_CHECK_SELF (self, klass, FALSE);
 
 	g_return_val_if_fail (ifindex >= 0, FALSE);
 
-	return klass->link_get_driver_info (self,
-	                                    ifindex,
-	                                    out_driver_name,
-	                                    out_driver_version,
-	                                    out_fw_version);
+	entry = _ethtool_cache_get (self, ifindex, NM_PLATFORM_ETHTOOL_QUERY_DRIVER_INFO, &tmp);
+	if (   !entry
+	    || !entry->driver_info_success)
+		return FALSE;
+
+	NM_SET_OUT (out_driver_name,    g_strdup (entry->driver_name));
+	NM_SET_OUT (out_driver_version, g_strdup (entry->driver_version));
+	NM_SET_OUT (out_fw_version,     g_strdup (entry->fw_version));
+	return TRUE;
 }
 
 /**
@@ -3217,11 +4099,19 @@ NM_UTILS_LOOKUP_STR_DEFINE (nm_platform_link_duplex_type_to_string, NMPlatformLi
 NMEthtoolFeatureStates *
 nm_platform_ethtool_get_link_features (NMPlatform *self, int ifindex)
 {
-	_CHECK_SELF_NETNS (self, klass, netns, NULL);
+	nm_auto (_ethtool_cache_entry_clear_all) EthtoolCacheEntry tmp = { };
+	const EthtoolCacheEntry *entry;
+
+	_CHECK_SELF (self, klass, NULL);
 
 	g_return_val_if_fail (ifindex > 0, NULL);
 
-	return nmp_utils_ethtool_get_features (ifindex);
+	entry = _ethtool_cache_get (self, ifindex, NM_PLATFORM_ETHTOOL_QUERY_FEATURES, &tmp);
+	if (!entry)
+		return NULL;
+	if (entry == &tmp)
+		return g_steal_pointer (&tmp.features);
+	return nmp_utils_ethtool_features_dup (entry->features);
 }
 
 gboolean
@@ -3231,11 +4121,15 @@ nm_platform_ethtool_set_features (NMPlatform *self,
                                   const NMTernary *requested /* indexed by NMEthtoolID - _NM_ETHTOOL_ID_FEATURE_FIRST */,
                                   gboolean do_set /* or reset */)
 {
+	gboolean success;
+
 	_CHECK_SELF_NETNS (self, klass, netns, FALSE);
 
 	g_return_val_if_fail (ifindex > 0, FALSE);
 
-	return nmp_utils_ethtool_set_features (ifindex, features, requested, do_set);
+	success = nmp_utils_ethtool_set_features (ifindex, features, requested, do_set);
+	_ethtool_cache_invalidate (self, ifindex, NM_PLATFORM_ETHTOOL_QUERY_FEATURES);
+	return success;
 }
 
 gboolean
@@ -3243,12 +4137,21 @@ nm_platform_ethtool_get_link_coalesce (NMPlatform *self,
                                        int ifindex,
                                        NMEthtoolCoalesceState *coalesce)
 {
-	_CHECK_SELF_NETNS (self, klass, netns, FALSE);
+	nm_auto (_ethtool_cache_entry_clear_all) EthtoolCacheEntry tmp = { };
+	const EthtoolCacheEntry *entry;
+
+	_CHECK_SELF (self, klass, FALSE);
 
 	g_return_val_if_fail (ifindex > 0, FALSE);
 	g_return_val_if_fail (coalesce, FALSE);
 
-	return nmp_utils_ethtool_get_coalesce (ifindex, coalesce);
+	entry = _ethtool_cache_get (self, ifindex, NM_PLATFORM_ETHTOOL_QUERY_COALESCE, &tmp);
+	if (   !entry
+	    || !entry->coalesce_success)
+		return FALSE;
+
+	*coalesce = entry->coalesce;
+	return TRUE;
 }
 
 gboolean
@@ -3256,11 +4159,15 @@ nm_platform_ethtool_set_coalesce (NMPlatform *self,
                                   int ifindex,
                                   const NMEthtoolCoalesceState *coalesce)
 {
+	gboolean success;
+
 	_CHECK_SELF_NETNS (self, klass, netns, FALSE);
 
 	g_return_val_if_fail (ifindex > 0, FALSE);
 
-	return nmp_utils_ethtool_set_coalesce (ifindex, coalesce);
+	success = nmp_utils_ethtool_set_coalesce (ifindex, coalesce);
+	_ethtool_cache_invalidate (self, ifindex, NM_PLATFORM_ETHTOOL_QUERY_COALESCE);
+	return success;
 }
 
 gboolean
@@ -3268,12 +4175,21 @@ nm_platform_ethtool_get_link_ring (NMPlatform *self,
                                    int ifindex,
                                    NMEthtoolRingState *ring)
 {
-	_CHECK_SELF_NETNS (self, klass, netns, FALSE);
+	nm_auto (_ethtool_cache_entry_clear_all) EthtoolCacheEntry tmp = { };
+	const EthtoolCacheEntry *entry;
+
+	_CHECK_SELF (self, klass, FALSE);
 
 	g_return_val_if_fail (ifindex > 0, FALSE);
 	g_return_val_if_fail (ring, FALSE);
 
-	return nmp_utils_ethtool_get_ring (ifindex, ring);
+	entry = _ethtool_cache_get (self, ifindex, NM_PLATFORM_ETHTOOL_QUERY_RING, &tmp);
+	if (   !entry
+	    || !entry->ring_success)
+		return FALSE;
+
+	*ring = entry->ring;
+	return TRUE;
 }
 
 gboolean
@@ -3281,11 +4197,103 @@ nm_platform_ethtool_set_ring (NMPlatform *self,
                               int ifindex,
                               const NMEthtoolRingState *ring)
 {
+	gboolean success;
+
 	_CHECK_SELF_NETNS (self, klass, netns, FALSE);
 
 	g_return_val_if_fail (ifindex > 0, FALSE);
 
-	return nmp_utils_ethtool_set_ring (ifindex, ring);
+	success = nmp_utils_ethtool_set_ring (ifindex, ring);
+	_ethtool_cache_invalidate (self, ifindex, NM_PLATFORM_ETHTOOL_QUERY_RING);
+	return success;
+}
+
+/*****************************************************************************/
+
+static NMPCacheSnapshot *
+_cache_snapshot_refresh (NMPlatform *self)
+{
+	NMPlatformPrivate *priv = NM_PLATFORM_GET_PRIVATE (self);
+	nm_auto_unref_nmp_cache_snapshot NMPCacheSnapshot *snapshot_old = NULL;
+	NMPCacheSnapshot *snapshot;
+
+	nm_assert (priv->snapshot_owner == g_thread_self ());
+
+	/* only the owner thread sets @snapshot, so we only need to lock
+	 * for publishing it. */
+	if (   !priv->snapshot
+	    || nmp_cache_snapshot_get_version (priv->snapshot) != nmp_cache_get_version (priv->cache)) {
+		snapshot = nmp_cache_snapshot_new (priv->cache, priv->snapshot);
+
+		g_mutex_lock (&priv->snapshot_lock);
+		snapshot_old = priv->snapshot;
+		priv->snapshot = snapshot;
+		g_mutex_unlock (&priv->snapshot_lock);
+
+		_LOGt ("cache snapshot: publish version %u", nmp_cache_snapshot_get_version (snapshot));
+	}
+
+	return nmp_cache_snapshot_ref (priv->snapshot);
+}
+
+static gboolean
+_cache_snapshot_refresh_cb (gpointer user_data)
+{
+	NMPlatform *self = user_data;
+	NMPlatformPrivate *priv = NM_PLATFORM_GET_PRIVATE (self);
+
+	g_mutex_lock (&priv->snapshot_lock);
+	nm_clear_pointer (&priv->snapshot_refresh_source, g_source_unref);
+	g_mutex_unlock (&priv->snapshot_lock);
+
+	nmp_cache_snapshot_unref (_cache_snapshot_refresh (self));
+	return G_SOURCE_REMOVE;
+}
+
+/**
+ * nm_platform_cache_snapshot_get:
+ * @self: the platform instance
+ *
+ * Get a consistent read-only view of the platform cache, which other threads
+ * can iterate without locking, while the cache keeps being updated.
+ *
+ * On the thread that owns @self, the snapshot is always up to date. On other
+ * threads, the last published snapshot is returned, which may be older than
+ * the cache. Compare nmp_cache_snapshot_get_version() to notice that. In that
+ * case, a new snapshot gets published by the owner thread once its main
+ * context runs.
+ *
+ * This function is thread-safe.
+ *
+ * Returns: (transfer full) (nullable): the snapshot. On other threads, %NULL
+ *   if no snapshot was published yet.
+ */
+NMPCacheSnapshot *
+nm_platform_cache_snapshot_get (NMPlatform *self)
+{
+	NMPlatformPrivate *priv;
+	NMPCacheSnapshot *snapshot;
+
+	g_return_val_if_fail (NM_IS_PLATFORM (self), NULL);
+
+	priv = NM_PLATFORM_GET_PRIVATE (self);
+
+	if (priv->snapshot_owner == g_thread_self ())
+		return _cache_snapshot_refresh (self);
+
+	g_mutex_lock (&priv->snapshot_lock);
+	snapshot = priv->snapshot ? nmp_cache_snapshot_ref (priv->snapshot) : NULL;
+	if (   !priv->snapshot_refresh_source
+	    && (   !snapshot
+	        || nmp_cache_snapshot_get_version (snapshot) != nmp_cache_get_version (priv->cache))) {
+		priv->snapshot_refresh_source = g_idle_source_new ();
+		g_source_set_priority (priv->snapshot_refresh_source, G_PRIORITY_DEFAULT);
+		g_source_set_callback (priv->snapshot_refresh_source, _cache_snapshot_refresh_cb, self, NULL);
+		g_source_attach (priv->snapshot_refresh_source, priv->snapshot_context);
+	}
+	g_mutex_unlock (&priv->snapshot_lock);
+
+	return snapshot;
 }
 
 /*****************************************************************************/
@@ -3504,6 +4512,262 @@ nm_platform_ip6_address_delete (NMPlatform *self, int ifindex, struct in6_addr a
 	return klass->ip6_address_delete (self, ifindex, address, plen);
 }
 
+static gboolean
+_ip_address_many_validate (int addr_family,
+                           const NMPlatformIPAddress *a,
+                           gboolean for_add)
+{
+	g_return_val_if_fail (a->ifindex > 0, FALSE);
+	g_return_val_if_fail (a->plen <= (addr_family == AF_INET ? 32 : 128), FALSE);
+	if (for_add) {
+		g_return_val_if_fail (a->lifetime > 0, FALSE);
+		g_return_val_if_fail (a->preferred <= a->lifetime, FALSE);
+	}
+	return TRUE;
+}
+
+/* Passes the valid addresses of @addresses to @func, which must set the
+ * result for each of them. The invalid ones fail. */
+static gboolean
+_ip_address_many_dispatch (NMPlatform *self,
+                           int addr_family,
+                           const NMPlatformIPXAddress *addresses,
+                           guint len,
+                           gboolean *out_results,
+                           gboolean for_add,
+                           void (*func) (NMPlatform *self,
+                                         int addr_family,
+                                         const NMPlatformIPXAddress *addresses,
+                                         guint len,
+                                         gboolean *out_results))
+{
+	const gboolean IS_IPv4 = (addr_family == AF_INET);
+	gs_free NMPlatformIPXAddress *valid_free = NULL;
+	gs_free gboolean *valid_results_free = NULL;
+	gs_free guint *valid_idx = NULL;
+	const NMPlatformIPXAddress *valid;
+	gboolean *valid_results;
+	gboolean success = TRUE;
+	guint n_valid;
+	guint i;
+
+	n_valid = 0;
+	for (i = 0; i < len; i++) {
+		out_results[i] = FALSE;
+		if (!_ip_address_many_validate (addr_family, &addresses[i].ax, for_add)) {
+			if (!valid_idx) {
+				valid_idx = g_new (guint, len);
+				valid_free = g_new (NMPlatformIPXAddress, len);
+				for (n_valid = 0; n_valid < i; n_valid++) {
+					valid_idx[n_valid] = n_valid;
+					valid_free[n_valid] = addresses[n_valid];
+				}
+			}
+			continue;
+		}
+		if (valid_idx) {
+			valid_idx[n_valid] = i;
+			valid_free[n_valid] = addresses[i];
+		}
+		n_valid++;
+	}
+
+	if (valid_idx) {
+		valid = valid_free;
+		valid_results = (valid_results_free = g_new (gboolean, NM_MAX (n_valid, 1u)));
+	} else {
+		valid = addresses;
+		valid_results = out_results;
+	}
+
+	for (i = 0; i < n_valid; i++) {
+		int ifindex = valid[i].ax.ifindex;
+
+		_LOG3D ("address: %s IPv%c address: %s (batch %u/%u)",
+		        for_add ? "adding or updating" : "deleting",
+		        nm_utils_addr_family_to_char (addr_family),
+		          IS_IPv4
+		        ? nm_platform_ip4_address_to_string (&valid[i].a4, NULL, 0)
+		        : nm_platform_ip6_address_to_string (&valid[i].a6, NULL, 0),
+		        i + 1, n_valid);
+	}
+
+	if (n_valid > 0)
+		func (self, addr_family, valid, n_valid, valid_results);
+
+	if (valid_idx) {
+		for (i = 0; i < n_valid; i++)
+			out_results[valid_idx[i]] = valid_results[i];
+	}
+
+	for (i = 0; i < len; i++)
+		success &= out_results[i];
+	return success;
+}
+
+static void
+_ip_address_add_many_fallback (NMPlatform *self,
+                               int addr_family,
+                               const NMPlatformIPXAddress *addresses,
+                               guint len,
+                               gboolean *out_results)
+{
+	guint i;
+
+	for (i = 0; i < len; i++) {
+		if (addr_family == AF_INET) {
+			const NMPlatformIP4Address *a = &addresses[i].a4;
+
+			out_results[i] = nm_platform_ip4_address_add (self,
+			                                              a->ifindex,
+			                                              a->address,
+			                                              a->plen,
+			                                              a->peer_address,
+			                                              a->broadcast_address,
+			                                              a->lifetime,
+			                                              a->preferred,
+			                                              a->n_ifa_flags,
+			                                              a->label);
+		} else {
+			const NMPlatformIP6Address *a = &addresses[i].a6;
+
+			out_results[i] = nm_platform_ip6_address_add (self,
+			                                              a->ifindex,
+			                                              a->address,
+			                                              a->plen,
+			                                              a->peer_address,
+			                                              a->lifetime,
+			                                              a->preferred,
+			                                              a->n_ifa_flags);
+		}
+	}
+}
+
+static void
+_ip_address_delete_many_fallback (NMPlatform *self,
+                                  int addr_family,
+                                  const NMPlatformIPXAddress *addresses,
+                                  guint len,
+                                  gboolean *out_results)
+{
+	guint i;
+
+	for (i = 0; i < len; i++) {
+		if (addr_family == AF_INET) {
+			const NMPlatformIP4Address *a = &addresses[i].a4;
+
+			out_results[i] = nm_platform_ip4_address_delete (self, a->ifindex, a->address, a->plen, a->peer_address);
+		} else {
+			const NMPlatformIP6Address *a = &addresses[i].a6;
+
+			out_results[i] = nm_platform_ip6_address_delete (self, a->ifindex, a->address, a->plen);
+		}
+	}
+}
+
+/**
+ * nm_platform_ip_address_add_many:
+ * @self: the #NMPlatform instance
+ * @addr_family: either AF_INET or AF_INET6
+ * @addresses: the addresses to add or update. The lifetime and preferred
+ *   lifetime are relative to now and the timestamp is ignored. For IPv4,
+ *   the broadcast address and label are sent as they are.
+ * @len: the number of @addresses
+ * @out_results: (out): for each address, whether it was added successfully.
+ *
+ * Like calling nm_platform_ip4_address_add() or nm_platform_ip6_address_add()
+ * for each address, in order. The platform may send all requests at once and
+ * only afterwards wait for the replies. Invalid addresses are not sent
+ * and fail, without affecting the others.
+ *
+ * Returns: %TRUE if all addresses were added.
+ */
+gboolean
+nm_platform_ip_address_add_many (NMPlatform *self,
+                                 int addr_family,
+                                 const NMPlatformIPXAddress *addresses,
+                                 guint len,
+                                 gboolean *out_results)
+{
+	_CHECK_SELF (self, klass, FALSE);
+
+	g_return_val_if_fail (NM_IN_SET (addr_family, AF_INET, AF_INET6), FALSE);
+	g_return_val_if_fail (len == 0 || (addresses && out_results), FALSE);
+
+	if (!klass->ip_address_add_many) {
+		/* the per-address functions do their own logging. */
+		guint i;
+		gboolean success = TRUE;
+
+		for (i = 0; i < len; i++) {
+			out_results[i] = FALSE;
+			if (_ip_address_many_validate (addr_family, &addresses[i].ax, TRUE))
+				_ip_address_add_many_fallback (self, addr_family, &addresses[i], 1, &out_results[i]);
+			success &= out_results[i];
+		}
+		return success;
+	}
+
+	return _ip_address_many_dispatch (self,
+	                                  addr_family,
+	                                  addresses,
+	                                  len,
+	                                  out_results,
+	                                  TRUE,
+	                                  klass->ip_address_add_many);
+}
+
+/**
+ * nm_platform_ip_address_delete_many:
+ * @self: the #NMPlatform instance
+ * @addr_family: either AF_INET or AF_INET6
+ * @addresses: the addresses to delete. Only the fields that identify
+ *   the address are used.
+ * @len: the number of @addresses
+ * @out_results: (out): for each address, whether it was deleted (or was
+ *   already gone).
+ *
+ * Like calling nm_platform_ip4_address_delete() or nm_platform_ip6_address_delete()
+ * for each address, in order. The platform may send all requests at once and
+ * only afterwards wait for the replies. Invalid addresses are not sent
+ * and fail, without affecting the others.
+ *
+ * Returns: %TRUE if all addresses were deleted.
+ */
+gboolean
+nm_platform_ip_address_delete_many (NMPlatform *self,
+                                    int addr_family,
+                                    const NMPlatformIPXAddress *addresses,
+                                    guint len,
+                                    gboolean *out_results)
+{
+	_CHECK_SELF (self, klass, FALSE);
+
+	g_return_val_if_fail (NM_IN_SET (addr_family, AF_INET, AF_INET6), FALSE);
+	g_return_val_if_fail (len == 0 || (addresses && out_results), FALSE);
+
+	if (!klass->ip_address_delete_many) {
+		guint i;
+		gboolean success = TRUE;
+
+		for (i = 0; i < len; i++) {
+			out_results[i] = FALSE;
+			if (_ip_address_many_validate (addr_family, &addresses[i].ax, FALSE))
+				_ip_address_delete_many_fallback (self, addr_family, &addresses[i], 1, &out_results[i]);
+			success &= out_results[i];
+		}
+		return success;
+	}
+
+	return _ip_address_many_dispatch (self,
+	                                  addr_family,
+	                                  addresses,
+	                                  len,
+	                                  out_results,
+	                                  FALSE,
+	                                  klass->ip_address_delete_many);
+}
+
 const NMPlatformIP4Address *
 nm_platform_ip4_address_get (NMPlatform *self, int ifindex, in_addr_t address, guint8 plen, guint32 peer_address)
 {
@@ -3773,6 +5037,11 @@ nm_platform_ip4_address_sync (NMPlatform *self,
 	GHashTable *plat_subnets = NULL;
 	GHashTable *known_subnets = NULL;
 	gs_unref_hashtable GHashTable *known_addresses_idx = NULL;
+	gs_unref_array GArray *addrs_delete = NULL;
+	gs_free NMPlatformIPXAddress *addrs_add = NULL;
+	gs_free guint *addrs_add_idx = NULL;
+	gs_free gboolean *results = NULL;
+	guint addrs_add_len;
 	guint i, j, len;
 	NMPLookup lookup;
 	guint32 lifetime, preferred;
@@ -3788,15 +5057,19 @@ nm_platform_ip4_address_sync (NMPlatform *self,
 	                                                                   NMP_OBJECT_TYPE_IP4_ADDRESS,
 	                                                                   ifindex),
 	                                           NULL, NULL);
-	if (plat_addresses)
+	if (plat_addresses) {
 		plat_subnets = ip4_addr_subnets_build_index (plat_addresses, TRUE, TRUE);
+		addrs_delete = g_array_new (FALSE, FALSE, sizeof (NMPlatformIPXAddress));
+	}
 
-	/* Delete unknown addresses */
+	/* Delete unknown addresses. The deletions are collected and sent as one
+	 * batch below, in the same order. */
 	len = plat_addresses ? plat_addresses->len : 0;
 	for (i = 0; i < len; i++) {
 		const NMPObject *plat_obj;
 		const NMPlatformIP4Address *plat_address;
 		const GPtrArray *addr_list;
+		NMPlatformIPXAddress addr_delete;
 
 		plat_obj = plat_addresses->pdata[i];
 		if (!plat_obj) {
@@ -3825,10 +5098,8 @@ nm_platform_ip4_address_sync (NMPlatform *self,
 			}
 		}
 
-		nm_platform_ip4_address_delete (self, ifindex,
-		                                plat_address->address,
-		                                plat_address->plen,
-		                                plat_address->peer_address);
+		addr_delete = (NMPlatformIPXAddress) { .a4 = *plat_address };
+		g_array_append_val (addrs_delete, addr_delete);
 
 		if (   !ip4_addr_subnets_is_secondary (plat_obj, plat_subnets, plat_addresses, &addr_list)
 		    && addr_list) {
@@ -3845,13 +5116,8 @@ nm_platform_ip4_address_sync (NMPlatform *self,
 				nm_assert (o);
 
 				if (*o) {
-					const NMPlatformIP4Address *a;
-
-					a = NMP_OBJECT_CAST_IP4_ADDRESS (*o);
-					nm_platform_ip4_address_delete (self, ifindex,
-					                                a->address,
-					                                a->plen,
-					                                a->peer_address);
+					addr_delete = (NMPlatformIPXAddress) { .a4 = *NMP_OBJECT_CAST_IP4_ADDRESS (*o) };
+					g_array_append_val (addrs_delete, addr_delete);
 					nmp_object_unref (*o);
 					*o = NULL;
 				}
@@ -3860,6 +5126,17 @@ nm_platform_ip4_address_sync (NMPlatform *self,
 	}
 	ip4_addr_subnets_destroy_index (plat_subnets, plat_addresses);
 
+	if (   addrs_delete
+	    && addrs_delete->len > 0) {
+		results = g_new (gboolean, addrs_delete->len);
+		nm_platform_ip_address_delete_many (self,
+		                                    AF_INET,
+		                                    &g_array_index (addrs_delete, NMPlatformIPXAddress, 0),
+		                                    addrs_delete->len,
+		                                    results);
+		nm_clear_g_free (&results);
+	}
+
 	if (!known_addresses)
 		return TRUE;
 
@@ -3869,9 +5146,14 @@ nm_platform_ip4_address_sync (NMPlatform *self,
 	            ? IFA_F_NOPREFIXROUTE
 	            : 0;
 
-	/* Add missing addresses */
+	/* Add missing addresses. They are sent as one batch, in the order
+	 * of @known_addresses. */
+	addrs_add = g_new (NMPlatformIPXAddress, known_addresses->len);
+	addrs_add_idx = g_new (guint, known_addresses->len);
+	addrs_add_len = 0;
 	for (i = 0; i < known_addresses->len; i++) {
 		const NMPObject *o;
+		NMPlatformIP4Address *a;
 
 		o = known_addresses->pdata[i];
 		if (!o)
@@ -3881,25 +5163,35 @@ nm_platform_ip4_address_sync (NMPlatform *self,
 
 		lifetime = nm_utils_lifetime_get (known_address->timestamp, known_address->lifetime, known_address->preferred,
 		                                  now, &preferred);
-		if (!lifetime)
-			goto delete_and_next2;
-
-		if (!nm_platform_ip4_address_add (self,
-		                                  ifindex,
-		                                  known_address->address,
-		                                  known_address->plen,
-		                                  known_address->peer_address,
-		                                  nm_platform_ip4_broadcast_address_from_addr (known_address),
-		                                  lifetime,
-		                                  preferred,
-		                                  ifa_flags,
-		                                  known_address->label))
-			goto delete_and_next2;
+		if (!lifetime) {
+			nmp_object_unref (o);
+			known_addresses->pdata[i] = NULL;
+			continue;
+		}
 
-		continue;
-delete_and_next2:
-		nmp_object_unref (o);
-		known_addresses->pdata[i] = NULL;
+		a = &addrs_add[addrs_add_len].a4;
+		*a = *known_address;
+		a->ifindex = ifindex;
+		a->timestamp = 0;
+		a->lifetime = lifetime;
+		a->preferred = preferred;
+		a->n_ifa_flags = ifa_flags;
+		a->broadcast_address = nm_platform_ip4_broadcast_address_from_addr (known_address);
+		a->use_ip4_broadcast_address = TRUE;
+		addrs_add_idx[addrs_add_len++] = i;
+	}
+
+	if (addrs_add_len == 0)
+		return TRUE;
+
+	results = g_new (gboolean, addrs_add_len);
+	nm_platform_ip_address_add_many (self, AF_INET, addrs_add, addrs_add_len, results);
+
+	for (i = 0; i < addrs_add_len; i++) {
+		if (results[i])
+			continue;
+		nmp_object_unref (known_addresses->pdata[addrs_add_idx[i]]);
+		known_addresses->pdata[addrs_add_idx[i]] = NULL;
 	}
 
 	return TRUE;
@@ -3970,6 +5262,9 @@ nm_platform_ip6_address_sync (NMPlatform *self,
 	gint32 now = nm_utils_get_monotonic_timestamp_sec ();
 	guint i_plat, i_know;
 	gs_unref_hashtable GHashTable *known_addresses_idx = NULL;
+	gs_free NMPlatformIPXAddress *addrs = NULL;
+	gs_free gboolean *results = NULL;
+	guint addrs_len;
 	NMPLookup lookup;
 	guint32 ifa_flags;
 
@@ -4000,6 +5295,11 @@ nm_platform_ip6_address_sync (NMPlatform *self,
 
 		known_addresses_len = known_addresses ? known_addresses->len : 0;
 
+		/* Each platform address is deleted at most once. The deletions don't depend
+		 * on each other, so they are collected and sent as one batch below. */
+		addrs = g_new (NMPlatformIPXAddress, plat_addresses->len);
+		addrs_len = 0;
+
 		/* First, compare every address whether it is still a "known address", that is, whether
 		 * to keep it or to delete it.
 		 *
@@ -4039,7 +5339,7 @@ nm_platform_ip6_address_sync (NMPlatform *self,
 				}
 			}
 
-			nm_platform_ip6_address_delete (self, ifindex, plat_addr->address, plat_addr->plen);
+			addrs[addrs_len++].a6 = *plat_addr;
 clear_and_next:
 			nmp_object_unref (g_steal_pointer (&plat_addresses->pdata[i_plat]));
 		}
@@ -4098,10 +5398,17 @@ clear_and_next:
 				}
 			}
 
-			nm_platform_ip6_address_delete (self, ifindex, plat_addr->address, plat_addr->plen);
+			addrs[addrs_len++].a6 = *plat_addr;
 next_plat:
 			;
 		}
+
+		if (addrs_len > 0) {
+			results = g_new (gboolean, addrs_len);
+			nm_platform_ip_address_delete_many (self, AF_INET6, addrs, addrs_len, results);
+			nm_clear_g_free (&results);
+		}
+		nm_clear_g_free (&addrs);
 	}
 
 	if (!known_addresses)
@@ -4113,9 +5420,15 @@ next_plat:
 
 	/* Add missing addresses. New addresses are added by kernel with top
 	 * priority.
+	 *
+	 * All additions are sent as one batch. Contrary to adding them one by one,
+	 * a failure does not prevent the following addresses from being sent.
 	 */
+	addrs = g_new (NMPlatformIPXAddress, known_addresses->len);
+	addrs_len = 0;
 	for (i_know = 0; i_know < known_addresses->len; i_know++) {
 		const NMPlatformIP6Address *known_address = NMP_OBJECT_CAST_IP6_ADDRESS (known_addresses->pdata[i_know]);
+		NMPlatformIP6Address *a;
 		guint32 lifetime, preferred;
 
 		if (!known_address)
@@ -4123,15 +5436,27 @@ next_plat:
 
 		lifetime = nm_utils_lifetime_get (known_address->timestamp, known_address->lifetime, known_address->preferred,
 		                                  now, &preferred);
+		if (!lifetime) {
+			/* expired meanwhile. Like for IPv4, drop it instead of failing the batch. */
+			nmp_object_unref (known_addresses->pdata[i_know]);
+			known_addresses->pdata[i_know] = NULL;
+			continue;
+		}
 
-		if (!nm_platform_ip6_address_add (self, ifindex, known_address->address,
-		                                  known_address->plen, known_address->peer_address,
-		                                  lifetime, preferred,
-		                                  ifa_flags | known_address->n_ifa_flags))
-			return FALSE;
+		a = &addrs[addrs_len++].a6;
+		*a = *known_address;
+		a->ifindex = ifindex;
+		a->timestamp = 0;
+		a->lifetime = lifetime;
+		a->preferred = preferred;
+		a->n_ifa_flags = ifa_flags | known_address->n_ifa_flags;
 	}
 
-	return TRUE;
+	if (addrs_len == 0)
+		return TRUE;
+
+	results = g_new (gboolean, addrs_len);
+	return nm_platform_ip_address_add_many (self, AF_INET6, addrs, addrs_len, results);
 }
 
 gboolean
@@ -4270,9 +5595,12 @@ nm_platform_ip_route_sync (NMPlatform *self,
 {
 	const NMPlatformVTableRoute *vt;
 	gs_unref_hashtable GHashTable *routes_idx = NULL;
+	gs_free const NMPObject **routes_add = NULL;
+	gs_free int *routes_add_results = NULL;
 	const NMPObject *conf_o;
 	const NMDedupMultiEntry *plat_entry;
 	guint i;
+	guint routes_add_len;
 	int i_type;
 	gboolean success = TRUE;
 	char sbuf1[sizeof (_nm_utils_to_string_buffer)];
@@ -4285,11 +5613,17 @@ nm_platform_ip_route_sync (NMPlatform *self,
 
 	vt = &nm_platform_vtable_route.vx[IS_IPv4];
 
+	if (routes && routes->len > 0) {
+		routes_add = g_new (const NMPObject *, routes->len);
+		routes_add_results = g_new (int, routes->len);
+	}
+
 	for (i_type = 0; routes && i_type < 2; i_type++) {
+		/* First collect all the routes that need adding. We add them with one
+		 * batched request below, which avoids a round trip to kernel for each
+		 * route. */
+		routes_add_len = 0;
 		for (i = 0; i < routes->len; i++) {
-			int r, r2;
-			gboolean gateway_route_added = FALSE;
-
 			conf_o = routes->pdata[i];
 
 #define VTABLE_IS_DEVICE_ROUTE(vt, o) (vt->is_ip4 \
@@ -4334,109 +5668,127 @@ nm_platform_ip_route_sync (NMPlatform *self,
 				}
 			}
 
-sync_route_add:
-			r = nm_platform_ip_route_add (self,
-			                                NMP_NLM_FLAG_APPEND
-			                              | NMP_NLM_FLAG_SUPPRESS_NETLINK_FAILURE,
-			                              conf_o);
-			if (r < 0) {
-				if (r == -EEXIST) {
-					/* Don't fail for EEXIST. It's not clear that the existing route
-					 * is identical to the one that we were about to add. However,
-					 * above we should have deleted conflicting (non-identical) routes. */
-					if (_LOGD_ENABLED ()) {
-						plat_entry = nm_platform_lookup_entry (self,
-						                                       NMP_CACHE_ID_TYPE_OBJECT_TYPE,
-						                                       conf_o);
-						if (!plat_entry) {
-							_LOG3D ("route-sync: adding route %s failed with EEXIST, however we cannot find such a route",
-							        nmp_object_to_string (conf_o, NMP_OBJECT_TO_STRING_PUBLIC, sbuf1, sizeof (sbuf1)));
-						} else if (vt->route_cmp (NMP_OBJECT_CAST_IPX_ROUTE (conf_o),
-						                          NMP_OBJECT_CAST_IPX_ROUTE (plat_entry->obj),
-						                          NM_PLATFORM_IP_ROUTE_CMP_TYPE_SEMANTICALLY) != 0) {
-							_LOG3D ("route-sync: adding route %s failed due to existing (different!) route %s",
-							        nmp_object_to_string (conf_o, NMP_OBJECT_TO_STRING_PUBLIC, sbuf1, sizeof (sbuf1)),
-							        nmp_object_to_string (plat_entry->obj, NMP_OBJECT_TO_STRING_PUBLIC, sbuf2, sizeof (sbuf2)));
-						}
-					}
-				} else if (NMP_OBJECT_CAST_IP_ROUTE (conf_o)->rt_source < NM_IP_CONFIG_SOURCE_USER) {
-					_LOG3D ("route-sync: ignore failure to add IPv%c route: %s: %s",
-					       vt->is_ip4 ? '4' : '6',
-					       nmp_object_to_string (conf_o, NMP_OBJECT_TO_STRING_PUBLIC, sbuf1, sizeof (sbuf1)),
-					       nm_strerror (r));
-				} else if (   r == -EINVAL
-				           && out_temporary_not_available
-				           && _err_inval_due_to_ipv6_tentative_pref_src (self, conf_o)) {
-					_LOG3D ("route-sync: ignore failure to add IPv6 route with tentative IPv6 pref-src: %s: %s",
-					        nmp_object_to_string (conf_o, NMP_OBJECT_TO_STRING_PUBLIC, sbuf1, sizeof (sbuf1)),
-					        nm_strerror (r));
-					if (!*out_temporary_not_available)
-						*out_temporary_not_available = g_ptr_array_new_full (0, (GDestroyNotify) nmp_object_unref);
-					g_ptr_array_add (*out_temporary_not_available, (gpointer) nmp_object_ref (conf_o));
-				} else if (   !gateway_route_added
-				           && (   (   r == -ENETUNREACH
-				                   && vt->is_ip4
-				                   && !!NMP_OBJECT_CAST_IP4_ROUTE (conf_o)->gateway)
-				               || (   r == -EHOSTUNREACH
-				                   && !vt->is_ip4
-				                   && !IN6_IS_ADDR_UNSPECIFIED (&NMP_OBJECT_CAST_IP6_ROUTE (conf_o)->gateway)))) {
-					NMPObject oo;
-
-					if (vt->is_ip4) {
-						const NMPlatformIP4Route *rt = NMP_OBJECT_CAST_IP4_ROUTE (conf_o);
-
-						nmp_object_stackinit (&oo,
-						                      NMP_OBJECT_TYPE_IP4_ROUTE,
-						                      &((NMPlatformIP4Route) {
-						                          .ifindex = rt->ifindex,
-						                          .network = rt->gateway,
-						                          .plen = 32,
-						                          .metric = rt->metric,
-						                          .rt_source = rt->rt_source,
-						                          .table_coerced = rt->table_coerced,
-						                      }));
-					} else {
-						const NMPlatformIP6Route *rt = NMP_OBJECT_CAST_IP6_ROUTE (conf_o);
-
-						nmp_object_stackinit (&oo,
-						                      NMP_OBJECT_TYPE_IP6_ROUTE,
-						                      &((NMPlatformIP6Route) {
-						                          .ifindex = rt->ifindex,
-						                          .network = rt->gateway,
-						                          .plen = 128,
-						                          .metric = rt->metric,
-						                          .rt_source = rt->rt_source,
-						                          .table_coerced = rt->table_coerced,
-						                      }));
-					}
+			routes_add[routes_add_len++] = conf_o;
+		}
 
-					_LOG3D ("route-sync: failure to add IPv%c route: %s: %s; try adding direct route to gateway %s",
-					        vt->is_ip4 ? '4' : '6',
-					        nmp_object_to_string (conf_o, NMP_OBJECT_TO_STRING_PUBLIC, sbuf1, sizeof (sbuf1)),
-					        nm_strerror (r),
-					        nmp_object_to_string (&oo, NMP_OBJECT_TO_STRING_PUBLIC, sbuf2, sizeof (sbuf2)));
+		nm_platform_ip_route_add_many (self,
+		                                 NMP_NLM_FLAG_APPEND
+		                               | NMP_NLM_FLAG_SUPPRESS_NETLINK_FAILURE,
+		                               routes_add,
+		                               routes_add_len,
+		                               routes_add_results);
 
-					r2 = nm_platform_ip_route_add (self,
-					                                 NMP_NLM_FLAG_APPEND
-					                               | NMP_NLM_FLAG_SUPPRESS_NETLINK_FAILURE,
-					                               &oo);
+		for (i = 0; i < routes_add_len; i++) {
+			gboolean gateway_route_added = FALSE;
+			int r, r2;
+
+			conf_o = routes_add[i];
+			r = routes_add_results[i];
+
+sync_route_check:
+			if (r >= 0)
+				continue;
 
-					if (r2 < 0) {
-						_LOG3D ("route-sync: failure to add gateway IPv%c route: %s: %s",
-						        vt->is_ip4 ? '4' : '6',
+			if (r == -EEXIST) {
+				/* Don't fail for EEXIST. It's not clear that the existing route
+				 * is identical to the one that we were about to add. However,
+				 * above we should have deleted conflicting (non-identical) routes. */
+				if (_LOGD_ENABLED ()) {
+					plat_entry = nm_platform_lookup_entry (self,
+					                                       NMP_CACHE_ID_TYPE_OBJECT_TYPE,
+					                                       conf_o);
+					if (!plat_entry) {
+						_LOG3D ("route-sync: adding route %s failed with EEXIST, however we cannot find such a route",
+						        nmp_object_to_string (conf_o, NMP_OBJECT_TO_STRING_PUBLIC, sbuf1, sizeof (sbuf1)));
+					} else if (vt->route_cmp (NMP_OBJECT_CAST_IPX_ROUTE (conf_o),
+					                          NMP_OBJECT_CAST_IPX_ROUTE (plat_entry->obj),
+					                          NM_PLATFORM_IP_ROUTE_CMP_TYPE_SEMANTICALLY) != 0) {
+						_LOG3D ("route-sync: adding route %s failed due to existing (different!) route %s",
 						        nmp_object_to_string (conf_o, NMP_OBJECT_TO_STRING_PUBLIC, sbuf1, sizeof (sbuf1)),
-						        nm_strerror (r2));
+						        nmp_object_to_string (plat_entry->obj, NMP_OBJECT_TO_STRING_PUBLIC, sbuf2, sizeof (sbuf2)));
 					}
-
-					gateway_route_added = TRUE;
-					goto sync_route_add;
+				}
+			} else if (NMP_OBJECT_CAST_IP_ROUTE (conf_o)->rt_source < NM_IP_CONFIG_SOURCE_USER) {
+				_LOG3D ("route-sync: ignore failure to add IPv%c route: %s: %s",
+				       vt->is_ip4 ? '4' : '6',
+				       nmp_object_to_string (conf_o, NMP_OBJECT_TO_STRING_PUBLIC, sbuf1, sizeof (sbuf1)),
+				       nm_strerror (r));
+			} else if (   r == -EINVAL
+			           && out_temporary_not_available
+			           && _err_inval_due_to_ipv6_tentative_pref_src (self, conf_o)) {
+				_LOG3D ("route-sync: ignore failure to add IPv6 route with tentative IPv6 pref-src: %s: %s",
+				        nmp_object_to_string (conf_o, NMP_OBJECT_TO_STRING_PUBLIC, sbuf1, sizeof (sbuf1)),
+				        nm_strerror (r));
+				if (!*out_temporary_not_available)
+					*out_temporary_not_available = g_ptr_array_new_full (0, (GDestroyNotify) nmp_object_unref);
+				g_ptr_array_add (*out_temporary_not_available, (gpointer) nmp_object_ref (conf_o));
+			} else if (   !gateway_route_added
+			           && (   (   r == -ENETUNREACH
+			                   && vt->is_ip4
+			                   && !!NMP_OBJECT_CAST_IP4_ROUTE (conf_o)->gateway)
+			               || (   r == -EHOSTUNREACH
+			                   && !vt->is_ip4
+			                   && !IN6_IS_ADDR_UNSPECIFIED (&NMP_OBJECT_CAST_IP6_ROUTE (conf_o)->gateway)))) {
+				NMPObject oo;
+
+				if (vt->is_ip4) {
+					const NMPlatformIP4Route *rt = NMP_OBJECT_CAST_IP4_ROUTE (conf_o);
+
+					nmp_object_stackinit (&oo,
+					                      NMP_OBJECT_TYPE_IP4_ROUTE,
+					                      &((NMPlatformIP4Route) {
+					                          .ifindex = rt->ifindex,
+					                          .network = rt->gateway,
+					                          .plen = 32,
+					                          .metric = rt->metric,
+					                          .rt_source = rt->rt_source,
+					                          .table_coerced = rt->table_coerced,
+					                      }));
 				} else {
-					_LOG3W ("route-sync: failure to add IPv%c route: %s: %s",
-					       vt->is_ip4 ? '4' : '6',
-					       nmp_object_to_string (conf_o, NMP_OBJECT_TO_STRING_PUBLIC, sbuf1, sizeof (sbuf1)),
-					       nm_strerror (r));
-					success = FALSE;
+					const NMPlatformIP6Route *rt = NMP_OBJECT_CAST_IP6_ROUTE (conf_o);
+
+					nmp_object_stackinit (&oo,
+					                      NMP_OBJECT_TYPE_IP6_ROUTE,
+					                      &((NMPlatformIP6Route) {
+					                          .ifindex = rt->ifindex,
+					                          .network = rt->gateway,
+					                          .plen = 128,
+					                          .metric = rt->metric,
+					                          .rt_source = rt->rt_source,
+					                          .table_coerced = rt->table_coerced,
+					                      }));
+				}
+
+				_LOG3D ("route-sync: failure to add IPv%c route: %s: %s; try adding direct route to gateway %s",
+				        vt->is_ip4 ? '4' : '6',
+				        nmp_object_to_string (conf_o, NMP_OBJECT_TO_STRING_PUBLIC, sbuf1, sizeof (sbuf1)),
+				        nm_strerror (r),
+				        nmp_object_to_string (&oo, NMP_OBJECT_TO_STRING_PUBLIC, sbuf2, sizeof (sbuf2)));
+
+				r2 = nm_platform_ip_route_add (self,
+				                                 NMP_NLM_FLAG_APPEND
+				                               | NMP_NLM_FLAG_SUPPRESS_NETLINK_FAILURE,
+				                               &oo);
+
+				if (r2 < 0) {
+					_LOG3D ("route-sync: failure to add gateway IPv%c route: %s: %s",
+					        vt->is_ip4 ? '4' : '6',
+					        nmp_object_to_string (conf_o, NMP_OBJECT_TO_STRING_PUBLIC, sbuf1, sizeof (sbuf1)),
+					        nm_strerror (r2));
 				}
+
+				gateway_route_added = TRUE;
+				r = nm_platform_ip_route_add (self,
+				                                NMP_NLM_FLAG_APPEND
+				                              | NMP_NLM_FLAG_SUPPRESS_NETLINK_FAILURE,
+				                              conf_o);
+				goto sync_route_check;
+			} else {
+				_LOG3W ("route-sync: failure to add IPv%c route: %s: %s",
+				       vt->is_ip4 ? '4' : '6',
+				       nmp_object_to_string (conf_o, NMP_OBJECT_TO_STRING_PUBLIC, sbuf1, sizeof (sbuf1)),
+				       nm_strerror (r));
+				success = FALSE;
 			}
 		}
 	}
@@ -4642,20 +5994,86 @@ nm_platform_ip6_route_add (NMPlatform *self,
 	return _ip_route_add (self, flags, AF_INET6, route);
 }
 
-gboolean
-nm_platform_object_delete (NMPlatform *self,
-                           const NMPObject *obj)
+/**
+ * nm_platform_ip_route_add_many:
+ * @self: the #NMPlatform instance
+ * @flags: the flags for adding the routes, like for nm_platform_ip_route_add().
+ * @routes: the routes to add. All routes must be of the same address family.
+ * @len: the number of routes in @routes.
+ * @out_results: (out): an array of @len elements. For each route, it receives
+ *   the result as nm_platform_ip_route_add() would return it.
+ *
+ * Adds the routes in order, like calling nm_platform_ip_route_add() for each
+ * of them. The difference is that the platform implementation may pipeline
+ * the requests and wait for the replies of a whole batch at once, instead of
+ * waiting for the kernel's reply after each request.
+ */
+void
+nm_platform_ip_route_add_many (NMPlatform *self,
+                               NMPNlmFlags flags,
+                               const NMPObject *const*routes,
+                               guint len,
+                               int *out_results)
 {
-	int ifindex;
+	char sbuf[sizeof (_nm_utils_to_string_buffer)];
+	int addr_family;
+	guint i;
 
-	_CHECK_SELF (self, klass, FALSE);
+	_CHECK_SELF_VOID (self, klass);
+
+	nm_assert (out_results);
+
+	if (len == 0)
+		return;
+
+	switch (NMP_OBJECT_GET_TYPE (routes[0])) {
+	case NMP_OBJECT_TYPE_IP4_ROUTE:
+		addr_family = AF_INET;
+		break;
+	case NMP_OBJECT_TYPE_IP6_ROUTE:
+		addr_family = AF_INET6;
+		break;
+	default:
+		g_return_if_reached ();
+	}
+
+	if (!klass->ip_route_add_many) {
+		for (i = 0; i < len; i++) {
+			nm_assert (NMP_OBJECT_GET_TYPE (routes[i]) == NMP_OBJECT_GET_TYPE (routes[0]));
+			out_results[i] = _ip_route_add (self, flags, addr_family, NMP_OBJECT_CAST_IP_ROUTE (routes[i]));
+		}
+		return;
+	}
+
+	if (_LOGD_ENABLED ()) {
+		for (i = 0; i < len; i++) {
+			int ifindex = NMP_OBJECT_CAST_IP_ROUTE (routes[i])->ifindex;
+
+			nm_assert (NMP_OBJECT_GET_TYPE (routes[i]) == NMP_OBJECT_GET_TYPE (routes[0]));
+			_LOG3D ("route: %-10s IPv%c route: %s (batch %u/%u)",
+			        _nmp_nlm_flag_to_string (flags & NMP_NLM_FLAG_FMASK),
+			        nm_utils_addr_family_to_char (addr_family),
+			        nmp_object_to_string (routes[i], NMP_OBJECT_TO_STRING_PUBLIC, sbuf, sizeof (sbuf)),
+			        i + 1,
+			        len);
+		}
+	}
+
+	klass->ip_route_add_many (self, flags, addr_family, routes, len, out_results);
+}
+
+static gboolean
+_object_delete_check_and_log (NMPlatform *self,
+                              const NMPObject *obj)
+{
+	int ifindex;
 
 	switch (NMP_OBJECT_GET_TYPE (obj)) {
 	case NMP_OBJECT_TYPE_ROUTING_RULE:
 		_LOGD ("%s: delete %s",
 		       NMP_OBJECT_GET_CLASS (obj)->obj_type_name,
 		       nmp_object_to_string (obj, NMP_OBJECT_TO_STRING_PUBLIC, NULL, 0));
-		break;
+		return TRUE;
 	case NMP_OBJECT_TYPE_IP4_ROUTE:
 	case NMP_OBJECT_TYPE_IP6_ROUTE:
 	case NMP_OBJECT_TYPE_QDISC:
@@ -4664,14 +6082,64 @@ nm_platform_object_delete (NMPlatform *self,
 		_LOG3D ("%s: delete %s",
 		        NMP_OBJECT_GET_CLASS (obj)->obj_type_name,
 		        nmp_object_to_string (obj, NMP_OBJECT_TO_STRING_PUBLIC, NULL, 0));
-		break;
+		return TRUE;
 	default:
-		g_return_val_if_reached (FALSE);
+		return FALSE;
 	}
+}
+
+gboolean
+nm_platform_object_delete (NMPlatform *self,
+                           const NMPObject *obj)
+{
+	_CHECK_SELF (self, klass, FALSE);
+
+	if (!_object_delete_check_and_log (self, obj))
+		g_return_val_if_reached (FALSE);
 
 	return klass->object_delete (self, obj);
 }
 
+/**
+ * nm_platform_object_delete_many:
+ * @self: the #NMPlatform instance
+ * @objs: the objects to delete.
+ * @len: the number of objects in @objs.
+ * @out_results: (out): an array of @len elements. For each object, it
+ *   receives the result as nm_platform_object_delete() would return it.
+ *
+ * Like calling nm_platform_object_delete() for each object, but the
+ * platform implementation may pipeline the requests.
+ */
+void
+nm_platform_object_delete_many (NMPlatform *self,
+                                const NMPObject *const*objs,
+                                guint len,
+                                gboolean *out_results)
+{
+	guint i;
+
+	_CHECK_SELF_VOID (self, klass);
+
+	nm_assert (out_results);
+
+	if (len == 0)
+		return;
+
+	if (!klass->object_delete_many) {
+		for (i = 0; i < len; i++)
+			out_results[i] = nm_platform_object_delete (self, objs[i]);
+		return;
+	}
+
+	for (i = 0; i < len; i++) {
+		if (!_object_delete_check_and_log (self, objs[i]))
+			g_return_if_reached ();
+	}
+
+	klass->object_delete_many (self, objs, len, out_results);
+}
+
 /*****************************************************************************/
 
 int
@@ -4996,6 +6464,190 @@ nm_platform_ip4_dev_route_blacklist_set (NMPlatform *self,
 
 /*****************************************************************************/
 
+static gboolean
+_route_cache_scope_protocol_is_reserved (guint8 rtm_protocol)
+{
+	/* these are the protocols that NetworkManager itself uses (or that
+	 * kernel uses for routes that NetworkManager cares about). */
+	return NM_IN_SET (rtm_protocol, RTPROT_UNSPEC,
+	                                RTPROT_REDIRECT,
+	                                RTPROT_KERNEL,
+	                                RTPROT_BOOT,
+	                                RTPROT_STATIC,
+	                                RTPROT_RA,
+	                                RTPROT_DHCP);
+}
+
+static int
+_route_cache_scope_table_cmp (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+	NM_CMP_DIRECT (*((const guint32 *) a), *((const guint32 *) b));
+	return 0;
+}
+
+/**
+ * nm_platform_route_cache_scope_set:
+ * @self: the #NMPlatform instance
+ * @ignore_protocols: (allow-none): the route protocols (rtm_protocol) to ignore
+ * @n_ignore_protocols: number of entries in @ignore_protocols
+ * @ignore_tables: (allow-none): the routing tables to ignore
+ * @n_ignore_tables: number of entries in @ignore_tables
+ *
+ * On hosts that run a routing daemon (like bird or FRR), the kernel may have
+ * hundreds of thousands of routes that NetworkManager does not care about.
+ * Keeping them all in the platform cache costs memory and CPU for every
+ * notification. This configures a scope for the route cache: routes that
+ * have one of the ignored protocols or that are in one of the ignored tables
+ * are dropped before they get parsed and are only counted.
+ *
+ * Protocols and tables that NetworkManager uses itself (like "kernel", "static",
+ * "dhcp", "ra" and the "main" and "local" tables) cannot be ignored. They are
+ * skipped and a warning is logged.
+ *
+ * An ignored route that replaces a route in the cache (NLM_F_REPLACE) still
+ * removes the replaced route from the cache.
+ *
+ * When the scope changes, the IPv4 and IPv6 routes are re-dumped so that
+ * the cache content reflects the new scope.
+ *
+ * Returns: %TRUE if the scope changed.
+ */
+gboolean
+nm_platform_route_cache_scope_set (NMPlatform *self,
+                                   const guint8 *ignore_protocols,
+                                   guint n_ignore_protocols,
+                                   const guint32 *ignore_tables,
+                                   guint n_ignore_tables)
+{
+	NMPlatformPrivate *priv;
+	guint32 protocols[G_N_ELEMENTS (priv->route_scope_ignore_protocols)] = { };
+	gs_free guint32 *tables = NULL;
+	guint tables_len = 0;
+	guint i;
+	_CHECK_SELF (self, klass, FALSE);
+
+	priv = NM_PLATFORM_GET_PRIVATE (self);
+
+	for (i = 0; i < n_ignore_protocols; i++) {
+		guint8 p = ignore_protocols[i];
+
+		if (_route_cache_scope_protocol_is_reserved (p)) {
+			_LOGW ("route-cache-scope: cannot ignore reserved route protocol %u", (guint) p);
+			continue;
+		}
+		protocols[p / 32] |= (((guint32) 1) << (p % 32));
+	}
+
+	if (n_ignore_tables > 0) {
+		tables = g_new (guint32, n_ignore_tables);
+		for (i = 0; i < n_ignore_tables; i++) {
+			guint32 t = ignore_tables[i];
+
+			if (NM_IN_SET (t, RT_TABLE_UNSPEC, RT_TABLE_MAIN, RT_TABLE_LOCAL)) {
+				_LOGW ("route-cache-scope: cannot ignore reserved route table %u", (guint) t);
+				continue;
+			}
+			tables[tables_len++] = t;
+		}
+		if (tables_len > 1) {
+			guint j;
+
+			g_qsort_with_data (tables, tables_len, sizeof (guint32), _route_cache_scope_table_cmp, NULL);
+			for (i = 1, j = 1; i < tables_len; i++) {
+				if (tables[i] != tables[j - 1])
+					tables[j++] = tables[i];
+			}
+			tables_len = j;
+		}
+	}
+
+	if (   memcmp (protocols, priv->route_scope_ignore_protocols, sizeof (protocols)) == 0
+	    && tables_len == priv->route_scope_ignore_tables_len
+	    && (   tables_len == 0
+	        || memcmp (tables, priv->route_scope_ignore_tables, tables_len * sizeof (guint32)) == 0))
+		return FALSE;
+
+	memcpy (priv->route_scope_ignore_protocols, protocols, sizeof (protocols));
+	nm_clear_g_free (&priv->route_scope_ignore_tables);
+	if (tables_len > 0)
+		priv->route_scope_ignore_tables = g_steal_pointer (&tables);
+	priv->route_scope_ignore_tables_len = tables_len;
+
+	priv->route_scope_active = (tables_len > 0);
+	for (i = 0; i < G_N_ELEMENTS (protocols); i++) {
+		if (protocols[i] != 0)
+			priv->route_scope_active = TRUE;
+	}
+
+	_LOGD ("route-cache-scope: %s (ignoring %u tables)",
+	       priv->route_scope_active ? "restricted" : "unrestricted",
+	       tables_len);
+
+	/* re-dump the routes. Routes that are no longer in scope get pruned from
+	 * the cache, routes that became in scope get added. */
+	if (klass->refresh_all) {
+		klass->refresh_all (self, NMP_OBJECT_TYPE_IP4_ROUTE);
+		klass->refresh_all (self, NMP_OBJECT_TYPE_IP6_ROUTE);
+	}
+	return TRUE;
+}
+
+/**
+ * nm_platform_route_cache_scope_ignores:
+ * @self: the #NMPlatform instance
+ * @rtm_protocol: the protocol of the route
+ * @table: the (full) routing table of the route
+ *
+ * This is called by the platform implementations for each route notification
+ * before parsing it. If the route is outside the configured scope, it gets
+ * counted.
+ *
+ * Returns: %TRUE if the route is not to be kept in the cache.
+ */
+gboolean
+nm_platform_route_cache_scope_ignores (NMPlatform *self,
+                                       guint8 rtm_protocol,
+                                       guint32 table)
+{
+	NMPlatformPrivate *priv = NM_PLATFORM_GET_PRIVATE (self);
+
+	if (!priv->route_scope_active)
+		return FALSE;
+
+	if (!NM_FLAGS_ANY (priv->route_scope_ignore_protocols[rtm_protocol / 32],
+	                   (((guint32) 1) << (rtm_protocol % 32)))) {
+		guint lo = 0;
+		guint hi = priv->route_scope_ignore_tables_len;
+
+		while (TRUE) {
+			guint mid;
+
+			if (lo >= hi)
+				return FALSE;
+			mid = lo + ((hi - lo) / 2);
+			if (priv->route_scope_ignore_tables[mid] == table)
+				break;
+			if (priv->route_scope_ignore_tables[mid] < table)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+	}
+
+	priv->route_scope_n_ignored++;
+	return TRUE;
+}
+
+guint64
+nm_platform_route_cache_scope_get_n_ignored (NMPlatform *self)
+{
+	_CHECK_SELF (self, klass, 0);
+
+	return NM_PLATFORM_GET_PRIVATE (self)->route_scope_n_ignored;
+}
+
+/*****************************************************************************/
+
 int
 nm_platform_routing_rule_add (NMPlatform *self,
                               NMPNlmFlags flags,
@@ -5009,6 +6661,53 @@ nm_platform_routing_rule_add (NMPlatform *self,
 	return klass->routing_rule_add (self, flags, routing_rule);
 }
 
+/**
+ * nm_platform_routing_rule_add_many:
+ * @self: the #NMPlatform instance
+ * @flags: the flags for adding the rules.
+ * @objs: the routing rules (of type %NMP_OBJECT_TYPE_ROUTING_RULE) to add.
+ * @len: the number of objects in @objs.
+ * @out_results: (out): an array of @len elements. For each rule, it
+ *   receives the result as nm_platform_routing_rule_add() would return it.
+ *
+ * Adds the rules in order. The platform implementation may pipeline
+ * the requests.
+ */
+void
+nm_platform_routing_rule_add_many (NMPlatform *self,
+                                   NMPNlmFlags flags,
+                                   const NMPObject *const*objs,
+                                   guint len,
+                                   int *out_results)
+{
+	char sbuf[sizeof (_nm_utils_to_string_buffer)];
+	guint i;
+
+	_CHECK_SELF_VOID (self, klass);
+
+	nm_assert (out_results);
+
+	if (len == 0)
+		return;
+
+	if (!klass->routing_rule_add_many) {
+		for (i = 0; i < len; i++)
+			out_results[i] = nm_platform_routing_rule_add (self, flags, NMP_OBJECT_CAST_ROUTING_RULE (objs[i]));
+		return;
+	}
+
+	if (_LOGD_ENABLED ()) {
+		for (i = 0; i < len; i++) {
+			_LOGD ("routing-rule: adding or updating: %s (batch %u/%u)",
+			       nm_platform_routing_rule_to_string (NMP_OBJECT_CAST_ROUTING_RULE (objs[i]), sbuf, sizeof (sbuf)),
+			       i + 1,
+			       len);
+		}
+	}
+
+	klass->routing_rule_add_many (self, flags, objs, len, out_results);
+}
+
 /*****************************************************************************/
 
 int
@@ -5026,6 +6725,33 @@ nm_platform_qdisc_add (NMPlatform *self,
 	return klass->qdisc_add (self, flags, qdisc);
 }
 
+static void
+_tc_sync_commit (NMPlatform *self,
+                 const NMPObject *const*objs_del,
+                 guint n_del,
+                 const NMPObject *const*objs_add,
+                 guint n_add,
+                 gboolean *success)
+{
+	guint i;
+
+	if (n_del > 0) {
+		gs_free gboolean *results = g_new (gboolean, n_del);
+
+		nm_platform_object_delete_many (self, objs_del, n_del, results);
+		for (i = 0; i < n_del; i++)
+			*success &= results[i];
+	}
+
+	if (n_add > 0) {
+		gs_free int *results = g_new (int, n_add);
+
+		nm_platform_tc_add_many (self, NMP_NLM_FLAG_REPLACE, objs_add, n_add, results);
+		for (i = 0; i < n_add; i++)
+			*success &= (results[i] >= 0);
+	}
+}
+
 /**
  * nm_platform_qdisc_sync:
  * @self: the #NMPlatform instance
@@ -5038,6 +6764,11 @@ nm_platform_qdisc_add (NMPlatform *self,
  * caller to pass NMPlatformQdisc instances which "kind" string
  * have a limited lifetime.
  *
+ * Only qdiscs that differ from what is configured are touched. A qdisc
+ * that changed is replaced in place (RTM_NEWQDISC with NLM_F_REPLACE),
+ * so that the interface does not lose its traffic control setup in
+ * between. The requests are sent in batches.
+ *
  * Returns: %TRUE on success.
  */
 gboolean
@@ -5050,6 +6781,11 @@ nm_platform_qdisc_sync (NMPlatform *self,
 	guint i;
 	gboolean success = TRUE;
 	gs_unref_hashtable GHashTable *known_qdiscs_idx = NULL;
+	gs_free const NMPObject **objs_del = NULL;
+	gs_free const NMPObject **objs_add = NULL;
+	guint n_del = 0;
+	guint n_add = 0;
+	gboolean replaced = FALSE;
 
 	nm_assert (NM_IS_PLATFORM (self));
 	nm_assert (ifindex > 0);
@@ -5074,6 +6810,8 @@ nm_platform_qdisc_sync (NMPlatform *self,
 	                                                                ifindex),
 	                                        NULL, NULL);
 	if (plat_qdiscs) {
+		objs_del = g_new (const NMPObject *, plat_qdiscs->len);
+
 		for (i = 0; i < plat_qdiscs->len; i++) {
 			const NMPObject *p = g_ptr_array_index (plat_qdiscs, i);
 			const NMPObject *k;
@@ -5085,58 +6823,239 @@ nm_platform_qdisc_sync (NMPlatform *self,
 				const NMPlatformQdisc *qdisc_k = NMP_OBJECT_CAST_QDISC (k);
 				const NMPlatformQdisc *qdisc_p = NMP_OBJECT_CAST_QDISC (p);
 
-				/* check other fields */
-				if (   nm_platform_qdisc_cmp_full (qdisc_k, qdisc_p, FALSE) != 0
-				    || (   qdisc_k->handle != qdisc_p->handle
-				        && qdisc_k != 0)) {
-					k = NULL;
-				}
-			}
+				if (   nm_platform_qdisc_cmp_full (qdisc_k, qdisc_p, FALSE) == 0
+				    && (   qdisc_k->handle == qdisc_p->handle
+				        || qdisc_k->handle == 0)) {
+					/* already configured as desired. */
+					g_hash_table_remove (known_qdiscs_idx, k);
+				} else {
+					/* differs. It gets replaced below. */
+					replaced = TRUE;
+				}
+				continue;
+			}
+
+			/* can't delete qdisc with zero handle */
+			if (TC_H_MAJ (p->qdisc.handle) != 0)
+				objs_del[n_del++] = p;
+		}
+	}
+
+	if (known_qdiscs) {
+		gs_unref_hashtable GHashTable *touched_handles = NULL;
+
+		objs_add = g_new (const NMPObject *, known_qdiscs->len);
+
+		/* When a classful qdisc gets replaced, kernel destroys the qdiscs below
+		 * it. So, also (re-)add the children of every qdisc that we add. That
+		 * works in one pass, because parents must come before their children
+		 * in @known_qdiscs anyway. */
+		for (i = 0; i < known_qdiscs->len; i++) {
+			const NMPObject *q = g_ptr_array_index (known_qdiscs, i);
+			guint32 handle_maj;
+
+			if (   !g_hash_table_contains (known_qdiscs_idx, q)
+			    && (   !touched_handles
+			        || !g_hash_table_contains (touched_handles,
+			                                   GUINT_TO_POINTER (TC_H_MAJ (q->qdisc.parent)))))
+				continue;
+
+			objs_add[n_add++] = q;
+
+			handle_maj = TC_H_MAJ (q->qdisc.handle);
+			if (handle_maj != 0) {
+				if (!touched_handles)
+					touched_handles = g_hash_table_new (nm_direct_hash, NULL);
+				g_hash_table_add (touched_handles, GUINT_TO_POINTER (handle_maj));
+			}
+		}
+	}
+
+	_tc_sync_commit (self, objs_del, n_del, objs_add, n_add, &success);
+
+	if (   (   n_del > 0
+	        || replaced)
+	    && NM_PLATFORM_GET_CLASS (self)->refresh_all) {
+		/* Deleting or replacing a qdisc also destroys the qdiscs below it and
+		 * the filters attached to it, but kernel sends no notifications for
+		 * them. Refetch, so that the cache (and a following
+		 * nm_platform_tfilter_sync()) sees the current state. */
+		NM_PLATFORM_GET_CLASS (self)->refresh_all (self, NMP_OBJECT_TYPE_QDISC);
+		NM_PLATFORM_GET_CLASS (self)->refresh_all (self, NMP_OBJECT_TYPE_TFILTER);
+	}
+
+	return success;
+}
+
+/*****************************************************************************/
+
+int
+nm_platform_tfilter_add (NMPlatform *self,
+                         NMPNlmFlags flags,
+                         const NMPlatformTfilter *tfilter)
+{
+	int ifindex = tfilter->ifindex;
+	_CHECK_SELF (self, klass, -NME_BUG);
+
+	/* Note: @tfilter must not be copied or kept alive because the lifetime of tfilter.kind
+	 * and tfilter.action.kind is undefined. */
+
+	_LOG3D ("adding or updating a tfilter: %s", nm_platform_tfilter_to_string (tfilter, NULL, 0));
+	return klass->tfilter_add (self, flags, tfilter);
+}
+
+/**
+ * nm_platform_tc_add_many:
+ * @self: the #NMPlatform instance
+ * @flags: the flags for adding the objects.
+ * @objs: the qdiscs and tfilters to add.
+ * @len: the number of objects in @objs.
+ * @out_results: (out): an array of @len elements. For each object, it
+ *   receives the result as nm_platform_qdisc_add() or nm_platform_tfilter_add()
+ *   would return it.
+ *
+ * Adds the qdiscs and tfilters in order. The platform implementation may
+ * pipeline the requests and wait for the kernel's replies of a whole batch
+ * at once.
+ *
+ * Like for nm_platform_qdisc_add(), the objects are not kept alive after
+ * the function returns.
+ */
+void
+nm_platform_tc_add_many (NMPlatform *self,
+                         NMPNlmFlags flags,
+                         const NMPObject *const*objs,
+                         guint len,
+                         int *out_results)
+{
+	char sbuf[sizeof (_nm_utils_to_string_buffer)];
+	guint i;
+
+	_CHECK_SELF_VOID (self, klass);
+
+	nm_assert (out_results);
 
-			if (k) {
-				g_hash_table_remove (known_qdiscs_idx, k);
-			} else {
-				/* can't delete qdisc with zero handle */
-				if (TC_H_MAJ (p->qdisc.handle) != 0) {
-					success &= nm_platform_object_delete (self, p);
-				}
+	if (len == 0)
+		return;
+
+	if (!klass->tc_add_many) {
+		for (i = 0; i < len; i++) {
+			if (NMP_OBJECT_GET_TYPE (objs[i]) == NMP_OBJECT_TYPE_QDISC)
+				out_results[i] = nm_platform_qdisc_add (self, flags, NMP_OBJECT_CAST_QDISC (objs[i]));
+			else {
+				nm_assert (NMP_OBJECT_GET_TYPE (objs[i]) == NMP_OBJECT_TYPE_TFILTER);
+				out_results[i] = nm_platform_tfilter_add (self, flags, NMP_OBJECT_CAST_TFILTER (objs[i]));
 			}
 		}
+		return;
 	}
 
-	if (known_qdiscs) {
-		for (i = 0; i < known_qdiscs->len; i++) {
-			const NMPObject *q = g_ptr_array_index (known_qdiscs, i);
-
-			if (g_hash_table_contains (known_qdiscs_idx, q)) {
-				success &= (nm_platform_qdisc_add (self, NMP_NLM_FLAG_ADD,
-				                                   NMP_OBJECT_CAST_QDISC (q)) >= 0);
-			}
+	if (_LOGD_ENABLED ()) {
+		for (i = 0; i < len; i++) {
+			int ifindex = NMP_OBJECT_CAST_OBJ_WITH_IFINDEX (objs[i])->ifindex;
+
+			nm_assert (NM_IN_SET (NMP_OBJECT_GET_TYPE (objs[i]), NMP_OBJECT_TYPE_QDISC,
+			                                                     NMP_OBJECT_TYPE_TFILTER));
+			_LOG3D ("%s: %-10s %s (batch %u/%u)",
+			        NMP_OBJECT_GET_CLASS (objs[i])->obj_type_name,
+			        _nmp_nlm_flag_to_string (flags & NMP_NLM_FLAG_FMASK),
+			        nmp_object_to_string (objs[i], NMP_OBJECT_TO_STRING_PUBLIC, sbuf, sizeof (sbuf)),
+			        i + 1,
+			        len);
 		}
 	}
 
-	return success;
+	klass->tc_add_many (self, flags, objs, len, out_results);
 }
 
-/*****************************************************************************/
+static gboolean
+_tfilter_can_replace (const NMPlatformTfilter *a, const NMPlatformTfilter *b)
+{
+	/* Kernel finds the filter to change by parent, priority and protocol
+	 * (both encoded in info) and the handle. The kind cannot be changed. */
+	return    a->ifindex == b->ifindex
+	       && a->parent == b->parent
+	       && a->info == b->info
+	       && a->handle == b->handle
+	       && a->addr_family == b->addr_family
+	       && nm_streq0 (a->kind, b->kind);
+}
 
-int
-nm_platform_tfilter_add (NMPlatform *self,
-                         NMPNlmFlags flags,
-                         const NMPlatformTfilter *tfilter)
+static guint
+_tfilter_hash (gconstpointer ptr)
 {
-	int ifindex = tfilter->ifindex;
-	_CHECK_SELF (self, klass, -NME_BUG);
+	NMHashState h;
 
-	/* Note: @tfilter must not be copied or kept alive because the lifetime of tfilter.kind
-	 * and tfilter.action.kind is undefined. */
+	nm_hash_init (&h, 1205542291u);
+	nm_platform_tfilter_hash_update (ptr, &h);
+	return nm_hash_complete (&h);
+}
 
-	_LOG3D ("adding or updating a tfilter: %s", nm_platform_tfilter_to_string (tfilter, NULL, 0));
-	return klass->tfilter_add (self, flags, tfilter);
+static gboolean
+_tfilter_equal (gconstpointer a, gconstpointer b)
+{
+	return nm_platform_tfilter_cmp (a, b) == 0;
+}
+
+static guint
+_tfilter_replace_id_hash (gconstpointer ptr)
+{
+	const NMPlatformTfilter *tfilter = ptr;
+	NMHashState h;
+
+	nm_hash_init (&h, 3287109361u);
+	nm_hash_update_str0 (&h, tfilter->kind);
+	nm_hash_update_vals (&h,
+	                     tfilter->ifindex,
+	                     tfilter->addr_family,
+	                     tfilter->handle,
+	                     tfilter->parent,
+	                     tfilter->info);
+	return nm_hash_complete (&h);
+}
+
+static gboolean
+_tfilter_replace_id_equal (gconstpointer a, gconstpointer b)
+{
+	return _tfilter_can_replace (a, b);
+}
+
+/* Kernel chooses the priority and the handle of a filter, if they are
+ * zero in the request. Look up the configured filter @tfilter in @idx,
+ * also as if it had no priority and handle. */
+static const NMPObject *
+_tfilter_sync_lookup (GHashTable *idx,
+                      GHashTable *done,
+                      const NMPlatformTfilter *tfilter)
+{
+	NMPlatformTfilter needle;
+	const NMPObject *k;
+	guint i;
+
+	for (i = 0; i < 4; i++) {
+		if (   NM_FLAGS_HAS (i, 0x1)
+		    && TC_H_MAJ (tfilter->info) == 0)
+			continue;
+		if (   NM_FLAGS_HAS (i, 0x2)
+		    && tfilter->handle == 0)
+			continue;
+
+		needle = *tfilter;
+		if (NM_FLAGS_HAS (i, 0x1))
+			needle.info = TC_H_MIN (tfilter->info);
+		if (NM_FLAGS_HAS (i, 0x2))
+			needle.handle = 0;
+
+		k = g_hash_table_lookup (idx, &needle);
+		if (   k
+		    && !g_hash_table_contains (done, k))
+			return k;
+	}
+	return NULL;
 }
 
 /**
- * nm_platform_qdisc_sync:
+ * nm_platform_tfilter_sync:
  * @self: the #NMPlatform instance
  * @ifindex: the ifindex where to configure the qdiscs.
  * @known_tfilters: the list of tfilters (#NMPObject).
@@ -5147,6 +7066,13 @@ nm_platform_tfilter_add (NMPlatform *self,
  * caller to pass NMPlatformTfilter instances which "kind" string
  * have a limited lifetime.
  *
+ * Filters are matched by their full identity: the parent, the priority
+ * and protocol, the handle and the kind. A zero priority or handle in
+ * @known_tfilters matches the one that kernel chose. Filters that are
+ * already configured as desired are left alone, and filters that only
+ * differ in their action are replaced in place. The requests are sent
+ * in batches.
+ *
  * Returns: %TRUE on success.
  */
 gboolean
@@ -5159,18 +7085,31 @@ nm_platform_tfilter_sync (NMPlatform *self,
 	guint i;
 	gboolean success = TRUE;
 	gs_unref_hashtable GHashTable *known_tfilters_idx = NULL;
+	gs_unref_hashtable GHashTable *known_tfilters_replace_idx = NULL;
+	gs_unref_hashtable GHashTable *done = NULL;
+	gs_unref_hashtable GHashTable *replacements_idx = NULL;
+	gs_free NMPObject *replacements = NULL;
+	gs_free const NMPObject **objs_del = NULL;
+	gs_free const NMPObject **objs_add = NULL;
+	guint n_del = 0;
+	guint n_add = 0;
+	guint n_replacements = 0;
 
 	nm_assert (NM_IS_PLATFORM (self));
 	nm_assert (ifindex > 0);
 
-	known_tfilters_idx = g_hash_table_new ((GHashFunc) nmp_object_id_hash,
-	                                       (GEqualFunc) nmp_object_id_equal);
+	known_tfilters_idx = g_hash_table_new (_tfilter_hash, _tfilter_equal);
+	known_tfilters_replace_idx = g_hash_table_new (_tfilter_replace_id_hash, _tfilter_replace_id_equal);
+	done = g_hash_table_new (nm_direct_hash, NULL);
 
 	if (known_tfilters) {
 		for (i = 0; i < known_tfilters->len; i++) {
 			const NMPObject *q = g_ptr_array_index (known_tfilters, i);
 
-			g_hash_table_insert (known_tfilters_idx, (gpointer) q, (gpointer) q);
+			if (!g_hash_table_contains (known_tfilters_idx, &q->tfilter))
+				g_hash_table_insert (known_tfilters_idx, (gpointer) &q->tfilter, (gpointer) q);
+			if (!g_hash_table_contains (known_tfilters_replace_idx, &q->tfilter))
+				g_hash_table_insert (known_tfilters_replace_idx, (gpointer) &q->tfilter, (gpointer) q);
 		}
 	}
 
@@ -5181,23 +7120,67 @@ nm_platform_tfilter_sync (NMPlatform *self,
 	                                          NULL, NULL);
 
 	if (plat_tfilters) {
+		objs_del = g_new (const NMPObject *, plat_tfilters->len);
+		replacements = g_new (NMPObject, plat_tfilters->len);
+
 		for (i = 0; i < plat_tfilters->len; i++) {
-			const NMPObject *q = g_ptr_array_index (plat_tfilters, i);
+			const NMPObject *p = g_ptr_array_index (plat_tfilters, i);
+			const NMPObject *k;
+			NMPObject *r;
+
+			k = _tfilter_sync_lookup (known_tfilters_idx, done, &p->tfilter);
+			if (k) {
+				/* already configured as desired. */
+				g_hash_table_add (done, (gpointer) k);
+				continue;
+			}
+
+			k = _tfilter_sync_lookup (known_tfilters_replace_idx, done, &p->tfilter);
+			if (k) {
+				/* only the action differs. Replace it, with the priority and
+				 * handle that kernel chose. */
+				r = &replacements[n_replacements++];
+				nmp_object_stackinit (r, NMP_OBJECT_TYPE_TFILTER, &k->tfilter);
+				r->tfilter.info = p->tfilter.info;
+				r->tfilter.handle = p->tfilter.handle;
+				if (!replacements_idx)
+					replacements_idx = g_hash_table_new (nm_direct_hash, NULL);
+				g_hash_table_insert (replacements_idx, (gpointer) k, r);
+				g_hash_table_add (done, (gpointer) k);
+				continue;
+			}
 
-			if (!g_hash_table_lookup (known_tfilters_idx, q))
-				success &= nm_platform_object_delete (self, q);
+			objs_del[n_del++] = p;
 		}
 	}
 
 	if (known_tfilters) {
+		objs_add = g_new (const NMPObject *, known_tfilters->len);
+
 		for (i = 0; i < known_tfilters->len; i++) {
 			const NMPObject *q = g_ptr_array_index (known_tfilters, i);
+			const NMPObject *r;
+
+			if (   replacements_idx
+			    && (r = g_hash_table_lookup (replacements_idx, q))) {
+				objs_add[n_add++] = r;
+				continue;
+			}
+
+			if (g_hash_table_contains (done, q))
+				continue;
+
+			if (g_hash_table_lookup (known_tfilters_idx, &q->tfilter) != q) {
+				/* a duplicate. */
+				continue;
+			}
 
-			success &= (nm_platform_tfilter_add (self, NMP_NLM_FLAG_ADD,
-			                                     NMP_OBJECT_CAST_TFILTER (q)) >= 0);
+			objs_add[n_add++] = q;
 		}
 	}
 
+	_tc_sync_commit (self, objs_del, n_del, objs_add, n_add, &success);
+
 	return success;
 }
 
@@ -6065,6 +8048,284 @@ _rtm_flags_to_string_full (char *buf, gsize buf_size, unsigned rtm_flags)
 	return buf0;
 }
 
+/*****************************************************************************/
+
+/* Interning of NMPlatformRouteRtax.
+ *
+ * Few routes have RTA_METRICS besides mss, and those that have, mostly share
+ * the same values. Routes only carry a 32 bit id, which keeps the many routes
+ * in the platform cache small. Id zero is the empty block.
+ *
+ * If only one metric is set (like the mtu of a route, which might be
+ * different for every route), it is encoded in the id itself. Otherwise,
+ * the id refers to an interned (immutable) block. Routes are copied by value,
+ * so we cannot tell when a block is no longer used, and interned blocks are
+ * never released. There are only a handful of distinct combinations in
+ * practice. Still, the number of blocks is not limited, so that interning
+ * never loses metrics.
+ *
+ * Routes are parsed on the netlink worker thread as well, so interning is
+ * guarded by a lock. The blocks live in chunks that never move, so that
+ * looking up an id does not require the lock. Chunk k holds
+ * (RTAX_CHUNK_SIZE << k) blocks, so that a fixed number of chunks covers
+ * all ids below RTAX_ID_INLINE. See _rtax_id_locate(). */
+
+#define RTAX_CHUNK_SHIFT 8u
+#define RTAX_CHUNK_SIZE  (1u << RTAX_CHUNK_SHIFT)
+#define RTAX_N_CHUNKS    (32u - RTAX_CHUNK_SHIFT)
+
+/* the layout of ids that encode one metric inline. */
+#define RTAX_ID_INLINE           0x80000000u
+#define RTAX_ID_INLINE_LOCK      0x40000000u
+#define RTAX_ID_INLINE_IDX_SHIFT 27u
+#define RTAX_ID_INLINE_IDX_MASK  0x7u
+#define RTAX_ID_INLINE_VAL_MAX   0x07FFFFFFu
+
+static struct {
+	GMutex lock;
+	GHashTable *idx;
+	guint32 n_ids;
+	NMPlatformRouteRtax *chunks[RTAX_N_CHUNKS];
+} _rtax_intern;
+
+static void
+_rtax_id_locate (guint32 rtax_id, guint *out_chunk, guint32 *out_offset)
+{
+	const guint32 n = rtax_id + RTAX_CHUNK_SIZE;
+	guint k;
+
+	nm_assert (rtax_id > 0 && rtax_id < RTAX_ID_INLINE);
+
+	k = g_bit_storage (n) - 1u - RTAX_CHUNK_SHIFT;
+	nm_assert (k < RTAX_N_CHUNKS);
+
+	*out_chunk = k;
+	*out_offset = n - (RTAX_CHUNK_SIZE << k);
+}
+
+static gboolean
+_rtax_is_empty (const NMPlatformRouteRtax *rtax)
+{
+	return    !rtax->window
+	       && !rtax->cwnd
+	       && !rtax->initcwnd
+	       && !rtax->initrwnd
+	       && !rtax->mtu
+	       && !rtax->lock_window
+	       && !rtax->lock_cwnd
+	       && !rtax->lock_initcwnd
+	       && !rtax->lock_initrwnd
+	       && !rtax->lock_mtu;
+}
+
+static guint
+_rtax_hash (gconstpointer ptr)
+{
+	const NMPlatformRouteRtax *rtax = ptr;
+	NMHashState h;
+
+	nm_hash_init (&h, 1393046271u);
+	nm_hash_update_vals (&h,
+	                     rtax->window,
+	                     rtax->cwnd,
+	                     rtax->initcwnd,
+	                     rtax->initrwnd,
+	                     rtax->mtu,
+	                     NM_HASH_COMBINE_BOOLS (guint8,
+	                                            rtax->lock_window,
+	                                            rtax->lock_cwnd,
+	                                            rtax->lock_initcwnd,
+	                                            rtax->lock_initrwnd,
+	                                            rtax->lock_mtu));
+	return nm_hash_complete (&h);
+}
+
+static gboolean
+_rtax_equal (gconstpointer ptr_a, gconstpointer ptr_b)
+{
+	const NMPlatformRouteRtax *a = ptr_a;
+	const NMPlatformRouteRtax *b = ptr_b;
+
+	return    a->window == b->window
+	       && a->cwnd == b->cwnd
+	       && a->initcwnd == b->initcwnd
+	       && a->initrwnd == b->initrwnd
+	       && a->mtu == b->mtu
+	       && a->lock_window == b->lock_window
+	       && a->lock_cwnd == b->lock_cwnd
+	       && a->lock_initcwnd == b->lock_initcwnd
+	       && a->lock_initrwnd == b->lock_initrwnd
+	       && a->lock_mtu == b->lock_mtu;
+}
+
+static gboolean
+_rtax_to_inline (const NMPlatformRouteRtax *rtax, guint32 *out_rtax_id)
+{
+	const struct {
+		guint32 val;
+		bool lock;
+	} metrics[] = {
+		{ rtax->window,   rtax->lock_window,   },
+		{ rtax->cwnd,     rtax->lock_cwnd,     },
+		{ rtax->initcwnd, rtax->lock_initcwnd, },
+		{ rtax->initrwnd, rtax->lock_initrwnd, },
+		{ rtax->mtu,      rtax->lock_mtu,      },
+	};
+	guint idx = G_N_ELEMENTS (metrics);
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS (metrics); i++) {
+		if (   !metrics[i].val
+		    && !metrics[i].lock)
+			continue;
+		if (idx != G_N_ELEMENTS (metrics))
+			return FALSE;
+		idx = i;
+	}
+
+	nm_assert (idx < G_N_ELEMENTS (metrics));
+
+	if (metrics[idx].val > RTAX_ID_INLINE_VAL_MAX)
+		return FALSE;
+
+	*out_rtax_id =   RTAX_ID_INLINE
+	               | (metrics[idx].lock ? RTAX_ID_INLINE_LOCK : 0u)
+	               | (((guint32) idx) << RTAX_ID_INLINE_IDX_SHIFT)
+	               | metrics[idx].val;
+	return TRUE;
+}
+
+static void
+_rtax_from_inline (guint32 rtax_id, NMPlatformRouteRtax *rtax)
+{
+	const guint32 val = rtax_id & RTAX_ID_INLINE_VAL_MAX;
+	const bool lock = NM_FLAGS_HAS (rtax_id, RTAX_ID_INLINE_LOCK);
+
+	*rtax = (NMPlatformRouteRtax) { 0 };
+	switch ((rtax_id >> RTAX_ID_INLINE_IDX_SHIFT) & RTAX_ID_INLINE_IDX_MASK) {
+	case 0:
+		rtax->window = val;
+		rtax->lock_window = lock;
+		break;
+	case 1:
+		rtax->cwnd = val;
+		rtax->lock_cwnd = lock;
+		break;
+	case 2:
+		rtax->initcwnd = val;
+		rtax->lock_initcwnd = lock;
+		break;
+	case 3:
+		rtax->initrwnd = val;
+		rtax->lock_initrwnd = lock;
+		break;
+	case 4:
+		rtax->mtu = val;
+		rtax->lock_mtu = lock;
+		break;
+	default:
+		nm_assert_not_reached ();
+		break;
+	}
+}
+
+/**
+ * nm_platform_route_rtax_get:
+ * @rtax_id: the id of a #NMPlatformRouteRtax, as found in
+ *   the rtax_id field of a route.
+ * @buf: a buffer for the metrics, for ids that are not interned.
+ *
+ * Returns: the RTA_METRICS of the route. For zero, this is an empty
+ *   block. The result is either @buf or an interned block, which is
+ *   immutable and lives forever. Use NM_PLATFORM_IP_ROUTE_RTAX().
+ */
+const NMPlatformRouteRtax *
+nm_platform_route_rtax_get (guint32 rtax_id, NMPlatformRouteRtax *buf)
+{
+	static const NMPlatformRouteRtax empty = { 0 };
+	const NMPlatformRouteRtax *chunk;
+	guint i_chunk;
+	guint32 offset;
+
+	if (rtax_id == 0)
+		return &empty;
+
+	if (NM_FLAGS_HAS (rtax_id, RTAX_ID_INLINE)) {
+		_rtax_from_inline (rtax_id, buf);
+		return buf;
+	}
+
+	_rtax_id_locate (rtax_id, &i_chunk, &offset);
+
+	chunk = g_atomic_pointer_get (&_rtax_intern.chunks[i_chunk]);
+	if (G_UNLIKELY (!chunk))
+		g_return_val_if_reached (&empty);
+	return &chunk[offset];
+}
+
+/**
+ * nm_platform_route_rtax_intern:
+ * @rtax: (allow-none): the RTA_METRICS to intern
+ *
+ * Returns: the id for @rtax, to be set as rtax_id field of a route.
+ *   Equal blocks get the same id, and zero is returned if no attribute
+ *   is set. Interning cannot fail.
+ */
+guint32
+nm_platform_route_rtax_intern (const NMPlatformRouteRtax *rtax)
+{
+	NMPlatformRouteRtax *chunk;
+	gpointer ptr;
+	guint32 rtax_id;
+	guint32 offset;
+	guint i_chunk;
+
+	if (   !rtax
+	    || _rtax_is_empty (rtax))
+		return 0;
+
+	if (_rtax_to_inline (rtax, &rtax_id))
+		return rtax_id;
+
+	g_mutex_lock (&_rtax_intern.lock);
+
+	if (G_UNLIKELY (!_rtax_intern.idx)) {
+		_rtax_intern.idx = g_hash_table_new (_rtax_hash, _rtax_equal);
+		_rtax_intern.n_ids = 1;
+	}
+
+	ptr = g_hash_table_lookup (_rtax_intern.idx, rtax);
+	if (ptr) {
+		rtax_id = GPOINTER_TO_UINT (ptr);
+		goto out;
+	}
+
+	rtax_id = _rtax_intern.n_ids;
+	if (G_UNLIKELY (rtax_id >= RTAX_ID_INLINE)) {
+		/* we run out of memory long before. */
+		g_error ("platform: too many distinct route metrics");
+	}
+
+	_rtax_id_locate (rtax_id, &i_chunk, &offset);
+
+	chunk = _rtax_intern.chunks[i_chunk];
+	if (!chunk) {
+		chunk = g_new0 (NMPlatformRouteRtax, RTAX_CHUNK_SIZE << i_chunk);
+		chunk[offset] = *rtax;
+		g_atomic_pointer_set (&_rtax_intern.chunks[i_chunk], chunk);
+	} else
+		chunk[offset] = *rtax;
+
+	_rtax_intern.n_ids++;
+	g_hash_table_insert (_rtax_intern.idx,
+	                     &chunk[offset],
+	                     GUINT_TO_POINTER (rtax_id));
+
+out:
+	g_mutex_unlock (&_rtax_intern.lock);
+	return rtax_id;
+}
+
 /**
  * nm_platform_ip4_route_to_string:
  * @route: pointer to NMPlatformIP4Route route structure
@@ -6088,10 +8349,13 @@ nm_platform_ip4_route_to_string (const NMPlatformIP4Route *route, char *buf, gsi
 	char str_scope[30], s_source[50];
 	char str_tos[32], str_window[32], str_cwnd[32], str_initcwnd[32], str_initrwnd[32], str_mtu[32];
 	char str_rtm_flags[_RTM_FLAGS_TO_STRING_MAXLEN];
+	const NMPlatformRouteRtax *rtax;
 
 	if (!nm_utils_to_string_buffer_init_null (route, &buf, &len))
 		return buf;
 
+	rtax = NM_PLATFORM_IP_ROUTE_RTAX (route);
+
 	inet_ntop (AF_INET, &route->network, s_network, sizeof(s_network));
 	inet_ntop (AF_INET, &route->gateway, s_gateway, sizeof(s_gateway));
 
@@ -6131,11 +8395,11 @@ nm_platform_ip4_route_to_string (const NMPlatformIP4Route *route, char *buf, gsi
 	            route->pref_src ? " pref-src " : "",
 	            route->pref_src ? inet_ntop (AF_INET, &route->pref_src, s_pref_src, sizeof(s_pref_src)) : "",
 	            route->tos ? nm_sprintf_buf (str_tos, " tos 0x%x", (unsigned) route->tos) : "",
-	            route->window   || route->lock_window   ? nm_sprintf_buf (str_window,   " window %s%"G_GUINT32_FORMAT,   route->lock_window   ? "lock " : "", route->window)   : "",
-	            route->cwnd     || route->lock_cwnd     ? nm_sprintf_buf (str_cwnd,     " cwnd %s%"G_GUINT32_FORMAT,     route->lock_cwnd     ? "lock " : "", route->cwnd)     : "",
-	            route->initcwnd || route->lock_initcwnd ? nm_sprintf_buf (str_initcwnd, " initcwnd %s%"G_GUINT32_FORMAT, route->lock_initcwnd ? "lock " : "", route->initcwnd) : "",
-	            route->initrwnd || route->lock_initrwnd ? nm_sprintf_buf (str_initrwnd, " initrwnd %s%"G_GUINT32_FORMAT, route->lock_initrwnd ? "lock " : "", route->initrwnd) : "",
-	            route->mtu      || route->lock_mtu      ? nm_sprintf_buf (str_mtu,      " mtu %s%"G_GUINT32_FORMAT,      route->lock_mtu      ? "lock " : "", route->mtu)      : "");
+	            rtax->window   || rtax->lock_window   ? nm_sprintf_buf (str_window,   " window %s%"G_GUINT32_FORMAT,   rtax->lock_window   ? "lock " : "", rtax->window)   : "",
+	            rtax->cwnd     || rtax->lock_cwnd     ? nm_sprintf_buf (str_cwnd,     " cwnd %s%"G_GUINT32_FORMAT,     rtax->lock_cwnd     ? "lock " : "", rtax->cwnd)     : "",
+	            rtax->initcwnd || rtax->lock_initcwnd ? nm_sprintf_buf (str_initcwnd, " initcwnd %s%"G_GUINT32_FORMAT, rtax->lock_initcwnd ? "lock " : "", rtax->initcwnd) : "",
+	            rtax->initrwnd || rtax->lock_initrwnd ? nm_sprintf_buf (str_initrwnd, " initrwnd %s%"G_GUINT32_FORMAT, rtax->lock_initrwnd ? "lock " : "", rtax->initrwnd) : "",
+	            rtax->mtu      || rtax->lock_mtu      ? nm_sprintf_buf (str_mtu,      " mtu %s%"G_GUINT32_FORMAT,      rtax->lock_mtu      ? "lock " : "", rtax->mtu)      : "");
 	return buf;
 }
 
@@ -6171,10 +8435,13 @@ nm_platform_ip6_route_to_string (const NMPlatformIP6Route *route, char *buf, gsi
 	char str_initrwnd[32];
 	char str_mtu[32];
 	char str_rtm_flags[_RTM_FLAGS_TO_STRING_MAXLEN];
+	const NMPlatformRouteRtax *rtax;
 
 	if (!nm_utils_to_string_buffer_init_null (route, &buf, &len))
 		return buf;
 
+	rtax = NM_PLATFORM_IP_ROUTE_RTAX (route);
+
 	inet_ntop (AF_INET6, &route->network, s_network, sizeof (s_network));
 	inet_ntop (AF_INET6, &route->gateway, s_gateway, sizeof (s_gateway));
 
@@ -6219,11 +8486,11 @@ nm_platform_ip6_route_to_string (const NMPlatformIP6Route *route, char *buf, gsi
 	            _rtm_flags_to_string_full (str_rtm_flags, sizeof (str_rtm_flags), route->r_rtm_flags),
 	            s_pref_src[0] ? " pref-src " : "",
 	            s_pref_src[0] ? s_pref_src : "",
-	            route->window   || route->lock_window   ? nm_sprintf_buf (str_window,   " window %s%"G_GUINT32_FORMAT,   route->lock_window   ? "lock " : "", route->window)   : "",
-	            route->cwnd     || route->lock_cwnd     ? nm_sprintf_buf (str_cwnd,     " cwnd %s%"G_GUINT32_FORMAT,     route->lock_cwnd     ? "lock " : "", route->cwnd)     : "",
-	            route->initcwnd || route->lock_initcwnd ? nm_sprintf_buf (str_initcwnd, " initcwnd %s%"G_GUINT32_FORMAT, route->lock_initcwnd ? "lock " : "", route->initcwnd) : "",
-	            route->initrwnd || route->lock_initrwnd ? nm_sprintf_buf (str_initrwnd, " initrwnd %s%"G_GUINT32_FORMAT, route->lock_initrwnd ? "lock " : "", route->initrwnd) : "",
-	            route->mtu      || route->lock_mtu      ? nm_sprintf_buf (str_mtu,      " mtu %s%"G_GUINT32_FORMAT,      route->lock_mtu      ? "lock " : "", route->mtu)      : "",
+	            rtax->window   || rtax->lock_window   ? nm_sprintf_buf (str_window,   " window %s%"G_GUINT32_FORMAT,   rtax->lock_window   ? "lock " : "", rtax->window)   : "",
+	            rtax->cwnd     || rtax->lock_cwnd     ? nm_sprintf_buf (str_cwnd,     " cwnd %s%"G_GUINT32_FORMAT,     rtax->lock_cwnd     ? "lock " : "", rtax->cwnd)     : "",
+	            rtax->initcwnd || rtax->lock_initcwnd ? nm_sprintf_buf (str_initcwnd, " initcwnd %s%"G_GUINT32_FORMAT, rtax->lock_initcwnd ? "lock " : "", rtax->initcwnd) : "",
+	            rtax->initrwnd || rtax->lock_initrwnd ? nm_sprintf_buf (str_initrwnd, " initrwnd %s%"G_GUINT32_FORMAT, rtax->lock_initrwnd ? "lock " : "", rtax->initrwnd) : "",
+	            rtax->mtu      || rtax->lock_mtu      ? nm_sprintf_buf (str_mtu,      " mtu %s%"G_GUINT32_FORMAT,      rtax->lock_mtu      ? "lock " : "", rtax->mtu)      : "",
 	            route->rt_pref ? nm_sprintf_buf (str_pref, " pref %s", nm_icmpv6_router_pref_to_string (route->rt_pref, str_pref2, sizeof (str_pref2))) : "");
 
 	return buf;
@@ -7273,6 +9540,8 @@ nm_platform_ip6_address_cmp (const NMPlatformIP6Address *a, const NMPlatformIP6A
 void
 nm_platform_ip4_route_hash_update (const NMPlatformIP4Route *obj, NMPlatformIPRouteCmpType cmp_type, NMHashState *h)
 {
+	const NMPlatformRouteRtax *rtax = NM_PLATFORM_IP_ROUTE_RTAX (obj);
+
 	switch (cmp_type) {
 	case NM_PLATFORM_IP_ROUTE_CMP_TYPE_WEAK_ID:
 		nm_hash_update_vals (h,
@@ -7297,18 +9566,18 @@ nm_platform_ip4_route_hash_update (const NMPlatformIP4Route *obj, NMPlatformIPRo
 		                     obj->gateway,
 		                     obj->mss,
 		                     obj->pref_src,
-		                     obj->window,
-		                     obj->cwnd,
-		                     obj->initcwnd,
-		                     obj->initrwnd,
-		                     obj->mtu,
+		                     rtax->window,
+		                     rtax->cwnd,
+		                     rtax->initcwnd,
+		                     rtax->initrwnd,
+		                     rtax->mtu,
 		                     obj->r_rtm_flags & RTNH_F_ONLINK,
 		                     NM_HASH_COMBINE_BOOLS (guint8,
-		                                            obj->lock_window,
-		                                            obj->lock_cwnd,
-		                                            obj->lock_initcwnd,
-		                                            obj->lock_initrwnd,
-		                                            obj->lock_mtu));
+		                                            rtax->lock_window,
+		                                            rtax->lock_cwnd,
+		                                            rtax->lock_initcwnd,
+		                                            rtax->lock_initrwnd,
+		                                            rtax->lock_mtu));
 		break;
 	case NM_PLATFORM_IP_ROUTE_CMP_TYPE_SEMANTICALLY:
 		nm_hash_update_vals (h,
@@ -7324,18 +9593,18 @@ nm_platform_ip4_route_hash_update (const NMPlatformIP4Route *obj, NMPlatformIPRo
 		                     obj->tos,
 		                     obj->mss,
 		                     obj->pref_src,
-		                     obj->window,
-		                     obj->cwnd,
-		                     obj->initcwnd,
-		                     obj->initrwnd,
-		                     obj->mtu,
+		                     rtax->window,
+		                     rtax->cwnd,
+		                     rtax->initcwnd,
+		                     rtax->initrwnd,
+		                     rtax->mtu,
 		                     obj->r_rtm_flags & (RTM_F_CLONED | RTNH_F_ONLINK),
 		                     NM_HASH_COMBINE_BOOLS (guint8,
-		                                            obj->lock_window,
-		                                            obj->lock_cwnd,
-		                                            obj->lock_initcwnd,
-		                                            obj->lock_initrwnd,
-		                                            obj->lock_mtu));
+		                                            rtax->lock_window,
+		                                            rtax->lock_cwnd,
+		                                            rtax->lock_initcwnd,
+		                                            rtax->lock_initrwnd,
+		                                            rtax->lock_mtu));
 		break;
 	case NM_PLATFORM_IP_ROUTE_CMP_TYPE_FULL:
 		nm_hash_update_vals (h,
@@ -7351,18 +9620,18 @@ nm_platform_ip4_route_hash_update (const NMPlatformIP4Route *obj, NMPlatformIPRo
 		                     obj->tos,
 		                     obj->mss,
 		                     obj->pref_src,
-		                     obj->window,
-		                     obj->cwnd,
-		                     obj->initcwnd,
-		                     obj->initrwnd,
-		                     obj->mtu,
+		                     rtax->window,
+		                     rtax->cwnd,
+		                     rtax->initcwnd,
+		                     rtax->initrwnd,
+		                     rtax->mtu,
 		                     obj->r_rtm_flags,
 		                     NM_HASH_COMBINE_BOOLS (guint8,
-		                                            obj->lock_window,
-		                                            obj->lock_cwnd,
-		                                            obj->lock_initcwnd,
-		                                            obj->lock_initrwnd,
-		                                            obj->lock_mtu));
+		                                            rtax->lock_window,
+		                                            rtax->lock_cwnd,
+		                                            rtax->lock_initcwnd,
+		                                            rtax->lock_initrwnd,
+		                                            rtax->lock_mtu));
 		break;
 	}
 }
@@ -7370,7 +9639,14 @@ nm_platform_ip4_route_hash_update (const NMPlatformIP4Route *obj, NMPlatformIPRo
 int
 nm_platform_ip4_route_cmp (const NMPlatformIP4Route *a, const NMPlatformIP4Route *b, NMPlatformIPRouteCmpType cmp_type)
 {
+	const NMPlatformRouteRtax *rtax_a;
+	const NMPlatformRouteRtax *rtax_b;
+
 	NM_CMP_SELF (a, b);
+
+	rtax_a = NM_PLATFORM_IP_ROUTE_RTAX (a);
+	rtax_b = NM_PLATFORM_IP_ROUTE_RTAX (b);
+
 	switch (cmp_type) {
 	case NM_PLATFORM_IP_ROUTE_CMP_TYPE_WEAK_ID:
 	case NM_PLATFORM_IP_ROUTE_CMP_TYPE_ID:
@@ -7390,18 +9666,18 @@ nm_platform_ip4_route_cmp (const NMPlatformIP4Route *a, const NMPlatformIP4Route
 			NM_CMP_FIELD (a, b, gateway);
 			NM_CMP_FIELD (a, b, mss);
 			NM_CMP_FIELD (a, b, pref_src);
-			NM_CMP_FIELD (a, b, window);
-			NM_CMP_FIELD (a, b, cwnd);
-			NM_CMP_FIELD (a, b, initcwnd);
-			NM_CMP_FIELD (a, b, initrwnd);
-			NM_CMP_FIELD (a, b, mtu);
+			NM_CMP_FIELD (rtax_a, rtax_b, window);
+			NM_CMP_FIELD (rtax_a, rtax_b, cwnd);
+			NM_CMP_FIELD (rtax_a, rtax_b, initcwnd);
+			NM_CMP_FIELD (rtax_a, rtax_b, initrwnd);
+			NM_CMP_FIELD (rtax_a, rtax_b, mtu);
 			NM_CMP_DIRECT (a->r_rtm_flags & RTNH_F_ONLINK,
 			               b->r_rtm_flags & RTNH_F_ONLINK);
-			NM_CMP_FIELD_UNSAFE (a, b, lock_window);
-			NM_CMP_FIELD_UNSAFE (a, b, lock_cwnd);
-			NM_CMP_FIELD_UNSAFE (a, b, lock_initcwnd);
-			NM_CMP_FIELD_UNSAFE (a, b, lock_initrwnd);
-			NM_CMP_FIELD_UNSAFE (a, b, lock_mtu);
+			NM_CMP_FIELD_UNSAFE (rtax_a, rtax_b, lock_window);
+			NM_CMP_FIELD_UNSAFE (rtax_a, rtax_b, lock_cwnd);
+			NM_CMP_FIELD_UNSAFE (rtax_a, rtax_b, lock_initcwnd);
+			NM_CMP_FIELD_UNSAFE (rtax_a, rtax_b, lock_initrwnd);
+			NM_CMP_FIELD_UNSAFE (rtax_a, rtax_b, lock_mtu);
 		}
 		break;
 	case NM_PLATFORM_IP_ROUTE_CMP_TYPE_SEMANTICALLY:
@@ -7437,16 +9713,16 @@ nm_platform_ip4_route_cmp (const NMPlatformIP4Route *a, const NMPlatformIP4Route
 		} else
 			NM_CMP_FIELD (a, b, r_rtm_flags);
 		NM_CMP_FIELD (a, b, tos);
-		NM_CMP_FIELD_UNSAFE (a, b, lock_window);
-		NM_CMP_FIELD_UNSAFE (a, b, lock_cwnd);
-		NM_CMP_FIELD_UNSAFE (a, b, lock_initcwnd);
-		NM_CMP_FIELD_UNSAFE (a, b, lock_initrwnd);
-		NM_CMP_FIELD_UNSAFE (a, b, lock_mtu);
-		NM_CMP_FIELD (a, b, window);
-		NM_CMP_FIELD (a, b, cwnd);
-		NM_CMP_FIELD (a, b, initcwnd);
-		NM_CMP_FIELD (a, b, initrwnd);
-		NM_CMP_FIELD (a, b, mtu);
+		NM_CMP_FIELD_UNSAFE (rtax_a, rtax_b, lock_window);
+		NM_CMP_FIELD_UNSAFE (rtax_a, rtax_b, lock_cwnd);
+		NM_CMP_FIELD_UNSAFE (rtax_a, rtax_b, lock_initcwnd);
+		NM_CMP_FIELD_UNSAFE (rtax_a, rtax_b, lock_initrwnd);
+		NM_CMP_FIELD_UNSAFE (rtax_a, rtax_b, lock_mtu);
+		NM_CMP_FIELD (rtax_a, rtax_b, window);
+		NM_CMP_FIELD (rtax_a, rtax_b, cwnd);
+		NM_CMP_FIELD (rtax_a, rtax_b, initcwnd);
+		NM_CMP_FIELD (rtax_a, rtax_b, initrwnd);
+		NM_CMP_FIELD (rtax_a, rtax_b, mtu);
 		break;
 	}
 	return 0;
@@ -7455,6 +9731,7 @@ nm_platform_ip4_route_cmp (const NMPlatformIP4Route *a, const NMPlatformIP4Route
 void
 nm_platform_ip6_route_hash_update (const NMPlatformIP6Route *obj, NMPlatformIPRouteCmpType cmp_type, NMHashState *h)
 {
+	const NMPlatformRouteRtax *rtax = NM_PLATFORM_IP_ROUTE_RTAX (obj);
 	struct in6_addr a1, a2;
 
 	switch (cmp_type) {
@@ -7496,16 +9773,16 @@ nm_platform_ip6_route_hash_update (const NMPlatformIP6Route *obj, NMPlatformIPRo
 		                     obj->mss,
 		                     obj->r_rtm_flags & RTM_F_CLONED,
 		                     NM_HASH_COMBINE_BOOLS (guint8,
-		                                            obj->lock_window,
-		                                            obj->lock_cwnd,
-		                                            obj->lock_initcwnd,
-		                                            obj->lock_initrwnd,
-		                                            obj->lock_mtu),
-		                     obj->window,
-		                     obj->cwnd,
-		                     obj->initcwnd,
-		                     obj->initrwnd,
-		                     obj->mtu,
+		                                            rtax->lock_window,
+		                                            rtax->lock_cwnd,
+		                                            rtax->lock_initcwnd,
+		                                            rtax->lock_initrwnd,
+		                                            rtax->lock_mtu),
+		                     rtax->window,
+		                     rtax->cwnd,
+		                     rtax->initcwnd,
+		                     rtax->initrwnd,
+		                     rtax->mtu,
 		                     _route_pref_normalize (obj->rt_pref));
 		break;
 	case NM_PLATFORM_IP_ROUTE_CMP_TYPE_FULL:
@@ -7524,16 +9801,16 @@ nm_platform_ip6_route_hash_update (const NMPlatformIP6Route *obj, NMPlatformIPRo
 		                     obj->mss,
 		                     obj->r_rtm_flags,
 		                     NM_HASH_COMBINE_BOOLS (guint8,
-		                                            obj->lock_window,
-		                                            obj->lock_cwnd,
-		                                            obj->lock_initcwnd,
-		                                            obj->lock_initrwnd,
-		                                            obj->lock_mtu),
-		                     obj->window,
-		                     obj->cwnd,
-		                     obj->initcwnd,
-		                     obj->initrwnd,
-		                     obj->mtu,
+		                                            rtax->lock_window,
+		                                            rtax->lock_cwnd,
+		                                            rtax->lock_initcwnd,
+		                                            rtax->lock_initrwnd,
+		                                            rtax->lock_mtu),
+		                     rtax->window,
+		                     rtax->cwnd,
+		                     rtax->initcwnd,
+		                     rtax->initrwnd,
+		                     rtax->mtu,
 		                     obj->rt_pref);
 		break;
 	}
@@ -7542,7 +9819,14 @@ nm_platform_ip6_route_hash_update (const NMPlatformIP6Route *obj, NMPlatformIPRo
 int
 nm_platform_ip6_route_cmp (const NMPlatformIP6Route *a, const NMPlatformIP6Route *b, NMPlatformIPRouteCmpType cmp_type)
 {
+	const NMPlatformRouteRtax *rtax_a;
+	const NMPlatformRouteRtax *rtax_b;
+
 	NM_CMP_SELF (a, b);
+
+	rtax_a = NM_PLATFORM_IP_ROUTE_RTAX (a);
+	rtax_b = NM_PLATFORM_IP_ROUTE_RTAX (b);
+
 	switch (cmp_type) {
 	case NM_PLATFORM_IP_ROUTE_CMP_TYPE_WEAK_ID:
 	case NM_PLATFORM_IP_ROUTE_CMP_TYPE_ID:
@@ -7595,16 +9879,16 @@ nm_platform_ip6_route_cmp (const NMPlatformIP6Route *a, const NMPlatformIP6Route
 			               b->r_rtm_flags & RTM_F_CLONED);
 		} else
 			NM_CMP_FIELD (a, b, r_rtm_flags);
-		NM_CMP_FIELD_UNSAFE (a, b, lock_window);
-		NM_CMP_FIELD_UNSAFE (a, b, lock_cwnd);
-		NM_CMP_FIELD_UNSAFE (a, b, lock_initcwnd);
-		NM_CMP_FIELD_UNSAFE (a, b, lock_initrwnd);
-		NM_CMP_FIELD_UNSAFE (a, b, lock_mtu);
-		NM_CMP_FIELD (a, b, window);
-		NM_CMP_FIELD (a, b, cwnd);
-		NM_CMP_FIELD (a, b, initcwnd);
-		NM_CMP_FIELD (a, b, initrwnd);
-		NM_CMP_FIELD (a, b, mtu);
+		NM_CMP_FIELD_UNSAFE (rtax_a, rtax_b, lock_window);
+		NM_CMP_FIELD_UNSAFE (rtax_a, rtax_b, lock_cwnd);
+		NM_CMP_FIELD_UNSAFE (rtax_a, rtax_b, lock_initcwnd);
+		NM_CMP_FIELD_UNSAFE (rtax_a, rtax_b, lock_initrwnd);
+		NM_CMP_FIELD_UNSAFE (rtax_a, rtax_b, lock_mtu);
+		NM_CMP_FIELD (rtax_a, rtax_b, window);
+		NM_CMP_FIELD (rtax_a, rtax_b, cwnd);
+		NM_CMP_FIELD (rtax_a, rtax_b, initcwnd);
+		NM_CMP_FIELD (rtax_a, rtax_b, initrwnd);
+		NM_CMP_FIELD (rtax_a, rtax_b, mtu);
 		if (cmp_type == NM_PLATFORM_IP_ROUTE_CMP_TYPE_SEMANTICALLY)
 			NM_CMP_DIRECT (_route_pref_normalize (a->rt_pref), _route_pref_normalize (b->rt_pref));
 		else
@@ -7941,6 +10225,214 @@ log_tfilter (NMPlatform *self, NMPObjectType obj_type, int ifindex, NMPlatformTf
 
 /*****************************************************************************/
 
+typedef struct {
+	NMPObjectType obj_type;
+	int ifindex;
+	CList lst;
+	GHashTable *objs;
+	guint n_added;
+	guint n_changed;
+	guint n_removed;
+	bool overflow:1;
+} ChangeSetData;
+
+static guint
+_change_set_data_hash (gconstpointer ptr)
+{
+	const ChangeSetData *data = ptr;
+	NMHashState h;
+
+	nm_hash_init (&h, 1871426981u);
+	nm_hash_update_vals (&h, data->obj_type, data->ifindex);
+	return nm_hash_complete (&h);
+}
+
+static gboolean
+_change_set_data_equal (gconstpointer ptr_a, gconstpointer ptr_b)
+{
+	const ChangeSetData *a = ptr_a;
+	const ChangeSetData *b = ptr_b;
+
+	return    a->obj_type == b->obj_type
+	       && a->ifindex == b->ifindex;
+}
+
+static void
+_change_set_data_free (ChangeSetData *data)
+{
+	c_list_unlink_stale (&data->lst);
+	nm_clear_pointer (&data->objs, g_hash_table_unref);
+	g_slice_free (ChangeSetData, data);
+}
+
+static void
+_change_set_emit (NMPlatform *self, const ChangeSetData *data)
+{
+	gs_free gpointer *objs = NULL;
+	guint n_objs = 0;
+	NMPlatformChangeSet change_set;
+
+	if (!data->overflow)
+		objs = g_hash_table_get_keys_as_array (data->objs, &n_objs);
+
+	change_set = (NMPlatformChangeSet) {
+		.obj_type  = data->obj_type,
+		.ifindex   = data->ifindex,
+		.n_added   = data->n_added,
+		.n_changed = data->n_changed,
+		.n_removed = data->n_removed,
+		.objs      = (const NMPObject *const*) objs,
+		.n_objs    = n_objs,
+	};
+
+	_LOGt ("emit signal %s for %s, ifindex %d: %u added, %u changed, %u removed",
+	       NM_PLATFORM_SIGNAL_CHANGE_SET,
+	       nmp_class_from_type (data->obj_type)->obj_type_name,
+	       data->ifindex,
+	       data->n_added,
+	       data->n_changed,
+	       data->n_removed);
+
+	g_signal_emit (self,
+	               signals[NM_PLATFORM_SIGNAL_ID_CHANGE_SET],
+	               0,
+	               &change_set);
+}
+
+static gboolean
+_change_set_emit_cb (gpointer user_data)
+{
+	NMPlatform *self = user_data;
+	NMPlatformPrivate *priv = NM_PLATFORM_GET_PRIVATE (self);
+	_nm_unused gs_unref_object NMPlatform *self_keep_alive = g_object_ref (self);
+	nm_auto_pop_netns NMPNetns *netns = NULL;
+	CList lst_head = C_LIST_INIT (lst_head);
+	ChangeSetData *data;
+	gboolean netns_ok;
+
+	priv->change_sets_idle_id = 0;
+
+	/* take the pending change sets. Changes that happen while we emit the
+	 * signals are collected for the next main loop iteration. */
+	c_list_splice (&lst_head, &priv->change_sets_lst_head);
+	g_hash_table_steal_all (priv->change_sets);
+
+	netns_ok = nm_platform_netns_push (self, &netns);
+
+	while ((data = c_list_first_entry (&lst_head, ChangeSetData, lst))) {
+		if (netns_ok)
+			_change_set_emit (self, data);
+		_change_set_data_free (data);
+	}
+
+	return G_SOURCE_REMOVE;
+}
+
+/**
+ * nm_platform_change_set_flush:
+ * @self: the platform instance
+ * @obj_type: the object type of the change set
+ * @ifindex: the ifindex of the change set
+ *
+ * Emits the pending change set for @obj_type and @ifindex right away,
+ * instead of waiting for the next main loop iteration. Users that look
+ * at the cache and also track the change sets call this first, so that
+ * what they track is not behind the cache.
+ */
+void
+nm_platform_change_set_flush (NMPlatform *self,
+                              NMPObjectType obj_type,
+                              int ifindex)
+{
+	NMPlatformPrivate *priv;
+	_nm_unused gs_unref_object NMPlatform *self_keep_alive = NULL;
+	nm_auto_pop_netns NMPNetns *netns = NULL;
+	ChangeSetData needle;
+	ChangeSetData *data;
+
+	_CHECK_SELF_VOID (self, klass);
+
+	priv = NM_PLATFORM_GET_PRIVATE (self);
+
+	needle.obj_type = obj_type;
+	needle.ifindex = ifindex;
+
+	data = g_hash_table_lookup (priv->change_sets, &needle);
+	if (!data)
+		return;
+
+	g_hash_table_remove (priv->change_sets, data);
+	c_list_unlink (&data->lst);
+
+	self_keep_alive = g_object_ref (self);
+	if (nm_platform_netns_push (self, &netns))
+		_change_set_emit (self, data);
+	_change_set_data_free (data);
+}
+
+static void
+_change_set_track (NMPlatform *self,
+                   NMPObjectType obj_type,
+                   int ifindex,
+                   NMPlatformSignalChangeType change_type,
+                   const NMPObject *obj)
+{
+	NMPlatformPrivate *priv = NM_PLATFORM_GET_PRIVATE (self);
+	ChangeSetData needle;
+	ChangeSetData *data;
+
+	/* only pay for the tracking, if anybody is interested. */
+	if (!g_signal_has_handler_pending (self, signals[NM_PLATFORM_SIGNAL_ID_CHANGE_SET], 0, FALSE))
+		return;
+
+	needle.obj_type = obj_type;
+	needle.ifindex = ifindex;
+
+	data = g_hash_table_lookup (priv->change_sets, &needle);
+	if (!data) {
+		data = g_slice_new (ChangeSetData);
+		*data = (ChangeSetData) {
+			.obj_type = obj_type,
+			.ifindex  = ifindex,
+			.objs     = g_hash_table_new_full ((GHashFunc) nmp_object_id_hash,
+			                                   (GEqualFunc) nmp_object_id_equal,
+			                                   (GDestroyNotify) nmp_object_unref,
+			                                   NULL),
+		};
+		c_list_link_tail (&priv->change_sets_lst_head, &data->lst);
+		g_hash_table_add (priv->change_sets, data);
+	}
+
+	switch (change_type) {
+	case NM_PLATFORM_SIGNAL_ADDED:
+		data->n_added++;
+		break;
+	case NM_PLATFORM_SIGNAL_CHANGED:
+		data->n_changed++;
+		break;
+	default:
+		nm_assert (change_type == NM_PLATFORM_SIGNAL_REMOVED);
+		data->n_removed++;
+		break;
+	}
+
+	if (!data->overflow) {
+		if (   g_hash_table_size (data->objs) >= NM_PLATFORM_CHANGE_SET_OBJS_MAX
+		    && !g_hash_table_contains (data->objs, obj)) {
+			data->overflow = TRUE;
+			nm_clear_pointer (&data->objs, g_hash_table_unref);
+		} else {
+			/* replaces an older version of the same object. */
+			g_hash_table_add (data->objs, (gpointer) nmp_object_ref (obj));
+		}
+	}
+
+	if (!priv->change_sets_idle_id)
+		priv->change_sets_idle_id = g_idle_add_full (G_PRIORITY_DEFAULT, _change_set_emit_cb, self, NULL);
+}
+
+/*****************************************************************************/
+
 void
 nm_platform_cache_update_emit_signal (NMPlatform *self,
                                       NMPCacheOpsType cache_op,
@@ -8005,6 +10497,11 @@ nm_platform_cache_update_emit_signal (NMPlatform *self,
 	    && NM_IN_SET (cache_op, NMP_CACHE_OPS_ADDED, NMP_CACHE_OPS_UPDATED))
 		_ip4_dev_route_blacklist_notify_route (self, o);
 
+	if (klass->obj_type == NMP_OBJECT_TYPE_LINK)
+		_ethtool_cache_link_changed (self, cache_op, obj_old, o);
+
+	_change_set_track (self, klass->obj_type, ifindex, (NMPlatformSignalChangeType) cache_op, o);
+
 	_LOG3t ("emit signal %s %s: %s",
 	        klass->signal_type,
 	        nm_platform_signal_change_type_to_string ((NMPlatformSignalChangeType) cache_op),
@@ -8140,6 +10637,13 @@ constructor (GType type,
 
 	priv->multi_idx = nm_dedup_multi_index_new ();
 
+	c_list_init (&priv->change_sets_lst_head);
+
+	g_mutex_init (&priv->snapshot_lock);
+	priv->snapshot_owner = g_thread_self ();
+	priv->snapshot_context = g_main_context_ref_thread_default ();
+	priv->change_sets = g_hash_table_new (_change_set_data_hash, _change_set_data_equal);
+
 	priv->cache = nmp_cache_new (priv->multi_idx,
 	                             priv->use_udev);
 
@@ -8151,11 +10655,25 @@ finalize (GObject *object)
 {
 	NMPlatform *self = NM_PLATFORM (object);
 	NMPlatformPrivate *priv = NM_PLATFORM_GET_PRIVATE (self);
+	ChangeSetData *data;
 
 	nm_clear_g_source (&priv->ip4_dev_route_blacklist_check_id);
 	nm_clear_g_source (&priv->ip4_dev_route_blacklist_gc_timeout_id);
 	nm_clear_pointer (&priv->ip4_dev_route_blacklist_hash, g_hash_table_unref);
+	nm_clear_g_free (&priv->route_scope_ignore_tables);
+	nm_clear_g_source (&priv->change_sets_idle_id);
+	nm_clear_pointer (&priv->change_sets, g_hash_table_unref);
+	nm_clear_pointer (&priv->ethtool_cache, g_hash_table_unref);
+	while ((data = c_list_first_entry (&priv->change_sets_lst_head, ChangeSetData, lst)))
+		_change_set_data_free (data);
 	g_clear_object (&self->_netns);
+
+	g_mutex_lock (&priv->snapshot_lock);
+	nm_clear_g_source_inst (&priv->snapshot_refresh_source);
+	g_mutex_unlock (&priv->snapshot_lock);
+	nm_clear_pointer (&priv->snapshot, nmp_cache_snapshot_unref);
+	g_main_context_unref (priv->snapshot_context);
+	g_mutex_clear (&priv->snapshot_lock);
 	nm_dedup_multi_index_unref (priv->multi_idx);
 	nmp_cache_free (priv->cache);
 }
@@ -8222,4 +10740,12 @@ nm_platform_class_init (NMPlatformClass *platform_class)
 	SIGNAL (NM_PLATFORM_SIGNAL_ID_ROUTING_RULE, NM_PLATFORM_SIGNAL_ROUTING_RULE_CHANGED, log_routing_rule);
 	SIGNAL (NM_PLATFORM_SIGNAL_ID_QDISC,        NM_PLATFORM_SIGNAL_QDISC_CHANGED,        log_qdisc);
 	SIGNAL (NM_PLATFORM_SIGNAL_ID_TFILTER,      NM_PLATFORM_SIGNAL_TFILTER_CHANGED,      log_tfilter);
+
+	signals[NM_PLATFORM_SIGNAL_ID_CHANGE_SET] =
+	    g_signal_new (NM_PLATFORM_SIGNAL_CHANGE_SET,
+	                  G_OBJECT_CLASS_TYPE (object_class),
+	                  G_SIGNAL_RUN_FIRST,
+	                  0, NULL, NULL, NULL,
+	                  G_TYPE_NONE, 1,
+	                  G_TYPE_POINTER /* const NMPlatformChangeSet * */);
 }
@@ -262,6 +262,7 @@ typedef enum { /*< skip >*/
 	NM_PLATFORM_SIGNAL_ID_ROUTING_RULE,
 	NM_PLATFORM_SIGNAL_ID_QDISC,
 	NM_PLATFORM_SIGNAL_ID_TFILTER,
+	NM_PLATFORM_SIGNAL_ID_CHANGE_SET,
 	_NM_PLATFORM_SIGNAL_ID_LAST,
 } NMPlatformSignalIdType;
 
@@ -389,6 +390,30 @@ typedef union {
  * configures addresses. */
 #define NM_PLATFORM_ROUTE_METRIC_IP4_DEVICE_ROUTE 0
 
+typedef struct {
+	/* RTA_METRICS.RTAX_WINDOW (iproute2: window) */
+	guint32 window;
+
+	/* RTA_METRICS.RTAX_CWND (iproute2: cwnd) */
+	guint32 cwnd;
+
+	/* RTA_METRICS.RTAX_INITCWND (iproute2: initcwnd) */
+	guint32 initcwnd;
+
+	/* RTA_METRICS.RTAX_INITRWND (iproute2: initrwnd) */
+	guint32 initrwnd;
+
+	/* RTA_METRICS.RTAX_MTU (iproute2: mtu) */
+	guint32 mtu;
+
+	/* RTA_METRICS.RTAX_LOCK (iproute2: "lock" arguments) */
+	bool lock_window:1;
+	bool lock_cwnd:1;
+	bool lock_initcwnd:1;
+	bool lock_initrwnd:1;
+	bool lock_mtu:1;
+} NMPlatformRouteRtax;
+
 #define __NMPlatformIPRoute_COMMON \
 	__NMPlatformObjWithIfindex_COMMON; \
 	\
@@ -420,13 +445,6 @@ typedef union {
 	 * That is a problem/bug for IPv4 because you cannot explicitly select which
 	 * route to delete. Kernel just picks the first. See rh#1475642. */ \
 	\
-	/* RTA_METRICS.RTAX_LOCK (iproute2: "lock" arguments) */ \
-	bool lock_window:1; \
-	bool lock_cwnd:1; \
-	bool lock_initcwnd:1; \
-	bool lock_initrwnd:1; \
-	bool lock_mtu:1; \
-	\
 	/* rtnh_flags
 	 *
 	 * Routes with rtm_flags RTM_F_CLONED are hidden by platform and
@@ -442,21 +460,13 @@ typedef union {
 	/* RTA_METRICS.RTAX_ADVMSS (iproute2: advmss) */ \
 	guint32 mss; \
 	\
-	/* RTA_METRICS.RTAX_WINDOW (iproute2: window) */ \
-	guint32 window; \
-	\
-	/* RTA_METRICS.RTAX_CWND (iproute2: cwnd) */ \
-	guint32 cwnd; \
-	\
-	/* RTA_METRICS.RTAX_INITCWND (iproute2: initcwnd) */ \
-	guint32 initcwnd; \
-	\
-	/* RTA_METRICS.RTAX_INITRWND (iproute2: initrwnd) */ \
-	guint32 initrwnd; \
-	\
-	/* RTA_METRICS.RTAX_MTU (iproute2: mtu) */ \
-	guint32 mtu; \
-	\
+	/* The remaining RTA_METRICS (window, cwnd, initcwnd, initrwnd, mtu
+	 * and their locks) are rarely set. This is the id of an
+	 * NMPlatformRouteRtax, which encodes a single metric inline or refers
+	 * to an interned block. Zero means that none of them is set. Use
+	 * NM_PLATFORM_IP_ROUTE_RTAX() to access them and
+	 * nm_platform_route_rtax_intern() to set them. */ \
+	guint32 rtax_id; \
 	\
 	/* RTA_PRIORITY (iproute2: metric) */ \
 	guint32 metric; \
@@ -491,6 +501,14 @@ typedef struct {
 #define NM_PLATFORM_IP_ROUTE_IS_DEFAULT(route) \
 	(NM_PLATFORM_IP_ROUTE_CAST (route)->plen <= 0)
 
+const NMPlatformRouteRtax *nm_platform_route_rtax_get (guint32 rtax_id, NMPlatformRouteRtax *buf);
+
+guint32 nm_platform_route_rtax_intern (const NMPlatformRouteRtax *rtax);
+
+/* the result is valid until the end of the enclosing block. */
+#define NM_PLATFORM_IP_ROUTE_RTAX(route) \
+	nm_platform_route_rtax_get (NM_PLATFORM_IP_ROUTE_CAST (route)->rtax_id, &((NMPlatformRouteRtax) { 0 }))
+
 struct _NMPlatformIP4Route {
 	__NMPlatformIPRoute_COMMON;
 	in_addr_t network;
@@ -927,8 +945,25 @@ typedef enum {
 
 } NMPlatformWireGuardChangePeerFlags;
 
+typedef enum {
+	NM_PLATFORM_ETHTOOL_QUERY_NONE                                = 0,
+	NM_PLATFORM_ETHTOOL_QUERY_DRIVER_INFO                         = (1LL << 0),
+	NM_PLATFORM_ETHTOOL_QUERY_PERMANENT_ADDRESS                   = (1LL << 1),
+	NM_PLATFORM_ETHTOOL_QUERY_FEATURES                            = (1LL << 2),
+	NM_PLATFORM_ETHTOOL_QUERY_COALESCE                            = (1LL << 3),
+	NM_PLATFORM_ETHTOOL_QUERY_RING                                = (1LL << 4),
+
+	NM_PLATFORM_ETHTOOL_QUERY_ALL                                 =   NM_PLATFORM_ETHTOOL_QUERY_DRIVER_INFO
+	                                                                | NM_PLATFORM_ETHTOOL_QUERY_PERMANENT_ADDRESS
+	                                                                | NM_PLATFORM_ETHTOOL_QUERY_FEATURES
+	                                                                | NM_PLATFORM_ETHTOOL_QUERY_COALESCE
+	                                                                | NM_PLATFORM_ETHTOOL_QUERY_RING,
+} NMPlatformEthtoolQueryFlags;
+
 typedef void (*NMPlatformAsyncCallback) (GError *error, gpointer user_data);
 
+typedef struct _NMPlatformSysctlBatch NMPlatformSysctlBatch;
+
 /*****************************************************************************/
 
 typedef enum {
@@ -984,6 +1019,20 @@ struct _NMPlatform {
 	struct _NMPlatformPrivate *_priv;
 };
 
+typedef struct {
+	/* lookups of ip conf sysctls served from the cache. */
+	guint64 hits;
+
+	/* lookups of ip conf sysctls that had to read the file. */
+	guint64 misses;
+
+	/* cached values that were updated from RTM_NEWNETCONF. */
+	guint64 updates_netconf;
+
+	/* the number of currently cached values. */
+	guint n_entries;
+} NMPlatformSysctlCacheStats;
+
 typedef struct {
 	GObjectClass parent;
 
@@ -997,8 +1046,17 @@ typedef struct {
 	                           gpointer data,
 	                           GCancellable *cancellable);
 	char * (*sysctl_get) (NMPlatform *self, const char *pathid, int dirfd, const char *path);
+	gboolean (*sysctl_cache_get_stats) (NMPlatform *self, NMPlatformSysctlCacheStats *out_stats);
+	void (*sysctl_batch_commit) (NMPlatform *self,
+	                             NMPlatformSysctlBatch *batch,
+	                             NMPlatformAsyncCallback callback,
+	                             gpointer data,
+	                             GCancellable *cancellable);
 
 	void (*refresh_all) (NMPlatform *self, NMPObjectType obj_type);
+	void (*refresh_filtered) (NMPlatform *self, NMPObjectType obj_type, int ifindex, guint32 table);
+	void (*netlink_config_set) (NMPlatform *self, guint rcvbuf_max, gboolean resync_affected_only);
+	void (*netlink_worker_set) (NMPlatform *self, gboolean enabled);
 	void (*process_events) (NMPlatform *self);
 
 	int (*link_add) (NMPlatform *self,
@@ -1013,6 +1071,10 @@ typedef struct {
 	gboolean (*link_refresh) (NMPlatform *self, int ifindex);
 	gboolean (*link_set_netns) (NMPlatform *self, int ifindex, int netns_fd);
 	gboolean (*link_set_up) (NMPlatform *self, int ifindex, gboolean *out_no_firmware);
+	void (*link_set_up_many) (NMPlatform *self,
+	                          const int *ifindexes,
+	                          guint len,
+	                          int *out_results);
 	gboolean (*link_set_down) (NMPlatform *self, int ifindex);
 	gboolean (*link_set_arp) (NMPlatform *self, int ifindex);
 	gboolean (*link_set_noarp) (NMPlatform *self, int ifindex);
@@ -1106,6 +1168,10 @@ typedef struct {
 	gboolean    (*wpan_set_channel)      (NMPlatform *self, int ifindex, guint8 page, guint8 channel);
 
 	gboolean (*object_delete) (NMPlatform *self, const NMPObject *obj);
+	void (*object_delete_many) (NMPlatform *self,
+	                            const NMPObject *const*objs,
+	                            guint len,
+	                            gboolean *out_results);
 
 	gboolean (*ip4_address_add) (NMPlatform *self,
 	                             int ifindex,
@@ -1127,11 +1193,27 @@ typedef struct {
 	                             guint32 flags);
 	gboolean (*ip4_address_delete) (NMPlatform *self, int ifindex, in_addr_t address, guint8 plen, in_addr_t peer_address);
 	gboolean (*ip6_address_delete) (NMPlatform *self, int ifindex, struct in6_addr address, guint8 plen);
+	void (*ip_address_add_many) (NMPlatform *self,
+	                             int addr_family,
+	                             const NMPlatformIPXAddress *addresses,
+	                             guint len,
+	                             gboolean *out_results);
+	void (*ip_address_delete_many) (NMPlatform *self,
+	                                int addr_family,
+	                                const NMPlatformIPXAddress *addresses,
+	                                guint len,
+	                                gboolean *out_results);
 
 	int (*ip_route_add) (NMPlatform *self,
 	                     NMPNlmFlags flags,
 	                     int addr_family,
 	                     const NMPlatformIPRoute *route);
+	void (*ip_route_add_many) (NMPlatform *self,
+	                           NMPNlmFlags flags,
+	                           int addr_family,
+	                           const NMPObject *const*routes,
+	                           guint len,
+	                           int *out_results);
 	int (*ip_route_get) (NMPlatform *self,
 	                     int addr_family,
 	                     gconstpointer address,
@@ -1141,6 +1223,11 @@ typedef struct {
 	int (*routing_rule_add) (NMPlatform *self,
 	                         NMPNlmFlags flags,
 	                         const NMPlatformRoutingRule *routing_rule);
+	void (*routing_rule_add_many) (NMPlatform *self,
+	                               NMPNlmFlags flags,
+	                               const NMPObject *const*objs,
+	                               guint len,
+	                               int *out_results);
 
 	int (*qdisc_add)   (NMPlatform *self,
 	                    NMPNlmFlags flags,
@@ -1149,6 +1236,12 @@ typedef struct {
 	int (*tfilter_add)   (NMPlatform *self,
 	                      NMPNlmFlags flags,
 	                      const NMPlatformTfilter *tfilter);
+
+	void (*tc_add_many) (NMPlatform *self,
+	                     NMPNlmFlags flags,
+	                     const NMPObject *const*objs,
+	                     guint len,
+	                     int *out_results);
 } NMPlatformClass;
 
 /* NMPlatform signals
@@ -1171,8 +1264,44 @@ typedef struct {
 #define NM_PLATFORM_SIGNAL_QDISC_CHANGED "qdisc-changed"
 #define NM_PLATFORM_SIGNAL_TFILTER_CHANGED "tfilter-changed"
 
+/* NM_PLATFORM_SIGNAL_CHANGE_SET is emitted once per main loop iteration
+ * for every object type and ifindex that saw changes. The handler gets
+ * a const NMPlatformChangeSet pointer. It only exists while the handler
+ * is called.
+ *
+ * Unlike with the per-object signals above, the cache already contains
+ * all changes when the signal is emitted. Subscribers that react to bulk
+ * changes (like a routing daemon installing many routes) should prefer
+ * this signal. */
+#define NM_PLATFORM_SIGNAL_CHANGE_SET "change-set"
+
+#define NM_PLATFORM_CHANGE_SET_OBJS_MAX 5000
+
+typedef struct {
+	NMPObjectType obj_type;
+
+	/* the ifindex of the objects, or 0 for routing rules. */
+	int ifindex;
+
+	/* how often an object was added, changed or removed. */
+	guint n_added;
+	guint n_changed;
+	guint n_removed;
+
+	/* the affected objects, each one only once in its latest version.
+	 * For removed objects, that is the version that was removed. If more
+	 * than %NM_PLATFORM_CHANGE_SET_OBJS_MAX objects changed, @objs is %NULL
+	 * and @n_objs is zero, and the subscriber must look at the cache. */
+	const NMPObject *const*objs;
+	guint n_objs;
+} NMPlatformChangeSet;
+
 const char *nm_platform_signal_change_type_to_string (NMPlatformSignalChangeType change_type);
 
+void nm_platform_change_set_flush (NMPlatform *self,
+                                   NMPObjectType obj_type,
+                                   int ifindex);
+
 /*****************************************************************************/
 
 GType nm_platform_get_type (void);
@@ -1366,6 +1495,24 @@ void nm_platform_sysctl_set_async (NMPlatform *self,
 char *nm_platform_sysctl_get (NMPlatform *self, const char *pathid, int dirfd, const char *path);
 gint32 nm_platform_sysctl_get_int32 (NMPlatform *self, const char *pathid, int dirfd, const char *path, gint32 fallback);
 gint64 nm_platform_sysctl_get_int_checked (NMPlatform *self, const char *pathid, int dirfd, const char *path, guint base, gint64 min, gint64 max, gint64 fallback);
+gboolean nm_platform_sysctl_cache_get_stats (NMPlatform *self, NMPlatformSysctlCacheStats *out_stats);
+
+NMPlatformSysctlBatch *nm_platform_sysctl_batch_new (NMPlatform *self);
+void nm_platform_sysctl_batch_free (NMPlatformSysctlBatch *batch);
+void nm_platform_sysctl_batch_add (NMPlatformSysctlBatch *batch, const char *pathid, int dirfd, const char *path, const char *value);
+void nm_platform_sysctl_batch_add_ip_conf (NMPlatformSysctlBatch *batch,
+                                           int addr_family,
+                                           const char *ifname,
+                                           const char *property,
+                                           const char *value);
+guint nm_platform_sysctl_batch_get_len (const NMPlatformSysctlBatch *batch);
+void nm_platform_sysctl_batch_commit (NMPlatformSysctlBatch *batch,
+                                      NMPlatformAsyncCallback callback,
+                                      gpointer data,
+                                      GCancellable *cancellable);
+
+NM_AUTO_DEFINE_FCN0 (NMPlatformSysctlBatch *, _nm_auto_free_sysctl_batch, nm_platform_sysctl_batch_free);
+#define nm_auto_free_sysctl_batch nm_auto(_nm_auto_free_sysctl_batch)
 
 char *nm_platform_sysctl_ip_conf_get (NMPlatform *self,
                                       int addr_family,
@@ -1659,12 +1806,27 @@ const char *nm_platform_link_get_type_name (NMPlatform *self, int ifindex);
 
 gboolean nm_platform_link_refresh (NMPlatform *self, int ifindex);
 void nm_platform_process_events (NMPlatform *self);
+void nm_platform_refresh_filtered (NMPlatform *self,
+                                   NMPObjectType obj_type,
+                                   int ifindex,
+                                   guint32 table);
+
+void nm_platform_netlink_config_set (NMPlatform *self,
+                                     guint rcvbuf_max,
+                                     gboolean resync_affected_only);
+
+void nm_platform_netlink_worker_set (NMPlatform *self,
+                                     gboolean enabled);
 
 const NMPlatformLink *nm_platform_process_events_ensure_link (NMPlatform *self,
                                                               int ifindex,
                                                               const char *ifname);
 
 gboolean nm_platform_link_set_up (NMPlatform *self, int ifindex, gboolean *out_no_firmware);
+void nm_platform_link_set_up_many (NMPlatform *self,
+                                   const int *ifindexes,
+                                   guint len,
+                                   int *out_results);
 gboolean nm_platform_link_set_down (NMPlatform *self, int ifindex);
 gboolean nm_platform_link_set_arp (NMPlatform *self, int ifindex);
 gboolean nm_platform_link_set_noarp (NMPlatform *self, int ifindex);
@@ -1678,6 +1840,17 @@ int nm_platform_link_set_user_ipv6ll_enabled (NMPlatform *self, int ifindex, gbo
 gboolean nm_platform_link_set_ipv6_token (NMPlatform *self, int ifindex, NMUtilsIPv6IfaceId iid);
 
 gboolean nm_platform_link_get_permanent_address (NMPlatform *self, int ifindex, guint8 *buf, size_t *length);
+
+void nm_platform_link_ethtool_prefetch (NMPlatform *self,
+                                        const int *ifindexes,
+                                        guint len);
+void nm_platform_link_ethtool_query_async (NMPlatform *self,
+                                           int ifindex,
+                                           NMPlatformEthtoolQueryFlags what,
+                                           NMPlatformAsyncCallback callback,
+                                           gpointer callback_data,
+                                           GCancellable *cancellable);
+NMPlatformEthtoolQueryFlags _nmtst_platform_ethtool_cache_get_valid (NMPlatform *self, int ifindex);
 int nm_platform_link_set_address (NMPlatform *self, int ifindex, const void *address, size_t length);
 int nm_platform_link_set_mtu (NMPlatform *self, int ifindex, guint32 mtu);
 gboolean nm_platform_link_set_name (NMPlatform *self, int ifindex, const char *name);
@@ -1816,6 +1989,10 @@ int nm_platform_link_wireguard_change (NMPlatform *self,
 const NMPlatformIP6Address *nm_platform_ip6_address_get (NMPlatform *self, int ifindex, struct in6_addr address);
 
 gboolean nm_platform_object_delete (NMPlatform *self, const NMPObject *route);
+void nm_platform_object_delete_many (NMPlatform *self,
+                                     const NMPObject *const*objs,
+                                     guint len,
+                                     gboolean *out_results);
 
 gboolean nm_platform_ip4_address_add (NMPlatform *self,
                                       int ifindex,
@@ -1837,6 +2014,16 @@ gboolean nm_platform_ip6_address_add (NMPlatform *self,
                                       guint32 flags);
 gboolean nm_platform_ip4_address_delete (NMPlatform *self, int ifindex, in_addr_t address, guint8 plen, in_addr_t peer_address);
 gboolean nm_platform_ip6_address_delete (NMPlatform *self, int ifindex, struct in6_addr address, guint8 plen);
+gboolean nm_platform_ip_address_add_many (NMPlatform *self,
+                                         int addr_family,
+                                         const NMPlatformIPXAddress *addresses,
+                                         guint len,
+                                         gboolean *out_results);
+gboolean nm_platform_ip_address_delete_many (NMPlatform *self,
+                                            int addr_family,
+                                            const NMPlatformIPXAddress *addresses,
+                                            guint len,
+                                            gboolean *out_results);
 gboolean nm_platform_ip4_address_sync (NMPlatform *self, int ifindex, GPtrArray *known_addresses);
 gboolean nm_platform_ip6_address_sync (NMPlatform *self, int ifindex, GPtrArray *known_addresses, gboolean full_sync);
 gboolean nm_platform_ip_address_flush (NMPlatform *self,
@@ -1851,6 +2038,11 @@ int nm_platform_ip_route_add (NMPlatform *self,
                               const NMPObject *route);
 int nm_platform_ip4_route_add (NMPlatform *self, NMPNlmFlags flags, const NMPlatformIP4Route *route);
 int nm_platform_ip6_route_add (NMPlatform *self, NMPNlmFlags flags, const NMPlatformIP6Route *route);
+void nm_platform_ip_route_add_many (NMPlatform *self,
+                                    NMPNlmFlags flags,
+                                    const NMPObject *const*routes,
+                                    guint len,
+                                    int *out_results);
 
 GPtrArray *nm_platform_ip_route_get_prune_list (NMPlatform *self,
                                                 int addr_family,
@@ -1877,6 +2069,11 @@ int nm_platform_ip_route_get (NMPlatform *self,
 int nm_platform_routing_rule_add (NMPlatform *self,
                                   NMPNlmFlags flags,
                                   const NMPlatformRoutingRule *routing_rule);
+void nm_platform_routing_rule_add_many (NMPlatform *self,
+                                        NMPNlmFlags flags,
+                                        const NMPObject *const*objs,
+                                        guint len,
+                                        int *out_results);
 
 int nm_platform_qdisc_add   (NMPlatform *self,
                              NMPNlmFlags flags,
@@ -1892,6 +2089,12 @@ gboolean nm_platform_tfilter_sync         (NMPlatform *self,
                                            int ifindex,
                                            GPtrArray *known_tfilters);
 
+void nm_platform_tc_add_many (NMPlatform *self,
+                              NMPNlmFlags flags,
+                              const NMPObject *const*objs,
+                              guint len,
+                              int *out_results);
+
 const char *nm_platform_link_to_string (const NMPlatformLink *link, char *buf, gsize len);
 const char *nm_platform_lnk_gre_to_string (const NMPlatformLnkGre *lnk, char *buf, gsize len);
 const char *nm_platform_lnk_infiniband_to_string (const NMPlatformLnkInfiniband *lnk, char *buf, gsize len);
@@ -2041,6 +2244,18 @@ void nm_platform_ip4_dev_route_blacklist_set (NMPlatform *self,
                                               int ifindex,
                                               GPtrArray *ip4_dev_route_blacklist);
 
+gboolean nm_platform_route_cache_scope_set (NMPlatform *self,
+                                            const guint8 *ignore_protocols,
+                                            guint n_ignore_protocols,
+                                            const guint32 *ignore_tables,
+                                            guint n_ignore_tables);
+
+gboolean nm_platform_route_cache_scope_ignores (NMPlatform *self,
+                                                guint8 rtm_protocol,
+                                                guint32 table);
+
+guint64 nm_platform_route_cache_scope_get_n_ignored (NMPlatform *self);
+
 struct _NMDedupMultiIndex *nm_platform_get_multi_idx (NMPlatform *self);
 
 #endif /* __NETWORKMANAGER_PLATFORM_H__ */
@@ -8,11 +8,15 @@
 #include "nmp-object.h"
 
 #include <unistd.h>
+#include <sys/mman.h>
 #include <linux/rtnetlink.h>
 #include <linux/if.h>
 #include <libudev.h>
 
+#include "c-rbtree/src/c-rbtree.h"
+
 #include "nm-utils.h"
+#include "nm-glib-aux/nm-c-list.h"
 #include "nm-glib-aux/nm-secret-utils.h"
 
 #include "nm-core-utils.h"
@@ -69,9 +73,37 @@ struct _NMPCache {
 	 * Don't bother, use _idx_type_get() instead! */
 	DedupMultiIdxType idx_types[NMP_CACHE_ID_TYPE_MAX];
 
+	/* bumped whenever an object is added, changed or removed. Overall, and
+	 * per object type. Snapshots use it to tell whether they are stale.
+	 * Only the owner thread writes them, but other threads may read. */
+	volatile guint version;
+	guint versions[NMP_OBJECT_TYPE_MAX + 1];
+
+	/* all links, ordered by ifindex and by name. Each LinkOrderNode is
+	 * linked in both trees. They let nmp_cache_link_get_all_sorted()
+	 * return the links in order without sorting. */
+	CRBTree links_by_ifindex;
+	CRBTree links_by_name;
+
 	gboolean use_udev;
 };
 
+typedef enum {
+	LINK_ORDER_VISIT_SKIP,
+	LINK_ORDER_VISIT_NONE,
+	LINK_ORDER_VISIT_PENDING,
+	LINK_ORDER_VISIT_DONE,
+} LinkOrderVisit;
+
+typedef struct {
+	CRBNode node_ifindex;
+	CRBNode node_name;
+	const NMPObject *obj;
+
+	/* scratch state of nmp_cache_link_get_all_sorted(). */
+	LinkOrderVisit visit:8;
+} LinkOrderNode;
+
 /*****************************************************************************/
 
 int
@@ -592,16 +624,19 @@ _wireguard_peer_hash_update (const NMPWireGuardPeer *peer,
 
 static int
 _wireguard_peer_cmp (const NMPWireGuardPeer *a,
-                     const NMPWireGuardPeer *b)
+                     const NMPWireGuardPeer *b,
+                     gboolean with_stats)
 {
 	guint i;
 
 	NM_CMP_SELF (a, b);
 
-	NM_CMP_FIELD (a, b, last_handshake_time.tv_sec);
-	NM_CMP_FIELD (a, b, last_handshake_time.tv_nsec);
-	NM_CMP_FIELD (a, b, rx_bytes);
-	NM_CMP_FIELD (a, b, tx_bytes);
+	if (with_stats) {
+		NM_CMP_FIELD (a, b, last_handshake_time.tv_sec);
+		NM_CMP_FIELD (a, b, last_handshake_time.tv_nsec);
+		NM_CMP_FIELD (a, b, rx_bytes);
+		NM_CMP_FIELD (a, b, tx_bytes);
+	}
 	NM_CMP_FIELD (a, b, allowed_ips_len);
 	NM_CMP_FIELD (a, b, persistent_keepalive_interval);
 	NM_CMP_FIELD (a, b, endpoint.sa.sa_family);
@@ -618,6 +653,332 @@ _wireguard_peer_cmp (const NMPWireGuardPeer *a,
 	return 0;
 }
 
+/**
+ * nmp_object_lnk_wireguard_equal_config:
+ * @a: a #NMPObjectLnkWireGuard
+ * @b: a #NMPObjectLnkWireGuard
+ *
+ * Like nmp_object_equal(), but ignores the statistics of the peers
+ * (handshake time, rx/tx bytes).
+ *
+ * Returns: whether @a and @b have the same configuration.
+ */
+gboolean
+nmp_object_lnk_wireguard_equal_config (const NMPObject *a, const NMPObject *b)
+{
+	guint i;
+
+	nm_assert (!a || NMP_OBJECT_GET_TYPE (a) == NMP_OBJECT_TYPE_LNK_WIREGUARD);
+	nm_assert (!b || NMP_OBJECT_GET_TYPE (b) == NMP_OBJECT_TYPE_LNK_WIREGUARD);
+
+	if (a == b)
+		return TRUE;
+	if (!a || !b)
+		return FALSE;
+
+	if (nm_platform_lnk_wireguard_cmp (&a->lnk_wireguard, &b->lnk_wireguard) != 0)
+		return FALSE;
+	if (a->_lnk_wireguard.peers_len != b->_lnk_wireguard.peers_len)
+		return FALSE;
+	for (i = 0; i < a->_lnk_wireguard.peers_len; i++) {
+		if (_wireguard_peer_cmp (&a->_lnk_wireguard.peers[i], &b->_lnk_wireguard.peers[i], FALSE) != 0)
+			return FALSE;
+	}
+	return TRUE;
+}
+
+static guint
+_wireguard_peer_public_key_hash (gconstpointer ptr)
+{
+	const NMPWireGuardPeer *peer = ptr;
+
+	return nm_hash_mem (1405437197u, peer->public_key, sizeof (peer->public_key));
+}
+
+static gboolean
+_wireguard_peer_public_key_equal (gconstpointer a, gconstpointer b)
+{
+	const NMPWireGuardPeer *peer_a = a;
+	const NMPWireGuardPeer *peer_b = b;
+
+	return memcmp (peer_a->public_key, peer_b->public_key, sizeof (peer_a->public_key)) == 0;
+}
+
+static guint
+_wireguard_allowed_ip_hash (gconstpointer ptr)
+{
+	const NMPWireGuardAllowedIP *aip = ptr;
+	NMHashState h;
+
+	nm_hash_init (&h, 3176478581u);
+	nm_hash_update_vals (&h, aip->family, aip->mask);
+	nm_hash_update (&h, &aip->addr, nm_utils_addr_family_to_size (aip->family));
+	return nm_hash_complete (&h);
+}
+
+static gboolean
+_wireguard_allowed_ip_equal (gconstpointer a, gconstpointer b)
+{
+	const NMPWireGuardAllowedIP *aip_a = a;
+	const NMPWireGuardAllowedIP *aip_b = b;
+
+	return    aip_a->family == aip_b->family
+	       && aip_a->mask == aip_b->mask
+	       && memcmp (&aip_a->addr, &aip_b->addr, nm_utils_addr_family_to_size (aip_a->family)) == 0;
+}
+
+/**
+ * nmp_object_lnk_wireguard_create_change_delta:
+ * @lnk_cached: the currently configured #NMPObjectLnkWireGuard
+ * @lnk_wireguard: the requested device attributes
+ * @peers: the requested peers
+ * @peer_flags: (allow-none): the flags for @peers
+ * @peers_len: the number of @peers
+ * @inout_change_flags: the requested change flags. On return, the
+ *   flags for the reduced change
+ * @out_peers: the peers of the reduced change
+ * @out_peer_flags: the flags for @out_peers
+ * @out_peers_len: the number of @out_peers
+ * @out_allowed_ips_buf: the buffer that the allowed-ips of @out_peers
+ *   may point to
+ *
+ * Reduces the requested change to what differs from the current configuration
+ * in @lnk_cached. Peers and attributes that are already configured as requested
+ * are dropped, peers that are no longer wanted get removed one by one instead
+ * of replacing all peers, and allowed-ips are only replaced if some of the
+ * configured ones must go away. Otherwise, only the missing ones are added.
+ *
+ * The resulting peers point into @out_allowed_ips_buf and into @peers.
+ */
+void
+nmp_object_lnk_wireguard_create_change_delta (const NMPObject *lnk_cached,
+                                              const NMPlatformLnkWireGuard *lnk_wireguard,
+                                              const NMPWireGuardPeer *peers,
+                                              const NMPlatformWireGuardChangePeerFlags *peer_flags,
+                                              guint peers_len,
+                                              NMPlatformWireGuardChangeFlags *inout_change_flags,
+                                              NMPWireGuardPeer **out_peers,
+                                              NMPlatformWireGuardChangePeerFlags **out_peer_flags,
+                                              guint *out_peers_len,
+                                              NMPWireGuardAllowedIP **out_allowed_ips_buf)
+{
+	const NMPObjectLnkWireGuard *cached = &lnk_cached->_lnk_wireguard;
+	gs_unref_hashtable GHashTable *cached_peers = NULL;
+	gs_unref_array GArray *allowed_ips = NULL;
+	gs_free gboolean *d_construct = NULL;
+	NMPlatformWireGuardChangeFlags change_flags = *inout_change_flags;
+	NMPWireGuardPeer *d_peers;
+	NMPlatformWireGuardChangePeerFlags *d_peer_flags;
+	guint d_len = 0;
+	guint i, j;
+
+	if (   NM_FLAGS_HAS (change_flags, NM_PLATFORM_WIREGUARD_CHANGE_FLAG_HAS_PRIVATE_KEY)
+	    && memcmp (lnk_wireguard->private_key, cached->_public.private_key, sizeof (lnk_wireguard->private_key)) == 0)
+		change_flags &= ~NM_PLATFORM_WIREGUARD_CHANGE_FLAG_HAS_PRIVATE_KEY;
+	if (   NM_FLAGS_HAS (change_flags, NM_PLATFORM_WIREGUARD_CHANGE_FLAG_HAS_LISTEN_PORT)
+	    && lnk_wireguard->listen_port == cached->_public.listen_port)
+		change_flags &= ~NM_PLATFORM_WIREGUARD_CHANGE_FLAG_HAS_LISTEN_PORT;
+	if (   NM_FLAGS_HAS (change_flags, NM_PLATFORM_WIREGUARD_CHANGE_FLAG_HAS_FWMARK)
+	    && lnk_wireguard->fwmark == cached->_public.fwmark)
+		change_flags &= ~NM_PLATFORM_WIREGUARD_CHANGE_FLAG_HAS_FWMARK;
+
+	/* at most, we remove all cached peers and configure all requested ones. */
+	d_peers = g_new0 (NMPWireGuardPeer, peers_len + cached->peers_len);
+	d_peer_flags = g_new0 (NMPlatformWireGuardChangePeerFlags, peers_len + cached->peers_len);
+	d_construct = g_new0 (gboolean, peers_len + cached->peers_len);
+
+	cached_peers = g_hash_table_new (_wireguard_peer_public_key_hash, _wireguard_peer_public_key_equal);
+	for (i = 0; i < cached->peers_len; i++)
+		g_hash_table_add (cached_peers, (gpointer) &cached->peers[i]);
+
+	for (i = 0; i < peers_len; i++) {
+		const NMPWireGuardPeer *p = &peers[i];
+		const NMPWireGuardPeer *c;
+		NMPlatformWireGuardChangePeerFlags p_flags;
+		NMPWireGuardPeer *d;
+		gboolean aip_add_only = FALSE;
+		gboolean clear_preshared_key = FALSE;
+		gboolean clear_keepalive_interval = FALSE;
+
+		p_flags =   peer_flags
+		          ? peer_flags[i]
+		          : NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_DEFAULT;
+
+		c = g_hash_table_lookup (cached_peers, p);
+		if (c) {
+			/* the peer is still wanted (or handled explicitly). It must not be
+			 * removed below. */
+			g_hash_table_remove (cached_peers, c);
+		}
+
+		if (NM_FLAGS_HAS (p_flags, NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_REMOVE_ME)) {
+			if (!c)
+				continue;
+			p_flags = NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_REMOVE_ME;
+		} else if (   c
+		           && NM_FLAGS_HAS (change_flags, NM_PLATFORM_WIREGUARD_CHANGE_FLAG_REPLACE_PEERS)
+		           && !NM_FLAGS_HAS (p_flags, NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_ENDPOINT)
+		           && c->endpoint.sa.sa_family != AF_UNSPEC) {
+			/* with replace-peers, the peer would be created anew without
+			 * endpoint. The endpoint of an existing peer cannot be cleared,
+			 * so remove the peer first, and add it again as requested. */
+			memcpy (d_peers[d_len].public_key, c->public_key, sizeof (c->public_key));
+			d_peer_flags[d_len] = NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_REMOVE_ME;
+			d_len++;
+		} else if (c) {
+			if (NM_FLAGS_HAS (change_flags, NM_PLATFORM_WIREGUARD_CHANGE_FLAG_REPLACE_PEERS)) {
+				/* with replace-peers, the peer would be created anew. Attributes
+				 * that are not requested, would be reset. Since we don't recreate
+				 * the peer, reset them explicitly. The peer has no endpoint
+				 * that would need clearing (see above). */
+				p_flags |= NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_REPLACE_ALLOWEDIPS;
+				if (!NM_FLAGS_HAS (p_flags, NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_PRESHARED_KEY)) {
+					p_flags |= NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_PRESHARED_KEY;
+					clear_preshared_key = TRUE;
+				}
+				if (!NM_FLAGS_HAS (p_flags, NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_KEEPALIVE_INTERVAL)) {
+					p_flags |= NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_KEEPALIVE_INTERVAL;
+					clear_keepalive_interval = TRUE;
+				}
+			}
+
+			if (   NM_FLAGS_HAS (p_flags, NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_PRESHARED_KEY)
+			    && clear_preshared_key
+			    && nm_utils_memeqzero (c->preshared_key, sizeof (c->preshared_key)))
+				p_flags &= ~NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_PRESHARED_KEY;
+			if (   NM_FLAGS_HAS (p_flags, NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_PRESHARED_KEY)
+			    && !clear_preshared_key
+			    && memcmp (p->preshared_key, c->preshared_key, sizeof (p->preshared_key)) == 0)
+				p_flags &= ~NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_PRESHARED_KEY;
+			if (   NM_FLAGS_HAS (p_flags, NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_KEEPALIVE_INTERVAL)
+			    && (clear_keepalive_interval ? 0 : p->persistent_keepalive_interval) == c->persistent_keepalive_interval)
+				p_flags &= ~NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_KEEPALIVE_INTERVAL;
+			if (   NM_FLAGS_HAS (p_flags, NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_ENDPOINT)
+			    && nm_sock_addr_union_cmp (&p->endpoint, &c->endpoint) == 0)
+				p_flags &= ~NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_ENDPOINT;
+
+			if (NM_FLAGS_HAS (p_flags, NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_ALLOWEDIPS)) {
+				gs_unref_hashtable GHashTable *cached_aips = NULL;
+				guint n_found = 0;
+
+				/* count the distinct requested allowed-ips that are already configured. */
+				if (c->allowed_ips_len > 0) {
+					cached_aips = g_hash_table_new (_wireguard_allowed_ip_hash, _wireguard_allowed_ip_equal);
+					for (j = 0; j < c->allowed_ips_len; j++)
+						g_hash_table_add (cached_aips, (gpointer) &c->allowed_ips[j]);
+					for (j = 0; j < p->allowed_ips_len; j++) {
+						if (g_hash_table_remove (cached_aips, &p->allowed_ips[j]))
+							n_found++;
+					}
+				}
+
+				if (NM_FLAGS_HAS (p_flags, NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_REPLACE_ALLOWEDIPS)) {
+					if (   n_found == p->allowed_ips_len
+					    && n_found == c->allowed_ips_len) {
+						/* identical. */
+						p_flags &= ~(  NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_ALLOWEDIPS
+						             | NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_REPLACE_ALLOWEDIPS);
+					} else if (n_found == c->allowed_ips_len) {
+						/* none of the configured allowed-ips need to go away. Only
+						 * add the missing ones. */
+						p_flags &= ~NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_REPLACE_ALLOWEDIPS;
+						aip_add_only = (n_found > 0);
+					}
+				} else {
+					if (n_found == p->allowed_ips_len)
+						p_flags &= ~NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_ALLOWEDIPS;
+					else
+						aip_add_only = (n_found > 0);
+				}
+			} else if (   NM_FLAGS_HAS (p_flags, NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_REPLACE_ALLOWEDIPS)
+			           && c->allowed_ips_len == 0) {
+				/* nothing to clear. */
+				p_flags &= ~NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_REPLACE_ALLOWEDIPS;
+			}
+
+			if (!NM_FLAGS_ANY (p_flags,   NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_PRESHARED_KEY
+			                            | NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_KEEPALIVE_INTERVAL
+			                            | NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_ENDPOINT
+			                            | NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_ALLOWEDIPS
+			                            | NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_REPLACE_ALLOWEDIPS)) {
+				/* already configured as requested. */
+				continue;
+			}
+		}
+
+		d = &d_peers[d_len];
+		d_peer_flags[d_len] = p_flags;
+		d_len++;
+
+		*d = *p;
+		if (clear_preshared_key)
+			nm_explicit_bzero (d->preshared_key, sizeof (d->preshared_key));
+		if (clear_keepalive_interval)
+			d->persistent_keepalive_interval = 0;
+
+		if (aip_add_only) {
+			gs_unref_hashtable GHashTable *cached_aips = NULL;
+
+			cached_aips = g_hash_table_new (_wireguard_allowed_ip_hash, _wireguard_allowed_ip_equal);
+			for (j = 0; j < c->allowed_ips_len; j++)
+				g_hash_table_add (cached_aips, (gpointer) &c->allowed_ips[j]);
+
+			if (!allowed_ips)
+				allowed_ips = g_array_new (FALSE, FALSE, sizeof (NMPWireGuardAllowedIP));
+
+			/* the array may still grow. Track the indexes for now, and resolve
+			 * the pointers at the end. */
+			d->_construct_idx_start = allowed_ips->len;
+			for (j = 0; j < p->allowed_ips_len; j++) {
+				if (!g_hash_table_contains (cached_aips, &p->allowed_ips[j]))
+					g_array_append_val (allowed_ips, p->allowed_ips[j]);
+			}
+			d->_construct_idx_end = allowed_ips->len;
+
+			/* mark the peer, so that its allowed-ips get resolved below. */
+			d_construct[d_len - 1] = TRUE;
+		}
+	}
+
+	if (NM_FLAGS_HAS (change_flags, NM_PLATFORM_WIREGUARD_CHANGE_FLAG_REPLACE_PEERS)) {
+		GHashTableIter iter;
+		const NMPWireGuardPeer *c;
+
+		/* instead of replacing all peers, remove the ones that are no longer wanted. */
+		g_hash_table_iter_init (&iter, cached_peers);
+		while (g_hash_table_iter_next (&iter, (gpointer *) &c, NULL)) {
+			memcpy (d_peers[d_len].public_key, c->public_key, sizeof (c->public_key));
+			d_peer_flags[d_len] = NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_REMOVE_ME;
+			d_len++;
+		}
+		change_flags &= ~NM_PLATFORM_WIREGUARD_CHANGE_FLAG_REPLACE_PEERS;
+	}
+
+	*out_allowed_ips_buf =   allowed_ips && allowed_ips->len > 0
+	                       ? nm_memdup (allowed_ips->data, sizeof (NMPWireGuardAllowedIP) * allowed_ips->len)
+	                       : NULL;
+
+	for (i = 0; i < d_len; i++) {
+		NMPWireGuardPeer *d = &d_peers[i];
+		guint start;
+		guint end;
+
+		if (!d_construct[i])
+			continue;
+
+		start = d->_construct_idx_start;
+		end = d->_construct_idx_end;
+		d->allowed_ips = end > start ? &(*out_allowed_ips_buf)[start] : NULL;
+		d->allowed_ips_len = end - start;
+	}
+
+	*inout_change_flags = change_flags;
+	*out_peers = d_peers;
+	*out_peer_flags = d_peer_flags;
+	*out_peers_len = d_len;
+}
+
+
 /*****************************************************************************/
 
 static const char *
@@ -756,16 +1117,293 @@ _vt_cmd_obj_dispose_lnk_wireguard (NMPObject *obj)
 	_wireguard_clear (&obj->_lnk_wireguard);
 }
 
+/*****************************************************************************/
+
+/* The cache churns through large numbers of objects of few shapes (for
+ * example, when a routing table with many routes gets dumped again). The
+ * object types that can be numerous are allocated from per-type pools.
+ *
+ * A pool hands out fixed size elements from slabs. A slab is an mmap()ed
+ * chunk of NMP_SLAB_SIZE bytes, aligned to its size so that the slab of an
+ * element is found by masking the pointer. Freed elements go back to a free
+ * list of their slab. Once a slab is entirely unused, it is unmapped (except
+ * one, that is kept in reserve), so memory is returned to the system after
+ * the number of objects drops again.
+ *
+ * Objects are created on the netlink worker thread too, so a pool has a lock.
+ *
+ * Setting G_SLICE=always-malloc (like for valgrind) disables the pools. */
+
+#define NMP_SLAB_SIZE ((gsize) (64u * 1024u))
+
+#define _NMP_ALIGN_TO(x, align) (((x) + ((align) - 1u)) & ~((gsize) ((align) - 1u)))
+
+typedef struct _NMPObjectPool NMPObjectPool;
+
+typedef struct {
+	CList lst_slabs;
+	NMPObjectPool *pool;
+	gpointer free_list;
+	guint n_used;
+	guint n_bumped;
+} NMPSlab;
+
+#define NMP_SLAB_HEADER_SIZE _NMP_ALIGN_TO (sizeof (NMPSlab), 16u)
+
+struct _NMPObjectPool {
+	GMutex lock;
+	gsize elem_size;
+	guint n_per_slab;
+	CList lst_partial;
+	CList lst_full;
+	NMPSlab *reserve;
+	NMPObjectPoolStats stats;
+};
+
+static NMPObjectPool _object_pools[NMP_OBJECT_TYPE_MAX + 1];
+
+static gboolean
+_object_pools_enabled (void)
+{
+	static gsize enabled = 0;
+
+	if (g_once_init_enter (&enabled)) {
+		const char *env = g_getenv ("G_SLICE");
+
+		g_once_init_leave (&enabled,
+		                     (env && strstr (env, "always-malloc"))
+		                   ? 1u
+		                   : 2u);
+	}
+	return enabled == 2u;
+}
+
+static NMPObjectPool *
+_object_pool_get (const NMPClass *klass)
+{
+	NMPObjectPool *pool;
+
+	switch (klass->obj_type) {
+	case NMP_OBJECT_TYPE_LINK:
+	case NMP_OBJECT_TYPE_IP4_ADDRESS:
+	case NMP_OBJECT_TYPE_IP6_ADDRESS:
+	case NMP_OBJECT_TYPE_IP4_ROUTE:
+	case NMP_OBJECT_TYPE_IP6_ROUTE:
+	case NMP_OBJECT_TYPE_ROUTING_RULE:
+	case NMP_OBJECT_TYPE_QDISC:
+	case NMP_OBJECT_TYPE_TFILTER:
+		break;
+	default:
+		return NULL;
+	}
+
+	if (!_object_pools_enabled ())
+		return NULL;
+
+	pool = &_object_pools[klass->obj_type];
+	if (G_UNLIKELY (g_atomic_pointer_get (&pool->lst_partial.next) == NULL)) {
+		static GMutex init_lock;
+
+		g_mutex_lock (&init_lock);
+		if (!pool->lst_partial.next) {
+			g_mutex_init (&pool->lock);
+			pool->elem_size = _NMP_ALIGN_TO (klass->sizeof_data + G_STRUCT_OFFSET (NMPObject, object), sizeof (gpointer));
+			pool->n_per_slab = (NMP_SLAB_SIZE - NMP_SLAB_HEADER_SIZE) / pool->elem_size;
+			nm_assert (pool->n_per_slab > 1);
+			c_list_init (&pool->lst_full);
+			pool->lst_partial.prev = &pool->lst_partial;
+			/* set last. It marks the pool as initialized. */
+			g_atomic_pointer_set (&pool->lst_partial.next, &pool->lst_partial);
+		}
+		g_mutex_unlock (&init_lock);
+	}
+	return pool;
+}
+
+static NMPSlab *
+_object_pool_slab_new (NMPObjectPool *pool)
+{
+	guint8 *mem;
+	guint8 *aligned;
+	NMPSlab *slab;
+
+	/* over-allocate, and trim the mapping to an aligned slab. */
+	mem = mmap (NULL, 2 * NMP_SLAB_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (mem == MAP_FAILED)
+		g_error ("nmp-object: failed to allocate %zu bytes", 2 * NMP_SLAB_SIZE);
+
+	aligned = (guint8 *) _NMP_ALIGN_TO ((uintptr_t) mem, NMP_SLAB_SIZE);
+	if (aligned != mem)
+		munmap (mem, aligned - mem);
+	if (aligned + NMP_SLAB_SIZE != mem + 2 * NMP_SLAB_SIZE)
+		munmap (aligned + NMP_SLAB_SIZE, (mem + 2 * NMP_SLAB_SIZE) - (aligned + NMP_SLAB_SIZE));
+
+	slab = (NMPSlab *) aligned;
+	slab->pool = pool;
+	slab->free_list = NULL;
+	slab->n_used = 0;
+	slab->n_bumped = 0;
+
+	pool->stats.n_slabs++;
+	pool->stats.bytes += NMP_SLAB_SIZE;
+	return slab;
+}
+
+static void
+_object_pool_slab_free (NMPObjectPool *pool, NMPSlab *slab)
+{
+	nm_assert (slab->n_used == 0);
+
+	pool->stats.n_slabs--;
+	pool->stats.bytes -= NMP_SLAB_SIZE;
+	munmap (slab, NMP_SLAB_SIZE);
+}
+
+static gpointer
+_object_pool_alloc0 (NMPObjectPool *pool)
+{
+	NMPSlab *slab;
+	gpointer elem;
+
+	g_mutex_lock (&pool->lock);
+
+	slab = c_list_first_entry (&pool->lst_partial, NMPSlab, lst_slabs);
+	if (!slab) {
+		slab = g_steal_pointer (&pool->reserve);
+		if (!slab)
+			slab = _object_pool_slab_new (pool);
+		c_list_link_front (&pool->lst_partial, &slab->lst_slabs);
+	}
+
+	if (slab->free_list) {
+		elem = slab->free_list;
+		slab->free_list = *((gpointer *) elem);
+	} else {
+		nm_assert (slab->n_bumped < pool->n_per_slab);
+		elem = &((guint8 *) slab)[NMP_SLAB_HEADER_SIZE + (slab->n_bumped++ * pool->elem_size)];
+	}
+
+	if (++slab->n_used == pool->n_per_slab)
+		nm_c_list_move_front (&pool->lst_full, &slab->lst_slabs);
+
+	pool->stats.n_objs++;
+	pool->stats.n_allocs++;
+
+	g_mutex_unlock (&pool->lock);
+
+	memset (elem, 0, pool->elem_size);
+	return elem;
+}
+
+static void
+_object_pool_free (NMPObjectPool *pool, gpointer elem)
+{
+	NMPSlab *slab;
+
+	slab = (NMPSlab *) (((uintptr_t) elem) & ~((uintptr_t) (NMP_SLAB_SIZE - 1)));
+	nm_assert (slab->pool == pool);
+
+	g_mutex_lock (&pool->lock);
+
+	nm_assert (slab->n_used > 0);
+
+	if (slab->n_used-- == pool->n_per_slab)
+		nm_c_list_move_front (&pool->lst_partial, &slab->lst_slabs);
+
+	*((gpointer *) elem) = slab->free_list;
+	slab->free_list = elem;
+
+	if (slab->n_used == 0) {
+		c_list_unlink (&slab->lst_slabs);
+		if (!pool->reserve) {
+			slab->free_list = NULL;
+			slab->n_bumped = 0;
+			pool->reserve = slab;
+		} else
+			_object_pool_slab_free (pool, slab);
+	}
+
+	pool->stats.n_objs--;
+	pool->stats.n_frees++;
+
+	g_mutex_unlock (&pool->lock);
+}
+
+/**
+ * nmp_object_pool_get_stats:
+ * @obj_type: the object type
+ * @out_stats: (out): the statistics of the pool
+ *
+ * Returns: %FALSE if objects of @obj_type are not allocated from a pool.
+ */
+gboolean
+nmp_object_pool_get_stats (NMPObjectType obj_type,
+                           NMPObjectPoolStats *out_stats)
+{
+	NMPObjectPool *pool;
+
+	g_return_val_if_fail (out_stats, FALSE);
+
+	pool = _object_pool_get (nmp_class_from_type (obj_type));
+	if (!pool) {
+		*out_stats = (NMPObjectPoolStats) { 0 };
+		return FALSE;
+	}
+
+	g_mutex_lock (&pool->lock);
+	*out_stats = pool->stats;
+	g_mutex_unlock (&pool->lock);
+	return TRUE;
+}
+
+const char *
+nmp_object_pool_stats_to_string (char *buf, gsize len)
+{
+	char *b = buf;
+	NMPObjectType obj_type;
+	gboolean any = FALSE;
+
+	nm_utils_strbuf_init (buf, &b, &len);
+
+	for (obj_type = 1; obj_type <= NMP_OBJECT_TYPE_MAX; obj_type++) {
+		NMPObjectPoolStats stats;
+
+		if (!nmp_object_pool_get_stats (obj_type, &stats))
+			continue;
+		if (stats.n_slabs == 0 && stats.n_allocs == 0)
+			continue;
+		nm_utils_strbuf_append (&b, &len,
+		                        "%s%s %u objs, %u slabs (%zu KiB)",
+		                        any ? "; " : "",
+		                        nmp_class_from_type (obj_type)->obj_type_name,
+		                        stats.n_objs,
+		                        stats.n_slabs,
+		                        stats.bytes / 1024u);
+		any = TRUE;
+	}
+
+	if (!any)
+		nm_utils_strbuf_append_str (&b, &len, "none");
+	return buf;
+}
+
+/*****************************************************************************/
+
 static NMPObject *
 _nmp_object_new_from_class (const NMPClass *klass)
 {
+	NMPObjectPool *pool;
 	NMPObject *obj;
 
 	nm_assert (klass);
 	nm_assert (klass->sizeof_data > 0);
 	nm_assert (klass->sizeof_public > 0 && klass->sizeof_public <= klass->sizeof_data);
 
-	obj = g_slice_alloc0 (klass->sizeof_data + G_STRUCT_OFFSET (NMPObject, object));
+	pool = _object_pool_get (klass);
+	if (pool)
+		obj = _object_pool_alloc0 (pool);
+	else
+		obj = g_slice_alloc0 (klass->sizeof_data + G_STRUCT_OFFSET (NMPObject, object));
 	obj->_class = klass;
 	obj->parent._ref_count = 1;
 	return obj;
@@ -1228,7 +1866,7 @@ _vt_cmd_obj_cmp_lnk_wireguard (const NMPObject *obj1, const NMPObject *obj2)
 	NM_CMP_FIELD (obj1, obj2, _lnk_wireguard.peers_len);
 
 	for (i = 0; i < obj1->_lnk_wireguard.peers_len; i++)
-		NM_CMP_RETURN (_wireguard_peer_cmp (&obj1->_lnk_wireguard.peers[i], &obj2->_lnk_wireguard.peers[i]));
+		NM_CMP_RETURN (_wireguard_peer_cmp (&obj1->_lnk_wireguard.peers[i], &obj2->_lnk_wireguard.peers[i], TRUE));
 
 	return 0;
 }
@@ -1452,6 +2090,8 @@ _vt_cmd_plobj_id_cmp (qdisc, NMPlatformQdisc,
 )
 _vt_cmd_plobj_id_cmp (tfilter, NMPlatformTfilter,
                       NM_CMP_FIELD (obj1, obj2, ifindex);
+                      NM_CMP_FIELD (obj1, obj2, parent);
+                      NM_CMP_FIELD (obj1, obj2, info);
                       NM_CMP_FIELD (obj1, obj2, handle);
 )
 
@@ -1549,6 +2189,8 @@ _vt_cmd_plobj_id_hash_update (qdisc, NMPlatformQdisc, {
 _vt_cmd_plobj_id_hash_update (tfilter, NMPlatformTfilter, {
 	nm_hash_update_vals (h,
 	                     obj->ifindex,
+	                     obj->parent,
+	                     obj->info,
 	                     obj->handle);
 })
 
@@ -1705,6 +2347,7 @@ _vt_dedup_obj_destroy (NMDedupMultiObj *obj)
 {
 	NMPObject *o = (NMPObject *) obj;
 	const NMPClass *klass;
+	NMPObjectPool *pool;
 
 	nm_assert (o->parent._ref_count == 0);
 	nm_assert (!o->parent._multi_idx);
@@ -1712,7 +2355,12 @@ _vt_dedup_obj_destroy (NMDedupMultiObj *obj)
 	klass = o->_class;
 	if (klass->cmd_obj_dispose)
 		klass->cmd_obj_dispose (o);
-	g_slice_free1 (klass->sizeof_data + G_STRUCT_OFFSET (NMPObject, object), o);
+
+	pool = _object_pool_get (klass);
+	if (pool)
+		_object_pool_free (pool, o);
+	else
+		g_slice_free1 (klass->sizeof_data + G_STRUCT_OFFSET (NMPObject, object), o);
 }
 
 static const NMDedupMultiObj *
@@ -2369,6 +3017,205 @@ _idxcache_update_other_cache_ids (NMPCache *cache,
 		nm_dedup_multi_index_remove_entry (cache->multi_idx, entry_old);
 }
 
+static int
+_link_order_cmp_ifindex (CRBTree *tree, void *key, CRBNode *node)
+{
+	const NMPlatformLink *a = key;
+	const NMPlatformLink *b = &c_rbnode_entry (node, LinkOrderNode, node_ifindex)->obj->link;
+
+	NM_CMP_DIRECT (a->ifindex, b->ifindex);
+	return 0;
+}
+
+static int
+_link_order_cmp_name (CRBTree *tree, void *key, CRBNode *node)
+{
+	const NMPlatformLink *a = key;
+	const NMPlatformLink *b = &c_rbnode_entry (node, LinkOrderNode, node_name)->obj->link;
+
+	if (a->ifindex == b->ifindex)
+		return 0;
+
+	/* Loopback always first, then initialized links. */
+	NM_CMP_DIRECT (a->ifindex != 1, b->ifindex != 1);
+	NM_CMP_DIRECT (!a->initialized, !b->initialized);
+	NM_CMP_DIRECT_STRCMP (a->name, b->name);
+	NM_CMP_DIRECT (a->ifindex, b->ifindex);
+	return 0;
+}
+
+static void
+_link_order_add (CRBTree *tree,
+                 CRBCompareFunc cmp,
+                 CRBNode *node,
+                 const NMPlatformLink *key)
+{
+	CRBNode *parent;
+	CRBNode **slot;
+
+	slot = c_rbtree_find_slot (tree, cmp, key, &parent);
+	if (!slot)
+		g_return_if_reached ();
+	c_rbtree_add (tree, parent, slot, node);
+}
+
+static void
+_link_order_node_free (LinkOrderNode *node)
+{
+	c_rbnode_unlink (&node->node_ifindex);
+	c_rbnode_unlink (&node->node_name);
+	nmp_object_unref (node->obj);
+	g_slice_free (LinkOrderNode, node);
+}
+
+static void
+_link_order_update (NMPCache *cache,
+                    const NMPObject *obj_old,
+                    const NMPObject *obj_new)
+{
+	LinkOrderNode *node = NULL;
+
+	nm_assert (obj_old || obj_new);
+	nm_assert (!obj_old || NMP_OBJECT_GET_TYPE (obj_old) == NMP_OBJECT_TYPE_LINK);
+	nm_assert (!obj_new || NMP_OBJECT_GET_TYPE (obj_new) == NMP_OBJECT_TYPE_LINK);
+	nm_assert (!obj_old || !obj_new || obj_old->link.ifindex == obj_new->link.ifindex);
+
+	if (obj_old) {
+		node = c_rbtree_find_entry (&cache->links_by_ifindex,
+		                            _link_order_cmp_ifindex,
+		                            &obj_old->link,
+		                            LinkOrderNode,
+		                            node_ifindex);
+		nm_assert (node && node->obj == obj_old);
+	}
+
+	if (!obj_new) {
+		if (node)
+			_link_order_node_free (node);
+		return;
+	}
+
+	if (!node) {
+		node = g_slice_new (LinkOrderNode);
+		c_rbnode_init (&node->node_ifindex);
+		c_rbnode_init (&node->node_name);
+		node->obj = nmp_object_ref (obj_new);
+		node->visit = LINK_ORDER_VISIT_NONE;
+		_link_order_add (&cache->links_by_ifindex, _link_order_cmp_ifindex, &node->node_ifindex, &obj_new->link);
+		_link_order_add (&cache->links_by_name, _link_order_cmp_name, &node->node_name, &obj_new->link);
+		return;
+	}
+
+	if (node->obj == obj_new)
+		return;
+
+	if (   node->obj->link.initialized != obj_new->link.initialized
+	    || !nm_streq (node->obj->link.name, obj_new->link.name)) {
+		/* the position in the name tree changes. Unlink it while the node
+		 * still carries the old key. */
+		c_rbnode_unlink (&node->node_name);
+		nmp_object_unref (node->obj);
+		node->obj = nmp_object_ref (obj_new);
+		_link_order_add (&cache->links_by_name, _link_order_cmp_name, &node->node_name, &obj_new->link);
+		return;
+	}
+
+	nmp_object_unref (node->obj);
+	node->obj = nmp_object_ref (obj_new);
+}
+
+static void
+_link_order_visit (NMPCache *cache, LinkOrderNode *node, GPtrArray *result);
+
+static void
+_link_order_visit_ifindex (NMPCache *cache, int ifindex, GPtrArray *result)
+{
+	NMPlatformLink needle = { .ifindex = ifindex };
+	LinkOrderNode *node;
+
+	if (ifindex <= 0)
+		return;
+
+	node = c_rbtree_find_entry (&cache->links_by_ifindex,
+	                            _link_order_cmp_ifindex,
+	                            &needle,
+	                            LinkOrderNode,
+	                            node_ifindex);
+	if (node)
+		_link_order_visit (cache, node, result);
+}
+
+static void
+_link_order_visit (NMPCache *cache, LinkOrderNode *node, GPtrArray *result)
+{
+	/* A node that is PENDING is an ancestor of itself. That happens for veth
+	 * pairs, where each peer is the parent of the other end. Break the loop
+	 * by not waiting for it. */
+	if (node->visit != LINK_ORDER_VISIT_NONE)
+		return;
+
+	node->visit = LINK_ORDER_VISIT_PENDING;
+	_link_order_visit_ifindex (cache, node->obj->link.master, result);
+	_link_order_visit_ifindex (cache, node->obj->link.parent, result);
+	node->visit = LINK_ORDER_VISIT_DONE;
+
+	g_ptr_array_add (result, (gpointer) nmp_object_ref (node->obj));
+}
+
+/**
+ * nmp_cache_link_get_all_sorted:
+ * @cache: the #NMPCache
+ * @sort_by_name: whether to order the links by name or by ifindex.
+ *
+ * Returns all visible links in the requested order, except that
+ * slaves and children are moved behind their master and parent.
+ * That requires no sorting, because the cache keeps the links
+ * ordered at all times.
+ *
+ * Returns: (transfer full): an array of link #NMPObject, or %NULL
+ *   if there are no visible links.
+ */
+GPtrArray *
+nmp_cache_link_get_all_sorted (NMPCache *cache, gboolean sort_by_name)
+{
+	GPtrArray *result;
+	CRBTree *tree;
+	CRBNode *n;
+	guint n_visible = 0;
+
+	nm_assert (cache);
+
+	tree = sort_by_name ? &cache->links_by_name : &cache->links_by_ifindex;
+
+	c_rbtree_for_each (n, tree) {
+		LinkOrderNode *node = sort_by_name
+		                      ? c_rbnode_entry (n, LinkOrderNode, node_name)
+		                      : c_rbnode_entry (n, LinkOrderNode, node_ifindex);
+
+		if (nmp_object_is_visible (node->obj)) {
+			node->visit = LINK_ORDER_VISIT_NONE;
+			n_visible++;
+		} else
+			node->visit = LINK_ORDER_VISIT_SKIP;
+	}
+
+	if (n_visible == 0)
+		return NULL;
+
+	result = g_ptr_array_new_full (n_visible, (GDestroyNotify) nmp_object_unref);
+
+	c_rbtree_for_each (n, tree) {
+		_link_order_visit (cache,
+		                   sort_by_name
+		                     ? c_rbnode_entry (n, LinkOrderNode, node_name)
+		                     : c_rbnode_entry (n, LinkOrderNode, node_ifindex),
+		                   result);
+	}
+
+	nm_assert (result->len == n_visible);
+	return result;
+}
+
 static void
 _idxcache_update (NMPCache *cache,
                   const NMDedupMultiEntry *entry_old,
@@ -2408,6 +3255,9 @@ _idxcache_update (NMPCache *cache,
 	if (entry_old)
 		obj_old = nmp_object_ref (entry_old->obj);
 
+	g_atomic_int_inc (&cache->version);
+	cache->versions[NMP_OBJECT_GET_TYPE (obj_new ?: obj_old)]++;
+
 	/* first update the main index NMP_CACHE_ID_TYPE_OBJECT_TYPE.
 	 * We already know the pre-existing @entry old, so all that
 	 * nm_dedup_multi_index_add_full() effectively does, is update the
@@ -2448,6 +3298,9 @@ _idxcache_update (NMPCache *cache,
 		                                  is_dump);
 	}
 
+	if (klass->obj_type == NMP_OBJECT_TYPE_LINK)
+		_link_order_update (cache, obj_old, entry_new ? entry_new->obj : NULL);
+
 	NM_SET_OUT (out_entry_new, entry_new);
 }
 
@@ -3001,6 +3854,9 @@ nmp_cache_new (NMDedupMultiIndex *multi_idx, gboolean use_udev)
 
 	cache->multi_idx = nm_dedup_multi_index_ref (multi_idx);
 
+	c_rbtree_init (&cache->links_by_ifindex);
+	c_rbtree_init (&cache->links_by_name);
+
 	cache->use_udev = !!use_udev;
 	return cache;
 }
@@ -3008,8 +3864,17 @@ nmp_cache_new (NMDedupMultiIndex *multi_idx, gboolean use_udev)
 void
 nmp_cache_free (NMPCache *cache)
 {
+	LinkOrderNode *node, *node_safe;
 	guint i;
 
+	/* every node is in both trees. Drop the name tree wholesale, and
+	 * free the nodes while tearing down the ifindex tree. */
+	c_rbtree_init (&cache->links_by_name);
+	c_rbtree_for_each_entry_safe_postorder_unlink (node, node_safe, &cache->links_by_ifindex, node_ifindex) {
+		c_rbnode_init (&node->node_name);
+		_link_order_node_free (node);
+	}
+
 	for (i = NMP_CACHE_ID_TYPE_NONE + 1; i <= NMP_CACHE_ID_TYPE_MAX; i++)
 		nm_dedup_multi_index_remove_idx (cache->multi_idx, _idx_type_get (cache, i));
 
@@ -3018,6 +3883,222 @@ nmp_cache_free (NMPCache *cache)
 	g_slice_free (NMPCache, cache);
 }
 
+guint
+nmp_cache_get_version (const NMPCache *cache)
+{
+	return g_atomic_int_get (&cache->version);
+}
+
+/*****************************************************************************/
+
+/* The objects of one type in a snapshot. Successive snapshots share the
+ * parts for types that didn't change. */
+typedef struct {
+	volatile int ref_count;
+	guint version;
+	guint len;
+	const NMPObject *objs[];
+} SnapshotPart;
+
+struct _NMPCacheSnapshot {
+	volatile int ref_count;
+	guint version;
+
+	/* the objects hold non-atomic references. They can only be released
+	 * on the thread that created the snapshot, in @context. */
+	GThread *owner;
+	GMainContext *context;
+
+	SnapshotPart *parts[NMP_OBJECT_TYPE_MAX + 1];
+};
+
+static const NMPObjectType _snapshot_obj_types[] = {
+	NMP_OBJECT_TYPE_LINK,
+	NMP_OBJECT_TYPE_IP4_ADDRESS,
+	NMP_OBJECT_TYPE_IP6_ADDRESS,
+	NMP_OBJECT_TYPE_IP4_ROUTE,
+	NMP_OBJECT_TYPE_IP6_ROUTE,
+	NMP_OBJECT_TYPE_ROUTING_RULE,
+	NMP_OBJECT_TYPE_QDISC,
+	NMP_OBJECT_TYPE_TFILTER,
+};
+
+static SnapshotPart *
+_snapshot_part_new (const NMPCache *cache, NMPObjectType obj_type)
+{
+	const NMDedupMultiHeadEntry *head_entry;
+	NMDedupMultiIter iter;
+	const NMPObject *obj;
+	SnapshotPart *part;
+	NMPLookup lookup;
+	guint len = 0;
+
+	head_entry = nmp_cache_lookup (cache, nmp_lookup_init_obj_type (&lookup, obj_type));
+
+	part = g_malloc (sizeof (SnapshotPart) + (head_entry ? head_entry->len : 0u) * sizeof (const NMPObject *));
+	part->ref_count = 1;
+	part->version = cache->versions[obj_type];
+
+	nmp_cache_iter_for_each (&iter, head_entry, &obj) {
+		if (!nmp_object_is_visible (obj))
+			continue;
+		part->objs[len++] = nmp_object_ref (obj);
+	}
+	part->len = len;
+	return part;
+}
+
+static void
+_snapshot_part_unref (SnapshotPart *part)
+{
+	guint i;
+
+	if (!part || !g_atomic_int_dec_and_test (&part->ref_count))
+		return;
+
+	for (i = 0; i < part->len; i++)
+		nmp_object_unref (part->objs[i]);
+	g_free (part);
+}
+
+/**
+ * nmp_cache_snapshot_new:
+ * @cache: the cache
+ * @previous: (allow-none): an older snapshot of the same cache. Object types
+ *   that didn't change since then are shared with it.
+ *
+ * Creates a read-only copy of the visible objects in @cache. Other threads
+ * can read it, while the owner keeps updating the cache. The objects are
+ * immutable, so the copy only costs a reference per object.
+ *
+ * This must be called on the thread that owns @cache, and it is then the
+ * owner of the snapshot. References can be taken and released on any
+ * thread, but the last one is only freed in the thread default main
+ * context of the owner.
+ *
+ * Returns: (transfer full): the new snapshot.
+ */
+NMPCacheSnapshot *
+nmp_cache_snapshot_new (const NMPCache *cache,
+                        NMPCacheSnapshot *previous)
+{
+	NMPCacheSnapshot *snapshot;
+	guint i;
+
+	nm_assert (cache);
+	nm_assert (!previous || previous->owner == g_thread_self ());
+
+	snapshot = g_slice_new0 (NMPCacheSnapshot);
+	snapshot->ref_count = 1;
+	snapshot->version = nmp_cache_get_version (cache);
+	snapshot->owner = g_thread_self ();
+	snapshot->context = g_main_context_ref_thread_default ();
+
+	for (i = 0; i < G_N_ELEMENTS (_snapshot_obj_types); i++) {
+		const NMPObjectType obj_type = _snapshot_obj_types[i];
+		SnapshotPart *part = previous ? previous->parts[obj_type] : NULL;
+
+		if (   part
+		    && part->version == cache->versions[obj_type]) {
+			g_atomic_int_inc (&part->ref_count);
+			snapshot->parts[obj_type] = part;
+		} else
+			snapshot->parts[obj_type] = _snapshot_part_new (cache, obj_type);
+	}
+
+	return snapshot;
+}
+
+NMPCacheSnapshot *
+nmp_cache_snapshot_ref (NMPCacheSnapshot *snapshot)
+{
+	g_return_val_if_fail (snapshot, NULL);
+	g_return_val_if_fail (snapshot->ref_count > 0, NULL);
+
+	g_atomic_int_inc (&snapshot->ref_count);
+	return snapshot;
+}
+
+static gboolean
+_snapshot_free (gpointer user_data)
+{
+	NMPCacheSnapshot *snapshot = user_data;
+	guint i;
+
+	nm_assert (snapshot->owner == g_thread_self ());
+
+	for (i = 0; i < G_N_ELEMENTS (snapshot->parts); i++)
+		_snapshot_part_unref (snapshot->parts[i]);
+	g_main_context_unref (snapshot->context);
+	g_slice_free (NMPCacheSnapshot, snapshot);
+	return G_SOURCE_REMOVE;
+}
+
+void
+nmp_cache_snapshot_unref (NMPCacheSnapshot *snapshot)
+{
+	GSource *source;
+
+	if (!snapshot)
+		return;
+
+	g_return_if_fail (snapshot->ref_count > 0);
+
+	if (!g_atomic_int_dec_and_test (&snapshot->ref_count))
+		return;
+
+	if (snapshot->owner == g_thread_self ()) {
+		_snapshot_free (snapshot);
+		return;
+	}
+
+	/* the references to the objects are not thread-safe. Release them
+	 * on the owner thread. */
+	source = g_idle_source_new ();
+	g_source_set_priority (source, G_PRIORITY_DEFAULT);
+	g_source_set_callback (source, _snapshot_free, snapshot, NULL);
+	g_source_attach (source, snapshot->context);
+	g_source_unref (source);
+}
+
+guint
+nmp_cache_snapshot_get_version (const NMPCacheSnapshot *snapshot)
+{
+	g_return_val_if_fail (snapshot, 0);
+
+	return snapshot->version;
+}
+
+/**
+ * nmp_cache_snapshot_get_objects:
+ * @snapshot: the snapshot
+ * @obj_type: the object type
+ * @out_len: (out): the number of objects
+ *
+ * Returns: (transfer none): the visible objects of @obj_type, in the order
+ *   of the cache. The objects are valid as long as @snapshot is. Don't take
+ *   references to them on other threads than the owner.
+ */
+const NMPObject *const*
+nmp_cache_snapshot_get_objects (const NMPCacheSnapshot *snapshot,
+                                NMPObjectType obj_type,
+                                guint *out_len)
+{
+	const SnapshotPart *part;
+
+	g_return_val_if_fail (snapshot, NULL);
+	g_return_val_if_fail (obj_type > NMP_OBJECT_TYPE_UNKNOWN && obj_type <= NMP_OBJECT_TYPE_MAX, NULL);
+
+	part = snapshot->parts[obj_type];
+	if (!part || part->len == 0) {
+		*out_len = 0;
+		return NULL;
+	}
+
+	*out_len = part->len;
+	return part->objs;
+}
+
 /*****************************************************************************/
 
 void
@@ -645,6 +645,19 @@ gboolean nmp_object_is_visible (const NMPObject *obj);
 
 void _nmp_object_fixup_link_udev_fields (NMPObject **obj_new, NMPObject *obj_orig, gboolean use_udev);
 
+gboolean nmp_object_lnk_wireguard_equal_config (const NMPObject *a, const NMPObject *b);
+
+void nmp_object_lnk_wireguard_create_change_delta (const NMPObject *lnk_cached,
+                                                   const NMPlatformLnkWireGuard *lnk_wireguard,
+                                                   const NMPWireGuardPeer *peers,
+                                                   const NMPlatformWireGuardChangePeerFlags *peer_flags,
+                                                   guint peers_len,
+                                                   NMPlatformWireGuardChangeFlags *inout_change_flags,
+                                                   NMPWireGuardPeer **out_peers,
+                                                   NMPlatformWireGuardChangePeerFlags **out_peer_flags,
+                                                   guint *out_peers_len,
+                                                   NMPWireGuardAllowedIP **out_allowed_ips_buf);
+
 static inline void
 _nm_auto_nmpobj_cleanup (gpointer p)
 {
@@ -765,6 +778,23 @@ gboolean nmp_cache_link_connected_for_slave (int ifindex_master, const NMPObject
 gboolean nmp_cache_link_connected_needs_toggle (const NMPCache *cache, const NMPObject *master, const NMPObject *potential_slave, const NMPObject *ignore_slave);
 const NMPObject *nmp_cache_link_connected_needs_toggle_by_ifindex (const NMPCache *cache, int master_ifindex, const NMPObject *potential_slave, const NMPObject *ignore_slave);
 
+GPtrArray *nmp_cache_link_get_all_sorted (NMPCache *cache, gboolean sort_by_name);
+
+/*****************************************************************************/
+
+typedef struct {
+	guint64 n_allocs;
+	guint64 n_frees;
+	guint n_objs;
+	guint n_slabs;
+	gsize bytes;
+} NMPObjectPoolStats;
+
+gboolean nmp_object_pool_get_stats (NMPObjectType obj_type,
+                                    NMPObjectPoolStats *out_stats);
+
+const char *nmp_object_pool_stats_to_string (char *buf, gsize len);
+
 gboolean nmp_cache_use_udev_get (const NMPCache *cache);
 
 void ASSERT_nmp_cache_is_consistent (const NMPCache *cache);
@@ -833,6 +863,27 @@ void nmp_cache_dirty_set_all_main (NMPCache *cache,
 NMPCache *nmp_cache_new (NMDedupMultiIndex *multi_idx, gboolean use_udev);
 void nmp_cache_free (NMPCache *cache);
 
+guint nmp_cache_get_version (const NMPCache *cache);
+
+/*****************************************************************************/
+
+typedef struct _NMPCacheSnapshot NMPCacheSnapshot;
+
+NMPCacheSnapshot *nmp_cache_snapshot_new (const NMPCache *cache,
+                                          NMPCacheSnapshot *previous);
+
+NMPCacheSnapshot *nmp_cache_snapshot_ref (NMPCacheSnapshot *snapshot);
+void nmp_cache_snapshot_unref (NMPCacheSnapshot *snapshot);
+
+guint nmp_cache_snapshot_get_version (const NMPCacheSnapshot *snapshot);
+
+const NMPObject *const*nmp_cache_snapshot_get_objects (const NMPCacheSnapshot *snapshot,
+                                                       NMPObjectType obj_type,
+                                                       guint *out_len);
+
+NM_AUTO_DEFINE_FCN0 (NMPCacheSnapshot *, _nm_auto_unref_nmp_cache_snapshot, nmp_cache_snapshot_unref);
+#define nm_auto_unref_nmp_cache_snapshot nm_auto(_nm_auto_unref_nmp_cache_snapshot)
+
 static inline void
 ASSERT_nmp_cache_ops (const NMPCache *cache,
                       NMPCacheOpsType ops_type,
@@ -873,6 +924,8 @@ ASSERT_nmp_cache_ops (const NMPCache *cache,
 #endif
 }
 
+NMPCacheSnapshot *nm_platform_cache_snapshot_get (NMPlatform *platform);
+
 const NMDedupMultiHeadEntry *nm_platform_lookup_all (NMPlatform *platform,
                                                      NMPCacheIdType cache_id_type,
                                                      const NMPObject *obj);
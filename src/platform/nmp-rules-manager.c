@@ -17,6 +17,10 @@ struct _NMPRulesManager {
 	GHashTable *by_obj;
 	GHashTable *by_user_tag;
 	GHashTable *by_data;
+
+	/* the RulesObjData that need to be looked at during the next sync. */
+	CList dirty_lst_head;
+
 	guint ref_count;
 };
 
@@ -61,6 +65,9 @@ typedef struct {
 	CList obj_lst;
 	CList user_tag_lst;
 
+	/* the cached _rules_obj_id_hash() of @obj. */
+	guint obj_hash;
+
 	/* track_priority_val zero is special: those are weakly tracked rules.
 	 * That means: NetworkManager will restore them only if it removed them earlier.
 	 * But it will not remove or add them otherwise.
@@ -101,6 +108,12 @@ typedef struct {
 	const NMPObject *obj;
 	CList obj_lst_head;
 
+	/* linked in NMPRulesManager's dirty_lst_head, if the rule needs to be
+	 * synced. That is, if it got (un)tracked or changed in platform. */
+	CList dirty_lst;
+
+	guint obj_hash;
+
 	/* indicates whether we configured/removed the rule (during sync()). We need that, so
 	 * if the rule gets untracked, that we know to remove/restore it.
 	 *
@@ -139,6 +152,18 @@ _rules_data_assert (const RulesData *rules_data, gboolean linked)
 	nm_assert (!linked || !c_list_is_empty (&rules_data->user_tag_lst));
 }
 
+static guint
+_rules_obj_id_hash (const NMPObject *obj)
+{
+	NMHashState h;
+
+	nm_hash_init (&h, 432817559u);
+	nm_platform_routing_rule_hash_update (NMP_OBJECT_CAST_ROUTING_RULE (obj),
+	                                      NM_PLATFORM_ROUTING_RULE_CMP_TYPE_ID,
+	                                      &h);
+	return nm_hash_complete (&h);
+}
+
 static guint
 _rules_data_hash (gconstpointer data)
 {
@@ -146,12 +171,12 @@ _rules_data_hash (gconstpointer data)
 	NMHashState h;
 
 	_rules_data_assert (rules_data, FALSE);
+	nm_assert (rules_data->obj_hash == _rules_obj_id_hash (rules_data->obj));
 
 	nm_hash_init (&h, 269297543u);
-	nm_platform_routing_rule_hash_update (NMP_OBJECT_CAST_ROUTING_RULE (rules_data->obj),
-	                                      NM_PLATFORM_ROUTING_RULE_CMP_TYPE_ID,
-	                                      &h);
-	nm_hash_update_val (&h, rules_data->user_tag);
+	nm_hash_update_vals (&h,
+	                     rules_data->obj_hash,
+	                     rules_data->user_tag);
 	return nm_hash_complete (&h);
 }
 
@@ -165,6 +190,7 @@ _rules_data_equal (gconstpointer data_a, gconstpointer data_b)
 	_rules_data_assert (rules_data_b, FALSE);
 
 	return    rules_data_a->user_tag == rules_data_b->user_tag
+	       && rules_data_a->obj_hash == rules_data_b->obj_hash
 	       && (nm_platform_routing_rule_cmp (NMP_OBJECT_CAST_ROUTING_RULE (rules_data_a->obj),
 	                                         NMP_OBJECT_CAST_ROUTING_RULE (rules_data_b->obj),
 	                                         NM_PLATFORM_ROUTING_RULE_CMP_TYPE_ID) == 0);
@@ -216,13 +242,10 @@ static guint
 _rules_obj_hash (gconstpointer data)
 {
 	const RulesObjData *obj_data = data;
-	NMHashState h;
 
-	nm_hash_init (&h, 432817559u);
-	nm_platform_routing_rule_hash_update (NMP_OBJECT_CAST_ROUTING_RULE (obj_data->obj),
-	                                      NM_PLATFORM_ROUTING_RULE_CMP_TYPE_ID,
-	                                      &h);
-	return nm_hash_complete (&h);
+	nm_assert (obj_data->obj_hash == _rules_obj_id_hash (obj_data->obj));
+
+	return obj_data->obj_hash;
 }
 
 static gboolean
@@ -231,7 +254,8 @@ _rules_obj_equal (gconstpointer data_a, gconstpointer data_b)
 	const RulesObjData *obj_data_a = data_a;
 	const RulesObjData *obj_data_b = data_b;
 
-	return (nm_platform_routing_rule_cmp (NMP_OBJECT_CAST_ROUTING_RULE (obj_data_a->obj),
+	return    obj_data_a->obj_hash == obj_data_b->obj_hash
+	       && (nm_platform_routing_rule_cmp (NMP_OBJECT_CAST_ROUTING_RULE (obj_data_a->obj),
 	                                      NMP_OBJECT_CAST_ROUTING_RULE (obj_data_b->obj),
 	                                      NM_PLATFORM_ROUTING_RULE_CMP_TYPE_ID) == 0);
 }
@@ -242,6 +266,7 @@ _rules_obj_destroy (gpointer data)
 	RulesObjData *obj_data = data;
 
 	c_list_unlink_stale (&obj_data->obj_lst_head);
+	c_list_unlink_stale (&obj_data->dirty_lst);
 	nmp_object_unref (obj_data->obj);
 	g_slice_free (RulesObjData, obj_data);
 }
@@ -275,16 +300,39 @@ _rules_user_tag_destroy (gpointer data)
 static RulesData *
 _rules_data_lookup (GHashTable *by_data,
                     const NMPObject *obj,
+                    guint obj_hash,
                     gconstpointer user_tag)
 {
 	RulesData rules_data_needle = {
 		.obj      = obj,
+		.obj_hash = obj_hash,
 		.user_tag = user_tag,
 	};
 
 	return g_hash_table_lookup (by_data, &rules_data_needle);
 }
 
+static RulesObjData *
+_rules_obj_lookup (GHashTable *by_obj,
+                   const NMPObject *obj,
+                   guint obj_hash)
+{
+	RulesObjData obj_data_needle = {
+		.obj      = obj,
+		.obj_hash = obj_hash,
+	};
+
+	return g_hash_table_lookup (by_obj, &obj_data_needle);
+}
+
+static void
+_rules_obj_set_dirty (NMPRulesManager *self,
+                      RulesObjData *obj_data)
+{
+	if (c_list_is_empty (&obj_data->dirty_lst))
+		c_list_link_tail (&self->dirty_lst_head, &obj_data->dirty_lst);
+}
+
 /**
  * nmp_rules_manager_track:
  * @self: the #NMPRulesManager instance
@@ -319,6 +367,7 @@ nmp_rules_manager_track (NMPRulesManager *self,
 	gboolean changed = FALSE;
 	guint32 track_priority_val;
 	gboolean track_priority_present;
+	guint obj_hash;
 
 	g_return_if_fail (NMP_IS_RULES_MANAGER (self));
 	g_return_if_fail (routing_rule);
@@ -339,13 +388,17 @@ nmp_rules_manager_track (NMPRulesManager *self,
 		track_priority_present = FALSE;
 	}
 
-	rules_data = _rules_data_lookup (self->by_data, p_obj_stack, user_tag);
+	/* the rule's ID hash is needed for the lookups below. Compute it only once. */
+	obj_hash = _rules_obj_id_hash (p_obj_stack);
+
+	rules_data = _rules_data_lookup (self->by_data, p_obj_stack, obj_hash, user_tag);
 
 	if (!rules_data) {
 		rules_data = g_slice_new (RulesData);
 		*rules_data = (RulesData) {
 			.obj                    = nm_dedup_multi_index_obj_intern (nm_platform_get_multi_idx (self->platform),
 			                                                           p_obj_stack),
+			.obj_hash               = obj_hash,
 			.user_tag               = user_tag,
 			.track_priority_val     = track_priority_val,
 			.track_priority_present = track_priority_present,
@@ -353,17 +406,20 @@ nmp_rules_manager_track (NMPRulesManager *self,
 		};
 		g_hash_table_add (self->by_data, rules_data);
 
-		obj_data = g_hash_table_lookup (self->by_obj, &rules_data->obj);
+		obj_data = _rules_obj_lookup (self->by_obj, rules_data->obj, obj_hash);
 		if (!obj_data) {
 			obj_data = g_slice_new (RulesObjData);
 			*obj_data = (RulesObjData) {
 				.obj          = nmp_object_ref (rules_data->obj),
+				.obj_hash     = obj_hash,
 				.obj_lst_head = C_LIST_INIT (obj_data->obj_lst_head),
+				.dirty_lst    = C_LIST_INIT (obj_data->dirty_lst),
 				.config_state = CONFIG_STATE_NONE,
 			};
 			g_hash_table_add (self->by_obj, obj_data);
 		}
 		c_list_link_tail (&obj_data->obj_lst_head, &rules_data->obj_lst);
+		_rules_obj_set_dirty (self, obj_data);
 
 		user_tag_data = g_hash_table_lookup (self->by_user_tag, &rules_data->user_tag);
 		if (!user_tag_data) {
@@ -382,6 +438,8 @@ nmp_rules_manager_track (NMPRulesManager *self,
 		    || rules_data->track_priority_present != track_priority_present) {
 			rules_data->track_priority_val = track_priority_val;
 			rules_data->track_priority_present = track_priority_present;
+			_rules_obj_set_dirty (self,
+			                      _rules_obj_lookup (self->by_obj, rules_data->obj, obj_hash));
 			changed = TRUE;
 		}
 	}
@@ -390,7 +448,7 @@ nmp_rules_manager_track (NMPRulesManager *self,
 		if (user_tag != user_tag_untrack) {
 			RulesData *rules_data_untrack;
 
-			rules_data_untrack = _rules_data_lookup (self->by_data, p_obj_stack, user_tag_untrack);
+			rules_data_untrack = _rules_data_lookup (self->by_data, p_obj_stack, obj_hash, user_tag_untrack);
 			if (rules_data_untrack)
 				_rules_data_untrack (self, rules_data_untrack, FALSE, TRUE);
 		} else
@@ -441,10 +499,11 @@ _rules_data_untrack (NMPRulesManager *self,
 
 	nm_assert (!c_list_is_empty (&rules_data->user_tag_lst));
 
-	obj_data = g_hash_table_lookup (self->by_obj, &rules_data->obj);
+	obj_data = _rules_obj_lookup (self->by_obj, rules_data->obj, rules_data->obj_hash);
 	nm_assert (obj_data);
 	nm_assert (c_list_contains (&obj_data->obj_lst_head, &rules_data->obj_lst));
-	nm_assert (obj_data == g_hash_table_lookup (self->by_obj, &rules_data->obj));
+
+	_rules_obj_set_dirty (self, obj_data);
 
 	if (make_owned_by_us) {
 		if (obj_data->config_state == CONFIG_STATE_NONE) {
@@ -460,7 +519,7 @@ _rules_data_untrack (NMPRulesManager *self,
 	 * around for the next sync -- so that we can undo what we did earlier. */
 	if (   obj_data->config_state == CONFIG_STATE_NONE
 	    && c_list_length_is (&rules_data->obj_lst, 1))
-		g_hash_table_remove (self->by_obj, &rules_data->obj);
+		g_hash_table_remove (self->by_obj, obj_data);
 
 	g_hash_table_remove (self->by_data, rules_data);
 }
@@ -484,7 +543,7 @@ nmp_rules_manager_untrack (NMPRulesManager *self,
 
 	nm_assert (nmp_object_is_visible (p_obj_stack));
 
-	rules_data = _rules_data_lookup (self->by_data, p_obj_stack, user_tag);
+	rules_data = _rules_data_lookup (self->by_data, p_obj_stack, _rules_obj_id_hash (p_obj_stack), user_tag);
 	if (rules_data)
 		_rules_data_untrack (self, rules_data, TRUE, FALSE);
 }
@@ -538,103 +597,206 @@ nmp_rules_manager_untrack_all (NMPRulesManager *self,
 		g_hash_table_remove (self->by_user_tag, user_tag_data);
 }
 
-void
-nmp_rules_manager_sync (NMPRulesManager *self,
-                        gboolean keep_deleted_rules)
+typedef struct {
+	const NMPObject *obj;
+
+	/* the config_state of the RulesObjData before the sync. If the request
+	 * fails, we restore it and retry during the next sync. */
+	ConfigState config_state_prev;
+} RulesSyncRequest;
+
+static void
+_rules_sync_request_clear (gpointer data)
 {
-	const NMDedupMultiHeadEntry *pl_head_entry;
-	NMDedupMultiIter pl_iter;
-	const NMPObject *plobj;
-	gs_unref_ptrarray GPtrArray *rules_to_delete = NULL;
-	RulesObjData *obj_data;
-	GHashTableIter h_iter;
-	guint i;
-	const RulesData *rd_best;
+	RulesSyncRequest *request = data;
 
-	g_return_if_fail (NMP_IS_RULES_MANAGER (self));
+	nmp_object_unref (request->obj);
+}
 
-	if (!self->by_data)
+static void
+_rules_sync_request_add (GArray **p_requests,
+                         const NMPObject *obj,
+                         ConfigState config_state_prev)
+{
+	RulesSyncRequest *request;
+
+	if (!*p_requests) {
+		*p_requests = g_array_new (FALSE, FALSE, sizeof (RulesSyncRequest));
+		g_array_set_clear_func (*p_requests, _rules_sync_request_clear);
+	}
+
+	g_array_set_size (*p_requests, (*p_requests)->len + 1);
+	request = &g_array_index (*p_requests, RulesSyncRequest, (*p_requests)->len - 1);
+	request->obj = nmp_object_ref (obj);
+	request->config_state_prev = config_state_prev;
+}
+
+static void
+_rules_sync_request_failed (NMPRulesManager *self,
+                            const RulesSyncRequest *request)
+{
+	RulesObjData *obj_data;
+
+	obj_data = _rules_obj_lookup (self->by_obj, request->obj, _rules_obj_id_hash (request->obj));
+	if (!obj_data) {
+		/* the rule is no longer tracked. There is nothing to retry. */
 		return;
+	}
 
-	_LOGD ("sync%s", keep_deleted_rules ? " (don't remove any rules)" : "");
+	obj_data->config_state = request->config_state_prev;
+	_rules_obj_set_dirty (self, obj_data);
+}
 
-	pl_head_entry = nm_platform_lookup_obj_type (self->platform, NMP_OBJECT_TYPE_ROUTING_RULE);
-	if (pl_head_entry) {
-		nmp_cache_iter_for_each (&pl_iter, pl_head_entry, &plobj) {
-			obj_data = g_hash_table_lookup (self->by_obj, &plobj);
+static int
+_rules_sync_request_cmp_priority (gconstpointer a, gconstpointer b)
+{
+	const NMPlatformRoutingRule *rr_a = NMP_OBJECT_CAST_ROUTING_RULE (((const RulesSyncRequest *) a)->obj);
+	const NMPlatformRoutingRule *rr_b = NMP_OBJECT_CAST_ROUTING_RULE (((const RulesSyncRequest *) b)->obj);
 
-			if (!obj_data) {
-				/* this rule is not tracked. It was externally added, hence we
-				 * ignore it. */
-				continue;
-			}
+	NM_CMP_FIELD (rr_a, rr_b, addr_family);
+	NM_CMP_FIELD (rr_a, rr_b, priority);
+	return 0;
+}
 
-			rd_best = _rules_obj_get_best_data (obj_data);
-			if (rd_best) {
-				if (rd_best->track_priority_present) {
-					if (obj_data->config_state == CONFIG_STATE_OWNED_BY_US)
-						obj_data->config_state = CONFIG_STATE_ADDED_BY_US;
-					continue;
-				}
-				if (rd_best->track_priority_val == 0) {
-					if (!NM_IN_SET (obj_data->config_state, CONFIG_STATE_ADDED_BY_US,
-					                                        CONFIG_STATE_OWNED_BY_US)) {
-						obj_data->config_state = CONFIG_STATE_NONE;
-						continue;
-					}
+static void
+_rules_obj_sync (NMPRulesManager *self,
+                 RulesObjData *obj_data,
+                 gboolean keep_deleted_rules,
+                 GArray **p_rules_to_delete,
+                 GArray **p_rules_to_add)
+{
+	const ConfigState config_state_prev = obj_data->config_state;
+	const RulesData *rd_best;
+	const NMPObject *plobj;
+
+	rd_best = _rules_obj_get_best_data (obj_data);
+
+	plobj = nm_platform_lookup_obj (self->platform, NMP_CACHE_ID_TYPE_OBJECT_TYPE, obj_data->obj);
+	if (plobj) {
+		/* the rule is configured in platform. Check whether we need to remove it. */
+		if (rd_best) {
+			if (rd_best->track_priority_present) {
+				if (obj_data->config_state == CONFIG_STATE_OWNED_BY_US)
+					obj_data->config_state = CONFIG_STATE_ADDED_BY_US;
+				goto check_add;
+			}
+			if (rd_best->track_priority_val == 0) {
+				if (!NM_IN_SET (obj_data->config_state, CONFIG_STATE_ADDED_BY_US,
+				                                        CONFIG_STATE_OWNED_BY_US)) {
 					obj_data->config_state = CONFIG_STATE_NONE;
+					goto check_add;
 				}
+				obj_data->config_state = CONFIG_STATE_NONE;
 			}
+		}
 
-			if (keep_deleted_rules) {
-				_LOGD ("forget/leak rule added by us: %s", nmp_object_to_string (plobj, NMP_OBJECT_TO_STRING_PUBLIC, NULL, 0));
-				continue;
-			}
+		if (keep_deleted_rules) {
+			_LOGD ("forget/leak rule added by us: %s", nmp_object_to_string (plobj, NMP_OBJECT_TO_STRING_PUBLIC, NULL, 0));
+			/* we didn't remove it. If the rule is still tracked, look at it again
+			 * during the next sync. Otherwise, we forget about it below and leave
+			 * it configured. */
+			if (rd_best)
+				_rules_obj_set_dirty (self, obj_data);
+			goto check_add;
+		}
 
-			if (!rules_to_delete)
-				rules_to_delete = g_ptr_array_new_with_free_func ((GDestroyNotify) nmp_object_unref);
+		_rules_sync_request_add (p_rules_to_delete, plobj, config_state_prev);
+
+		obj_data->config_state = CONFIG_STATE_REMOVED_BY_US;
+		plobj = NULL;
+	}
 
-			g_ptr_array_add (rules_to_delete, (gpointer) nmp_object_ref (plobj));
+check_add:
+	if (!rd_best) {
+		g_hash_table_remove (self->by_obj, obj_data);
+		return;
+	}
 
+	if (!rd_best->track_priority_present) {
+		if (obj_data->config_state == CONFIG_STATE_OWNED_BY_US)
 			obj_data->config_state = CONFIG_STATE_REMOVED_BY_US;
+		return;
+	}
+	if (rd_best->track_priority_val == 0) {
+		if (!NM_IN_SET (obj_data->config_state, CONFIG_STATE_REMOVED_BY_US,
+		                                        CONFIG_STATE_OWNED_BY_US)) {
+			obj_data->config_state = CONFIG_STATE_NONE;
+			return;
 		}
+		obj_data->config_state = CONFIG_STATE_NONE;
 	}
 
-	if (rules_to_delete) {
-		for (i = 0; i < rules_to_delete->len; i++)
-			nm_platform_object_delete (self->platform, rules_to_delete->pdata[i]);
+	if (plobj)
+		return;
+
+	_rules_sync_request_add (p_rules_to_add, obj_data->obj, config_state_prev);
+
+	obj_data->config_state = CONFIG_STATE_ADDED_BY_US;
+}
+
+void
+nmp_rules_manager_sync (NMPRulesManager *self,
+                        gboolean keep_deleted_rules)
+{
+	CList dirty_lst_head = C_LIST_INIT (dirty_lst_head);
+	gs_unref_array GArray *rules_to_delete = NULL;
+	gs_unref_array GArray *rules_to_add = NULL;
+	RulesObjData *obj_data;
+	guint i;
+
+	g_return_if_fail (NMP_IS_RULES_MANAGER (self));
+
+	if (!self->by_data)
+		return;
+
+	_LOGD ("sync%s", keep_deleted_rules ? " (don't remove any rules)" : "");
+
+	/* Only the rules that were (un)tracked or that changed in platform since the last
+	 * sync need to be looked at. All other rules are already as we want them. */
+	c_list_splice (&dirty_lst_head, &self->dirty_lst_head);
+
+	while ((obj_data = c_list_first_entry (&dirty_lst_head, RulesObjData, dirty_lst))) {
+		c_list_unlink (&obj_data->dirty_lst);
+		_rules_obj_sync (self, obj_data, keep_deleted_rules, &rules_to_delete, &rules_to_add);
 	}
 
-	g_hash_table_iter_init (&h_iter, self->by_obj);
-	while (g_hash_table_iter_next (&h_iter, (gpointer *) &obj_data, NULL)) {
+	/* Send the requests in batches, ordered by rule priority. First delete, then add.
+	 *
+	 * A failed request leaves the rule dirty, so that the next sync retries it. */
 
-		rd_best = _rules_obj_get_best_data (obj_data);
+	if (rules_to_delete) {
+		gs_free const NMPObject **objs = g_new (const NMPObject *, rules_to_delete->len);
+		gs_free gboolean *results = g_new (gboolean, rules_to_delete->len);
 
-		if (!rd_best) {
-			g_hash_table_iter_remove (&h_iter);
-			continue;
+		g_array_sort (rules_to_delete, _rules_sync_request_cmp_priority);
+		for (i = 0; i < rules_to_delete->len; i++)
+			objs[i] = g_array_index (rules_to_delete, RulesSyncRequest, i).obj;
+		nm_platform_object_delete_many (self->platform,
+		                                objs,
+		                                rules_to_delete->len,
+		                                results);
+		for (i = 0; i < rules_to_delete->len; i++) {
+			if (!results[i])
+				_rules_sync_request_failed (self, &g_array_index (rules_to_delete, RulesSyncRequest, i));
 		}
+	}
 
-		if (!rd_best->track_priority_present) {
-			if (obj_data->config_state == CONFIG_STATE_OWNED_BY_US)
-				obj_data->config_state = CONFIG_STATE_REMOVED_BY_US;
-			continue;
+	if (rules_to_add) {
+		gs_free const NMPObject **objs = g_new (const NMPObject *, rules_to_add->len);
+		gs_free int *results = g_new (int, rules_to_add->len);
+
+		g_array_sort (rules_to_add, _rules_sync_request_cmp_priority);
+		for (i = 0; i < rules_to_add->len; i++)
+			objs[i] = g_array_index (rules_to_add, RulesSyncRequest, i).obj;
+		nm_platform_routing_rule_add_many (self->platform,
+		                                   NMP_NLM_FLAG_ADD,
+		                                   objs,
+		                                   rules_to_add->len,
+		                                   results);
+		for (i = 0; i < rules_to_add->len; i++) {
+			if (results[i] < 0)
+				_rules_sync_request_failed (self, &g_array_index (rules_to_add, RulesSyncRequest, i));
 		}
-		if (rd_best->track_priority_val == 0) {
-			if (!NM_IN_SET (obj_data->config_state, CONFIG_STATE_REMOVED_BY_US,
-			                                        CONFIG_STATE_OWNED_BY_US)) {
-				obj_data->config_state = CONFIG_STATE_NONE;
-				continue;
-			}
-			obj_data->config_state = CONFIG_STATE_NONE;
-		}
-
-		plobj = nm_platform_lookup_obj (self->platform, NMP_CACHE_ID_TYPE_OBJECT_TYPE, obj_data->obj);
-		if (plobj)
-			continue;
-
-		obj_data->config_state = CONFIG_STATE_ADDED_BY_US;
-		nm_platform_routing_rule_add (self->platform, NMP_NLM_FLAG_ADD, NMP_OBJECT_CAST_ROUTING_RULE (obj_data->obj));
 	}
 }
 
@@ -747,6 +909,27 @@ nmp_rules_manager_track_default (NMPRulesManager *self,
 	}
 }
 
+static void
+_platform_routing_rule_changed_cb (NMPlatform *platform,
+                                   int obj_type_i,
+                                   int ifindex,
+                                   gconstpointer platform_object,
+                                   int change_type_i,
+                                   NMPRulesManager *self)
+{
+	const NMPObject *obj = NMP_OBJECT_UP_CAST (platform_object);
+	RulesObjData *obj_data;
+
+	nm_assert (NMP_IS_RULES_MANAGER (self));
+	nm_assert (self->by_obj);
+
+	/* a tracked rule was added or removed externally (or by us). Check it
+	 * during the next sync. Untracked rules are ignored anyway. */
+	obj_data = _rules_obj_lookup (self->by_obj, obj, _rules_obj_id_hash (obj));
+	if (obj_data)
+		_rules_obj_set_dirty (self, obj_data);
+}
+
 static void
 _rules_init (NMPRulesManager *self)
 {
@@ -756,6 +939,11 @@ _rules_init (NMPRulesManager *self)
 	self->by_data      = g_hash_table_new_full (_rules_data_hash,      _rules_data_equal,      NULL, _rules_data_destroy);
 	self->by_obj       = g_hash_table_new_full (_rules_obj_hash,       _rules_obj_equal,       NULL, _rules_obj_destroy);
 	self->by_user_tag  = g_hash_table_new_full (_rules_user_tag_hash,  _rules_user_tag_equal,  NULL, _rules_user_tag_destroy);
+
+	g_signal_connect (self->platform,
+	                  NM_PLATFORM_SIGNAL_ROUTING_RULE_CHANGED,
+	                  G_CALLBACK (_platform_routing_rule_changed_cb),
+	                  self);
 }
 
 /*****************************************************************************/
@@ -769,8 +957,9 @@ nmp_rules_manager_new (NMPlatform *platform)
 
 	self = g_slice_new (NMPRulesManager);
 	*self = (NMPRulesManager) {
-		.ref_count     = 1,
-		.platform      = g_object_ref (platform),
+		.ref_count      = 1,
+		.platform       = g_object_ref (platform),
+		.dirty_lst_head = C_LIST_INIT (self->dirty_lst_head),
 	};
 	return self;
 }
@@ -791,6 +980,9 @@ void nmp_rules_manager_unref (NMPRulesManager *self)
 		return;
 
 	if (self->by_data) {
+		g_signal_handlers_disconnect_by_func (self->platform,
+		                                      G_CALLBACK (_platform_routing_rule_changed_cb),
+		                                      self);
 		g_hash_table_destroy (self->by_user_tag);
 		g_hash_table_destroy (self->by_obj);
 		g_hash_table_destroy (self->by_data);
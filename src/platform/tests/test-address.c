@@ -338,6 +338,187 @@ test_ip4_address_peer_zero (void)
 
 /*****************************************************************************/
 
+static void
+test_ip4_address_sync_many (void)
+{
+	const int ifindex = DEVICE_IFINDEX;
+	const guint N = 600;
+	const in_addr_t addr_base = nmtst_inet4_from_string ("10.200.0.0");
+	gs_unref_ptrarray GPtrArray *known_addresses = NULL;
+	GArray *addresses;
+	guint i;
+
+	known_addresses = g_ptr_array_new_with_free_func ((GDestroyNotify) nmp_object_unref);
+	for (i = 0; i < N; i++) {
+		const NMPlatformIP4Address a = {
+			.ifindex      = ifindex,
+			.address      = addr_base | htonl (i + 1),
+			.peer_address = addr_base | htonl (i + 1),
+			.plen         = 32,
+			.lifetime     = NM_PLATFORM_LIFETIME_PERMANENT,
+			.preferred    = NM_PLATFORM_LIFETIME_PERMANENT,
+		};
+
+		g_ptr_array_add (known_addresses, nmp_object_new (NMP_OBJECT_TYPE_IP4_ADDRESS, (const NMPlatformObject *) &a));
+	}
+
+	/* all addresses are added in one batch. */
+	g_assert (nm_platform_ip4_address_sync (NM_PLATFORM_GET, ifindex, known_addresses));
+	for (i = 0; i < N; i++)
+		g_assert (known_addresses->pdata[i]);
+
+	addresses = nmtstp_platform_ip4_address_get_all (NM_PLATFORM_GET, ifindex);
+	g_assert_cmpint (addresses->len, ==, N);
+	g_array_unref (addresses);
+
+	/* syncing again changes nothing. */
+	g_assert (nm_platform_ip4_address_sync (NM_PLATFORM_GET, ifindex, known_addresses));
+	addresses = nmtstp_platform_ip4_address_get_all (NM_PLATFORM_GET, ifindex);
+	g_assert_cmpint (addresses->len, ==, N);
+	g_array_unref (addresses);
+
+	/* all addresses are deleted in one batch. */
+	g_assert (nm_platform_ip_address_flush (NM_PLATFORM_GET, AF_INET, ifindex));
+	addresses = nmtstp_platform_ip4_address_get_all (NM_PLATFORM_GET, ifindex);
+	g_assert_cmpint (addresses->len, ==, 0);
+	g_array_unref (addresses);
+}
+
+static GPtrArray *
+_ip4_known_addresses (int ifindex, const char *const*addrs)
+{
+	GPtrArray *known_addresses;
+	guint i;
+
+	known_addresses = g_ptr_array_new_with_free_func ((GDestroyNotify) nmp_object_unref);
+	for (i = 0; addrs[i]; i++) {
+		const NMPlatformIP4Address a = {
+			.ifindex      = ifindex,
+			.address      = nmtst_inet4_from_string (addrs[i]),
+			.peer_address = nmtst_inet4_from_string (addrs[i]),
+			.plen         = 24,
+			.lifetime     = NM_PLATFORM_LIFETIME_PERMANENT,
+			.preferred    = NM_PLATFORM_LIFETIME_PERMANENT,
+		};
+
+		g_ptr_array_add (known_addresses, nmp_object_new (NMP_OBJECT_TYPE_IP4_ADDRESS, (const NMPlatformObject *) &a));
+	}
+	return known_addresses;
+}
+
+static void
+_ip4_address_sync (int ifindex, const char *const*addrs)
+{
+	gs_unref_ptrarray GPtrArray *known_addresses = _ip4_known_addresses (ifindex, addrs);
+	GArray *addresses;
+	guint i;
+
+	g_assert (nm_platform_ip4_address_sync (NM_PLATFORM_GET, ifindex, known_addresses));
+	for (i = 0; i < known_addresses->len; i++)
+		g_assert (known_addresses->pdata[i]);
+
+	addresses = nmtstp_platform_ip4_address_get_all (NM_PLATFORM_GET, ifindex);
+	g_assert_cmpint (addresses->len, ==, known_addresses->len);
+	g_array_unref (addresses);
+}
+
+typedef enum {
+	ADDR_ROLE_ABSENT,
+	ADDR_ROLE_PRIMARY,
+	ADDR_ROLE_SECONDARY,
+} AddrRole;
+
+static void
+_ip4_address_assert (int ifindex, const char *addr, AddrRole role)
+{
+	const NMPlatformIP4Address *a;
+	in_addr_t a_bin = nmtst_inet4_from_string (addr);
+
+	a = nm_platform_ip4_address_get (NM_PLATFORM_GET, ifindex, a_bin, 24, a_bin);
+	if (role == ADDR_ROLE_ABSENT) {
+		g_assert (!a);
+		return;
+	}
+	g_assert (a);
+
+	/* the fake platform does not track primary and secondary addresses. */
+	if (nmtstp_is_root_test ())
+		g_assert_cmpint (NM_FLAGS_HAS (a->n_ifa_flags, IFA_F_SECONDARY), ==, role == ADDR_ROLE_SECONDARY);
+}
+
+static void
+test_ip4_address_sync_secondary (void)
+{
+	const int ifindex = DEVICE_IFINDEX;
+
+	/* the first address of a subnet is the primary address, the others
+	 * are its secondaries. */
+	_ip4_address_sync (ifindex, NM_MAKE_STRV ("10.201.0.1", "10.201.0.2", "10.202.0.1"));
+	_ip4_address_assert (ifindex, "10.201.0.1", ADDR_ROLE_PRIMARY);
+	_ip4_address_assert (ifindex, "10.201.0.2", ADDR_ROLE_SECONDARY);
+	_ip4_address_assert (ifindex, "10.202.0.1", ADDR_ROLE_PRIMARY);
+
+	_ip4_address_sync (ifindex, NM_MAKE_STRV ("10.201.0.1", "10.201.0.2", "10.202.0.1"));
+	_ip4_address_assert (ifindex, "10.201.0.1", ADDR_ROLE_PRIMARY);
+	_ip4_address_assert (ifindex, "10.201.0.2", ADDR_ROLE_SECONDARY);
+	_ip4_address_assert (ifindex, "10.202.0.1", ADDR_ROLE_PRIMARY);
+
+	/* deleting the primary address deletes its secondaries in the same
+	 * batch. They are added back, and the first one becomes primary. */
+	_ip4_address_sync (ifindex, NM_MAKE_STRV ("10.201.0.2", "10.202.0.1"));
+	_ip4_address_assert (ifindex, "10.201.0.1", ADDR_ROLE_ABSENT);
+	_ip4_address_assert (ifindex, "10.201.0.2", ADDR_ROLE_PRIMARY);
+	_ip4_address_assert (ifindex, "10.202.0.1", ADDR_ROLE_PRIMARY);
+
+	/* a new primary address turns the old primary into a secondary. The
+	 * additions are sent in the order of the known addresses. */
+	_ip4_address_sync (ifindex, NM_MAKE_STRV ("10.201.0.3", "10.201.0.2", "10.202.0.1"));
+	_ip4_address_assert (ifindex, "10.201.0.3", ADDR_ROLE_PRIMARY);
+	_ip4_address_assert (ifindex, "10.201.0.2", ADDR_ROLE_SECONDARY);
+	_ip4_address_assert (ifindex, "10.202.0.1", ADDR_ROLE_PRIMARY);
+
+	g_assert (nm_platform_ip_address_flush (NM_PLATFORM_GET, AF_INET, ifindex));
+	_ip4_address_assert (ifindex, "10.201.0.3", ADDR_ROLE_ABSENT);
+	_ip4_address_assert (ifindex, "10.201.0.2", ADDR_ROLE_ABSENT);
+	_ip4_address_assert (ifindex, "10.202.0.1", ADDR_ROLE_ABSENT);
+}
+
+static void
+test_ip4_address_add_many_invalid (void)
+{
+	const int ifindex = DEVICE_IFINDEX;
+	NMPlatformIPXAddress addrs[3];
+	gboolean results[G_N_ELEMENTS (addrs)];
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS (addrs); i++) {
+		addrs[i].a4 = (NMPlatformIP4Address) {
+			.ifindex      = ifindex,
+			.address      = nmtst_inet4_from_string ("10.203.0.0") | htonl (i + 1),
+			.plen         = 24,
+			.lifetime     = NM_PLATFORM_LIFETIME_PERMANENT,
+			.preferred    = NM_PLATFORM_LIFETIME_PERMANENT,
+		};
+		addrs[i].a4.peer_address = addrs[i].a4.address;
+	}
+
+	/* an invalid address fails, but does not prevent the others from being added. */
+	addrs[1].a4.lifetime = 0;
+	NMTST_EXPECT_NM (G_LOG_LEVEL_CRITICAL, "*a->lifetime > 0*");
+	g_assert (!nm_platform_ip_address_add_many (NM_PLATFORM_GET, AF_INET, addrs, G_N_ELEMENTS (addrs), results));
+	g_test_assert_expected_messages ();
+	g_assert (results[0]);
+	g_assert (!results[1]);
+	g_assert (results[2]);
+	_ip4_address_assert (ifindex, "10.203.0.1", ADDR_ROLE_PRIMARY);
+	_ip4_address_assert (ifindex, "10.203.0.2", ADDR_ROLE_ABSENT);
+	_ip4_address_assert (ifindex, "10.203.0.3", ADDR_ROLE_SECONDARY);
+
+	g_assert (nm_platform_ip_address_flush (NM_PLATFORM_GET, AF_INET, ifindex));
+}
+
+/*****************************************************************************/
+
 NMTstpSetupFunc const _nmtstp_setup_platform_func = SETUP;
 
 void
@@ -362,4 +543,8 @@ _nmtstp_setup_tests (void)
 
 	add_test_func ("/address/ipv4/peer", test_ip4_address_peer);
 	add_test_func ("/address/ipv4/peer/zero", test_ip4_address_peer_zero);
+
+	add_test_func ("/address/ipv4/sync-many", test_ip4_address_sync_many);
+	add_test_func ("/address/ipv4/sync-secondary", test_ip4_address_sync_secondary);
+	add_test_func ("/address/ipv4/add-many-invalid", test_ip4_address_add_many_invalid);
 }
@@ -10,6 +10,7 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <linux/if_tun.h>
+#include <linux/rtnetlink.h>
 
 #include "nm-glib-aux/nm-io-utils.h"
 #include "platform/nmp-object.h"
@@ -546,6 +547,252 @@ test_bridge_addr (void)
 
 /*****************************************************************************/
 
+static void
+_assert_link_get_all_order (gboolean sort_by_name)
+{
+	gs_unref_ptrarray GPtrArray *links = NULL;
+	gs_unref_hashtable GHashTable *seen = NULL;
+	guint i;
+
+	links = nm_platform_link_get_all (NM_PLATFORM_GET, sort_by_name);
+	g_assert (links);
+	g_assert_cmpint (NMP_OBJECT_CAST_LINK (links->pdata[0])->ifindex, ==, LO_INDEX);
+
+	seen = g_hash_table_new (nm_direct_hash, NULL);
+	for (i = 0; i < links->len; i++) {
+		const NMPlatformLink *plink = NMP_OBJECT_CAST_LINK (links->pdata[i]);
+
+		g_assert (nmp_object_is_visible (links->pdata[i]));
+		if (plink->master > 0)
+			g_assert (g_hash_table_contains (seen, GINT_TO_POINTER (plink->master)));
+		if (plink->parent > 0) {
+			const NMPlatformLink *plink_parent;
+
+			/* veth peers are each other's parent. Only the second one can
+			 * come after its parent. */
+			plink_parent = nm_platform_link_get (NM_PLATFORM_GET, plink->parent);
+			if (   !plink_parent
+			    || plink_parent->parent != plink->ifindex)
+				g_assert (g_hash_table_contains (seen, GINT_TO_POINTER (plink->parent)));
+		}
+		g_assert (g_hash_table_add (seen, GINT_TO_POINTER (plink->ifindex)));
+	}
+}
+
+static void
+test_link_get_all_order (void)
+{
+	const char *const IFACE_VETH0 = "nm-test-veth0";
+	const char *const IFACE_VETH1 = "nm-test-veth1";
+	const NMPlatformLink *plink;
+	int ifindex_slave;
+	int ifindex_master;
+	int ifindex_vlan;
+	int ifindex_veth0;
+
+	/* create the links so that neither ordering by ifindex nor by name
+	 * has ancestors first:
+	 *
+	 *   SLAVE_NAME (dummy, lowest ifindex) is a port of PARENT_NAME (bridge),
+	 *   DEVICE_NAME (vlan, sorts first by name) sits on top of SLAVE_NAME. */
+	g_assert (NMTST_NM_ERR_SUCCESS (nm_platform_link_dummy_add (NM_PLATFORM_GET, SLAVE_NAME, &plink)));
+	ifindex_slave = plink->ifindex;
+	g_assert (NMTST_NM_ERR_SUCCESS (nm_platform_link_bridge_add (NM_PLATFORM_GET, PARENT_NAME, NULL, 0, &plink)));
+	ifindex_master = plink->ifindex;
+	g_assert (nm_platform_link_enslave (NM_PLATFORM_GET, ifindex_master, ifindex_slave));
+	g_assert_cmpint (nm_platform_link_get_master (NM_PLATFORM_GET, ifindex_slave), ==, ifindex_master);
+	g_assert (NMTST_NM_ERR_SUCCESS (nm_platform_link_vlan_add (NM_PLATFORM_GET, DEVICE_NAME, ifindex_slave, VLAN_ID, VLAN_FLAGS, &plink)));
+	ifindex_vlan = plink->ifindex;
+	g_assert (NMTST_NM_ERR_SUCCESS (nm_platform_link_veth_add (NM_PLATFORM_GET, IFACE_VETH0, IFACE_VETH1, &plink)));
+	ifindex_veth0 = plink->ifindex;
+
+	g_assert_cmpint (ifindex_slave, <, ifindex_master);
+	g_assert_cmpstr (DEVICE_NAME, <, SLAVE_NAME);
+
+	_assert_link_get_all_order (FALSE);
+	_assert_link_get_all_order (TRUE);
+
+	if (nmtstp_is_root_test ()) {
+		/* renaming moves the link in the name index. */
+		g_assert (nm_platform_link_set_name (NM_PLATFORM_GET, ifindex_master, "nm-test-a"));
+		_assert_link_get_all_order (TRUE);
+	}
+
+	nmtstp_link_delete (NULL, -1, ifindex_vlan, DEVICE_NAME, TRUE);
+	nmtstp_link_delete (NULL, -1, ifindex_master, NULL, TRUE);
+	nmtstp_link_delete (NULL, -1, ifindex_slave, SLAVE_NAME, TRUE);
+	nmtstp_link_delete (NULL, -1, ifindex_veth0, IFACE_VETH0, TRUE);
+	nmtstp_link_delete (NULL, -1, -1, IFACE_VETH1, FALSE);
+
+	_assert_link_get_all_order (FALSE);
+	_assert_link_get_all_order (TRUE);
+}
+
+/*****************************************************************************/
+
+static void
+test_link_set_up_many (void)
+{
+#define N 5
+	int ifindexes[N + 1];
+	int results[N + 1];
+	guint i;
+
+	for (i = 0; i < N; i++) {
+		char ifname[IFNAMSIZ];
+
+		nm_sprintf_buf (ifname, "nm-test-up%u", i);
+		ifindexes[i] = nmtstp_link_dummy_add (NM_PLATFORM_GET, -1, ifname)->ifindex;
+		g_assert (!nm_platform_link_is_up (NM_PLATFORM_GET, ifindexes[i]));
+	}
+
+	/* a link that does not exist only fails its own request. */
+	ifindexes[N] = G_MAXINT - 1;
+
+	nm_platform_link_set_up_many (NM_PLATFORM_GET, ifindexes, N + 1, results);
+
+	for (i = 0; i < N; i++) {
+		g_assert_cmpint (results[i], ==, 0);
+		g_assert (nm_platform_link_is_up (NM_PLATFORM_GET, ifindexes[i]));
+	}
+	g_assert_cmpint (results[N], <, 0);
+
+	for (i = 0; i < N; i++)
+		nmtstp_link_delete (NULL, -1, ifindexes[i], NULL, TRUE);
+#undef N
+}
+
+/*****************************************************************************/
+
+typedef struct {
+	GMainLoop *loop;
+	gboolean expected_success;
+} EthtoolQueryAsyncData;
+
+static void
+ethtool_query_async_cb (GError *error, gpointer user_data)
+{
+	EthtoolQueryAsyncData *data = user_data;
+
+	if (data->expected_success)
+		g_assert_no_error (error);
+	else
+		g_assert (error);
+
+	g_main_loop_quit (data->loop);
+}
+
+static void
+test_link_ethtool_query_async (void)
+{
+	NMPlatform *const PL = NM_PLATFORM_GET;
+	gs_free char *driver_name1 = NULL;
+	gs_free char *driver_name2 = NULL;
+	gboolean success1;
+	gboolean success2;
+	EthtoolQueryAsyncData data;
+	GMainLoop *loop;
+	int ifindex;
+
+	ifindex = nmtstp_link_dummy_add (PL, -1, "nm-test-ethtool")->ifindex;
+	loop = g_main_loop_new (NULL, FALSE);
+
+	g_assert_cmpint (_nmtst_platform_ethtool_cache_get_valid (PL, ifindex), ==, NM_PLATFORM_ETHTOOL_QUERY_NONE);
+
+	data = (EthtoolQueryAsyncData) {
+		.loop = loop,
+		.expected_success = TRUE,
+	};
+	nm_platform_link_ethtool_query_async (PL,
+	                                      ifindex,
+	                                      NM_PLATFORM_ETHTOOL_QUERY_ALL,
+	                                      ethtool_query_async_cb,
+	                                      &data,
+	                                      NULL);
+	if (!nmtst_main_loop_run (loop, 1000))
+		g_assert_not_reached ();
+	g_assert_cmpint (_nmtst_platform_ethtool_cache_get_valid (PL, ifindex), ==, NM_PLATFORM_ETHTOOL_QUERY_ALL);
+
+	/* reading is served from the cache. */
+	success1 = nm_platform_link_get_driver_info (PL, ifindex, &driver_name1, NULL, NULL);
+	g_assert_cmpint (_nmtst_platform_ethtool_cache_get_valid (PL, ifindex), ==, NM_PLATFORM_ETHTOOL_QUERY_ALL);
+
+	/* a change of the link drops only the volatile settings. Either way, the
+	 * result does not change. */
+	g_assert (nm_platform_link_set_up (PL, ifindex, NULL));
+	g_assert_cmpint (_nmtst_platform_ethtool_cache_get_valid (PL, ifindex), ==,   NM_PLATFORM_ETHTOOL_QUERY_DRIVER_INFO
+	                                                                            | NM_PLATFORM_ETHTOOL_QUERY_PERMANENT_ADDRESS);
+	success2 = nm_platform_link_get_driver_info (PL, ifindex, &driver_name2, NULL, NULL);
+	g_assert_cmpint (success1, ==, success2);
+	g_assert_cmpstr (driver_name1, ==, driver_name2);
+
+	/* once everything is cached, the callback is still invoked asynchronously. */
+	data.expected_success = TRUE;
+	nm_platform_link_ethtool_query_async (PL,
+	                                      ifindex,
+	                                      NM_PLATFORM_ETHTOOL_QUERY_DRIVER_INFO,
+	                                      ethtool_query_async_cb,
+	                                      &data,
+	                                      NULL);
+	if (!nmtst_main_loop_run (loop, 1000))
+		g_assert_not_reached ();
+
+	if (NM_IS_LINUX_PLATFORM (PL)) {
+		/* every RTM_NEWLINK notification drops the volatile settings, even if
+		 * the link in the cache does not change. That is how the kernel
+		 * announces changes like "ethtool -K". But the replies to our own
+		 * requests keep them. */
+		nm_platform_link_ethtool_query_async (PL,
+		                                      ifindex,
+		                                      NM_PLATFORM_ETHTOOL_QUERY_FEATURES,
+		                                      ethtool_query_async_cb,
+		                                      &data,
+		                                      NULL);
+		if (!nmtst_main_loop_run (loop, 1000))
+			g_assert_not_reached ();
+		g_assert (NM_FLAGS_HAS (_nmtst_platform_ethtool_cache_get_valid (PL, ifindex), NM_PLATFORM_ETHTOOL_QUERY_FEATURES));
+
+		g_assert (nm_platform_link_refresh (PL, ifindex));
+		g_assert (NM_FLAGS_HAS (_nmtst_platform_ethtool_cache_get_valid (PL, ifindex), NM_PLATFORM_ETHTOOL_QUERY_FEATURES));
+
+		if (nmtstp_run_command ("ethtool -K nm-test-ethtool tx off") == 0) {
+			nm_platform_process_events (PL);
+			g_assert (!NM_FLAGS_HAS (_nmtst_platform_ethtool_cache_get_valid (PL, ifindex), NM_PLATFORM_ETHTOOL_QUERY_FEATURES));
+			g_assert (NM_FLAGS_HAS (_nmtst_platform_ethtool_cache_get_valid (PL, ifindex), NM_PLATFORM_ETHTOOL_QUERY_DRIVER_INFO));
+		}
+	}
+
+	/* the result of a query is dropped, if the link changes while the query
+	 * is pending. */
+	nm_platform_link_ethtool_query_async (PL,
+	                                      ifindex,
+	                                      NM_PLATFORM_ETHTOOL_QUERY_RING,
+	                                      ethtool_query_async_cb,
+	                                      &data,
+	                                      NULL);
+	g_assert (nm_platform_link_set_down (PL, ifindex));
+	if (!nmtst_main_loop_run (loop, 1000))
+		g_assert_not_reached ();
+	g_assert (!NM_FLAGS_HAS (_nmtst_platform_ethtool_cache_get_valid (PL, ifindex), NM_PLATFORM_ETHTOOL_QUERY_RING));
+
+	nmtstp_link_delete (NULL, -1, ifindex, NULL, TRUE);
+	g_assert_cmpint (_nmtst_platform_ethtool_cache_get_valid (PL, ifindex), ==, NM_PLATFORM_ETHTOOL_QUERY_NONE);
+
+	data.expected_success = FALSE;
+	nm_platform_link_ethtool_query_async (PL,
+	                                      ifindex,
+	                                      NM_PLATFORM_ETHTOOL_QUERY_DRIVER_INFO,
+	                                      ethtool_query_async_cb,
+	                                      &data,
+	                                      NULL);
+	if (!nmtst_main_loop_run (loop, 1000))
+		g_assert_not_reached ();
+
+	g_main_loop_unref (loop);
+}
+
+/*****************************************************************************/
+
 static void
 test_internal (void)
 {
@@ -920,6 +1167,202 @@ _test_wireguard_change (NMPlatform *platform,
 	g_assert (NMTST_NM_ERR_SUCCESS (r));
 }
 
+static void
+_wireguard_peer_init (NMPWireGuardPeer *peer,
+                      guint8 key,
+                      guint16 keepalive,
+                      gboolean with_endpoint,
+                      const NMPWireGuardAllowedIP *allowed_ips,
+                      guint allowed_ips_len)
+{
+	*peer = (NMPWireGuardPeer) {
+		.persistent_keepalive_interval = keepalive,
+		.allowed_ips                   = allowed_ips_len > 0 ? allowed_ips : NULL,
+		.allowed_ips_len               = allowed_ips_len,
+	};
+	memset (peer->public_key, key, sizeof (peer->public_key));
+	if (with_endpoint) {
+		peer->endpoint = (NMSockAddrUnion) {
+			.in = {
+				.sin_family      = AF_INET,
+				.sin_addr.s_addr = nmtst_inet4_from_string ("192.168.7.1"),
+				.sin_port        = htons (14000 + key),
+			},
+		};
+	}
+}
+
+static NMPObject *
+_wireguard_lnk_new (const NMPWireGuardPeer *peers, guint peers_len)
+{
+	NMPObject *obj;
+	NMPWireGuardPeer *obj_peers;
+	NMPWireGuardAllowedIP *buf;
+	guint n_allowed_ips = 0;
+	guint i;
+
+	obj = nmp_object_new (NMP_OBJECT_TYPE_LNK_WIREGUARD, NULL);
+	obj->_lnk_wireguard._public.listen_port = 50754;
+	obj->_lnk_wireguard._public.fwmark = 0x1102;
+
+	for (i = 0; i < peers_len; i++)
+		n_allowed_ips += peers[i].allowed_ips_len;
+
+	obj_peers = g_new0 (NMPWireGuardPeer, NM_MAX (peers_len, 1u));
+	buf = g_new0 (NMPWireGuardAllowedIP, NM_MAX (n_allowed_ips, 1u));
+	n_allowed_ips = 0;
+	for (i = 0; i < peers_len; i++) {
+		obj_peers[i] = peers[i];
+		if (peers[i].allowed_ips_len > 0) {
+			memcpy (&buf[n_allowed_ips], peers[i].allowed_ips, sizeof (buf[0]) * peers[i].allowed_ips_len);
+			obj_peers[i].allowed_ips = &buf[n_allowed_ips];
+			n_allowed_ips += peers[i].allowed_ips_len;
+		}
+	}
+
+	obj->_lnk_wireguard.peers = obj_peers;
+	obj->_lnk_wireguard.peers_len = peers_len;
+	obj->_lnk_wireguard._allowed_ips_buf = buf;
+	obj->_lnk_wireguard._allowed_ips_buf_len = n_allowed_ips;
+	return obj;
+}
+
+static void
+test_wireguard_change_delta (void)
+{
+	NMPWireGuardAllowedIP aips[3];
+	NMPWireGuardPeer cached_peers[2];
+	NMPWireGuardPeer peers[3];
+	NMPlatformWireGuardChangePeerFlags peer_flags[3];
+	nm_auto_nmpobj NMPObject *lnk_cached = NULL;
+	NMPlatformLnkWireGuard lnk_wireguard;
+	NMPlatformWireGuardChangeFlags change_flags;
+	gs_free NMPWireGuardPeer *d_peers = NULL;
+	gs_free NMPlatformWireGuardChangePeerFlags *d_peer_flags = NULL;
+	gs_free NMPWireGuardAllowedIP *d_allowed_ips_buf = NULL;
+	guint d_peers_len;
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS (aips); i++) {
+		aips[i] = (NMPWireGuardAllowedIP) {
+			.family     = AF_INET,
+			.addr.addr4 = htonl (0x0a000000u + (i << 8)),
+			.mask       = 24,
+		};
+	}
+
+	_wireguard_peer_init (&cached_peers[0], 1, 25, TRUE, &aips[0], 1);
+	_wireguard_peer_init (&cached_peers[1], 2, 0, FALSE, &aips[1], 1);
+	lnk_cached = _wireguard_lnk_new (cached_peers, G_N_ELEMENTS (cached_peers));
+
+	lnk_wireguard = lnk_cached->lnk_wireguard;
+
+#define _delta(peers_len, peer_flags, flags) \
+	G_STMT_START { \
+		nm_clear_g_free (&d_peers); \
+		nm_clear_g_free (&d_peer_flags); \
+		nm_clear_g_free (&d_allowed_ips_buf); \
+		change_flags = (flags); \
+		nmp_object_lnk_wireguard_create_change_delta (lnk_cached, \
+		                                              &lnk_wireguard, \
+		                                              peers, \
+		                                              (peer_flags), \
+		                                              (peers_len), \
+		                                              &change_flags, \
+		                                              &d_peers, \
+		                                              &d_peer_flags, \
+		                                              &d_peers_len, \
+		                                              &d_allowed_ips_buf); \
+	} G_STMT_END
+
+	/* the requested configuration is already configured. Nothing to do. */
+	peers[0] = cached_peers[0];
+	peers[1] = cached_peers[1];
+	_delta (2,
+	        NULL,
+	          NM_PLATFORM_WIREGUARD_CHANGE_FLAG_REPLACE_PEERS
+	        | NM_PLATFORM_WIREGUARD_CHANGE_FLAG_HAS_LISTEN_PORT
+	        | NM_PLATFORM_WIREGUARD_CHANGE_FLAG_HAS_FWMARK);
+	g_assert_cmpint (change_flags, ==, NM_PLATFORM_WIREGUARD_CHANGE_FLAG_NONE);
+	g_assert_cmpint (d_peers_len, ==, 0);
+
+	/* a changed device attribute is sent. */
+	lnk_wireguard.listen_port = 50755;
+	_delta (2,
+	        NULL,
+	          NM_PLATFORM_WIREGUARD_CHANGE_FLAG_HAS_LISTEN_PORT
+	        | NM_PLATFORM_WIREGUARD_CHANGE_FLAG_HAS_FWMARK);
+	g_assert_cmpint (change_flags, ==, NM_PLATFORM_WIREGUARD_CHANGE_FLAG_HAS_LISTEN_PORT);
+	g_assert_cmpint (d_peers_len, ==, 0);
+	lnk_wireguard.listen_port = lnk_cached->lnk_wireguard.listen_port;
+
+	/* with replace-peers, only the changed attribute of an existing peer is
+	 * sent, a new peer is added and the peer that is no longer wanted gets
+	 * removed. */
+	peers[0].persistent_keepalive_interval = 30;
+	_wireguard_peer_init (&peers[1], 3, 0, FALSE, &aips[2], 1);
+	_delta (2, NULL, NM_PLATFORM_WIREGUARD_CHANGE_FLAG_REPLACE_PEERS);
+	g_assert_cmpint (change_flags, ==, NM_PLATFORM_WIREGUARD_CHANGE_FLAG_NONE);
+	g_assert_cmpint (d_peers_len, ==, 3);
+	g_assert_cmpint (d_peers[0].public_key[0], ==, 1);
+	g_assert_cmpint (d_peer_flags[0], ==, NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_KEEPALIVE_INTERVAL);
+	g_assert_cmpint (d_peers[0].persistent_keepalive_interval, ==, 30);
+	g_assert_cmpint (d_peers[1].public_key[0], ==, 3);
+	g_assert_cmpint (d_peer_flags[1], ==, NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_DEFAULT);
+	g_assert_cmpint (d_peers[1].allowed_ips_len, ==, 1);
+	g_assert_cmpint (d_peers[2].public_key[0], ==, 2);
+	g_assert_cmpint (d_peer_flags[2], ==, NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_REMOVE_ME);
+
+	/* without replace-peers, peers that are not mentioned are kept. Allowed-ips
+	 * are only added, if none of the configured ones need to go away. */
+	peers[0] = cached_peers[0];
+	peers[0].allowed_ips = &aips[0];
+	peers[0].allowed_ips_len = 2;
+	peer_flags[0] = NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_ALLOWEDIPS;
+	_delta (1, peer_flags, NM_PLATFORM_WIREGUARD_CHANGE_FLAG_NONE);
+	g_assert_cmpint (d_peers_len, ==, 1);
+	g_assert_cmpint (d_peer_flags[0], ==, NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_ALLOWEDIPS);
+	g_assert_cmpint (d_peers[0].allowed_ips_len, ==, 1);
+	g_assert_cmpint (d_peers[0].allowed_ips[0].addr.addr4, ==, aips[1].addr.addr4);
+
+	/* ... and replaced, if some must go away. */
+	peers[0].allowed_ips = &aips[1];
+	peers[0].allowed_ips_len = 1;
+	peer_flags[0] =   NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_ALLOWEDIPS
+	                | NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_REPLACE_ALLOWEDIPS;
+	_delta (1, peer_flags, NM_PLATFORM_WIREGUARD_CHANGE_FLAG_NONE);
+	g_assert_cmpint (d_peers_len, ==, 1);
+	g_assert_cmpint (d_peer_flags[0], ==, peer_flags[0]);
+	g_assert_cmpint (d_peers[0].allowed_ips_len, ==, 1);
+	g_assert (d_peers[0].allowed_ips == &aips[1]);
+
+	/* removing a peer that is not configured is a no-op. */
+	_wireguard_peer_init (&peers[0], 9, 0, FALSE, NULL, 0);
+	peer_flags[0] = NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_REMOVE_ME;
+	peers[1] = cached_peers[1];
+	peer_flags[1] = NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_REMOVE_ME;
+	_delta (2, peer_flags, NM_PLATFORM_WIREGUARD_CHANGE_FLAG_NONE);
+	g_assert_cmpint (d_peers_len, ==, 1);
+	g_assert_cmpint (d_peers[0].public_key[0], ==, 2);
+	g_assert_cmpint (d_peer_flags[0], ==, NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_REMOVE_ME);
+
+	/* with replace-peers, a peer without requested endpoint loses its endpoint.
+	 * That cannot be cleared, so the peer is removed and added again. */
+	peers[0] = cached_peers[0];
+	peer_flags[0] = NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_ALLOWEDIPS;
+	peers[1] = cached_peers[1];
+	peer_flags[1] = NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_ALLOWEDIPS;
+	_delta (2, peer_flags, NM_PLATFORM_WIREGUARD_CHANGE_FLAG_REPLACE_PEERS);
+	g_assert_cmpint (change_flags, ==, NM_PLATFORM_WIREGUARD_CHANGE_FLAG_NONE);
+	g_assert_cmpint (d_peers_len, ==, 2);
+	g_assert_cmpint (d_peers[0].public_key[0], ==, 1);
+	g_assert_cmpint (d_peer_flags[0], ==, NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_REMOVE_ME);
+	g_assert_cmpint (d_peers[1].public_key[0], ==, 1);
+	g_assert_cmpint (d_peer_flags[1], ==, NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_ALLOWEDIPS);
+	g_assert_cmpint (d_peers[1].allowed_ips_len, ==, 1);
+#undef _delta
+}
+
 /*****************************************************************************/
 
 typedef struct {
@@ -3165,6 +3608,159 @@ test_sysctl_set_async_fail (void)
 	g_main_loop_unref (loop);
 }
 
+typedef struct {
+	GMainLoop *loop;
+	gboolean expected_success;
+	guint n_called;
+} SysctlBatchData;
+
+static void
+sysctl_batch_cb (GError *error, gpointer user_data)
+{
+	SysctlBatchData *data = user_data;
+
+	if (data->expected_success)
+		g_assert_no_error (error);
+	else
+		g_assert (error);
+
+	data->n_called++;
+	g_main_loop_quit (data->loop);
+}
+
+static void
+test_sysctl_batch (void)
+{
+	NMPlatform *const PL = NM_PLATFORM_GET;
+	const char *const IFNAME = "nm-dummy-0";
+	NMPlatformSysctlBatch *batch;
+	nm_auto_close int dirfd = -1;
+	gs_unref_object GCancellable *cancellable = g_cancellable_new ();
+	GMainLoop *loop;
+	SysctlBatchData data;
+	gboolean sysfs_writable;
+	int ifindex;
+
+	if (_check_sysctl_skip ())
+		return;
+
+	sysfs_writable = nmtstp_is_sysfs_writable ();
+	ifindex = nmtstp_link_dummy_add (PL, -1, IFNAME)->ifindex;
+	loop = g_main_loop_new (NULL, FALSE);
+
+	dirfd = nm_platform_sysctl_open_netdir (PL, ifindex, NULL);
+	g_assert (dirfd >= 0);
+
+	/* all values are written, and one failure is reported. */
+	data = (SysctlBatchData) {
+		.loop = loop,
+		.expected_success = FALSE,
+	};
+	batch = nm_platform_sysctl_batch_new (PL);
+	nm_platform_sysctl_batch_add_ip_conf (batch, AF_INET, IFNAME, "rp_filter", "2");
+	nm_platform_sysctl_batch_add_ip_conf (batch, AF_INET, IFNAME, "does-not-exist", "1");
+	nm_platform_sysctl_batch_add_ip_conf (batch, AF_INET6, IFNAME, "accept_ra", "0");
+	if (sysfs_writable)
+		nm_platform_sysctl_batch_add (batch, NMP_SYSCTL_PATHID_NETDIR (dirfd, IFNAME, "tx_queue_len"), "123");
+	g_assert_cmpint (nm_platform_sysctl_batch_get_len (batch), ==, sysfs_writable ? 4 : 3);
+	nm_platform_sysctl_batch_commit (batch, sysctl_batch_cb, &data, NULL);
+
+	if (!nmtst_main_loop_run (loop, 1000))
+		g_assert_not_reached ();
+	g_assert_cmpint (data.n_called, ==, 1);
+	g_assert_cmpint (nm_platform_sysctl_ip_conf_get_int_checked (PL, AF_INET, IFNAME, "rp_filter", 10, 0, 2, -1), ==, 2);
+	g_assert_cmpint (nm_platform_sysctl_ip_conf_get_int_checked (PL, AF_INET6, IFNAME, "accept_ra", 10, 0, 2, -1), ==, 0);
+	if (sysfs_writable)
+		g_assert_cmpint (nm_platform_sysctl_get_int32 (PL, NMP_SYSCTL_PATHID_NETDIR (dirfd, IFNAME, "tx_queue_len"), -1), ==, 123);
+
+	/* reading a value right after the commit waits for the batch. */
+	data = (SysctlBatchData) {
+		.loop = loop,
+		.expected_success = TRUE,
+	};
+	batch = nm_platform_sysctl_batch_new (PL);
+	nm_platform_sysctl_batch_add_ip_conf (batch, AF_INET, IFNAME, "rp_filter", "1");
+	nm_platform_sysctl_batch_add_ip_conf (batch, AF_INET, IFNAME, "rp_filter", "0");
+	nm_platform_sysctl_batch_commit (batch, sysctl_batch_cb, &data, NULL);
+	g_assert_cmpint (nm_platform_sysctl_ip_conf_get_int_checked (PL, AF_INET, IFNAME, "rp_filter", 10, 0, 2, -1), ==, 0);
+	g_assert_cmpint (data.n_called, ==, 0);
+
+	if (!nmtst_main_loop_run (loop, 1000))
+		g_assert_not_reached ();
+	g_assert_cmpint (data.n_called, ==, 1);
+
+	/* an asynchronous write does not overtake a committed batch. */
+	data = (SysctlBatchData) {
+		.loop = loop,
+		.expected_success = TRUE,
+	};
+	batch = nm_platform_sysctl_batch_new (PL);
+	nm_platform_sysctl_batch_add_ip_conf (batch, AF_INET, IFNAME, "rp_filter", "1");
+	nm_platform_sysctl_batch_commit (batch, sysctl_batch_cb, &data, NULL);
+	nm_platform_sysctl_set_async (PL,
+	                              NMP_SYSCTL_PATHID_ABSOLUTE ("/proc/sys/net/ipv4/conf/nm-dummy-0/rp_filter"),
+	                              (const char *[]) { "2", NULL },
+	                              sysctl_batch_cb,
+	                              &data,
+	                              cancellable);
+	while (data.n_called < 2) {
+		if (!nmtst_main_loop_run (loop, 1000))
+			g_assert_not_reached ();
+	}
+	g_assert_cmpint (nm_platform_sysctl_ip_conf_get_int_checked (PL, AF_INET, IFNAME, "rp_filter", 10, 0, 2, -1), ==, 2);
+
+	nmtstp_link_delete (NULL, -1, ifindex, IFNAME, TRUE);
+	g_main_loop_unref (loop);
+}
+
+static void
+test_sysctl_cache (void)
+{
+	NMPlatform *const PL = NM_PLATFORM_GET;
+	const char *const IFNAME = "nm-dummy-0";
+	const char *const PATH = "/proc/sys/net/ipv4/conf/nm-dummy-0/forwarding";
+	NMPlatformSysctlCacheStats stats0;
+	NMPlatformSysctlCacheStats stats;
+	int ifindex;
+
+	if (_check_sysctl_skip ())
+		return;
+
+	ifindex = nmtstp_link_dummy_add (PL, -1, IFNAME)->ifindex;
+
+	if (!nm_platform_sysctl_cache_get_stats (PL, &stats0)) {
+		nmtstp_link_delete (NULL, -1, ifindex, IFNAME, TRUE);
+		g_test_skip ("Platform has no sysctl cache");
+		return;
+	}
+
+	/* the first read goes to the file, the second one not. */
+	g_assert (nm_platform_sysctl_set (PL, NMP_SYSCTL_PATHID_ABSOLUTE (PATH), "0"));
+	_sysctl_assert_eq (PL, PATH, "0");
+	nm_platform_sysctl_cache_get_stats (PL, &stats);
+	g_assert_cmpint (stats.hits, ==, stats0.hits + 1);
+	g_assert_cmpint (stats.misses, ==, stats0.misses);
+	g_assert_cmpint (stats.n_entries, >, 0);
+
+	g_assert (nm_platform_sysctl_set (PL, NMP_SYSCTL_PATHID_ABSOLUTE (PATH), "1"));
+	_sysctl_assert_eq (PL, PATH, "1");
+	nm_platform_sysctl_cache_get_stats (PL, &stats);
+	g_assert_cmpint (stats.hits, ==, stats0.hits + 2);
+
+	/* somebody else changes the value. Kernel tells us via RTM_NEWNETCONF. */
+	nmtstp_run_command_check ("echo 0 > %s", PATH);
+	nm_platform_process_events (PL);
+	_sysctl_assert_eq (PL, PATH, "0");
+	nm_platform_sysctl_cache_get_stats (PL, &stats);
+	g_assert_cmpint (stats.updates_netconf, >, stats0.updates_netconf);
+
+	/* the values of a link are forgotten, when the link goes away. */
+	nmtstp_link_delete (NULL, -1, ifindex, IFNAME, TRUE);
+	_sysctl_assert_eq (PL, PATH, NULL);
+	nm_platform_sysctl_cache_get_stats (PL, &stats);
+	g_assert_cmpint (stats.n_entries, ==, stats0.n_entries);
+}
+
 /*****************************************************************************/
 
 static gpointer
@@ -3322,6 +3918,89 @@ test_ethtool_features_get (void)
 
 /*****************************************************************************/
 
+typedef struct {
+	guint n_overflows;
+	guint n_links;
+	guint n_ip4_routes;
+	guint n_ip6_routes;
+	guint n_rules;
+	guint n_qdiscs;
+} NLEventStats;
+
+static void
+_nl_event_stats_get (NLEventStats *stats)
+{
+	NMPlatform *platform = NM_PLATFORM_GET;
+
+	_nmtst_linux_platform_nl_event_get_stats (platform, &stats->n_overflows, NULL);
+	stats->n_links = _nmtst_linux_platform_nl_event_get_n_resyncs (platform, NMP_OBJECT_TYPE_LINK);
+	stats->n_ip4_routes = _nmtst_linux_platform_nl_event_get_n_resyncs (platform, NMP_OBJECT_TYPE_IP4_ROUTE);
+	stats->n_ip6_routes = _nmtst_linux_platform_nl_event_get_n_resyncs (platform, NMP_OBJECT_TYPE_IP6_ROUTE);
+	stats->n_rules = _nmtst_linux_platform_nl_event_get_n_resyncs (platform, NMP_OBJECT_TYPE_ROUTING_RULE);
+	stats->n_qdiscs = _nmtst_linux_platform_nl_event_get_n_resyncs (platform, NMP_OBJECT_TYPE_QDISC);
+}
+
+#define _assert_nl_event_stats(stats0, overflows, links, ip4_routes, ip6_routes, rules, qdiscs) \
+	G_STMT_START { \
+		const NLEventStats *const _stats0 = (stats0); \
+		NLEventStats _stats; \
+		\
+		_nl_event_stats_get (&_stats); \
+		g_assert_cmpint (_stats.n_overflows - _stats0->n_overflows, ==, (overflows)); \
+		g_assert_cmpint (_stats.n_links - _stats0->n_links, ==, (links)); \
+		g_assert_cmpint (_stats.n_ip4_routes - _stats0->n_ip4_routes, ==, (ip4_routes)); \
+		g_assert_cmpint (_stats.n_ip6_routes - _stats0->n_ip6_routes, ==, (ip6_routes)); \
+		g_assert_cmpint (_stats.n_rules - _stats0->n_rules, ==, (rules)); \
+		g_assert_cmpint (_stats.n_qdiscs - _stats0->n_qdiscs, ==, (qdiscs)); \
+	} G_STMT_END
+
+static void
+test_nl_event_overflow (void)
+{
+	NMPlatform *platform = NM_PLATFORM_GET;
+	NLEventStats stats0;
+	int rcvbuf_size;
+
+	g_assert (NM_IS_LINUX_PLATFORM (platform));
+
+	nm_platform_process_events (platform);
+	_nl_event_stats_get (&stats0);
+
+	/* by default, every overflow resyncs all types. Routing rules are
+	 * resynced per address family. */
+	nm_platform_netlink_config_set (platform, 16 * 1024 * 1024, FALSE);
+	_nmtst_linux_platform_nl_event_overflow (platform, RTM_NEWROUTE);
+	nm_platform_process_events (platform);
+	_assert_nl_event_stats (&stats0, 1, 1, 1, 1, 2, 1);
+
+	/* the receive buffer grew, but only up to the maximum. */
+	_nmtst_linux_platform_nl_event_get_stats (platform, NULL, &rcvbuf_size);
+	g_assert_cmpint (rcvbuf_size, ==, 16 * 1024 * 1024);
+	_nmtst_linux_platform_nl_event_overflow (platform, RTM_NEWROUTE);
+	nm_platform_process_events (platform);
+	_assert_nl_event_stats (&stats0, 2, 2, 2, 2, 4, 2);
+	_nmtst_linux_platform_nl_event_get_stats (platform, NULL, &rcvbuf_size);
+	g_assert_cmpint (rcvbuf_size, ==, 16 * 1024 * 1024);
+
+	/* only resync the affected types right away. */
+	nm_platform_netlink_config_set (platform, 16 * 1024 * 1024, TRUE);
+	_nmtst_linux_platform_nl_event_overflow (platform, RTM_NEWROUTE);
+	nm_platform_process_events (platform);
+	_assert_nl_event_stats (&stats0, 3, 2, 3, 3, 4, 2);
+
+	_nmtst_linux_platform_nl_event_overflow (platform, RTM_NEWLINK);
+	nm_platform_process_events (platform);
+	_assert_nl_event_stats (&stats0, 4, 3, 3, 3, 4, 2);
+
+	/* the types that the last overflow did not resync are resynced, when
+	 * we stop deferring them. */
+	nm_platform_netlink_config_set (platform, 0, FALSE);
+	nm_platform_process_events (platform);
+	_assert_nl_event_stats (&stats0, 4, 3, 4, 4, 6, 3);
+}
+
+/*****************************************************************************/
+
 NMTstpSetupFunc const _nmtstp_setup_platform_func = SETUP;
 
 void
@@ -3348,6 +4027,10 @@ _nmtstp_setup_tests (void)
 	g_test_add_func ("/link/software/team", test_team);
 	g_test_add_func ("/link/software/vlan", test_vlan);
 	g_test_add_func ("/link/software/bridge/addr", test_bridge_addr);
+	g_test_add_func ("/link/get-all/order", test_link_get_all_order);
+	g_test_add_func ("/link/set-up-many", test_link_set_up_many);
+	g_test_add_func ("/link/ethtool-query-async", test_link_ethtool_query_async);
+	g_test_add_func ("/link/wireguard/change-delta", test_wireguard_change_delta);
 
 	if (nmtstp_is_root_test ()) {
 		g_test_add_func ("/link/external", test_external);
@@ -3391,7 +4074,11 @@ _nmtstp_setup_tests (void)
 		g_test_add_func ("/general/sysctl/netns-switch", test_sysctl_netns_switch);
 		g_test_add_func ("/general/sysctl/set-async", test_sysctl_set_async);
 		g_test_add_func ("/general/sysctl/set-async-fail", test_sysctl_set_async_fail);
+		g_test_add_func ("/general/sysctl/cache", test_sysctl_cache);
+		g_test_add_func ("/general/sysctl/batch", test_sysctl_batch);
 
 		g_test_add_func ("/link/ethtool/features/get", test_ethtool_features_get);
+
+		g_test_add_func ("/link/nl-event/overflow", test_nl_event_overflow);
 	}
 }
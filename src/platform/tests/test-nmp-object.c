@@ -524,6 +524,56 @@ test_cache_qdisc (void)
 
 /*****************************************************************************/
 
+static void
+test_object_pool (void)
+{
+	NMPObjectPoolStats stats0;
+	NMPObjectPoolStats stats;
+	gs_unref_ptrarray GPtrArray *objs = NULL;
+	const guint N = 5000;
+	guint i_run;
+	guint i;
+
+	if (!nmp_object_pool_get_stats (NMP_OBJECT_TYPE_IP4_ROUTE, &stats0)) {
+		g_test_skip ("object pools are disabled");
+		return;
+	}
+
+	g_assert (!nmp_object_pool_get_stats (NMP_OBJECT_TYPE_LNK_VLAN, &stats));
+
+	objs = g_ptr_array_new_with_free_func ((GDestroyNotify) nmp_object_unref);
+
+	for (i_run = 0; i_run < 3; i_run++) {
+		for (i = 0; i < N; i++) {
+			const NMPlatformIP4Route r = {
+				.ifindex = 1 + (i % 10),
+				.network = htonl (0x0a000000u + i),
+				.plen = 32,
+				.metric = i_run,
+			};
+
+			g_ptr_array_add (objs, nmp_object_new (NMP_OBJECT_TYPE_IP4_ROUTE, &r));
+		}
+
+		nmp_object_pool_get_stats (NMP_OBJECT_TYPE_IP4_ROUTE, &stats);
+		g_assert_cmpint (stats.n_objs, ==, stats0.n_objs + N);
+		g_assert_cmpint (stats.n_slabs, >, stats0.n_slabs);
+		g_assert_cmpint (stats.bytes, <, (gsize) N * 1024u);
+
+		/* free in random order, so that the slabs get fragmented. */
+		while (objs->len > 0)
+			g_ptr_array_remove_index_fast (objs, nmtst_get_rand_uint32 () % objs->len);
+
+		/* all the slabs got returned, except at most one kept in reserve. */
+		nmp_object_pool_get_stats (NMP_OBJECT_TYPE_IP4_ROUTE, &stats);
+		g_assert_cmpint (stats.n_objs, ==, stats0.n_objs);
+		g_assert_cmpint (stats.n_slabs, <=, stats0.n_slabs + 1);
+		g_assert_cmpint (stats.n_allocs - stats0.n_allocs, ==, (guint64) N * (i_run + 1));
+	}
+}
+
+/*****************************************************************************/
+
 NMTST_DEFINE ();
 
 int
@@ -569,6 +619,7 @@ main (int argc, char **argv)
 	g_test_add_func ("/nmp-object/obj-base", test_obj_base);
 	g_test_add_func ("/nmp-object/cache_link", test_cache_link);
 	g_test_add_func ("/nmp-object/cache_qdisc", test_cache_qdisc);
+	g_test_add_func ("/nmp-object/object-pool", test_object_pool);
 
 	result = g_test_run ();
 
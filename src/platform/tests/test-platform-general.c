@@ -62,6 +62,124 @@ test_nm_platform_link_flags2str (void)
 
 /*****************************************************************************/
 
+static guint
+_route_hash (const NMPlatformIP4Route *r)
+{
+	NMHashState h;
+
+	nm_hash_init (&h, 1);
+	nm_platform_ip4_route_hash_update (r, NM_PLATFORM_IP_ROUTE_CMP_TYPE_FULL, &h);
+	return nm_hash_complete (&h);
+}
+
+static void
+test_route_rtax (void)
+{
+	const NMPlatformRouteRtax rtax1 = {
+		.window = 10000,
+		.mtu = 1350,
+		.lock_mtu = TRUE,
+	};
+	NMPlatformRouteRtax rtax2 = rtax1;
+	NMPlatformRouteRtax buf;
+	NMPlatformIP4Route r1 = {
+		.ifindex = 5,
+		.network = nmtst_inet4_from_string ("192.168.5.0"),
+		.plen = 24,
+		.metric = 100,
+	};
+	NMPlatformIP4Route r2 = r1;
+	guint32 id1;
+	guint32 id;
+	guint i;
+
+	g_assert_cmpint (nm_platform_route_rtax_intern (NULL), ==, 0);
+	g_assert_cmpint (nm_platform_route_rtax_intern (&((NMPlatformRouteRtax) { 0 })), ==, 0);
+	g_assert (NM_PLATFORM_IP_ROUTE_RTAX (&r1)->mtu == 0);
+
+	id1 = nm_platform_route_rtax_intern (&rtax1);
+	g_assert_cmpint (id1, !=, 0);
+	g_assert_cmpint (nm_platform_route_rtax_intern (&rtax2), ==, id1);
+
+	rtax2.lock_mtu = FALSE;
+	g_assert_cmpint (nm_platform_route_rtax_intern (&rtax2), !=, id1);
+
+	/* enough distinct blocks to span several chunks. */
+	for (i = 0; i < 1000; i++) {
+		const NMPlatformRouteRtax rtax = { .cwnd = i + 1, .initrwnd = 7, };
+
+		id = nm_platform_route_rtax_intern (&rtax);
+		g_assert_cmpint (nm_platform_route_rtax_get (id, &buf)->cwnd, ==, i + 1);
+		g_assert_cmpint (nm_platform_route_rtax_get (id, &buf)->initrwnd, ==, 7);
+		g_assert_cmpint (nm_platform_route_rtax_intern (&rtax), ==, id);
+	}
+	g_assert_cmpint (nm_platform_route_rtax_intern (&rtax1), ==, id1);
+
+	/* a single metric is encoded in the id. */
+	for (i = 0; i < 5; i++) {
+		NMPlatformRouteRtax rtax = { 0 };
+		const NMPlatformRouteRtax *r;
+
+		switch (i) {
+		case 0: rtax.window = 1;                                    break;
+		case 1: rtax.cwnd = 10; rtax.lock_cwnd = TRUE;              break;
+		case 2: rtax.initcwnd = 0x07FFFFFF;                         break;
+		case 3: rtax.lock_initrwnd = TRUE;                          break;
+		case 4: rtax.mtu = 1280; rtax.lock_mtu = TRUE;              break;
+		}
+
+		id = nm_platform_route_rtax_intern (&rtax);
+		g_assert_cmpint (id, !=, 0);
+		r = nm_platform_route_rtax_get (id, &buf);
+		g_assert (r == &buf);
+		g_assert (memcmp (r, &rtax, sizeof (rtax)) == 0);
+	}
+
+	/* too large for that. */
+	id = nm_platform_route_rtax_intern (&((NMPlatformRouteRtax) { .mtu = 0x08000000 }));
+	g_assert (nm_platform_route_rtax_get (id, &buf) != &buf);
+	g_assert_cmpint (nm_platform_route_rtax_get (id, &buf)->mtu, ==, 0x08000000);
+
+	r1.rtax_id = id1;
+	g_assert (NM_PLATFORM_IP_ROUTE_RTAX (&r1)->window == 10000);
+	g_assert (NM_PLATFORM_IP_ROUTE_RTAX (&r1)->lock_mtu);
+	g_assert_cmpint (nm_platform_ip4_route_cmp (&r1, &r2, NM_PLATFORM_IP_ROUTE_CMP_TYPE_FULL), >, 0);
+	g_assert_cmpint (nm_platform_ip4_route_cmp (&r1, &r2, NM_PLATFORM_IP_ROUTE_CMP_TYPE_ID), !=, 0);
+	g_assert_cmpint (nm_platform_ip4_route_cmp (&r1, &r2, NM_PLATFORM_IP_ROUTE_CMP_TYPE_WEAK_ID), ==, 0);
+
+	r2.rtax_id = nm_platform_route_rtax_intern (&rtax1);
+	g_assert_cmpint (nm_platform_ip4_route_cmp (&r1, &r2, NM_PLATFORM_IP_ROUTE_CMP_TYPE_FULL), ==, 0);
+	g_assert_cmpint (_route_hash (&r1), ==, _route_hash (&r2));
+	g_assert (strstr (nm_platform_ip4_route_to_string (&r1, NULL, 0), " window 10000 "));
+	g_assert (strstr (nm_platform_ip4_route_to_string (&r1, NULL, 0), " mtu lock 1350"));
+
+	r2.rtax_id = nm_platform_route_rtax_intern (&((NMPlatformRouteRtax) { .mtu = 1350 }));
+	g_assert_cmpint (nm_platform_ip4_route_cmp (&r1, &r2, NM_PLATFORM_IP_ROUTE_CMP_TYPE_FULL), !=, 0);
+	g_assert (strstr (nm_platform_ip4_route_to_string (&r2, NULL, 0), " mtu 1350"));
+
+	/* the number of interned blocks is not limited. Many distinct blocks
+	 * span chunks of growing size, and existing blocks are still found. */
+	for (i = 0; i < 0x10000 + 1000; i++) {
+		const NMPlatformRouteRtax rtax = { .window = i + 1, .mtu = 1500, };
+
+		id = nm_platform_route_rtax_intern (&rtax);
+		g_assert_cmpint (id, !=, 0);
+		g_assert_cmpint (nm_platform_route_rtax_get (id, &buf)->window, ==, i + 1);
+		g_assert_cmpint (nm_platform_route_rtax_get (id, &buf)->mtu, ==, 1500);
+	}
+	for (i = 0; i < 0x10000 + 1000; i += 997) {
+		const NMPlatformRouteRtax rtax = { .window = i + 1, .mtu = 1500, };
+
+		id = nm_platform_route_rtax_intern (&rtax);
+		g_assert_cmpint (nm_platform_route_rtax_get (id, &buf)->window, ==, i + 1);
+	}
+	g_assert_cmpint (nm_platform_route_rtax_intern (&rtax1), ==, id1);
+	id = nm_platform_route_rtax_intern (&((NMPlatformRouteRtax) { .window = 1, .cwnd = 1 }));
+	g_assert_cmpint (nm_platform_route_rtax_get (id, &buf)->cwnd, ==, 1);
+}
+
+/*****************************************************************************/
+
 NMTST_DEFINE ();
 
 int
@@ -72,6 +190,7 @@ main (int argc, char **argv)
 	g_test_add_func ("/general/init_linux_platform", test_init_linux_platform);
 	g_test_add_func ("/general/link_get_all", test_link_get_all);
 	g_test_add_func ("/general/nm_platform_link_flags2str", test_nm_platform_link_flags2str);
+	g_test_add_func ("/general/route_rtax", test_route_rtax);
 
 	return g_test_run ();
 }
@@ -11,6 +11,7 @@
 #include "nm-core-utils.h"
 #include "platform/nm-platform-utils.h"
 #include "platform/nmp-rules-manager.h"
+#include "platform/nm-netlink.h"
 
 #include "test-common.h"
 
@@ -306,6 +307,72 @@ test_ip4_route (void)
 	free_signal (route_removed);
 }
 
+static guint
+_ip4_route_count_with_metric (NMPlatform *platform, int ifindex, guint32 metric)
+{
+	gs_unref_ptrarray GPtrArray *routes = NULL;
+	guint n = 0;
+	guint i;
+
+	routes = nmtstp_ip4_route_get_all (platform, ifindex);
+	if (!routes)
+		return 0;
+	for (i = 0; i < routes->len; i++) {
+		if (NMP_OBJECT_CAST_IP4_ROUTE (routes->pdata[i])->metric == metric)
+			n++;
+	}
+	return n;
+}
+
+static void
+test_ip4_route_sync_many (void)
+{
+	const guint N_ROUTES = 2000;
+	const guint32 METRIC = 22987;
+	NMPlatform *platform = NM_PLATFORM_GET;
+	int ifindex = nm_platform_link_get_ifindex (platform, DEVICE_NAME);
+	gs_unref_ptrarray GPtrArray *routes = NULL;
+	guint i;
+
+	routes = g_ptr_array_new_with_free_func ((GDestroyNotify) nmp_object_unref);
+
+	/* a device route to the gateway, which is added before the gateway routes. */
+	g_ptr_array_add (routes,
+	                 nmp_object_new (NMP_OBJECT_TYPE_IP4_ROUTE,
+	                                 &((NMPlatformIP4Route) {
+	                                     .ifindex = ifindex,
+	                                     .network = nmtst_inet4_from_string ("198.51.100.0"),
+	                                     .plen = 24,
+	                                     .metric = METRIC,
+	                                     .rt_source = NM_IP_CONFIG_SOURCE_USER,
+	                                 })));
+
+	for (i = 0; i < N_ROUTES; i++) {
+		g_ptr_array_add (routes,
+		                 nmp_object_new (NMP_OBJECT_TYPE_IP4_ROUTE,
+		                                 &((NMPlatformIP4Route) {
+		                                     .ifindex = ifindex,
+		                                     .network = htonl (0x0a000000u | (i << 8)),
+		                                     .plen = 24,
+		                                     .gateway = i % 2 ? nmtst_inet4_from_string ("198.51.100.1") : 0,
+		                                     .metric = METRIC,
+		                                     .rt_source = NM_IP_CONFIG_SOURCE_USER,
+		                                 })));
+	}
+
+	g_assert_cmpint (_ip4_route_count_with_metric (platform, ifindex, METRIC), ==, 0);
+
+	g_assert (nm_platform_ip_route_sync (platform, AF_INET, ifindex, routes, NULL, NULL));
+	g_assert_cmpint (_ip4_route_count_with_metric (platform, ifindex, METRIC), ==, N_ROUTES + 1);
+
+	/* syncing again must be a no-op. */
+	g_assert (nm_platform_ip_route_sync (platform, AF_INET, ifindex, routes, NULL, NULL));
+	g_assert_cmpint (_ip4_route_count_with_metric (platform, ifindex, METRIC), ==, N_ROUTES + 1);
+
+	g_assert (nm_platform_ip_route_sync (platform, AF_INET, ifindex, NULL, routes, NULL));
+	g_assert_cmpint (_ip4_route_count_with_metric (platform, ifindex, METRIC), ==, 0);
+}
+
 static void
 test_ip6_route (void)
 {
@@ -469,6 +536,425 @@ test_ip4_zero_gateway (void)
 	nmtstp_wait_for_signal (NM_PLATFORM_GET, 50);
 }
 
+static void
+test_ip4_route_cache_scope (void)
+{
+	int ifindex = nm_platform_link_get_ifindex (NM_PLATFORM_GET, DEVICE_NAME);
+	const guint8 ignore_protocols[] = { 186 };
+	guint64 n_ignored;
+
+	g_assert (nm_platform_route_cache_scope_set (NM_PLATFORM_GET,
+	                                             ignore_protocols,
+	                                             G_N_ELEMENTS (ignore_protocols),
+	                                             NULL,
+	                                             0));
+	n_ignored = nm_platform_route_cache_scope_get_n_ignored (NM_PLATFORM_GET);
+
+	nmtstp_run_command_check ("ip route add 1.2.3.1/32 dev %s proto 186", DEVICE_NAME);
+	nmtstp_run_command_check ("ip route add 1.2.3.2/32 dev %s proto static", DEVICE_NAME);
+
+	NMTST_WAIT_ASSERT (100, {
+		nmtstp_wait_for_signal (NM_PLATFORM_GET, 10);
+		if (nmtstp_ip4_route_get (NM_PLATFORM_GET, ifindex, nmtst_inet4_from_string ("1.2.3.2"), 32, 0, 0))
+			break;
+	});
+
+	g_assert (!nmtstp_ip4_route_get (NM_PLATFORM_GET, ifindex, nmtst_inet4_from_string ("1.2.3.1"), 32, 0, 0));
+	g_assert_cmpint (nm_platform_route_cache_scope_get_n_ignored (NM_PLATFORM_GET), >, n_ignored);
+
+	/* an ignored route that replaces a cached one, removes it from the cache. */
+	nmtstp_run_command_check ("ip route replace 1.2.3.2/32 dev %s proto 186", DEVICE_NAME);
+
+	NMTST_WAIT_ASSERT (100, {
+		nmtstp_wait_for_signal (NM_PLATFORM_GET, 10);
+		if (!nmtstp_ip4_route_get (NM_PLATFORM_GET, ifindex, nmtst_inet4_from_string ("1.2.3.2"), 32, 0, 0))
+			break;
+	});
+
+	/* lifting the scope re-dumps the routes. */
+	g_assert (nm_platform_route_cache_scope_set (NM_PLATFORM_GET, NULL, 0, NULL, 0));
+	g_assert (nmtstp_ip4_route_get (NM_PLATFORM_GET, ifindex, nmtst_inet4_from_string ("1.2.3.1"), 32, 0, 0));
+	g_assert (nmtstp_ip4_route_get (NM_PLATFORM_GET, ifindex, nmtst_inet4_from_string ("1.2.3.2"), 32, 0, 0));
+
+	nmtstp_run_command_check ("ip route flush dev %s", DEVICE_NAME);
+
+	nmtstp_wait_for_signal (NM_PLATFORM_GET, 50);
+}
+
+static const NMPlatformIP4Route *
+_ip4_route_get_in_table (int ifindex, const char *network, guint32 table)
+{
+	NMDedupMultiIter iter;
+	NMPLookup lookup;
+	const NMPObject *o;
+
+	nmp_cache_iter_for_each (&iter,
+	                         nm_platform_lookup (NM_PLATFORM_GET,
+	                                             nmp_lookup_init_object (&lookup,
+	                                                                     NMP_OBJECT_TYPE_IP4_ROUTE,
+	                                                                     ifindex)),
+	                         &o) {
+		const NMPlatformIP4Route *r = NMP_OBJECT_CAST_IP4_ROUTE (o);
+
+		if (   r->plen == 32
+		    && r->network == nmtst_inet4_from_string (network)
+		    && nm_platform_route_table_uncoerce (r->table_coerced, TRUE) == table)
+			return r;
+	}
+	return NULL;
+}
+
+static void
+test_ip4_route_refresh_filtered (void)
+{
+	int ifindex = nm_platform_link_get_ifindex (NM_PLATFORM_GET, DEVICE_NAME);
+
+	nmtstp_run_command_check ("ip route add 1.2.3.1/32 dev %s", DEVICE_NAME);
+	nmtstp_run_command_check ("ip route add 1.2.3.2/32 dev %s table 1000", DEVICE_NAME);
+
+	NMTST_WAIT_ASSERT (100, {
+		nmtstp_wait_for_signal (NM_PLATFORM_GET, 10);
+		if (   _ip4_route_get_in_table (ifindex, "1.2.3.1", RT_TABLE_MAIN)
+		    && _ip4_route_get_in_table (ifindex, "1.2.3.2", 1000))
+			break;
+	});
+
+	/* a filtered refresh must neither drop the matching routes, nor
+	 * the routes outside the filter. */
+	nm_platform_refresh_filtered (NM_PLATFORM_GET, NMP_OBJECT_TYPE_IP4_ROUTE, ifindex, 1000);
+	g_assert (_ip4_route_get_in_table (ifindex, "1.2.3.1", RT_TABLE_MAIN));
+	g_assert (_ip4_route_get_in_table (ifindex, "1.2.3.2", 1000));
+
+	nm_platform_refresh_filtered (NM_PLATFORM_GET, NMP_OBJECT_TYPE_IP4_ROUTE, ifindex, 0);
+	g_assert (_ip4_route_get_in_table (ifindex, "1.2.3.1", RT_TABLE_MAIN));
+	g_assert (_ip4_route_get_in_table (ifindex, "1.2.3.2", 1000));
+
+	nmtstp_run_command_check ("ip route flush dev %s", DEVICE_NAME);
+	nmtstp_run_command_check ("ip route flush table 1000");
+
+	nmtstp_wait_for_signal (NM_PLATFORM_GET, 50);
+}
+
+typedef struct {
+	int ifindex;
+	guint version;
+	guint n_routes;
+	gboolean has_snapshot;
+} SnapshotThreadData;
+
+static gpointer
+_snapshot_thread (gpointer user_data)
+{
+	SnapshotThreadData *data = user_data;
+	nm_auto_unref_nmp_cache_snapshot NMPCacheSnapshot *snapshot = NULL;
+	const NMPObject *const*objs;
+	guint len;
+	guint i;
+
+	snapshot = nm_platform_cache_snapshot_get (NM_PLATFORM_GET);
+	data->has_snapshot = !!snapshot;
+	if (!snapshot)
+		return NULL;
+
+	data->version = nmp_cache_snapshot_get_version (snapshot);
+	data->n_routes = 0;
+	objs = nmp_cache_snapshot_get_objects (snapshot, NMP_OBJECT_TYPE_IP4_ROUTE, &len);
+	for (i = 0; i < len; i++) {
+		if (NMP_OBJECT_CAST_IP4_ROUTE (objs[i])->ifindex == data->ifindex)
+			data->n_routes++;
+	}
+	return NULL;
+}
+
+static void
+_snapshot_thread_run (SnapshotThreadData *data)
+{
+	g_thread_join (g_thread_new ("test-snapshot", _snapshot_thread, data));
+}
+
+static void
+test_ip4_route_cache_snapshot (void)
+{
+	SnapshotThreadData data = {
+		.ifindex = nm_platform_link_get_ifindex (NM_PLATFORM_GET, DEVICE_NAME),
+	};
+	nm_auto_unref_nmp_cache_snapshot NMPCacheSnapshot *snapshot = NULL;
+	guint n_routes;
+	guint version;
+
+	/* on the owner thread, the snapshot is always current. */
+	snapshot = nm_platform_cache_snapshot_get (NM_PLATFORM_GET);
+	g_assert (snapshot);
+	version = nmp_cache_snapshot_get_version (snapshot);
+	nmp_cache_snapshot_get_objects (snapshot, NMP_OBJECT_TYPE_IP4_ROUTE, &n_routes);
+	nm_clear_pointer (&snapshot, nmp_cache_snapshot_unref);
+
+	_snapshot_thread_run (&data);
+	g_assert (data.has_snapshot);
+	g_assert_cmpint (data.version, ==, version);
+
+	nmtstp_run_command_check ("ip route add 1.2.6.1/32 dev %s table 1000", DEVICE_NAME);
+	NMTST_WAIT_ASSERT (100, {
+		nmtstp_wait_for_signal (NM_PLATFORM_GET, 10);
+		if (_ip4_route_get_in_table (data.ifindex, "1.2.6.1", 1000))
+			break;
+	});
+
+	/* the other thread still sees the old version, and triggers a refresh. */
+	_snapshot_thread_run (&data);
+	g_assert_cmpint (data.version, ==, version);
+
+	while (g_main_context_iteration (NULL, FALSE)) {
+	}
+
+	_snapshot_thread_run (&data);
+	g_assert_cmpint (data.version, !=, version);
+	g_assert_cmpint (data.n_routes, >=, 1);
+
+	snapshot = nm_platform_cache_snapshot_get (NM_PLATFORM_GET);
+	g_assert_cmpint (nmp_cache_snapshot_get_version (snapshot), ==, data.version);
+
+	nmtstp_run_command_check ("ip route flush table 1000");
+	nmtstp_wait_for_signal (NM_PLATFORM_GET, 50);
+}
+
+typedef struct {
+	int ifindex;
+	guint n_emitted;
+	guint n_added;
+	guint n_objs;
+} ChangeSetTestData;
+
+static void
+_change_set_cb (NMPlatform *platform,
+                const NMPlatformChangeSet *change_set,
+                ChangeSetTestData *data)
+{
+	guint i;
+
+	if (   change_set->obj_type != NMP_OBJECT_TYPE_IP4_ROUTE
+	    || change_set->ifindex != data->ifindex)
+		return;
+
+	g_assert (change_set->objs);
+	g_assert_cmpint (change_set->n_objs, >, 0);
+	for (i = 0; i < change_set->n_objs; i++) {
+		g_assert_cmpint (NMP_OBJECT_GET_TYPE (change_set->objs[i]), ==, NMP_OBJECT_TYPE_IP4_ROUTE);
+		g_assert_cmpint (NMP_OBJECT_CAST_IP4_ROUTE (change_set->objs[i])->ifindex, ==, data->ifindex);
+	}
+
+	data->n_emitted++;
+	data->n_added += change_set->n_added;
+	data->n_objs += change_set->n_objs;
+}
+
+static void
+test_ip4_route_change_set (void)
+{
+	const guint N_ROUTES = 100;
+	ChangeSetTestData data = {
+		.ifindex = nm_platform_link_get_ifindex (NM_PLATFORM_GET, DEVICE_NAME),
+	};
+	nm_auto_free_gstring GString *batch_str = NULL;
+	gs_free char *batch_file = NULL;
+	gs_free_error GError *error = NULL;
+	gulong handler_id;
+	guint i;
+
+	handler_id = g_signal_connect (NM_PLATFORM_GET,
+	                               NM_PLATFORM_SIGNAL_CHANGE_SET,
+	                               G_CALLBACK (_change_set_cb),
+	                               &data);
+
+	batch_str = g_string_new (NULL);
+	for (i = 0; i < N_ROUTES; i++)
+		g_string_append_printf (batch_str, "route add 1.2.5.%u/32 dev %s table 1000\n", i, DEVICE_NAME);
+	batch_file = g_strdup_printf ("/tmp/nm-test-route-change-set-%ld.batch", (long) getpid ());
+	g_assert (g_file_set_contents (batch_file, batch_str->str, batch_str->len, &error));
+	g_assert_no_error (error);
+
+	nmtstp_run_command_check ("ip -batch %s", batch_file);
+	unlink (batch_file);
+
+	NMTST_WAIT_ASSERT (200, {
+		nmtstp_wait_for_signal (NM_PLATFORM_GET, 10);
+		if (data.n_added >= N_ROUTES)
+			break;
+	});
+
+	/* each route was added once, so each one is reported once. */
+	g_assert_cmpint (data.n_added, ==, N_ROUTES);
+	g_assert_cmpint (data.n_objs, ==, N_ROUTES);
+	g_assert_cmpint (data.n_emitted, <=, N_ROUTES);
+	_LOGI (">>> %u route additions reported in %u change sets", data.n_added, data.n_emitted);
+
+	nm_clear_g_signal_handler (NM_PLATFORM_GET, &handler_id);
+
+	nmtstp_run_command_check ("ip route flush table 1000");
+	nmtstp_wait_for_signal (NM_PLATFORM_GET, 50);
+}
+
+static void
+test_ip4_route_netlink_worker (void)
+{
+	int ifindex = nm_platform_link_get_ifindex (NM_PLATFORM_GET, DEVICE_NAME);
+
+	nm_platform_netlink_worker_set (NM_PLATFORM_GET, TRUE);
+
+	/* events are received via the worker. */
+	nmtstp_run_command_check ("ip route add 1.2.4.1/32 dev %s table 1000", DEVICE_NAME);
+	NMTST_WAIT_ASSERT (100, {
+		nmtstp_wait_for_signal (NM_PLATFORM_GET, 10);
+		if (_ip4_route_get_in_table (ifindex, "1.2.4.1", 1000))
+			break;
+	});
+
+	/* requests still wait for their response. */
+	nmtstp_ip4_route_add (NM_PLATFORM_GET, ifindex, NM_IP_CONFIG_SOURCE_USER,
+	                      nmtst_inet4_from_string ("1.2.4.2"), 32, INADDR_ANY, 0, 20, 0);
+	g_assert (_ip4_route_get_in_table (ifindex, "1.2.4.2", RT_TABLE_MAIN));
+
+	/* and so do dumps. */
+	nm_platform_refresh_filtered (NM_PLATFORM_GET, NMP_OBJECT_TYPE_IP4_ROUTE, 0, 0);
+	g_assert (_ip4_route_get_in_table (ifindex, "1.2.4.1", 1000));
+	g_assert (_ip4_route_get_in_table (ifindex, "1.2.4.2", RT_TABLE_MAIN));
+
+	nmtstp_run_command_check ("ip route del 1.2.4.1/32 dev %s table 1000", DEVICE_NAME);
+
+	/* events that the worker already read are not lost, when switching back. */
+	nm_platform_netlink_worker_set (NM_PLATFORM_GET, FALSE);
+	NMTST_WAIT_ASSERT (100, {
+		nmtstp_wait_for_signal (NM_PLATFORM_GET, 10);
+		if (!_ip4_route_get_in_table (ifindex, "1.2.4.1", 1000))
+			break;
+	});
+	g_assert (_ip4_route_get_in_table (ifindex, "1.2.4.2", RT_TABLE_MAIN));
+
+	nmtstp_run_command_check ("ip route flush dev %s", DEVICE_NAME);
+	nmtstp_run_command_check ("ip route flush table 1000");
+
+	nmtstp_wait_for_signal (NM_PLATFORM_GET, 50);
+}
+
+static guint
+_bench_dump_routes (gboolean batched, gint64 *out_time_nsec)
+{
+	struct nl_sock *sk = NULL;
+	nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
+	NLRecvBatch *batch = NULL;
+	const struct rtmsg rtmsg = {
+		.rtm_family = AF_INET,
+	};
+	gint64 start_time;
+	guint n_routes = 0;
+	gboolean done = FALSE;
+
+	sk = nl_socket_alloc ();
+	g_assert_cmpint (nl_connect (sk, NETLINK_ROUTE), ==, 0);
+	nl_socket_disable_msg_peek (sk);
+	g_assert_cmpint (nl_socket_set_msg_buf_size (sk, 32 * 1024), ==, 0);
+	if (batched)
+		batch = nl_recv_batch_new (8);
+
+	nlmsg = nlmsg_alloc_simple (RTM_GETROUTE, NLM_F_DUMP);
+	g_assert_cmpint (nlmsg_append_struct (nlmsg, &rtmsg), >=, 0);
+
+	start_time = nm_utils_get_monotonic_timestamp_nsec ();
+
+	g_assert_cmpint (nl_send_auto (sk, nlmsg), >=, 0);
+
+	while (!done) {
+		nm_auto_free unsigned char *buf_alloc = NULL;
+		unsigned char *buf = NULL;
+		struct sockaddr_nl nla;
+		struct nlmsghdr *hdr;
+		int n;
+
+		if (batched)
+			n = nl_recv_batch_next (sk, batch, &nla, &buf, NULL, NULL);
+		else {
+			n = nl_recv (sk, &nla, &buf_alloc, NULL, NULL);
+			buf = buf_alloc;
+		}
+		g_assert_cmpint (n, >, 0);
+
+		for (hdr = (struct nlmsghdr *) buf; nlmsg_ok (hdr, n); hdr = nlmsg_next (hdr, &n)) {
+			if (hdr->nlmsg_type == NLMSG_DONE) {
+				done = TRUE;
+				break;
+			}
+			g_assert_cmpint (hdr->nlmsg_type, ==, RTM_NEWROUTE);
+			n_routes++;
+		}
+	}
+
+	*out_time_nsec = nm_utils_get_monotonic_timestamp_nsec () - start_time;
+
+	nl_recv_batch_free (batch);
+	nl_socket_free (sk);
+	return n_routes;
+}
+
+static void
+test_ip4_route_dump_many (gconstpointer user_data)
+{
+	const guint N_ROUTES = GPOINTER_TO_UINT (user_data);
+	int ifindex = nm_platform_link_get_ifindex (NM_PLATFORM_GET, DEVICE_NAME);
+	gs_free char *batch_file = NULL;
+	nm_auto_free_gstring GString *batch_str = NULL;
+	gs_free_error GError *error = NULL;
+	gint64 time_single;
+	gint64 time_batched;
+	gint64 time_refresh;
+	guint n_single;
+	guint n_batched;
+	guint i;
+
+	if (N_ROUTES > 1000 && nmtst_test_quick ()) {
+		g_print ("Skipping test: don't run long running test %s (NMTST_DEBUG=slow)\n", g_get_prgname () ?: "test-route-linux");
+		g_test_skip ("Skip long running test");
+		return;
+	}
+
+	batch_str = g_string_new (NULL);
+	for (i = 0; i < N_ROUTES; i++) {
+		g_string_append_printf (batch_str,
+		                        "route add 10.%u.%u.%u/32 dev %s table 2000\n",
+		                        (i >> 16) & 0xFF,
+		                        (i >> 8) & 0xFF,
+		                        i & 0xFF,
+		                        DEVICE_NAME);
+	}
+	batch_file = g_strdup_printf ("/tmp/nm-test-route-dump-many-%ld.batch", (long) getpid ());
+	g_assert (g_file_set_contents (batch_file, batch_str->str, batch_str->len, &error));
+	g_assert_no_error (error);
+
+	nmtstp_run_command_check ("ip -batch %s", batch_file);
+	unlink (batch_file);
+
+	nm_platform_process_events (NM_PLATFORM_GET);
+
+	n_single = _bench_dump_routes (FALSE, &time_single);
+	n_batched = _bench_dump_routes (TRUE, &time_batched);
+	g_assert_cmpint (n_single, >=, N_ROUTES);
+	g_assert_cmpint (n_batched, ==, n_single);
+
+	time_refresh = nm_utils_get_monotonic_timestamp_nsec ();
+	nm_platform_refresh_filtered (NM_PLATFORM_GET, NMP_OBJECT_TYPE_IP4_ROUTE, 0, 0);
+	time_refresh = nm_utils_get_monotonic_timestamp_nsec () - time_refresh;
+
+	g_assert (_ip4_route_get_in_table (ifindex, "10.0.0.0", 2000));
+
+	_LOGI (">>> dump of %u routes: recvmsg() %ld.%06ld s, recvmmsg() %ld.%06ld s, platform refresh %ld.%06ld s",
+	       n_single,
+	       (long) (time_single / NM_UTILS_NSEC_PER_SEC), (long) ((time_single % NM_UTILS_NSEC_PER_SEC) / 1000),
+	       (long) (time_batched / NM_UTILS_NSEC_PER_SEC), (long) ((time_batched % NM_UTILS_NSEC_PER_SEC) / 1000),
+	       (long) (time_refresh / NM_UTILS_NSEC_PER_SEC), (long) ((time_refresh % NM_UTILS_NSEC_PER_SEC) / 1000));
+
+	nmtstp_run_command_check ("ip route flush table 2000");
+	nmtstp_wait_for_signal (NM_PLATFORM_GET, 50);
+}
+
 static void
 test_ip4_route_options (gconstpointer test_data)
 {
@@ -492,12 +978,14 @@ test_ip4_route_options (gconstpointer test_data)
 			.plen = 24,
 			.metric = 20,
 			.tos = 0x28,
-			.window = 10000,
-			.cwnd = 16,
-			.initcwnd = 30,
-			.initrwnd = 50,
-			.mtu = 1350,
-			.lock_cwnd = TRUE,
+			.rtax_id = nm_platform_route_rtax_intern (&((NMPlatformRouteRtax) {
+				.window = 10000,
+				.cwnd = 16,
+				.initcwnd = 30,
+				.initrwnd = 50,
+				.mtu = 1350,
+				.lock_cwnd = TRUE,
+			})),
 		});
 		break;
 	case 2:
@@ -636,12 +1124,14 @@ test_ip6_route_options (gconstpointer test_data)
 			.plen = 64,
 			.gateway = in6addr_any,
 			.metric = 1024,
-			.window = 20000,
-			.cwnd = 8,
-			.initcwnd = 22,
-			.initrwnd = 33,
-			.mtu = 1300,
-			.lock_mtu = TRUE,
+			.rtax_id = nm_platform_route_rtax_intern (&((NMPlatformRouteRtax) {
+				.window = 20000,
+				.cwnd = 8,
+				.initcwnd = 22,
+				.initrwnd = 33,
+				.mtu = 1300,
+				.lock_mtu = TRUE,
+			})),
 		});
 		break;
 	case 2:
@@ -1718,6 +2208,183 @@ again:
 		g_test_skip ("some kernel features were not available and skipped for the test");
 }
 
+static void
+test_rule_sync_dirty (void)
+{
+	NMPlatform *platform = NM_PLATFORM_GET;
+	nm_auto_unref_rules_manager NMPRulesManager *rules_manager = NULL;
+	nm_auto_nmpobj const NMPObject *rule_a = NULL;
+	nm_auto_nmpobj const NMPObject *rule_b = NULL;
+	nm_auto_nmpobj const NMPObject *rule_c = NULL;
+	nm_auto_nmpobj const NMPObject *rule_extern = NULL;
+	gconstpointer USER_TAG_1 = &rules_manager;
+	gconstpointer USER_TAG_2 = &platform;
+	guint n_initial;
+
+	nm_platform_process_events (platform);
+	n_initial = nmtstp_platform_routing_rules_get_count (platform, AF_UNSPEC);
+
+	rule_a = RR (
+		.addr_family = AF_INET,
+		.priority    = 20001,
+		.action      = FR_ACT_TO_TBL,
+		.table       = 10001,
+	);
+	rule_b = RR (
+		.addr_family = AF_INET,
+		.priority    = 20002,
+		.action      = FR_ACT_TO_TBL,
+		.table       = 10002,
+	);
+	rule_c = RR (
+		.addr_family = AF_INET6,
+		.priority    = 20003,
+		.action      = FR_ACT_TO_TBL,
+		.table       = 10003,
+	);
+	rule_extern = RR (
+		.addr_family = AF_INET,
+		.priority    = 20004,
+		.action      = FR_ACT_TO_TBL,
+		.table       = 10004,
+	);
+
+	rules_manager = nmp_rules_manager_new (platform);
+
+	nmp_rules_manager_track (rules_manager, NMP_OBJECT_CAST_ROUTING_RULE (rule_a), 1, USER_TAG_1, NULL);
+	nmp_rules_manager_track (rules_manager, NMP_OBJECT_CAST_ROUTING_RULE (rule_b), 1, USER_TAG_1, NULL);
+	nmp_rules_manager_track (rules_manager, NMP_OBJECT_CAST_ROUTING_RULE (rule_c), 1, USER_TAG_1, NULL);
+	nmp_rules_manager_sync (rules_manager, FALSE);
+	g_assert (_platform_has_routing_rule (platform, rule_a));
+	g_assert (_platform_has_routing_rule (platform, rule_b));
+	g_assert (_platform_has_routing_rule (platform, rule_c));
+	g_assert_cmpint (nmtstp_platform_routing_rules_get_count (platform, AF_UNSPEC), ==, n_initial + 3);
+
+	/* a tracked rule that gets deleted externally becomes dirty. The next
+	 * sync restores it, although nothing was tracked or untracked. */
+	g_assert (nm_platform_object_delete (platform, rule_b));
+	g_assert (!_platform_has_routing_rule (platform, rule_b));
+	nmp_rules_manager_sync (rules_manager, FALSE);
+	g_assert (_platform_has_routing_rule (platform, rule_b));
+
+	/* also when it gets deleted behind our back. */
+	nmtstp_run_command_check ("ip -6 rule del priority 20003");
+	nm_platform_process_events (platform);
+	g_assert (!_platform_has_routing_rule (platform, rule_c));
+	nmp_rules_manager_sync (rules_manager, FALSE);
+	g_assert (_platform_has_routing_rule (platform, rule_c));
+
+	/* untracked rules are left alone. */
+	g_assert_cmpint (nm_platform_routing_rule_add (platform, NMP_NLM_FLAG_ADD, NMP_OBJECT_CAST_ROUTING_RULE (rule_extern)), ==, 0);
+	nmp_rules_manager_sync (rules_manager, FALSE);
+	g_assert (_platform_has_routing_rule (platform, rule_extern));
+
+	/* with keep_deleted_rules, a rule that is still tracked (but should no
+	 * longer be configured) is kept, and removed by a later sync. */
+	nmp_rules_manager_track (rules_manager, NMP_OBJECT_CAST_ROUTING_RULE (rule_a), -1, USER_TAG_2, NULL);
+	nmp_rules_manager_untrack (rules_manager, NMP_OBJECT_CAST_ROUTING_RULE (rule_a), USER_TAG_1);
+	nmp_rules_manager_sync (rules_manager, TRUE);
+	g_assert (_platform_has_routing_rule (platform, rule_a));
+	nmp_rules_manager_sync (rules_manager, FALSE);
+	g_assert (!_platform_has_routing_rule (platform, rule_a));
+
+	/* a rule that is no longer tracked at all is forgotten, and stays. */
+	nmp_rules_manager_untrack (rules_manager, NMP_OBJECT_CAST_ROUTING_RULE (rule_b), USER_TAG_1);
+	nmp_rules_manager_sync (rules_manager, TRUE);
+	g_assert (_platform_has_routing_rule (platform, rule_b));
+	nmp_rules_manager_sync (rules_manager, FALSE);
+	g_assert (_platform_has_routing_rule (platform, rule_b));
+
+	nmp_rules_manager_untrack_all (rules_manager, USER_TAG_1, TRUE);
+	nmp_rules_manager_untrack_all (rules_manager, USER_TAG_2, TRUE);
+	nmp_rules_manager_sync (rules_manager, FALSE);
+	g_assert (!_platform_has_routing_rule (platform, rule_c));
+
+	g_assert (nm_platform_object_delete (platform, rule_b));
+	g_assert (nm_platform_object_delete (platform, rule_extern));
+	g_assert_cmpint (nmtstp_platform_routing_rules_get_count (platform, AF_UNSPEC), ==, n_initial);
+}
+
+/*****************************************************************************/
+
+static struct {
+	void (*routing_rule_add_many) (NMPlatform *self,
+	                               NMPNlmFlags flags,
+	                               const NMPObject *const*objs,
+	                               guint len,
+	                               int *out_results);
+	gboolean fail_add;
+} rule_hooks;
+
+static void
+rule_hooks_routing_rule_add_many (NMPlatform *self,
+                                  NMPNlmFlags flags,
+                                  const NMPObject *const*objs,
+                                  guint len,
+                                  int *out_results)
+{
+	guint i;
+
+	if (rule_hooks.fail_add) {
+		for (i = 0; i < len; i++)
+			out_results[i] = -NME_UNSPEC;
+		return;
+	}
+	rule_hooks.routing_rule_add_many (self, flags, objs, len, out_results);
+}
+
+static void
+rule_hooks_set_fail_add (gboolean fail_add)
+{
+	NMPlatformClass *klass = NM_PLATFORM_GET_CLASS (NM_PLATFORM_GET);
+
+	if (klass->routing_rule_add_many != rule_hooks_routing_rule_add_many) {
+		g_assert (klass->routing_rule_add_many);
+		rule_hooks.routing_rule_add_many = klass->routing_rule_add_many;
+		klass->routing_rule_add_many = rule_hooks_routing_rule_add_many;
+	}
+	rule_hooks.fail_add = fail_add;
+}
+
+static void
+test_rule_sync_failed (void)
+{
+	NMPlatform *platform = NM_PLATFORM_GET;
+	nm_auto_unref_rules_manager NMPRulesManager *rules_manager = NULL;
+	nm_auto_nmpobj const NMPObject *rule_a = NULL;
+	gconstpointer USER_TAG_1 = &rules_manager;
+	guint n_initial;
+
+	nm_platform_process_events (platform);
+	n_initial = nmtstp_platform_routing_rules_get_count (platform, AF_UNSPEC);
+
+	rule_a = RR (
+		.addr_family = AF_INET,
+		.priority    = 20011,
+		.action      = FR_ACT_TO_TBL,
+		.table       = 10011,
+	);
+
+	rules_manager = nmp_rules_manager_new (platform);
+
+	/* a failed add leaves the rule dirty. The next sync retries it, although
+	 * nothing changed in the meantime. */
+	nmp_rules_manager_track (rules_manager, NMP_OBJECT_CAST_ROUTING_RULE (rule_a), 1, USER_TAG_1, NULL);
+	rule_hooks_set_fail_add (TRUE);
+	nmp_rules_manager_sync (rules_manager, FALSE);
+	rule_hooks_set_fail_add (FALSE);
+	g_assert (!_platform_has_routing_rule (platform, rule_a));
+
+	nmp_rules_manager_sync (rules_manager, FALSE);
+	g_assert (_platform_has_routing_rule (platform, rule_a));
+
+	/* the retried rule is ours, and gets removed once it is untracked. */
+	nmp_rules_manager_untrack (rules_manager, NMP_OBJECT_CAST_ROUTING_RULE (rule_a), USER_TAG_1);
+	nmp_rules_manager_sync (rules_manager, FALSE);
+	g_assert (!_platform_has_routing_rule (platform, rule_a));
+	g_assert_cmpint (nmtstp_platform_routing_rules_get_count (platform, AF_UNSPEC), ==, n_initial);
+}
+
 /*****************************************************************************/
 
 NMTstpSetupFunc const _nmtstp_setup_platform_func = SETUP;
@@ -1736,6 +2403,7 @@ _nmtstp_setup_tests (void)
 	add_test_func ("/route/ip4", test_ip4_route);
 	add_test_func ("/route/ip6", test_ip6_route);
 	add_test_func ("/route/ip4_metric0", test_ip4_route_metric0);
+	add_test_func ("/route/ip4_sync_many", test_ip4_route_sync_many);
 	add_test_func_data ("/route/ip4_options/1", test_ip4_route_options, GINT_TO_POINTER (1));
 	if (nmtstp_is_root_test ())
 		add_test_func_data ("/route/ip4_options/2", test_ip4_route_options, GINT_TO_POINTER (2));
@@ -1748,6 +2416,13 @@ _nmtstp_setup_tests (void)
 		add_test_func ("/route/ip4_route_get", test_ip4_route_get);
 		add_test_func ("/route/ip6_route_get", test_ip6_route_get);
 		add_test_func ("/route/ip4_zero_gateway", test_ip4_zero_gateway);
+		add_test_func ("/route/ip4_route_cache_scope", test_ip4_route_cache_scope);
+		add_test_func ("/route/ip4_route_refresh_filtered", test_ip4_route_refresh_filtered);
+		add_test_func ("/route/ip4_route_netlink_worker", test_ip4_route_netlink_worker);
+		add_test_func ("/route/ip4_route_change_set", test_ip4_route_change_set);
+		add_test_func ("/route/ip4_route_cache_snapshot", test_ip4_route_cache_snapshot);
+		add_test_func_data ("/route/ip4_route_dump_many/1000", test_ip4_route_dump_many, GUINT_TO_POINTER (1000));
+		add_test_func_data ("/route/ip4_route_dump_many/100000", test_ip4_route_dump_many, GUINT_TO_POINTER (100000));
 	}
 
 	if (nmtstp_is_root_test ()) {
@@ -1755,5 +2430,7 @@ _nmtstp_setup_tests (void)
 		add_test_func_data ("/route/rule/2", test_rule, GINT_TO_POINTER (2));
 		add_test_func_data ("/route/rule/3", test_rule, GINT_TO_POINTER (3));
 		add_test_func_data ("/route/rule/4", test_rule, GINT_TO_POINTER (4));
+		add_test_func ("/route/rule/sync-dirty", test_rule_sync_dirty);
+		add_test_func ("/route/rule/sync-failed", test_rule_sync_failed);
 	}
 }
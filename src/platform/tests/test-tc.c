@@ -3,6 +3,7 @@
 #include "nm-default.h"
 
 #include <linux/pkt_sched.h>
+#include <linux/if_ether.h>
 
 #include "nm-test-utils-core.h"
 #include "platform/nmp-object.h"
@@ -37,6 +38,120 @@ qdiscs_lookup (int ifindex)
 	                                 NULL, NULL);
 }
 
+static NMPObject *
+tfilter_new_simple (int ifindex, guint32 parent, guint32 handle, const char *sdata)
+{
+	NMPObject *obj;
+
+	obj = nmp_object_new (NMP_OBJECT_TYPE_TFILTER, NULL);
+	obj->tfilter = (NMPlatformTfilter) {
+		.ifindex = ifindex,
+		.kind = "matchall",
+		.addr_family = AF_UNSPEC,
+		.handle = handle,
+		.parent = parent,
+		.info = TC_H_MAKE (0, htons (ETH_P_ALL)),
+		.action = {
+			.kind = NM_PLATFORM_ACTION_KIND_SIMPLE,
+		},
+	};
+	g_strlcpy (obj->tfilter.action.simple.sdata, sdata, sizeof (obj->tfilter.action.simple.sdata));
+
+	return obj;
+}
+
+static const NMPlatformTfilter *
+tfilter_find (int ifindex, guint32 parent)
+{
+	gs_unref_ptrarray GPtrArray *plat = NULL;
+	NMPLookup lookup;
+	const NMPlatformTfilter *found = NULL;
+	guint i;
+
+	plat = nm_platform_lookup_clone (NM_PLATFORM_GET,
+	                                 nmp_lookup_init_object (&lookup,
+	                                                         NMP_OBJECT_TYPE_TFILTER,
+	                                                         ifindex),
+	                                 NULL, NULL);
+	if (!plat)
+		return NULL;
+
+	for (i = 0; i < plat->len; i++) {
+		const NMPObject *obj = plat->pdata[i];
+
+		if (obj->tfilter.parent != parent)
+			continue;
+		g_assert (!found);
+		/* the cache keeps a reference to the object. */
+		found = NMP_OBJECT_CAST_TFILTER (obj);
+	}
+	return found;
+}
+
+/* The sync functions send their requests via the object_delete_many() and
+ * tc_add_many() hooks of the platform. Wrap them, to count the qdiscs and
+ * filters that get deleted and added (or replaced). */
+static struct {
+	void (*object_delete_many) (NMPlatform *self,
+	                            const NMPObject *const*objs,
+	                            guint len,
+	                            gboolean *out_results);
+	void (*tc_add_many) (NMPlatform *self,
+	                     NMPNlmFlags flags,
+	                     const NMPObject *const*objs,
+	                     guint len,
+	                     int *out_results);
+	guint n_deleted;
+	guint n_added;
+} tc_hooks;
+
+static void
+tc_hooks_object_delete_many (NMPlatform *self,
+                             const NMPObject *const*objs,
+                             guint len,
+                             gboolean *out_results)
+{
+	guint i;
+
+	for (i = 0; i < len; i++) {
+		if (NM_IN_SET (NMP_OBJECT_GET_TYPE (objs[i]), NMP_OBJECT_TYPE_QDISC,
+		                                              NMP_OBJECT_TYPE_TFILTER))
+			tc_hooks.n_deleted++;
+	}
+	tc_hooks.object_delete_many (self, objs, len, out_results);
+}
+
+static void
+tc_hooks_tc_add_many (NMPlatform *self,
+                      NMPNlmFlags flags,
+                      const NMPObject *const*objs,
+                      guint len,
+                      int *out_results)
+{
+	tc_hooks.n_added += len;
+	tc_hooks.tc_add_many (self, flags, objs, len, out_results);
+}
+
+static void
+tc_sync_stats_diff (guint *n_deleted, guint *n_added)
+{
+	NMPlatformClass *klass = NM_PLATFORM_GET_CLASS (NM_PLATFORM_GET);
+
+	if (klass->tc_add_many != tc_hooks_tc_add_many) {
+		g_assert (klass->object_delete_many);
+		g_assert (klass->tc_add_many);
+		tc_hooks.object_delete_many = klass->object_delete_many;
+		tc_hooks.tc_add_many = klass->tc_add_many;
+		klass->object_delete_many = tc_hooks_object_delete_many;
+		klass->tc_add_many = tc_hooks_tc_add_many;
+	}
+
+	*n_deleted = tc_hooks.n_deleted;
+	*n_added = tc_hooks.n_added;
+	tc_hooks.n_deleted = 0;
+	tc_hooks.n_added = 0;
+}
+
 static void
 test_qdisc1 (void)
 {
@@ -201,6 +316,158 @@ test_qdisc_tbf (void)
 	g_assert_cmpint (qdisc->handle, ==, TC_H_MAKE (0x8005 << 16, 0));
 }
 
+static void
+test_qdisc_sync (void)
+{
+	int ifindex;
+	gs_unref_ptrarray GPtrArray *known = NULL;
+	gs_unref_ptrarray GPtrArray *plat = NULL;
+	NMPObject *obj;
+	NMPlatformQdisc *qdisc;
+	guint n_deleted;
+	guint n_added;
+
+	ifindex = nm_platform_link_get_ifindex (NM_PLATFORM_GET, DEVICE_NAME);
+	g_assert_cmpint (ifindex, >, 0);
+
+	nmtstp_run_command ("tc qdisc del dev %s root", DEVICE_NAME);
+
+	nmtstp_wait_for_signal (NM_PLATFORM_GET, 0);
+
+	known = g_ptr_array_new_with_free_func ((GDestroyNotify) nmp_object_unref);
+	obj = qdisc_new (ifindex, "tbf", TC_H_ROOT);
+	obj->qdisc.handle = TC_H_MAKE (0x8143 << 16, 0);
+	obj->qdisc.tbf.rate = 1000000;
+	obj->qdisc.tbf.burst = 2000;
+	obj->qdisc.tbf.limit = 3000;
+	g_ptr_array_add (known, obj);
+
+	obj = qdisc_new (ifindex, "sfq", TC_H_MAKE (0x8143 << 16, 0));
+	obj->qdisc.handle = TC_H_MAKE (0x8005 << 16, 0);
+	g_ptr_array_add (known, obj);
+
+	tc_sync_stats_diff (&n_deleted, &n_added);
+
+	g_assert (nm_platform_qdisc_sync (NM_PLATFORM_GET, ifindex, known));
+	tc_sync_stats_diff (&n_deleted, &n_added);
+	g_assert_cmpint (n_added, ==, 2);
+
+	/* syncing again changes nothing. */
+	g_assert (nm_platform_qdisc_sync (NM_PLATFORM_GET, ifindex, known));
+	tc_sync_stats_diff (&n_deleted, &n_added);
+	g_assert_cmpint (n_deleted, ==, 0);
+	g_assert_cmpint (n_added, ==, 0);
+
+	/* the root is replaced in place, and kernel drops its child, which
+	 * gets added again. */
+	NMP_OBJECT_CAST_QDISC (known->pdata[0])->tbf.rate = 2000000;
+	g_assert (nm_platform_qdisc_sync (NM_PLATFORM_GET, ifindex, known));
+	tc_sync_stats_diff (&n_deleted, &n_added);
+	g_assert_cmpint (n_deleted, ==, 0);
+	g_assert_cmpint (n_added, ==, 2);
+
+	plat = qdiscs_lookup (ifindex);
+	g_assert (plat);
+	g_assert_cmpint (plat->len, ==, 2);
+
+	qdisc = NMP_OBJECT_CAST_QDISC (plat->pdata[0]);
+	g_assert_cmpstr (qdisc->kind, ==, "tbf");
+	g_assert_cmpint (qdisc->handle, ==, TC_H_MAKE (0x8143 << 16, 0));
+	g_assert_cmpint (qdisc->tbf.rate, ==, 2000000);
+
+	qdisc = NMP_OBJECT_CAST_QDISC (plat->pdata[1]);
+	g_assert_cmpstr (qdisc->kind, ==, "sfq");
+	g_assert_cmpint (qdisc->parent, ==, TC_H_MAKE (0x8143 << 16, 0));
+	g_assert_cmpint (qdisc->handle, ==, TC_H_MAKE (0x8005 << 16, 0));
+}
+
+static void
+test_tfilter_sync (void)
+{
+	int ifindex;
+	gs_unref_ptrarray GPtrArray *known_qdiscs = NULL;
+	gs_unref_ptrarray GPtrArray *known = NULL;
+	const NMPlatformTfilter *tfilter;
+	NMPObject *obj;
+	guint n_deleted;
+	guint n_added;
+
+	ifindex = nm_platform_link_get_ifindex (NM_PLATFORM_GET, DEVICE_NAME);
+	g_assert_cmpint (ifindex, >, 0);
+
+	nmtstp_run_command ("tc qdisc del dev %s root", DEVICE_NAME);
+	nmtstp_run_command ("tc qdisc del dev %s ingress", DEVICE_NAME);
+
+	nmtstp_wait_for_signal (NM_PLATFORM_GET, 0);
+
+	known_qdiscs = g_ptr_array_new_with_free_func ((GDestroyNotify) nmp_object_unref);
+	obj = qdisc_new (ifindex, "sfq", TC_H_ROOT);
+	obj->qdisc.handle = TC_H_MAKE (0x1 << 16, 0);
+	g_ptr_array_add (known_qdiscs, obj);
+	obj = qdisc_new (ifindex, "ingress", TC_H_INGRESS);
+	obj->qdisc.handle = TC_H_MAKE (TC_H_INGRESS, 0);
+	g_ptr_array_add (known_qdiscs, obj);
+	g_assert (nm_platform_qdisc_sync (NM_PLATFORM_GET, ifindex, known_qdiscs));
+
+	/* two filters with the same handle, on different parents. */
+	known = g_ptr_array_new_with_free_func ((GDestroyNotify) nmp_object_unref);
+	g_ptr_array_add (known, tfilter_new_simple (ifindex, TC_H_MAKE (0x1 << 16, 0), 1, "a"));
+	g_ptr_array_add (known, tfilter_new_simple (ifindex, TC_H_MAKE (TC_H_INGRESS, 0), 1, "b"));
+
+	tc_sync_stats_diff (&n_deleted, &n_added);
+
+	g_assert (nm_platform_tfilter_sync (NM_PLATFORM_GET, ifindex, known));
+	tc_sync_stats_diff (&n_deleted, &n_added);
+	g_assert_cmpint (n_deleted, ==, 0);
+	g_assert_cmpint (n_added, ==, 2);
+
+	tfilter = tfilter_find (ifindex, TC_H_MAKE (0x1 << 16, 0));
+	g_assert (tfilter);
+	g_assert_cmpint (tfilter->handle, ==, 1);
+	g_assert_cmpstr (tfilter->action.kind, ==, NM_PLATFORM_ACTION_KIND_SIMPLE);
+	g_assert_cmpstr (tfilter->action.simple.sdata, ==, "a");
+
+	tfilter = tfilter_find (ifindex, TC_H_MAKE (TC_H_INGRESS, 0));
+	g_assert (tfilter);
+	g_assert_cmpint (tfilter->handle, ==, 1);
+	g_assert_cmpstr (tfilter->action.kind, ==, NM_PLATFORM_ACTION_KIND_SIMPLE);
+	g_assert_cmpstr (tfilter->action.simple.sdata, ==, "b");
+
+	/* syncing again changes nothing. */
+	g_assert (nm_platform_tfilter_sync (NM_PLATFORM_GET, ifindex, known));
+	tc_sync_stats_diff (&n_deleted, &n_added);
+	g_assert_cmpint (n_deleted, ==, 0);
+	g_assert_cmpint (n_added, ==, 0);
+
+	/* a changed action is replaced in place. */
+	obj = known->pdata[1];
+	g_strlcpy (obj->tfilter.action.simple.sdata, "c", sizeof (obj->tfilter.action.simple.sdata));
+	g_assert (nm_platform_tfilter_sync (NM_PLATFORM_GET, ifindex, known));
+	tc_sync_stats_diff (&n_deleted, &n_added);
+	g_assert_cmpint (n_deleted, ==, 0);
+	g_assert_cmpint (n_added, ==, 1);
+
+	tfilter = tfilter_find (ifindex, TC_H_MAKE (0x1 << 16, 0));
+	g_assert (tfilter);
+	g_assert_cmpstr (tfilter->action.simple.sdata, ==, "a");
+
+	tfilter = tfilter_find (ifindex, TC_H_MAKE (TC_H_INGRESS, 0));
+	g_assert (tfilter);
+	g_assert_cmpint (tfilter->handle, ==, 1);
+	g_assert_cmpstr (tfilter->action.simple.sdata, ==, "c");
+
+	/* filters that are not configured get removed. */
+	g_ptr_array_set_size (known, 1);
+	g_assert (nm_platform_tfilter_sync (NM_PLATFORM_GET, ifindex, known));
+	tc_sync_stats_diff (&n_deleted, &n_added);
+	g_assert_cmpint (n_deleted, ==, 1);
+	g_assert_cmpint (n_added, ==, 0);
+	g_assert (tfilter_find (ifindex, TC_H_MAKE (0x1 << 16, 0)));
+	g_assert (!tfilter_find (ifindex, TC_H_MAKE (TC_H_INGRESS, 0)));
+
+	nmtstp_run_command ("tc qdisc del dev %s ingress", DEVICE_NAME);
+}
+
 /*****************************************************************************/
 
 NMTstpSetupFunc const _nmtstp_setup_platform_func = SETUP;
@@ -219,5 +486,7 @@ _nmtstp_setup_tests (void)
 		nmtstp_env1_add_test_func ("/link/qdisc/fq_codel", test_qdisc_fq_codel, TRUE);
 		nmtstp_env1_add_test_func ("/link/qdisc/sfq", test_qdisc_sfq, TRUE);
 		nmtstp_env1_add_test_func ("/link/qdisc/tbf", test_qdisc_tbf, TRUE);
+		nmtstp_env1_add_test_func ("/link/qdisc/sync", test_qdisc_sync, TRUE);
+		nmtstp_env1_add_test_func ("/link/tfilter/sync", test_tfilter_sync, TRUE);
 	}
 }
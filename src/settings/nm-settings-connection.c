@@ -23,6 +23,7 @@
 #include "nm-core-internal.h"
 #include "nm-audit-manager.h"
 #include "nm-settings.h"
+#include "nm-settings-utils.h"
 #include "nm-dbus-manager.h"
 #include "settings/plugins/keyfile/nms-keyfile-storage.h"
 
@@ -67,6 +68,7 @@ NM_GOBJECT_PROPERTIES_DEFINE (NMSettingsConnection,
 enum {
 	UPDATED_INTERNAL,
 	FLAGS_CHANGED,
+	TIMESTAMP_CHANGED,
 	LAST_SIGNAL
 };
 
@@ -2209,15 +2211,16 @@ nm_settings_connection_update_timestamp (NMSettingsConnection *self,
 	_LOGT ("timestamp: set timestamp %"G_GUINT64_FORMAT,
 	       timestamp);
 
-	if (!priv->kf_db_timestamps)
-		return;
-
-	connection_uuid = nm_settings_connection_get_uuid (self);
-	if (connection_uuid) {
-		nm_key_file_db_set_value (priv->kf_db_timestamps,
-		                          connection_uuid,
-		                          nm_sprintf_buf (sbuf, "%" G_GUINT64_FORMAT, timestamp));
+	if (priv->kf_db_timestamps) {
+		connection_uuid = nm_settings_connection_get_uuid (self);
+		if (connection_uuid) {
+			nm_key_file_db_set_value (priv->kf_db_timestamps,
+			                          connection_uuid,
+			                          nm_sprintf_buf (sbuf, "%" G_GUINT64_FORMAT, timestamp));
+		}
 	}
+
+	g_signal_emit (self, signals[TIMESTAMP_CHANGED], 0);
 }
 
 void
@@ -2589,6 +2592,7 @@ nm_settings_connection_init (NMSettingsConnection *self)
 	self->_priv = priv;
 
 	c_list_init (&self->_connections_lst);
+	self->_connections_sorted_idx = NM_SETT_UTIL_SORTED_ARRAY_IDX_NONE;
 
 	c_list_init (&priv->call_ids_lst_head);
 	c_list_init (&priv->auth_lst_head);
@@ -2617,6 +2621,7 @@ dispose (GObject *object)
 	nm_assert (!priv->default_wired_device);
 
 	nm_assert (c_list_is_empty (&self->_connections_lst));
+	nm_assert (self->_connections_sorted_idx == NM_SETT_UTIL_SORTED_ARRAY_IDX_NONE);
 	nm_assert (c_list_is_empty (&priv->auth_lst_head));
 
 	/* Cancel in-progress secrets requests */
@@ -2797,4 +2802,14 @@ nm_settings_connection_class_init (NMSettingsConnectionClass *klass)
 	                  0, NULL, NULL,
 	                  g_cclosure_marshal_VOID__VOID,
 	                  G_TYPE_NONE, 0);
+
+	/* internal signal, emitted when nm_settings_connection_update_timestamp()
+	 * changes the timestamp. */
+	signals[TIMESTAMP_CHANGED] =
+	    g_signal_new (NM_SETTINGS_CONNECTION_TIMESTAMP_CHANGED,
+	                  G_TYPE_FROM_CLASS (klass),
+	                  G_SIGNAL_RUN_FIRST,
+	                  0, NULL, NULL,
+	                  g_cclosure_marshal_VOID__VOID,
+	                  G_TYPE_NONE, 0);
 }
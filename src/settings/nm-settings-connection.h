@@ -128,6 +128,7 @@ typedef enum {
 #define NM_SETTINGS_CONNECTION_CANCEL_SECRETS "cancel-secrets"
 #define NM_SETTINGS_CONNECTION_UPDATED_INTERNAL "updated-internal"
 #define NM_SETTINGS_CONNECTION_FLAGS_CHANGED    "flags-changed"
+#define NM_SETTINGS_CONNECTION_TIMESTAMP_CHANGED "timestamp-changed"
 
 /* Properties */
 #define NM_SETTINGS_CONNECTION_UNSAVED  "unsaved"
@@ -206,6 +207,8 @@ struct _NMSettingsConnectionPrivate;
 struct _NMSettingsConnection {
 	NMDBusObject parent;
 	CList _connections_lst;
+	/* the position in NMSettings' list of profiles sorted by autoconnect priority. */
+	guint _connections_sorted_idx;
 	struct _NMSettingsConnectionPrivate *_priv;
 };
 
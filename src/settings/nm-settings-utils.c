@@ -12,7 +12,9 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include "nm-core-internal.h"
 #include "nm-settings-plugin.h"
+#include "nm-settings.h"
 
 /*****************************************************************************/
 
@@ -159,3 +161,421 @@ nm_sett_util_storages_steal (NMSettUtilStorages *storages,
 
 	return storage;
 }
+
+/*****************************************************************************/
+
+typedef struct {
+	const char *key;
+	CList entries_lst_head;
+	char _key[];
+} AutoconnectIdxBucket;
+
+typedef struct {
+	gconstpointer user_data;
+	AutoconnectIdxBucket *bucket;
+	GHashTable *buckets;
+	CList bucket_lst;
+
+	/* the properties of the profile that restrict the devices it can
+	 * be compatible with. See NMSettingsAutoconnectLookup. */
+	char *type;
+	char *ifname;
+	char *hwaddr;
+	char *parent;
+	guint32 vlan_id;
+	bool vlan_id_has:1;
+} AutoconnectIdxEntry;
+
+struct _NMSettUtilAutoconnectIdx {
+	/* Profiles that pin an interface name are in @by_ifname. VLAN profiles
+	 * with a parent given by interface name are in @by_vlan, keyed by
+	 * VLAN id and parent. All others are in @by_type. */
+	GHashTable *by_user_data;
+	GHashTable *by_ifname;
+	GHashTable *by_vlan;
+	GHashTable *by_type;
+};
+
+static void
+_autoconnect_idx_bucket_free (AutoconnectIdxBucket *bucket)
+{
+	nm_assert (c_list_is_empty (&bucket->entries_lst_head));
+
+	g_free (bucket);
+}
+
+static void
+_autoconnect_idx_entry_free (AutoconnectIdxEntry *entry)
+{
+	AutoconnectIdxBucket *bucket = entry->bucket;
+
+	c_list_unlink_stale (&entry->bucket_lst);
+	if (c_list_is_empty (&bucket->entries_lst_head)) {
+		if (!g_hash_table_remove (entry->buckets, bucket))
+			nm_assert_not_reached ();
+	}
+
+	g_free (entry->type);
+	g_free (entry->ifname);
+	g_free (entry->hwaddr);
+	g_free (entry->parent);
+	g_slice_free (AutoconnectIdxEntry, entry);
+}
+
+static char *
+_autoconnect_idx_vlan_key (guint32 vlan_id, const char *parent)
+{
+	return g_strdup_printf ("%u/%s", (guint) vlan_id, parent);
+}
+
+NMSettUtilAutoconnectIdx *
+nm_sett_util_autoconnect_idx_new (void)
+{
+	NMSettUtilAutoconnectIdx *idx;
+
+	idx = g_slice_new (NMSettUtilAutoconnectIdx);
+	*idx = (NMSettUtilAutoconnectIdx) {
+		.by_user_data = g_hash_table_new_full (nm_direct_hash, NULL,
+		                                       NULL, (GDestroyNotify) _autoconnect_idx_entry_free),
+		.by_ifname    = g_hash_table_new_full (nm_pstr_hash, nm_pstr_equal,
+		                                       NULL, (GDestroyNotify) _autoconnect_idx_bucket_free),
+		.by_vlan      = g_hash_table_new_full (nm_pstr_hash, nm_pstr_equal,
+		                                       NULL, (GDestroyNotify) _autoconnect_idx_bucket_free),
+		.by_type      = g_hash_table_new_full (nm_pstr_hash, nm_pstr_equal,
+		                                       NULL, (GDestroyNotify) _autoconnect_idx_bucket_free),
+	};
+	return idx;
+}
+
+void
+nm_sett_util_autoconnect_idx_free (NMSettUtilAutoconnectIdx *idx)
+{
+	if (!idx)
+		return;
+
+	/* the entries remove their buckets. */
+	g_hash_table_destroy (idx->by_user_data);
+	nm_assert (g_hash_table_size (idx->by_ifname) == 0);
+	nm_assert (g_hash_table_size (idx->by_vlan) == 0);
+	nm_assert (g_hash_table_size (idx->by_type) == 0);
+	g_hash_table_destroy (idx->by_ifname);
+	g_hash_table_destroy (idx->by_vlan);
+	g_hash_table_destroy (idx->by_type);
+	g_slice_free (NMSettUtilAutoconnectIdx, idx);
+}
+
+void
+nm_sett_util_autoconnect_idx_remove (NMSettUtilAutoconnectIdx *idx,
+                                     gconstpointer user_data)
+{
+	g_hash_table_remove (idx->by_user_data, user_data);
+}
+
+/**
+ * nm_sett_util_autoconnect_idx_update:
+ * @idx: the index
+ * @user_data: identifies the profile. This is what
+ *   nm_sett_util_autoconnect_idx_collect() returns.
+ * @connection: the current content of the profile
+ *
+ * Adds the profile to the index, or updates it after @connection changed.
+ */
+void
+nm_sett_util_autoconnect_idx_update (NMSettUtilAutoconnectIdx *idx,
+                                     gconstpointer user_data,
+                                     NMConnection *connection)
+{
+	AutoconnectIdxEntry *entry;
+	AutoconnectIdxBucket *bucket;
+	gs_free char *key_free = NULL;
+	const char *type;
+	const char *key;
+
+	nm_sett_util_autoconnect_idx_remove (idx, user_data);
+
+	type = nm_connection_get_connection_type (connection);
+
+	entry = g_slice_new0 (AutoconnectIdxEntry);
+	entry->user_data = user_data;
+	entry->type = g_strdup (type);
+	entry->ifname = g_strdup (nm_connection_get_interface_name (connection));
+
+	if (nm_streq0 (type, NM_SETTING_WIRED_SETTING_NAME)) {
+		NMSettingWired *s_wired = nm_connection_get_setting_wired (connection);
+		const char *const*subchans;
+
+		/* with s390 subchannels, the MAC address is not checked. */
+		subchans = s_wired ? nm_setting_wired_get_s390_subchannels (s_wired) : NULL;
+		if (   s_wired
+		    && (!subchans || !subchans[0]))
+			entry->hwaddr = g_strdup (nm_setting_wired_get_mac_address (s_wired));
+	} else if (nm_streq0 (type, NM_SETTING_VLAN_SETTING_NAME)) {
+		NMSettingVlan *s_vlan = nm_connection_get_setting_vlan (connection);
+		const char *parent;
+
+		if (s_vlan) {
+			entry->vlan_id = nm_setting_vlan_get_id (s_vlan);
+			entry->vlan_id_has = TRUE;
+
+			/* a parent given as UUID matches depending on the active profile
+			 * of the parent device. Only index interface names. */
+			parent = nm_setting_vlan_get_parent (s_vlan);
+			if (   parent
+			    && !nm_utils_is_uuid (parent))
+				entry->parent = g_strdup (parent);
+		}
+	}
+
+	if (entry->ifname) {
+		entry->buckets = idx->by_ifname;
+		key = entry->ifname;
+	} else if (   entry->vlan_id_has
+	           && entry->parent) {
+		entry->buckets = idx->by_vlan;
+		key = (key_free = _autoconnect_idx_vlan_key (entry->vlan_id, entry->parent));
+	} else {
+		entry->buckets = idx->by_type;
+		key = entry->type ?: "";
+	}
+
+	bucket = g_hash_table_lookup (entry->buckets, &key);
+	if (!bucket) {
+		gsize l_p_1 = strlen (key) + 1;
+
+		bucket = g_malloc (sizeof (AutoconnectIdxBucket) + l_p_1);
+		bucket->key = bucket->_key;
+		c_list_init (&bucket->entries_lst_head);
+		memcpy (bucket->_key, key, l_p_1);
+		g_hash_table_add (entry->buckets, bucket);
+	}
+	entry->bucket = bucket;
+	c_list_link_tail (&bucket->entries_lst_head, &entry->bucket_lst);
+
+	g_hash_table_insert (idx->by_user_data, (gpointer) user_data, entry);
+}
+
+static gboolean
+_autoconnect_idx_entry_matches (const AutoconnectIdxEntry *entry,
+                                const NMSettingsAutoconnectLookup *lookup)
+{
+	if (lookup->type) {
+		if (!nm_streq0 (entry->type, lookup->type))
+			return FALSE;
+	} else if (lookup->types) {
+		if (   !entry->type
+		    || nm_utils_strv_find_first ((char **) lookup->types, -1, entry->type) < 0)
+			return FALSE;
+	}
+
+	if (   entry->ifname
+	    && !nm_streq0 (entry->ifname, lookup->ifname))
+		return FALSE;
+
+	if (   entry->hwaddr
+	    && lookup->hwaddr
+	    && !nm_utils_hwaddr_matches (entry->hwaddr, -1, lookup->hwaddr, -1))
+		return FALSE;
+
+	if (   entry->parent
+	    && lookup->parent
+	    && !nm_streq (entry->parent, lookup->parent))
+		return FALSE;
+
+	if (   entry->vlan_id_has
+	    && lookup->vlan_id_has
+	    && entry->vlan_id != lookup->vlan_id)
+		return FALSE;
+
+	return TRUE;
+}
+
+static void
+_autoconnect_idx_bucket_collect (AutoconnectIdxBucket *bucket,
+                                 const NMSettingsAutoconnectLookup *lookup,
+                                 GPtrArray *result)
+{
+	AutoconnectIdxEntry *entry;
+
+	if (!bucket)
+		return;
+
+	c_list_for_each_entry (entry, &bucket->entries_lst_head, bucket_lst) {
+		if (_autoconnect_idx_entry_matches (entry, lookup))
+			g_ptr_array_add (result, (gpointer) entry->user_data);
+	}
+}
+
+static void
+_autoconnect_idx_buckets_collect_all (GHashTable *buckets,
+                                      const NMSettingsAutoconnectLookup *lookup,
+                                      GPtrArray *result)
+{
+	GHashTableIter iter;
+	AutoconnectIdxBucket *bucket;
+
+	g_hash_table_iter_init (&iter, buckets);
+	while (g_hash_table_iter_next (&iter, (gpointer *) &bucket, NULL))
+		_autoconnect_idx_bucket_collect (bucket, lookup, result);
+}
+
+/**
+ * nm_sett_util_autoconnect_idx_collect:
+ * @idx: the index
+ * @lookup: the properties of the device
+ * @result: the array to which the user data of the candidates get appended
+ *
+ * Appends the profiles that could be compatible with a device described
+ * by @lookup, in no particular order.
+ */
+void
+nm_sett_util_autoconnect_idx_collect (NMSettUtilAutoconnectIdx *idx,
+                                      const NMSettingsAutoconnectLookup *lookup,
+                                      GPtrArray *result)
+{
+	gboolean collect_vlan;
+	guint i;
+
+	if (lookup->ifname) {
+		_autoconnect_idx_bucket_collect (g_hash_table_lookup (idx->by_ifname, &lookup->ifname),
+		                                 lookup,
+		                                 result);
+	}
+
+	if (lookup->type) {
+		_autoconnect_idx_bucket_collect (g_hash_table_lookup (idx->by_type, &lookup->type),
+		                                 lookup,
+		                                 result);
+		collect_vlan = nm_streq (lookup->type, NM_SETTING_VLAN_SETTING_NAME);
+	} else if (lookup->types) {
+		for (i = 0; lookup->types[i]; i++) {
+			_autoconnect_idx_bucket_collect (g_hash_table_lookup (idx->by_type, &lookup->types[i]),
+			                                 lookup,
+			                                 result);
+		}
+		collect_vlan = nm_utils_strv_find_first ((char **) lookup->types, -1, NM_SETTING_VLAN_SETTING_NAME) >= 0;
+	} else {
+		_autoconnect_idx_buckets_collect_all (idx->by_type, lookup, result);
+		collect_vlan = TRUE;
+	}
+
+	if (!collect_vlan) {
+		/* @by_vlan only has VLAN profiles. */
+		return;
+	}
+
+	if (   lookup->vlan_id_has
+	    && lookup->parent) {
+		gs_free char *key = _autoconnect_idx_vlan_key (lookup->vlan_id, lookup->parent);
+		const char *key_p = key;
+
+		_autoconnect_idx_bucket_collect (g_hash_table_lookup (idx->by_vlan, &key_p),
+		                                 lookup,
+		                                 result);
+	} else
+		_autoconnect_idx_buckets_collect_all (idx->by_vlan, lookup, result);
+}
+
+/*****************************************************************************/
+
+#define _SORTED_ARRAY_IDX(elem, idx_offset) (*((guint *) (((char *) (elem)) + (idx_offset))))
+
+static void
+_sorted_array_set_idx (GPtrArray *arr,
+                       gsize idx_offset,
+                       guint from,
+                       guint to)
+{
+	for (; from < to; from++)
+		_SORTED_ARRAY_IDX (arr->pdata[from], idx_offset) = from;
+}
+
+static void
+_sorted_array_assert (GPtrArray *arr,
+                      gsize idx_offset,
+                      GCompareDataFunc cmp_func,
+                      gpointer cmp_data)
+{
+#if NM_MORE_ASSERTS > 5
+	guint i;
+
+	for (i = 0; i < arr->len; i++) {
+		nm_assert (_SORTED_ARRAY_IDX (arr->pdata[i], idx_offset) == i);
+		if (   i > 0
+		    && cmp_func)
+			nm_assert (cmp_func (arr->pdata[i - 1], arr->pdata[i], cmp_data) < 0);
+	}
+#endif
+}
+
+/**
+ * nm_sett_util_sorted_array_update:
+ * @arr: the array, sorted by @cmp_func
+ * @elem: the element to add or to re-position
+ * @idx_offset: the offset of a guint field in @elem, that holds the position
+ *   of the element in @arr. It must be initialized to
+ *   %NM_SETT_UTIL_SORTED_ARRAY_IDX_NONE and is maintained by the array.
+ * @cmp_func: the sort order. It must not consider distinct elements equal.
+ * @cmp_data: user data for @cmp_func
+ *
+ * Adds @elem to @arr, or moves it to its new position after its sort key
+ * changed. The old position is known from @elem, so there is no need to
+ * search for it.
+ */
+void
+nm_sett_util_sorted_array_update (GPtrArray *arr,
+                                  gpointer elem,
+                                  gsize idx_offset,
+                                  GCompareDataFunc cmp_func,
+                                  gpointer cmp_data)
+{
+	guint idx_old;
+	guint idx_new;
+	gssize idx;
+
+	idx_old = _SORTED_ARRAY_IDX (elem, idx_offset);
+	if (idx_old != NM_SETT_UTIL_SORTED_ARRAY_IDX_NONE) {
+		nm_assert (idx_old < arr->len);
+		nm_assert (arr->pdata[idx_old] == elem);
+		g_ptr_array_remove_index (arr, idx_old);
+	}
+
+	idx = nm_utils_ptrarray_find_binary_search ((gconstpointer *) arr->pdata,
+	                                            arr->len,
+	                                            elem,
+	                                            cmp_func,
+	                                            cmp_data,
+	                                            NULL,
+	                                            NULL);
+	nm_assert (idx < 0);
+	idx_new = ~idx;
+	g_ptr_array_insert (arr, idx_new, elem);
+
+	/* only the elements between the old and the new position moved. */
+	if (idx_old == NM_SETT_UTIL_SORTED_ARRAY_IDX_NONE)
+		_sorted_array_set_idx (arr, idx_offset, idx_new, arr->len);
+	else
+		_sorted_array_set_idx (arr, idx_offset, MIN (idx_old, idx_new), MAX (idx_old, idx_new) + 1);
+
+	_sorted_array_assert (arr, idx_offset, cmp_func, cmp_data);
+}
+
+void
+nm_sett_util_sorted_array_remove (GPtrArray *arr,
+                                  gpointer elem,
+                                  gsize idx_offset)
+{
+	guint idx;
+
+	idx = _SORTED_ARRAY_IDX (elem, idx_offset);
+	if (idx == NM_SETT_UTIL_SORTED_ARRAY_IDX_NONE)
+		return;
+
+	nm_assert (idx < arr->len);
+	nm_assert (arr->pdata[idx] == elem);
+
+	g_ptr_array_remove_index (arr, idx);
+	_SORTED_ARRAY_IDX (elem, idx_offset) = NM_SETT_UTIL_SORTED_ARRAY_IDX_NONE;
+	_sorted_array_set_idx (arr, idx_offset, idx, arr->len);
+
+	_sorted_array_assert (arr, idx_offset, NULL, NULL);
+}
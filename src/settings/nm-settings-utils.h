@@ -93,4 +93,39 @@ typedef struct {
 gboolean nm_sett_util_allow_filename_cb (const char *filename,
                                          gpointer user_data);
 
+/*****************************************************************************/
+
+struct _NMSettingsAutoconnectLookup;
+
+typedef struct _NMSettUtilAutoconnectIdx NMSettUtilAutoconnectIdx;
+
+NMSettUtilAutoconnectIdx *nm_sett_util_autoconnect_idx_new (void);
+
+void nm_sett_util_autoconnect_idx_free (NMSettUtilAutoconnectIdx *idx);
+
+void nm_sett_util_autoconnect_idx_update (NMSettUtilAutoconnectIdx *idx,
+                                          gconstpointer user_data,
+                                          NMConnection *connection);
+
+void nm_sett_util_autoconnect_idx_remove (NMSettUtilAutoconnectIdx *idx,
+                                          gconstpointer user_data);
+
+void nm_sett_util_autoconnect_idx_collect (NMSettUtilAutoconnectIdx *idx,
+                                           const struct _NMSettingsAutoconnectLookup *lookup,
+                                           GPtrArray *result);
+
+/*****************************************************************************/
+
+#define NM_SETT_UTIL_SORTED_ARRAY_IDX_NONE G_MAXUINT
+
+void nm_sett_util_sorted_array_update (GPtrArray *arr,
+                                       gpointer elem,
+                                       gsize idx_offset,
+                                       GCompareDataFunc cmp_func,
+                                       gpointer cmp_data);
+
+void nm_sett_util_sorted_array_remove (GPtrArray *arr,
+                                       gpointer elem,
+                                       gsize idx_offset);
+
 #endif /* __NM_SETTINGS_UTILS_H__ */
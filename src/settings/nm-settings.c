@@ -52,6 +52,7 @@
 #include "devices/nm-device-ethernet.h"
 #include "nm-settings-connection.h"
 #include "nm-settings-plugin.h"
+#include "nm-settings-utils.h"
 #include "nm-dbus-manager.h"
 #include "nm-auth-utils.h"
 #include "nm-libnm-core-intern/nm-auth-subject.h"
@@ -369,6 +370,14 @@ typedef struct {
 
 	NMSettingsConnection **connections_cached_list;
 
+	/* all profiles, kept sorted by nm_settings_connection_cmp_autoconnect_priority().
+	 * It gets updated whenever a profile is added, changed, removed or
+	 * its timestamp changes. */
+	GPtrArray *connections_sorted;
+
+	/* index of the profiles for nm_settings_get_autoconnect_candidates(). */
+	NMSettUtilAutoconnectIdx *autoconnect_idx;
+
 	GSList *unmanaged_specs;
 	GSList *unrecognized_specs;
 
@@ -774,6 +783,46 @@ connection_flags_changed (NMSettingsConnection *sett_conn,
 
 /*****************************************************************************/
 
+static int
+_connections_sorted_cmp (gconstpointer a,
+                         gconstpointer b,
+                         gpointer user_data)
+{
+	return nm_settings_connection_cmp_autoconnect_priority ((NMSettingsConnection *) a,
+	                                                        (NMSettingsConnection *) b);
+}
+
+static void
+_connections_sorted_remove (NMSettingsPrivate *priv,
+                            NMSettingsConnection *sett_conn)
+{
+	nm_sett_util_sorted_array_remove (priv->connections_sorted,
+	                                  sett_conn,
+	                                  G_STRUCT_OFFSET (NMSettingsConnection, _connections_sorted_idx));
+}
+
+static void
+_connections_sorted_update (NMSettingsPrivate *priv,
+                            NMSettingsConnection *sett_conn)
+{
+	/* the sort key of @sett_conn might already have changed. We find it by
+	 * its stored position and move it. */
+	nm_sett_util_sorted_array_update (priv->connections_sorted,
+	                                  sett_conn,
+	                                  G_STRUCT_OFFSET (NMSettingsConnection, _connections_sorted_idx),
+	                                  _connections_sorted_cmp,
+	                                  NULL);
+}
+
+static void
+connection_timestamp_changed (NMSettingsConnection *sett_conn,
+                              gpointer user_data)
+{
+	_connections_sorted_update (NM_SETTINGS_GET_PRIVATE (user_data), sett_conn);
+}
+
+/*****************************************************************************/
+
 static SettConnEntry *
 _sett_conn_entries_get (NMSettings *self,
                         const char *uuid)
@@ -1029,6 +1078,62 @@ _connection_changed_normalize_connection (NMSettingsStorage *storage,
 
 /*****************************************************************************/
 
+/**
+ * nm_settings_get_autoconnect_candidates:
+ * @self: the #NMSettings
+ * @lookup: the properties of the device
+ * @func: (allow-none): caller-supplied function for filtering connections
+ * @func_data: caller-supplied data passed to @func
+ * @out_len: (allow-none): the number of returned profiles
+ *
+ * Instead of checking every profile, this only returns the profiles
+ * that could be compatible with a device described by @lookup. The
+ * caller still must check each candidate with nm_device_can_auto_connect().
+ *
+ * Returns: (transfer container): a %NULL terminated array of the candidates,
+ *   sorted by nm_settings_connection_cmp_autoconnect_priority(). Free
+ *   with g_free().
+ */
+NMSettingsConnection **
+nm_settings_get_autoconnect_candidates (NMSettings *self,
+                                        const NMSettingsAutoconnectLookup *lookup,
+                                        NMSettingsConnectionFilterFunc func,
+                                        gpointer func_data,
+                                        guint *out_len)
+{
+	NMSettingsPrivate *priv;
+	GPtrArray *result;
+	guint i, j;
+
+	g_return_val_if_fail (NM_IS_SETTINGS (self), NULL);
+	g_return_val_if_fail (lookup, NULL);
+
+	priv = NM_SETTINGS_GET_PRIVATE (self);
+
+	result = g_ptr_array_new ();
+
+	nm_sett_util_autoconnect_idx_collect (priv->autoconnect_idx, lookup, result);
+
+	if (func) {
+		for (i = 0, j = 0; i < result->len; i++) {
+			if (func (self, result->pdata[i], func_data))
+				result->pdata[j++] = result->pdata[i];
+		}
+		g_ptr_array_set_size (result, j);
+	}
+
+	if (result->len > 1) {
+		g_qsort_with_data (result->pdata, result->len, sizeof (NMSettingsConnection *),
+		                   nm_settings_connection_cmp_autoconnect_priority_p_with_data, NULL);
+	}
+
+	NM_SET_OUT (out_len, result->len);
+	g_ptr_array_add (result, NULL);
+	return (NMSettingsConnection **) g_ptr_array_free (result, FALSE);
+}
+
+/*****************************************************************************/
+
 static void
 _connection_changed_update (NMSettings *self,
                             SettConnEntry *sett_conn_entry,
@@ -1071,8 +1176,14 @@ _connection_changed_update (NMSettings *self,
 		priv->connections_generation++;
 
 		g_signal_connect (sett_conn, NM_SETTINGS_CONNECTION_FLAGS_CHANGED, G_CALLBACK (connection_flags_changed), self);
+		g_signal_connect (sett_conn, NM_SETTINGS_CONNECTION_TIMESTAMP_CHANGED, G_CALLBACK (connection_timestamp_changed), self);
 	}
 
+	_connections_sorted_update (priv, sett_conn);
+	nm_sett_util_autoconnect_idx_update (priv->autoconnect_idx,
+	                                     sett_conn,
+	                                     nm_settings_connection_get_connection (sett_conn));
+
 	if (NM_FLAGS_HAS (update_reason, NM_SETTINGS_CONNECTION_UPDATE_REASON_BLOCK_AUTOCONNECT)) {
 		nm_settings_connection_autoconnect_blocked_reason_set (sett_conn,
 		                                                       NM_SETTINGS_AUTO_CONNECT_BLOCKED_REASON_USER_REQUEST,
@@ -1177,12 +1288,16 @@ _connection_changed_delete (NMSettings *self,
 		default_wired_clear_tag (self, device, sett_conn, allow_add_to_no_auto_default);
 
 	g_signal_handlers_disconnect_by_func (sett_conn, G_CALLBACK (connection_flags_changed), self);
+	g_signal_handlers_disconnect_by_func (sett_conn, G_CALLBACK (connection_timestamp_changed), self);
 
 	_clear_connections_cached_list (priv);
 	c_list_unlink (&sett_conn->_connections_lst);
 	priv->connections_len--;
 	priv->connections_generation++;
 
+	_connections_sorted_remove (priv, sett_conn);
+	nm_sett_util_autoconnect_idx_remove (priv->autoconnect_idx, sett_conn);
+
 	/* Tell agents to remove secrets for this connection */
 	connection_for_agents = nm_simple_connection_new_clone (nm_settings_connection_get_connection (sett_conn));
 	nm_connection_clear_secrets (connection_for_agents);
@@ -3002,6 +3117,35 @@ nm_settings_get_connections (NMSettings *self, guint *out_len)
 	return priv->connections_cached_list;
 }
 
+/**
+ * nm_settings_get_connections_sorted_by_autoconnect_priority:
+ * @self: the #NMSettings
+ * @out_len: (out) (allow-none): returns the number of returned
+ *   connections.
+ *
+ * Returns: (transfer none): all profiles, sorted by
+ *   nm_settings_connection_cmp_autoconnect_priority(). The list
+ *   is maintained incrementally, so this is cheap. Like with
+ *   nm_settings_get_connections(), the list is only valid until
+ *   the next NMSettings operation. Contrary to nm_settings_get_connections(),
+ *   the list is not %NULL terminated.
+ */
+NMSettingsConnection *const*
+nm_settings_get_connections_sorted_by_autoconnect_priority (NMSettings *self,
+                                                            guint *out_len)
+{
+	NMSettingsPrivate *priv;
+
+	g_return_val_if_fail (NM_IS_SETTINGS (self), NULL);
+
+	priv = NM_SETTINGS_GET_PRIVATE (self);
+
+	nm_assert (priv->connections_len == priv->connections_sorted->len);
+
+	NM_SET_OUT (out_len, priv->connections_sorted->len);
+	return (NMSettingsConnection *const*) priv->connections_sorted->pdata;
+}
+
 /**
  * nm_settings_get_connections_clone:
  * @self: the #NMSetting
@@ -3015,7 +3159,9 @@ nm_settings_get_connections (NMSettings *self, guint *out_len)
  * Returns: (transfer container) (element-type NMSettingsConnection):
  *   an NULL terminated array of #NMSettingsConnection objects that were
  *   filtered by @func (or all connections if no filter was specified).
- *   The order is arbitrary.
+ *   The order is arbitrary, unless @sort_compare_func is given. Sorting by
+ *   nm_settings_connection_cmp_autoconnect_priority_p_with_data() is
+ *   cheap, because NMSettings already keeps that order.
  *   Caller is responsible for freeing the returned array with free(),
  *   the contained values do not need to be unrefed.
  */
@@ -3033,13 +3179,18 @@ nm_settings_get_connections_clone (NMSettings *self,
 
 	g_return_val_if_fail (NM_IS_SETTINGS (self), NULL);
 
-	list_cached = nm_settings_get_connections (self, &len);
+	if (sort_compare_func == nm_settings_connection_cmp_autoconnect_priority_p_with_data) {
+		/* this is the common case for activation. We already have the list
+		 * in this order. */
+		list_cached = nm_settings_get_connections_sorted_by_autoconnect_priority (self, &len);
+		sort_compare_func = NULL;
+	} else
+		list_cached = nm_settings_get_connections (self, &len);
 
 #if NM_MORE_ASSERTS
 	nm_assert (list_cached);
 	for (i = 0; i < len; i++)
 		nm_assert (NM_IS_SETTINGS_CONNECTION (list_cached[i]));
-	nm_assert (!list_cached[i]);
 #endif
 
 	list = g_new (NMSettingsConnection *, ((gsize) len + 1));
@@ -3048,10 +3199,10 @@ nm_settings_get_connections_clone (NMSettings *self,
 			if (func (self, list_cached[i], func_data))
 				list[j++] = list_cached[i];
 		}
-		list[j] = NULL;
 		len = j;
-	} else
-		memcpy (list, list_cached, sizeof (list[0]) * ((gsize) len + 1));
+	} else if (len > 0)
+		memcpy (list, list_cached, sizeof (list[0]) * ((gsize) len));
+	list[len] = NULL;
 
 	if (   len > 1
 	    && sort_compare_func) {
@@ -3814,11 +3965,14 @@ nm_settings_init (NMSettings *self)
 
 	c_list_init (&priv->auth_lst_head);
 	c_list_init (&priv->connections_lst_head);
+	priv->connections_sorted = g_ptr_array_new ();
 
 	c_list_init (&priv->sce_dirty_lst_head);
 	priv->sce_idx = g_hash_table_new_full (nm_pstr_hash, nm_pstr_equal,
 	                                       NULL, (GDestroyNotify) _sett_conn_entry_free);
 
+	priv->autoconnect_idx = nm_sett_util_autoconnect_idx_new ();
+
 	priv->config = g_object_ref (nm_config_get ());
 
 	priv->agent_mgr = g_object_ref (nm_agent_manager_get ());
@@ -3884,11 +4038,16 @@ finalize (GObject *object)
 
 	nm_assert (c_list_is_empty (&priv->connections_lst_head));
 
+	nm_assert (priv->connections_sorted->len == 0);
+	nm_clear_pointer (&priv->connections_sorted, g_ptr_array_unref);
+
 	nm_assert (c_list_is_empty (&priv->sce_dirty_lst_head));
 	nm_assert (g_hash_table_size (priv->sce_idx) == 0);
 
 	nm_clear_pointer (&priv->sce_idx, g_hash_table_destroy);
 
+	nm_clear_pointer (&priv->autoconnect_idx, nm_sett_util_autoconnect_idx_free);
+
 	g_slist_free_full (priv->unmanaged_specs, g_free);
 	g_slist_free_full (priv->unrecognized_specs, g_free);
 
@@ -76,6 +76,9 @@ void nm_settings_add_connection_dbus (NMSettings *self,
 
 NMSettingsConnection *const*nm_settings_get_connections (NMSettings *settings, guint *out_len);
 
+NMSettingsConnection *const*nm_settings_get_connections_sorted_by_autoconnect_priority (NMSettings *self,
+                                                                                        guint *out_len);
+
 NMSettingsConnection **nm_settings_get_connections_clone (NMSettings *self,
                                                           guint *out_len,
                                                           NMSettingsConnectionFilterFunc func,
@@ -83,6 +86,45 @@ NMSettingsConnection **nm_settings_get_connections_clone (NMSettings *self,
                                                           GCompareDataFunc sort_compare_func,
                                                           gpointer sort_data);
 
+/**
+ * NMSettingsAutoconnectLookup:
+ * @type: the connection type that the device accepts, or %NULL if
+ *   the device accepts profiles of several types.
+ * @types: (allow-none): if @type is %NULL, the %NULL terminated list of
+ *   connection types that the device accepts. If both are %NULL, profiles
+ *   of all types are candidates.
+ * @ifname: the interface name of the device. Profiles that pin a
+ *   different connection.interface-name are not candidates.
+ * @hwaddr: (allow-none): the permanent MAC address of the device. Ethernet
+ *   profiles that pin a different 802-3-ethernet.mac-address are not
+ *   candidates.
+ * @parent: (allow-none): the interface name of the parent device. VLAN
+ *   profiles that pin a parent with a different interface name are not
+ *   candidates.
+ * @vlan_id: the VLAN id of the device. Only valid if @vlan_id_has is set.
+ * @vlan_id_has: whether @vlan_id is set. VLAN profiles with a different
+ *   id are not candidates.
+ *
+ * Describes a device for nm_settings_get_autoconnect_candidates(). Each
+ * field must only be set, if the device indeed is not compatible with
+ * the profiles that it would rule out.
+ */
+typedef struct _NMSettingsAutoconnectLookup {
+	const char *type;
+	const char *const*types;
+	const char *ifname;
+	const char *hwaddr;
+	const char *parent;
+	guint32 vlan_id;
+	bool vlan_id_has;
+} NMSettingsAutoconnectLookup;
+
+NMSettingsConnection **nm_settings_get_autoconnect_candidates (NMSettings *self,
+                                                               const NMSettingsAutoconnectLookup *lookup,
+                                                               NMSettingsConnectionFilterFunc func,
+                                                               gpointer func_data,
+                                                               guint *out_len);
+
 gboolean nm_settings_add_connection (NMSettings *settings,
                                      NMConnection *connection,
                                      NMSettingsConnectionPersistMode persist_mode,
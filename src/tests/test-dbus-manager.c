@@ -0,0 +1,395 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Copyright (C) 2020 Red Hat, Inc.
+ */
+
+#include "nm-default.h"
+
+#include "nm-dbus-manager.h"
+#include "nm-dbus-object.h"
+
+#include "nm-test-utils-core.h"
+
+/*****************************************************************************/
+
+#define TST_INTERFACE NM_DBUS_INTERFACE".Test"
+
+typedef struct {
+	NMDBusObject parent;
+	guint value;
+} TstObject;
+
+typedef struct {
+	NMDBusObjectClass parent;
+} TstObjectClass;
+
+G_DEFINE_TYPE (TstObject, tst_object, NM_TYPE_DBUS_OBJECT)
+
+enum {
+	PROP_0,
+	PROP_VALUE,
+};
+
+static const GDBusSignalInfo signal_info_tst_ping = NM_DEFINE_GDBUS_SIGNAL_INFO_INIT (
+	"Ping",
+	.args = NM_DEFINE_GDBUS_ARG_INFOS (
+		NM_DEFINE_GDBUS_ARG_INFO ("object", "o"),
+	),
+);
+
+static const NMDBusInterfaceInfoExtended interface_info_tst = {
+	.parent = NM_DEFINE_GDBUS_INTERFACE_INFO_INIT (
+		TST_INTERFACE,
+		.signals = NM_DEFINE_GDBUS_SIGNAL_INFOS (
+			&signal_info_tst_ping,
+		),
+		.properties = NM_DEFINE_GDBUS_PROPERTY_INFOS (
+			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE ("Value", "u", "value"),
+		),
+	),
+};
+
+static void
+tst_object_get_property (GObject *object, guint prop_id,
+                         GValue *value, GParamSpec *pspec)
+{
+	TstObject *self = (TstObject *) object;
+
+	switch (prop_id) {
+	case PROP_VALUE:
+		g_value_set_uint (value, self->value);
+		break;
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+		break;
+	}
+}
+
+static void
+tst_object_init (TstObject *self)
+{
+}
+
+static void
+tst_object_class_init (TstObjectClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+	NMDBusObjectClass *dbus_object_class = NM_DBUS_OBJECT_CLASS (klass);
+
+	dbus_object_class->export_path = NM_DBUS_EXPORT_PATH_NUMBERED (NM_DBUS_PATH"/Test");
+	dbus_object_class->interface_infos = NM_DBUS_INTERFACE_INFOS (&interface_info_tst);
+
+	object_class->get_property = tst_object_get_property;
+
+	g_object_class_install_property (object_class, PROP_VALUE,
+	    g_param_spec_uint ("value", "", "",
+	                       0, G_MAXUINT, 0,
+	                       G_PARAM_READABLE |
+	                       G_PARAM_STATIC_STRINGS));
+}
+
+static TstObject *
+_tst_object_new_exported (void)
+{
+	TstObject *obj;
+
+	obj = g_object_new (tst_object_get_type (), NULL);
+	nm_dbus_object_export (NM_DBUS_OBJECT (obj));
+	return obj;
+}
+
+static const char *
+_tst_object_path (TstObject *obj)
+{
+	return nm_dbus_object_get_path (NM_DBUS_OBJECT (obj));
+}
+
+static void
+_tst_object_unexport_and_unref (TstObject *obj)
+{
+	nm_dbus_object_unexport (NM_DBUS_OBJECT (obj));
+	g_object_unref (obj);
+}
+
+/*****************************************************************************/
+
+typedef struct {
+	GDBusServer *server;
+	GDBusConnection *server_connection;
+	GDBusConnection *client_connection;
+	GPtrArray *signals;
+	guint subscription_id;
+} TestBusData;
+
+static gboolean
+_server_new_connection (GDBusServer *server,
+                        GDBusConnection *connection,
+                        gpointer user_data)
+{
+	TestBusData *bus = user_data;
+
+	g_assert (!bus->server_connection);
+	bus->server_connection = g_object_ref (connection);
+	return TRUE;
+}
+
+static void
+_client_new_cb (GObject *source,
+                GAsyncResult *result,
+                gpointer user_data)
+{
+	TestBusData *bus = user_data;
+	gs_free_error GError *error = NULL;
+
+	bus->client_connection = g_dbus_connection_new_for_address_finish (result, &error);
+	g_assert_no_error (error);
+}
+
+static void
+_client_signal_cb (GDBusConnection *connection,
+                   const char *sender_name,
+                   const char *object_path,
+                   const char *interface_name,
+                   const char *signal_name,
+                   GVariant *parameters,
+                   gpointer user_data)
+{
+	TestBusData *bus = user_data;
+	const char *arg0 = NULL;
+
+	if (   g_variant_n_children (parameters) > 0
+	    && g_variant_is_of_type (parameters, G_VARIANT_TYPE_TUPLE)) {
+		gs_unref_variant GVariant *v = g_variant_get_child_value (parameters, 0);
+
+		if (g_variant_is_of_type (v, G_VARIANT_TYPE_OBJECT_PATH))
+			arg0 = g_variant_get_string (v, NULL);
+	}
+
+	g_ptr_array_add (bus->signals,
+	                 g_strdup_printf ("%s %s%s%s%s",
+	                                  signal_name,
+	                                  object_path,
+	                                  NM_PRINT_FMT_QUOTED (arg0, " ", arg0, "", "")));
+}
+
+static void
+_test_bus_setup (TestBusData *bus)
+{
+	gs_free_error GError *error = NULL;
+	gs_free char *guid = NULL;
+
+	*bus = (TestBusData) {
+		.signals = g_ptr_array_new_with_free_func (g_free),
+	};
+
+	guid = g_dbus_generate_guid ();
+	bus->server = g_dbus_server_new_sync ("unix:tmpdir=/tmp",
+	                                      G_DBUS_SERVER_FLAGS_AUTHENTICATION_ALLOW_ANONYMOUS,
+	                                      guid,
+	                                      NULL,
+	                                      NULL,
+	                                      &error);
+	g_assert_no_error (error);
+	g_signal_connect (bus->server, "new-connection", G_CALLBACK (_server_new_connection), bus);
+	g_dbus_server_start (bus->server);
+
+	g_dbus_connection_new_for_address (g_dbus_server_get_client_address (bus->server),
+	                                   G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT,
+	                                   NULL,
+	                                   NULL,
+	                                   _client_new_cb,
+	                                   bus);
+
+	nmtst_main_context_iterate_until_assert (NULL, 5000,
+	                                            bus->server_connection
+	                                         && bus->client_connection);
+
+	bus->subscription_id = g_dbus_connection_signal_subscribe (bus->client_connection,
+	                                                           NULL,
+	                                                           NULL,
+	                                                           NULL,
+	                                                           NULL,
+	                                                           NULL,
+	                                                           G_DBUS_SIGNAL_FLAGS_NONE,
+	                                                           _client_signal_cb,
+	                                                           bus,
+	                                                           NULL);
+
+	_nmtst_dbus_manager_start_on_connection (nm_dbus_manager_get (), bus->server_connection);
+}
+
+static void
+_get_managed_objects_cb (GObject *source,
+                         GAsyncResult *result,
+                         gpointer user_data)
+{
+	GVariant **p_result = user_data;
+	gs_free_error GError *error = NULL;
+
+	*p_result = g_dbus_connection_call_finish (G_DBUS_CONNECTION (source), result, &error);
+	g_assert_no_error (error);
+}
+
+/* Calls GetManagedObjects() and returns the exported paths, separated by
+ * space. Signals emitted before the reply are received before it, so
+ * afterwards all of them are recorded. */
+static char *
+_test_bus_roundtrip (TestBusData *bus)
+{
+	gs_unref_variant GVariant *result = NULL;
+	gs_unref_variant GVariant *objects = NULL;
+	nm_auto_free_gstring GString *str = NULL;
+	GVariantIter iter;
+	const char *path;
+
+	g_dbus_connection_call (bus->client_connection,
+	                        NULL,
+	                        "/org/freedesktop",
+	                        "org.freedesktop.DBus.ObjectManager",
+	                        "GetManagedObjects",
+	                        NULL,
+	                        G_VARIANT_TYPE ("(a{oa{sa{sv}}})"),
+	                        G_DBUS_CALL_FLAGS_NONE,
+	                        -1,
+	                        NULL,
+	                        _get_managed_objects_cb,
+	                        &result);
+	nmtst_main_context_iterate_until_assert (NULL, 5000, result);
+
+	str = g_string_new (NULL);
+	objects = g_variant_get_child_value (result, 0);
+	g_variant_iter_init (&iter, objects);
+	while (g_variant_iter_next (&iter, "{&o@a{sa{sv}}}", &path, NULL)) {
+		if (str->len > 0)
+			g_string_append_c (str, ' ');
+		g_string_append (str, path);
+	}
+	return g_string_free (g_steal_pointer (&str), FALSE);
+}
+
+static char *
+_test_bus_steal_signals (TestBusData *bus)
+{
+	char *s;
+
+	g_ptr_array_add (bus->signals, NULL);
+	s = g_strjoinv ("\n", (char **) bus->signals->pdata);
+	g_ptr_array_set_size (bus->signals, 0);
+	return s;
+}
+
+#define _assert_str(str_take, ...) \
+	G_STMT_START { \
+		gs_free char *_str = (str_take); \
+		gs_free char *_expected = g_strdup_printf (__VA_ARGS__); \
+		\
+		g_assert_cmpstr (_str, ==, _expected); \
+	} G_STMT_END
+
+/*****************************************************************************/
+
+static void
+test_export_freeze (void)
+{
+	TestBusData bus;
+	TstObject *obj_a;
+	TstObject *obj_b;
+	TstObject *obj_c;
+	TstObject *obj_d;
+	gs_free char *path_a = NULL;
+	gs_free char *path_b = NULL;
+	gs_free char *path_c = NULL;
+	NMDBusManager *dbus_manager;
+
+	_test_bus_setup (&bus);
+	dbus_manager = nm_dbus_manager_get ();
+
+	obj_a = _tst_object_new_exported ();
+	obj_c = _tst_object_new_exported ();
+	path_a = g_strdup (_tst_object_path (obj_a));
+	path_c = g_strdup (_tst_object_path (obj_c));
+
+	_assert_str (_test_bus_roundtrip (&bus), "%s %s", path_a, path_c);
+	_assert_str (_test_bus_steal_signals (&bus),
+	             "InterfacesAdded /org/freedesktop %s\n"
+	             "InterfacesAdded /org/freedesktop %s",
+	             path_a,
+	             path_c);
+
+	/* freezing nests. */
+	nm_dbus_manager_export_freeze (dbus_manager);
+	nm_dbus_manager_export_freeze (dbus_manager);
+
+	obj_b = _tst_object_new_exported ();
+	path_b = g_strdup (_tst_object_path (obj_b));
+
+	/* signals and notifications of registered objects are delayed... */
+	nm_dbus_object_emit_signal (NM_DBUS_OBJECT (obj_a),
+	                            &interface_info_tst,
+	                            &signal_info_tst_ping,
+	                            "(o)",
+	                            path_b);
+	obj_a->value = 1;
+	g_object_notify (G_OBJECT (obj_a), "value");
+
+	/* ... and dropped, if the object goes away. */
+	nm_dbus_object_emit_signal (NM_DBUS_OBJECT (obj_c),
+	                            &interface_info_tst,
+	                            &signal_info_tst_ping,
+	                            "(o)",
+	                            path_b);
+	obj_c->value = 1;
+	g_object_notify (G_OBJECT (obj_c), "value");
+	_tst_object_unexport_and_unref (obj_c);
+
+	/* an object that comes and goes while frozen is never announced. */
+	obj_d = _tst_object_new_exported ();
+	g_object_notify (G_OBJECT (obj_d), "value");
+	_tst_object_unexport_and_unref (obj_d);
+
+	nm_dbus_manager_export_thaw (dbus_manager);
+
+	_assert_str (_test_bus_roundtrip (&bus), "%s", path_a);
+	_assert_str (_test_bus_steal_signals (&bus),
+	             "InterfacesRemoved /org/freedesktop %s",
+	             path_c);
+
+	nm_dbus_manager_export_thaw (dbus_manager);
+
+	_assert_str (_test_bus_roundtrip (&bus), "%s %s", path_a, path_b);
+	_assert_str (_test_bus_steal_signals (&bus),
+	             "InterfacesAdded /org/freedesktop %s\n"
+	             "Ping %s %s\n"
+	             "PropertiesChanged %s",
+	             path_b,
+	             path_a, path_b,
+	             path_a);
+
+	/* once thawed, everything is emitted right away again. */
+	obj_b->value = 2;
+	g_object_notify (G_OBJECT (obj_b), "value");
+	_assert_str (_test_bus_roundtrip (&bus), "%s %s", path_a, path_b);
+	_assert_str (_test_bus_steal_signals (&bus),
+	             "PropertiesChanged %s",
+	             path_b);
+
+	_tst_object_unexport_and_unref (obj_a);
+	_tst_object_unexport_and_unref (obj_b);
+
+	g_dbus_connection_signal_unsubscribe (bus.client_connection, bus.subscription_id);
+	g_ptr_array_unref (bus.signals);
+}
+
+/*****************************************************************************/
+
+NMTST_DEFINE ();
+
+int
+main (int argc, char **argv)
+{
+	nmtst_init_assert_logging (&argc, &argv, "INFO", "DEFAULT");
+
+	g_test_add_func ("/dbus-manager/export-freeze", test_export_freeze);
+
+	return g_test_run ();
+}
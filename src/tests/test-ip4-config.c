@@ -9,6 +9,7 @@
 
 #include "nm-ip4-config.h"
 #include "platform/nm-platform.h"
+#include "platform/nm-fake-platform.h"
 
 #include "nm-test-utils-core.h"
 
@@ -359,6 +360,177 @@ test_strip_search_trailing_dot (void)
 
 /*****************************************************************************/
 
+static void
+_capture_change_set_cb (NMPlatform *platform,
+                        const NMPlatformChangeSet *change_set,
+                        GHashTable *changed_routes)
+{
+	guint i;
+
+	if (change_set->obj_type != NMP_OBJECT_TYPE_IP4_ROUTE)
+		return;
+
+	g_assert (change_set->objs);
+	for (i = 0; i < change_set->n_objs; i++)
+		g_hash_table_add (changed_routes, (gpointer) nmp_object_ref (change_set->objs[i]));
+}
+
+static void
+_assert_capture_equal (const NMIP4Config *a, const NMIP4Config *b)
+{
+	NMDedupMultiIter iter_a;
+	NMDedupMultiIter iter_b;
+	const NMPlatformIP4Route *r_a;
+	const NMPlatformIP4Route *r_b;
+	guint i;
+
+	g_assert_cmpint (nm_ip4_config_get_num_addresses (a), ==, nm_ip4_config_get_num_addresses (b));
+	for (i = 0; i < nm_ip4_config_get_num_addresses (a); i++) {
+		g_assert_cmpint (nm_platform_ip4_address_cmp (_nmtst_ip4_config_get_address (a, i),
+		                                              _nmtst_ip4_config_get_address (b, i)), ==, 0);
+	}
+
+	/* the order of the routes differs, but not their content. */
+	g_assert_cmpint (nm_ip4_config_get_num_routes (a), ==, nm_ip4_config_get_num_routes (b));
+	nm_ip_config_iter_ip4_route_for_each (&iter_a, a, &r_a) {
+		gboolean found = FALSE;
+
+		nm_ip_config_iter_ip4_route_for_each (&iter_b, b, &r_b) {
+			if (nm_platform_ip4_route_cmp_full (r_a, r_b) == 0) {
+				found = TRUE;
+				break;
+			}
+		}
+		g_assert (found);
+	}
+
+	g_assert (nmp_object_equal (nm_ip4_config_best_default_route_get (a),
+	                            nm_ip4_config_best_default_route_get (b)));
+}
+
+static void
+test_capture_update (void)
+{
+	NMPlatform *platform = NM_PLATFORM_GET;
+	nm_auto_unref_dedup_multi_index NMDedupMultiIndex *multi_idx = nm_dedup_multi_index_new ();
+	gs_unref_hashtable GHashTable *changed_routes = NULL;
+	gs_unref_object NMIP4Config *captured = NULL;
+	gs_unref_object NMIP4Config *cloned = NULL;
+	gs_unref_object NMIP4Config *full = NULL;
+	nm_auto_nmpobj NMPObject *obj = NULL;
+	NMPlatformIP4Route route;
+	GHashTableIter h_iter;
+	const NMPObject *needle;
+	gulong handler_id;
+	int ifindex;
+
+	ifindex = nm_platform_link_get_ifindex (platform, "eth0");
+	g_assert_cmpint (ifindex, >, 0);
+
+	changed_routes = g_hash_table_new_full ((GHashFunc) nmp_object_id_hash,
+	                                        (GEqualFunc) nmp_object_id_equal,
+	                                        (GDestroyNotify) nmp_object_unref,
+	                                        NULL);
+	handler_id = g_signal_connect (platform,
+	                               NM_PLATFORM_SIGNAL_CHANGE_SET,
+	                               G_CALLBACK (_capture_change_set_cb),
+	                               changed_routes);
+
+	g_assert (nm_platform_ip4_address_add (platform, ifindex,
+	                                       nmtst_inet4_from_string ("192.168.1.10"), 24,
+	                                       nmtst_inet4_from_string ("192.168.1.10"), 0,
+	                                       NM_PLATFORM_LIFETIME_PERMANENT,
+	                                       NM_PLATFORM_LIFETIME_PERMANENT,
+	                                       0, NULL));
+
+	route = (NMPlatformIP4Route) {
+		.ifindex   = ifindex,
+		.rt_source = NM_IP_CONFIG_SOURCE_USER,
+		.network   = nmtst_inet4_from_string ("10.0.0.0"),
+		.plen      = 8,
+		.metric    = 100,
+	};
+	g_assert_cmpint (nm_platform_ip4_route_add (platform, NMP_NLM_FLAG_REPLACE, &route), ==, 0);
+	route.network = nmtst_inet4_from_string ("172.16.0.0");
+	route.plen = 16;
+	g_assert_cmpint (nm_platform_ip4_route_add (platform, NMP_NLM_FLAG_REPLACE, &route), ==, 0);
+	route.network = 0;
+	route.plen = 0;
+	g_assert_cmpint (nm_platform_ip4_route_add (platform, NMP_NLM_FLAG_REPLACE, &route), ==, 0);
+
+	captured = nm_ip4_config_capture (multi_idx, platform, ifindex);
+	g_assert (captured);
+	g_assert_cmpint (nm_ip4_config_get_num_routes (captured), ==, 3);
+	g_assert (nm_ip4_config_best_default_route_get (captured));
+
+	cloned = nm_ip4_config_new_cloned (captured);
+	g_assert_cmpint (nm_ip4_config_get_ifindex (cloned), ==, ifindex);
+	_assert_capture_equal (captured, cloned);
+
+	/* the captured configuration already contains the pending changes. */
+	nm_platform_change_set_flush (platform, NMP_OBJECT_TYPE_IP4_ROUTE, ifindex);
+	g_assert_cmpint (g_hash_table_size (changed_routes), ==, 3);
+	g_hash_table_remove_all (changed_routes);
+
+	/* remove a route, change one, add another one and the default route with
+	 * a lower metric. Also replace the address. */
+	route = (NMPlatformIP4Route) {
+		.ifindex   = ifindex,
+		.rt_source = NM_IP_CONFIG_SOURCE_USER,
+		.network   = nmtst_inet4_from_string ("10.0.0.0"),
+		.plen      = 8,
+		.metric    = 100,
+	};
+	obj = nmp_object_new (NMP_OBJECT_TYPE_IP4_ROUTE, (const NMPlatformObject *) &route);
+	g_assert (nm_platform_object_delete (platform, obj));
+	route.network = nmtst_inet4_from_string ("172.16.0.0");
+	route.plen = 16;
+	route.pref_src = nmtst_inet4_from_string ("192.168.1.10");
+	g_assert_cmpint (nm_platform_ip4_route_add (platform, NMP_NLM_FLAG_REPLACE, &route), ==, 0);
+	route.network = nmtst_inet4_from_string ("172.17.0.0");
+	route.pref_src = 0;
+	g_assert_cmpint (nm_platform_ip4_route_add (platform, NMP_NLM_FLAG_REPLACE, &route), ==, 0);
+	route.network = 0;
+	route.plen = 0;
+	route.metric = 50;
+	g_assert_cmpint (nm_platform_ip4_route_add (platform, NMP_NLM_FLAG_REPLACE, &route), ==, 0);
+
+	g_assert (nm_platform_ip4_address_add (platform, ifindex,
+	                                       nmtst_inet4_from_string ("192.168.2.10"), 24,
+	                                       nmtst_inet4_from_string ("192.168.2.10"), 0,
+	                                       NM_PLATFORM_LIFETIME_PERMANENT,
+	                                       NM_PLATFORM_LIFETIME_PERMANENT,
+	                                       0, NULL));
+	g_assert (nm_platform_ip4_address_delete (platform, ifindex,
+	                                          nmtst_inet4_from_string ("192.168.1.10"), 24,
+	                                          nmtst_inet4_from_string ("192.168.1.10")));
+
+	/* the change set was not yet emitted. */
+	g_assert_cmpint (g_hash_table_size (changed_routes), ==, 0);
+	nm_platform_change_set_flush (platform, NMP_OBJECT_TYPE_IP4_ROUTE, ifindex);
+	g_assert_cmpint (g_hash_table_size (changed_routes), ==, 4);
+
+	nm_ip4_config_capture_update_addresses (captured, platform);
+	nm_ip4_config_capture_update_addresses (cloned, platform);
+	g_hash_table_iter_init (&h_iter, changed_routes);
+	while (g_hash_table_iter_next (&h_iter, (gpointer *) &needle, NULL)) {
+		nm_ip4_config_capture_update_route (captured, platform, needle);
+		nm_ip4_config_capture_update_route (cloned, platform, needle);
+	}
+
+	full = nm_ip4_config_capture (multi_idx, platform, ifindex);
+	g_assert (full);
+	g_assert_cmpint (nm_ip4_config_get_num_addresses (full), ==, 1);
+	g_assert (NMP_OBJECT_CAST_IP4_ROUTE (nm_ip4_config_best_default_route_get (full))->metric == 50);
+
+	_assert_capture_equal (full, captured);
+	_assert_capture_equal (full, cloned);
+
+	g_signal_handler_disconnect (platform, handler_id);
+}
+
+/*****************************************************************************/
+
 NMTST_DEFINE ();
 
 int
@@ -366,6 +538,8 @@ main (int argc, char **argv)
 {
 	nmtst_init_with_logging (&argc, &argv, NULL, "DEFAULT");
 
+	nm_fake_platform_setup ();
+
 	g_test_add_func ("/ip4-config/replace", test_replace);
 	g_test_add_func ("/ip4-config/subtract", test_subtract);
 	g_test_add_func ("/ip4-config/compare-with-source", test_compare_with_source);
@@ -373,6 +547,7 @@ main (int argc, char **argv)
 	g_test_add_func ("/ip4-config/add-route-with-source", test_add_route_with_source);
 	g_test_add_func ("/ip4-config/merge-subtract-mtu", test_merge_subtract_mtu);
 	g_test_add_func ("/ip4-config/strip-search-trailing-dot", test_strip_search_trailing_dot);
+	g_test_add_func ("/ip4-config/capture-update", test_capture_update);
 
 	return g_test_run ();
 }
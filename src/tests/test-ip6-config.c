@@ -11,6 +11,7 @@
 #include "nm-ip6-config.h"
 
 #include "platform/nm-platform.h"
+#include "platform/nm-fake-platform.h"
 #include "nm-test-utils-core.h"
 
 static NMIP6Config *
@@ -405,6 +406,173 @@ test_replace (gconstpointer user_data)
 
 /*****************************************************************************/
 
+static void
+_capture_change_set_cb (NMPlatform *platform,
+                        const NMPlatformChangeSet *change_set,
+                        GHashTable *changed_routes)
+{
+	guint i;
+
+	if (change_set->obj_type != NMP_OBJECT_TYPE_IP6_ROUTE)
+		return;
+
+	g_assert (change_set->objs);
+	for (i = 0; i < change_set->n_objs; i++)
+		g_hash_table_add (changed_routes, (gpointer) nmp_object_ref (change_set->objs[i]));
+}
+
+static void
+_assert_capture_equal (const NMIP6Config *a, const NMIP6Config *b)
+{
+	NMDedupMultiIter iter_a;
+	NMDedupMultiIter iter_b;
+	const NMPlatformIP6Route *r_a;
+	const NMPlatformIP6Route *r_b;
+	guint i;
+
+	g_assert_cmpint (nm_ip6_config_get_num_addresses (a), ==, nm_ip6_config_get_num_addresses (b));
+	for (i = 0; i < nm_ip6_config_get_num_addresses (a); i++) {
+		g_assert_cmpint (nm_platform_ip6_address_cmp (_nmtst_ip6_config_get_address (a, i),
+		                                              _nmtst_ip6_config_get_address (b, i)), ==, 0);
+	}
+
+	/* the order of the routes differs, but not their content. */
+	g_assert_cmpint (nm_ip6_config_get_num_routes (a), ==, nm_ip6_config_get_num_routes (b));
+	nm_ip_config_iter_ip6_route_for_each (&iter_a, a, &r_a) {
+		gboolean found = FALSE;
+
+		nm_ip_config_iter_ip6_route_for_each (&iter_b, b, &r_b) {
+			if (nm_platform_ip6_route_cmp_full (r_a, r_b) == 0) {
+				found = TRUE;
+				break;
+			}
+		}
+		g_assert (found);
+	}
+
+	g_assert (nmp_object_equal (nm_ip6_config_best_default_route_get (a),
+	                            nm_ip6_config_best_default_route_get (b)));
+}
+
+static void
+test_capture_update (void)
+{
+	NMPlatform *platform = NM_PLATFORM_GET;
+	nm_auto_unref_dedup_multi_index NMDedupMultiIndex *multi_idx = nm_dedup_multi_index_new ();
+	gs_unref_hashtable GHashTable *changed_routes = NULL;
+	gs_unref_object NMIP6Config *captured = NULL;
+	gs_unref_object NMIP6Config *cloned = NULL;
+	gs_unref_object NMIP6Config *full = NULL;
+	nm_auto_nmpobj NMPObject *obj = NULL;
+	NMPlatformIP6Route route;
+	GHashTableIter h_iter;
+	const NMPObject *needle;
+	gulong handler_id;
+	int ifindex;
+
+	ifindex = nm_platform_link_get_ifindex (platform, "eth0");
+	g_assert_cmpint (ifindex, >, 0);
+
+	changed_routes = g_hash_table_new_full ((GHashFunc) nmp_object_id_hash,
+	                                        (GEqualFunc) nmp_object_id_equal,
+	                                        (GDestroyNotify) nmp_object_unref,
+	                                        NULL);
+	handler_id = g_signal_connect (platform,
+	                               NM_PLATFORM_SIGNAL_CHANGE_SET,
+	                               G_CALLBACK (_capture_change_set_cb),
+	                               changed_routes);
+
+	g_assert (nm_platform_ip6_address_add (platform, ifindex,
+	                                       *nmtst_inet6_from_string ("2001:db8:1::10"), 64,
+	                                       in6addr_any,
+	                                       NM_PLATFORM_LIFETIME_PERMANENT,
+	                                       NM_PLATFORM_LIFETIME_PERMANENT,
+	                                       0));
+
+	route = (NMPlatformIP6Route) {
+		.ifindex   = ifindex,
+		.rt_source = NM_IP_CONFIG_SOURCE_USER,
+		.network   = *nmtst_inet6_from_string ("2001:db8:a::"),
+		.plen      = 48,
+		.metric    = 100,
+	};
+	g_assert_cmpint (nm_platform_ip6_route_add (platform, NMP_NLM_FLAG_REPLACE, &route), ==, 0);
+	route.network = *nmtst_inet6_from_string ("2001:db8:b::");
+	g_assert_cmpint (nm_platform_ip6_route_add (platform, NMP_NLM_FLAG_REPLACE, &route), ==, 0);
+	route.network = in6addr_any;
+	route.plen = 0;
+	g_assert_cmpint (nm_platform_ip6_route_add (platform, NMP_NLM_FLAG_REPLACE, &route), ==, 0);
+
+	captured = nm_ip6_config_capture (multi_idx, platform, ifindex, NM_SETTING_IP6_CONFIG_PRIVACY_UNKNOWN);
+	g_assert (captured);
+	g_assert_cmpint (nm_ip6_config_get_num_routes (captured), ==, 3);
+	g_assert (nm_ip6_config_best_default_route_get (captured));
+
+	cloned = nm_ip6_config_new_cloned (captured);
+	_assert_capture_equal (captured, cloned);
+
+	/* the captured configuration already contains the pending changes. */
+	nm_platform_change_set_flush (platform, NMP_OBJECT_TYPE_IP6_ROUTE, ifindex);
+	g_assert_cmpint (g_hash_table_size (changed_routes), ==, 3);
+	g_hash_table_remove_all (changed_routes);
+
+	/* remove a route, change one, add another one and the default route with
+	 * a lower metric. Also replace the address. */
+	route = (NMPlatformIP6Route) {
+		.ifindex   = ifindex,
+		.rt_source = NM_IP_CONFIG_SOURCE_USER,
+		.network   = *nmtst_inet6_from_string ("2001:db8:a::"),
+		.plen      = 48,
+		.metric    = 100,
+	};
+	obj = nmp_object_new (NMP_OBJECT_TYPE_IP6_ROUTE, (const NMPlatformObject *) &route);
+	g_assert (nm_platform_object_delete (platform, obj));
+	route.network = *nmtst_inet6_from_string ("2001:db8:b::");
+	route.pref_src = *nmtst_inet6_from_string ("2001:db8:1::10");
+	g_assert_cmpint (nm_platform_ip6_route_add (platform, NMP_NLM_FLAG_REPLACE, &route), ==, 0);
+	route.network = *nmtst_inet6_from_string ("2001:db8:c::");
+	route.pref_src = in6addr_any;
+	g_assert_cmpint (nm_platform_ip6_route_add (platform, NMP_NLM_FLAG_REPLACE, &route), ==, 0);
+	route.network = in6addr_any;
+	route.plen = 0;
+	route.metric = 50;
+	g_assert_cmpint (nm_platform_ip6_route_add (platform, NMP_NLM_FLAG_REPLACE, &route), ==, 0);
+
+	g_assert (nm_platform_ip6_address_add (platform, ifindex,
+	                                       *nmtst_inet6_from_string ("2001:db8:2::10"), 64,
+	                                       in6addr_any,
+	                                       NM_PLATFORM_LIFETIME_PERMANENT,
+	                                       NM_PLATFORM_LIFETIME_PERMANENT,
+	                                       0));
+	g_assert (nm_platform_ip6_address_delete (platform, ifindex,
+	                                          *nmtst_inet6_from_string ("2001:db8:1::10"), 64));
+
+	/* the change set was not yet emitted. */
+	g_assert_cmpint (g_hash_table_size (changed_routes), ==, 0);
+	nm_platform_change_set_flush (platform, NMP_OBJECT_TYPE_IP6_ROUTE, ifindex);
+	g_assert_cmpint (g_hash_table_size (changed_routes), ==, 4);
+
+	nm_ip6_config_capture_update_addresses (captured, platform, NM_SETTING_IP6_CONFIG_PRIVACY_UNKNOWN);
+	nm_ip6_config_capture_update_addresses (cloned, platform, NM_SETTING_IP6_CONFIG_PRIVACY_UNKNOWN);
+	g_hash_table_iter_init (&h_iter, changed_routes);
+	while (g_hash_table_iter_next (&h_iter, (gpointer *) &needle, NULL)) {
+		nm_ip6_config_capture_update_route (captured, platform, needle);
+		nm_ip6_config_capture_update_route (cloned, platform, needle);
+	}
+
+	full = nm_ip6_config_capture (multi_idx, platform, ifindex, NM_SETTING_IP6_CONFIG_PRIVACY_UNKNOWN);
+	g_assert (full);
+	g_assert_cmpint (nm_ip6_config_get_num_addresses (full), ==, 1);
+	g_assert (NMP_OBJECT_CAST_IP6_ROUTE (nm_ip6_config_best_default_route_get (full))->metric == 50);
+
+	_assert_capture_equal (full, captured);
+	_assert_capture_equal (full, cloned);
+
+	g_signal_handler_disconnect (platform, handler_id);
+}
+
+/*****************************************************************************/
+
 NMTST_DEFINE();
 
 int
@@ -412,6 +580,8 @@ main (int argc, char **argv)
 {
 	nmtst_init_with_logging (&argc, &argv, NULL, "ALL");
 
+	nm_fake_platform_setup ();
+
 	g_test_add_func ("/ip6-config/subtract", test_subtract);
 	g_test_add_func ("/ip6-config/compare-with-source", test_compare_with_source);
 	g_test_add_func ("/ip6-config/add-address-with-source", test_add_address_with_source);
@@ -420,6 +590,7 @@ main (int argc, char **argv)
 	g_test_add_func ("/ip6-config/strip-search-trailing-dot", test_strip_search_trailing_dot);
 	g_test_add_data_func ("/ip6-config/replace/1", GINT_TO_POINTER (1), test_replace);
 	g_test_add_data_func ("/ip6-config/replace/2", GINT_TO_POINTER (2), test_replace);
+	g_test_add_func ("/ip6-config/capture-update", test_capture_update);
 
 	return g_test_run ();
 }
@@ -7,6 +7,9 @@
 
 #include <arpa/inet.h>
 
+#include "settings/nm-settings.h"
+#include "settings/nm-settings-utils.h"
+
 #include "nm-test-utils-core.h"
 
 static void
@@ -109,6 +112,350 @@ test_hw_addr_gen_stable_eth (void)
 
 /*****************************************************************************/
 
+static void
+_idx_update (NMSettUtilAutoconnectIdx *idx,
+             guint id,
+             const char *type,
+             const char *ifname,
+             const char *hwaddr,
+             const char *vlan_parent,
+             guint32 vlan_id)
+{
+	gs_unref_object NMConnection *connection = NULL;
+	NMSettingConnection *s_con;
+
+	connection = nmtst_create_minimal_connection ("test", NULL, type, &s_con);
+	if (ifname)
+		g_object_set (s_con, NM_SETTING_CONNECTION_INTERFACE_NAME, ifname, NULL);
+	if (hwaddr) {
+		g_object_set (nm_connection_get_setting_wired (connection),
+		              NM_SETTING_WIRED_MAC_ADDRESS, hwaddr,
+		              NULL);
+	}
+	if (nm_streq (type, NM_SETTING_VLAN_SETTING_NAME)) {
+		g_object_set (nm_connection_get_setting_vlan (connection),
+		              NM_SETTING_VLAN_PARENT, vlan_parent,
+		              NM_SETTING_VLAN_ID, vlan_id,
+		              NULL);
+	}
+
+	nm_sett_util_autoconnect_idx_update (idx, GUINT_TO_POINTER (id), connection);
+}
+
+static int
+_idx_cmp (gconstpointer a, gconstpointer b)
+{
+	NM_CMP_DIRECT (GPOINTER_TO_UINT (*((gconstpointer *) a)),
+	               GPOINTER_TO_UINT (*((gconstpointer *) b)));
+	return 0;
+}
+
+/* returns the sorted ids of the candidates, separated by space. */
+static char *
+_idx_collect (NMSettUtilAutoconnectIdx *idx,
+              const NMSettingsAutoconnectLookup *lookup)
+{
+	gs_unref_ptrarray GPtrArray *result = g_ptr_array_new ();
+	GString *str = g_string_new (NULL);
+	guint i;
+
+	nm_sett_util_autoconnect_idx_collect (idx, lookup, result);
+	g_ptr_array_sort (result, _idx_cmp);
+	for (i = 0; i < result->len; i++) {
+		if (i > 0)
+			g_assert (result->pdata[i - 1] != result->pdata[i]);
+		g_string_append_printf (str, "%s%u",
+		                        i > 0 ? " " : "",
+		                        GPOINTER_TO_UINT (result->pdata[i]));
+	}
+	return g_string_free (str, FALSE);
+}
+
+#define _assert_idx_collect(idx, expected, ...) \
+	G_STMT_START { \
+		const NMSettingsAutoconnectLookup _lookup = { __VA_ARGS__ }; \
+		gs_free char *_s = _idx_collect ((idx), &_lookup); \
+		\
+		g_assert_cmpstr (_s, ==, (expected)); \
+	} G_STMT_END
+
+static void
+test_autoconnect_idx (void)
+{
+	NMSettUtilAutoconnectIdx *idx;
+
+	idx = nm_sett_util_autoconnect_idx_new ();
+
+	_idx_update (idx, 1, NM_SETTING_WIRED_SETTING_NAME, NULL,   NULL,                NULL,    0);
+	_idx_update (idx, 2, NM_SETTING_WIRED_SETTING_NAME, NULL,   "00:11:22:33:44:55", NULL,    0);
+	_idx_update (idx, 3, NM_SETTING_WIRED_SETTING_NAME, "eth0", NULL,                NULL,    0);
+	_idx_update (idx, 4, NM_SETTING_WIRED_SETTING_NAME, "eth1", NULL,                NULL,    0);
+	_idx_update (idx, 5, NM_SETTING_VLAN_SETTING_NAME,  NULL,   NULL,                "eth0",  10);
+	_idx_update (idx, 6, NM_SETTING_VLAN_SETTING_NAME,  NULL,   NULL,                "eth0",  20);
+	_idx_update (idx, 7, NM_SETTING_VLAN_SETTING_NAME,  NULL,   NULL,                "eth1",  10);
+	_idx_update (idx, 8, NM_SETTING_VLAN_SETTING_NAME,  NULL,   NULL,                "b6d7fd5b-5d6b-4a37-a1a3-3ff4a4e7f9a2", 10);
+	_idx_update (idx, 9, NM_SETTING_VLAN_SETTING_NAME,  "vlan", NULL,                "eth0",  30);
+	_idx_update (idx, 10, NM_SETTING_BOND_SETTING_NAME, NULL,   NULL,                NULL,    0);
+
+	/* the type and the interface name. */
+	_assert_idx_collect (idx, "1 2 3",
+	                     .type = NM_SETTING_WIRED_SETTING_NAME,
+	                     .ifname = "eth0");
+	_assert_idx_collect (idx, "1 2",
+	                     .type = NM_SETTING_WIRED_SETTING_NAME,
+	                     .ifname = "eth2");
+	_assert_idx_collect (idx, "10",
+	                     .type = NM_SETTING_BOND_SETTING_NAME,
+	                     .ifname = "eth0");
+	_assert_idx_collect (idx, "",
+	                     .type = NM_SETTING_TEAM_SETTING_NAME,
+	                     .ifname = "eth0");
+
+	/* the MAC address. */
+	_assert_idx_collect (idx, "1 2 3",
+	                     .type = NM_SETTING_WIRED_SETTING_NAME,
+	                     .ifname = "eth0",
+	                     .hwaddr = "00:11:22:33:44:55");
+	_assert_idx_collect (idx, "1 3",
+	                     .type = NM_SETTING_WIRED_SETTING_NAME,
+	                     .ifname = "eth0",
+	                     .hwaddr = "00:11:22:33:44:66");
+
+	/* the parent and the VLAN id. */
+	_assert_idx_collect (idx, "5 8",
+	                     .type = NM_SETTING_VLAN_SETTING_NAME,
+	                     .ifname = "eth0.10",
+	                     .parent = "eth0",
+	                     .vlan_id = 10,
+	                     .vlan_id_has = TRUE);
+	_assert_idx_collect (idx, "6",
+	                     .type = NM_SETTING_VLAN_SETTING_NAME,
+	                     .ifname = "eth0.20",
+	                     .parent = "eth0",
+	                     .vlan_id = 20,
+	                     .vlan_id_has = TRUE);
+	_assert_idx_collect (idx, "7 8",
+	                     .type = NM_SETTING_VLAN_SETTING_NAME,
+	                     .ifname = "eth1.10",
+	                     .parent = "eth1",
+	                     .vlan_id = 10,
+	                     .vlan_id_has = TRUE);
+	_assert_idx_collect (idx, "9",
+	                     .type = NM_SETTING_VLAN_SETTING_NAME,
+	                     .ifname = "vlan",
+	                     .parent = "eth0",
+	                     .vlan_id = 30,
+	                     .vlan_id_has = TRUE);
+	_assert_idx_collect (idx, "",
+	                     .type = NM_SETTING_VLAN_SETTING_NAME,
+	                     .ifname = "eth2.10",
+	                     .parent = "eth2",
+	                     .vlan_id = 40,
+	                     .vlan_id_has = TRUE);
+
+	/* without parent and id, all VLAN profiles without interface name
+	 * are candidates. */
+	_assert_idx_collect (idx, "5 6 7 8",
+	                     .type = NM_SETTING_VLAN_SETTING_NAME,
+	                     .ifname = "eth0.10");
+	_assert_idx_collect (idx, "5 7 8",
+	                     .type = NM_SETTING_VLAN_SETTING_NAME,
+	                     .ifname = "eth0.10",
+	                     .vlan_id = 10,
+	                     .vlan_id_has = TRUE);
+
+	/* a list of types, like for ethernet devices. VLAN profiles are not
+	 * candidates. */
+	_assert_idx_collect (idx, "1 2 3",
+	                     .types = NM_MAKE_STRV (NM_SETTING_WIRED_SETTING_NAME, NM_SETTING_PPPOE_SETTING_NAME),
+	                     .ifname = "eth0");
+	_assert_idx_collect (idx, "1 2",
+	                     .types = NM_MAKE_STRV (NM_SETTING_WIRED_SETTING_NAME, NM_SETTING_PPPOE_SETTING_NAME),
+	                     .ifname = "vlan");
+	_assert_idx_collect (idx, "1 3",
+	                     .types = NM_MAKE_STRV (NM_SETTING_WIRED_SETTING_NAME, NM_SETTING_PPPOE_SETTING_NAME),
+	                     .ifname = "eth0",
+	                     .hwaddr = "00:11:22:33:44:66");
+	_assert_idx_collect (idx, "10",
+	                     .types = NM_MAKE_STRV (NM_SETTING_BOND_SETTING_NAME),
+	                     .ifname = "eth0");
+
+	/* without type, all types are candidates. */
+	_assert_idx_collect (idx, "1 2 3 5 8 10",
+	                     .ifname = "eth0",
+	                     .parent = "eth0",
+	                     .vlan_id = 10,
+	                     .vlan_id_has = TRUE);
+
+	/* updating a profile moves it to its new bucket. */
+	_idx_update (idx, 5, NM_SETTING_VLAN_SETTING_NAME, NULL, NULL, "eth0", 20);
+	_idx_update (idx, 3, NM_SETTING_WIRED_SETTING_NAME, NULL, "00:11:22:33:44:66", NULL, 0);
+	_assert_idx_collect (idx, "5 6",
+	                     .type = NM_SETTING_VLAN_SETTING_NAME,
+	                     .ifname = "eth0.20",
+	                     .parent = "eth0",
+	                     .vlan_id = 20,
+	                     .vlan_id_has = TRUE);
+	_assert_idx_collect (idx, "8",
+	                     .type = NM_SETTING_VLAN_SETTING_NAME,
+	                     .ifname = "eth0.10",
+	                     .parent = "eth0",
+	                     .vlan_id = 10,
+	                     .vlan_id_has = TRUE);
+	_assert_idx_collect (idx, "1 3",
+	                     .type = NM_SETTING_WIRED_SETTING_NAME,
+	                     .ifname = "eth0",
+	                     .hwaddr = "00:11:22:33:44:66");
+
+	nm_sett_util_autoconnect_idx_remove (idx, GUINT_TO_POINTER (6));
+	nm_sett_util_autoconnect_idx_remove (idx, GUINT_TO_POINTER (6));
+	nm_sett_util_autoconnect_idx_remove (idx, GUINT_TO_POINTER (1));
+	_assert_idx_collect (idx, "5",
+	                     .type = NM_SETTING_VLAN_SETTING_NAME,
+	                     .ifname = "eth0.20",
+	                     .parent = "eth0",
+	                     .vlan_id = 20,
+	                     .vlan_id_has = TRUE);
+	_assert_idx_collect (idx, "3",
+	                     .type = NM_SETTING_WIRED_SETTING_NAME,
+	                     .ifname = "eth2",
+	                     .hwaddr = "00:11:22:33:44:66");
+
+	/* the remaining profiles are freed with the index. */
+	nm_sett_util_autoconnect_idx_free (idx);
+}
+
+/*****************************************************************************/
+
+typedef struct {
+	guint id;
+	int priority;
+	guint64 timestamp;
+	guint sorted_idx;
+} SortedElem;
+
+/* like nm_settings_connection_cmp_autoconnect_priority(): higher priority
+ * first, then more recent timestamp. */
+static int
+_sorted_cmp (gconstpointer pa, gconstpointer pb, gpointer user_data)
+{
+	const SortedElem *a = pa;
+	const SortedElem *b = pb;
+
+	NM_CMP_FIELD (b, a, priority);
+	NM_CMP_FIELD (b, a, timestamp);
+	NM_CMP_FIELD (a, b, id);
+	return 0;
+}
+
+static int
+_sorted_cmp_p (gconstpointer pa, gconstpointer pb, gpointer user_data)
+{
+	return _sorted_cmp (*((gconstpointer *) pa), *((gconstpointer *) pb), user_data);
+}
+
+static void
+_sorted_assert (GPtrArray *arr, SortedElem *elems, guint n_elems)
+{
+	gs_unref_ptrarray GPtrArray *expected = g_ptr_array_new ();
+	guint i;
+
+	for (i = 0; i < n_elems; i++) {
+		if (elems[i].sorted_idx != NM_SETT_UTIL_SORTED_ARRAY_IDX_NONE)
+			g_ptr_array_add (expected, &elems[i]);
+	}
+	g_ptr_array_sort_with_data (expected, _sorted_cmp_p, NULL);
+
+	g_assert_cmpint (arr->len, ==, expected->len);
+	for (i = 0; i < arr->len; i++) {
+		g_assert (arr->pdata[i] == expected->pdata[i]);
+		g_assert_cmpint (((SortedElem *) arr->pdata[i])->sorted_idx, ==, i);
+	}
+}
+
+#define _sorted_update(arr, elem) \
+	nm_sett_util_sorted_array_update ((arr), (elem), G_STRUCT_OFFSET (SortedElem, sorted_idx), _sorted_cmp, NULL)
+
+#define _sorted_remove(arr, elem) \
+	nm_sett_util_sorted_array_remove ((arr), (elem), G_STRUCT_OFFSET (SortedElem, sorted_idx))
+
+static void
+test_sorted_array (void)
+{
+	gs_unref_ptrarray GPtrArray *arr = g_ptr_array_new ();
+	SortedElem elems[20];
+	guint i;
+	guint j;
+
+	for (i = 0; i < G_N_ELEMENTS (elems); i++) {
+		elems[i] = (SortedElem) {
+			.id         = i,
+			.priority   = nmtst_get_rand_uint32 () % 3,
+			.timestamp  = nmtst_get_rand_uint32 () % 5,
+			.sorted_idx = NM_SETT_UTIL_SORTED_ARRAY_IDX_NONE,
+		};
+	}
+
+	for (i = 0; i < G_N_ELEMENTS (elems); i++) {
+		_sorted_update (arr, &elems[i]);
+		_sorted_assert (arr, elems, G_N_ELEMENTS (elems));
+	}
+
+	/* activating a profile bumps its timestamp, which moves it before the
+	 * other profiles of the same priority. */
+	elems[7].timestamp = 100;
+	_sorted_update (arr, &elems[7]);
+	_sorted_assert (arr, elems, G_N_ELEMENTS (elems));
+	for (i = 0; i < arr->len && arr->pdata[i] != &elems[7]; i++)
+		g_assert_cmpint (((SortedElem *) arr->pdata[i])->priority, >, elems[7].priority);
+
+	/* a higher priority moves it to the front, a lower one to the back. */
+	elems[3].priority = 10;
+	_sorted_update (arr, &elems[3]);
+	_sorted_assert (arr, elems, G_N_ELEMENTS (elems));
+	g_assert (arr->pdata[0] == &elems[3]);
+
+	elems[3].priority = -10;
+	_sorted_update (arr, &elems[3]);
+	_sorted_assert (arr, elems, G_N_ELEMENTS (elems));
+	g_assert (arr->pdata[arr->len - 1] == &elems[3]);
+
+	/* updating an element whose key did not change keeps it in place. */
+	_sorted_update (arr, &elems[3]);
+	_sorted_assert (arr, elems, G_N_ELEMENTS (elems));
+
+	for (j = 0; j < 200; j++) {
+		SortedElem *elem = &elems[nmtst_get_rand_uint32 () % G_N_ELEMENTS (elems)];
+
+		switch (nmtst_get_rand_uint32 () % 4) {
+		case 0:
+			elem->priority = nmtst_get_rand_uint32 () % 3;
+			_sorted_update (arr, elem);
+			break;
+		case 1:
+			elem->timestamp = nmtst_get_rand_uint32 () % 5;
+			_sorted_update (arr, elem);
+			break;
+		case 2:
+			_sorted_remove (arr, elem);
+			g_assert_cmpint (elem->sorted_idx, ==, NM_SETT_UTIL_SORTED_ARRAY_IDX_NONE);
+			break;
+		default:
+			_sorted_update (arr, elem);
+			break;
+		}
+		_sorted_assert (arr, elems, G_N_ELEMENTS (elems));
+	}
+
+	for (i = 0; i < G_N_ELEMENTS (elems); i++) {
+		_sorted_remove (arr, &elems[i]);
+		_sorted_assert (arr, elems, G_N_ELEMENTS (elems));
+	}
+	g_assert_cmpint (arr->len, ==, 0);
+}
+
+/*****************************************************************************/
+
 NMTST_DEFINE ();
 
 int
@@ -118,6 +465,8 @@ main (int argc, char **argv)
 
 	g_test_add_func ("/utils/stable_privacy", test_stable_privacy);
 	g_test_add_func ("/utils/hw_addr_gen_stable_eth", test_hw_addr_gen_stable_eth);
+	g_test_add_func ("/utils/autoconnect-idx", test_autoconnect_idx);
+	g_test_add_func ("/utils/sorted-array", test_sorted_array);
 
 	return g_test_run ();
 }